@@ -11,6 +11,7 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QEventLoop>
+#include <QtCore/QRegExp>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QTimer>
 #include <QtNetwork/QNetworkDiskCache>
@@ -30,6 +31,7 @@
 #include <ModelsScriptingInterface.h> // TODO: consider moving to scriptengine.h
 
 #include "Agent.h"
+#include "AgentScriptWorker.h"
 
 Agent::Agent(const QByteArray& packet) :
     ThreadedAssignment(packet),
@@ -47,6 +49,9 @@ Agent::Agent(const QByteArray& packet) :
     _scriptEngine.getModelsScriptingInterface()->setPacketSender(&_modelEditSender);
 }
 
+// The Agent doesn't go through the PacketDispatcher: almost everything it receives is kept past the read (queued to the
+// jurisdiction listeners, the viewers' pipelines or the script workers), so each packet would be copied out of the pool
+// anyway, and its rate is bounded by the octree data its own queries ask for.
 void Agent::readPendingDatagrams() {
     QByteArray receivedPacket;
     HifiSockAddr senderSockAddr;
@@ -171,7 +176,14 @@ void Agent::readPendingDatagrams() {
                        || datagramPacketType == PacketTypeAvatarBillboard
                        || datagramPacketType == PacketTypeKillAvatar) {
                 // let the avatar hash map process it
-                _avatarHashMap.processAvatarMixerDatagram(receivedPacket, nodeList->sendingNodeForPacket(receivedPacket));
+                SharedNodePointer avatarMixer = nodeList->sendingNodeForPacket(receivedPacket);
+                _avatarHashMap.processAvatarMixerDatagram(receivedPacket, avatarMixer);
+
+                // the hosted scripts keep their own avatar lists, update those on the threads that read them
+                foreach (AgentScriptWorker* worker, _scriptWorkers) {
+                    QMetaObject::invokeMethod(worker, "processAvatarMixerDatagram", Qt::QueuedConnection,
+                                              Q_ARG(QByteArray, receivedPacket), Q_ARG(SharedNodePointer, avatarMixer));
+                }
                 
                 // let this continue through to the NodeList so it updates last heard timestamp
                 // for the sending avatar-mixer
@@ -199,13 +211,16 @@ void Agent::run() {
     
     // figure out the URL for the script for this agent assignment
     QUrl scriptURL;
+    QStringList hostedScriptURLs;
     if (_payload.isEmpty())  {
         scriptURL = QUrl(QString("http://%1:%2/assignment/%3")
             .arg(NodeList::getInstance()->getDomainHandler().getIP().toString())
             .arg(DOMAIN_SERVER_HTTP_PORT)
             .arg(uuidStringWithoutCurlyBraces(_uuid)));
     } else {
-        scriptURL = QUrl(_payload);
+        // the payload can carry more than one script, the first is ours and the others are hosted alongside it
+        hostedScriptURLs = QString(_payload).split(QRegExp("\\s+"), QString::SkipEmptyParts);
+        scriptURL = QUrl(hostedScriptURLs.takeFirst());
     }
    
     NetworkAccessManager& networkAccessManager = NetworkAccessManager::getInstance();
@@ -262,11 +277,79 @@ void Agent::run() {
     _modelViewer.init();
     _scriptEngine.getModelsScriptingInterface()->setModelTree(_modelViewer.getTree());
 
+    if (!hostedScriptURLs.isEmpty()) {
+        startHostedScripts(hostedScriptURLs);
+    }
+
     _scriptEngine.setScriptContents(scriptContents);
     _scriptEngine.run();
+
+    stopHostedScripts();
     setFinished(true);
 }
 
+void Agent::startHostedScripts(const QStringList& scriptURLs) {
+    qDebug() << "Hosting" << scriptURLs.size() << "additional scripts";
+
+    int numWorkers = qMin(scriptURLs.size(), qMax(QThread::idealThreadCount(), 1));
+    for (int i = 0; i < numWorkers; i++) {
+        _scriptWorkers.append(new AgentScriptWorker());
+    }
+
+    NodeList* nodeList = NodeList::getInstance();
+    int nextWorker = 0;
+
+    foreach (const QString& scriptURL, scriptURLs) {
+        // this downloads the script contents, so it blocks until they are here
+        ScriptEngine* scriptEngine = new ScriptEngine(QUrl(scriptURL));
+        if (!scriptEngine->hasScript()) {
+            qDebug() << "Could not load hosted script at" << scriptURL;
+            delete scriptEngine;
+            continue;
+        }
+
+        AgentScriptWorker* worker = _scriptWorkers[nextWorker];
+        scriptEngine->setAvatarHashMap(worker->getAvatarHashMap(), "AvatarList");
+        scriptEngine->init();
+
+        // The servers know this Agent by a single node and view frustum, so only our own script gets the viewers and
+        // drives the camera. Hosted scripts still read the trees through Voxels, Particles and Models, which lock them.
+
+        connect(nodeList, &NodeList::nodeKilled, scriptEngine, &ScriptEngine::nodeKilled);
+
+        worker->addScript(scriptEngine);
+        nextWorker = (nextWorker + 1) % numWorkers;
+    }
+
+    foreach (AgentScriptWorker* worker, _scriptWorkers) {
+        QThread* workerThread = new QThread(this);
+        worker->moveToThread(workerThread);
+        connect(workerThread, &QThread::started, worker, &AgentScriptWorker::start);
+
+        _scriptWorkerThreads.append(workerThread);
+        workerThread->start();
+    }
+}
+
+void Agent::stopHostedScripts() {
+    foreach (AgentScriptWorker* worker, _scriptWorkers) {
+        QMetaObject::invokeMethod(worker, "stopAll");
+    }
+
+    foreach (QThread* workerThread, _scriptWorkerThreads) {
+        workerThread->wait();
+        delete workerThread;
+    }
+    _scriptWorkerThreads.clear();
+
+    // the threads are gone so the workers (and their engines) can be cleaned up from here
+    qDeleteAll(_scriptWorkers);
+    _scriptWorkers.clear();
+
+    // send any edits the hosted scripts queued up on their way out
+    ScriptEngine::flushEditPacketSenders();
+}
+
 void Agent::aboutToFinish() {
     _scriptEngine.stop();
     NetworkAccessManager::getInstance().clearAccessCache();
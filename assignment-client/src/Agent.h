@@ -16,6 +16,8 @@
 
 #include <QtScript/QScriptEngine>
 #include <QtCore/QObject>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
 #include <QtCore/QUrl>
 
 #include <AvatarHashMap.h>
@@ -32,6 +34,12 @@
 #include <VoxelTreeHeadlessViewer.h>
 
 
+class AgentScriptWorker;
+
+/// Runs the script(s) given in the assignment payload. The payload may list several whitespace separated script URLs,
+/// in which case the first one is the Agent's own (avatar capable) script and the rest are hosted on a small pool of
+/// AgentScriptWorker threads. All scripts share this Agent's node and edit packet senders, but only our own script gets
+/// the headless viewers, since the servers know this Agent by one view frustum.
 class Agent : public ThreadedAssignment {
     Q_OBJECT
     
@@ -61,6 +69,9 @@ public slots:
     void playAvatarSound(Sound* avatarSound) { _scriptEngine.setAvatarSound(avatarSound); }
 
 private:
+    void startHostedScripts(const QStringList& scriptURLs);
+    void stopHostedScripts();
+
     ScriptEngine _scriptEngine;
     VoxelEditPacketSender _voxelEditSender;
     ParticleEditPacketSender _particleEditSender;
@@ -74,6 +85,9 @@ private:
     SequenceNumberStats _incomingMixedAudioSequenceNumberStats;
 
     AvatarHashMap _avatarHashMap;
+
+    QList<AgentScriptWorker*> _scriptWorkers;
+    QList<QThread*> _scriptWorkerThreads;
 };
 
 #endif // hifi_Agent_h
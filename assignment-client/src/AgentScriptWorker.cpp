@@ -0,0 +1,78 @@
+//
+//  AgentScriptWorker.cpp
+//  assignment-client/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDebug>
+#include <QtCore/QThread>
+
+#include "AgentScriptWorker.h"
+
+AgentScriptWorker::AgentScriptWorker() :
+    _scripts(),
+    _frameTimer(NULL),
+    _avatarHashMap()
+{
+    // be the parent of the avatar list so it gets moved to our thread with us
+    _avatarHashMap.setParent(this);
+}
+
+void AgentScriptWorker::addScript(ScriptEngine* scriptEngine) {
+    // parent the engine to us so that it moves to our thread with us
+    scriptEngine->setParent(this);
+    _scripts.append(scriptEngine);
+}
+
+void AgentScriptWorker::start() {
+    foreach (ScriptEngine* scriptEngine, _scripts) {
+        scriptEngine->startRunning();
+    }
+
+    _frameTimer = new QTimer(this);
+    _frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(_frameTimer, &QTimer::timeout, this, &AgentScriptWorker::runFrame);
+    _frameTimer->start(SCRIPT_DATA_CALLBACK_USECS / USECS_PER_MSEC);
+}
+
+void AgentScriptWorker::stopAll() {
+    foreach (ScriptEngine* scriptEngine, _scripts) {
+        scriptEngine->stop();
+    }
+
+    // don't wait for the next frame to wind the scripts down
+    runFrame();
+}
+
+void AgentScriptWorker::processAvatarMixerDatagram(const QByteArray& datagram, const SharedNodePointer& sendingNode) {
+    _avatarHashMap.processAvatarMixerDatagram(datagram, sendingNode);
+}
+
+void AgentScriptWorker::runFrame() {
+    QList<ScriptEngine*>::iterator it = _scripts.begin();
+    while (it != _scripts.end()) {
+        ScriptEngine* scriptEngine = *it;
+        if (scriptEngine->isFinished()) {
+            // the Agent flushes the shared edit packet senders, we don't have to do it here
+            scriptEngine->finishRunning(false);
+            delete scriptEngine;
+            it = _scripts.erase(it);
+        } else {
+            scriptEngine->runFrame();
+            ++it;
+        }
+    }
+
+    if (_scripts.isEmpty()) {
+        if (_frameTimer) {
+            _frameTimer->stop();
+        }
+        emit finished();
+        thread()->quit();
+    }
+}
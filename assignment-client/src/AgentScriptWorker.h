@@ -0,0 +1,58 @@
+//
+//  AgentScriptWorker.h
+//  assignment-client/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AgentScriptWorker_h
+#define hifi_AgentScriptWorker_h
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+#include <AvatarHashMap.h>
+#include <Node.h>
+#include <ScriptEngine.h>
+
+/// Drives several ScriptEngines from a single thread. Used by an Agent that hosts more than one script, so that the
+/// number of threads does not grow with the number of scripts. The engines on a worker share its AvatarList, which
+/// the Agent feeds from the avatar mixer packets it receives.
+class AgentScriptWorker : public QObject {
+    Q_OBJECT
+public:
+    AgentScriptWorker();
+
+    /// Takes ownership of the script engine. Must be called before the worker is moved to its thread.
+    void addScript(ScriptEngine* scriptEngine);
+
+    int getNumScripts() const { return _scripts.size(); }
+
+    /// The AvatarList of the scripts on this worker. Only touch it from the worker's thread once it has been started.
+    AvatarHashMap* getAvatarHashMap() { return &_avatarHashMap; }
+
+public slots:
+    void start();
+    void stopAll();
+
+    /// queued to us by the Agent, so that the avatar list is only ever updated from the thread the scripts run on
+    void processAvatarMixerDatagram(const QByteArray& datagram, const SharedNodePointer& sendingNode);
+
+signals:
+    void finished();
+
+private slots:
+    void runFrame();
+
+private:
+    QList<ScriptEngine*> _scripts;
+    QTimer* _frameTimer;
+    AvatarHashMap _avatarHashMap;
+};
+
+#endif // hifi_AgentScriptWorker_h
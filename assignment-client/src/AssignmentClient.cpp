@@ -15,6 +15,7 @@
 
 #include <AccountManager.h>
 #include <Assignment.h>
+#include <AudioInjectorScheduler.h>
 #include <HifiConfigVariantMap.h>
 #include <Logging.h>
 #include <NodeList.h>
@@ -81,6 +82,9 @@ AssignmentClient::AssignmentClient(int &argc, char **argv) :
     // create a NodeList as an unassigned client
     NodeList* nodeList = NodeList::createInstance(NodeType::Unassigned);
 
+    // the sounds the Agent scripts inject are sent from their own thread, which winds down when we're about to quit
+    AudioInjectorScheduler::createInstance(this);
+
     // check for an overriden assignment server hostname
     if (argumentVariantMap.contains(CUSTOM_ASSIGNMENT_SERVER_HOSTNAME_OPTION)) {
         _assignmentServerHostname = argumentVariantMap.value(CUSTOM_ASSIGNMENT_SERVER_HOSTNAME_OPTION).toString();
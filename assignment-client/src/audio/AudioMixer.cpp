@@ -77,11 +77,20 @@ AudioMixer::AudioMixer(const QByteArray& packet) :
     _numStatFrames(0),
     _sumListeners(0),
     _sumMixes(0),
+    _sumSendCalls(0),
+    _sumEncodeUsecs(0),
+    _sumMixBytes(0),
     _sourceUnattenuatedZone(NULL),
     _listenerUnattenuatedZone(NULL),
     _lastSendAudioStreamStatsTime(usecTimestampNow())
 {
-    
+    PacketDispatcher& packetDispatcher = getPacketDispatcher();
+    packetDispatcher.registerHandler(PacketTypeMicrophoneAudioNoEcho, this, &AudioMixer::handleAudioDataPacket);
+    packetDispatcher.registerHandler(PacketTypeMicrophoneAudioWithEcho, this, &AudioMixer::handleAudioDataPacket);
+    packetDispatcher.registerHandler(PacketTypeInjectAudio, this, &AudioMixer::handleAudioDataPacket);
+    packetDispatcher.registerHandler(PacketTypeSilentAudioFrame, this, &AudioMixer::handleAudioDataPacket);
+    packetDispatcher.registerHandler(PacketTypeAudioStreamStats, this, &AudioMixer::handleAudioDataPacket);
+    packetDispatcher.registerHandler(PacketTypeMuteEnvironment, this, &AudioMixer::handleMuteEnvironmentPacket);
 }
 
 AudioMixer::~AudioMixer() {
@@ -394,35 +403,25 @@ void AudioMixer::prepareMixForListeningNode(Node* node) {
 
 
 void AudioMixer::readPendingDatagrams() {
-    QByteArray receivedPacket;
-    HifiSockAddr senderSockAddr;
+    getPacketDispatcher().processPendingDatagrams();
+}
+
+void AudioMixer::handleAudioDataPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    // pull any new audio data from nodes off of the network stack
+    NodeList::getInstance()->findNodeAndUpdateWithDataFromPacket(packet);
+}
+
+void AudioMixer::handleMuteEnvironmentPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
     NodeList* nodeList = NodeList::getInstance();
-    
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
-        if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
-            // pull any new audio data from nodes off of the network stack
-            PacketType mixerPacketType = packetTypeForPacket(receivedPacket);
-            if (mixerPacketType == PacketTypeMicrophoneAudioNoEcho
-                || mixerPacketType == PacketTypeMicrophoneAudioWithEcho
-                || mixerPacketType == PacketTypeInjectAudio
-                || mixerPacketType == PacketTypeSilentAudioFrame
-                || mixerPacketType == PacketTypeAudioStreamStats) {
-                
-                nodeList->findNodeAndUpdateWithDataFromPacket(receivedPacket);
-            } else if (mixerPacketType == PacketTypeMuteEnvironment) {
-                QByteArray packet = receivedPacket;
-                populatePacketHeader(packet, PacketTypeMuteEnvironment);
-                
-                foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
-                    if (node->getType() == NodeType::Agent && node->getActiveSocket() && node->getLinkedData() && node != nodeList->sendingNodeForPacket(receivedPacket)) {
-                        nodeList->writeDatagram(packet, packet.size(), node);
-                    }
-                }
 
-            } else {
-                // let processNodeData handle it.
-                nodeList->processNodeData(senderSockAddr, receivedPacket);
-            }
+    QByteArray mutePacket = packet;
+    populatePacketHeader(mutePacket, PacketTypeMuteEnvironment);
+
+    SharedNodePointer sendingNode = nodeList->sendingNodeForPacket(packet);
+
+    foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
+        if (node->getType() == NodeType::Agent && node->getActiveSocket() && node->getLinkedData() && node != sendingNode) {
+            nodeList->writeDatagram(mutePacket, mutePacket.size(), node);
         }
     }
 }
@@ -436,13 +435,22 @@ void AudioMixer::sendStatsPacket() {
     
     if (_sumListeners > 0) {
         statsObject["average_mixes_per_listener"] = (float) _sumMixes / (float) _sumListeners;
+        statsObject["average_encode_usecs_per_listener"] = (float) _sumEncodeUsecs / (float) _sumListeners;
+        statsObject["average_mix_bytes_per_listener"] = (float) _sumMixBytes / (float) _sumListeners;
     } else {
         statsObject["average_mixes_per_listener"] = 0.0;
+        statsObject["average_encode_usecs_per_listener"] = 0.0;
+        statsObject["average_mix_bytes_per_listener"] = 0.0;
     }
+    
+    statsObject["average_send_calls_per_frame"] = (float) _sumSendCalls / (float) _numStatFrames;
 
     ThreadedAssignment::addPacketStatsAndSendStatsPacket(statsObject);
     _sumListeners = 0;
     _sumMixes = 0;
+    _sumSendCalls = 0;
+    _sumEncodeUsecs = 0;
+    _sumMixBytes = 0;
     _numStatFrames = 0;
 
 
@@ -572,7 +580,8 @@ void AudioMixer::run() {
     QElapsedTimer timer;
     timer.start();
     
-    char* clientMixBuffer = new char[NETWORK_BUFFER_LENGTH_BYTES_STEREO + sizeof(quint16)
+    // none of the codecs encode a mix to more bytes than the samples take up
+    char* clientMixBuffer = new char[NETWORK_BUFFER_LENGTH_BYTES_STEREO + sizeof(quint16) + sizeof(AudioCodec_t)
                                      + numBytesForPacketHeaderGivenPacketType(PacketTypeMixedAudio)];
     
     int usecToSleep = BUFFER_SEND_INTERVAL_USECS;
@@ -648,6 +657,9 @@ void AudioMixer::run() {
             sendAudioStreamStats = true;
         }
 
+        // queue this frame's mixes and stats so they go out together once every listener has been mixed for
+        nodeList->beginDatagramBatch();
+        
         foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
             if (node->getType() == NodeType::Agent && node->getActiveSocket() && node->getLinkedData()
                 && ((AudioMixerClientData*) node->getLinkedData())->getAvatarAudioRingBuffer()) {
@@ -665,9 +677,18 @@ void AudioMixer::run() {
                 memcpy(dataAt, &sequence, sizeof(quint16));
                 dataAt += sizeof(quint16);
 
-                // pack mixed audio samples
-                memcpy(dataAt, _clientSamples, NETWORK_BUFFER_LENGTH_BYTES_STEREO);
-                dataAt += NETWORK_BUFFER_LENGTH_BYTES_STEREO;
+                // pack the codec, and the mixed audio samples encoded with it
+                AudioCodec_t codecType = nodeData->getOutgoingCodec();
+                memcpy(dataAt, &codecType, sizeof(AudioCodec_t));
+                dataAt += sizeof(AudioCodec_t);
+
+                quint64 encodeStart = usecTimestampNow();
+                int numEncodedBytes = AudioCodec::getCodec(codecType)->encode(_clientSamples,
+                                                                              NETWORK_BUFFER_LENGTH_SAMPLES_STEREO, 2,
+                                                                              dataAt);
+                _sumEncodeUsecs += usecTimestampNow() - encodeStart;
+                _sumMixBytes += numEncodedBytes;
+                dataAt += numEncodedBytes;
 
                 // send mixed audio packet
                 nodeList->writeDatagram(clientMixBuffer, dataAt - clientMixBuffer, node);
@@ -682,6 +703,9 @@ void AudioMixer::run() {
             }
         }
         
+        nodeList->flushDatagramBatch();
+        _sumSendCalls += nodeList->getDatagramBatch()->getNumSendCallsLastFlush();
+        
         // push forward the next output pointers for any audio buffers we used
         foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
             if (node->getLinkedData()) {
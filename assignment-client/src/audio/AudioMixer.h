@@ -40,6 +40,9 @@ public slots:
     static bool getUseDynamicJitterBuffers() { return _useDynamicJitterBuffers; }
 
 private:
+    void handleAudioDataPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleMuteEnvironmentPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+
     /// adds one buffer to the mix for a listening node
     void addBufferToMixForListeningNodeWithBuffer(PositionalAudioRingBuffer* bufferToAdd,
                                                   AvatarAudioRingBuffer* listeningNodeBuffer);
@@ -57,6 +60,9 @@ private:
     int _numStatFrames;
     int _sumListeners;
     int _sumMixes;
+    int _sumSendCalls;
+    quint64 _sumEncodeUsecs;
+    qint64 _sumMixBytes;
     AABox* _sourceUnattenuatedZone;
     AABox* _listenerUnattenuatedZone;
     static bool _useDynamicJitterBuffers;
@@ -49,6 +49,14 @@ AvatarAudioRingBuffer* AudioMixerClientData::getAvatarAudioRingBuffer() const {
     return NULL;
 }
 
+AudioCodec_t AudioMixerClientData::getOutgoingCodec() const {
+    AvatarAudioRingBuffer* avatarRingBuffer = getAvatarAudioRingBuffer();
+    if (avatarRingBuffer && AudioCodec::getCodec(avatarRingBuffer->getCodec())) {
+        return avatarRingBuffer->getCodec();
+    }
+    return AudioCodecType::PCM;
+}
+
 int AudioMixerClientData::parseData(const QByteArray& packet) {
 
     // parse sequence number for this packet
@@ -30,6 +30,9 @@ public:
     
     const QList<PositionalAudioRingBuffer*> getRingBuffers() const { return _ringBuffers; }
     AvatarAudioRingBuffer* getAvatarAudioRingBuffer() const;
+
+    /// the codec to send this listener's mix with, the one it sends its own audio with if we support it
+    AudioCodec_t getOutgoingCodec() const;
     
     int parseData(const QByteArray& packet);
     void checkBuffersBeforeFrameSend(AABox* checkSourceZone = NULL, AABox* listenerZone = NULL);
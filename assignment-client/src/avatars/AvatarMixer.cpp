@@ -38,10 +38,17 @@ AvatarMixer::AvatarMixer(const QByteArray& packet) :
     _sumListeners(0),
     _numStatFrames(0),
     _sumBillboardPackets(0),
-    _sumIdentityPackets(0)
+    _sumIdentityPackets(0),
+    _sumSendCalls(0)
 {
     // make sure we hear about node kills so we can tell the other nodes
     connect(NodeList::getInstance(), &NodeList::nodeKilled, this, &AvatarMixer::nodeKilled);
+
+    PacketDispatcher& packetDispatcher = getPacketDispatcher();
+    packetDispatcher.registerHandler(PacketTypeAvatarData, this, &AvatarMixer::handleAvatarDataPacket);
+    packetDispatcher.registerHandler(PacketTypeAvatarIdentity, this, &AvatarMixer::handleAvatarIdentityPacket);
+    packetDispatcher.registerHandler(PacketTypeAvatarBillboard, this, &AvatarMixer::handleAvatarBillboardPacket);
+    packetDispatcher.registerHandler(PacketTypeKillAvatar, this, &AvatarMixer::handleKillAvatarPacket);
 }
 
 AvatarMixer::~AvatarMixer() {
@@ -122,6 +129,9 @@ void AvatarMixer::broadcastAvatarData() {
     AvatarMixerClientData* nodeData = NULL;
     AvatarMixerClientData* otherNodeData = NULL;
     
+    // every listener gets at least one packet per frame, queue them all and hand them to the kernel together
+    nodeList->beginDatagramBatch();
+    
     foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
         if (node->getLinkedData() && node->getType() == NodeType::Agent && node->getActiveSocket()
             && (nodeData = reinterpret_cast<AvatarMixerClientData*>(node->getLinkedData()))->getMutex().tryLock()) {
@@ -211,6 +221,9 @@ void AvatarMixer::broadcastAvatarData() {
         }
     }
     
+    nodeList->flushDatagramBatch();
+    _sumSendCalls += nodeList->getDatagramBatch()->getNumSendCallsLastFlush();
+    
     _lastFrameTimestamp = QDateTime::currentMSecsSinceEpoch();
 }
 
@@ -228,72 +241,56 @@ void AvatarMixer::nodeKilled(SharedNodePointer killedNode) {
 }
 
 void AvatarMixer::readPendingDatagrams() {
-    QByteArray receivedPacket;
-    HifiSockAddr senderSockAddr;
+    getPacketDispatcher().processPendingDatagrams();
+}
+
+void AvatarMixer::handleAvatarDataPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    NodeList::getInstance()->findNodeAndUpdateWithDataFromPacket(packet);
+}
+
+void AvatarMixer::handleAvatarIdentityPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    // check if we have a matching node in our list
+    SharedNodePointer avatarNode = NodeList::getInstance()->sendingNodeForPacket(packet);
     
-    NodeList* nodeList = NodeList::getInstance();
+    if (avatarNode && avatarNode->getLinkedData()) {
+        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(avatarNode->getLinkedData());
+        AvatarData& avatar = nodeData->getAvatar();
+        
+        // parse the identity packet and update the change timestamp if appropriate
+        if (avatar.hasIdentityChangedAfterParsing(packet)) {
+            QMutexLocker nodeDataLocker(&nodeData->getMutex());
+            nodeData->setIdentityChangeTimestamp(QDateTime::currentMSecsSinceEpoch());
+        }
+    }
+}
+
+void AvatarMixer::handleAvatarBillboardPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    // check if we have a matching node in our list
+    SharedNodePointer avatarNode = NodeList::getInstance()->sendingNodeForPacket(packet);
     
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
-        if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
-            switch (packetTypeForPacket(receivedPacket)) {
-                case PacketTypeAvatarData: {
-                    nodeList->findNodeAndUpdateWithDataFromPacket(receivedPacket);
-                    break;
-                }
-                case PacketTypeAvatarIdentity: {
-                    
-                    // check if we have a matching node in our list
-                    SharedNodePointer avatarNode = nodeList->sendingNodeForPacket(receivedPacket);
-                    
-                    if (avatarNode && avatarNode->getLinkedData()) {
-                        AvatarMixerClientData* nodeData = reinterpret_cast<AvatarMixerClientData*>(avatarNode->getLinkedData());
-                        AvatarData& avatar = nodeData->getAvatar();
-                        
-                        // parse the identity packet and update the change timestamp if appropriate
-                        if (avatar.hasIdentityChangedAfterParsing(receivedPacket)) {
-                            QMutexLocker nodeDataLocker(&nodeData->getMutex());
-                            nodeData->setIdentityChangeTimestamp(QDateTime::currentMSecsSinceEpoch());
-                        }
-                    }
-                    break;
-                }
-                case PacketTypeAvatarBillboard: {
-                    
-                    // check if we have a matching node in our list
-                    SharedNodePointer avatarNode = nodeList->sendingNodeForPacket(receivedPacket);
-                    
-                    if (avatarNode && avatarNode->getLinkedData()) {
-                        AvatarMixerClientData* nodeData = static_cast<AvatarMixerClientData*>(avatarNode->getLinkedData());
-                        AvatarData& avatar = nodeData->getAvatar();
-                        
-                        // parse the billboard packet and update the change timestamp if appropriate
-                        if (avatar.hasBillboardChangedAfterParsing(receivedPacket)) {
-                            QMutexLocker nodeDataLocker(&nodeData->getMutex());
-                            nodeData->setBillboardChangeTimestamp(QDateTime::currentMSecsSinceEpoch());
-                        }
-                        
-                    }
-                    break;
-                }
-                case PacketTypeKillAvatar: {
-                    nodeList->processKillNode(receivedPacket);
-                    break;
-                }
-                default:
-                    // hand this off to the NodeList
-                    nodeList->processNodeData(senderSockAddr, receivedPacket);
-                    break;
-            }
+    if (avatarNode && avatarNode->getLinkedData()) {
+        AvatarMixerClientData* nodeData = static_cast<AvatarMixerClientData*>(avatarNode->getLinkedData());
+        AvatarData& avatar = nodeData->getAvatar();
+        
+        // parse the billboard packet and update the change timestamp if appropriate
+        if (avatar.hasBillboardChangedAfterParsing(packet)) {
+            QMutexLocker nodeDataLocker(&nodeData->getMutex());
+            nodeData->setBillboardChangeTimestamp(QDateTime::currentMSecsSinceEpoch());
         }
     }
 }
 
+void AvatarMixer::handleKillAvatarPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    NodeList::getInstance()->processKillNode(packet);
+}
+
 void AvatarMixer::sendStatsPacket() {
     QJsonObject statsObject;
     statsObject["average_listeners_last_second"] = (float) _sumListeners / (float) _numStatFrames;
     
     statsObject["average_billboard_packets_per_frame"] = (float) _sumBillboardPackets / (float) _numStatFrames;
     statsObject["average_identity_packets_per_frame"] = (float) _sumIdentityPackets / (float) _numStatFrames;
+    statsObject["average_send_calls_per_frame"] = (float) _sumSendCalls / (float) _numStatFrames;
     
     statsObject["trailing_sleep_percentage"] = _trailingSleepRatio * 100;
     statsObject["performance_throttling_ratio"] = _performanceThrottlingRatio;
@@ -303,6 +300,7 @@ void AvatarMixer::sendStatsPacket() {
     _sumListeners = 0;
     _sumBillboardPackets = 0;
     _sumIdentityPackets = 0;
+    _sumSendCalls = 0;
     _numStatFrames = 0;
 }
 
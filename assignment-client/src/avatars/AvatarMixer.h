@@ -35,6 +35,11 @@ public slots:
     
 private:
     void broadcastAvatarData();
+
+    void handleAvatarDataPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleAvatarIdentityPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleAvatarBillboardPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleKillAvatarPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
     
     QThread _broadcastThread;
     
@@ -47,6 +52,7 @@ private:
     int _numStatFrames;
     int _sumBillboardPackets;
     int _sumIdentityPackets;
+    int _sumSendCalls;
 };
 
 #endif // hifi_AvatarMixer_h
@@ -29,10 +29,16 @@ MetavoxelServer::MetavoxelServer(const QByteArray& packet) :
     
     _sendTimer.setSingleShot(true);
     connect(&_sendTimer, SIGNAL(timeout()), SLOT(sendDeltas()));
+
+    // the sessions hold on to the datagrams they're given, so they get their own copies
+    getPacketDispatcher().registerHandler(PacketTypeMetavoxelData, this, &MetavoxelServer::handleMetavoxelDataPacket, true);
 }
 
 void MetavoxelServer::applyEdit(const MetavoxelEditMessage& edit) {
-    edit.apply(_data, SharedObject::getWeakHash());
+    // edits copy what they change, so readers of the current version aren't affected until the new one is published
+    MetavoxelData data = _data.getSnapshot();
+    edit.apply(data, SharedObject::getWeakHash());
+    _data.publish(data);
 }
 
 const QString METAVOXEL_SERVER_LOGGING_NAME = "metavoxel-server";
@@ -62,28 +68,15 @@ void MetavoxelServer::run() {
 }
 
 void MetavoxelServer::readPendingDatagrams() {
-    QByteArray receivedPacket;
-    HifiSockAddr senderSockAddr;
-    
-    NodeList* nodeList = NodeList::getInstance();
-    
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
-        if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
-            switch (packetTypeForPacket(receivedPacket)) {
-                case PacketTypeMetavoxelData:
-                    nodeList->findNodeAndUpdateWithDataFromPacket(receivedPacket);
-                    break;
-                
-                default:
-                    nodeList->processNodeData(senderSockAddr, receivedPacket);
-                    break;
-            }
-        }
-    }
+    getPacketDispatcher().processPendingDatagrams();
+}
+
+void MetavoxelServer::handleMetavoxelDataPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    NodeList::getInstance()->findNodeAndUpdateWithDataFromPacket(packet);
 }
 
 void MetavoxelServer::aboutToFinish() {
-    QMetaObject::invokeMethod(_persister, "save", Q_ARG(const MetavoxelData&, _data));
+    QMetaObject::invokeMethod(_persister, "save", Q_ARG(const MetavoxelData&, getData()));
     _persister->thread()->quit();
     _persister->thread()->wait();
 }
@@ -133,11 +126,14 @@ void MetavoxelSession::update() {
         sendPacketGroup();
         return;
     }
+    // the delta and the records of the packets sent with it refer to the same version, whatever edits come in meanwhile
+    _sendData = _server->getData();
+    
     Bitstream& out = _sequencer.startPacket();
     int start = _sequencer.getOutputStream().getUnderlying().device()->pos(); 
     out << QVariant::fromValue(MetavoxelDeltaMessage());
     PacketRecord* sendRecord = getLastAcknowledgedSendRecord();
-    _server->getData().writeDelta(sendRecord->getData(), sendRecord->getLOD(), out, _lod);
+    _sendData.writeDelta(sendRecord->getData(), sendRecord->getLOD(), out, _lod);
     out.flush();
     int end = _sequencer.getOutputStream().getUnderlying().device()->pos();
     if (end > _sequencer.getMaxPacketSize()) {
@@ -149,7 +145,7 @@ void MetavoxelSession::update() {
         
         _reliableDeltaWriteMappings = out.getAndResetWriteMappings();
         _reliableDeltaReceivedOffset = _reliableDeltaChannel->getBytesWritten();
-        _reliableDeltaData = _server->getData();
+        _reliableDeltaData = _sendData;
         _reliableDeltaLOD = _lod;
         
         // go back to the beginning with the current packet and note that there's a delta pending
@@ -172,7 +168,7 @@ void MetavoxelSession::handleMessage(const QVariant& message, Bitstream& in) {
 
 PacketRecord* MetavoxelSession::maybeCreateSendRecord() const {
     return _reliableDeltaChannel ? new PacketRecord(_reliableDeltaLOD, _reliableDeltaData) :
-        new PacketRecord(_lod, _server->getData());
+        new PacketRecord(_lod, _sendData);
 }
 
 void MetavoxelSession::handleMessage(const QVariant& message) {
@@ -33,9 +33,10 @@ public:
 
     void applyEdit(const MetavoxelEditMessage& edit);
 
-    const MetavoxelData& getData() const { return _data; }
+    /// Returns a snapshot of the current version of the data, which may be kept and read from any thread.
+    MetavoxelData getData() const { return _data.getSnapshot(); }
     
-    Q_INVOKABLE void setData(const MetavoxelData& data) { _data = data; }
+    Q_INVOKABLE void setData(const MetavoxelData& data) { _data.publish(data); }
 
     virtual void run();
     
@@ -50,12 +51,14 @@ private slots:
     
 private:
     
+    void handleMetavoxelDataPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+
     MetavoxelPersister* _persister;
     
     QTimer _sendTimer;
     qint64 _lastSend;
     
-    MetavoxelData _data;
+    PublishedMetavoxelData _data;
 };
 
 /// Contains the state of a single client session.
@@ -86,6 +89,7 @@ private:
     MetavoxelServer* _server;
     
     MetavoxelLOD _lod;
+    MetavoxelData _sendData;
     
     ReliableChannel* _reliableDeltaChannel;
     int _reliableDeltaReceivedOffset;
@@ -102,7 +102,7 @@ int ModelServer::sendSpecialPacket(const SharedNodePointer& node, OctreeQueryNod
         packetsSent = 0;
         while (hasMoreToSend) {
             hasMoreToSend = tree->encodeModelsDeletedSince(queryNode->getSequenceNumber(), deletedModelsSentAt,
-                                                outputBuffer, MAX_PACKET_SIZE, packetLength);
+                                                outputBuffer, MAX_PACKET_SIZE, packetLength, &queryNode->itemDeltas);
 
             //qDebug() << "sending PacketType_MODEL_ERASE packetLength:" << packetLength;
 
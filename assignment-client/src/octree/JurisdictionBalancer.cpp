@@ -0,0 +1,714 @@
+//
+//  JurisdictionBalancer.cpp
+//  assignment-client/src/octree
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QSet>
+
+#include <NodeList.h>
+#include <OctalCode.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+#include <SubtreeHandoff.h>
+
+#include "OctreeServer.h"
+#include "JurisdictionBalancer.h"
+
+const int LOAD_CHECK_INTERVAL_MSECS = 1000;
+
+// the load is measured over this many checks before we decide whether to split
+const int CHECKS_PER_MEASURING_INTERVAL = 5;
+
+// a sibling we haven't heard a load report from in this long is not asked to take anything over
+const quint64 SIBLING_LOAD_TIMEOUT_USECS = 3 * USECS_PER_SECOND;
+
+// give the clients and edit senders time to follow a split before we consider the next one
+const quint64 SPLIT_COOLDOWN_USECS = 30 * USECS_PER_SECOND;
+
+// how many times the commit is sent before we give up on a standby that doesn't answer
+const int MAX_COMMITS_PER_HANDOFF = 10;
+
+// how long a standby holds edits for a subtree it took over while waiting for the catch-up chunks - a little longer
+// than the source keeps sending them
+const quint64 CATCH_UP_TIMEOUT_USECS = (MAX_COMMITS_PER_HANDOFF + 2) * LOAD_CHECK_INTERVAL_MSECS * USECS_PER_MSEC;
+
+// edits that reach us for a subtree we handed off are passed on for this long, the edit senders get the new
+// jurisdictions well within it
+const quint64 LATE_EDIT_FORWARDING_USECS = SPLIT_COOLDOWN_USECS;
+
+// room for the handoff message type, the handoff ID, the chunk index and count, the subtree code and the chunk size
+const int HANDOFF_DATA_OVERHEAD_BYTES = 64;
+const int MAX_HANDOFF_BITSTREAM_SIZE = MAX_PACKET_SIZE - MAX_PACKET_HEADER_BYTES - HANDOFF_DATA_OVERHEAD_BYTES;
+
+// keeps a resend request within one packet
+const int MAX_CHUNKS_PER_RESEND = 500;
+
+static QByteArray octalCodeBytes(const unsigned char* octalCode) {
+    return QByteArray(reinterpret_cast<const char*>(octalCode),
+                      bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(octalCode)));
+}
+
+static const unsigned char* octalCodeData(const QByteArray& octalCode) {
+    return reinterpret_cast<const unsigned char*>(octalCode.constData());
+}
+
+JurisdictionBalancer::JurisdictionBalancer(OctreeServer* server, float splitLoadThreshold) :
+    QObject(server),
+    _server(server),
+    _splitLoadThreshold(splitLoadThreshold),
+    _checkLoadTimer(this),
+    _checksSinceReset(0),
+    _lastSplitUsecs(0),
+    _siblingLoads(),
+    _isHandingOff(false),
+    _outgoing(),
+    _nextHandoffID(qrand()),
+    _isTakingOver(false),
+    _incoming(),
+    _lastAcceptedHandoffID(0),
+    _lastAcceptedSourceUUID(),
+    _receivedCatchUpChunks(),
+    _isCatchingUp(false),
+    _catchUpUntilUsecs(0),
+    _heldEdits(),
+    _heldEditsMutex(),
+    _handedOffSubtrees(),
+    _handedOffSubtreesMutex()
+{
+    connect(&_checkLoadTimer, &QTimer::timeout, this, &JurisdictionBalancer::checkLoad);
+    _checkLoadTimer.start(LOAD_CHECK_INTERVAL_MSECS);
+}
+
+void JurisdictionBalancer::checkLoad() {
+    sendLoadReport();
+
+    // keep asking until the standby accepts or has caught up, or we give up on it
+    if (_isHandingOff) {
+        sendCommit();
+    }
+
+    {
+        QMutexLocker locker(&_heldEditsMutex);
+        if (_isCatchingUp && usecTimestampNow() > _catchUpUntilUsecs) {
+            qDebug() << "JurisdictionBalancer: source" << _lastAcceptedSourceUUID << "did not finish catching us up on"
+                << "subtree" << _incoming.subtreeCode.toHex() << "- edits made during the handoff may be lost";
+            locker.unlock();
+            finishCatchingUp();
+        }
+    }
+
+    {
+        QMutexLocker locker(&_handedOffSubtreesMutex);
+        quint64 now = usecTimestampNow();
+        for (int i = _handedOffSubtrees.size() - 1; i >= 0; i--) {
+            if (now > _handedOffSubtrees[i].forwardUntilUsecs) {
+                _handedOffSubtrees.removeAt(i);
+            }
+        }
+    }
+
+    if (++_checksSinceReset < CHECKS_PER_MEASURING_INTERVAL) {
+        return;
+    }
+    _checksSinceReset = 0;
+
+    JurisdictionLoadTracker& loadTracker = _server->getLoadTracker();
+    if (!_isHandingOff && !_isTakingOver && loadTracker.getLoad() > _splitLoadThreshold
+            && usecTimestampNow() - _lastSplitUsecs > SPLIT_COOLDOWN_USECS) {
+        startHandoff();
+    }
+    loadTracker.reset();
+}
+
+void JurisdictionBalancer::sendLoadReport() {
+    JurisdictionMap* jurisdiction = _server->getJurisdiction();
+    quint8 isStandingBy = jurisdiction && jurisdiction->isEmpty() && !_isTakingOver;
+
+    QByteArray loadPacket = byteArrayWithPopulatedHeader(PacketTypeJurisdictionLoad);
+    QDataStream packetStream(&loadPacket, QIODevice::Append);
+    packetStream << _server->getLoadTracker().getLoad() << isStandingBy;
+
+    NodeList::getInstance()->broadcastToNodes(loadPacket, NodeSet() << (NodeType_t)_server->getMyNodeType());
+}
+
+bool JurisdictionBalancer::isSibling(const SharedNodePointer& node) const {
+    return node && node->getType() == _server->getMyNodeType();
+}
+
+void JurisdictionBalancer::processLoadReport(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    if (!isSibling(sendingNode)) {
+        return;
+    }
+
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    float load;
+    quint8 isStandingBy;
+    packetStream >> load >> isStandingBy;
+
+    SiblingLoad& sibling = _siblingLoads[sendingNode->getUUID()];
+    sibling.load = load;
+    sibling.isStandingBy = isStandingBy;
+    sibling.lastHeardUsecs = usecTimestampNow();
+}
+
+void JurisdictionBalancer::startHandoff() {
+    quint64 now = usecTimestampNow();
+
+    QUuid targetUUID;
+    QHash<QUuid, SiblingLoad>::const_iterator sibling = _siblingLoads.constBegin();
+    for (; sibling != _siblingLoads.constEnd(); sibling++) {
+        if (sibling.value().isStandingBy && now - sibling.value().lastHeardUsecs < SIBLING_LOAD_TIMEOUT_USECS) {
+            targetUUID = sibling.key();
+            break;
+        }
+    }
+
+    SharedNodePointer targetNode = NodeList::getInstance()->nodeWithUUID(targetUUID);
+    if (!targetNode) {
+        qDebug() << "JurisdictionBalancer: load is over the split threshold but there is no standby server to hand off to";
+        return;
+    }
+
+    float subtreeLoad = 0.0f;
+    QByteArray subtreeCode = _server->getLoadTracker().chooseSubtreeToHandOff(_server->getJurisdiction(), subtreeLoad);
+    if (subtreeCode.isEmpty()) {
+        return;
+    }
+
+    _outgoing.handoffID = _nextHandoffID++;
+    _outgoing.targetUUID = targetUUID;
+    _outgoing.subtreeCode = subtreeCode;
+    _outgoing.chunks = encodeSubtree(subtreeCode);
+    _outgoing.numCommitsSent = 0;
+    _outgoing.isCatchingUp = false;
+    _isHandingOff = true;
+    _lastSplitUsecs = now;
+
+    // another busy server might be looking at the same standby, it will turn one of us down
+    _siblingLoads[targetUUID].isStandingBy = false;
+
+    qDebug() << "JurisdictionBalancer: handing subtree" << subtreeCode.toHex() << "with" << subtreeLoad << "of"
+        << _server->getLoadTracker().getLoad() << "usecs/sec of load to" << targetUUID
+        << "in" << _outgoing.chunks.size() << "chunks";
+
+    for (int i = 0; i < _outgoing.chunks.size(); i++) {
+        sendChunk(targetNode, i);
+    }
+    sendCommit();
+}
+
+void JurisdictionBalancer::sendCommit() {
+    if (_outgoing.numCommitsSent >= MAX_COMMITS_PER_HANDOFF) {
+        if (_outgoing.isCatchingUp) {
+            // the subtree is theirs already, what they're missing are the edits made while it was being sent
+            qDebug() << "JurisdictionBalancer: standby" << _outgoing.targetUUID << "did not confirm catching up on"
+                << "subtree" << _outgoing.subtreeCode.toHex() << "- edits made during the handoff may be lost";
+            endHandoff();
+        } else {
+            qDebug() << "JurisdictionBalancer: standby" << _outgoing.targetUUID << "did not accept subtree"
+                << _outgoing.subtreeCode.toHex() << "- giving up";
+            abortHandoff();
+        }
+        return;
+    }
+    _outgoing.numCommitsSent++;
+
+    if (_outgoing.isCatchingUp) {
+        QByteArray commitPacket = handoffPacket(SubtreeHandoffMessage::CatchUpCommit, _outgoing.handoffID);
+        QDataStream packetStream(&commitPacket, QIODevice::Append);
+        packetStream << (quint16)_outgoing.chunks.size();
+
+        sendToSibling(commitPacket, _outgoing.targetUUID);
+        return;
+    }
+
+    // the standby stops at the same end nodes below the subtree that we stop at
+    QList<QByteArray> endNodes;
+    JurisdictionMap* jurisdiction = _server->getJurisdiction();
+    if (jurisdiction) {
+        for (int i = 0; i < jurisdiction->getEndNodeCount(); i++) {
+            const unsigned char* endNodeCode = jurisdiction->getEndNodeOctalCode(i);
+            if (isAncestorOf(octalCodeData(_outgoing.subtreeCode), endNodeCode)) {
+                endNodes << octalCodeBytes(endNodeCode);
+            }
+        }
+    }
+
+    QByteArray commitPacket = handoffPacket(SubtreeHandoffMessage::Commit, _outgoing.handoffID);
+    QDataStream packetStream(&commitPacket, QIODevice::Append);
+    packetStream << (quint16)_outgoing.chunks.size() << _outgoing.subtreeCode << endNodes;
+
+    sendToSibling(commitPacket, _outgoing.targetUUID);
+}
+
+void JurisdictionBalancer::abortHandoff() {
+    sendToSibling(handoffPacket(SubtreeHandoffMessage::Abort, _outgoing.handoffID), _outgoing.targetUUID);
+    endHandoff();
+}
+
+void JurisdictionBalancer::finishHandoff() {
+    QByteArray subtreeCode = _outgoing.subtreeCode;
+
+    // Encode the subtree once more, for the edits that came in while it was being handed off. This has to happen
+    // while the subtree is still part of our jurisdiction, since only what is within it gets encoded. The chunks are
+    // sent like the first ones, until the standby confirms it has them all.
+    _outgoing.chunks = encodeSubtree(subtreeCode);
+    _outgoing.numCommitsSent = 0;
+    _outgoing.isCatchingUp = true;
+
+    JurisdictionMap* jurisdiction = _server->getJurisdiction();
+    JurisdictionMap* newJurisdiction = jurisdiction
+        ? new JurisdictionMap(*jurisdiction) : new JurisdictionMap(_server->getMyNodeType());
+    newJurisdiction->addEndNode(octalCodeData(subtreeCode));
+    _server->setJurisdiction(newJurisdiction);
+
+    // from here on, the edits for the subtree that still reach us are passed on
+    {
+        QMutexLocker locker(&_handedOffSubtreesMutex);
+        HandedOffSubtree handedOff;
+        handedOff.targetUUID = _outgoing.targetUUID;
+        handedOff.subtreeCode = subtreeCode;
+        handedOff.forwardUntilUsecs = usecTimestampNow() + LATE_EDIT_FORWARDING_USECS;
+        _handedOffSubtrees << handedOff;
+    }
+
+    deleteSubtree(subtreeCode);
+
+    qDebug() << "JurisdictionBalancer: handed subtree" << subtreeCode.toHex() << "off to" << _outgoing.targetUUID
+        << "- catching it up in" << _outgoing.chunks.size() << "chunks";
+
+    SharedNodePointer targetNode = NodeList::getInstance()->nodeWithUUID(_outgoing.targetUUID);
+    if (targetNode) {
+        for (int i = 0; i < _outgoing.chunks.size(); i++) {
+            sendChunk(targetNode, i);
+        }
+    }
+    sendCommit();
+}
+
+void JurisdictionBalancer::endHandoff() {
+    _isHandingOff = false;
+    _outgoing.isCatchingUp = false;
+    _outgoing.chunks.clear();
+}
+
+void JurisdictionBalancer::processHandoffPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    // handing subtrees over and forwarding edits is between servers of the same type, anyone else could use it to take
+    // a jurisdiction over or make edits on behalf of others
+    if (!isSibling(sendingNode)) {
+        return;
+    }
+
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    SubtreeHandoffMessage_t message;
+    quint32 handoffID;
+    packetStream >> message >> handoffID;
+
+    bool isFromTarget = _isHandingOff && handoffID == _outgoing.handoffID
+        && sendingNode->getUUID() == _outgoing.targetUUID;
+    bool isFromSource = _isTakingOver && handoffID == _incoming.handoffID
+        && sendingNode->getUUID() == _incoming.sourceUUID;
+
+    if (message == SubtreeHandoffMessage::Data) {
+        processData(sendingNode, handoffID, packetStream);
+    } else if (message == SubtreeHandoffMessage::Commit) {
+        processCommit(sendingNode, handoffID, packetStream);
+    } else if (message == SubtreeHandoffMessage::Accept) {
+        // a commit we resent can be accepted again
+        if (isFromTarget && !_outgoing.isCatchingUp) {
+            finishHandoff();
+        }
+    } else if (message == SubtreeHandoffMessage::Resend) {
+        if (isFromTarget) {
+            processResend(sendingNode, packetStream);
+        }
+    } else if (message == SubtreeHandoffMessage::Abort) {
+        if (isFromTarget && !_outgoing.isCatchingUp) {
+            qDebug() << "JurisdictionBalancer: standby" << _outgoing.targetUUID << "turned subtree"
+                << _outgoing.subtreeCode.toHex() << "down";
+            endHandoff();
+        } else if (isFromSource) {
+            deleteSubtree(_incoming.subtreeCode);
+            _isTakingOver = false;
+        }
+    } else if (message == SubtreeHandoffMessage::CatchUpData) {
+        processCatchUpData(sendingNode, handoffID, packetStream);
+    } else if (message == SubtreeHandoffMessage::CatchUpCommit) {
+        processCatchUpCommit(sendingNode, handoffID, packetStream);
+    } else if (message == SubtreeHandoffMessage::CaughtUp) {
+        if (isFromTarget && _outgoing.isCatchingUp) {
+            qDebug() << "JurisdictionBalancer: standby" << _outgoing.targetUUID << "caught up on subtree"
+                << _outgoing.subtreeCode.toHex();
+            endHandoff();
+        }
+    } else if (message == SubtreeHandoffMessage::ForwardedEdit) {
+        processForwardedEdit(sendingNode, packetStream);
+    }
+}
+
+void JurisdictionBalancer::processData(const SharedNodePointer& sendingNode, quint32 handoffID, QDataStream& packetStream) {
+    quint16 chunkIndex;
+    quint16 numChunks;
+    QByteArray subtreeCode;
+    QByteArray bitstream;
+    packetStream >> chunkIndex >> numChunks >> subtreeCode >> bitstream;
+
+    if (!_isTakingOver) {
+        // only a server that is standing by takes a subtree over. Chunks of the handoff we already accepted are late,
+        // and older than what the source caught us up with.
+        JurisdictionMap* jurisdiction = _server->getJurisdiction();
+        if (!jurisdiction || !jurisdiction->isEmpty()) {
+            return;
+        }
+        _isTakingOver = true;
+        _incoming.handoffID = handoffID;
+        _incoming.sourceUUID = sendingNode->getUUID();
+        _incoming.subtreeCode = subtreeCode;
+        _incoming.receivedChunks.fill(false, numChunks);
+    } else if (handoffID != _incoming.handoffID || sendingNode->getUUID() != _incoming.sourceUUID) {
+        // we're already taking over from someone else, they'll hear so when they commit
+        return;
+    }
+
+    if (chunkIndex >= _incoming.receivedChunks.size()) {
+        return;
+    }
+    _incoming.receivedChunks[chunkIndex] = true;
+
+    SubtreeHandoff::readChunk(_server->getOctree(), bitstream, sendingNode);
+}
+
+void JurisdictionBalancer::processCommit(const SharedNodePointer& sendingNode, quint32 handoffID,
+                                         QDataStream& packetStream) {
+    quint16 numChunks;
+    QByteArray subtreeCode;
+    QList<QByteArray> endNodes;
+    packetStream >> numChunks >> subtreeCode >> endNodes;
+
+    QUuid sourceUUID = sendingNode->getUUID();
+
+    if (handoffID == _lastAcceptedHandoffID && sourceUUID == _lastAcceptedSourceUUID) {
+        // our accept got lost
+        sendToSibling(handoffPacket(SubtreeHandoffMessage::Accept, handoffID), sourceUUID);
+        return;
+    }
+
+    if (!_isTakingOver) {
+        // the subtree might have been empty, in which case there were no chunks to start the handoff with
+        JurisdictionMap* jurisdiction = _server->getJurisdiction();
+        if (jurisdiction && jurisdiction->isEmpty()) {
+            _isTakingOver = true;
+            _incoming.handoffID = handoffID;
+            _incoming.sourceUUID = sourceUUID;
+            _incoming.subtreeCode = subtreeCode;
+            _incoming.receivedChunks.fill(false, numChunks);
+        }
+    }
+
+    if (!_isTakingOver || handoffID != _incoming.handoffID || sourceUUID != _incoming.sourceUUID) {
+        sendToSibling(handoffPacket(SubtreeHandoffMessage::Abort, handoffID), sourceUUID);
+        return;
+    }
+
+    QVector<quint16> missing = missingChunks(_incoming.receivedChunks);
+    if (!missing.isEmpty()) {
+        QByteArray resendPacket = handoffPacket(SubtreeHandoffMessage::Resend, handoffID);
+        QDataStream resendStream(&resendPacket, QIODevice::Append);
+        resendStream << missing;
+        sendToSibling(resendPacket, sourceUUID);
+        return;
+    }
+
+    // we have the whole subtree, make it our jurisdiction
+    unsigned char* rootCode = new unsigned char[subtreeCode.size()];
+    memcpy(rootCode, subtreeCode.constData(), subtreeCode.size());
+
+    std::vector<unsigned char*> endNodeCodes;
+    foreach (const QByteArray& endNode, endNodes) {
+        if (isAncestorOf(rootCode, octalCodeData(endNode))) {
+            unsigned char* endNodeCode = new unsigned char[endNode.size()];
+            memcpy(endNodeCode, endNode.constData(), endNode.size());
+            endNodeCodes.push_back(endNodeCode);
+        }
+    }
+
+    JurisdictionMap* newJurisdiction = new JurisdictionMap(rootCode, endNodeCodes);
+    newJurisdiction->setNodeType(_server->getMyNodeType());
+    _server->setJurisdiction(newJurisdiction);
+
+    qDebug() << "JurisdictionBalancer: took subtree" << subtreeCode.toHex() << "over from" << sourceUUID;
+
+    _isTakingOver = false;
+    _lastAcceptedHandoffID = handoffID;
+    _lastAcceptedSourceUUID = sourceUUID;
+    _incoming.receivedChunks.clear();
+    _receivedCatchUpChunks.clear();
+
+    // the edits for the subtree that reach us from now on are newer than the catch-up data, hold them until we have it
+    {
+        QMutexLocker locker(&_heldEditsMutex);
+        _isCatchingUp = true;
+        _catchUpUntilUsecs = usecTimestampNow() + CATCH_UP_TIMEOUT_USECS;
+    }
+
+    sendToSibling(handoffPacket(SubtreeHandoffMessage::Accept, handoffID), sourceUUID);
+}
+
+void JurisdictionBalancer::processResend(const SharedNodePointer& sendingNode, QDataStream& packetStream) {
+    QVector<quint16> missingChunks;
+    packetStream >> missingChunks;
+
+    foreach (quint16 chunkIndex, missingChunks) {
+        if (chunkIndex < _outgoing.chunks.size()) {
+            sendChunk(sendingNode, chunkIndex);
+        }
+    }
+}
+
+void JurisdictionBalancer::processCatchUpData(const SharedNodePointer& sendingNode, quint32 handoffID,
+                                              QDataStream& packetStream) {
+    quint16 chunkIndex;
+    quint16 numChunks;
+    QByteArray subtreeCode;
+    QByteArray bitstream;
+    packetStream >> chunkIndex >> numChunks >> subtreeCode >> bitstream;
+
+    if (handoffID != _lastAcceptedHandoffID || sendingNode->getUUID() != _lastAcceptedSourceUUID) {
+        return;
+    }
+    {
+        // once we're caught up, the edits we made since are newer than anything a late chunk brings
+        QMutexLocker locker(&_heldEditsMutex);
+        if (!_isCatchingUp) {
+            return;
+        }
+    }
+    if (_receivedCatchUpChunks.size() != numChunks) {
+        _receivedCatchUpChunks.fill(false, numChunks);
+    }
+    if (chunkIndex >= _receivedCatchUpChunks.size()) {
+        return;
+    }
+    _receivedCatchUpChunks[chunkIndex] = true;
+
+    SubtreeHandoff::readChunk(_server->getOctree(), bitstream, sendingNode);
+}
+
+void JurisdictionBalancer::processCatchUpCommit(const SharedNodePointer& sendingNode, quint32 handoffID,
+                                                QDataStream& packetStream) {
+    quint16 numChunks;
+    packetStream >> numChunks;
+
+    QUuid sourceUUID = sendingNode->getUUID();
+    if (handoffID != _lastAcceptedHandoffID || sourceUUID != _lastAcceptedSourceUUID) {
+        return;
+    }
+
+    bool isCatchingUp;
+    {
+        QMutexLocker locker(&_heldEditsMutex);
+        isCatchingUp = _isCatchingUp;
+    }
+
+    // if we are caught up already, our answer got lost
+    if (isCatchingUp) {
+        if (_receivedCatchUpChunks.size() != numChunks) {
+            _receivedCatchUpChunks.fill(false, numChunks);
+        }
+
+        QVector<quint16> missing = missingChunks(_receivedCatchUpChunks);
+        if (!missing.isEmpty()) {
+            QByteArray resendPacket = handoffPacket(SubtreeHandoffMessage::Resend, handoffID);
+            QDataStream resendStream(&resendPacket, QIODevice::Append);
+            resendStream << missing;
+            sendToSibling(resendPacket, sourceUUID);
+            return;
+        }
+
+        finishCatchingUp();
+    }
+
+    sendToSibling(handoffPacket(SubtreeHandoffMessage::CaughtUp, handoffID), sourceUUID);
+}
+
+bool JurisdictionBalancer::holdEditWhileCatchingUp(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    QMutexLocker locker(&_heldEditsMutex);
+    if (!_isCatchingUp) {
+        return false;
+    }
+
+    HeldEdit heldEdit;
+    heldEdit.sendingNode = sendingNode;
+    heldEdit.packet = packet;
+    _heldEdits << heldEdit;
+    return true;
+}
+
+void JurisdictionBalancer::finishCatchingUp() {
+    // the inbound packet processor waits for us while we process the held edits, so the edits it gets after them
+    // are not made before them
+    QMutexLocker locker(&_heldEditsMutex);
+    if (!_isCatchingUp) {
+        return;
+    }
+
+    qDebug() << "JurisdictionBalancer: caught up on subtree" << _incoming.subtreeCode.toHex() << "- processing"
+        << _heldEdits.size() << "edit packets that came in meanwhile";
+
+    foreach (const HeldEdit& heldEdit, _heldEdits) {
+        processEditPacket(heldEdit.sendingNode, heldEdit.packet);
+    }
+    _heldEdits.clear();
+    _isCatchingUp = false;
+}
+
+void JurisdictionBalancer::forwardLateEdit(const SharedNodePointer& sendingNode, const QByteArray& packet) {
+    QList<HandedOffSubtree> handedOffSubtrees;
+    {
+        QMutexLocker locker(&_handedOffSubtreesMutex);
+        if (_handedOffSubtrees.isEmpty()) {
+            return;
+        }
+        handedOffSubtrees = _handedOffSubtrees;
+    }
+
+    // we can't tell which edits in the packet are for which subtree without knowing the edit format, so the whole
+    // packet goes to every server we handed off to lately, and each drops what isn't in its jurisdiction
+    QByteArray forwardPacket = handoffPacket(SubtreeHandoffMessage::ForwardedEdit, 0);
+    QDataStream packetStream(&forwardPacket, QIODevice::Append);
+    packetStream << (sendingNode ? sendingNode->getUUID() : QUuid()) << (quint8)packetTypeForPacket(packet)
+        << packet.mid(numBytesForPacketHeader(packet));
+
+    QSet<QUuid> targets;
+    foreach (const HandedOffSubtree& handedOff, handedOffSubtrees) {
+        if (!targets.contains(handedOff.targetUUID)) {
+            targets.insert(handedOff.targetUUID);
+            sendToSibling(forwardPacket, handedOff.targetUUID);
+        }
+        SubtreeHandoff::deleteSubtree(_server->getOctree(), octalCodeData(handedOff.subtreeCode));
+    }
+}
+
+void JurisdictionBalancer::processForwardedEdit(const SharedNodePointer& sendingNode, QDataStream& packetStream) {
+    QUuid editSenderUUID;
+    quint8 packetType;
+    QByteArray payload;
+    packetStream >> editSenderUUID >> packetType >> payload;
+
+    // edits outside our jurisdiction get trimmed away below, which would take a subtree we're taking over with them
+    JurisdictionMap* jurisdiction = _server->getJurisdiction();
+    if (_isTakingOver || !jurisdiction || jurisdiction->isEmpty()
+            || !_server->getOctree()->handlesEditPacketType((PacketType)packetType)) {
+        return;
+    }
+
+    // the edit is made on behalf of whoever sent it to the source, so that replies go to them
+    SharedNodePointer editSender = NodeList::getInstance()->nodeWithUUID(editSenderUUID);
+    if (!editSender) {
+        editSender = sendingNode;
+    }
+
+    QByteArray editPacket = byteArrayWithPopulatedHeader((PacketType)packetType) + payload;
+    if (!holdEditWhileCatchingUp(editSender, editPacket)) {
+        processEditPacket(editSender, editPacket);
+    }
+}
+
+void JurisdictionBalancer::processEditPacket(const SharedNodePointer& editSender, const QByteArray& editPacket) {
+    JurisdictionMap* jurisdiction = _server->getJurisdiction();
+    Octree* tree = _server->getOctree();
+    PacketType packetType = packetTypeForPacket(editPacket);
+    const unsigned char* packetData = reinterpret_cast<const unsigned char*>(editPacket.constData());
+
+    // skip the sequence number and the time the edits were sent at, like the inbound packet processor does
+    int atByte = numBytesForPacketHeader(editPacket) + sizeof(unsigned short int) + sizeof(quint64);
+    while (atByte < editPacket.size()) {
+        tree->lockForWrite();
+        int editDataBytesRead = tree->processEditPacketData(packetType, packetData, editPacket.size(),
+                                                            packetData + atByte, editPacket.size() - atByte, editSender);
+        tree->unlock();
+
+        if (editDataBytesRead <= 0) {
+            break;
+        }
+        atByte += editDataBytesRead;
+    }
+
+    if (jurisdiction) {
+        SubtreeHandoff::trimToJurisdiction(tree, *jurisdiction);
+    }
+}
+
+QVector<quint16> JurisdictionBalancer::missingChunks(const QVector<bool>& receivedChunks) {
+    QVector<quint16> missing;
+    for (int i = 0; i < receivedChunks.size() && missing.size() < MAX_CHUNKS_PER_RESEND; i++) {
+        if (!receivedChunks[i]) {
+            missing << i;
+        }
+    }
+    return missing;
+}
+
+QVector<QByteArray> JurisdictionBalancer::encodeSubtree(const QByteArray& subtreeCode) {
+    return SubtreeHandoff::encodeSubtree(_server->getOctree(), octalCodeData(subtreeCode), _server->getJurisdiction(),
+                                         MAX_HANDOFF_BITSTREAM_SIZE);
+}
+
+void JurisdictionBalancer::sendChunk(const SharedNodePointer& targetNode, quint16 chunkIndex) {
+    SubtreeHandoffMessage_t message = _outgoing.isCatchingUp
+        ? SubtreeHandoffMessage::CatchUpData : SubtreeHandoffMessage::Data;
+    QByteArray dataPacket = handoffPacket(message, _outgoing.handoffID);
+    QDataStream packetStream(&dataPacket, QIODevice::Append);
+    packetStream << chunkIndex << (quint16)_outgoing.chunks.size() << _outgoing.subtreeCode << _outgoing.chunks[chunkIndex];
+
+    NodeList::getInstance()->writeDatagram(dataPacket, targetNode);
+}
+
+void JurisdictionBalancer::deleteSubtree(const QByteArray& subtreeCode) {
+    SubtreeHandoff::deleteSubtree(_server->getOctree(), octalCodeData(subtreeCode));
+}
+
+QByteArray JurisdictionBalancer::handoffPacket(SubtreeHandoffMessage_t message, quint32 handoffID) {
+    QByteArray handoffPacket = byteArrayWithPopulatedHeader(PacketTypeSubtreeHandoff);
+    QDataStream packetStream(&handoffPacket, QIODevice::Append);
+    packetStream << message << handoffID;
+    return handoffPacket;
+}
+
+void JurisdictionBalancer::sendToSibling(const QByteArray& packet, const QUuid& siblingUUID) {
+    SharedNodePointer siblingNode = NodeList::getInstance()->nodeWithUUID(siblingUUID);
+    if (siblingNode) {
+        NodeList::getInstance()->writeDatagram(packet, siblingNode);
+    }
+}
+
+void JurisdictionBalancer::nodeKilled(SharedNodePointer node) {
+    _siblingLoads.remove(node->getUUID());
+
+    if (_isHandingOff && node->getUUID() == _outgoing.targetUUID) {
+        qDebug() << "JurisdictionBalancer: standby" << _outgoing.targetUUID << "went away during the handoff";
+        endHandoff();
+    }
+
+    if (_isTakingOver && node->getUUID() == _incoming.sourceUUID) {
+        deleteSubtree(_incoming.subtreeCode);
+        _isTakingOver = false;
+    }
+
+    // the catch-up data won't come anymore
+    if (node->getUUID() == _lastAcceptedSourceUUID) {
+        finishCatchingUp();
+    }
+}
@@ -0,0 +1,178 @@
+//
+//  JurisdictionBalancer.h
+//  assignment-client/src/octree
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JurisdictionBalancer_h
+#define hifi_JurisdictionBalancer_h
+
+#include <QtCore/QDataStream>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtCore/QUuid>
+#include <QtCore/QVector>
+
+#include <Node.h>
+
+class OctreeServer;
+
+/// the default work an octree server does for its clients before it hands part of its jurisdiction off, in usecs of
+/// encoding and edit processing per second
+const float DEFAULT_SPLIT_LOAD_THRESHOLD = 500000.0f;
+
+typedef quint8 SubtreeHandoffMessage_t;
+namespace SubtreeHandoffMessage {
+    const SubtreeHandoffMessage_t Data = 0;             // one chunk of the subtree's bitstream
+    const SubtreeHandoffMessage_t Commit = 1;           // all chunks were sent, take the subtree over if you have them all
+    const SubtreeHandoffMessage_t Accept = 2;           // the subtree was taken over, stop serving it
+    const SubtreeHandoffMessage_t Resend = 3;           // some chunks are missing, send them again
+    const SubtreeHandoffMessage_t Abort = 4;            // the handoff is off, forget the chunks
+    const SubtreeHandoffMessage_t CatchUpData = 5;      // one chunk of the subtree as it was when it was handed off
+    const SubtreeHandoffMessage_t CatchUpCommit = 6;    // all catch-up chunks were sent
+    const SubtreeHandoffMessage_t CaughtUp = 7;         // all catch-up chunks were received
+    const SubtreeHandoffMessage_t ForwardedEdit = 8;    // an edit packet that came in after the handoff
+}
+
+/// Splits the jurisdiction of a busy octree server with a sibling server that is standing by, by handing it the busiest
+/// subtree of the jurisdiction along with the voxels, particles or models in it.
+///
+/// Every server of the same type reports its load to its siblings once a second. When a server has done more work
+/// than the split threshold over a measuring interval, it sends the chosen subtree to a standby server in chunks and
+/// asks it to commit. The standby takes the subtree as its jurisdiction once it has all the chunks, after which the
+/// busy server adds the subtree to its end nodes and drops it from its tree. Both servers publish their new
+/// jurisdictions to their listeners, so edits and queries follow the split, and save them next to their persist files.
+///
+/// The edits that came in while the subtree was being sent are caught up on by sending it once more, until the standby
+/// confirms it has all of it. Edits that reach the busy server after that, from senders that don't know about the split
+/// yet, are forwarded to the standby for a while. The standby holds the edits it gets while it is catching up and makes
+/// them once it is caught up, so the older catch-up data never overwrites them.
+///
+/// Only servers of our own type take part: load reports and handoff messages from any other node are ignored.
+class JurisdictionBalancer : public QObject {
+    Q_OBJECT
+public:
+    JurisdictionBalancer(OctreeServer* server, float splitLoadThreshold);
+
+    void processLoadReport(const SharedNodePointer& sendingNode, const QByteArray& packet);
+    void processHandoffPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
+
+    /// forwards an edit packet that was processed by us to the servers we recently handed a subtree off to, and drops
+    /// what it put in those subtrees. Called from the inbound packet processor thread.
+    void forwardLateEdit(const SharedNodePointer& sendingNode, const QByteArray& packet);
+
+    /// keeps an edit packet that reached us while we're catching up on a subtree we took over, to be processed once we
+    /// are caught up. Returns false, keeping nothing, when we are not catching up. Called from the inbound packet
+    /// processor thread.
+    bool holdEditWhileCatchingUp(const SharedNodePointer& sendingNode, const QByteArray& packet);
+
+public slots:
+    void nodeKilled(SharedNodePointer node);
+
+private slots:
+    void checkLoad();
+
+private:
+    struct SiblingLoad {
+        float load;
+        bool isStandingBy;
+        quint64 lastHeardUsecs;
+    };
+
+    struct OutgoingHandoff {
+        quint32 handoffID;
+        QUuid targetUUID;
+        QByteArray subtreeCode;
+        QVector<QByteArray> chunks;
+        int numCommitsSent;
+        bool isCatchingUp;
+    };
+
+    struct IncomingHandoff {
+        quint32 handoffID;
+        QUuid sourceUUID;
+        QByteArray subtreeCode;
+        QVector<bool> receivedChunks;
+    };
+
+    struct HandedOffSubtree {
+        QUuid targetUUID;
+        QByteArray subtreeCode;
+        quint64 forwardUntilUsecs;
+    };
+
+    struct HeldEdit {
+        SharedNodePointer sendingNode;
+        QByteArray packet;
+    };
+
+    void sendLoadReport();
+    void startHandoff();
+    void sendCommit();
+    void abortHandoff();
+    void finishHandoff();
+    void endHandoff();
+
+    void processData(const SharedNodePointer& sendingNode, quint32 handoffID, QDataStream& stream);
+    void processCommit(const SharedNodePointer& sendingNode, quint32 handoffID, QDataStream& stream);
+    void processResend(const SharedNodePointer& sendingNode, QDataStream& stream);
+    void processCatchUpData(const SharedNodePointer& sendingNode, quint32 handoffID, QDataStream& stream);
+    void processCatchUpCommit(const SharedNodePointer& sendingNode, quint32 handoffID, QDataStream& stream);
+    void processForwardedEdit(const SharedNodePointer& sendingNode, QDataStream& stream);
+
+    /// whether the node is a sibling server, that is another server of our type
+    bool isSibling(const SharedNodePointer& node) const;
+
+    /// processes the edits that were held while catching up, in the order they came in, and stops holding them
+    void finishCatchingUp();
+    void processEditPacket(const SharedNodePointer& editSender, const QByteArray& editPacket);
+
+    /// the chunks that are missing, at most as many as fit a resend request
+    static QVector<quint16> missingChunks(const QVector<bool>& receivedChunks);
+
+    /// encodes the part of the subtree that is within our jurisdiction into bitstream chunks that each fit a packet
+    QVector<QByteArray> encodeSubtree(const QByteArray& subtreeCode);
+    void sendChunk(const SharedNodePointer& targetNode, quint16 chunkIndex);
+    void deleteSubtree(const QByteArray& subtreeCode);
+
+    QByteArray handoffPacket(SubtreeHandoffMessage_t message, quint32 handoffID);
+    void sendToSibling(const QByteArray& packet, const QUuid& siblingUUID);
+
+    OctreeServer* _server;
+    float _splitLoadThreshold;
+    QTimer _checkLoadTimer;
+    int _checksSinceReset;
+    quint64 _lastSplitUsecs;
+
+    QHash<QUuid, SiblingLoad> _siblingLoads;
+
+    bool _isHandingOff;
+    OutgoingHandoff _outgoing;
+    quint32 _nextHandoffID;
+
+    bool _isTakingOver;
+    IncomingHandoff _incoming;
+    quint32 _lastAcceptedHandoffID;
+    QUuid _lastAcceptedSourceUUID;
+    QVector<bool> _receivedCatchUpChunks;
+
+    // also used by the inbound packet processor thread, so guarded by _heldEditsMutex
+    bool _isCatchingUp;
+    quint64 _catchUpUntilUsecs;
+    QList<HeldEdit> _heldEdits;
+    QMutex _heldEditsMutex;
+
+    // also used by the inbound packet processor thread, so guarded by _handedOffSubtreesMutex
+    QList<HandedOffSubtree> _handedOffSubtrees;
+    QMutex _handedOffSubtreesMutex;
+};
+
+#endif // hifi_JurisdictionBalancer_h
@@ -110,6 +110,11 @@ void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendin
         }
         int atByte = numBytesPacketHeader + sizeof(sequence) + sizeof(sentAt);
         unsigned char* editData = (unsigned char*)&packetData[atByte];
+
+        // edits for a subtree we're still being caught up on are made once we are, after the older catch-up data
+        if (_myServer->holdEditWhileCatchingUp(sendingNode, packet)) {
+            atByte = packet.size();
+        }
         while (atByte < packet.size()) {
             int maxSize = packet.size() - atByte;
 
@@ -160,6 +165,14 @@ void OctreeInboundPacketProcessor::processPacket(const SharedNodePointer& sendin
             }
         }
         trackInboundPacket(nodeUUID, sequence, transitTime, editsInPacket, processTime, lockWaitTime);
+
+        // edits are charged to the part of the jurisdiction the sender is looking at
+        if (sendingNode && sendingNode->getLinkedData()) {
+            OctreeQueryNode* nodeData = static_cast<OctreeQueryNode*>(sendingNode->getLinkedData());
+            _myServer->trackSubtreeLoad(nodeData->getCameraPosition(), (float)processTime);
+        }
+
+        _myServer->forwardLateEdit(sendingNode, packet);
     } else {
         qDebug("unknown packet ignored... packetType=%d", packetType);
     }
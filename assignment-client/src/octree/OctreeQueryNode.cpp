@@ -29,6 +29,8 @@ OctreeQueryNode::OctreeQueryNode() :
     _maxSearchLevel(1),
     _maxLevelReachedInLastSearch(1),
     _lastTimeBagEmpty(0),
+    _lastItemDeltasReset(usecTimestampNow()),
+    _resendAllElements(false),
     _viewFrustumChanging(false),
     _viewFrustumJustStoppedChanging(true),
     _currentPacketIsColor(true),
@@ -176,6 +178,11 @@ void OctreeQueryNode::resetOctreePacket() {
     _lastOctreePacketLength = getPacketLength();
     memcpy(_lastOctreePacket, _octreePacket, _lastOctreePacketLength);
 
+    // items in a packet that goes away unsent haven't been sent
+    if (_octreePacketWaiting) {
+        itemDeltas.packetDropped();
+    }
+
     // If we're moving, and the client asked for low res, then we force monochrome, otherwise, use
     // the clients requested color state.
     _currentPacketIsColor = getWantColor();
@@ -342,6 +349,9 @@ void OctreeQueryNode::dumpOutOfView() {
         return;
     }
     
+    // items that went out of view leave the item deltas too, and are sent whole when they come back into view
+    itemDeltas.forgetItemsOutside(_currentViewFrustum);
+
     int stillInView = 0;
     int outOfView = 0;
     OctreeElementBag tempBag;
@@ -365,9 +375,16 @@ void OctreeQueryNode::dumpOutOfView() {
 }
 
 void OctreeQueryNode::octreePacketSent() {
+    itemDeltas.packetSent();
     packetSent(_octreePacket, getPacketLength());
 }
 
+void OctreeQueryNode::resetItemDeltas() {
+    itemDeltas.reset();
+    _lastItemDeltasReset = usecTimestampNow();
+    _resendAllElements = true;
+}
+
 void OctreeQueryNode::packetSent(unsigned char* packet, int packetLength) {
     packetSent(QByteArray((char*)packet, packetLength));
 }
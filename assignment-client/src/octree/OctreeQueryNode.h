@@ -19,6 +19,7 @@
 #include <NodeData.h>
 #include <OctreeConstants.h>
 #include <OctreeElementBag.h>
+#include <OctreeItemDeltas.h>
 #include <OctreePacketData.h>
 #include <OctreeQuery.h>
 #include <OctreeSceneStats.h>
@@ -58,6 +59,14 @@ public:
 
     OctreeElementBag nodeBag;
     CoverageMap map;
+    OctreeItemDeltas itemDeltas;
+
+    /// Forgets what the client has been sent of the items of elements, when it may have missed some of it, so that the
+    /// next scene sends all elements with all of their items.
+    void resetItemDeltas();
+    quint64 getLastItemDeltasReset() const { return _lastItemDeltasReset; }
+    bool getResendAllElements() const { return _resendAllElements; }
+    void setResendAllElements(bool resendAllElements) { _resendAllElements = resendAllElements; }
 
     ViewFrustum& getCurrentViewFrustum() { return _currentViewFrustum; }
     ViewFrustum& getLastKnownViewFrustum() { return _lastKnownViewFrustum; }
@@ -135,6 +144,8 @@ private:
     ViewFrustum _currentViewFrustum;
     ViewFrustum _lastKnownViewFrustum;
     quint64 _lastTimeBagEmpty;
+    quint64 _lastItemDeltasReset;
+    bool _resendAllElements;
     bool _viewFrustumChanging;
     bool _viewFrustumJustStoppedChanging;
     bool _currentPacketIsColor;
@@ -84,7 +84,11 @@ bool OctreeSendThread::process() {
             // Sometimes the node data has not yet been linked, in which case we can't really do anything
             if (nodeData && !nodeData->isShuttingDown()) {
                 bool viewFrustumChanged = nodeData->updateCurrentViewFrustum();
+                
+                // each send thread has its own batch, so this interval's burst goes out in a few system calls
+                NodeList::getInstance()->beginDatagramBatch();
                 packetDistributor(nodeData, viewFrustumChanged);
+                NodeList::getInstance()->flushDatagramBatch();
             }
         }
     }
@@ -347,6 +351,20 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
             nodeData->setLastTimeBagEmpty(now);
         }
 
+        // Deltas are only right while the client has everything it was counted as having been sent. Clients that
+        // don't NACK get whole items, and for the rest a keyframe every so often makes up for a lost last packet or a
+        // lost NACK, which nothing else would notice.
+        if (!nodeData->itemDeltas.isEmpty() && (!nodeData->getWantItemDeltas() ||
+                usecTimestampNow() - nodeData->getLastItemDeltasReset() > ITEM_DELTAS_KEYFRAME_INTERVAL_USECS)) {
+            nodeData->resetItemDeltas();
+        }
+
+        // after the item deltas were reset, every element goes out again, with all of its items
+        if (nodeData->getResendAllElements()) {
+            nodeData->setLastTimeBagEmpty(0);
+            nodeData->setResendAllElements(false);
+        }
+
         // track completed scenes and send out the stats packet accordingly
         nodeData->stats.sceneCompleted();
         nodeData->setLastRootTimestamp(_myServer->getOctree()->getRoot()->getLastChanged());
@@ -429,6 +447,8 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
                 bool wantOcclusionCulling = nodeData->getWantOcclusionCulling();
                 CoverageMap* coverageMap = wantOcclusionCulling ? &nodeData->map : IGNORE_COVERAGE_MAP;
                 
+                OctreeItemDeltas* itemDeltas = nodeData->getWantItemDeltas() ? &nodeData->itemDeltas : IGNORE_ITEM_DELTAS;
+
                 float voxelSizeScale = nodeData->getOctreeSizeScale();
                 int boundaryLevelAdjustClient = nodeData->getBoundaryLevelAdjust();
                 
@@ -439,7 +459,7 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
                                              WANT_EXISTS_BITS, DONT_CHOP, wantDelta, lastViewFrustum,
                                              wantOcclusionCulling, coverageMap, boundaryLevelAdjust, voxelSizeScale,
                                              nodeData->getLastTimeBagEmpty(),
-                                             isFullScene, &nodeData->stats, _myServer->getJurisdiction());
+                                             isFullScene, &nodeData->stats, _myServer->getJurisdiction(), itemDeltas);
 
                 // TODO: should this include the lock time or not? This stat is sent down to the client,
                 // it seems like it may be a good idea to include the lock time as part of the encode time
@@ -509,6 +529,7 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
                     }
 
                     nodeData->writeToPacket(_packetData.getFinalizedData(), _packetData.getFinalizedSize());
+                    nodeData->itemDeltas.sectionWritten(&_packetData);
                     extraPackingAttempts = 0;
                     quint64 compressAndWriteEnd = usecTimestampNow();
                     compressAndWriteElapsedUsec = (float)(compressAndWriteEnd - compressAndWriteStart);
@@ -548,6 +569,9 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
             }
             OctreeServer::trackTreeWaitTime(lockWaitElapsedUsec);
             OctreeServer::trackEncodeTime(encodeElapsedUsec);
+            if (encodeElapsedUsec != OctreeServer::SKIP_TIME) {
+                _myServer->trackSubtreeLoad(nodeData->getCameraPosition(), encodeElapsedUsec);
+            }
             OctreeServer::trackCompressAndWriteTime(compressAndWriteElapsedUsec);
             OctreeServer::trackPacketSendingTime(packetSendingElapsedUsec);
             
@@ -568,6 +592,11 @@ int OctreeSendThread::packetDistributor(OctreeQueryNode* nodeData, bool viewFrus
             packetsSentThisInterval += specialPacketsSent;
         }
 
+        // The packets the client missed may have held item properties and strings it's counted as having been sent
+        if (nodeData->hasNextNackedPacket() && !nodeData->itemDeltas.isEmpty()) {
+            nodeData->resetItemDeltas();
+        }
+
         // Re-send packets that were nacked by the client
         while (nodeData->hasNextNackedPacket() && packetsSentThisInterval < maxPacketsPerInterval) {
             const QByteArray* packet = nodeData->getNextNackedPacket();
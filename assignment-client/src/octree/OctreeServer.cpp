@@ -9,6 +9,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <QFile>
 #include <QJsonObject>
 #include <QTimer>
 #include <QUuid>
@@ -221,6 +222,7 @@ OctreeServer::OctreeServer(const QByteArray& packet) :
     _parsedArgV(NULL),
     _httpManager(NULL),
     _statusPort(0),
+    _jurisdictionFilename(),
     _packetsPerClientPerInterval(10),
     _packetsTotalPerInterval(DEFAULT_PACKETS_PER_INTERVAL),
     _tree(NULL),
@@ -230,6 +232,9 @@ OctreeServer::OctreeServer(const QByteArray& packet) :
     _verboseDebug(false),
     _jurisdiction(NULL),
     _jurisdictionSender(NULL),
+    _retiredJurisdictions(),
+    _loadTracker(),
+    _jurisdictionBalancer(NULL),
     _octreeInboundPacketProcessor(NULL),
     _persistThread(NULL),
     _started(time(0)),
@@ -272,6 +277,8 @@ OctreeServer::~OctreeServer() {
 
     delete _jurisdiction;
     _jurisdiction = NULL;
+    qDeleteAll(_retiredJurisdictions);
+    _retiredJurisdictions.clear();
     
     // cleanup our tree here...
     qDebug() << qPrintable(_safeServerName) << "server START cleaning up octree... [" << this << "]";
@@ -821,52 +828,83 @@ void OctreeServer::parsePayload() {
 }
 
 void OctreeServer::readPendingDatagrams() {
-    QByteArray receivedPacket;
-    HifiSockAddr senderSockAddr;
-    
+    getPacketDispatcher().processPendingDatagrams();
+}
+
+void OctreeServer::registerPacketHandlers() {
+    PacketDispatcher& packetDispatcher = getPacketDispatcher();
+    packetDispatcher.registerHandler(getMyQueryMessageType(), this, &OctreeServer::handleQueryPacket);
+    packetDispatcher.registerHandler(PacketTypeOctreeDataNack, this, &OctreeServer::handleNackPacket);
+    packetDispatcher.registerHandler(PacketTypeJurisdictionRequest, this, &OctreeServer::handleJurisdictionRequestPacket,
+                                     true);
+    packetDispatcher.registerHandler(PacketTypeJurisdictionLoad, this, &OctreeServer::handleJurisdictionLoadPacket);
+    packetDispatcher.registerHandler(PacketTypeSubtreeHandoff, this, &OctreeServer::handleSubtreeHandoffPacket);
+
+    // the edit packet types depend on the tree, so the edits are picked out of the packets without a handler of their
+    // own. They're queued for the inbound packet processor's thread, so everything that comes this way gets copied.
+    packetDispatcher.setDefaultHandler(this, &OctreeServer::handleEditOrNodeListPacket, true);
+}
+
+void OctreeServer::handleQueryPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
     NodeList* nodeList = NodeList::getInstance();
-    
-    while (readAvailableDatagram(receivedPacket, senderSockAddr)) {
-        if (nodeList->packetVersionAndHashMatch(receivedPacket)) {
-            PacketType packetType = packetTypeForPacket(receivedPacket);
-            SharedNodePointer matchingNode = nodeList->sendingNodeForPacket(receivedPacket);
-            if (packetType == getMyQueryMessageType()) {
-                // If we got a query packet, then we're talking to an agent, and we
-                // need to make sure we have it in our nodeList.
-                if (matchingNode) {
-                    nodeList->updateNodeWithDataFromPacket(matchingNode, receivedPacket);
-                    OctreeQueryNode* nodeData = (OctreeQueryNode*)matchingNode->getLinkedData();
-                    if (nodeData && !nodeData->isOctreeSendThreadInitalized()) {
-                        
-                        // NOTE: this is an important aspect of the proper ref counting. The send threads/node data need to 
-                        // know that the OctreeServer/Assignment will not get deleted on it while it's still active. The 
-                        // solution is to get the shared pointer for the current assignment. We need to make sure this is the 
-                        // same SharedAssignmentPointer that was ref counted by the assignment client.                    
-                        SharedAssignmentPointer sharedAssignment = AssignmentClient::getCurrentAssignment();
-                        nodeData->initializeOctreeSendThread(sharedAssignment, matchingNode);
-                    }
-                }
-            } else if (packetType == PacketTypeOctreeDataNack) {
-                // If we got a nack packet, then we're talking to an agent, and we
-                // need to make sure we have it in our nodeList.
-                if (matchingNode) {
-                    OctreeQueryNode* nodeData = (OctreeQueryNode*)matchingNode->getLinkedData();
-                    if (nodeData) {
-                        nodeData->parseNackPacket(receivedPacket);
-                    }
-                }
-            } else if (packetType == PacketTypeJurisdictionRequest) {
-                _jurisdictionSender->queueReceivedPacket(matchingNode, receivedPacket);
-            } else if (_octreeInboundPacketProcessor && getOctree()->handlesEditPacketType(packetType)) {
-                _octreeInboundPacketProcessor->queueReceivedPacket(matchingNode, receivedPacket);
-            } else {
-                // let processNodeData handle it.
-                NodeList::getInstance()->processNodeData(senderSockAddr, receivedPacket);
-            }
+    SharedNodePointer matchingNode = nodeList->sendingNodeForPacket(packet);
+
+    // If we got a query packet, then we're talking to an agent, and we
+    // need to make sure we have it in our nodeList.
+    if (matchingNode) {
+        nodeList->updateNodeWithDataFromPacket(matchingNode, packet);
+        OctreeQueryNode* nodeData = (OctreeQueryNode*)matchingNode->getLinkedData();
+        if (nodeData && !nodeData->isOctreeSendThreadInitalized()) {
+            
+            // NOTE: this is an important aspect of the proper ref counting. The send threads/node data need to 
+            // know that the OctreeServer/Assignment will not get deleted on it while it's still active. The 
+            // solution is to get the shared pointer for the current assignment. We need to make sure this is the 
+            // same SharedAssignmentPointer that was ref counted by the assignment client.                    
+            SharedAssignmentPointer sharedAssignment = AssignmentClient::getCurrentAssignment();
+            nodeData->initializeOctreeSendThread(sharedAssignment, matchingNode);
+        }
+    }
+}
+
+void OctreeServer::handleNackPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    // If we got a nack packet, then we're talking to an agent, and we
+    // need to make sure we have it in our nodeList.
+    SharedNodePointer matchingNode = NodeList::getInstance()->sendingNodeForPacket(packet);
+    if (matchingNode) {
+        OctreeQueryNode* nodeData = (OctreeQueryNode*)matchingNode->getLinkedData();
+        if (nodeData) {
+            QByteArray nackPacket = packet;
+            nodeData->parseNackPacket(nackPacket);
         }
     }
 }
 
+void OctreeServer::handleJurisdictionRequestPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    _jurisdictionSender->queueReceivedPacket(NodeList::getInstance()->sendingNodeForPacket(packet), packet);
+}
+
+void OctreeServer::handleJurisdictionLoadPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    if (_jurisdictionBalancer) {
+        _jurisdictionBalancer->processLoadReport(NodeList::getInstance()->sendingNodeForPacket(packet), packet);
+    }
+}
+
+void OctreeServer::handleSubtreeHandoffPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    if (_jurisdictionBalancer) {
+        _jurisdictionBalancer->processHandoffPacket(NodeList::getInstance()->sendingNodeForPacket(packet), packet);
+    }
+}
+
+void OctreeServer::handleEditOrNodeListPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    PacketType packetType = packetTypeForPacket(packet);
+    if (_octreeInboundPacketProcessor && getOctree()->handlesEditPacketType(packetType)) {
+        _octreeInboundPacketProcessor->queueReceivedPacket(NodeList::getInstance()->sendingNodeForPacket(packet), packet);
+    } else {
+        // let processNodeData handle it.
+        NodeList::getInstance()->processNodeData(senderSockAddr, packet);
+    }
+}
+
 void OctreeServer::run() {
     _safeServerName = getMyServerName();
     
@@ -876,6 +914,7 @@ void OctreeServer::run() {
     
     // use common init to setup common timers and logging
     commonInit(getMyLoggingServerTargetName(), getMyNodeType());
+    registerPacketHandlers();
 
     // Now would be a good time to parse our arguments, if we got them as assignment
     if (getPayload().size() > 0) {
@@ -930,6 +969,27 @@ void OctreeServer::run() {
         }
     }
 
+    // A standby server starts out with a jurisdiction that covers nothing, and waits for a busy sibling to hand it
+    // part of its jurisdiction. The root being its own end node keeps it that way when the map gets copied.
+    const char* JURISDICTION_STANDBY = "--jurisdictionStandby";
+    bool jurisdictionStandby = cmdOptionExists(_argc, _argv, JURISDICTION_STANDBY);
+    if (jurisdictionStandby) {
+        delete _jurisdiction;
+        _jurisdiction = new JurisdictionMap("00", "00");
+    }
+    qDebug("jurisdictionStandby=%s", debug::valueOf(jurisdictionStandby));
+
+    const char* DYNAMIC_JURISDICTION = "--dynamicJurisdiction";
+    bool dynamicJurisdiction = jurisdictionStandby || cmdOptionExists(_argc, _argv, DYNAMIC_JURISDICTION);
+    qDebug("dynamicJurisdiction=%s", debug::valueOf(dynamicJurisdiction));
+
+    const char* SPLIT_LOAD_THRESHOLD = "--splitLoadThreshold";
+    const char* splitLoadThresholdOption = getCmdOption(_argc, _argv, SPLIT_LOAD_THRESHOLD);
+    float splitLoadThreshold = splitLoadThresholdOption ? atof(splitLoadThresholdOption) : DEFAULT_SPLIT_LOAD_THRESHOLD;
+    if (dynamicJurisdiction) {
+        qDebug("splitLoadThreshold=%f", splitLoadThreshold);
+    }
+
     NodeList* nodeList = NodeList::getInstance();
     nodeList->setOwnerType(getMyNodeType());
 
@@ -940,6 +1000,11 @@ void OctreeServer::run() {
     // we need to ask the DS about agents so we can ping/reply with them
     nodeList->addNodeTypeToInterestSet(NodeType::Agent);
 
+    // and about the other servers of our type, when we balance our jurisdictions with them
+    if (dynamicJurisdiction) {
+        nodeList->addNodeTypeToInterestSet(getMyNodeType());
+    }
+
 #ifndef WIN32
     setvbuf(stdout, NULL, _IOLBF, 0);
 #endif
@@ -1025,6 +1090,19 @@ void OctreeServer::run() {
 
     HifiSockAddr senderSockAddr;
 
+    // A server that balances its jurisdiction with its siblings keeps the jurisdiction next to its persist file, and
+    // comes back with it after a restart, since that's all its persisted tree has. The domain-server isn't told about
+    // a split: it keeps handing out the payload it was configured with, and the saved jurisdiction replaces the
+    // jurisdiction options in that payload, --jurisdictionStandby included.
+    if (dynamicJurisdiction && _wantPersist) {
+        _jurisdictionFilename = QString("%1.jurisdiction").arg(_persistFilename);
+        if (QFile::exists(_jurisdictionFilename)) {
+            delete _jurisdiction;
+            _jurisdiction = new JurisdictionMap(_jurisdictionFilename.toLocal8Bit().constData());
+            qDebug() << "jurisdiction restored from" << _jurisdictionFilename;
+        }
+    }
+
     // set up our jurisdiction broadcaster...
     if (_jurisdiction) {
         _jurisdiction->setNodeType(getMyNodeType());
@@ -1032,6 +1110,13 @@ void OctreeServer::run() {
     _jurisdictionSender = new JurisdictionSender(_jurisdiction, getMyNodeType());
     _jurisdictionSender->initialize(true);
 
+    if (dynamicJurisdiction) {
+        _loadTracker.setJurisdiction(_jurisdiction);
+        _jurisdictionBalancer = new JurisdictionBalancer(this, splitLoadThreshold);
+        connect(nodeList, SIGNAL(nodeKilled(SharedNodePointer)),
+                _jurisdictionBalancer, SLOT(nodeKilled(SharedNodePointer)));
+    }
+
     // set up our OctreeServerPacketProcessor
     _octreeInboundPacketProcessor = new OctreeInboundPacketProcessor(this);
     _octreeInboundPacketProcessor->initialize(true);
@@ -1050,6 +1135,31 @@ void OctreeServer::run() {
     qDebug() << "Now running... started at: " << localBuffer << utcBuffer;
 }
 
+void OctreeServer::setJurisdiction(JurisdictionMap* jurisdiction) {
+    jurisdiction->setNodeType(getMyNodeType());
+
+    if (_jurisdiction) {
+        _retiredJurisdictions << _jurisdiction;
+    }
+    _jurisdiction = jurisdiction;
+
+    qDebug() << qPrintable(_safeServerName) << "server jurisdiction changed to:";
+    _jurisdiction->displayDebugDetails();
+
+    _jurisdictionSender->publishJurisdiction(_jurisdiction);
+    _loadTracker.setJurisdiction(_jurisdiction);
+
+    // the jurisdiction and the tree have to agree when we come back up, so both are saved right away
+    if (!_jurisdictionFilename.isEmpty()) {
+        if (!_jurisdiction->writeToFile(_jurisdictionFilename.toLocal8Bit().constData())) {
+            qDebug() << qPrintable(_safeServerName) << "server failed to save its jurisdiction to" << _jurisdictionFilename;
+        }
+    }
+    if (_persistThread) {
+        _persistThread->persistSoon();
+    }
+}
+
 void OctreeServer::nodeAdded(SharedNodePointer node) {
     // we might choose to use this notifier to track clients in a pending state
     qDebug() << qPrintable(_safeServerName) << "server added node:" << *node;
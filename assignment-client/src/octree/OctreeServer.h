@@ -20,7 +20,9 @@
 
 #include <ThreadedAssignment.h>
 #include <EnvironmentData.h>
+#include <JurisdictionLoadTracker.h>
 
+#include "JurisdictionBalancer.h"
 #include "OctreePersistThread.h"
 #include "OctreeSendThread.h"
 #include "OctreeServerConsts.h"
@@ -45,6 +47,25 @@ public:
     Octree* getOctree() { return _tree; }
     JurisdictionMap* getJurisdiction() { return _jurisdiction; }
 
+    /// switches to a new jurisdiction, which we take ownership of, and tells everyone listening to our jurisdiction.
+    /// The old one is kept around until we shut down, since the send threads may still be using it. When we persist,
+    /// the jurisdiction is saved, and the tree is saved soon after.
+    void setJurisdiction(JurisdictionMap* jurisdiction);
+
+    /// passes an edit packet that we processed on to the servers we handed part of our jurisdiction off to, while the
+    /// edit senders might not know about the handoff yet
+    void forwardLateEdit(const SharedNodePointer& sendingNode, const QByteArray& packet)
+                { if (_jurisdictionBalancer) { _jurisdictionBalancer->forwardLateEdit(sendingNode, packet); } }
+
+    /// keeps an edit packet for later while we're catching up on a subtree that was handed to us, returns whether it did
+    bool holdEditWhileCatchingUp(const SharedNodePointer& sendingNode, const QByteArray& packet)
+                { return _jurisdictionBalancer && _jurisdictionBalancer->holdEditWhileCatchingUp(sendingNode, packet); }
+
+    /// adds work done for a client at the given position, in meters, when the jurisdiction is balanced dynamically
+    void trackSubtreeLoad(const glm::vec3& position, float usecs)
+                { if (_jurisdictionBalancer) { _loadTracker.addLoad(position, usecs); } }
+    JurisdictionLoadTracker& getLoadTracker() { return _loadTracker; }
+
     int getPacketsPerClientPerInterval() const { return std::min(_packetsPerClientPerInterval, 
                                 std::max(1, getPacketsTotalPerInterval() / std::max(1, getCurrentClientCount()))); }
 
@@ -129,6 +150,14 @@ public slots:
     void sendStatsPacket();
 
 protected:
+    void registerPacketHandlers();
+    void handleQueryPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleNackPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleJurisdictionRequestPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleJurisdictionLoadPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleSubtreeHandoffPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void handleEditOrNodeListPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+
     void parsePayload();
     void initHTTPManager(int port);
     void resetSendingStats();
@@ -146,6 +175,7 @@ protected:
     QString _statusHost;
 
     char _persistFilename[MAX_FILENAME_LENGTH];
+    QString _jurisdictionFilename;
     int _packetsPerClientPerInterval;
     int _packetsTotalPerInterval;
     Octree* _tree; // this IS a reaveraging tree
@@ -155,6 +185,9 @@ protected:
     bool _verboseDebug;
     JurisdictionMap* _jurisdiction;
     JurisdictionSender* _jurisdictionSender;
+    QList<JurisdictionMap*> _retiredJurisdictions;
+    JurisdictionLoadTracker _loadTracker;
+    JurisdictionBalancer* _jurisdictionBalancer;
     OctreeInboundPacketProcessor* _octreeInboundPacketProcessor;
     OctreePersistThread* _persistThread;
 
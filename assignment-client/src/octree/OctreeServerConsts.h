@@ -20,5 +20,6 @@ const int MAX_FILENAME_LENGTH = 1024;
 const int INTERVALS_PER_SECOND = 60;
 const int OCTREE_SEND_INTERVAL_USECS = (1000 * 1000)/INTERVALS_PER_SECOND;
 const int SENDING_TIME_TO_SPARE = 5 * 1000; // usec of sending interval to spare for calculating voxels
+const quint64 ITEM_DELTAS_KEYFRAME_INTERVAL_USECS = 10 * USECS_PER_SECOND; // how often items are all sent whole again
 
 #endif // hifi_OctreeServerConsts_h
@@ -102,7 +102,7 @@ int ParticleServer::sendSpecialPacket(const SharedNodePointer& node, OctreeQuery
         packetsSent = 0;
         while (hasMoreToSend) {
             hasMoreToSend = tree->encodeParticlesDeletedSince(queryNode->getSequenceNumber(), deletedParticlesSentAt,
-                                                outputBuffer, MAX_PACKET_SIZE, packetLength);
+                                                outputBuffer, MAX_PACKET_SIZE, packetLength, &queryNode->itemDeltas);
 
             //qDebug() << "sending PacketType_PARTICLE_ERASE packetLength:" << packetLength;
 
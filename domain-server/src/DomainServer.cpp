@@ -42,7 +42,9 @@ DomainServer::DomainServer(int argc, char* argv[]) :
     _hostname(),
     _networkReplyUUIDMap(),
     _sessionAuthenticationHash(),
-    _settingsManager()
+    _settingsManager(),
+    _domainListVersion(NO_DOMAIN_LIST_VERSION),
+    _domainListChanges()
 {
     setOrganizationName("High Fidelity");
     setOrganizationDomain("highfidelity.io");
@@ -558,78 +560,158 @@ NodeSet DomainServer::nodeInterestListFromPacket(const QByteArray& packet, int n
     return nodeInterestSet;
 }
 
-void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr &senderSockAddr,
-                                        const NodeSet& nodeInterestList) {
+quint32 DomainServer::domainListVersionFromPacket(const QByteArray& packet, int numPreceedingBytes) {
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numPreceedingBytes);
 
-    QByteArray broadcastPacket = byteArrayWithPopulatedHeader(PacketTypeDomainList);
+    // the version of the list the node has follows its node types of interest
+    quint8 numInterestTypes = 0;
+    packetStream >> numInterestTypes;
+    packetStream.skipRawData(numInterestTypes * sizeof(NodeType_t));
 
-    // always send the node their own UUID back
-    QDataStream broadcastDataStream(&broadcastPacket, QIODevice::Append);
-    broadcastDataStream << node->getUUID();
+    quint32 knownListVersion = NO_DOMAIN_LIST_VERSION;
+    if (!packetStream.atEnd()) {
+        packetStream >> knownListVersion;
+    }
 
-    int numBroadcastPacketLeadBytes = broadcastDataStream.device()->pos();
+    return knownListVersion;
+}
 
-    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+// how many changes to the node list we remember - nodes that are further behind than this get a full list
+const int MAX_DOMAIN_LIST_CHANGE_HISTORY = 1024;
 
-    LimitedNodeList* nodeList = LimitedNodeList::getInstance();
+void DomainServer::recordDomainListChange(const QUuid& nodeUUID) {
+    _domainListChanges.append(QPair<quint32, QUuid>(++_domainListVersion, nodeUUID));
 
-    if (nodeInterestList.size() > 0) {
+    if (_domainListChanges.size() > MAX_DOMAIN_LIST_CHANGE_HISTORY) {
+        _domainListChanges.removeFirst();
+    }
+}
 
-//        DTLSServerSession* dtlsSession = _isUsingDTLS ? _dtlsSessions[senderSockAddr] : NULL;
-        int dataMTU = MAX_PACKET_SIZE;
+QByteArray DomainServer::domainListEntryForNode(const SharedNodePointer& node, const SharedNodePointer& otherNode) {
+    QByteArray nodeByteArray;
+    QDataStream nodeDataStream(&nodeByteArray, QIODevice::Append);
 
-        if (nodeData->isAuthenticated()) {
-            // if this authenticated node has any interest types, send back those nodes as well
-            foreach (const SharedNodePointer& otherNode, nodeList->getNodeHash()) {
+    nodeDataStream << DomainListEntry::AddOrUpdate;
+    nodeDataStream << *otherNode.data();
 
-                // reset our nodeByteArray and nodeDataStream
-                QByteArray nodeByteArray;
-                QDataStream nodeDataStream(&nodeByteArray, QIODevice::Append);
+    // pack the secret that these two nodes will use to communicate with each other
+    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+    QUuid secretUUID = nodeData->getSessionSecretHash().value(otherNode->getUUID());
+    if (secretUUID.isNull()) {
+        // generate a new secret UUID these two nodes can use
+        secretUUID = QUuid::createUuid();
 
-                if (otherNode->getUUID() != node->getUUID() && nodeInterestList.contains(otherNode->getType())) {
+        // set that on the current Node's sessionSecretHash
+        nodeData->getSessionSecretHash().insert(otherNode->getUUID(), secretUUID);
 
-                    // don't send avatar nodes to other avatars, that will come from avatar mixer
-                    nodeDataStream << *otherNode.data();
+        // set it on the other Node's sessionSecretHash
+        reinterpret_cast<DomainServerNodeData*>(otherNode->getLinkedData())
+            ->getSessionSecretHash().insert(node->getUUID(), secretUUID);
+    }
 
-                    // pack the secret that these two nodes will use to communicate with each other
-                    QUuid secretUUID = nodeData->getSessionSecretHash().value(otherNode->getUUID());
-                    if (secretUUID.isNull()) {
-                        // generate a new secret UUID these two nodes can use
-                        secretUUID = QUuid::createUuid();
+    nodeDataStream << secretUUID;
 
-                        // set that on the current Node's sessionSecretHash
-                        nodeData->getSessionSecretHash().insert(otherNode->getUUID(), secretUUID);
+    return nodeByteArray;
+}
 
-                        // set it on the other Node's sessionSecretHash
-                        reinterpret_cast<DomainServerNodeData*>(otherNode->getLinkedData())
-                        ->getSessionSecretHash().insert(node->getUUID(), secretUUID);
+void DomainServer::sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr &senderSockAddr,
+                                        const NodeSet& nodeInterestList, quint32 knownListVersion) {
 
-                    }
+    DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
+
+    LimitedNodeList* nodeList = LimitedNodeList::getInstance();
 
-                    nodeDataStream << secretUUID;
+    // we can get away with only sending the changes since the version this node has, unless it has no list yet,
+    // has a list from before we started, wants different node types than last time, or is behind our change history
+    DomainListType_t listType = DomainListType::Delta;
+    if (knownListVersion == NO_DOMAIN_LIST_VERSION
+        || knownListVersion > _domainListVersion
+        || nodeInterestList != nodeData->getNodeInterestSet()
+        || (!_domainListChanges.isEmpty() && knownListVersion + 1 < _domainListChanges.first().first)) {
+        listType = DomainListType::Full;
+    }
+
+    nodeData->setNodeInterestSet(nodeInterestList);
 
-                    if (broadcastPacket.size() +  nodeByteArray.size() > dataMTU) {
-                        // we need to break here and start a new packet
-                        // so send the current one
+    // an unauthenticated node gets no other nodes, and no version it could acknowledge either
+    quint32 listVersion = nodeData->isAuthenticated() ? _domainListVersion : NO_DOMAIN_LIST_VERSION;
 
-                        nodeList->writeDatagram(broadcastPacket, node, senderSockAddr);
+    QList<QByteArray> entries;
 
-                        // reset the broadcastPacket structure
-                        broadcastPacket.resize(numBroadcastPacketLeadBytes);
-                        broadcastDataStream.device()->seek(numBroadcastPacketLeadBytes);
+    if (nodeInterestList.size() > 0 && nodeData->isAuthenticated()) {
+        if (listType == DomainListType::Full) {
+            // if this authenticated node has any interest types, send back those nodes as well
+            foreach (const SharedNodePointer& otherNode, nodeList->getNodeHash()) {
+                if (otherNode->getUUID() != node->getUUID() && nodeInterestList.contains(otherNode->getType())) {
+                    entries.append(domainListEntryForNode(node, otherNode));
+                }
+            }
+        } else {
+            // walk back through the changes this node hasn't seen yet, each changed node only needs to be sent once
+            QSet<QUuid> changedNodeUUIDs;
+            for (int i = _domainListChanges.size() - 1; i >= 0 && _domainListChanges[i].first > knownListVersion; i--) {
+                changedNodeUUIDs.insert(_domainListChanges[i].second);
+            }
+
+            foreach (const QUuid& changedNodeUUID, changedNodeUUIDs) {
+                if (changedNodeUUID == node->getUUID()) {
+                    continue;
+                }
+
+                SharedNodePointer otherNode = nodeList->nodeWithUUID(changedNodeUUID);
+                if (otherNode) {
+                    if (nodeInterestList.contains(otherNode->getType())) {
+                        entries.append(domainListEntryForNode(node, otherNode));
                     }
+                } else {
+                    // this node is gone, tell the receiver to drop it too
+                    QByteArray removedByteArray;
+                    QDataStream removedDataStream(&removedByteArray, QIODevice::Append);
+                    removedDataStream << DomainListEntry::Remove << changedNodeUUID;
 
-                    // append the nodeByteArray to the current state of broadcastDataStream
-                    broadcastPacket.append(nodeByteArray);
+                    entries.append(removedByteArray);
                 }
             }
         }
+    }
+
+    // always send the node their own UUID back, along with the list type and version
+    QByteArray leadPacket = byteArrayWithPopulatedHeader(PacketTypeDomainList);
+    QDataStream leadDataStream(&leadPacket, QIODevice::Append);
+    leadDataStream << node->getUUID() << listType << listVersion;
+
+    // each packet also carries its index and the number of packets in this list, so the node knows when it has it all
+    int numLeadBytes = leadPacket.size() + 2 * sizeof(quint16);
+
+//    DTLSServerSession* dtlsSession = _isUsingDTLS ? _dtlsSessions[senderSockAddr] : NULL;
+    int dataMTU = MAX_PACKET_SIZE;
+
+    QList<QByteArray> packetBodies;
+    packetBodies.append(QByteArray());
+
+    foreach (const QByteArray& entry, entries) {
+        if (numLeadBytes + packetBodies.last().size() + entry.size() > dataMTU) {
+            // we need to break here and start a new packet
+            packetBodies.append(QByteArray());
+        }
+
+        packetBodies.last().append(entry);
+    }
+
+    for (int i = 0; i < packetBodies.size(); i++) {
+        QByteArray broadcastPacket = leadPacket;
+        QDataStream broadcastDataStream(&broadcastPacket, QIODevice::Append);
+        broadcastDataStream << (quint16) i << (quint16) packetBodies.size();
+        broadcastPacket.append(packetBodies[i]);
 
-        // always write the last broadcastPacket
         nodeList->writeDatagram(broadcastPacket, node, senderSockAddr);
     }
 }
 
+// The domain-server isn't a ThreadedAssignment and doesn't go through the PacketDispatcher: most of what it reads
+// (assignment requests, check-ins from nodes it doesn't know yet) can't be matched to a node, and every node only checks
+// in about once a second, so its datagram rate stays far below the mixers'.
 void DomainServer::readAvailableDatagrams() {
     LimitedNodeList* nodeList = LimitedNodeList::getInstance();
 
@@ -827,13 +909,21 @@ void DomainServer::processDatagram(const QByteArray& receivedPacket, const HifiS
                 int numNodeInfoBytes = parseNodeDataFromByteArray(throwawayNodeType, nodePublicAddress, nodeLocalAddress,
                                                                   receivedPacket, senderSockAddr);
 
-                SharedNodePointer checkInNode = nodeList->updateSocketsForNode(nodeUUID, nodePublicAddress, nodeLocalAddress);
+                SharedNodePointer checkInNode = nodeList->nodeWithUUID(nodeUUID);
+                if (checkInNode->getPublicSocket() != nodePublicAddress
+                    || checkInNode->getLocalSocket() != nodeLocalAddress) {
+                    // the other nodes will need to hear about the new sockets for this node
+                    recordDomainListChange(nodeUUID);
+                }
+
+                checkInNode = nodeList->updateSocketsForNode(nodeUUID, nodePublicAddress, nodeLocalAddress);
 
                 // update last receive to now
                 quint64 timeNow = usecTimestampNow();
                 checkInNode->setLastHeardMicrostamp(timeNow);
 
-                sendDomainListToNode(checkInNode, senderSockAddr, nodeInterestListFromPacket(receivedPacket, numNodeInfoBytes));
+                sendDomainListToNode(checkInNode, senderSockAddr, nodeInterestListFromPacket(receivedPacket, numNodeInfoBytes),
+                                     domainListVersionFromPacket(receivedPacket, numNodeInfoBytes));
             }
         } else if (requestType == PacketTypeNodeJsonStats) {
             SharedNodePointer matchingNode = nodeList->sendingNodeForPacket(receivedPacket);
@@ -1294,10 +1384,14 @@ void DomainServer::refreshStaticAssignmentAndAddToQueue(SharedAssignmentPointer&
 void DomainServer::nodeAdded(SharedNodePointer node) {
     // we don't use updateNodeWithData, so add the DomainServerNodeData to the node here
     node->setLinkedData(new DomainServerNodeData());
+
+    recordDomainListChange(node->getUUID());
 }
 
 void DomainServer::nodeKilled(SharedNodePointer node) {
 
+    recordDomainListChange(node->getUUID());
+
     DomainServerNodeData* nodeData = reinterpret_cast<DomainServerNodeData*>(node->getLinkedData());
 
     if (nodeData) {
@@ -67,8 +67,11 @@ private:
     int parseNodeDataFromByteArray(NodeType_t& nodeType, HifiSockAddr& publicSockAddr,
                                     HifiSockAddr& localSockAddr, const QByteArray& packet, const HifiSockAddr& senderSockAddr);
     NodeSet nodeInterestListFromPacket(const QByteArray& packet, int numPreceedingBytes);
+    quint32 domainListVersionFromPacket(const QByteArray& packet, int numPreceedingBytes);
     void sendDomainListToNode(const SharedNodePointer& node, const HifiSockAddr& senderSockAddr,
-                              const NodeSet& nodeInterestList);
+                              const NodeSet& nodeInterestList, quint32 knownListVersion = NO_DOMAIN_LIST_VERSION);
+    QByteArray domainListEntryForNode(const SharedNodePointer& node, const SharedNodePointer& otherNode);
+    void recordDomainListChange(const QUuid& nodeUUID);
     
     void parseAssignmentConfigs(QSet<Assignment::Type>& excludedTypes);
     void addStaticAssignmentToAssignmentHash(Assignment* newAssignment);
@@ -111,6 +114,9 @@ private:
     QHash<QUuid, bool> _sessionAuthenticationHash;
     
     DomainServerSettingsManager _settingsManager;
+    
+    quint32 _domainListVersion;
+    QList<QPair<quint32, QUuid> > _domainListChanges;
 };
 
 #endif // hifi_DomainServer_h
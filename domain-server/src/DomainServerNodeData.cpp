@@ -24,7 +24,8 @@ DomainServerNodeData::DomainServerNodeData() :
     _paymentIntervalTimer(),
     _statsJSONObject(),
     _sendingSockAddr(),
-    _isAuthenticated(true)
+    _isAuthenticated(true),
+    _nodeInterestSet()
 {
     _paymentIntervalTimer.start();
 }
@@ -18,6 +18,7 @@
 #include <QtCore/QUuid>
 
 #include <HifiSockAddr.h>
+#include <LimitedNodeList.h>
 #include <NodeData.h>
 
 class DomainServerNodeData : public NodeData {
@@ -44,6 +45,9 @@ public:
     bool isAuthenticated() const { return _isAuthenticated; }
     
     QHash<QUuid, QUuid>& getSessionSecretHash() { return _sessionSecretHash; }
+    
+    void setNodeInterestSet(const NodeSet& nodeInterestSet) { _nodeInterestSet = nodeInterestSet; }
+    const NodeSet& getNodeInterestSet() const { return _nodeInterestSet; }
 private:
     QJsonObject mergeJSONStatsFromNewObject(const QJsonObject& newObject, QJsonObject destinationObject);
     
@@ -54,6 +58,7 @@ private:
     QJsonObject _statsJSONObject;
     HifiSockAddr _sendingSockAddr;
     bool _isAuthenticated;
+    NodeSet _nodeInterestSet;
 };
 
 #endif // hifi_DomainServerNodeData_h
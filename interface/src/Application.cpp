@@ -52,6 +52,7 @@
 
 #include <AccountManager.h>
 #include <AudioInjector.h>
+#include <AudioInjectorScheduler.h>
 #include <LocalVoxelsList.h>
 #include <Logging.h>
 #include <ModelsScriptingInterface.h>
@@ -228,6 +229,9 @@ Application::Application(int& argc, char** argv, QElapsedTimer &startup_time) :
     // connect the DataProcessor processDatagrams slot to the QUDPSocket readyRead() signal
     connect(&nodeList->getNodeSocket(), SIGNAL(readyRead()), &_datagramProcessor, SLOT(processDatagrams()));
 
+    // the injected sounds are sent from their own thread, which winds down when we're about to quit
+    AudioInjectorScheduler::createInstance(this);
+
     // put the audio processing on a separate thread
     QThread* audioThread = new QThread(this);
 
@@ -533,6 +537,10 @@ void Application::initializeGL() {
 
     // create thread for parsing of voxel data independent of the main network and rendering threads
     _octreeProcessor.initialize(_enableProcessVoxelsThread);
+    // without that thread, the packets are also decoded on the main thread
+    _voxels.getPacketPipeline().setIsThreaded(_enableProcessVoxelsThread);
+    _particles.getPacketPipeline().setIsThreaded(_enableProcessVoxelsThread);
+    _models.getPacketPipeline().setIsThreaded(_enableProcessVoxelsThread);
     _voxelEditSender.initialize(_enableProcessVoxelsThread);
     _voxelHideShowThread.initialize(_enableProcessVoxelsThread);
     _particleEditSender.initialize(_enableProcessVoxelsThread);
@@ -2262,6 +2270,7 @@ void Application::queryOctree(NodeType_t serverType, PacketType packetType, Node
     _octreeQuery.setWantDelta(true);
     _octreeQuery.setWantOcclusionCulling(false);
     _octreeQuery.setWantCompression(true);
+    _octreeQuery.setWantItemDeltas(!Menu::getInstance()->isOptionChecked(MenuOption::DisableNackPackets));
 
     _octreeQuery.setCameraPosition(_viewFrustum.getPosition());
     _octreeQuery.setCameraOrientation(_viewFrustum.getOrientation());
@@ -3273,12 +3282,14 @@ void Application::domainChanged(const QString& domainHostname) {
     // reset our node to stats and node to jurisdiction maps... since these must be changing...
     _voxelServerJurisdictions.lockForWrite();
     _voxelServerJurisdictions.clear();
+    _voxelServerJurisdictions.jurisdictionsChanged();
     _voxelServerJurisdictions.unlock();
 
     _octreeServerSceneStats.clear();
 
     _particleServerJurisdictions.lockForWrite();
     _particleServerJurisdictions.clear();
+    _particleServerJurisdictions.jurisdictionsChanged();
     _particleServerJurisdictions.unlock();
 
     // reset the particle renderer
@@ -3357,6 +3368,7 @@ void Application::nodeKilled(SharedNodePointer node) {
             // If the voxel server is going away, remove it from our jurisdiction map so we don't send voxels to a dead server
             _voxelServerJurisdictions.lockForWrite();
             _voxelServerJurisdictions.erase(_voxelServerJurisdictions.find(nodeUUID));
+            _voxelServerJurisdictions.jurisdictionsChanged();
         }
         _voxelServerJurisdictions.unlock();
 
@@ -3394,6 +3406,7 @@ void Application::nodeKilled(SharedNodePointer node) {
             // If the particle server is going away, remove it from our jurisdiction map so we don't send voxels to a dead server
             _particleServerJurisdictions.lockForWrite();
             _particleServerJurisdictions.erase(_particleServerJurisdictions.find(nodeUUID));
+            _particleServerJurisdictions.jurisdictionsChanged();
         }
         _particleServerJurisdictions.unlock();
 
@@ -3432,6 +3445,7 @@ void Application::nodeKilled(SharedNodePointer node) {
             // If the model server is going away, remove it from our jurisdiction map so we don't send voxels to a dead server
             _modelServerJurisdictions.lockForWrite();
             _modelServerJurisdictions.erase(_modelServerJurisdictions.find(nodeUUID));
+            _modelServerJurisdictions.jurisdictionsChanged();
         }
         _modelServerJurisdictions.unlock();
 
@@ -3531,6 +3545,7 @@ int Application::parseOctreeStats(const QByteArray& packet, const SharedNodePoin
         jurisdictionMap.copyContents(temp.getJurisdictionRoot(), temp.getJurisdictionEndNodes());
         jurisdiction->lockForWrite();
         (*jurisdiction)[nodeUUID] = jurisdictionMap;
+        jurisdiction->jurisdictionsChanged();
         jurisdiction->unlock();
     }
     return statsMessageLength;
@@ -115,6 +115,7 @@ Audio::Audio(int16_t initialJitterBufferSamples, QObject* parent) :
     _starveCount(0),
     _consecutiveNotMixedCount(0),
     _outgoingAvatarAudioSequenceNumber(0),
+    _outgoingAudioCodec(AudioCodecType::ADPCM),
     _incomingMixedAudioSequenceNumberStats(INCOMING_SEQ_STATS_HISTORY_LENGTH),
     _interframeTimeGapStats(TIME_GAPS_STATS_INTERVAL_SAMPLES, TIME_GAP_STATS_WINDOW_INTERVALS)
 {
@@ -444,9 +445,11 @@ void Audio::handleAudioInput() {
     static char audioDataPacket[MAX_PACKET_SIZE];
 
     static int numBytesPacketHeader = numBytesForPacketHeaderGivenPacketType(PacketTypeMicrophoneAudioNoEcho);
-    static int leadingBytes = numBytesPacketHeader + sizeof(quint16) + sizeof(glm::vec3) + sizeof(glm::quat) + sizeof(quint8);
+    static int leadingBytes = numBytesPacketHeader + sizeof(quint16) + sizeof(glm::vec3) + sizeof(glm::quat)
+        + sizeof(quint8) + sizeof(AudioCodec_t);
 
-    static int16_t* networkAudioSamples = (int16_t*) (audioDataPacket + leadingBytes);
+    // the samples are encoded into the packet once they have been processed
+    static int16_t networkAudioSamples[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
 
     float inputToNetworkInputRatio = calculateDeviceToNetworkInputRatio(_numInputCallbackBytes);
 
@@ -655,18 +658,10 @@ void Audio::handleAudioInput() {
             glm::quat headOrientation = interfaceAvatar->getHead()->getFinalOrientationInWorldFrame();
             quint8 isStereo = _isStereoInput ? 1 : 0;
             
-            int numAudioBytes = 0;
-            
             PacketType packetType;
             if (_lastInputLoudness == 0) {
                 packetType = PacketTypeSilentAudioFrame;
-                
-                // we need to indicate how many silent samples this is to the audio mixer
-                networkAudioSamples[0] = numNetworkSamples;
-                numAudioBytes = sizeof(int16_t);
             } else {
-                numAudioBytes = numNetworkBytes;
-                
                 if (Menu::getInstance()->isOptionChecked(MenuOption::EchoServerAudio)) {
                     packetType = PacketTypeMicrophoneAudioWithEcho;
                 } else {
@@ -690,6 +685,21 @@ void Audio::handleAudioInput() {
             // memcpy our orientation
             memcpy(currentPacketPtr, &headOrientation, sizeof(headOrientation));
             currentPacketPtr += sizeof(headOrientation);
+
+            // the mixer sends our mix back with the codec we use
+            *currentPacketPtr++ = _outgoingAudioCodec;
+
+            int numAudioBytes = 0;
+            if (packetType == PacketTypeSilentAudioFrame) {
+                // we need to indicate how many silent samples this is to the audio mixer
+                int16_t numSilentSamples = numNetworkSamples;
+                memcpy(currentPacketPtr, &numSilentSamples, sizeof(int16_t));
+                numAudioBytes = sizeof(int16_t);
+            } else {
+                numAudioBytes = AudioCodec::getCodec(_outgoingAudioCodec)->encode(networkAudioSamples, numNetworkSamples,
+                                                                                  _isStereoInput ? 2 : 1,
+                                                                                  currentPacketPtr);
+            }
             
             nodeList->writeDatagram(audioDataPacket, numAudioBytes + leadingBytes, audioMixer);
             _outgoingAvatarAudioSequenceNumber++;
@@ -28,6 +28,12 @@ const float DEFAULT_DIFFUSION_RATIO = 0.125; // 12.5% is diffused
 const float DEFAULT_ORIGINAL_ATTENUATION = 1.0f;
 const float DEFAULT_ECHO_ATTENUATION = 1.0f;
 
+const float EAR_POSITION_SIMILAR_ENOUGH = 0.01f; // meters the ears can move before we recalculate the echo taps
+
+// echo taps that start within this many buffers of the first tap of a block are mixed into that block, so dense taps
+// become one addition to the spatial audio buffer rather than one per tap
+const int ECHO_BLOCK_SPREAD_BUFFERS = 4;
+
 AudioReflector::AudioReflector(QObject* parent) : 
     QObject(parent),
     _preDelay(DEFAULT_PRE_DELAY),
@@ -49,7 +55,8 @@ AudioReflector::AudioReflector(QObject* parent) :
     _lastAbsorptionRatio(DEFAULT_ABSORPTION_RATIO),
     _lastDiffusionRatio(DEFAULT_DIFFUSION_RATIO),
     _lastDontDistanceAttenuate(false),
-    _lastAlternateDistanceAttenuate(false)
+    _lastAlternateDistanceAttenuate(false),
+    _tapsCombFilterWindow(DEFAULT_COMB_FILTER_WINDOW)
 {
     _reflections = 0;
     _diffusionPathCount = 0;
@@ -63,6 +70,7 @@ AudioReflector::AudioReflector(QObject* parent) :
     _inboundEchoesSuppressedCount = 0;
     _localEchoesCount = 0;
     _localEchoesSuppressedCount = 0;
+    _injectedEchoes = 0;
 }
 
 bool AudioReflector::haveAttributesChanged() {
@@ -112,8 +120,31 @@ void AudioReflector::render() {
     }
 }
 
-// delay = 1ms per foot
-//       = 3ms per meter
+AudioReflectorSettings AudioReflector::getCurrentSettings() {
+    bool wantEarSeparation = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingSeparateEars);
+    bool wantPreDelay = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingPreDelay);
+    bool wantDiffusions = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingWithDiffusions);
+
+    AudioReflectorSettings settings;
+    settings.listenerPosition = _myAvatar->getHead()->getPosition();
+    settings.leftEarPosition = wantEarSeparation ? _myAvatar->getHead()->getLeftEarPosition() :
+                                    _myAvatar->getHead()->getPosition();
+    settings.rightEarPosition = wantEarSeparation ? _myAvatar->getHead()->getRightEarPosition() :
+                                    _myAvatar->getHead()->getPosition();
+    settings.preDelay = wantPreDelay ? _preDelay : 0.0f;
+    settings.soundMsPerMeter = _soundMsPerMeter;
+    settings.doDistanceAttenuation = !Menu::getInstance()->isOptionChecked(
+                                            MenuOption::AudioSpatialProcessingDontDistanceAttenuate);
+    settings.alternateDistanceAttenuation = Menu::getInstance()->isOptionChecked(
+                                            MenuOption::AudioSpatialProcessingAlternateDistanceAttenuate);
+    settings.distanceAttenuationScalingFactor = _distanceAttenuationScalingFactor;
+    settings.slightlyRandomSurfaces = Menu::getInstance()->isOptionChecked(
+                                            MenuOption::AudioSpatialProcessingSlightlyRandomSurfaces);
+    settings.diffusionFanout = wantDiffusions ? _diffusionFanout : 0;
+    settings.material = getSurfaceCharacteristics();
+    return settings;
+}
+
 float AudioReflector::getDelayFromDistance(float distance) {
     float delay = (_soundMsPerMeter * distance);
     if (Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingPreDelay)) {
@@ -122,22 +153,19 @@ float AudioReflector::getDelayFromDistance(float distance) {
     return delay;
 }
 
-// attenuation = from the Audio Mixer
-float AudioReflector::getDistanceAttenuationCoefficient(float distance) {
-
-
-    bool doDistanceAttenuation = !Menu::getInstance()->isOptionChecked(
-                                            MenuOption::AudioSpatialProcessingDontDistanceAttenuate);
+// delay = 1ms per foot
+//       = 3ms per meter
+float AudioReflectorSettings::getDelayFromDistance(float distance) const {
+    return (soundMsPerMeter * distance) + preDelay;
+}
 
-    bool originalFormula = !Menu::getInstance()->isOptionChecked(
-                                            MenuOption::AudioSpatialProcessingAlternateDistanceAttenuate);
-    
-    
+// attenuation = from the Audio Mixer
+float AudioReflectorSettings::getDistanceAttenuationCoefficient(float distance) const {
     float distanceCoefficient = 1.0f;
     
     if (doDistanceAttenuation) {
     
-        if (originalFormula) {
+        if (!alternateDistanceAttenuation) {
             const float DISTANCE_SCALE = 2.5f;
             const float GEOMETRIC_AMPLITUDE_SCALAR = 0.3f;
             const float DISTANCE_LOG_BASE = 2.5f;
@@ -149,7 +177,7 @@ float AudioReflector::getDistanceAttenuationCoefficient(float distance) {
             distanceCoefficient = powf(GEOMETRIC_AMPLITUDE_SCALAR,
                                              DISTANCE_SCALE_LOG +
                                              (0.5f * logf(distanceSquareToSource) / logf(DISTANCE_LOG_BASE)) - 1);
-            distanceCoefficient = std::min(1.0f, distanceCoefficient * getDistanceAttenuationScalingFactor());
+            distanceCoefficient = std::min(1.0f, distanceCoefficient * distanceAttenuationScalingFactor);
         } else {
         
             // From Fred: If we wanted something that would produce a tail that could go up to 5 seconds in a 
@@ -162,15 +190,15 @@ float AudioReflector::getDistanceAttenuationCoefficient(float distance) {
             const float DISTANCE_DENOMINATOR = 300.0f;
             const float DISTANCE_NUMERATOR = 300.0f;
             distanceCoefficient = DISTANCE_NUMERATOR / powf(DISTANCE_BASE, (distance / DISTANCE_DENOMINATOR ));
-            distanceCoefficient = std::min(1.0f, distanceCoefficient * getDistanceAttenuationScalingFactor());
+            distanceCoefficient = std::min(1.0f, distanceCoefficient * distanceAttenuationScalingFactor);
         }
     }
     
     return distanceCoefficient;
 }
 
-glm::vec3 AudioReflector::getFaceNormal(BoxFace face) {
-    bool wantSlightRandomness = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingSlightlyRandomSurfaces);
+glm::vec3 AudioPathTracer::getFaceNormal(BoxFace face) const {
+    bool wantSlightRandomness = _settings.slightlyRandomSurfaces;
     glm::vec3 faceNormal;
     const float MIN_RANDOM_LENGTH = 0.99f;
     const float MAX_RANDOM_LENGTH = 1.0f;
@@ -199,55 +227,82 @@ glm::vec3 AudioReflector::getFaceNormal(BoxFace face) {
 // set up our buffers for our attenuated and delayed samples
 const int NUMBER_OF_CHANNELS = 2;
 
-void AudioReflector::injectAudiblePoint(AudioSource source, const AudiblePoint& audiblePoint,
-                        const QByteArray& samples, unsigned int sampleTime, int sampleRate) {
-
-    bool wantEarSeparation = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingSeparateEars);
-    bool wantStereo = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingStereoSource);
-    glm::vec3 rightEarPosition = wantEarSeparation ? _myAvatar->getHead()->getRightEarPosition() : 
-                                    _myAvatar->getHead()->getPosition();
-    glm::vec3 leftEarPosition = wantEarSeparation ? _myAvatar->getHead()->getLeftEarPosition() :
-                                    _myAvatar->getHead()->getPosition();
+static bool echoTapDelayLessThan(const AudioEchoTap& first, const AudioEchoTap& second) {
+    return first.delay < second.delay;
+}
 
-    int totalNumberOfSamples = samples.size() / sizeof(int16_t);
-    int totalNumberOfStereoSamples = samples.size() / (sizeof(int16_t) * NUMBER_OF_CHANNELS);
+void AudioReflector::calculateEchoTaps(const AudioReflectorSettings& settings) {
+    _maxDelay = 0;
+    _maxAttenuation = 0.0f;
+    _minDelay = std::numeric_limits<int>::max();
+    _minAttenuation = std::numeric_limits<float>::max();
+    _totalDelay = 0.0f;
+    _delayCount = 0;
+    _totalAttenuation = 0.0f;
+    _attenuationCount = 0;
+    _injectedEchoes = 0;
 
-    const int16_t* originalSamplesData = (const int16_t*)samples.constData();
-    QByteArray attenuatedLeftSamples;
-    QByteArray attenuatedRightSamples;
-    attenuatedLeftSamples.resize(samples.size());
-    attenuatedRightSamples.resize(samples.size());
+    calculateEchoTaps(INBOUND_AUDIO, settings);
+    calculateEchoTaps(LOCAL_AUDIO, settings);
 
-    int16_t* attenuatedLeftSamplesData = (int16_t*)attenuatedLeftSamples.data();
-    int16_t* attenuatedRightSamplesData = (int16_t*)attenuatedRightSamples.data();
-    
-    // calculate the distance to the ears
-    float rightEarDistance = glm::distance(audiblePoint.location, rightEarPosition);
-    float leftEarDistance = glm::distance(audiblePoint.location, leftEarPosition);
+    _tapsLeftEarPosition = settings.leftEarPosition;
+    _tapsRightEarPosition = settings.rightEarPosition;
+    _tapsCombFilterWindow = _combFilterWindow;
 
-    float rightEarDelayMsecs = getDelayFromDistance(rightEarDistance) + audiblePoint.delay;
-    float leftEarDelayMsecs = getDelayFromDistance(leftEarDistance) + audiblePoint.delay;
-    float averageEarDelayMsecs = (leftEarDelayMsecs + rightEarDelayMsecs) / 2.0f;
+    _averageDelay = _delayCount == 0 ? 0 : _totalDelay / _delayCount;
+    _averageAttenuation = _attenuationCount == 0 ? 0 : _totalAttenuation / _attenuationCount;
     
-    bool safeToInject = true; // assume the best
+    if (_reflections == 0) {
+        _minDelay = 0.0f;
+        _minAttenuation = 0.0f;
+    }
     
-    // check to see if this new injection point would be within the comb filter 
-    // suppression window for any of the existing known delays
+    _officialMaxDelay = _maxDelay;
+    _officialMinDelay = _minDelay;
+    _officialMaxAttenuation = _maxAttenuation;
+    _officialMinAttenuation = _minAttenuation;
+    _officialAverageDelay = _averageDelay;
+    _officialAverageAttenuation = _averageAttenuation;
+}
+
+void AudioReflector::calculateEchoTaps(AudioSource source, const AudioReflectorSettings& settings) {
+    const QVector<AudiblePoint>& audiblePoints = (source == INBOUND_AUDIO) ? _inboundAudiblePoints : _localAudiblePoints;
+    QVector<AudioEchoTap>& echoTaps = (source == INBOUND_AUDIO) ? _inboundEchoTaps : _localEchoTaps;
     QMap<float, float>& knownDelays = (source == INBOUND_AUDIO) ? _inboundAudioDelays : _localAudioDelays;
-    QMap<float, float>::const_iterator lowerBound = knownDelays.lowerBound(averageEarDelayMsecs - _combFilterWindow);
-    if (lowerBound != knownDelays.end()) {
-        float closestFound = lowerBound.value();
-        float deltaToClosest = (averageEarDelayMsecs - closestFound);
-        if (deltaToClosest > -_combFilterWindow && deltaToClosest < _combFilterWindow) {
-            safeToInject = false;
+    QVector<float>& suppressedEchoes = (source == INBOUND_AUDIO) ? _inboundEchoesSuppressed : _localEchoesSuppressed;
+
+    echoTaps.clear();
+    knownDelays.clear();
+    suppressedEchoes.clear();
+    echoTaps.reserve(audiblePoints.size() * NUMBER_OF_CHANNELS);
+
+    foreach (const AudiblePoint& audiblePoint, audiblePoints) {
+        // calculate the distance to the ears
+        float rightEarDistance = glm::distance(audiblePoint.location, settings.rightEarPosition);
+        float leftEarDistance = glm::distance(audiblePoint.location, settings.leftEarPosition);
+
+        float rightEarDelayMsecs = settings.getDelayFromDistance(rightEarDistance) + audiblePoint.delay;
+        float leftEarDelayMsecs = settings.getDelayFromDistance(leftEarDistance) + audiblePoint.delay;
+        float averageEarDelayMsecs = (leftEarDelayMsecs + rightEarDelayMsecs) / 2.0f;
+        
+        bool safeToInject = true; // assume the best
+        
+        // check to see if this new injection point would be within the comb filter 
+        // suppression window for any of the existing known delays
+        QMap<float, float>::const_iterator lowerBound = knownDelays.lowerBound(averageEarDelayMsecs - _combFilterWindow);
+        if (lowerBound != knownDelays.end()) {
+            float closestFound = lowerBound.value();
+            float deltaToClosest = (averageEarDelayMsecs - closestFound);
+            if (deltaToClosest > -_combFilterWindow && deltaToClosest < _combFilterWindow) {
+                safeToInject = false;
+            }
+        }
+        
+        // keep track of any of our suppressed echoes so we can report them in our statistics
+        if (!safeToInject) {
+            suppressedEchoes << averageEarDelayMsecs;
+            continue;
         }
-    }
-    
-    // keep track of any of our suppressed echoes so we can report them in our statistics
-    if (!safeToInject) {
-        QVector<float>& suppressedEchoes = (source == INBOUND_AUDIO) ? _inboundEchoesSuppressed : _localEchoesSuppressed;
-        suppressedEchoes << averageEarDelayMsecs;
-    } else {
         knownDelays[averageEarDelayMsecs] = averageEarDelayMsecs;
 
         _totalDelay += rightEarDelayMsecs + leftEarDelayMsecs;
@@ -257,14 +312,11 @@ void AudioReflector::injectAudiblePoint(AudioSource source, const AudiblePoint&
         _minDelay = std::min(_minDelay,rightEarDelayMsecs);
         _minDelay = std::min(_minDelay,leftEarDelayMsecs);
         
-        int rightEarDelay = rightEarDelayMsecs * sampleRate / MSECS_PER_SECOND;
-        int leftEarDelay = leftEarDelayMsecs * sampleRate / MSECS_PER_SECOND;
-
         float rightEarAttenuation = audiblePoint.attenuation * 
-                                        getDistanceAttenuationCoefficient(rightEarDistance + audiblePoint.distance);
+                                        settings.getDistanceAttenuationCoefficient(rightEarDistance + audiblePoint.distance);
 
         float leftEarAttenuation = audiblePoint.attenuation * 
-                                        getDistanceAttenuationCoefficient(leftEarDistance + audiblePoint.distance);
+                                        settings.getDistanceAttenuationCoefficient(leftEarDistance + audiblePoint.distance);
 
         _totalAttenuation += rightEarAttenuation + leftEarAttenuation;
         _attenuationCount += 2;
@@ -272,35 +324,17 @@ void AudioReflector::injectAudiblePoint(AudioSource source, const AudiblePoint&
         _maxAttenuation = std::max(_maxAttenuation,leftEarAttenuation);
         _minAttenuation = std::min(_minAttenuation,rightEarAttenuation);
         _minAttenuation = std::min(_minAttenuation,leftEarAttenuation);
-    
-        // run through the samples, and attenuate them                                                            
-        for (int sample = 0; sample < totalNumberOfStereoSamples; sample++) {
-            int16_t leftSample = originalSamplesData[sample * NUMBER_OF_CHANNELS];
-            int16_t rightSample = leftSample;
-            if (wantStereo) {
-                rightSample = originalSamplesData[(sample * NUMBER_OF_CHANNELS) + 1];
-            }
 
-            attenuatedLeftSamplesData[sample * NUMBER_OF_CHANNELS] = 
-                        leftSample * leftEarAttenuation * _allEchoesAttenuation;
-            attenuatedLeftSamplesData[sample * NUMBER_OF_CHANNELS + 1] = 0;
+        AudioEchoTap leftEarTap = { leftEarDelayMsecs, leftEarAttenuation, 0 };
+        AudioEchoTap rightEarTap = { rightEarDelayMsecs, rightEarAttenuation, 1 };
+        echoTaps << leftEarTap << rightEarTap;
 
-            attenuatedRightSamplesData[sample * NUMBER_OF_CHANNELS] = 0;
-            attenuatedRightSamplesData[sample * NUMBER_OF_CHANNELS + 1] = 
-                        rightSample * rightEarAttenuation * _allEchoesAttenuation;
-        }
-        
-        // now inject the attenuated array with the appropriate delay
-        unsigned int sampleTimeLeft = sampleTime + leftEarDelay;
-        unsigned int sampleTimeRight = sampleTime + rightEarDelay;
-    
-        _audio->addSpatialAudioToBuffer(sampleTimeLeft, attenuatedLeftSamples, totalNumberOfSamples);
-        _audio->addSpatialAudioToBuffer(sampleTimeRight, attenuatedRightSamples, totalNumberOfSamples);
-        
         _injectedEchoes++;
     }
-}
 
+    // sorted by delay, taps that land close together can be mixed into one block
+    qStableSort(echoTaps.begin(), echoTaps.end(), echoTapDelayLessThan);
+}
 
 void AudioReflector::preProcessOriginalInboundAudio(unsigned int sampleTime, 
                                 QByteArray& samples, const QAudioFormat& format) {
@@ -332,65 +366,101 @@ void AudioReflector::processLocalAudio(unsigned int sampleTime, const QByteArray
                 stereoSamples[i* NUM_CHANNELS_OUTPUT] = monoSamples[i] * _localAudioAttenuationFactor;
                 stereoSamples[(i * NUM_CHANNELS_OUTPUT) + 1] = monoSamples[i] * _localAudioAttenuationFactor;
             }
-            _localAudioDelays.clear();
-            _localEchoesSuppressed.clear();
             echoAudio(LOCAL_AUDIO, sampleTime, stereoInputData, outputFormat);
-            _localEchoesCount = _localAudioDelays.size();
-            _localEchoesSuppressedCount = _localEchoesSuppressed.size();
         }
     }
 }
 
 void AudioReflector::processInboundAudio(unsigned int sampleTime, const QByteArray& samples, const QAudioFormat& format) {
-    _inboundAudioDelays.clear();
-    _inboundEchoesSuppressed.clear();
     echoAudio(INBOUND_AUDIO, sampleTime, samples, format);
-    _inboundEchoesCount = _inboundAudioDelays.size();
-    _inboundEchoesSuppressedCount = _inboundEchoesSuppressed.size();
 }
 
+// Every echo tap is a copy of the samples, delayed and attenuated, mixed into one ear. The taps are sorted by delay, so
+// we walk them once, gathering the ones that start within a few buffers of each other into a block that each tap is
+// accumulated into with a plain multiply-add over contiguous floats, and add each block to the spatial audio buffer
+// in one call.
 void AudioReflector::echoAudio(AudioSource source, unsigned int sampleTime, const QByteArray& samples, const QAudioFormat& format) {
     QMutexLocker locker(&_mutex);
 
-    _maxDelay = 0;
-    _maxAttenuation = 0.0f;
-    _minDelay = std::numeric_limits<int>::max();
-    _minAttenuation = std::numeric_limits<float>::max();
-    _totalDelay = 0.0f;
-    _delayCount = 0;
-    _totalAttenuation = 0.0f;
-    _attenuationCount = 0;
-
-    // depending on if we're processing local or external audio, pick the correct points vector
-    QVector<AudiblePoint>& audiblePoints = source == INBOUND_AUDIO ? _inboundAudiblePoints : _localAudiblePoints;
+    const QVector<AudioEchoTap>& echoTaps = (source == INBOUND_AUDIO) ? _inboundEchoTaps : _localEchoTaps;
+    if (source == INBOUND_AUDIO) {
+        _inboundEchoesCount = _inboundAudioDelays.size();
+        _inboundEchoesSuppressedCount = _inboundEchoesSuppressed.size();
+    } else {
+        _localEchoesCount = _localAudioDelays.size();
+        _localEchoesSuppressedCount = _localEchoesSuppressed.size();
+    }
 
-    int injectCalls = 0;
-    _injectedEchoes = 0;
-    foreach(const AudiblePoint& audiblePoint, audiblePoints) {
-        injectCalls++;
-        injectAudiblePoint(source, audiblePoint, samples, sampleTime, format.sampleRate());
+    int numberOfStereoSamples = samples.size() / (sizeof(int16_t) * NUMBER_OF_CHANNELS);
+    if (echoTaps.isEmpty() || numberOfStereoSamples == 0) {
+        return;
     }
-    
-    /*
-    qDebug() << "injectCalls=" << injectCalls;
-    qDebug() << "_injectedEchoes=" << _injectedEchoes;
-    */
 
-    _averageDelay = _delayCount == 0 ? 0 : _totalDelay / _delayCount;
-    _averageAttenuation = _attenuationCount == 0 ? 0 : _totalAttenuation / _attenuationCount;
-    
-    if (_reflections == 0) {
-        _minDelay = 0.0f;
-        _minAttenuation = 0.0f;
+    // split the samples into one channel per ear, applying the echoes attenuation once rather than once per tap
+    bool wantStereo = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingStereoSource);
+    const int16_t* originalSamplesData = (const int16_t*)samples.constData();
+    for (int channel = 0; channel < NUMBER_OF_CHANNELS; channel++) {
+        _echoSourceSamples[channel].resize(numberOfStereoSamples);
     }
-    
-    _officialMaxDelay = _maxDelay;
-    _officialMinDelay = _minDelay;
-    _officialMaxAttenuation = _maxAttenuation;
-    _officialMinAttenuation = _minAttenuation;
-    _officialAverageDelay = _averageDelay;
-    _officialAverageAttenuation = _averageAttenuation;
+    float* leftSourceSamples = _echoSourceSamples[0].data();
+    float* rightSourceSamples = _echoSourceSamples[1].data();
+    for (int sample = 0; sample < numberOfStereoSamples; sample++) {
+        float leftSample = originalSamplesData[sample * NUMBER_OF_CHANNELS];
+        float rightSample = wantStereo ? originalSamplesData[(sample * NUMBER_OF_CHANNELS) + 1] : leftSample;
+        leftSourceSamples[sample] = leftSample * _allEchoesAttenuation;
+        rightSourceSamples[sample] = rightSample * _allEchoesAttenuation;
+    }
+
+    int sampleRate = format.sampleRate();
+    int maximumBlockSpread = numberOfStereoSamples * ECHO_BLOCK_SPREAD_BUFFERS;
+    int firstTap = 0;
+    while (firstTap < echoTaps.size()) {
+        int blockDelay = echoTaps.at(firstTap).delay * sampleRate / MSECS_PER_SECOND;
+
+        // gather the taps that start close enough to the first one
+        int endTap = firstTap + 1;
+        int lastDelay = blockDelay;
+        while (endTap < echoTaps.size()) {
+            int delay = echoTaps.at(endTap).delay * sampleRate / MSECS_PER_SECOND;
+            if (delay - blockDelay > maximumBlockSpread) {
+                break;
+            }
+            lastDelay = delay;
+            endTap++;
+        }
 
+        int blockLength = (lastDelay - blockDelay) + numberOfStereoSamples;
+        for (int channel = 0; channel < NUMBER_OF_CHANNELS; channel++) {
+            _echoBlockSamples[channel].fill(0.0f, blockLength);
+        }
+
+        for (int tap = firstTap; tap < endTap; tap++) {
+            const AudioEchoTap& echoTap = echoTaps.at(tap);
+            int delay = echoTap.delay * sampleRate / MSECS_PER_SECOND;
+            float attenuation = echoTap.attenuation;
+            const float* sourceSamples = _echoSourceSamples[echoTap.channel].constData();
+            float* blockSamples = _echoBlockSamples[echoTap.channel].data() + (delay - blockDelay);
+            for (int sample = 0; sample < numberOfStereoSamples; sample++) {
+                blockSamples[sample] += sourceSamples[sample] * attenuation;
+            }
+        }
+
+        // interleave the ears back into the output format
+        int totalNumberOfSamples = blockLength * NUMBER_OF_CHANNELS;
+        _echoBlock.resize(totalNumberOfSamples * sizeof(int16_t));
+        int16_t* echoBlockData = (int16_t*)_echoBlock.data();
+        const float* leftBlockSamples = _echoBlockSamples[0].constData();
+        const float* rightBlockSamples = _echoBlockSamples[1].constData();
+        for (int sample = 0; sample < blockLength; sample++) {
+            echoBlockData[sample * NUMBER_OF_CHANNELS] = glm::clamp(leftBlockSamples[sample], 
+                (float)std::numeric_limits<int16_t>::min(), (float)std::numeric_limits<int16_t>::max());
+            echoBlockData[sample * NUMBER_OF_CHANNELS + 1] = glm::clamp(rightBlockSamples[sample], 
+                (float)std::numeric_limits<int16_t>::min(), (float)std::numeric_limits<int16_t>::max());
+        }
+
+        _audio->addSpatialAudioToBuffer(sampleTime + blockDelay, _echoBlock, totalNumberOfSamples);
+        firstTap = endTap;
+    }
 }
 
 void AudioReflector::drawVector(const glm::vec3& start, const glm::vec3& end, const glm::vec3& color) {
@@ -431,15 +501,11 @@ AudioPath::AudioPath(AudioSource source, const glm::vec3& origin, const glm::vec
 {
 }
 
-void AudioReflector::addAudioPath(AudioSource source, const glm::vec3& origin, const glm::vec3& initialDirection, 
-                                        float initialAttenuation, float initialDelay, float initialDistance, bool isDiffusion) {
-                                        
-    AudioPath* path = new AudioPath(source, origin, initialDirection, initialAttenuation, initialDelay,
-                                        initialDistance, isDiffusion, 0);
-
-    QVector<AudioPath*>& audioPaths = source == INBOUND_AUDIO ? _inboundAudioPaths : _localAudioPaths;
-
-    audioPaths.push_back(path);
+AudioPathTracer::AudioPathTracer(VoxelTree* voxels, const AudioReflectorSettings& settings) :
+    _voxels(voxels),
+    _settings(settings)
+{
+    setAutoDelete(false);
 }
 
 // NOTE: This is a prototype of an eventual utility that will identify the speaking sources for the inbound audio
@@ -469,18 +535,26 @@ void AudioReflector::calculateAllReflections() {
                             || !isSimilarPosition(listenerPosition, _listenerPosition)
                             || haveAttributesChanged();
 
+    AudioReflectorSettings settings = getCurrentSettings();
+
     if (shouldRecalc) {
-        QMutexLocker locker(&_mutex);
         quint64 start = usecTimestampNow();        
         _origin = origin;
         _orientation = orientation;
         _listenerPosition = listenerPosition;
-        analyzePaths(); // actually does the work
+        analyzePaths(settings); // actually does the work
         quint64 end = usecTimestampNow();
         const bool wantDebugging = false;
         if (wantDebugging) {
             qDebug() << "newCalculateAllReflections() elapsed=" << (end - start);
         }
+
+    } else if (!isSimilarPosition(settings.leftEarPosition, _tapsLeftEarPosition, EAR_POSITION_SIMILAR_ENOUGH)
+            || !isSimilarPosition(settings.rightEarPosition, _tapsRightEarPosition, EAR_POSITION_SIMILAR_ENOUGH)
+            || _combFilterWindow != _tapsCombFilterWindow) {
+        // the paths still hold, but what the ears hear of them has changed
+        QMutexLocker locker(&_mutex);
+        calculateEchoTaps(settings);
     }
 }    
 
@@ -554,9 +628,10 @@ void AudioReflector::clearPaths() {
 // attenuation, path length, and delay for the primary path. For surfaces that have diffusion, it will also create
 // fanout number of new paths, those new paths will have an origin of the reflection point, and an initial attenuation
 // of their diffusion ratio. Those new paths will be added to the active audio paths, and be analyzed for the next loop.
-void AudioReflector::analyzePaths() {
-    clearPaths();
-    
+// Paths never interact, so the initial paths are dealt out to one tracer per thread, each of which follows its paths
+// and their diffusions to completion. The results are merged in tracer order once all of them are done, and only the
+// merge holds the mutex the audio thread waits on.
+void AudioReflector::analyzePaths(const AudioReflectorSettings& settings) {
     // add our initial paths
     glm::vec3 right = glm::normalize(_orientation * IDENTITY_RIGHT);
     glm::vec3 up = glm::normalize(_orientation * IDENTITY_UP);
@@ -575,43 +650,55 @@ void AudioReflector::analyzePaths() {
 
     float initialAttenuation = 1.0f;    
 
-    float preDelay = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingPreDelay) ? _preDelay : 0.0f;
+    float preDelay = settings.preDelay;
 
     // NOTE: we're still calculating our initial paths based on the listeners position. But the analysis code has been
     // updated to support individual sound sources (which is how we support diffusion), we can use this new paradigm to
     // add support for individual sound sources, and more directional sound sources    
+    glm::vec3 inboundDirections[] = { front, right, up, down, back, left, frontRightUp, frontLeftUp, backRightUp,
+        backLeftUp, frontRightDown, frontLeftDown, backRightDown, backLeftDown };
 
-    addAudioPath(INBOUND_AUDIO, _origin, front, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, right, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, up, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, down, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, back, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, left, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, frontRightUp, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, frontLeftUp, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, backRightUp, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, backLeftUp, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, frontRightDown, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, frontLeftDown, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, backRightDown, initialAttenuation, preDelay);
-    addAudioPath(INBOUND_AUDIO, _origin, backLeftDown, initialAttenuation, preDelay);
-    
     // the original paths for the local audio are directional to the front of the origin
-    addAudioPath(LOCAL_AUDIO, _origin, front, initialAttenuation, preDelay);
-    addAudioPath(LOCAL_AUDIO, _origin, frontRightUp, initialAttenuation, preDelay);
-    addAudioPath(LOCAL_AUDIO, _origin, frontLeftUp, initialAttenuation, preDelay);
-    addAudioPath(LOCAL_AUDIO, _origin, frontRightDown, initialAttenuation, preDelay);
-    addAudioPath(LOCAL_AUDIO, _origin, frontLeftDown, initialAttenuation, preDelay);
-
-    // loop through all our audio paths and keep analyzing them until they complete
-    int steps = 0;
-    int acitvePaths = _inboundAudioPaths.size() + _localAudioPaths.size(); // when we start, all paths are active
-    while(acitvePaths > 0) {
-        acitvePaths = analyzePathsSingleStep();
-        steps++;
+    glm::vec3 localDirections[] = { front, frontRightUp, frontLeftUp, frontRightDown, frontLeftDown };
+
+    QVector<AudioPath*> initialPaths;
+    for (unsigned int i = 0; i < sizeof(inboundDirections) / sizeof(inboundDirections[0]); i++) {
+        initialPaths.push_back(new AudioPath(INBOUND_AUDIO, _origin, inboundDirections[i], initialAttenuation, preDelay));
+    }
+    for (unsigned int i = 0; i < sizeof(localDirections) / sizeof(localDirections[0]); i++) {
+        initialPaths.push_back(new AudioPath(LOCAL_AUDIO, _origin, localDirections[i], initialAttenuation, preDelay));
+    }
+
+    // the calling thread traces too, so there is one more tracer than pool threads
+    int tracerCount = qMin(_tracerPool.maxThreadCount() + 1, initialPaths.size());
+    QVector<AudioPathTracer*> tracers;
+    for (int i = 0; i < tracerCount; i++) {
+        tracers.push_back(new AudioPathTracer(_voxels, settings));
+    }
+    for (int i = 0; i < initialPaths.size(); i++) {
+        tracers[i % tracerCount]->addAudioPath(initialPaths.at(i));
+    }
+    for (int i = 1; i < tracerCount; i++) {
+        _tracerPool.start(tracers.at(i));
+    }
+    tracers.at(0)->run();
+    _tracerPool.waitForDone();
+
+    QMutexLocker locker(&_mutex);
+    clearPaths();
+    foreach (AudioPathTracer* tracer, tracers) {
+        foreach (AudioPath* path, tracer->paths) {
+            QVector<AudioPath*>& audioPaths = path->source == INBOUND_AUDIO ? _inboundAudioPaths : _localAudioPaths;
+            audioPaths.push_back(path);
+        }
+        _inboundAudiblePoints += tracer->inboundAudiblePoints;
+        _localAudiblePoints += tracer->localAudiblePoints;
+        delete tracer;
     }
     _reflections = _inboundAudiblePoints.size() + _localAudiblePoints.size();
     _diffusionPathCount = countDiffusionPaths();
+
+    calculateEchoTaps(settings);
 }
 
 int AudioReflector::countDiffusionPaths() {
@@ -630,55 +717,59 @@ int AudioReflector::countDiffusionPaths() {
     return diffusionCount;
 }
 
-int AudioReflector::analyzePathsSingleStep() {
-    // iterate all the active sound paths, calculate one step per active path
-    int activePaths = 0;
-
-    QVector<AudioPath*>* pathsLists[] = { &_inboundAudioPaths, &_localAudioPaths };
-
-    for(unsigned int i = 0; i < sizeof(pathsLists) / sizeof(pathsLists[0]); i++) {
+void AudioPathTracer::run() {
+    // iterate all the active sound paths, calculate one step per active path, until none are left
+    forever {
+        _rays.clear();
+        _rayPaths.clear();
+
+        // new diffusion paths are added to the end of the list as we go, and are first traced in the next step
+        int pathCount = paths.size();
+        for (int i = 0; i < pathCount; i++) {
+            AudioPath* path = paths.at(i);
+            if (path->finalized) {
+                continue;
+            }
+            if (path->bounceCount > ABSOLUTE_MAXIMUM_BOUNCE_COUNT) {
+                path->finalized = true;
+            } else {
+                _rays.push_back(OctreeRayQuery(path->lastPoint, path->lastDirection));
+                _rayPaths.push_back(path);
+            }
+        }
+        if (_rays.isEmpty()) {
+            break;
+        }
 
-        QVector<AudioPath*>& pathList = *pathsLists[i];
+        // TODO: we need to decide how we want to handle locking on the ray intersection, if we force lock,
+        // we get an accurate picture, but it could prevent rendering of the voxels. If we trylock (default), 
+        // we might not get ray intersections where they may exist, but we can't really detect that case...
+        // add last parameter of Octree::Lock to force locking
+        _voxels->findRayIntersections(_rays);
 
-        foreach(AudioPath* const& path, pathList) {
-    
-            glm::vec3 start = path->lastPoint;
-            glm::vec3 direction = path->lastDirection;
-            OctreeElement* elementHit; // output from findRayIntersection
-            float distance; // output from findRayIntersection
-            BoxFace face; // output from findRayIntersection
-
-            if (!path->finalized) {
-                activePaths++;
-            
-                if (path->bounceCount > ABSOLUTE_MAXIMUM_BOUNCE_COUNT) {
-                    path->finalized = true;
-                } else if (_voxels->findRayIntersection(start, direction, elementHit, distance, face)) {
-                    // TODO: we need to decide how we want to handle locking on the ray intersection, if we force lock,
-                    // we get an accurate picture, but it could prevent rendering of the voxels. If we trylock (default), 
-                    // we might not get ray intersections where they may exist, but we can't really detect that case...
-                    // add last parameter of Octree::Lock to force locking
-                    handlePathPoint(path, distance, elementHit, face);
+        for (int i = 0; i < _rays.size(); i++) {
+            const OctreeRayQuery& ray = _rays.at(i);
+            AudioPath* path = _rayPaths.at(i);
+            if (ray.intersects) {
+                handlePathPoint(path, ray.distance, ray.element, ray.face);
 
+            } else {
+                // If we didn't intersect, but this was a diffusion ray, then we will go ahead and cast a short ray out
+                // from our last known point, in the last known direction, and leave that sound source hanging there
+                if (path->isDiffusion) {
+                    const float MINIMUM_RANDOM_DISTANCE = 0.25f;
+                    const float MAXIMUM_RANDOM_DISTANCE = 0.5f;
+                    float distance = randFloatInRange(MINIMUM_RANDOM_DISTANCE, MAXIMUM_RANDOM_DISTANCE);
+                    handlePathPoint(path, distance, NULL, UNKNOWN_FACE);
                 } else {
-                    // If we didn't intersect, but this was a diffusion ray, then we will go ahead and cast a short ray out
-                    // from our last known point, in the last known direction, and leave that sound source hanging there
-                    if (path->isDiffusion) {
-                        const float MINIMUM_RANDOM_DISTANCE = 0.25f;
-                        const float MAXIMUM_RANDOM_DISTANCE = 0.5f;
-                        float distance = randFloatInRange(MINIMUM_RANDOM_DISTANCE, MAXIMUM_RANDOM_DISTANCE);
-                        handlePathPoint(path, distance, NULL, UNKNOWN_FACE);
-                    } else {
-                        path->finalized = true; // if it doesn't intersect, then it is finished
-                    }
+                    path->finalized = true; // if it doesn't intersect, then it is finished
                 }
             }
         }
     }
-    return activePaths;
 }
 
-void AudioReflector::handlePathPoint(AudioPath* path, float distance, OctreeElement* elementHit, BoxFace face) {
+void AudioPathTracer::handlePathPoint(AudioPath* path, float distance, OctreeElement* elementHit, BoxFace face) {
     glm::vec3 start = path->lastPoint;
     glm::vec3 direction = path->lastDirection;
     glm::vec3 end = start + (direction * (distance * SLIGHTLY_SHORT));
@@ -689,26 +780,26 @@ void AudioReflector::handlePathPoint(AudioPath* path, float distance, OctreeElem
 
     pathDistance += glm::distance(start, end);
 
-    float toListenerDistance = glm::distance(end, _listenerPosition);
+    float toListenerDistance = glm::distance(end, _settings.listenerPosition);
 
     // adjust our current delay by just the delay from the most recent ray
-    currentDelay += getDelayFromDistance(distance);
+    currentDelay += _settings.getDelayFromDistance(distance);
 
     // now we know the current attenuation for the "perfect" reflection case, but we now incorporate
     // our surface materials to determine how much of this ray is absorbed, reflected, and diffused
-    SurfaceCharacteristics material = getSurfaceCharacteristics(elementHit);
+    // all elements have the same material for now, see AudioReflector::getSurfaceCharacteristics()
+    const SurfaceCharacteristics& material = _settings.material;
 
     float reflectiveAttenuation = currentReflectiveAttenuation * material.reflectiveRatio;
     float totalDiffusionAttenuation = currentReflectiveAttenuation * material.diffusionRatio;
     
-    bool wantDiffusions = Menu::getInstance()->isOptionChecked(MenuOption::AudioSpatialProcessingWithDiffusions);
-    int fanout = wantDiffusions ? _diffusionFanout : 0;
+    int fanout = _settings.diffusionFanout;
 
     float partialDiffusionAttenuation = fanout < 1 ? 0.0f : totalDiffusionAttenuation / (float)fanout;
 
     // total delay includes the bounce back to listener
-    float totalDelay = currentDelay + getDelayFromDistance(toListenerDistance);
-    float toListenerAttenuation = getDistanceAttenuationCoefficient(toListenerDistance + pathDistance);
+    float totalDelay = currentDelay + _settings.getDelayFromDistance(toListenerDistance);
+    float toListenerAttenuation = _settings.getDistanceAttenuationCoefficient(toListenerDistance + pathDistance);
 
     // if our resulting partial diffusion attenuation, is still above our minimum attenuation
     // then we add new paths for each diffusion point
@@ -750,7 +841,8 @@ void AudioReflector::handlePathPoint(AudioPath* path, float distance, OctreeElem
             diffusion = glm::normalize(diffusion);
 
             // add new audio path for these diffusions, the new path's source is the same as the original source
-            addAudioPath(path->source, end, diffusion, partialDiffusionAttenuation, currentDelay, pathDistance, true);
+            addAudioPath(new AudioPath(path->source, end, diffusion, partialDiffusionAttenuation, currentDelay, pathDistance,
+                                        true));
         }
     } else {
         const bool wantDebugging = false;
@@ -781,7 +873,7 @@ void AudioReflector::handlePathPoint(AudioPath* path, float distance, OctreeElem
         // audio so that it can be adjusted to ear position
         AudiblePoint point = {end, currentDelay, (reflectiveAttenuation + totalDiffusionAttenuation), pathDistance};
 
-        QVector<AudiblePoint>& audiblePoints = path->source == INBOUND_AUDIO ? _inboundAudiblePoints : _localAudiblePoints;
+        QVector<AudiblePoint>& audiblePoints = path->source == INBOUND_AUDIO ? inboundAudiblePoints : localAudiblePoints;
 
         audiblePoints.push_back(point);
     
@@ -13,6 +13,8 @@
 #define interface_AudioReflector_h
 
 #include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
 
 #include <VoxelTree.h>
 
@@ -64,6 +66,58 @@ public:
     float diffusionRatio;
 };
 
+/// The settings that path tracing and echo taps depend on, read once on the main thread so the tracing threads never
+/// touch the menu or members that a script could change while they run
+class AudioReflectorSettings {
+public:
+    glm::vec3 listenerPosition;
+    glm::vec3 leftEarPosition;
+    glm::vec3 rightEarPosition;
+    float preDelay; /// 0 unless pre delay is enabled
+    float soundMsPerMeter;
+    bool doDistanceAttenuation;
+    bool alternateDistanceAttenuation;
+    float distanceAttenuationScalingFactor;
+    bool slightlyRandomSurfaces;
+    int diffusionFanout; /// 0 unless diffusions are enabled
+    SurfaceCharacteristics material;
+
+    float getDelayFromDistance(float distance) const;
+    float getDistanceAttenuationCoefficient(float distance) const;
+};
+
+/// One echo of an audible point as heard by one ear
+class AudioEchoTap {
+public:
+    float delay; /// msecs from the original sound to the ear
+    float attenuation; /// includes the distance attenuation to the ear, but not the echoes attenuation
+    int channel; /// 0 for the left ear, 1 for the right ear
+};
+
+/// Traces a share of the initial audio paths, and the diffusion paths they spawn, to completion. Each step casts one
+/// ray per active path, all of them in a single batched octree query.
+class AudioPathTracer : public QRunnable {
+public:
+    AudioPathTracer(VoxelTree* voxels, const AudioReflectorSettings& settings);
+
+    void addAudioPath(AudioPath* path) { paths.push_back(path); }
+
+    virtual void run();
+
+    QVector<AudioPath*> paths; /// all paths traced, the initial ones first; owned by whoever takes them
+    QVector<AudiblePoint> inboundAudiblePoints;
+    QVector<AudiblePoint> localAudiblePoints;
+
+private:
+    void handlePathPoint(AudioPath* path, float distance, OctreeElement* elementHit, BoxFace face);
+    glm::vec3 getFaceNormal(BoxFace face) const;
+
+    VoxelTree* _voxels;
+    const AudioReflectorSettings& _settings;
+    QVector<OctreeRayQuery> _rays;
+    QVector<AudioPath*> _rayPaths;
+};
+
 class AudioReflector : public QObject {
     Q_OBJECT
 public:
@@ -149,9 +203,6 @@ private:
     // Helpers for drawing
     void drawVector(const glm::vec3& start, const glm::vec3& end, const glm::vec3& color);
 
-    // helper for generically calculating attenuation based on distance
-    float getDistanceAttenuationCoefficient(float distance);
-
     // statistics
     int _reflections;
     int _diffusionPathCount;
@@ -179,6 +230,7 @@ private:
     
     QVector<AudioPath*> _inboundAudioPaths; /// audio paths we're processing for inbound audio
     QVector<AudiblePoint> _inboundAudiblePoints; /// the audible points that have been calculated from the inbound audio paths
+    QVector<AudioEchoTap> _inboundEchoTaps; /// the echoes of the inbound audible points, sorted by delay
     QMap<float, float> _inboundAudioDelays; /// delay times for currently injected audio points
     QVector<float> _inboundEchoesSuppressed; /// delay times for currently injected audio points
     int _inboundEchoesCount;
@@ -186,29 +238,25 @@ private:
 
     QVector<AudioPath*> _localAudioPaths; /// audio paths we're processing for local audio
     QVector<AudiblePoint> _localAudiblePoints; /// the audible points that have been calculated from the local audio paths
+    QVector<AudioEchoTap> _localEchoTaps; /// the echoes of the local audible points, sorted by delay
     QMap<float, float> _localAudioDelays; /// delay times for currently injected audio points
     QVector<float> _localEchoesSuppressed; /// delay times for currently injected audio points
     int _localEchoesCount;
     int _localEchoesSuppressedCount;
 
-    // adds a sound source to begin an audio path trace, these can be the initial sound sources with their directional properties,
-    // as well as diffusion sound sources
-    void addAudioPath(AudioSource source, const glm::vec3& origin, const glm::vec3& initialDirection, float initialAttenuation, 
-                            float initialDelay, float initialDistance = 0.0f, bool isDiffusion = false);
-    
     // helper that handles audioPath analysis
-    int analyzePathsSingleStep();
-    void handlePathPoint(AudioPath* path, float distance, OctreeElement* elementHit, BoxFace face);
+    AudioReflectorSettings getCurrentSettings();
     void clearPaths();
-    void analyzePaths();
+    void analyzePaths(const AudioReflectorSettings& settings);
     void drawRays();
     void drawPath(AudioPath* path, const glm::vec3& originalColor);
     void calculateAllReflections();
     int countDiffusionPaths();
-    glm::vec3 getFaceNormal(BoxFace face);
     void identifyAudioSources();
 
-    void injectAudiblePoint(AudioSource source, const AudiblePoint& audiblePoint, const QByteArray& samples, unsigned int sampleTime, int sampleRate);
+    // turns the audible points into the echo taps heard by each ear, suppressing the ones that would comb filter
+    void calculateEchoTaps(const AudioReflectorSettings& settings);
+    void calculateEchoTaps(AudioSource source, const AudioReflectorSettings& settings);
     void echoAudio(AudioSource source, unsigned int sampleTime, const QByteArray& samples, const QAudioFormat& format);
     
     // return the surface characteristics of the element we hit
@@ -216,6 +264,17 @@ private:
     
     
     QMutex _mutex;
+    QThreadPool _tracerPool;
+
+    // the ear positions and comb filter window the echo taps were calculated with
+    glm::vec3 _tapsLeftEarPosition;
+    glm::vec3 _tapsRightEarPosition;
+    float _tapsCombFilterWindow;
+
+    // scratch buffers for echoAudio(), one per ear
+    QVector<float> _echoSourceSamples[2];
+    QVector<float> _echoBlockSamples[2];
+    QByteArray _echoBlock;
 
     float _preDelay;
     float _soundMsPerMeter;
@@ -362,8 +362,3 @@ float ModelTreeRenderer::getSizeScale() const {
 int ModelTreeRenderer::getBoundaryLevelAdjust() const { 
     return Menu::getInstance()->getBoundaryLevelAdjust();
 }
-
-
-void ModelTreeRenderer::processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) {
-    static_cast<ModelTree*>(_tree)->processEraseMessage(dataByteArray, sourceNode);
-}
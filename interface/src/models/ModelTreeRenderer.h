@@ -44,8 +44,6 @@ public:
 
     ModelTree* getTree() { return (ModelTree*)_tree; }
 
-    void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
-
     virtual void init();
     virtual void render(RenderMode renderMode = DEFAULT_RENDER_MODE);
 
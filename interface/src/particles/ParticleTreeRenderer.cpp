@@ -125,11 +125,3 @@ void ParticleTreeRenderer::renderElement(OctreeElement* element, RenderArgs* arg
         }
     }
 }
-
-void ParticleTreeRenderer::processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) {
-    if (_tree){
-        _tree->lockForWrite();
-        static_cast<ParticleTree*>(_tree)->processEraseMessage(dataByteArray, sourceNode);
-        _tree->unlock();
-    }
-}
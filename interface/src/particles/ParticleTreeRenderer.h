@@ -40,8 +40,6 @@ public:
 
     ParticleTree* getTree() { return (ParticleTree*)_tree; }
 
-    void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
-
     virtual void init();
     virtual void render(RenderMode renderMode = DEFAULT_RENDER_MODE);
 
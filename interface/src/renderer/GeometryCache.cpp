@@ -11,15 +11,30 @@
 
 #include <cmath>
 
+#include <QDir>
+#include <QFile>
 #include <QNetworkReply>
 #include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QThreadPool>
 
+#include <BakedFBXGeometry.h>
+
 #include "Application.h"
 #include "GeometryCache.h"
 #include "Model.h"
 #include "world.h"
 
+static QString createBakedGeometryDirectory() {
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/bakedGeometry";
+    return QDir().mkpath(path) ? path : QString();
+}
+
+GeometryCache::GeometryCache() :
+    _bakedGeometryDirectory(createBakedGeometryDirectory()) {
+}
+
 GeometryCache::~GeometryCache() {
     foreach (const VerticesIndices& vbo, _hemisphereVBOs) {
         glDeleteBuffers(1, &vbo.first);
@@ -485,7 +500,7 @@ class GeometryReader : public QRunnable {
 public:
 
     GeometryReader(const QWeakPointer<Resource>& geometry, const QUrl& url,
-        QNetworkReply* reply, const QVariantHash& mapping);
+        QNetworkReply* reply, const QVariantHash& mapping, const QString& bakedGeometryDirectory);
 
     virtual void run();
 
@@ -495,14 +510,55 @@ private:
     QUrl _url;
     QNetworkReply* _reply;
     QVariantHash _mapping;
+    QString _bakedGeometryDirectory;
 };
 
 GeometryReader::GeometryReader(const QWeakPointer<Resource>& geometry, const QUrl& url,
-        QNetworkReply* reply, const QVariantHash& mapping) :
+        QNetworkReply* reply, const QVariantHash& mapping, const QString& bakedGeometryDirectory) :
     _geometry(geometry),
     _url(url),
     _reply(reply),
-    _mapping(mapping) {
+    _mapping(mapping),
+    _bakedGeometryDirectory(bakedGeometryDirectory) {
+}
+
+/// Reads FBX geometry through the baked geometry cache in the given directory. The first load of a model with a mapping
+/// parses the FBX and bakes the result, later loads map the baked file.
+static FBXGeometry readFBXThroughBakedCache(const QString& directory, const QByteArray& model,
+                                            const QVariantHash& mapping) {
+    if (directory.isEmpty()) {
+        return readFBX(model, mapping);
+    }
+    QString path = directory + "/" + getBakedFBXGeometryKey(model, mapping) + ".geometry";
+
+    QFile bakedFile(path);
+    if (bakedFile.open(QIODevice::ReadOnly)) {
+        uchar* data = bakedFile.map(0, bakedFile.size());
+        if (data) {
+            try {
+                FBXGeometry geometry = readBakedFBXGeometry(data, bakedFile.size());
+                bakedFile.unmap(data);
+                return geometry;
+
+            } catch (const QString& error) {
+                qDebug() << "Baking " << path << " again: " << error;
+                bakedFile.unmap(data);
+            }
+        }
+        bakedFile.close();
+    }
+
+    FBXGeometry geometry = readFBX(model, mapping);
+
+    // the file only appears once it is complete, so other readers never map half of it
+    QSaveFile saveFile(path);
+    if (saveFile.open(QIODevice::WriteOnly)) {
+        writeBakedFBXGeometry(&saveFile, geometry);
+        if (!saveFile.commit()) {
+            qDebug() << "Failed to write baked geometry " << path;
+        }
+    }
+    return geometry;
 }
 
 void GeometryReader::run() {
@@ -513,7 +569,8 @@ void GeometryReader::run() {
     }
     try {
         QMetaObject::invokeMethod(geometry.data(), "setGeometry", Q_ARG(const FBXGeometry&,
-            _url.path().toLower().endsWith(".svo") ? readSVO(_reply->readAll()) : readFBX(_reply->readAll(), _mapping)));
+            _url.path().toLower().endsWith(".svo") ? readSVO(_reply->readAll()) :
+                readFBXThroughBakedCache(_bakedGeometryDirectory, _reply->readAll(), _mapping)));
         
     } catch (const QString& error) {
         qDebug() << "Error reading " << _url << ": " << error;
@@ -570,7 +627,8 @@ void NetworkGeometry::downloadFinished(QNetworkReply* reply) {
     }
     
     // send the reader off to the thread pool
-    QThreadPool::globalInstance()->start(new GeometryReader(_self, url, reply, _mapping));
+    QThreadPool::globalInstance()->start(new GeometryReader(_self, url, reply, _mapping,
+        Application::getInstance()->getGeometryCache()->getBakedGeometryDirectory()));
 }
 
 void NetworkGeometry::reinsert() {
@@ -35,6 +35,7 @@ class GeometryCache : public ResourceCache {
 
 public:
     
+    GeometryCache();
     virtual ~GeometryCache();
     
     void renderHemisphere(int slices, int stacks);
@@ -47,6 +48,9 @@ public:
     /// \param delayLoad if true, don't load the geometry immediately; wait until load is first requested
     QSharedPointer<NetworkGeometry> getGeometry(const QUrl& url, const QUrl& fallback = QUrl(), bool delayLoad = false);
 
+    /// Returns the directory that geometry is baked in, or an empty string if there is none.
+    const QString& getBakedGeometryDirectory() const { return _bakedGeometryDirectory; }
+
 public slots:
 
     void setBlendedVertices(const QPointer<Model>& model, const QWeakPointer<NetworkGeometry>& geometry,
@@ -68,6 +72,9 @@ private:
     QHash<IntPair, QOpenGLBuffer> _gridBuffers;
     
     QHash<QUrl, QWeakPointer<NetworkGeometry> > _networkGeometry;
+
+    // created with the cache, so the readers on the thread pool only ever read it
+    QString _bakedGeometryDirectory;
 };
 
 /// Geometry loaded from the network.
@@ -10,12 +10,14 @@
 //
 
 #include <QMetaType>
+#include <QMutex>
 #include <QRunnable>
 #include <QThreadPool>
 
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/norm.hpp>
 
+#include <BlendshapeEvaluator.h>
 #include <CapsuleShape.h>
 #include <GeometryUtil.h>
 #include <PhysicsEntity.h>
@@ -814,10 +816,18 @@ void Model::updateShapePositions() {
     // TODO: implement this when we know how to build shapes for regular Models
 }
 
+/// The blendshape evaluator of a model, which keeps the last blend so that the next one only applies what changed.
+/// Shared with the blenders on the thread pool, which take turns with it.
+class BlendState {
+public:
+    QMutex mutex;
+    BlendshapeEvaluator evaluator;
+};
+
 class Blender : public QRunnable {
 public:
 
-    Blender(Model* model, const QWeakPointer<NetworkGeometry>& geometry,
+    Blender(Model* model, const QWeakPointer<NetworkGeometry>& geometry, const QSharedPointer<BlendState>& state,
         const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients);
     
     virtual void run();
@@ -826,14 +836,16 @@ private:
     
     QPointer<Model> _model;
     QWeakPointer<NetworkGeometry> _geometry;
+    QSharedPointer<BlendState> _state;
     QVector<FBXMesh> _meshes;
     QVector<float> _blendshapeCoefficients;
 };
 
-Blender::Blender(Model* model, const QWeakPointer<NetworkGeometry>& geometry,
+Blender::Blender(Model* model, const QWeakPointer<NetworkGeometry>& geometry, const QSharedPointer<BlendState>& state,
         const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients) :
     _model(model),
     _geometry(geometry),
+    _state(state),
     _meshes(meshes),
     _blendshapeCoefficients(blendshapeCoefficients) {
 }
@@ -843,37 +855,18 @@ void Blender::run() {
     if (_model.isNull() || _geometry.isNull()) {
         return;
     }
-    QVector<glm::vec3> vertices, normals;
-    int offset = 0;
-    foreach (const FBXMesh& mesh, _meshes) {
-        if (mesh.blendshapes.isEmpty()) {
-            continue;
-        }
-        vertices += mesh.vertices;
-        normals += mesh.normals;
-        glm::vec3* meshVertices = vertices.data() + offset;
-        glm::vec3* meshNormals = normals.data() + offset;
-        offset += mesh.vertices.size();
-        const float NORMAL_COEFFICIENT_SCALE = 0.01f;
-        for (int i = 0, n = qMin(_blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
-            float vertexCoefficient = _blendshapeCoefficients.at(i);
-            if (vertexCoefficient < EPSILON) {
-                continue;
-            }
-            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
-            const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
-            for (int j = 0; j < blendshape.indices.size(); j++) {
-                int index = blendshape.indices.at(j);
-                meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
-                meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
-            }
-        }
+    QMutexLocker locker(&_state->mutex);
+    BlendshapeEvaluator& evaluator = _state->evaluator;
+    evaluator.setMeshes(_meshes);
+    if (!evaluator.evaluate(_blendshapeCoefficients)) {
+        return; // the model already has these vertices
     }
     
-    // post the result to the geometry cache, which will dispatch to the model if still alive
+    // post the result to the geometry cache, which will dispatch to the model if still alive; we post before letting
+    // the next blender in so that the results arrive in the order they were blended
     QMetaObject::invokeMethod(Application::getInstance()->getGeometryCache(), "setBlendedVertices",
         Q_ARG(const QPointer<Model>&, _model), Q_ARG(const QWeakPointer<NetworkGeometry>&, _geometry),
-        Q_ARG(const QVector<glm::vec3>&, vertices), Q_ARG(const QVector<glm::vec3>&, normals));
+        Q_ARG(const QVector<glm::vec3>&, evaluator.getVertices()), Q_ARG(const QVector<glm::vec3>&, evaluator.getNormals()));
 }
 
 void Model::setScaleToFit(bool scaleToFit, float largestDimension) {
@@ -985,7 +978,11 @@ void Model::simulateInternal(float deltaTime) {
     
     // post the blender
     if (geometry.hasBlendedMeshes()) {
-        QThreadPool::globalInstance()->start(new Blender(this, _geometry, geometry.meshes, _blendshapeCoefficients));
+        if (!_blendState) {
+            _blendState = QSharedPointer<BlendState>(new BlendState());
+        }
+        QThreadPool::globalInstance()->start(new Blender(this, _geometry, _blendState, geometry.meshes,
+            _blendshapeCoefficients));
     }
 }
 
@@ -1336,6 +1333,7 @@ void Model::deleteGeometry() {
     }
     _attachments.clear();
     _blendedVertexBuffers.clear();
+    _blendState.clear(); // the new buffers will need a full blend
     _jointStates.clear();
     _meshStates.clear();
     clearShapes();
@@ -27,6 +27,7 @@
 #include "TextureCache.h"
 
 class AnimationHandle;
+class BlendState;
 class Shape;
 
 typedef QSharedPointer<AnimationHandle> AnimationHandlePointer;
@@ -239,6 +240,7 @@ private:
     QUrl _url;
         
     QVector<QOpenGLBuffer> _blendedVertexBuffers;
+    QSharedPointer<BlendState> _blendState;
     
     QVector<QVector<QSharedPointer<Texture> > > _dilatedTextures;
     
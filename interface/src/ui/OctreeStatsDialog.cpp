@@ -50,6 +50,7 @@ OctreeStatsDialog::OctreeStatsDialog(QWidget* parent, NodeToOctreeSceneStats* mo
     _localVoxels = AddStatItem("Local Elements");
     _localVoxelsMemory = AddStatItem("Elements Memory");
     _voxelsRendered = AddStatItem("Voxels Rendered");
+    _packetPipeline = AddStatItem("Voxel Packet Pipeline");
     _sendingMode = AddStatItem("Sending Mode");
     
     layout()->setSizeConstraint(QLayout::SetFixedSize); 
@@ -137,6 +138,18 @@ void OctreeStatsDialog::paintEvent(QPaintEvent* event) {
         "Changed: " << voxels->getVoxelsUpdated() / 1000.f << "K ";
     label->setText(statsValue.str().c_str());
 
+    // Voxel packets waiting to be read into the tree, and how long they waited and held the tree's write lock
+    label = _labels[_packetPipeline];
+    const OctreePacketPipeline& pipeline = voxels->getPacketPipeline();
+    statsValue.str("");
+    statsValue <<
+        "Queued: " << pipeline.getQueuedPacketCount() << " (max " << pipeline.getMaxQueuedPacketCount() << ") " <<
+        "Latency: " << pipeline.getAverageApplyLatencyUsecs() / USECS_PER_MSEC << "ms " <<
+        "(max " << pipeline.getLongestApplyLatencyUsecs() / (float)USECS_PER_MSEC << "ms) " <<
+        "Lock Window: " << pipeline.getAverageApplyWindowUsecs() / USECS_PER_MSEC << "ms " <<
+        "(max " << pipeline.getLongestApplyWindowUsecs() / (float)USECS_PER_MSEC << "ms)";
+    label->setText(statsValue.str().c_str());
+
     // Voxels Memory Usage
     label = _labels[_localVoxelsMemory];
     statsValue.str("");
@@ -64,6 +64,7 @@ private:
     int _localVoxels;
     int _localVoxelsMemory;
     int _voxelsRendered;
+    int _packetPipeline;
     int _voxelServerLables[MAX_VOXEL_SERVERS];
     int _voxelServerLabelsCount;
     details _extraServerDetails[MAX_VOXEL_SERVERS];
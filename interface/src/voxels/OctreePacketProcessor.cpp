@@ -15,6 +15,25 @@
 #include "Menu.h"
 #include "OctreePacketProcessor.h"
 
+// how long to wait for more packets while the pipelines are still decoding
+const unsigned long PIPELINE_BUSY_WAIT_MSECS = 1;
+
+unsigned long OctreePacketProcessor::getMaxWait() const {
+    Application* app = Application::getInstance();
+    if (app->_voxels.getPacketPipeline().hasQueuedPackets() || app->_particles.getPacketPipeline().hasQueuedPackets() ||
+            app->_models.getPacketPipeline().hasQueuedPackets()) {
+        return PIPELINE_BUSY_WAIT_MSECS;
+    }
+    return ReceivedPacketProcessor::getMaxWait();
+}
+
+void OctreePacketProcessor::postProcess() {
+    Application* app = Application::getInstance();
+    app->_voxels.applyQueuedPackets();
+    app->_particles.applyQueuedPackets();
+    app->_models.applyQueuedPackets();
+}
+
 void OctreePacketProcessor::processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet) {
     PerformanceWarning warn(Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings),
                             "OctreePacketProcessor::processPacket()");
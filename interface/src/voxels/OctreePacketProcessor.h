@@ -20,5 +20,12 @@ class OctreePacketProcessor : public ReceivedPacketProcessor {
     Q_OBJECT
 protected:
     virtual void processPacket(const SharedNodePointer& sendingNode, const QByteArray& packet);
+
+    /// Wakes up shortly while the trees' packet pipelines still hold packets, so that those get read into the trees
+    /// even when no more packets come in.
+    virtual unsigned long getMaxWait() const;
+
+    /// Reads the packets the pipelines have decoded since the last packet was processed into the trees.
+    virtual void postProcess();
 };
 #endif // hifi_OctreePacketProcessor_h
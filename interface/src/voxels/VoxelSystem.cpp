@@ -81,6 +81,7 @@ VoxelSystem::VoxelSystem(float treeScale, int maxVoxels, VoxelTree* tree)
     _writeRenderFullVBO = true;
     _readRenderFullVBO = true;
     _tree = (tree) ? tree : new VoxelTree();
+    _packetPipeline.setTree(_tree);
 
     _tree->getRoot()->setVoxelSystem(this);
 
@@ -554,83 +555,40 @@ int VoxelSystem::parseData(const QByteArray& packet) {
     PerformanceWarning warn(showTimingDetails, "VoxelSystem::parseData()",showTimingDetails);
 
     PacketType command = packetTypeForPacket(packet);
-    int numBytesPacketHeader = numBytesForPacketHeader(packet);
     switch(command) {
         case PacketTypeVoxelData: {
-            PerformanceWarning warn(showTimingDetails, "VoxelSystem::parseData() PacketType_VOXEL_DATA part...",showTimingDetails);
-            
-            const unsigned char* dataAt = reinterpret_cast<const unsigned char*>(packet.data()) + numBytesPacketHeader;
-
-            OCTREE_PACKET_FLAGS flags = (*(OCTREE_PACKET_FLAGS*)(dataAt));
-            dataAt += sizeof(OCTREE_PACKET_FLAGS);
-            OCTREE_PACKET_SEQUENCE sequence = (*(OCTREE_PACKET_SEQUENCE*)dataAt);
-            dataAt += sizeof(OCTREE_PACKET_SEQUENCE);
-
-            OCTREE_PACKET_SENT_TIME sentAt = (*(OCTREE_PACKET_SENT_TIME*)dataAt);
-            dataAt += sizeof(OCTREE_PACKET_SENT_TIME);
-
-            bool packetIsColored = oneAtBit(flags, PACKET_IS_COLOR_BIT);
-            bool packetIsCompressed = oneAtBit(flags, PACKET_IS_COMPRESSED_BIT);
-
-            OCTREE_PACKET_SENT_TIME arrivedAt = usecTimestampNow();
-            int flightTime = arrivedAt - sentAt;
-
-            OCTREE_PACKET_INTERNAL_SECTION_SIZE sectionLength = 0;
-            unsigned int dataBytes = packet.size() - (numBytesPacketHeader + OCTREE_PACKET_EXTRA_HEADERS_SIZE);
-
-            int subsection = 1;
-            while (dataBytes > 0) {
-                if (packetIsCompressed) {
-                    if (dataBytes > sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE)) {
-                        sectionLength = (*(OCTREE_PACKET_INTERNAL_SECTION_SIZE*)dataAt);
-                        dataAt += sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
-                        dataBytes -= sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
-                    } else {
-                        sectionLength = 0;
-                        dataBytes = 0; // stop looping something is wrong
-                    }
-                } else {
-                    sectionLength = dataBytes;
-                }
-
-                if (sectionLength) {
-                    PerformanceWarning warn(showTimingDetails, "VoxelSystem::parseData() section");
-                    // ask the VoxelTree to read the bitstream into the tree
-                    ReadBitstreamToTreeParams args(packetIsColored ? WANT_COLOR : NO_COLOR, WANT_EXISTS_BITS, NULL, getDataSourceUUID());
-                    _tree->lockForWrite();
-                    OctreePacketData packetData(packetIsCompressed);
-                    packetData.loadFinalizedContent(dataAt, sectionLength);
-                    if (Application::getInstance()->getLogger()->extraDebugging()) {
-                        qDebug("VoxelSystem::parseData() ... Got Packet Section"
-                               " color:%s compressed:%s sequence: %u flight:%d usec size:%d data:%u"
-                               " subsection:%d sectionLength:%d uncompressed:%d",
-                            debug::valueOf(packetIsColored), debug::valueOf(packetIsCompressed),
-                            sequence, flightTime, packet.size(), dataBytes, subsection, sectionLength,
-                               packetData.getUncompressedSize());
-                    }
-                    _tree->readBitstreamToTree(packetData.getUncompressedData(), packetData.getUncompressedSize(), args);
-                    _tree->unlock();
-
-                    dataBytes -= sectionLength;
-                    dataAt += sectionLength;
-                }
+            // the sections are decompressed off this thread, and read into the tree in short write lock windows
+            _packetPipeline.queuePacket(packet, SharedNodePointer());
+            if (Application::getInstance()->getLogger()->extraDebugging()) {
+                qDebug("VoxelSystem::parseData() ... queued packet size:%d, packets in pipeline:%d",
+                       packet.size(), _packetPipeline.getQueuedPacketCount());
             }
-            subsection++;
         }
         default:
             break;
     }
-    if (!_useFastVoxelPipeline || _writeRenderFullVBO) {
-        setupNewVoxelsForDrawing();
-    } else {
-        setupNewVoxelsForDrawingSingleNode(DONT_BAIL_EARLY);
-    }
+    applyQueuedPackets();
 
     Application::getInstance()->getBandwidthMeter()->inputStream(BandwidthMeter::VOXELS).updateValue(packet.size());
 
     return packet.size();
 }
 
+int VoxelSystem::applyQueuedPackets() {
+    bool showTimingDetails = Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings);
+    PerformanceWarning warn(showTimingDetails, "VoxelSystem::applyQueuedPackets()", showTimingDetails);
+
+    int sectionsApplied = _packetPipeline.applyDecodedSections();
+    if (sectionsApplied > 0) {
+        if (!_useFastVoxelPipeline || _writeRenderFullVBO) {
+            setupNewVoxelsForDrawing();
+        } else {
+            setupNewVoxelsForDrawingSingleNode(DONT_BAIL_EARLY);
+        }
+    }
+    return sectionsApplied;
+}
+
 void VoxelSystem::setupNewVoxelsForDrawing() {
     PerformanceWarning warn(Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings),
                             "setupNewVoxelsForDrawing()");
@@ -1219,7 +1177,13 @@ void VoxelSystem::init() {
 }
 
 void VoxelSystem::changeTree(VoxelTree* newTree) {
+    // what's queued was meant for the old tree
+    _tree->lockForWrite();
+    _packetPipeline.discardQueued();
+    _tree->unlock();
+
     _tree = newTree;
+    _packetPipeline.setTree(_tree);
 
     _tree->setDirtyBit();
     _tree->getRoot()->setVoxelSystem(this);
@@ -1565,6 +1529,7 @@ void VoxelSystem::killLocalVoxels() {
     VoxelSystem* voxelSystem = _tree->getRoot()->getVoxelSystem();
     _tree->eraseAllOctreeElements();
     _tree->getRoot()->setVoxelSystem(voxelSystem);
+    _packetPipeline.discardQueued();
     _tree->unlock();
     clearFreeBufferIndexes();
     if (_usePrimitiveRenderer) {
@@ -1834,6 +1799,10 @@ public:
     unsigned long nodesOutsideOutside;
     unsigned long nodesShown;
 
+    // the locations of elements in the views, from batches tested by their parents before recursing into them
+    ChildrenFrustumLocations inFrustumLocations;
+    ChildrenFrustumLocations inLastCulledFrustumLocations;
+
     hideOutOfViewArgs(VoxelSystem* voxelSystem, VoxelTree* tree,
                         bool culledOnce, bool widenViewFrustum, bool wantDeltaFrustums) :
         thisVoxelSystem(voxelSystem),
@@ -1949,13 +1918,14 @@ bool VoxelSystem::hideAllSubTreeOperation(OctreeElement* element, void* extraDat
     ViewFrustum::location inLastCulledFrustum;
 
     if (args->culledOnce && args->wantDeltaFrustums) {
-        inLastCulledFrustum = voxel->inFrustum(args->lastViewFrustum);
+        inLastCulledFrustum = args->inLastCulledFrustumLocations.getLocation(voxel, args->lastViewFrustum);
 
         // if this node is fully OUTSIDE our last culled view frustum, then we don't need to recurse further
         if (inLastCulledFrustum == ViewFrustum::OUTSIDE) {
             args->nodesOutsideOutside++;
             return false;
         }
+        args->inLastCulledFrustumLocations.storeChildrenLocations(voxel, args->lastViewFrustum);
     }
 
     args->nodesOutside++;
@@ -1977,13 +1947,15 @@ bool VoxelSystem::showAllSubTreeOperation(OctreeElement* element, void* extraDat
     // how to proceed. If we've never culled, then we just consider all these voxels to be UNKNOWN so that we will not
     // consider that case.
     if (args->culledOnce && args->wantDeltaFrustums) {
-        ViewFrustum::location inLastCulledFrustum = voxel->inFrustum(args->lastViewFrustum);
+        ViewFrustum::location inLastCulledFrustum = args->inLastCulledFrustumLocations.getLocation(voxel,
+            args->lastViewFrustum);
 
         // if this node is fully inside our last culled view frustum, then we don't need to recurse further
         if (inLastCulledFrustum == ViewFrustum::INSIDE) {
             args->nodesInsideInside++;
             return false;
         }
+        args->inLastCulledFrustumLocations.storeChildrenLocations(voxel, args->lastViewFrustum);
     }
 
     args->nodesInside++;
@@ -2012,7 +1984,7 @@ bool VoxelSystem::hideOutOfViewOperation(OctreeElement* element, void* extraData
     
     // If we're still recursing the tree using this operator, then we don't know if we're inside or outside...
     // so before we move forward we need to determine our frustum location
-    ViewFrustum::location inFrustum = voxel->inFrustum(args->thisViewFrustum);
+    ViewFrustum::location inFrustum = args->inFrustumLocations.getLocation(voxel, args->thisViewFrustum);
 
     // If we've culled at least once, then we will use the status of this voxel in the last culled frustum to determine
     // how to proceed. If we've never culled, then we just consider all these voxels to be UNKNOWN so that we will not
@@ -2020,7 +1992,7 @@ bool VoxelSystem::hideOutOfViewOperation(OctreeElement* element, void* extraData
     ViewFrustum::location inLastCulledFrustum = ViewFrustum::OUTSIDE; // assume outside, but should get reset to actual value
 
     if (args->culledOnce && args->wantDeltaFrustums) {
-        inLastCulledFrustum = voxel->inFrustum(args->lastViewFrustum);
+        inLastCulledFrustum = args->inLastCulledFrustumLocations.getLocation(voxel, args->lastViewFrustum);
     }
 
     // ok, now do some processing for this node...
@@ -2089,6 +2061,10 @@ bool VoxelSystem::hideOutOfViewOperation(OctreeElement* element, void* extraData
             // If it INTERSECTS but shouldn't be displayed, then it's probably a parent and it is at least partially in view.
             // So we DO want to recurse the children because some of them may not be in view... nothing specifically to do,
             // just keep iterating the children
+            args->inFrustumLocations.storeChildrenLocations(voxel, args->thisViewFrustum);
+            if (args->culledOnce && args->wantDeltaFrustums) {
+                args->inLastCulledFrustumLocations.storeChildrenLocations(voxel, args->lastViewFrustum);
+            }
             return true;
 
         } break;
@@ -20,6 +20,7 @@
 #include <NodeData.h>
 #include <ViewFrustum.h>
 #include <VoxelTree.h>
+#include <OctreePacketPipeline.h>
 #include <OctreePersistThread.h>
 
 #include "Camera.h"
@@ -53,8 +54,18 @@ public:
     void setDataSourceUUID(const QUuid& dataSourceUUID) { _dataSourceUUID = dataSourceUUID; }
     const QUuid&  getDataSourceUUID() const { return _dataSourceUUID; }
 
+    /// Queues a voxel data packet to be decoded off this thread, and reads whatever packets are decoded by now into the
+    /// tree.
     int parseData(const QByteArray& packet);
 
+    /// Reads the decoded voxel packets into the tree, holding the write lock for one of the pipeline's windows, and sets
+    /// up the new voxels for drawing.
+    /// \return the number of packet sections read
+    int applyQueuedPackets();
+
+    OctreePacketPipeline& getPacketPipeline() { return _packetPipeline; }
+    const OctreePacketPipeline& getPacketPipeline() const { return _packetPipeline; }
+
     bool isInitialized() { return _initialized; }
     virtual void init();
     void render();
@@ -249,6 +260,8 @@ private:
     bool _falseColorizeBySource;
     QUuid _dataSourceUUID;
 
+    OctreePacketPipeline _packetPipeline;
+
     int _voxelServerCount;
     unsigned long _memoryUsageRAM;
     unsigned long _memoryUsageVBO;
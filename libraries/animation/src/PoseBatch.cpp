@@ -0,0 +1,312 @@
+//
+//  PoseBatch.cpp
+//  libraries/animation/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <glm/gtx/transform.hpp>
+
+#include <SharedUtil.h>
+
+#include "PoseBatch.h"
+
+Skeleton::Skeleton() :
+    _parentIndices(),
+    _geometryJointIndices(),
+    _jointIndices(),
+    _preTransforms(),
+    _preRotations(),
+    _postRotations(),
+    _postTransforms(),
+    _defaultRotations() {
+}
+
+Skeleton::Skeleton(const FBXGeometry& geometry) :
+    _parentIndices(),
+    _geometryJointIndices(),
+    _jointIndices(),
+    _preTransforms(),
+    _preRotations(),
+    _postRotations(),
+    _postTransforms(),
+    _defaultRotations() {
+
+    int numJoints = geometry.joints.size();
+    bool parentsComeFirst = true;
+    for (int i = 0; i < numJoints && parentsComeFirst; i++) {
+        parentsComeFirst = geometry.joints.at(i).parentIndex < i;
+    }
+
+    // otherwise order the joints by depth, which puts every parent before its children
+    if (parentsComeFirst) {
+        for (int i = 0; i < numJoints; i++) {
+            _geometryJointIndices.append(i);
+        }
+    } else {
+        QVector<int> depths(numJoints, 0);
+        int maxDepth = 0;
+        for (int i = 0; i < numJoints; i++) {
+            for (int parent = geometry.joints.at(i).parentIndex; parent != -1 && depths[i] <= numJoints;
+                    parent = geometry.joints.at(parent).parentIndex) {
+                depths[i]++;
+            }
+            maxDepth = qMax(maxDepth, depths.at(i));
+        }
+        for (int depth = 0; depth <= maxDepth; depth++) {
+            for (int i = 0; i < numJoints; i++) {
+                if (depths.at(i) == depth) {
+                    _geometryJointIndices.append(i);
+                }
+            }
+        }
+    }
+
+    QVector<int> skeletonJointIndices(numJoints, -1);
+    for (int i = 0; i < numJoints; i++) {
+        skeletonJointIndices[_geometryJointIndices.at(i)] = i;
+    }
+    for (int i = 0; i < numJoints; i++) {
+        const FBXJoint& joint = geometry.joints.at(_geometryJointIndices.at(i));
+        _parentIndices.append(joint.parentIndex == -1 ? -1 : skeletonJointIndices.at(joint.parentIndex));
+        _jointIndices.insert(joint.name, i);
+        _preTransforms.append(glm::translate(joint.translation) * joint.preTransform);
+        _preRotations.append(joint.preRotation);
+        _postRotations.append(joint.postRotation);
+        _postTransforms.append(joint.postTransform);
+        _defaultRotations.append(joint.rotation);
+    }
+}
+
+void Skeleton::computeTransforms(const glm::mat4& baseTransform, const glm::quat* rotations, glm::mat4* transforms) const {
+    const int* parentIndices = _parentIndices.constData();
+    const glm::mat4* preTransforms = _preTransforms.constData();
+    const glm::quat* preRotations = _preRotations.constData();
+    const glm::quat* postRotations = _postRotations.constData();
+    const glm::mat4* postTransforms = _postTransforms.constData();
+    for (int i = 0, n = _parentIndices.size(); i < n; i++) {
+        glm::quat rotation = preRotations[i] * rotations[i] * postRotations[i];
+        const glm::mat4& parentTransform = (parentIndices[i] == -1) ? baseTransform : transforms[parentIndices[i]];
+        transforms[i] = parentTransform * preTransforms[i] * glm::mat4_cast(rotation) * postTransforms[i];
+    }
+}
+
+AnimationClip::AnimationClip() :
+    _jointIndices(),
+    _rotations(),
+    _numFrames(0) {
+}
+
+AnimationClip::AnimationClip(const Skeleton& skeleton, const FBXGeometry& animationGeometry,
+        const QStringList& maskedJoints) :
+    _jointIndices(),
+    _rotations(),
+    _numFrames(animationGeometry.animationFrames.size()) {
+
+    // the animation joints that the skeleton has and that aren't masked, like NetworkGeometry::getJointMappings()
+    QVector<int> animationJointIndices;
+    for (int i = 0; i < animationGeometry.joints.size(); i++) {
+        const QString& name = animationGeometry.joints.at(i).name;
+        int jointIndex = skeleton.getJointIndex(name);
+        if (jointIndex != -1 && !maskedJoints.contains(name)) {
+            animationJointIndices.append(i);
+            _jointIndices.append(jointIndex);
+        }
+    }
+
+    int numChannels = _jointIndices.size();
+    _rotations.resize(_numFrames * numChannels);
+    for (int frame = 0; frame < _numFrames; frame++) {
+        const QVector<glm::quat>& frameRotations = animationGeometry.animationFrames.at(frame).rotations;
+        glm::quat* rotations = _rotations.data() + frame * numChannels;
+        for (int i = 0; i < numChannels; i++) {
+            int animationJointIndex = animationJointIndices.at(i);
+            rotations[i] = (animationJointIndex < frameRotations.size()) ? frameRotations.at(animationJointIndex) :
+                skeleton.getDefaultRotation(_jointIndices.at(i));
+        }
+    }
+}
+
+void AnimationClip::sample(float frameIndex, glm::quat* rotations) const {
+    if (_numFrames == 0) {
+        return;
+    }
+    int numChannels = _jointIndices.size();
+    const glm::quat* floorRotations = _rotations.constData() + ((int)glm::floor(frameIndex) % _numFrames) * numChannels;
+    const glm::quat* ceilRotations = _rotations.constData() + ((int)glm::ceil(frameIndex) % _numFrames) * numChannels;
+    float frameFraction = glm::fract(frameIndex);
+    if (floorRotations == ceilRotations) {
+        for (int i = 0; i < numChannels; i++) {
+            rotations[i] = floorRotations[i];
+        }
+        return;
+    }
+    for (int i = 0; i < numChannels; i++) {
+        rotations[i] = safeMix(floorRotations[i], ceilRotations[i], frameFraction);
+    }
+}
+
+PoseBatch::PoseBatch() :
+    _poses(),
+    _rotations(),
+    _priorities(),
+    _transforms(),
+    _layers(),
+    _sortedLayers(),
+    _layersAreDirty(false),
+    _samples(),
+    _workerSamples(),
+    _rangeSplitter() {
+}
+
+void PoseBatch::clear() {
+    _poses.clear();
+    _rotations.clear();
+    _priorities.clear();
+    _transforms.clear();
+    _layers.clear();
+    _sortedLayers.clear();
+    _layersAreDirty = false;
+}
+
+int PoseBatch::addPose(const Skeleton* skeleton) {
+    assert(skeleton);
+    Pose pose = { skeleton, _rotations.size(), glm::mat4(), 0, 0 };
+    _poses.push_back(pose);
+    for (int i = 0; i < skeleton->getNumJoints(); i++) {
+        _rotations.push_back(skeleton->getDefaultRotation(i));
+    }
+    _priorities.resize(_rotations.size());
+    _transforms.resize(_rotations.size());
+    clearJointPriorities(_poses.size() - 1);
+    return _poses.size() - 1;
+}
+
+void PoseBatch::setJointRotation(int poseIndex, int jointIndex, const glm::quat& rotation, float priority) {
+    int index = _poses.at(poseIndex).firstJoint + jointIndex;
+    if (priority >= _priorities.at(index)) {
+        _rotations[index] = rotation;
+        _priorities[index] = priority;
+    }
+}
+
+const glm::quat& PoseBatch::getJointRotation(int poseIndex, int jointIndex) const {
+    return _rotations.at(_poses.at(poseIndex).firstJoint + jointIndex);
+}
+
+float PoseBatch::getJointPriority(int poseIndex, int jointIndex) const {
+    return _priorities.at(_poses.at(poseIndex).firstJoint + jointIndex);
+}
+
+void PoseBatch::clearJointPriorities(int poseIndex) {
+    const Pose& pose = _poses.at(poseIndex);
+    for (int i = 0; i < pose.skeleton->getNumJoints(); i++) {
+        _priorities[pose.firstJoint + i] = 0.0f;
+    }
+}
+
+int PoseBatch::addLayer(int poseIndex, const AnimationClip* clip, float priority) {
+    assert(clip);
+    Layer layer = { poseIndex, clip, priority, 0.0f, true };
+    _layers.push_back(layer);
+    _layersAreDirty = true;
+    return _layers.size() - 1;
+}
+
+const glm::mat4* PoseBatch::getTransforms(int poseIndex) const {
+    return _transforms.constData() + _poses.at(poseIndex).firstJoint;
+}
+
+void PoseBatch::sortLayers() {
+    // a stable counting sort by pose, then an insertion sort by priority within each pose, which keeps the layers
+    // of equal priority in the order they were added
+    int numPoses = _poses.size();
+    QVector<int> layerCounts(numPoses, 0);
+    foreach (const Layer& layer, _layers) {
+        layerCounts[layer.poseIndex]++;
+    }
+    int firstLayer = 0;
+    for (int i = 0; i < numPoses; i++) {
+        _poses[i].firstLayer = firstLayer;
+        _poses[i].numLayers = 0;
+        firstLayer += layerCounts.at(i);
+    }
+    _sortedLayers.resize(_layers.size());
+    for (int i = 0; i < _layers.size(); i++) {
+        Pose& pose = _poses[_layers.at(i).poseIndex];
+        int position = pose.firstLayer + pose.numLayers++;
+        while (position > pose.firstLayer && _layers.at(_sortedLayers.at(position - 1)).priority < _layers.at(i).priority) {
+            _sortedLayers[position] = _sortedLayers.at(position - 1);
+            position--;
+        }
+        _sortedLayers[position] = i;
+    }
+    _layersAreDirty = false;
+}
+
+void PoseBatch::evaluatePoses(int firstPose, int lastPose, QVector<glm::quat>& samples) {
+    for (int i = firstPose; i < lastPose; i++) {
+        const Pose& pose = _poses.at(i);
+        glm::quat* rotations = _rotations.data() + pose.firstJoint;
+        float* priorities = _priorities.data() + pose.firstJoint;
+
+        // sample every channel of a layer in one go, then keep the ones the layer has the priority for
+        for (int j = 0; j < pose.numLayers; j++) {
+            const Layer& layer = _layers.at(_sortedLayers.at(pose.firstLayer + j));
+            const AnimationClip* clip = layer.clip;
+            if (!layer.enabled || clip->getNumFrames() == 0) {
+                continue;
+            }
+            int numChannels = clip->getNumChannels();
+            if (samples.size() < numChannels) {
+                samples.resize(numChannels);
+            }
+            clip->sample(layer.frameIndex, samples.data());
+            for (int k = 0; k < numChannels; k++) {
+                int jointIndex = clip->getJointIndex(k);
+                if (layer.priority >= priorities[jointIndex]) {
+                    rotations[jointIndex] = samples.at(k);
+                    priorities[jointIndex] = layer.priority;
+                }
+            }
+        }
+        pose.skeleton->computeTransforms(pose.baseTransform, rotations, _transforms.data() + pose.firstJoint);
+    }
+}
+
+void PoseBatch::evaluate(int poseIndex) {
+    if (_layersAreDirty) {
+        sortLayers();
+    }
+    evaluatePoses(poseIndex, poseIndex + 1, _samples);
+}
+
+void PoseBatch::evaluateAll() {
+    if (_layersAreDirty) {
+        sortLayers();
+    }
+    int numPoses = _poses.size();
+    int numWorkers = _rangeSplitter.getNumWorkers(numPoses);
+    if (numWorkers == 1) {
+        evaluatePoses(0, numPoses, _samples);
+        return;
+    }
+
+    // the arrays of the poses are written from several threads at once, so detach them here rather than there
+    _rotations.data();
+    _priorities.data();
+    _transforms.data();
+
+    if (_workerSamples.size() < numWorkers) {
+        _workerSamples.resize(numWorkers);
+    }
+    _rangeSplitter.run(*this, numPoses);
+}
+
+void PoseBatch::processRange(int worker, int firstPose, int lastPose) {
+    evaluatePoses(firstPose, lastPose, _workerSamples[worker]);
+}
@@ -0,0 +1,181 @@
+//
+//  PoseBatch.h
+//  libraries/animation/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PoseBatch_h
+#define hifi_PoseBatch_h
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+#include <FBXReader.h>
+#include <RangeSplitter.h>
+
+/// The joints of a model, flattened into arrays in parent-before-child order.  Keeps the order of the model's joints
+/// when they are already parent before child, which readFBX() makes them, so that joint indices are the same.
+class Skeleton {
+public:
+    Skeleton();
+    Skeleton(const FBXGeometry& geometry);
+
+    int getNumJoints() const { return _parentIndices.size(); }
+
+    /// \return the index of the named joint, or -1 if there is none
+    int getJointIndex(const QString& name) const { return _jointIndices.value(name, -1); }
+
+    /// \return the index in the geometry of the joint at the given index in the skeleton
+    int getGeometryJointIndex(int jointIndex) const { return _geometryJointIndices.at(jointIndex); }
+
+    int getParentIndex(int jointIndex) const { return _parentIndices.at(jointIndex); }
+
+    const glm::quat& getDefaultRotation(int jointIndex) const { return _defaultRotations.at(jointIndex); }
+
+    /// Computes the model frame transforms of all of the joints from their rotations in the constrained frame, the way
+    /// JointState::computeTransform() does for one joint, in a single pass from the root out.
+    /// \param baseTransform the transform of the parent of the root joints
+    void computeTransforms(const glm::mat4& baseTransform, const glm::quat* rotations, glm::mat4* transforms) const;
+
+private:
+    QVector<int> _parentIndices;
+    QVector<int> _geometryJointIndices;
+    QHash<QString, int> _jointIndices;
+
+    // translate(translation) * preTransform, which is all a joint's transform needs before its rotation
+    QVector<glm::mat4> _preTransforms;
+    QVector<glm::quat> _preRotations;
+    QVector<glm::quat> _postRotations;
+    QVector<glm::mat4> _postTransforms;
+    QVector<glm::quat> _defaultRotations;
+};
+
+/// The frames of an animation for the joints of a skeleton, packed one frame after the other with a rotation for each
+/// animation joint that the skeleton has, in skeleton order.
+class AnimationClip {
+public:
+    AnimationClip();
+
+    /// \param animationGeometry the geometry of an Animation from the AnimationCache
+    /// \param maskedJoints names of joints that the animation should leave alone
+    AnimationClip(const Skeleton& skeleton, const FBXGeometry& animationGeometry,
+        const QStringList& maskedJoints = QStringList());
+
+    int getNumFrames() const { return _numFrames; }
+
+    /// \return the number of joints that the clip animates
+    int getNumChannels() const { return _jointIndices.size(); }
+
+    /// \return the index in the skeleton of the joint that a channel animates
+    int getJointIndex(int channel) const { return _jointIndices.at(channel); }
+
+    /// Blends between the closest two frames like AnimationHandle::applyFrame(), writing a rotation for each channel.
+    void sample(float frameIndex, glm::quat* rotations) const;
+
+private:
+    QVector<int> _jointIndices;
+    QVector<glm::quat> _rotations;
+    int _numFrames;
+};
+
+/// Poses many skeletons at once.  Each pose keeps a rotation and an animation priority for every joint, as JointState
+/// does, which its animation layers overwrite in order of priority before one pass computes all of its transforms.
+/// evaluateAll() spreads the poses over a thread pool with a RangeSplitter.
+class PoseBatch : public RangeWork {
+public:
+    PoseBatch();
+
+    /// Removes all poses and layers.
+    void clear();
+
+    /// Adds a pose of a skeleton, which has to outlive the batch, starting from its default rotations.
+    /// \return the index of the pose
+    int addPose(const Skeleton* skeleton);
+
+    int getNumPoses() const { return _poses.size(); }
+
+    /// Sets the transform of the parent of the root joints of a pose.
+    void setBaseTransform(int poseIndex, const glm::mat4& transform) { _poses[poseIndex].baseTransform = transform; }
+
+    /// Sets the rotation of a joint in its constrained frame, if the priority is at least that of the joint.
+    void setJointRotation(int poseIndex, int jointIndex, const glm::quat& rotation, float priority);
+
+    const glm::quat& getJointRotation(int poseIndex, int jointIndex) const;
+    float getJointPriority(int poseIndex, int jointIndex) const;
+
+    /// Resets the priorities of the joints of a pose, so that any layer can take them over.
+    void clearJointPriorities(int poseIndex);
+
+    /// Animates a pose with a clip, which has to outlive the batch.  Layers are applied in order of decreasing
+    /// priority and then in the order they were added, like the running animations of a Model.
+    /// \return the index of the layer
+    int addLayer(int poseIndex, const AnimationClip* clip, float priority);
+
+    void setLayerFrame(int layerIndex, float frameIndex) { _layers[layerIndex].frameIndex = frameIndex; }
+    void setLayerEnabled(int layerIndex, bool enabled) { _layers[layerIndex].enabled = enabled; }
+
+    /// Applies the layers of a pose and computes its transforms on the calling thread.
+    void evaluate(int poseIndex);
+
+    /// Evaluates all of the poses, spread over the thread pool.
+    void evaluateAll();
+
+    /// \return the model frame transforms of the joints of a pose, in skeleton order
+    const glm::mat4* getTransforms(int poseIndex) const;
+
+private:
+    class Pose {
+    public:
+        const Skeleton* skeleton;
+        int firstJoint;
+        glm::mat4 baseTransform;
+        int firstLayer;
+        int numLayers;
+    };
+
+    class Layer {
+    public:
+        int poseIndex;
+        const AnimationClip* clip;
+        float priority;
+        float frameIndex;
+        bool enabled;
+    };
+
+    void sortLayers();
+
+    /// Evaluates the poses in [firstPose, lastPose), sampling into the given buffer.  Runs on the worker threads, so
+    /// the layers must be sorted.
+    void evaluatePoses(int firstPose, int lastPose, QVector<glm::quat>& samples);
+
+    /// evaluates a run of poses for evaluateAll(), sampling into the buffer of the worker
+    virtual void processRange(int worker, int firstPose, int lastPose);
+
+    QVector<Pose> _poses;
+
+    // the joints of all of the poses, pose after pose
+    QVector<glm::quat> _rotations;
+    QVector<float> _priorities;
+    QVector<glm::mat4> _transforms;
+
+    // the layers as added, and their indices ordered by pose and then by priority
+    QVector<Layer> _layers;
+    QVector<int> _sortedLayers;
+    bool _layersAreDirty;
+
+    QVector<glm::quat> _samples;
+    QVector<QVector<glm::quat> > _workerSamples;
+
+    RangeSplitter _rangeSplitter;
+};
+
+#endif // hifi_PoseBatch_h
@@ -0,0 +1,233 @@
+//
+//  ADPCMAudioCodec.cpp
+//  libraries/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstdlib>
+#include <cstring>
+
+#include "AudioRingBuffer.h"
+
+#include "ADPCMAudioCodec.h"
+
+static const int STEP_TABLE_SIZE = 89;
+
+static const int STEP_TABLE[STEP_TABLE_SIZE] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107,
+    118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int FRAME_HEADER_BYTES = sizeof(quint8) + sizeof(quint16);
+static const int CHANNEL_STATE_BYTES = sizeof(int16_t) + sizeof(quint8);
+
+static int encodedSize(int numFramesPerChannel, int numChannels) {
+    if (numFramesPerChannel == 0) {
+        return FRAME_HEADER_BYTES;
+    }
+    int numNibbles = (numFramesPerChannel - 1) * numChannels;
+    return FRAME_HEADER_BYTES + numChannels * CHANNEL_STATE_BYTES + (numNibbles + 1) / 2;
+}
+
+// moves the predictor by the difference the nibble codes and adapts the step index, the same on both ends
+static inline void applyNibble(int nibble, int& predictor, int& stepIndex) {
+    int step = STEP_TABLE[stepIndex];
+    int delta = step >> 3;
+    if (nibble & 4) {
+        delta += step;
+    }
+    if (nibble & 2) {
+        delta += step >> 1;
+    }
+    if (nibble & 1) {
+        delta += step >> 2;
+    }
+    predictor += (nibble & 8) ? -delta : delta;
+    predictor = qBound(MIN_SAMPLE_VALUE, predictor, MAX_SAMPLE_VALUE);
+
+    stepIndex = qBound(0, stepIndex + INDEX_TABLE[nibble], STEP_TABLE_SIZE - 1);
+}
+
+static inline int encodeSample(int sample, int& predictor, int& stepIndex) {
+    int difference = sample - predictor;
+    int nibble = 0;
+    if (difference < 0) {
+        nibble = 8;
+        difference = -difference;
+    }
+
+    int step = STEP_TABLE[stepIndex];
+    if (difference >= step) {
+        nibble |= 4;
+        difference -= step;
+    }
+    step >>= 1;
+    if (difference >= step) {
+        nibble |= 2;
+        difference -= step;
+    }
+    step >>= 1;
+    if (difference >= step) {
+        nibble |= 1;
+    }
+
+    applyNibble(nibble, predictor, stepIndex);
+    return nibble;
+}
+
+int ADPCMAudioCodec::getMaxEncodedSize(int numSamples, int numChannels) const {
+    return encodedSize(numSamples / numChannels, numChannels);
+}
+
+int ADPCMAudioCodec::encode(const int16_t* samples, int numSamples, int numChannels, char* encoded) const {
+    if (numChannels < 1 || numChannels > ADPCM_MAX_CHANNELS) {
+        return 0;
+    }
+
+    int numFramesPerChannel = numSamples / numChannels;
+    quint8 channelsByte = numChannels;
+    quint16 framesField = numFramesPerChannel;
+
+    char* dataAt = encoded;
+    memcpy(dataAt, &channelsByte, sizeof(quint8));
+    dataAt += sizeof(quint8);
+    memcpy(dataAt, &framesField, sizeof(quint16));
+    dataAt += sizeof(quint16);
+
+    if (numFramesPerChannel == 0) {
+        return dataAt - encoded;
+    }
+
+    int predictors[ADPCM_MAX_CHANNELS];
+    int stepIndices[ADPCM_MAX_CHANNELS];
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        // every frame starts over from its first sample, with a step that suits the first difference, so frames can be
+        // decoded without the ones before them
+        predictors[channel] = samples[channel];
+
+        int firstDifference = (numFramesPerChannel > 1) ? abs(samples[numChannels + channel] - samples[channel]) : 0;
+        int stepIndex = 0;
+        while (stepIndex < STEP_TABLE_SIZE - 1 && STEP_TABLE[stepIndex] * 2 < firstDifference) {
+            stepIndex++;
+        }
+        stepIndices[channel] = stepIndex;
+
+        int16_t firstSample = samples[channel];
+        quint8 stepIndexByte = stepIndex;
+        memcpy(dataAt, &firstSample, sizeof(int16_t));
+        dataAt += sizeof(int16_t);
+        memcpy(dataAt, &stepIndexByte, sizeof(quint8));
+        dataAt += sizeof(quint8);
+    }
+
+    const int16_t* sampleAt = samples + numChannels;
+    const int16_t* samplesEnd = samples + numFramesPerChannel * numChannels;
+    int channel = 0;
+    bool isHighNibble = false;
+    quint8 nibbles = 0;
+
+    while (sampleAt != samplesEnd) {
+        int nibble = encodeSample(*sampleAt++, predictors[channel], stepIndices[channel]);
+        if (isHighNibble) {
+            *dataAt++ = nibbles | (nibble << 4);
+        } else {
+            nibbles = nibble;
+        }
+        isHighNibble = !isHighNibble;
+
+        if (++channel == numChannels) {
+            channel = 0;
+        }
+    }
+    if (isHighNibble) {
+        *dataAt++ = nibbles;
+    }
+
+    return dataAt - encoded;
+}
+
+int ADPCMAudioCodec::decode(const char* encoded, int maxSize, int16_t* samples, int maxSamples, int& numSamples) const {
+    numSamples = 0;
+    if (maxSize < FRAME_HEADER_BYTES) {
+        return -1;
+    }
+
+    quint8 channelsByte;
+    quint16 framesField;
+    const char* dataAt = encoded;
+    memcpy(&channelsByte, dataAt, sizeof(quint8));
+    dataAt += sizeof(quint8);
+    memcpy(&framesField, dataAt, sizeof(quint16));
+    dataAt += sizeof(quint16);
+
+    int numChannels = channelsByte;
+    int numFramesPerChannel = framesField;
+    if (numChannels < 1 || numChannels > ADPCM_MAX_CHANNELS || numFramesPerChannel * numChannels > maxSamples
+        || encodedSize(numFramesPerChannel, numChannels) > maxSize) {
+        return -1;
+    }
+
+    if (numFramesPerChannel == 0) {
+        return dataAt - encoded;
+    }
+
+    int predictors[ADPCM_MAX_CHANNELS];
+    int stepIndices[ADPCM_MAX_CHANNELS];
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        int16_t firstSample;
+        quint8 stepIndexByte;
+        memcpy(&firstSample, dataAt, sizeof(int16_t));
+        dataAt += sizeof(int16_t);
+        memcpy(&stepIndexByte, dataAt, sizeof(quint8));
+        dataAt += sizeof(quint8);
+
+        samples[channel] = firstSample;
+        predictors[channel] = firstSample;
+        stepIndices[channel] = qMin((int) stepIndexByte, STEP_TABLE_SIZE - 1);
+    }
+
+    int16_t* sampleAt = samples + numChannels;
+    int16_t* samplesEnd = samples + numFramesPerChannel * numChannels;
+    int channel = 0;
+    bool isHighNibble = false;
+
+    while (sampleAt != samplesEnd) {
+        quint8 nibbles = *dataAt;
+        int nibble;
+        if (isHighNibble) {
+            nibble = nibbles >> 4;
+            dataAt++;
+        } else {
+            nibble = nibbles & 0x0f;
+        }
+        isHighNibble = !isHighNibble;
+
+        applyNibble(nibble, predictors[channel], stepIndices[channel]);
+        *sampleAt++ = predictors[channel];
+
+        if (++channel == numChannels) {
+            channel = 0;
+        }
+    }
+    if (isHighNibble) {
+        dataAt++;
+    }
+
+    numSamples = numFramesPerChannel * numChannels;
+    return dataAt - encoded;
+}
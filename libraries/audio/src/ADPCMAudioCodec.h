@@ -0,0 +1,35 @@
+//
+//  ADPCMAudioCodec.h
+//  libraries/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ADPCMAudioCodec_h
+#define hifi_ADPCMAudioCodec_h
+
+#include "AudioCodec.h"
+
+const int ADPCM_MAX_CHANNELS = 2;
+
+/// IMA ADPCM, four bits per sample with a handful of integer operations per sample on either end.
+///
+/// A frame starts with the number of channels and the number of samples per channel, followed by the first sample and
+/// the initial step index of every channel. The remaining samples are coded as the interleaved 4 bit differences from
+/// the previous sample of the same channel, two to a byte with the first in the low bits.
+class ADPCMAudioCodec : public AudioCodec {
+public:
+    AudioCodec_t getType() const { return AudioCodecType::ADPCM; }
+
+    int getMaxEncodedSize(int numSamples, int numChannels) const;
+
+    /// returns 0 without encoding anything if there are more than ADPCM_MAX_CHANNELS channels
+    int encode(const int16_t* samples, int numSamples, int numChannels, char* encoded) const;
+    int decode(const char* encoded, int maxSize, int16_t* samples, int maxSamples, int& numSamples) const;
+};
+
+#endif // hifi_ADPCMAudioCodec_h
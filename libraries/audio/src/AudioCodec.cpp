@@ -0,0 +1,46 @@
+//
+//  AudioCodec.cpp
+//  libraries/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+
+#include "ADPCMAudioCodec.h"
+
+#include "AudioCodec.h"
+
+const AudioCodec* AudioCodec::getCodec(AudioCodec_t type) {
+    static PCMAudioCodec pcmCodec;
+    static ADPCMAudioCodec adpcmCodec;
+
+    switch (type) {
+        case AudioCodecType::PCM:
+            return &pcmCodec;
+        case AudioCodecType::ADPCM:
+            return &adpcmCodec;
+        default:
+            return NULL;
+    }
+}
+
+int PCMAudioCodec::getMaxEncodedSize(int numSamples, int numChannels) const {
+    return numSamples * sizeof(int16_t);
+}
+
+int PCMAudioCodec::encode(const int16_t* samples, int numSamples, int numChannels, char* encoded) const {
+    memcpy(encoded, samples, numSamples * sizeof(int16_t));
+    return numSamples * sizeof(int16_t);
+}
+
+int PCMAudioCodec::decode(const char* encoded, int maxSize, int16_t* samples, int maxSamples, int& numSamples) const {
+    // PCM has no framing, the samples run to the end of the packet
+    numSamples = qMin(maxSize / (int) sizeof(int16_t), maxSamples);
+    memcpy(samples, encoded, numSamples * sizeof(int16_t));
+    return numSamples * sizeof(int16_t);
+}
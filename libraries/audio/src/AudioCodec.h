@@ -0,0 +1,57 @@
+//
+//  AudioCodec.h
+//  libraries/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioCodec_h
+#define hifi_AudioCodec_h
+
+#include <stdint.h>
+
+#include <QtCore/QtGlobal>
+
+typedef quint8 AudioCodec_t;
+namespace AudioCodecType {
+    const AudioCodec_t PCM = 0;     // raw 16 bit samples
+    const AudioCodec_t ADPCM = 1;   // 4 bit IMA ADPCM, a quarter of the size of PCM
+}
+
+/// Encodes and decodes one frame of interleaved 16 bit samples for an audio packet. A frame is encoded on its own, so
+/// a lost packet never affects the decoding of the packets after it, and the codecs can be shared between streams.
+class AudioCodec {
+public:
+    virtual ~AudioCodec() {}
+
+    /// returns the codec for the given type, or NULL if we don't know it
+    static const AudioCodec* getCodec(AudioCodec_t type);
+
+    virtual AudioCodec_t getType() const = 0;
+
+    /// the most bytes encode() writes for a frame with the given number of samples
+    virtual int getMaxEncodedSize(int numSamples, int numChannels) const = 0;
+
+    /// encodes numSamples interleaved samples into encoded, returns the number of bytes written
+    virtual int encode(const int16_t* samples, int numSamples, int numChannels, char* encoded) const = 0;
+
+    /// decodes one frame from the first maxSize bytes of encoded into at most maxSamples samples, sets numSamples to the
+    /// number of samples written and returns the number of bytes read, or -1 if the data isn't a valid frame
+    virtual int decode(const char* encoded, int maxSize, int16_t* samples, int maxSamples, int& numSamples) const = 0;
+};
+
+/// sends the samples as they are, for peers that don't support anything else
+class PCMAudioCodec : public AudioCodec {
+public:
+    AudioCodec_t getType() const { return AudioCodecType::PCM; }
+
+    int getMaxEncodedSize(int numSamples, int numChannels) const;
+    int encode(const int16_t* samples, int numSamples, int numChannels, char* encoded) const;
+    int decode(const char* encoded, int maxSize, int16_t* samples, int maxSamples, int& numSamples) const;
+};
+
+#endif // hifi_AudioCodec_h
@@ -17,6 +17,7 @@
 #include <UUID.h>
 
 #include "AbstractAudioInterface.h"
+#include "AudioInjectorScheduler.h"
 #include "AudioRingBuffer.h"
 
 #include "AudioInjector.h"
@@ -25,7 +26,15 @@ AudioInjector::AudioInjector(QObject* parent) :
     QObject(parent),
     _sound(NULL),
     _options(),
-    _shouldStop(false)
+    _shouldStop(false),
+    _soundByteArray(),
+    _injectAudioPacket(),
+    _numPreSequenceNumberBytes(0),
+    _numPreAudioDataBytes(0),
+    _currentSendPosition(0),
+    _outgoingSequenceNumber(0),
+    _numFramesSent(0),
+    _startUsecs(0)
 {
     
 }
@@ -33,110 +42,118 @@ AudioInjector::AudioInjector(QObject* parent) :
 AudioInjector::AudioInjector(Sound* sound, const AudioInjectorOptions& injectorOptions) :
     _sound(sound),
     _options(injectorOptions),
-    _shouldStop(false)
+    _shouldStop(false),
+    _soundByteArray(),
+    _injectAudioPacket(),
+    _numPreSequenceNumberBytes(0),
+    _numPreAudioDataBytes(0),
+    _currentSendPosition(0),
+    _outgoingSequenceNumber(0),
+    _numFramesSent(0),
+    _startUsecs(0)
 {
     
 }
 
 const uchar MAX_INJECTOR_VOLUME = 0xFF;
 
+// send two packets before waiting for the next frame so the mixer can start playback right away
+const int NUM_INITIAL_FRAMES = 2;
+
 void AudioInjector::injectAudio() {
-    
-    QByteArray soundByteArray = _sound->getByteArray();
+    AudioInjectorScheduler::getInstance()->scheduleInjector(this);
+}
+
+bool AudioInjector::startInjection() {
+    _soundByteArray = _sound->getByteArray();
     
     // make sure we actually have samples downloaded to inject
-    if (soundByteArray.size()) {
-        // give our sample byte array to the local audio interface, if we have it, so it can be handled locally
-        if (_options.getLoopbackAudioInterface()) {
-            // assume that localAudioInterface could be on a separate thread, use Qt::AutoConnection to handle properly
-            QMetaObject::invokeMethod(_options.getLoopbackAudioInterface(), "handleAudioByteArray",
-                                      Qt::AutoConnection,
-                                      Q_ARG(QByteArray, soundByteArray));
-            
-        }
-        
-        NodeList* nodeList = NodeList::getInstance();
-        
-        // setup the packet for injected audio
-        QByteArray injectAudioPacket = byteArrayWithPopulatedHeader(PacketTypeInjectAudio);
-        QDataStream packetStream(&injectAudioPacket, QIODevice::Append);
-        
-        // pack some placeholder sequence number for now
-        int numPreSequenceNumberBytes = injectAudioPacket.size();
-        packetStream << (quint16)0;
+    if (!_soundByteArray.size()) {
+        return false;
+    }
 
-        // pack stream identifier (a generated UUID)
-        packetStream << QUuid::createUuid();
-        
-        // pack the flag for loopback
-        uchar loopbackFlag = (uchar) (!_options.getLoopbackAudioInterface());
-        packetStream << loopbackFlag;
-        
-        // pack the position for injected audio
-        packetStream.writeRawData(reinterpret_cast<const char*>(&_options.getPosition()), sizeof(_options.getPosition()));
-        
-        // pack our orientation for injected audio
-        packetStream.writeRawData(reinterpret_cast<const char*>(&_options.getOrientation()), sizeof(_options.getOrientation()));
+    // give our sample byte array to the local audio interface, if we have it, so it can be handled locally
+    if (_options.getLoopbackAudioInterface()) {
+        // assume that localAudioInterface could be on a separate thread, use Qt::AutoConnection to handle properly
+        QMetaObject::invokeMethod(_options.getLoopbackAudioInterface(), "handleAudioByteArray",
+                                  Qt::AutoConnection,
+                                  Q_ARG(QByteArray, _soundByteArray));
         
-        // pack zero for radius
-        float radius = 0;
-        packetStream << radius;
+    }
+    
+    // setup the packet for injected audio
+    _injectAudioPacket = byteArrayWithPopulatedHeader(PacketTypeInjectAudio);
+    QDataStream packetStream(&_injectAudioPacket, QIODevice::Append);
+    
+    // pack some placeholder sequence number for now
+    _numPreSequenceNumberBytes = _injectAudioPacket.size();
+    packetStream << (quint16)0;
+
+    // pack stream identifier (a generated UUID)
+    packetStream << QUuid::createUuid();
+    
+    // pack the flag for loopback
+    uchar loopbackFlag = (uchar) (!_options.getLoopbackAudioInterface());
+    packetStream << loopbackFlag;
+    
+    // pack the position for injected audio
+    packetStream.writeRawData(reinterpret_cast<const char*>(&_options.getPosition()), sizeof(_options.getPosition()));
+    
+    // pack our orientation for injected audio
+    packetStream.writeRawData(reinterpret_cast<const char*>(&_options.getOrientation()), sizeof(_options.getOrientation()));
+    
+    // pack zero for radius
+    float radius = 0;
+    packetStream << radius;
+    
+    // pack 255 for attenuation byte
+    quint8 volume = MAX_INJECTOR_VOLUME * _options.getVolume();
+    packetStream << volume;
+
+    // injected sounds go out as they are, they are only mixed and not played back by the receiver
+    packetStream << AudioCodecType::PCM;
+
+    _numPreAudioDataBytes = _injectAudioPacket.size();
+    _currentSendPosition = 0;
+    _outgoingSequenceNumber = 0;
+    _numFramesSent = 0;
+    _startUsecs = usecTimestampNow();
+
+    return true;
+}
+
+bool AudioInjector::injectDueFrames(quint64 now, const SharedNodePointer& audioMixer) {
+    // frames are due on a fixed schedule from the start, so a late timer doesn't make the sound drift
+    int numFramesDue = NUM_INITIAL_FRAMES + (now - _startUsecs) / BUFFER_SEND_INTERVAL_USECS;
+    NodeList* nodeList = NodeList::getInstance();
+    
+    // send off our audio in NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL byte chunks
+    while (_numFramesSent < numFramesDue && _currentSendPosition < _soundByteArray.size() && !_shouldStop) {
         
-        // pack 255 for attenuation byte
-        quint8 volume = MAX_INJECTOR_VOLUME * _options.getVolume();
-        packetStream << volume;
+        int bytesToCopy = std::min(NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL,
+                                   _soundByteArray.size() - _currentSendPosition);
         
-        QElapsedTimer timer;
-        timer.start();
-        int nextFrame = 0;
+        // resize the QByteArray to the right size
+        _injectAudioPacket.resize(_numPreAudioDataBytes + bytesToCopy);
+
+        // pack the sequence number
+        memcpy(_injectAudioPacket.data() + _numPreSequenceNumberBytes, &_outgoingSequenceNumber, sizeof(quint16));
         
-        int currentSendPosition = 0;
+        // copy the next NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL bytes to the packet
+        memcpy(_injectAudioPacket.data() + _numPreAudioDataBytes,
+               _soundByteArray.data() + _currentSendPosition, bytesToCopy);
         
-        int numPreAudioDataBytes = injectAudioPacket.size();
-        bool shouldLoop = _options.getLoop();
+        // send off this audio packet, the scheduler has the node list batching what we write
+        nodeList->writeDatagram(_injectAudioPacket, audioMixer);
+        _outgoingSequenceNumber++;
+        _numFramesSent++;
         
-        // loop to send off our audio in NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL byte chunks
-        quint16 outgoingInjectedAudioSequenceNumber = 0;
-        while (currentSendPosition < soundByteArray.size() && !_shouldStop) {
-            
-            int bytesToCopy = std::min(NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL,
-                                       soundByteArray.size() - currentSendPosition);
-            
-            // resize the QByteArray to the right size
-            injectAudioPacket.resize(numPreAudioDataBytes + bytesToCopy);
-
-            // pack the sequence number
-            memcpy(injectAudioPacket.data() + numPreSequenceNumberBytes, &outgoingInjectedAudioSequenceNumber, sizeof(quint16));
-            
-            // copy the next NETWORK_BUFFER_LENGTH_BYTES_PER_CHANNEL bytes to the packet
-            memcpy(injectAudioPacket.data() + numPreAudioDataBytes, soundByteArray.data() + currentSendPosition, bytesToCopy);
-            
-            // grab our audio mixer from the NodeList, if it exists
-            SharedNodePointer audioMixer = nodeList->soloNodeOfType(NodeType::AudioMixer);
-            
-            // send off this audio packet
-            nodeList->writeDatagram(injectAudioPacket, audioMixer);
-            outgoingInjectedAudioSequenceNumber++;
-            
-            currentSendPosition += bytesToCopy;
-            
-            // send two packets before the first sleep so the mixer can start playback right away
-            
-            if (currentSendPosition != bytesToCopy && currentSendPosition < soundByteArray.size()) {
-                // not the first packet and not done
-                // sleep for the appropriate time
-                int usecToSleep = (++nextFrame * BUFFER_SEND_INTERVAL_USECS) - timer.nsecsElapsed() / 1000;
-                
-                if (usecToSleep > 0) {
-                    usleep(usecToSleep);
-                }
-            }
-
-            if (shouldLoop && currentSendPosition == soundByteArray.size()) {
-                currentSendPosition = 0;
-            }
+        _currentSendPosition += bytesToCopy;
+
+        if (_options.getLoop() && _currentSendPosition == _soundByteArray.size()) {
+            _currentSendPosition = 0;
         }
     }
-    
-    emit finished();
+
+    return _currentSendPosition < _soundByteArray.size() && !_shouldStop;
 }
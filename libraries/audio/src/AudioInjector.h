@@ -18,6 +18,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/quaternion.hpp>
 
+#include <Node.h>
+
 #include "AudioInjectorOptions.h"
 #include "Sound.h"
 
@@ -26,7 +28,20 @@ class AudioInjector : public QObject {
 public:
     AudioInjector(QObject* parent);
     AudioInjector(Sound* sound, const AudioInjectorOptions& injectorOptions);
+
+    /// called by the AudioInjectorScheduler on its thread: sets up the packet and hands the sound to the local audio
+    /// interface, returns false when there is nothing to inject
+    bool startInjection();
+
+    /// called by the AudioInjectorScheduler on its thread: writes the frames that have come due by now to the
+    /// audio mixer, returns false once the sound is done or the injector was stopped
+    bool injectDueFrames(quint64 now, const SharedNodePointer& audioMixer);
+
+    /// called by the AudioInjectorScheduler on its thread when it is done with the injector
+    void finishInjection() { emit finished(); }
+
 public slots:
+    /// hands the injector to the AudioInjectorScheduler, which sends its audio from then on
     void injectAudio();
     void stop() { _shouldStop = true; }
 signals:
@@ -35,6 +50,15 @@ private:
     Sound* _sound;
     AudioInjectorOptions _options;
     bool _shouldStop;
+
+    QByteArray _soundByteArray;
+    QByteArray _injectAudioPacket;
+    int _numPreSequenceNumberBytes;
+    int _numPreAudioDataBytes;
+    int _currentSendPosition;
+    quint16 _outgoingSequenceNumber;
+    int _numFramesSent;
+    quint64 _startUsecs;
 };
 
 Q_DECLARE_METATYPE(AudioInjector*)
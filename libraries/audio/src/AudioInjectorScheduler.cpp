@@ -0,0 +1,170 @@
+//
+//  AudioInjectorScheduler.cpp
+//  libraries/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QMetaObject>
+
+#include <NodeList.h>
+#include <SharedUtil.h>
+
+#include "AudioInjector.h"
+#include "AudioRingBuffer.h"
+
+#include "AudioInjectorScheduler.h"
+
+AudioInjectorScheduler* AudioInjectorScheduler::_sharedInstance = NULL;
+
+AudioInjectorScheduler* AudioInjectorScheduler::createInstance(QObject* application) {
+    if (!_sharedInstance) {
+        QThread* thread = new QThread(application);
+        _sharedInstance = new AudioInjectorScheduler(thread);
+
+        // the scheduler lives on its thread, so it goes away with it
+        connect(thread, &QThread::finished, _sharedInstance, &QObject::deleteLater);
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, _sharedInstance,
+                &AudioInjectorScheduler::stop, Qt::DirectConnection);
+
+        thread->start();
+    } else {
+        qDebug("AudioInjectorScheduler createInstance called with existing instance.");
+    }
+
+    return _sharedInstance;
+}
+
+AudioInjectorScheduler* AudioInjectorScheduler::getInstance() {
+    if (!_sharedInstance) {
+        qDebug("AudioInjectorScheduler getInstance called before call to createInstance. Returning NULL pointer.");
+    }
+
+    return _sharedInstance;
+}
+
+AudioInjectorScheduler::AudioInjectorScheduler(QThread* thread) :
+    _thread(thread),
+    _frameTimer(new QTimer(this)),
+    _injectors(),
+    _numActiveInjectors(0),
+    _isStopped(0)
+{
+    qRegisterMetaType<AudioInjector*>("AudioInjector*");
+
+    // the timer only has to be close, injectors send the frames that came due since the last time around
+    _frameTimer->setTimerType(Qt::PreciseTimer);
+    _frameTimer->setInterval(BUFFER_SEND_INTERVAL_USECS / USECS_PER_MSEC);
+    connect(_frameTimer, &QTimer::timeout, this, &AudioInjectorScheduler::sendFrames);
+
+    moveToThread(_thread);
+}
+
+AudioInjectorScheduler::~AudioInjectorScheduler() {
+    if (_sharedInstance == this) {
+        _sharedInstance = NULL;
+    }
+}
+
+void AudioInjectorScheduler::scheduleInjector(AudioInjector* injector) {
+    if (_isStopped.load()) {
+        // we're on our way out, there's nobody left to send the audio
+        injector->deleteLater();
+        return;
+    }
+
+    _numActiveInjectors.ref();
+
+    injector->moveToThread(_thread);
+    QMetaObject::invokeMethod(this, "addInjector", Qt::QueuedConnection, Q_ARG(AudioInjector*, injector));
+}
+
+void AudioInjectorScheduler::stop() {
+    if (!_isStopped.testAndSetOrdered(0, 1)) {
+        return;
+    }
+
+    // the injectors belong to our thread, so they're finished off there before it ends
+    if (QThread::currentThread() == _thread) {
+        removeAllInjectors();
+    } else {
+        QMetaObject::invokeMethod(this, "removeAllInjectors", Qt::BlockingQueuedConnection);
+    }
+
+    _thread->quit();
+    if (QThread::currentThread() != _thread) {
+        _thread->wait();
+    }
+}
+
+void AudioInjectorScheduler::removeAllInjectors() {
+    _frameTimer->stop();
+
+    foreach (AudioInjector* injector, _injectors) {
+        injector->finishInjection();
+        _numActiveInjectors.deref();
+
+        // the deleteLater() the injector may have connected to finished() wouldn't run once our thread is gone
+        delete injector;
+    }
+    _injectors.clear();
+}
+
+void AudioInjectorScheduler::addInjector(AudioInjector* injector) {
+    if (_isStopped.load()) {
+        // scheduled just as we were stopped
+        _numActiveInjectors.deref();
+        injector->finishInjection();
+        delete injector;
+        return;
+    }
+
+    if (!injector->startInjection()) {
+        // nothing to send, the sound may not have been downloaded
+        _numActiveInjectors.deref();
+        injector->finishInjection();
+        return;
+    }
+
+    _injectors.append(injector);
+
+    // send the first frames right away, so the mixer can start playback before the next timer tick
+    sendFrames();
+
+    if (!_frameTimer->isActive() && !_injectors.isEmpty()) {
+        _frameTimer->start();
+    }
+}
+
+void AudioInjectorScheduler::sendFrames() {
+    quint64 now = usecTimestampNow();
+
+    NodeList* nodeList = NodeList::getInstance();
+    nodeList->beginDatagramBatch();
+
+    // every injector sends to the audio mixer, so a frame's worth of packets goes out together
+    SharedNodePointer audioMixer = nodeList->soloNodeOfType(NodeType::AudioMixer);
+
+    QList<AudioInjector*>::iterator injector = _injectors.begin();
+    while (injector != _injectors.end()) {
+        if ((*injector)->injectDueFrames(now, audioMixer)) {
+            ++injector;
+        } else {
+            (*injector)->finishInjection();
+            _numActiveInjectors.deref();
+            injector = _injectors.erase(injector);
+        }
+    }
+
+    nodeList->flushDatagramBatch();
+
+    if (_injectors.isEmpty()) {
+        _frameTimer->stop();
+    }
+}
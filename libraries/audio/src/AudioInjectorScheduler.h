@@ -0,0 +1,65 @@
+//
+//  AudioInjectorScheduler.h
+//  libraries/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioInjectorScheduler_h
+#define hifi_AudioInjectorScheduler_h
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+class AudioInjector;
+
+/// Sends the audio of every playing AudioInjector from one thread. Once per audio frame it has each injector write the
+/// frames that have come due, and sends the whole frame's worth of packets to the audio mixer together.
+///
+/// The application creates the scheduler with createInstance(). The scheduler's thread is a child of the application,
+/// and the scheduler stops when the application is about to quit, taking the injectors that are still playing with it.
+class AudioInjectorScheduler : public QObject {
+    Q_OBJECT
+public:
+    /// creates the scheduler and starts its thread, which is parented to the given application object
+    static AudioInjectorScheduler* createInstance(QObject* application);
+    static AudioInjectorScheduler* getInstance();
+
+    /// moves the injector to the scheduler thread and starts sending its audio, the injector emits finished() and
+    /// gets deleted when it is done
+    void scheduleInjector(AudioInjector* injector);
+
+    /// the number of injectors that have been scheduled and haven't finished yet, can be called from any thread
+    int getNumActiveInjectors() const { return _numActiveInjectors.load(); }
+
+public slots:
+    /// Stops sending, finishes and deletes the injectors that are still playing and waits for the scheduler thread to
+    /// end. Called from the application's thread when it is about to quit; injectors scheduled after this are deleted.
+    void stop();
+
+private slots:
+    void addInjector(AudioInjector* injector);
+    void sendFrames();
+    void removeAllInjectors();
+
+private:
+    AudioInjectorScheduler(QThread* thread);
+    ~AudioInjectorScheduler();
+
+    static AudioInjectorScheduler* _sharedInstance;
+
+    QThread* _thread;
+    QTimer* _frameTimer;
+    QList<AudioInjector*> _injectors;
+    QAtomicInt _numActiveInjectors;
+    QAtomicInt _isStopped;
+};
+
+#endif // hifi_AudioInjectorScheduler_h
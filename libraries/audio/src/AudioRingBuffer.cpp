@@ -69,8 +69,12 @@ void AudioRingBuffer::resizeForFrameSize(int numFrameSamples) {
 
 int AudioRingBuffer::parseData(const QByteArray& packet) {
     // skip packet header and sequence number
-    int numBytesBeforeAudioData = numBytesForPacketHeader(packet) + sizeof(quint16);
-    return writeData(packet.data() + numBytesBeforeAudioData, packet.size() - numBytesBeforeAudioData);
+    int numBytesBeforeCodec = numBytesForPacketHeader(packet) + sizeof(quint16);
+    AudioCodec_t codec = packet.at(numBytesBeforeCodec);
+
+    int numBytesBeforeAudioData = numBytesBeforeCodec + sizeof(AudioCodec_t);
+    return numBytesBeforeAudioData + writeEncodedData(codec, packet.data() + numBytesBeforeAudioData,
+                                                      packet.size() - numBytesBeforeAudioData);
 }
 
 int AudioRingBuffer::readSamples(int16_t* destination, int maxSamples) {
@@ -125,6 +129,31 @@ int AudioRingBuffer::writeSamples(const int16_t* source, int maxSamples) {
     return writeData((const char*) source, maxSamples * sizeof(int16_t));
 }
 
+int AudioRingBuffer::writeEncodedData(AudioCodec_t codecType, const char* data, int maxSize) {
+    if (codecType == AudioCodecType::PCM) {
+        // the samples can go straight into the buffer
+        return writeData(data, maxSize);
+    }
+
+    const AudioCodec* codec = AudioCodec::getCodec(codecType);
+    if (!codec) {
+        qDebug() << "Dropping audio frame encoded with unknown codec" << codecType;
+        return maxSize;
+    }
+
+    int16_t decodedSamples[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+    int numDecodedSamples = 0;
+    int numBytesRead = codec->decode(data, maxSize, decodedSamples, NETWORK_BUFFER_LENGTH_SAMPLES_STEREO,
+                                     numDecodedSamples);
+    if (numBytesRead < 0) {
+        qDebug() << "Dropping audio frame that could not be decoded";
+        return maxSize;
+    }
+
+    writeSamples(decodedSamples, numDecodedSamples);
+    return numBytesRead;
+}
+
 int AudioRingBuffer::writeData(const char* data, int maxSize) {
     // make sure we have enough bytes left for this to be the right amount of audio
     // otherwise we should not copy that data, and leave the buffer pointers where they are
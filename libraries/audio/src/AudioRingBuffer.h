@@ -19,6 +19,7 @@
 
 #include <QtCore/QIODevice>
 
+#include "AudioCodec.h"
 #include "NodeData.h"
 #include "SharedUtil.h"
 
@@ -59,6 +60,10 @@ public:
     
     int readData(char* data, int maxSize);
     int writeData(const char* data, int maxSize);
+
+    /// decodes one frame of audio that was encoded with the given codec and writes it, returns the number of encoded
+    /// bytes that were read
+    int writeEncodedData(AudioCodec_t codec, const char* data, int maxSize);
     
     int16_t& operator[](const int index);
     const int16_t& operator[] (const int index) const;
@@ -9,25 +9,19 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "AudioInjectorScheduler.h"
+
 #include "AudioScriptingInterface.h"
 
 AudioInjector* AudioScriptingInterface::playSound(Sound* sound, const AudioInjectorOptions* injectorOptions) {
     
     AudioInjector* injector = new AudioInjector(sound, *injectorOptions);
     
-    QThread* injectorThread = new QThread();
-    
-    injector->moveToThread(injectorThread);
-    
-    // start injecting when the injector thread starts
-    connect(injectorThread, SIGNAL(started()), injector, SLOT(injectAudio()));
-    
     // connect the right slots and signals so that the AudioInjector is killed once the injection is complete
     connect(injector, SIGNAL(finished()), injector, SLOT(deleteLater()));
-    connect(injector, SIGNAL(finished()), injectorThread, SLOT(quit()));
-    connect(injectorThread, SIGNAL(finished()), injectorThread, SLOT(deleteLater()));
     
-    injectorThread->start();
+    // all injectors share the scheduler's thread, which sends their audio frame by frame
+    AudioInjectorScheduler::getInstance()->scheduleInjector(injector);
     
     return injector;
 }
@@ -42,6 +36,10 @@ bool AudioScriptingInterface::isInjectorPlaying(AudioInjector* injector) {
     return (injector != NULL);
 }
 
+int AudioScriptingInterface::getActiveInjectorCount() {
+    return AudioInjectorScheduler::getInstance()->getNumActiveInjectors();
+}
+
 void AudioScriptingInterface::startDrumSound(float volume, float frequency, float duration, float decay, 
                                     const AudioInjectorOptions* injectorOptions) {
 
@@ -49,17 +47,8 @@ void AudioScriptingInterface::startDrumSound(float volume, float frequency, floa
     AudioInjector* injector = new AudioInjector(sound, *injectorOptions);
     sound->setParent(injector);
     
-    QThread* injectorThread = new QThread();
-    
-    injector->moveToThread(injectorThread);
-    
-    // start injecting when the injector thread starts
-    connect(injectorThread, SIGNAL(started()), injector, SLOT(injectAudio()));
-    
     // connect the right slots and signals so that the AudioInjector is killed once the injection is complete
     connect(injector, SIGNAL(finished()), injector, SLOT(deleteLater()));
-    connect(injector, SIGNAL(finished()), injectorThread, SLOT(quit()));
-    connect(injectorThread, SIGNAL(finished()), injectorThread, SLOT(deleteLater()));
     
-    injectorThread->start();
+    AudioInjectorScheduler::getInstance()->scheduleInjector(injector);
 }
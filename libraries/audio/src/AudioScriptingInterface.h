@@ -23,6 +23,7 @@ public slots:
     static AudioInjector* playSound(Sound* sound, const AudioInjectorOptions* injectorOptions = NULL);
     static void stopInjector(AudioInjector* injector);
     static bool isInjectorPlaying(AudioInjector* injector);
+    static int getActiveInjectorCount();
     static void startDrumSound(float volume, float frequency, float duration, float decay, 
                     const AudioInjectorOptions* injectorOptions = NULL);
 
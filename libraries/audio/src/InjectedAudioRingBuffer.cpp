@@ -58,9 +58,11 @@ int InjectedAudioRingBuffer::parseData(const QByteArray& packet) {
     quint8 attenuationByte = 0;
     packetStream >> attenuationByte;
     _attenuationRatio = attenuationByte / (float) MAX_INJECTOR_VOLUME;
+
+    packetStream >> _codec;
     
-    packetStream.skipRawData(writeData(packet.data() + packetStream.device()->pos(),
-                                       packet.size() - packetStream.device()->pos()));
+    packetStream.skipRawData(writeEncodedData(_codec, packet.data() + packetStream.device()->pos(),
+                                              packet.size() - packetStream.device()->pos()));
     
     return packetStream.device()->pos();
 }
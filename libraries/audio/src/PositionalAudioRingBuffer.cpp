@@ -32,6 +32,7 @@ PositionalAudioRingBuffer::PositionalAudioRingBuffer(PositionalAudioRingBuffer::
     _shouldLoopbackForNode(false),
     _shouldOutputStarveDebug(true),
     _isStereo(isStereo),
+    _codec(AudioCodecType::PCM),
     _listenerUnattenuatedZone(NULL),
     _lastFrameReceivedTime(0),
     _interframeTimeGapStatsForJitterCalc(TIME_GAPS_FOR_JITTER_CALC_INTERVAL_SAMPLES, TIME_GAPS_FOR_JITTER_CALC_WINDOW_INTERVALS),
@@ -57,6 +58,10 @@ int PositionalAudioRingBuffer::parseData(const QByteArray& packet) {
     readBytes += sizeof(quint8);
     // read the positional data
     readBytes += parsePositionalData(packet.mid(readBytes));
+
+    // the codec the audio was encoded with, the mixer also sends its mix back with it
+    _codec = packet.at(readBytes);
+    readBytes += sizeof(AudioCodec_t);
    
     if (packetTypeForPacket(packet) == PacketTypeSilentAudioFrame) {
         // this source had no audio to send us, but this counts as a packet
@@ -97,7 +102,7 @@ int PositionalAudioRingBuffer::parseData(const QByteArray& packet) {
         }
     } else {
         // there is audio data to read
-        readBytes += writeData(packet.data() + readBytes, packet.size() - readBytes);
+        readBytes += writeEncodedData(_codec, packet.data() + readBytes, packet.size() - readBytes);
     }
     return readBytes;
 }
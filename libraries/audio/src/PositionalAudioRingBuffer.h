@@ -55,6 +55,9 @@ public:
     bool shouldLoopbackForNode() const { return _shouldLoopbackForNode; }
     
     bool isStereo() const { return _isStereo; }
+
+    /// the codec of the last frame that was parsed
+    AudioCodec_t getCodec() const { return _codec; }
     
     PositionalAudioRingBuffer::Type getType() const { return _type; }
     const glm::vec3& getPosition() const { return _position; }
@@ -90,6 +93,7 @@ protected:
     bool _shouldLoopbackForNode;
     bool _shouldOutputStarveDebug;
     bool _isStereo;
+    AudioCodec_t _codec;
     
     float _nextOutputTrailingLoudness;
     AABox* _listenerUnattenuatedZone;
@@ -0,0 +1,373 @@
+//
+//  BakedFBXGeometry.cpp
+//  libraries/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QStringList>
+
+#include "BakedFBXGeometry.h"
+
+static const QByteArray BAKED_GEOMETRY_MAGIC = "HIFIBAKEDFBX";
+
+// the arrays are stored in the byte order and layout of the machine that baked them; geometry baked elsewhere is read
+// as a cache miss and baked again
+static const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+static void addBytesToHash(QCryptographicHash& hash, const QByteArray& bytes) {
+    quint32 size = bytes.size();
+    hash.addData(reinterpret_cast<const char*>(&size), sizeof(size));
+    hash.addData(bytes);
+}
+
+// hashes the mapping in an order that doesn't depend on QHash iteration, which changes between runs
+static void addMappingToHash(QCryptographicHash& hash, const QVariant& value) {
+    if (value.type() == QVariant::Hash) {
+        QVariantHash values = value.toHash();
+        QStringList keys = values.uniqueKeys();
+        keys.sort();
+        hash.addData("{", 1);
+        foreach (const QString& key, keys) {
+            addBytesToHash(hash, key.toUtf8());
+            foreach (const QVariant& keyValue, values.values(key)) {
+                addMappingToHash(hash, keyValue);
+            }
+        }
+        hash.addData("}", 1);
+
+    } else if (value.type() == QVariant::List) {
+        hash.addData("[", 1);
+        foreach (const QVariant& element, value.toList()) {
+            addMappingToHash(hash, element);
+        }
+        hash.addData("]", 1);
+
+    } else {
+        addBytesToHash(hash, value.toByteArray());
+    }
+}
+
+QByteArray getBakedFBXGeometryKey(const QByteArray& model, const QVariantHash& mapping) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    quint32 version = BAKED_FBX_GEOMETRY_VERSION;
+    hash.addData(reinterpret_cast<const char*>(&version), sizeof(version));
+    quint32 readerVersion = FBX_READER_VERSION;
+    hash.addData(reinterpret_cast<const char*>(&readerVersion), sizeof(readerVersion));
+    addBytesToHash(hash, model);
+    addMappingToHash(hash, mapping);
+    return hash.result().toHex();
+}
+
+template<class T> static void writePOD(QDataStream& out, const T& value) {
+    out.writeRawData(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<class T> static void readPOD(QDataStream& in, T& value) {
+    if (in.readRawData(reinterpret_cast<char*>(&value), sizeof(T)) != sizeof(T)) {
+        throw QString("Truncated baked geometry");
+    }
+}
+
+template<class T> static void writeArray(QDataStream& out, const QVector<T>& values) {
+    out << (quint32)values.size();
+    out.writeRawData(reinterpret_cast<const char*>(values.constData()), values.size() * sizeof(T));
+}
+
+// one allocation at the final size and one copy out of the mapped file per array
+template<class T> static void readArray(QDataStream& in, QVector<T>& values) {
+    quint32 size;
+    in >> size;
+    qint64 numBytes = (qint64)size * sizeof(T);
+    if (in.status() != QDataStream::Ok || numBytes > in.device()->bytesAvailable()) {
+        throw QString("Truncated baked geometry");
+    }
+    values.resize(size);
+    in.readRawData(reinterpret_cast<char*>(values.data()), numBytes);
+}
+
+static void writeTexture(QDataStream& out, const FBXTexture& texture) {
+    out << texture.filename << texture.content;
+}
+
+static void readTexture(QDataStream& in, FBXTexture& texture) {
+    in >> texture.filename >> texture.content;
+}
+
+static void writeJoint(QDataStream& out, const FBXJoint& joint) {
+    out << joint.isFree;
+    writeArray(out, joint.freeLineage);
+    out << (qint32)joint.parentIndex << joint.distanceToParent << joint.boneRadius;
+    writePOD(out, joint.translation);
+    writePOD(out, joint.preTransform);
+    writePOD(out, joint.preRotation);
+    writePOD(out, joint.rotation);
+    writePOD(out, joint.postRotation);
+    writePOD(out, joint.postTransform);
+    writePOD(out, joint.transform);
+    writePOD(out, joint.rotationMin);
+    writePOD(out, joint.rotationMax);
+    writePOD(out, joint.inverseDefaultRotation);
+    writePOD(out, joint.inverseBindRotation);
+    writePOD(out, joint.bindTransform);
+    out << joint.name;
+    writePOD(out, joint.shapePosition);
+    writePOD(out, joint.shapeRotation);
+    out << (qint32)joint.shapeType;
+}
+
+static void readJoint(QDataStream& in, FBXJoint& joint) {
+    qint32 parentIndex, shapeType;
+    in >> joint.isFree;
+    readArray(in, joint.freeLineage);
+    in >> parentIndex >> joint.distanceToParent >> joint.boneRadius;
+    joint.parentIndex = parentIndex;
+    readPOD(in, joint.translation);
+    readPOD(in, joint.preTransform);
+    readPOD(in, joint.preRotation);
+    readPOD(in, joint.rotation);
+    readPOD(in, joint.postRotation);
+    readPOD(in, joint.postTransform);
+    readPOD(in, joint.transform);
+    readPOD(in, joint.rotationMin);
+    readPOD(in, joint.rotationMax);
+    readPOD(in, joint.inverseDefaultRotation);
+    readPOD(in, joint.inverseBindRotation);
+    readPOD(in, joint.bindTransform);
+    in >> joint.name;
+    readPOD(in, joint.shapePosition);
+    readPOD(in, joint.shapeRotation);
+    in >> shapeType;
+    joint.shapeType = (Shape::Type)shapeType;
+}
+
+static void writeMesh(QDataStream& out, const FBXMesh& mesh) {
+    out << (quint32)mesh.parts.size();
+    foreach (const FBXMeshPart& part, mesh.parts) {
+        writeArray(out, part.quadIndices);
+        writeArray(out, part.triangleIndices);
+        writePOD(out, part.diffuseColor);
+        writePOD(out, part.specularColor);
+        out << part.shininess;
+        writeTexture(out, part.diffuseTexture);
+        writeTexture(out, part.normalTexture);
+        writeTexture(out, part.specularTexture);
+    }
+    writeArray(out, mesh.vertices);
+    writeArray(out, mesh.normals);
+    writeArray(out, mesh.tangents);
+    writeArray(out, mesh.colors);
+    writeArray(out, mesh.texCoords);
+    writeArray(out, mesh.clusterIndices);
+    writeArray(out, mesh.clusterWeights);
+    writeArray(out, mesh.clusters);
+    writePOD(out, mesh.meshExtents);
+    out << mesh.isEye;
+
+    out << (quint32)mesh.blendshapes.size();
+    foreach (const FBXBlendshape& blendshape, mesh.blendshapes) {
+        writeArray(out, blendshape.indices);
+        writeArray(out, blendshape.vertices);
+        writeArray(out, blendshape.normals);
+    }
+}
+
+static void readMesh(QDataStream& in, FBXMesh& mesh) {
+    quint32 numParts;
+    in >> numParts;
+    for (quint32 i = 0; i < numParts && in.status() == QDataStream::Ok; i++) {
+        FBXMeshPart part;
+        readArray(in, part.quadIndices);
+        readArray(in, part.triangleIndices);
+        readPOD(in, part.diffuseColor);
+        readPOD(in, part.specularColor);
+        in >> part.shininess;
+        readTexture(in, part.diffuseTexture);
+        readTexture(in, part.normalTexture);
+        readTexture(in, part.specularTexture);
+        mesh.parts.append(part);
+    }
+    readArray(in, mesh.vertices);
+    readArray(in, mesh.normals);
+    readArray(in, mesh.tangents);
+    readArray(in, mesh.colors);
+    readArray(in, mesh.texCoords);
+    readArray(in, mesh.clusterIndices);
+    readArray(in, mesh.clusterWeights);
+    readArray(in, mesh.clusters);
+    readPOD(in, mesh.meshExtents);
+    in >> mesh.isEye;
+
+    quint32 numBlendshapes;
+    in >> numBlendshapes;
+    for (quint32 i = 0; i < numBlendshapes && in.status() == QDataStream::Ok; i++) {
+        FBXBlendshape blendshape;
+        readArray(in, blendshape.indices);
+        readArray(in, blendshape.vertices);
+        readArray(in, blendshape.normals);
+        mesh.blendshapes.append(blendshape);
+    }
+}
+
+static void writeHeader(QDataStream& out) {
+    out.writeRawData(BAKED_GEOMETRY_MAGIC.constData(), BAKED_GEOMETRY_MAGIC.size());
+    out << BAKED_FBX_GEOMETRY_VERSION;
+    writePOD(out, BYTE_ORDER_MARK);
+    out << (quint32)sizeof(glm::mat4) << (quint32)sizeof(FBXCluster) << (quint32)sizeof(Extents);
+}
+
+static void readHeader(QDataStream& in) {
+    QByteArray magic(BAKED_GEOMETRY_MAGIC.size(), 0);
+    in.readRawData(magic.data(), magic.size());
+    quint32 version, byteOrderMark, matrixSize, clusterSize, extentsSize;
+    in >> version;
+    readPOD(in, byteOrderMark);
+    in >> matrixSize >> clusterSize >> extentsSize;
+    if (magic != BAKED_GEOMETRY_MAGIC || version != BAKED_FBX_GEOMETRY_VERSION || byteOrderMark != BYTE_ORDER_MARK
+            || matrixSize != sizeof(glm::mat4) || clusterSize != sizeof(FBXCluster) || extentsSize != sizeof(Extents)) {
+        throw QString("Not baked geometry of this version and machine");
+    }
+}
+
+void writeBakedFBXGeometry(QIODevice* device, const FBXGeometry& geometry) {
+    QDataStream out(device);
+    out.setVersion(QDataStream::Qt_5_0);
+    writeHeader(out);
+
+    out << geometry.author << geometry.applicationName;
+
+    out << (quint32)geometry.joints.size();
+    foreach (const FBXJoint& joint, geometry.joints) {
+        writeJoint(out, joint);
+    }
+    out << geometry.jointIndices;
+
+    out << (quint32)geometry.meshes.size();
+    foreach (const FBXMesh& mesh, geometry.meshes) {
+        writeMesh(out, mesh);
+    }
+
+    writePOD(out, geometry.offset);
+    out << (qint32)geometry.leftEyeJointIndex << (qint32)geometry.rightEyeJointIndex << (qint32)geometry.neckJointIndex
+        << (qint32)geometry.rootJointIndex << (qint32)geometry.leanJointIndex << (qint32)geometry.headJointIndex
+        << (qint32)geometry.leftHandJointIndex << (qint32)geometry.rightHandJointIndex;
+    writeArray(out, geometry.humanIKJointIndices);
+    writePOD(out, geometry.palmDirection);
+
+    out << (quint32)geometry.sittingPoints.size();
+    foreach (const SittingPoint& sittingPoint, geometry.sittingPoints) {
+        out << sittingPoint.name;
+        writePOD(out, sittingPoint.position);
+        writePOD(out, sittingPoint.rotation);
+    }
+
+    writePOD(out, geometry.neckPivot);
+    writePOD(out, geometry.bindExtents);
+    writePOD(out, geometry.meshExtents);
+
+    out << (quint32)geometry.animationFrames.size();
+    foreach (const FBXAnimationFrame& frame, geometry.animationFrames) {
+        writeArray(out, frame.rotations);
+    }
+
+    out << (quint32)geometry.attachments.size();
+    foreach (const FBXAttachment& attachment, geometry.attachments) {
+        out << (qint32)attachment.jointIndex << attachment.url;
+        writePOD(out, attachment.translation);
+        writePOD(out, attachment.rotation);
+        writePOD(out, attachment.scale);
+    }
+}
+
+FBXGeometry readBakedFBXGeometry(const uchar* data, qint64 size) {
+    // read the mapped data in place
+    QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data), size);
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+    QDataStream in(&buffer);
+    in.setVersion(QDataStream::Qt_5_0);
+    readHeader(in);
+
+    FBXGeometry geometry;
+    in >> geometry.author >> geometry.applicationName;
+
+    quint32 numJoints;
+    in >> numJoints;
+    for (quint32 i = 0; i < numJoints && in.status() == QDataStream::Ok; i++) {
+        FBXJoint joint;
+        readJoint(in, joint);
+        geometry.joints.append(joint);
+    }
+    in >> geometry.jointIndices;
+
+    quint32 numMeshes;
+    in >> numMeshes;
+    for (quint32 i = 0; i < numMeshes && in.status() == QDataStream::Ok; i++) {
+        FBXMesh mesh;
+        readMesh(in, mesh);
+        geometry.meshes.append(mesh);
+    }
+
+    readPOD(in, geometry.offset);
+    qint32 jointIndices[8];
+    for (int i = 0; i < 8; i++) {
+        in >> jointIndices[i];
+    }
+    geometry.leftEyeJointIndex = jointIndices[0];
+    geometry.rightEyeJointIndex = jointIndices[1];
+    geometry.neckJointIndex = jointIndices[2];
+    geometry.rootJointIndex = jointIndices[3];
+    geometry.leanJointIndex = jointIndices[4];
+    geometry.headJointIndex = jointIndices[5];
+    geometry.leftHandJointIndex = jointIndices[6];
+    geometry.rightHandJointIndex = jointIndices[7];
+    readArray(in, geometry.humanIKJointIndices);
+    readPOD(in, geometry.palmDirection);
+
+    quint32 numSittingPoints;
+    in >> numSittingPoints;
+    for (quint32 i = 0; i < numSittingPoints && in.status() == QDataStream::Ok; i++) {
+        SittingPoint sittingPoint;
+        in >> sittingPoint.name;
+        readPOD(in, sittingPoint.position);
+        readPOD(in, sittingPoint.rotation);
+        geometry.sittingPoints.append(sittingPoint);
+    }
+
+    readPOD(in, geometry.neckPivot);
+    readPOD(in, geometry.bindExtents);
+    readPOD(in, geometry.meshExtents);
+
+    quint32 numAnimationFrames;
+    in >> numAnimationFrames;
+    for (quint32 i = 0; i < numAnimationFrames && in.status() == QDataStream::Ok; i++) {
+        FBXAnimationFrame frame;
+        readArray(in, frame.rotations);
+        geometry.animationFrames.append(frame);
+    }
+
+    quint32 numAttachments;
+    in >> numAttachments;
+    for (quint32 i = 0; i < numAttachments && in.status() == QDataStream::Ok; i++) {
+        FBXAttachment attachment;
+        qint32 jointIndex;
+        in >> jointIndex >> attachment.url;
+        attachment.jointIndex = jointIndex;
+        readPOD(in, attachment.translation);
+        readPOD(in, attachment.rotation);
+        readPOD(in, attachment.scale);
+        geometry.attachments.append(attachment);
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        throw QString("Truncated baked geometry");
+    }
+    return geometry;
+}
@@ -0,0 +1,38 @@
+//
+//  BakedFBXGeometry.h
+//  libraries/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakedFBXGeometry_h
+#define hifi_BakedFBXGeometry_h
+
+#include <QByteArray>
+#include <QVariantHash>
+
+#include "FBXReader.h"
+
+class QIODevice;
+
+/// The version of the baked geometry format. Bump it whenever FBXGeometry or the way it is written changes; changes to
+/// what readFBX() makes of a model bump FBX_READER_VERSION instead.
+const quint32 BAKED_FBX_GEOMETRY_VERSION = 1;
+
+/// Returns the key of the baked geometry of a model: a hash of the model contents, the mapping it is read with, the
+/// format version and the reader version. Two loads with the same key produce the same geometry.
+QByteArray getBakedFBXGeometryKey(const QByteArray& model, const QVariantHash& mapping);
+
+/// Writes geometry in the baked format. The vertex, index and weight arrays are stored as they are in memory, so
+/// reading them back is a copy per array rather than the parsing, vertex merging and tangent generation of readFBX().
+void writeBakedFBXGeometry(QIODevice* device, const FBXGeometry& geometry);
+
+/// Reads geometry in the baked format, typically from a memory mapped file.
+/// \exception QString if the data is not baked geometry of this version and machine, or is truncated
+FBXGeometry readBakedFBXGeometry(const uchar* data, qint64 size);
+
+#endif // hifi_BakedFBXGeometry_h
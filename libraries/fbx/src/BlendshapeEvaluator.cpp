@@ -0,0 +1,192 @@
+//
+//  BlendshapeEvaluator.cpp
+//  libraries/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cmath>
+#include <cstring>
+
+#include <SharedUtil.h>
+
+#include "BlendshapeEvaluator.h"
+
+const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+
+// how far a coefficient may drift from the value last applied before it is applied again
+const float COEFFICIENT_TOLERANCE = 0.001f;
+
+// the number of updates after which the results are rebuilt from the base vertices
+const int MAX_INCREMENTAL_UPDATES = 128;
+
+BlendshapeEvaluator::BlendshapeEvaluator() :
+    _meshes(),
+    _hasResults(false),
+    _baseVertices(),
+    _baseNormals(),
+    _vertices(),
+    _normals(),
+    _blendshapes(),
+    _spans(),
+    _appliedCoefficients(),
+    _targetCoefficients(),
+    _changedCoefficients(),
+    _numIncrementalUpdates(0),
+    _numUpdatedVertices(0),
+    _wasRebuilt(false) {
+}
+
+void BlendshapeEvaluator::setMeshes(const QVector<FBXMesh>& meshes) {
+    if (_hasResults && meshes.constData() == _meshes.constData()) {
+        return;
+    }
+    _meshes = meshes;
+    _hasResults = false;
+
+    _baseVertices.clear();
+    _baseNormals.clear();
+    int numBlendshapes = 0;
+    foreach (const FBXMesh& mesh, _meshes) {
+        if (mesh.blendshapes.isEmpty()) {
+            continue;
+        }
+        _baseVertices += mesh.vertices;
+        _baseNormals += mesh.normals;
+        numBlendshapes = qMax(numBlendshapes, mesh.blendshapes.size());
+    }
+    _vertices = _baseVertices;
+    _normals = _baseNormals;
+
+    // gather the spans of each blendshape index from all of the meshes that have it
+    _spans.clear();
+    _blendshapes.resize(numBlendshapes);
+    for (int i = 0; i < numBlendshapes; i++) {
+        BlendshapeSpans& blendshape = _blendshapes[i];
+        blendshape.firstSpan = _spans.size();
+        blendshape.numVertices = 0;
+        int offset = 0;
+        foreach (const FBXMesh& mesh, _meshes) {
+            if (mesh.blendshapes.isEmpty()) {
+                continue;
+            }
+            if (i < mesh.blendshapes.size()) {
+                addSpans(mesh.blendshapes.at(i), offset);
+            }
+            offset += mesh.vertices.size();
+        }
+        blendshape.numSpans = _spans.size() - blendshape.firstSpan;
+        for (int j = blendshape.firstSpan; j < _spans.size(); j++) {
+            blendshape.numVertices += _spans.at(j).numFloats / 3;
+        }
+    }
+
+    _appliedCoefficients.fill(0.0f, numBlendshapes);
+    _targetCoefficients.fill(0.0f, numBlendshapes);
+    _changedCoefficients.fill(false, numBlendshapes);
+    _numIncrementalUpdates = 0;
+}
+
+void BlendshapeEvaluator::addSpans(const FBXBlendshape& blendshape, int vertexOffset) {
+    const QVector<int>& indices = blendshape.indices;
+    const float* vertexDeltas = reinterpret_cast<const float*>(blendshape.vertices.constData());
+    const float* normalDeltas = reinterpret_cast<const float*>(blendshape.normals.constData());
+    int numIndices = qMin(indices.size(), qMin(blendshape.vertices.size(), blendshape.normals.size()));
+    for (int j = 0; j < numIndices; ) {
+        int end = j + 1;
+        while (end < numIndices && indices.at(end) == indices.at(end - 1) + 1) {
+            end++;
+        }
+        Span span = { (vertexOffset + indices.at(j)) * 3, (end - j) * 3, vertexDeltas + j * 3, normalDeltas + j * 3 };
+        _spans.push_back(span);
+        j = end;
+    }
+}
+
+void BlendshapeEvaluator::applyBlendshape(int index, float coefficient, float* vertices, float* normals) {
+    float normalCoefficient = coefficient * NORMAL_COEFFICIENT_SCALE;
+    const BlendshapeSpans& blendshape = _blendshapes.at(index);
+    const Span* spans = _spans.constData() + blendshape.firstSpan;
+    for (int i = 0; i < blendshape.numSpans; i++) {
+        const Span& span = spans[i];
+        float* spanVertices = vertices + span.firstFloat;
+        float* spanNormals = normals + span.firstFloat;
+        const float* vertexDeltas = span.vertexDeltas;
+        const float* normalDeltas = span.normalDeltas;
+        for (int j = 0; j < span.numFloats; j++) {
+            spanVertices[j] += vertexDeltas[j] * coefficient;
+        }
+        for (int j = 0; j < span.numFloats; j++) {
+            spanNormals[j] += normalDeltas[j] * normalCoefficient;
+        }
+    }
+}
+
+bool BlendshapeEvaluator::evaluate(const QVector<float>& coefficients) {
+    int numBlendshapes = _blendshapes.size();
+    int numChanged = 0;
+    int numChangedVertices = 0;
+    int numActiveVertices = 0;
+    for (int i = 0; i < numBlendshapes; i++) {
+        float coefficient = (i < coefficients.size()) ? coefficients.at(i) : 0.0f;
+        if (coefficient < EPSILON) {
+            coefficient = 0.0f;
+        } else {
+            numActiveVertices += _blendshapes.at(i).numVertices;
+        }
+        _targetCoefficients[i] = coefficient;
+
+        // a coefficient that falls to zero is always removed, however close to zero it was
+        float applied = _appliedCoefficients.at(i);
+        bool changed = coefficient != applied && (fabsf(coefficient - applied) > COEFFICIENT_TOLERANCE || coefficient == 0.0f);
+        _changedCoefficients[i] = changed;
+        if (changed) {
+            numChanged++;
+            numChangedVertices += _blendshapes.at(i).numVertices;
+        }
+    }
+
+    _numUpdatedVertices = 0;
+    _wasRebuilt = false;
+    if (_hasResults && numChanged == 0) {
+        return false;
+    }
+
+    // data() copies the results first if the last ones are still shared with whoever they were handed to
+    float* vertices = reinterpret_cast<float*>(_vertices.data());
+    float* normals = reinterpret_cast<float*>(_normals.data());
+
+    // rebuild when it's cheaper than updating, including at rest, where it's just a copy of the base vertices
+    if (!_hasResults || _numIncrementalUpdates >= MAX_INCREMENTAL_UPDATES || numActiveVertices == 0 ||
+            numChangedVertices > _baseVertices.size() + numActiveVertices) {
+        memcpy(vertices, _baseVertices.constData(), _baseVertices.size() * sizeof(glm::vec3));
+        memcpy(normals, _baseNormals.constData(), _baseNormals.size() * sizeof(glm::vec3));
+        for (int i = 0; i < numBlendshapes; i++) {
+            float coefficient = _targetCoefficients.at(i);
+            if (coefficient != 0.0f) {
+                applyBlendshape(i, coefficient, vertices, normals);
+            }
+            _appliedCoefficients[i] = coefficient;
+        }
+        _numUpdatedVertices = numActiveVertices;
+        _numIncrementalUpdates = 0;
+        _wasRebuilt = true;
+        _hasResults = true;
+        return true;
+    }
+
+    for (int i = 0; i < numBlendshapes; i++) {
+        if (_changedCoefficients.at(i)) {
+            float coefficient = _targetCoefficients.at(i);
+            applyBlendshape(i, coefficient - _appliedCoefficients.at(i), vertices, normals);
+            _appliedCoefficients[i] = coefficient;
+        }
+    }
+    _numUpdatedVertices = numChangedVertices;
+    _numIncrementalUpdates++;
+    return true;
+}
@@ -0,0 +1,96 @@
+//
+//  BlendshapeEvaluator.h
+//  libraries/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BlendshapeEvaluator_h
+#define hifi_BlendshapeEvaluator_h
+
+#include <glm/glm.hpp>
+
+#include <QVector>
+
+#include "FBXReader.h"
+
+/// Blends the meshes of a geometry that have blendshapes, keeping the results from one call to the next so that a call
+/// only does the work for the coefficients that changed:
+///
+/// - coefficients below EPSILON count as zero, as they always have
+/// - a coefficient that moved by less than COEFFICIENT_TOLERANCE since it was last applied is left where it was
+/// - a changed coefficient adds the difference times its blendshape to just the vertices that the blendshape touches
+/// - runs of consecutive vertex indices in a blendshape are added as spans of floats, which the compiler vectorizes
+/// - every so often, or when rebuilding is cheaper than updating, the results are rebuilt from the base vertices so
+///   that rounding errors can't accumulate
+///
+/// Keeps pointers into the meshes' blendshapes and is not thread safe.
+class BlendshapeEvaluator {
+public:
+    BlendshapeEvaluator();
+
+    /// Sets the meshes to blend.  Does nothing if they share their data with the meshes already set.
+    void setMeshes(const QVector<FBXMesh>& meshes);
+
+    /// Blends the meshes with the given coefficients.
+    /// \return whether the blended vertices and normals changed since the last call
+    bool evaluate(const QVector<float>& coefficients);
+
+    /// the blended vertices of the meshes with blendshapes, one mesh after the other in mesh order
+    const QVector<glm::vec3>& getVertices() const { return _vertices; }
+
+    /// the blended normals, laid out like the vertices
+    const QVector<glm::vec3>& getNormals() const { return _normals; }
+
+    /// \return the number of vertices the last evaluate() wrote, counting one for each blendshape that touched them
+    int getNumUpdatedVertices() const { return _numUpdatedVertices; }
+
+    /// \return whether the last evaluate() rebuilt the results from the base vertices
+    bool wasRebuilt() const { return _wasRebuilt; }
+
+private:
+
+    class Span {
+    public:
+        int firstFloat;
+        int numFloats;
+        const float* vertexDeltas;
+        const float* normalDeltas;
+    };
+
+    class BlendshapeSpans {
+    public:
+        int firstSpan;
+        int numSpans;
+        int numVertices;
+    };
+
+    void addSpans(const FBXBlendshape& blendshape, int vertexOffset);
+    void applyBlendshape(int index, float coefficient, float* vertices, float* normals);
+
+    QVector<FBXMesh> _meshes;
+    bool _hasResults;
+
+    QVector<glm::vec3> _baseVertices;
+    QVector<glm::vec3> _baseNormals;
+    QVector<glm::vec3> _vertices;
+    QVector<glm::vec3> _normals;
+
+    // the spans of each blendshape index, over all of the meshes
+    QVector<BlendshapeSpans> _blendshapes;
+    QVector<Span> _spans;
+
+    QVector<float> _appliedCoefficients;
+    QVector<float> _targetCoefficients;
+    QVector<bool> _changedCoefficients;
+    int _numIncrementalUpdates;
+
+    int _numUpdatedVertices;
+    bool _wasRebuilt;
+};
+
+#endif // hifi_BlendshapeEvaluator_h
@@ -9,6 +9,7 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
 #include <iostream>
 #include <QBuffer>
 #include <QDataStream>
@@ -22,6 +23,8 @@
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <zlib.h>
+
 #include <GeometryUtil.h>
 #include <OctalCode.h>
 #include <Shape.h>
@@ -84,6 +87,55 @@ static int fbxGeometryMetaTypeId = qRegisterMetaType<FBXGeometry>();
 static int fbxAnimationFrameMetaTypeId = qRegisterMetaType<FBXAnimationFrame>();
 static int fbxAnimationFrameVectorMetaTypeId = qRegisterMetaType<QVector<FBXAnimationFrame> >();
 
+const unsigned int DEFLATE_ENCODING = 1;
+
+// deflate can't do better than about a thousand to one, so anything that claims more is corrupt
+const quint64 MAX_DEFLATE_RATIO = 1032;
+
+// makes sure an array of the given size can be there before we allocate it
+void checkBinaryArraySize(QDataStream& in, quint32 encoding, quint32 compressedLength, quint64 size) {
+    if (encoding == DEFLATE_ENCODING ? size > (quint64)compressedLength * MAX_DEFLATE_RATIO
+            : size > (quint64)in.device()->bytesAvailable()) {
+        throw QString("Invalid FBX array length");
+    }
+}
+
+// reads the data of a binary array straight into the buffer, inflating it if it's compressed
+void readBinaryArrayData(QDataStream& in, quint32 encoding, quint32 compressedLength, char* data, quint32 size) {
+    if (encoding != DEFLATE_ENCODING) {
+        if (in.readRawData(data, size) != (int)size) {
+            throw QString("Truncated FBX array");
+        }
+        return;
+    }
+    QByteArray compressed(compressedLength, 0);
+    if (in.readRawData(compressed.data(), compressedLength) != (int)compressedLength) {
+        throw QString("Truncated FBX array");
+    }
+    if (size == 0) {
+        return;
+    }
+
+    z_stream stream;
+    stream.next_in = (Bytef*)compressed.data();
+    stream.avail_in = compressedLength;
+    stream.next_out = (Bytef*)data;
+    stream.avail_out = size;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    if (inflateInit(&stream) != Z_OK) {
+        throw QString("Failed to inflate FBX array");
+    }
+    int result = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END || stream.total_out != size) {
+        throw QString("Failed to inflate FBX array");
+    }
+}
+
+/// Decodes a binary array into a vector allocated up front at its final size, without going through QDataStream
+/// value by value.
 template<class T> QVariant readBinaryArray(QDataStream& in) {
     quint32 arrayLength;
     quint32 encoding;
@@ -93,28 +145,36 @@ template<class T> QVariant readBinaryArray(QDataStream& in) {
     in >> encoding;
     in >> compressedLength;
 
-    QVector<T> values;
-    const unsigned int DEFLATE_ENCODING = 1;
-    if (encoding == DEFLATE_ENCODING) {
-        // preface encoded data with uncompressed length
-        QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-        *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-        in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-        QByteArray uncompressed = qUncompress(compressed);
-        QDataStream uncompressedIn(uncompressed);
-        uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-        uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            uncompressedIn >> value;
-            values.append(value);
-        }
-    } else {
-        for (quint32 i = 0; i < arrayLength; i++) {
-            T value;
-            in >> value;
-            values.append(value);
-        }
+    checkBinaryArraySize(in, encoding, compressedLength, (quint64)arrayLength * sizeof(T));
+    QVector<T> values(arrayLength);
+    readBinaryArrayData(in, encoding, compressedLength, (char*)values.data(), arrayLength * sizeof(T));
+
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    for (T* value = values.data(), *end = value + arrayLength; value != end; value++) {
+        char* bytes = (char*)value;
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+#endif
+    return QVariant::fromValue(values);
+}
+
+// FBX booleans are a byte each, which we don't want to assume of bool
+template<> QVariant readBinaryArray<bool>(QDataStream& in) {
+    quint32 arrayLength;
+    quint32 encoding;
+    quint32 compressedLength;
+
+    in >> arrayLength;
+    in >> encoding;
+    in >> compressedLength;
+
+    checkBinaryArraySize(in, encoding, compressedLength, arrayLength);
+    QByteArray bytes(arrayLength, 0);
+    readBinaryArrayData(in, encoding, compressedLength, bytes.data(), arrayLength);
+
+    QVector<bool> values(arrayLength);
+    for (quint32 i = 0; i < arrayLength; i++) {
+        values[i] = (bytes.at(i) != 0);
     }
     return QVariant::fromValue(values);
 }
@@ -289,7 +349,53 @@ int Tokenizer::nextToken() {
     return -1;
 }
 
-FBXNode parseTextFBXNode(Tokenizer& tokenizer) {
+// we don't trust array lengths from the file with more than this
+const int MAX_RESERVED_TEXT_ARRAY_LENGTH = 1 << 24;
+
+/// Collects the values of a text array node into a typed vector as they are tokenized, as integers for as long as they
+/// all are, rather than keeping a QByteArray property for each value.
+class TextFBXArray {
+public:
+
+    TextFBXArray(int expectedLength) : _isIntegral(true), _intValues(), _doubleValues() {
+        _intValues.reserve(qBound(0, expectedLength, MAX_RESERVED_TEXT_ARRAY_LENGTH));
+    }
+
+    void append(const QByteArray& datum);
+
+    QVariant getValues() const;
+
+private:
+
+    bool _isIntegral;
+    QVector<int> _intValues;
+    QVector<double> _doubleValues;
+};
+
+void TextFBXArray::append(const QByteArray& datum) {
+    if (_isIntegral) {
+        bool ok;
+        int value = datum.toInt(&ok);
+        if (ok) {
+            _intValues.append(value);
+            return;
+        }
+        // switch over to doubles for this value and the rest
+        _isIntegral = false;
+        _doubleValues.reserve(qMax(_intValues.capacity(), _intValues.size() + 1));
+        foreach (int intValue, _intValues) {
+            _doubleValues.append(intValue);
+        }
+        _intValues = QVector<int>();
+    }
+    _doubleValues.append(datum.toDouble());
+}
+
+QVariant TextFBXArray::getValues() const {
+    return _isIntegral ? QVariant::fromValue(_intValues) : QVariant::fromValue(_doubleValues);
+}
+
+FBXNode parseTextFBXNode(Tokenizer& tokenizer, int expectedArrayLength = 0) {
     FBXNode node;
 
     if (tokenizer.nextToken() != Tokenizer::DATUM_TOKEN) {
@@ -301,14 +407,27 @@ FBXNode parseTextFBXNode(Tokenizer& tokenizer) {
         return node;
     }
 
+    // the values of array nodes ("a: 1,2,3") end up in a single typed property
+    bool isArray = (node.name == "a");
+    TextFBXArray array(isArray ? expectedArrayLength : 0);
+
     int token;
     bool expectingDatum = true;
     while ((token = tokenizer.nextToken()) != -1) {
         if (token == '{') {
-            for (FBXNode child = parseTextFBXNode(tokenizer); !child.name.isNull(); child = parseTextFBXNode(tokenizer)) {
+            // a node with an array child gives the array length as "*length"
+            int childArrayLength = 0;
+            if (!node.properties.isEmpty()) {
+                QByteArray firstProperty = node.properties.at(0).toByteArray();
+                if (firstProperty.startsWith('*')) {
+                    childArrayLength = firstProperty.mid(1).toInt();
+                }
+            }
+            for (FBXNode child = parseTextFBXNode(tokenizer, childArrayLength); !child.name.isNull();
+                    child = parseTextFBXNode(tokenizer, childArrayLength)) {
                 node.children.append(child);
             }
-            return node;
+            break;
         }
         if (token == ',') {
             expectingDatum = true;
@@ -318,19 +437,26 @@ FBXNode parseTextFBXNode(Tokenizer& tokenizer) {
             if ((token = tokenizer.nextToken()) == ':') {
                 tokenizer.ungetChar(':');
                 tokenizer.pushBackToken(Tokenizer::DATUM_TOKEN);
-                return node;    
+                break;
                 
             } else {
                 tokenizer.pushBackToken(token);
-                node.properties.append(datum);
+                if (isArray) {
+                    array.append(datum);
+                } else {
+                    node.properties.append(datum);
+                }
                 expectingDatum = false;
             }
         } else {
             tokenizer.pushBackToken(token);
-            return node;
+            break;
         }
     }
 
+    if (isArray) {
+        node.properties.append(array.getValues());
+    }
     return node;
 }
 
@@ -414,22 +540,24 @@ QVariantHash parseMapping(QIODevice* device) {
 }
 
 QVector<glm::vec3> createVec3Vector(const QVector<double>& doubleVector) {
-    QVector<glm::vec3> values;
+    QVector<glm::vec3> values(doubleVector.size() / 3);
+    glm::vec3* value = values.data();
     for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 3 * 3); it != end; ) {
         float x = *it++;
         float y = *it++;
         float z = *it++;
-        values.append(glm::vec3(x, y, z));
+        *value++ = glm::vec3(x, y, z);
     }
     return values;
 }
 
 QVector<glm::vec2> createVec2Vector(const QVector<double>& doubleVector) {
-    QVector<glm::vec2> values;
+    QVector<glm::vec2> values(doubleVector.size() / 2);
+    glm::vec2* value = values.data();
     for (const double* it = doubleVector.constData(), *end = it + (doubleVector.size() / 2 * 2); it != end; ) {
         float s = *it++;
         float t = *it++;
-        values.append(glm::vec2(s, -t));
+        *value++ = glm::vec2(s, -t);
     }
     return values;
 }
@@ -441,61 +569,58 @@ glm::mat4 createMat4(const QVector<double>& doubleVector) {
         doubleVector.at(12), doubleVector.at(13), doubleVector.at(14), doubleVector.at(15));
 }
 
-QVector<int> getIntVector(const FBXNode& node) {
-    foreach (const FBXNode& child, node.children) {
-        if (child.name == "a") {
-            return getIntVector(child);
-        }
+// converts an array property of another type, returns false if the property isn't a vector of U
+template<class T, class U> bool convertArrayProperty(const QVariant& property, QVector<T>& vector) {
+    if (property.userType() != qMetaTypeId<QVector<U> >()) {
+        return false;
     }
-    if (node.properties.isEmpty()) {
-        return QVector<int>();
-    }
-    QVector<int> vector = node.properties.at(0).value<QVector<int> >();
-    if (!vector.isEmpty()) {
-        return vector;
+    QVector<U> values = property.value<QVector<U> >();
+    vector.resize(values.size());
+    T* value = vector.data();
+    for (const U* it = values.constData(), *end = it + values.size(); it != end; ) {
+        *value++ = (T)*it++;
     }
-    for (int i = 0; i < node.properties.size(); i++) {
-        vector.append(node.properties.at(i).toInt());
-    }
-    return vector;
+    return true;
 }
 
-QVector<float> getFloatVector(const FBXNode& node) {
+/// Returns the values of an array node. Arrays that already have the type asked for are shared with the node rather
+/// than copied.
+template<class T> QVector<T> getArray(const FBXNode& node) {
     foreach (const FBXNode& child, node.children) {
         if (child.name == "a") {
-            return getFloatVector(child);
+            return getArray<T>(child);
         }
     }
     if (node.properties.isEmpty()) {
-        return QVector<float>();
+        return QVector<T>();
+    }
+    const QVariant& property = node.properties.at(0);
+    if (property.userType() == qMetaTypeId<QVector<T> >()) {
+        return property.value<QVector<T> >();
     }
-    QVector<float> vector = node.properties.at(0).value<QVector<float> >();
-    if (!vector.isEmpty()) {
+    QVector<T> vector;
+    if (convertArrayProperty<T, int>(property, vector) || convertArrayProperty<T, double>(property, vector)
+            || convertArrayProperty<T, float>(property, vector) || convertArrayProperty<T, qint64>(property, vector)) {
         return vector;
     }
+    // one property per value
+    vector.resize(node.properties.size());
     for (int i = 0; i < node.properties.size(); i++) {
-        vector.append(node.properties.at(i).toFloat());
+        vector[i] = node.properties.at(i).value<T>();
     }
     return vector;
 }
 
+QVector<int> getIntVector(const FBXNode& node) {
+    return getArray<int>(node);
+}
+
+QVector<float> getFloatVector(const FBXNode& node) {
+    return getArray<float>(node);
+}
+
 QVector<double> getDoubleVector(const FBXNode& node) {
-    foreach (const FBXNode& child, node.children) {
-        if (child.name == "a") {
-            return getDoubleVector(child);
-        }
-    }
-    if (node.properties.isEmpty()) {
-        return QVector<double>();
-    }
-    QVector<double> vector = node.properties.at(0).value<QVector<double> >();
-    if (!vector.isEmpty()) {
-        return vector;
-    }
-    for (int i = 0; i < node.properties.size(); i++) {
-        vector.append(node.properties.at(i).toDouble());
-    }
-    return vector;
+    return getArray<double>(node);
 }
 
 glm::vec3 getVec3(const QVariantList& properties, int index) {
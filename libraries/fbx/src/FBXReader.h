@@ -23,6 +23,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+class QIODevice;
+
 class FBXNode;
 
 typedef QList<FBXNode> FBXNodeList;
@@ -242,6 +244,15 @@ QVariantHash readMapping(const QByteArray& data);
 /// Writes an FST mapping to a byte array.
 QByteArray writeMapping(const QVariantHash& mapping);
 
+/// Parses the node tree of a binary or text FBX document. Arrays are stored as a single typed vector property, such as
+/// QVector<double> or QVector<int>.
+/// \exception QString if an error occurs in parsing
+FBXNode parseFBX(QIODevice* device);
+
+/// The version of readFBX(). Bump it whenever a change to the reader changes the geometry it makes of a model, so that
+/// geometry baked from an older reader gets baked again.  Version 2 reads text arrays into typed vectors.
+const quint32 FBX_READER_VERSION = 2;
+
 /// Reads FBX geometry from the supplied model and mapping data.
 /// \exception QString if an error occurs in parsing
 FBXGeometry readFBX(const QByteArray& model, const QVariantHash& mapping);
@@ -30,23 +30,27 @@ void MetavoxelClientManager::update() {
 
 SharedObjectPointer MetavoxelClientManager::findFirstRaySpannerIntersection(const glm::vec3& origin,
         const glm::vec3& direction, const AttributePointer& attribute, float& distance) {
-    SharedObjectPointer closestSpanner;
-    float closestDistance = FLT_MAX;
+    // take snapshots of the clients' data so that the clients aren't locked while we search them
+    QList<MetavoxelData> clientData;
     foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
         if (node->getType() == NodeType::MetavoxelServer) {
             QMutexLocker locker(&node->getMutex());
             MetavoxelClient* client = static_cast<MetavoxelClient*>(node->getLinkedData());
             if (client) {
-                float clientDistance;
-                SharedObjectPointer clientSpanner = client->getData().findFirstRaySpannerIntersection(
-                    origin, direction, attribute, clientDistance);
-                if (clientSpanner && clientDistance < closestDistance) {
-                    closestSpanner = clientSpanner;
-                    closestDistance = clientDistance;
-                }
+                clientData.append(client->getData());
             }
         }
     }
+    SharedObjectPointer closestSpanner;
+    float closestDistance = FLT_MAX;
+    for (QList<MetavoxelData>::iterator it = clientData.begin(); it != clientData.end(); it++) {
+        float clientDistance;
+        SharedObjectPointer clientSpanner = it->findFirstRaySpannerIntersection(origin, direction, attribute, clientDistance);
+        if (clientSpanner && clientDistance < closestDistance) {
+            closestSpanner = clientSpanner;
+            closestDistance = clientDistance;
+        }
+    }
     if (closestSpanner) {
         distance = closestDistance;
     }
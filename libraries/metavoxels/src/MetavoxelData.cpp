@@ -611,6 +611,14 @@ MetavoxelNode* MetavoxelData::createRoot(const AttributePointer& attribute) {
     return root = new MetavoxelNode(attribute);
 }
 
+MetavoxelNode* MetavoxelData::detachRoot(const AttributePointer& attribute) {
+    MetavoxelNode*& root = _roots[attribute];
+    MetavoxelNode* oldRoot = root;
+    root = new MetavoxelNode(attribute, oldRoot);
+    oldRoot->decrementReferenceCount(attribute);
+    return root;
+}
+
 bool MetavoxelData::deepEquals(const MetavoxelData& other, const MetavoxelLOD& lod) const {
     if (_size != other._size) {
         return false;
@@ -693,6 +701,21 @@ template<> void Bitstream::readDelta(MetavoxelData& value, const MetavoxelData&
     value.readDelta(reference, MetavoxelLOD(), *this, MetavoxelLOD());
 }
 
+MetavoxelData PublishedMetavoxelData::getSnapshot() const {
+    QReadLocker locker(&_lock);
+    return _data;
+}
+
+void PublishedMetavoxelData::publish(const MetavoxelData& data) {
+    // hold on to the old version so that it's released after the lock
+    MetavoxelData oldData;
+    {
+        QWriteLocker locker(&_lock);
+        oldData = _data;
+        _data = data;
+    }
+}
+
 bool MetavoxelStreamState::shouldSubdivide() const {
     return lod.shouldSubdivide(minimum, size, attribute->getLODThresholdMultiplier());
 }
@@ -842,12 +865,14 @@ void MetavoxelNode::readDelta(const MetavoxelNode& reference, MetavoxelStreamSta
                 if (changed) {    
                     _children[i] = new MetavoxelNode(state.attribute);
                     _children[i]->readDelta(*reference._children[i], nextState);
+                } else if (nextState.becameSubdivided()) {
+                    // read into a copy rather than the reference's node, which other versions may share
+                    _children[i] = new MetavoxelNode(state.attribute, reference._children[i]);
+                    _children[i]->readSubdivision(nextState);
+                    
                 } else {
                     _children[i] = reference._children[i];
                     _children[i]->incrementReferenceCount();
-                    if (nextState.becameSubdivided()) {
-                        _children[i]->readSubdivision(nextState);
-                    }
                 }
             }
         }
@@ -913,6 +938,9 @@ void MetavoxelNode::readSubdivision(MetavoxelStreamState& state) {
             for (int i = 0; i < CHILD_COUNT; i++) {
                 nextState.setMinimum(state.minimum, i);
                 if (nextState.becameSubdivided()) {
+                    MetavoxelNode* oldChild = _children[i];
+                    _children[i] = new MetavoxelNode(state.attribute, oldChild);
+                    oldChild->decrementReferenceCount(state.attribute);
                     _children[i]->readSubdivision(nextState);
                 }
             }
@@ -1027,7 +1055,7 @@ void MetavoxelNode::writeSpannerSubdivision(MetavoxelStreamState& state) const {
 }
 
 void MetavoxelNode::decrementReferenceCount(const AttributePointer& attribute) {
-    if (--_referenceCount == 0) {
+    if (!_referenceCount.deref()) {
         destroy(attribute);
         delete this;
     }
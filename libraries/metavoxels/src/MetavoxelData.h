@@ -12,8 +12,10 @@
 #ifndef hifi_MetavoxelData_h
 #define hifi_MetavoxelData_h
 
+#include <QAtomicInt>
 #include <QBitArray>
 #include <QHash>
+#include <QReadWriteLock>
 #include <QSharedData>
 #include <QSharedPointer>
 #include <QScriptString>
@@ -121,6 +123,10 @@ public:
     MetavoxelNode* getRoot(const AttributePointer& attribute) const { return _roots.value(attribute); }
     MetavoxelNode* createRoot(const AttributePointer& attribute);
 
+    /// Replaces the existing root for the specified attribute with a shallow copy that may be changed without affecting
+    /// the other versions of the data that share the original.
+    MetavoxelNode* detachRoot(const AttributePointer& attribute);
+
     /// Performs a deep comparison between this data and the specified other (as opposed to the == operator, which does a
     /// shallow comparison).
     bool deepEquals(const MetavoxelData& other, const MetavoxelLOD& lod = MetavoxelLOD()) const;
@@ -154,6 +160,24 @@ template<> void Bitstream::readDelta(MetavoxelData& value, const MetavoxelData&
 
 Q_DECLARE_METATYPE(MetavoxelData)
 
+/// Holds the current version of metavoxel data that one thread edits while others read it.  Edits never change the nodes
+/// of a version (they copy the path to what they change and share the rest), so a snapshot taken here stays the same
+/// however long it's kept, and the reference counts of the nodes may be changed from any thread.
+class PublishedMetavoxelData {
+public:
+
+    /// Returns a shallow copy of the current version.
+    MetavoxelData getSnapshot() const;
+
+    /// Replaces the current version.  The previous version is released in the calling thread unless snapshots of it remain.
+    void publish(const MetavoxelData& data);
+
+private:
+
+    mutable QReadWriteLock _lock;
+    MetavoxelData _data;
+};
+
 /// Holds the state used in streaming metavoxel data.
 class MetavoxelStreamState {
 public:
@@ -208,7 +232,7 @@ public:
     void writeSpannerSubdivision(MetavoxelStreamState& state) const;
 
     /// Increments the node's reference count.
-    void incrementReferenceCount() { _referenceCount++; }
+    void incrementReferenceCount() { _referenceCount.ref(); }
 
     /// Decrements the node's reference count.  If the resulting reference count is zero, destroys the node
     /// and calls delete this.
@@ -234,7 +258,7 @@ private:
     
     friend class MetavoxelVisitation;
     
-    int _referenceCount;
+    QAtomicInt _referenceCount;
     void* _attributeValue;
     MetavoxelNode* _children[CHILD_COUNT];
 };
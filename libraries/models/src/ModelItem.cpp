@@ -12,6 +12,7 @@
 #include <QtCore/QObject>
 
 #include <Octree.h>
+#include <OctreeItemDeltas.h>
 #include <RegisteredMetaTypes.h>
 #include <SharedUtil.h> // usecTimestampNow()
 #include <VoxelsScriptingInterface.h>
@@ -30,6 +31,28 @@
 
 uint32_t ModelItem::_nextID = 0;
 
+// the properties of a model read in full, or made locally
+static ModelItemPropertyFlags allModelItemProperties() {
+    ModelItemPropertyFlags properties;
+    for (int i = 0; i < MODEL_ITEM_PROP_COUNT; i++) {
+        if (i != MODEL_ITEM_PROP_QUANTIZED_POSITION) {
+            properties.setHasProperty((ModelItemPropertyList)i);
+        }
+    }
+    return properties;
+}
+
+// reads a property of a fixed size, unless there are too few bytes left for it
+static bool readProperty(const unsigned char*& dataAt, int& bytesLeftToRead, void* value, int size) {
+    if (bytesLeftToRead < size) {
+        return false;
+    }
+    memcpy(value, dataAt, size);
+    dataAt += size;
+    bytesLeftToRead -= size;
+    return true;
+}
+
 // for locally created models
 std::map<uint32_t,uint32_t> ModelItem::_tokenIDsToIDs;
 uint32_t ModelItem::_nextCreatorTokenID = 0;
@@ -95,6 +118,8 @@ ModelItem::ModelItem(const ModelItemID& modelItemID, const ModelItemProperties&
 
     _jointMappingCompleted = false;
     _lastAnimated = now;
+    _readProperties = allModelItemProperties();
+    _lastPartiallyEdited = 0;
     
     setProperties(properties);
 }
@@ -129,75 +154,95 @@ void ModelItem::init(glm::vec3 position, float radius, rgbColor color, uint32_t
     _glowLevel = 0.0f;
     _jointMappingCompleted = false;
     _lastAnimated = now;
+    _readProperties = allModelItemProperties();
+    _lastPartiallyEdited = 0;
 }
 
-bool ModelItem::appendModelData(OctreePacketData* packetData) const {
-
-    bool success = packetData->appendValue(getID());
+bool ModelItem::appendModelData(OctreePacketData* packetData, OctreeItemDeltas* deltas,
+                                const AACube* containingCube) const {
+    if (deltas) {
+        deltas->beginItem(packetData, getID(), containingCube);
+    }
 
-    //qDebug("ModelItem::appendModelData()... getID()=%d", getID());
+    // the properties follow their flags, so they're collected before anything is appended
+    ModelItemPropertyFlags propertyFlags;
+    QByteArray propertyBytes;
 
-    if (success) {
-        success = packetData->appendValue(getLastUpdated());
-    }
-    if (success) {
-        success = packetData->appendValue(getLastEdited());
-    }
-    if (success) {
-        success = packetData->appendValue(getRadius());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, MODEL_ITEM_PROP_RADIUS, &_radius, sizeof(_radius))) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_RADIUS);
     }
-    if (success) {
-        success = packetData->appendPosition(getPosition());
+    int positionProperty = OctreeItemDeltas::appendPositionProperty(deltas, propertyBytes, MODEL_ITEM_PROP_POSITION,
+        MODEL_ITEM_PROP_QUANTIZED_POSITION, _position, _radius, containingCube);
+    if (positionProperty != -1) {
+        propertyFlags.setHasProperty((ModelItemPropertyList)positionProperty);
     }
-    if (success) {
-        success = packetData->appendColor(getColor());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, MODEL_ITEM_PROP_COLOR, _color, sizeof(_color))) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_COLOR);
     }
-    if (success) {
-        success = packetData->appendValue(getShouldDie());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, MODEL_ITEM_PROP_SHOULD_DIE, &_shouldDie,
+                                         sizeof(_shouldDie))) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_SHOULD_DIE);
     }
 
     // modelURL
-    if (success) {
-        uint16_t modelURLLength = _modelURL.size() + 1; // include NULL
-        success = packetData->appendValue(modelURLLength);
-        if (success) {
-            success = packetData->appendRawData((const unsigned char*)qPrintable(_modelURL), modelURLLength);
-        }
+    if (OctreeItemDeltas::appendStringProperty(deltas, propertyBytes, MODEL_ITEM_PROP_MODEL_URL, _modelURL)) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_MODEL_URL);
     }
 
-    // modelRotation
-    if (success) {
-        success = packetData->appendValue(getModelRotation());
+    // modelRotation, packed into the same 8 bytes OctreePacketData::appendValue(glm::quat) has always written, in files too
+    unsigned char packedRotation[sizeof(glm::quat)];
+    int packedRotationBytes = packOrientationQuatToBytes(packedRotation, _modelRotation);
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, MODEL_ITEM_PROP_MODEL_ROTATION, packedRotation,
+                                         packedRotationBytes)) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_MODEL_ROTATION);
     }
 
     // animationURL
-    if (success) {
-        uint16_t animationURLLength = _animationURL.size() + 1; // include NULL
-        success = packetData->appendValue(animationURLLength);
-        if (success) {
-            success = packetData->appendRawData((const unsigned char*)qPrintable(_animationURL), animationURLLength);
-        }
+    if (OctreeItemDeltas::appendStringProperty(deltas, propertyBytes, MODEL_ITEM_PROP_ANIMATION_URL, _animationURL)) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_ANIMATION_URL);
     }
 
-    // animationIsPlaying
-    if (success) {
-        success = packetData->appendValue(getAnimationIsPlaying());
+    // animationIsPlaying, animationFrameIndex, animationFPS
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, MODEL_ITEM_PROP_ANIMATION_IS_PLAYING, &_animationIsPlaying,
+                                         sizeof(_animationIsPlaying))) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_ANIMATION_IS_PLAYING);
+    }
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, MODEL_ITEM_PROP_ANIMATION_FRAME_INDEX,
+                                         &_animationFrameIndex, sizeof(_animationFrameIndex))) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_ANIMATION_FRAME_INDEX);
+    }
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, MODEL_ITEM_PROP_ANIMATION_FPS, &_animationFPS,
+                                         sizeof(_animationFPS))) {
+        propertyFlags.setHasProperty(MODEL_ITEM_PROP_ANIMATION_FPS);
     }
 
-    // animationFrameIndex
+    bool success = packetData->appendValue(getID());
+
+    //qDebug("ModelItem::appendModelData()... getID()=%d", getID());
+
     if (success) {
-        success = packetData->appendValue(getAnimationFrameIndex());
+        success = packetData->appendValue(getLastUpdated());
+    }
+    if (success) {
+        success = packetData->appendValue(getLastEdited());
     }
-
-    // animationFPS
     if (success) {
-        success = packetData->appendValue(getAnimationFPS());
+        QByteArray encodedFlags = propertyFlags.encode();
+        success = packetData->appendRawData((const unsigned char*)encodedFlags.constData(), encodedFlags.size());
+    }
+    if (success) {
+        success = packetData->appendRawData((const unsigned char*)propertyBytes.constData(), propertyBytes.size());
     }
-
     return success;
 }
 
-int ModelItem::expectedBytes() {
+int ModelItem::expectedBytes(PacketVersion bitstreamVersion) {
+    if (bitstreamVersion >= VERSION_MODELS_HAVE_PROPERTY_FLAGS) {
+        return sizeof(uint32_t) // id
+                + sizeof(quint64) // last updated
+                + sizeof(quint64) // lasted edited
+                + 1; // property flags, at least
+    }
     int expectedBytes = sizeof(uint32_t) // id
                 + sizeof(float) // age
                 + sizeof(quint64) // last updated
@@ -209,10 +254,122 @@ int ModelItem::expectedBytes() {
     return expectedBytes;
 }
 
-int ModelItem::readModelDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args) {
+int ModelItem::readModelDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args,
+                                       const AACube* containingCube) {
+    if (args.bitstreamVersion < VERSION_MODELS_HAVE_PROPERTY_FLAGS) {
+        return readModelDataWithoutPropertyFlags(data, bytesLeftToRead, args);
+    }
+    if (bytesLeftToRead < expectedBytes(args.bitstreamVersion)) {
+        return 0;
+    }
+    int clockSkew = args.sourceNode ? args.sourceNode->getClockSkewUsec() : 0;
+
+    const unsigned char* dataAt = data;
+    int bytesLeft = bytesLeftToRead;
+
+    // id, _lastUpdated, _lastEdited
+    readProperty(dataAt, bytesLeft, &_id, sizeof(_id));
+    readProperty(dataAt, bytesLeft, &_lastUpdated, sizeof(_lastUpdated));
+    _lastUpdated -= clockSkew;
+    readProperty(dataAt, bytesLeft, &_lastEdited, sizeof(_lastEdited));
+    _lastEdited -= clockSkew;
+
+    ModelItemPropertyFlags propertyFlags;
+    int bytes = propertyFlags.decode(dataAt, bytesLeft);
+    if (bytes > bytesLeft) {
+        return 0;
+    }
+    dataAt += bytes;
+    bytesLeft -= bytes;
+
+    bool isComplete = true;
+    if (propertyFlags.getHasProperty(MODEL_ITEM_PROP_RADIUS)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_radius, sizeof(_radius));
+    }
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_POSITION)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_position, sizeof(_position));
+    }
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_QUANTIZED_POSITION)) {
+        isComplete = containingCube && bytesLeft >= QUANTIZED_POSITION_BYTES;
+        if (isComplete) {
+            _position = OctreeItemDeltas::readQuantizedPosition(dataAt, *containingCube);
+            dataAt += QUANTIZED_POSITION_BYTES;
+            bytesLeft -= QUANTIZED_POSITION_BYTES;
+            propertyFlags.setHasProperty(MODEL_ITEM_PROP_POSITION);
+        }
+    }
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_COLOR)) {
+        isComplete = readProperty(dataAt, bytesLeft, _color, sizeof(_color));
+    }
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_SHOULD_DIE)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_shouldDie, sizeof(_shouldDie));
+    }
 
+    // modelURL, which is left out of the properties that were read if it refers to a string that isn't known
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_MODEL_URL)) {
+        QString modelURL;
+        bool isKnown = false;
+        bytes = OctreeReceivedStrings::readString(dataAt, bytesLeft, args.receivedStrings, modelURL, isKnown);
+        isComplete = bytes > 0;
+        dataAt += bytes;
+        bytesLeft -= bytes;
+        if (isKnown) {
+            setModelURL(modelURL);
+        } else {
+            propertyFlags.setHasProperty(MODEL_ITEM_PROP_MODEL_URL, false);
+        }
+    }
+
+    // modelRotation
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_MODEL_ROTATION)) {
+        const int PACKED_ROTATION_BYTES = 4 * sizeof(uint16_t);
+        isComplete = bytesLeft >= PACKED_ROTATION_BYTES;
+        if (isComplete) {
+            bytes = unpackOrientationQuatFromBytes(dataAt, _modelRotation);
+            dataAt += bytes;
+            bytesLeft -= bytes;
+        }
+    }
+
+    // animationURL
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_ANIMATION_URL)) {
+        QString animationURL;
+        bool isKnown = false;
+        bytes = OctreeReceivedStrings::readString(dataAt, bytesLeft, args.receivedStrings, animationURL, isKnown);
+        isComplete = bytes > 0;
+        dataAt += bytes;
+        bytesLeft -= bytes;
+        if (isKnown) {
+            setAnimationURL(animationURL);
+        } else {
+            propertyFlags.setHasProperty(MODEL_ITEM_PROP_ANIMATION_URL, false);
+        }
+    }
+
+    // animationIsPlaying, animationFrameIndex, animationFPS
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_ANIMATION_IS_PLAYING)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_animationIsPlaying, sizeof(_animationIsPlaying));
+    }
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_ANIMATION_FRAME_INDEX)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_animationFrameIndex, sizeof(_animationFrameIndex));
+    }
+    if (isComplete && propertyFlags.getHasProperty(MODEL_ITEM_PROP_ANIMATION_FPS)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_animationFPS, sizeof(_animationFPS));
+    }
+
+    if (!isComplete) {
+        return 0;
+    }
+    propertyFlags.setHasProperty(MODEL_ITEM_PROP_QUANTIZED_POSITION, false);
+    _readProperties = propertyFlags;
+    return bytesLeftToRead - bytesLeft;
+}
+
+int ModelItem::readModelDataWithoutPropertyFlags(const unsigned char* data, int bytesLeftToRead,
+                                                 ReadBitstreamToTreeParams& args) {
     int bytesRead = 0;
-    if (bytesLeftToRead >= expectedBytes()) {
+    if (bytesLeftToRead >= expectedBytes(args.bitstreamVersion)) {
+        _readProperties = allModelItemProperties();
         int clockSkew = args.sourceNode ? args.sourceNode->getClockSkewUsec() : 0;
 
         const unsigned char* dataAt = data;
@@ -779,8 +936,69 @@ void ModelItem::update(const quint64& updateTime) {
     }
 }
 
+bool ModelItem::wasReadWhole() const {
+    return _readProperties == allModelItemProperties();
+}
+
 void ModelItem::copyChangedProperties(const ModelItem& other) {
-    *this = other;
+    ModelItemPropertyFlags properties = other._readProperties;
+
+    // the properties we took from updates that left the others out are newer than what an older update has for them
+    bool isOlderThanPartialUpdates = other._lastEdited < _lastPartiallyEdited;
+    if (other.wasReadWhole() && !isOlderThanPartialUpdates) {
+        *this = other;
+        return;
+    }
+    if (isOlderThanPartialUpdates) {
+        properties -= _partiallyReadProperties;
+    }
+
+    _lastUpdated = other._lastUpdated;
+    if (other.wasReadWhole()) {
+        // we have all of the model as of this edit, apart from the properties of the newer partial updates
+        _lastEdited = other._lastEdited;
+    } else {
+        // The properties an update left out may have changed in the same edit, so an older update that has them still
+        // has to be taken. Only a whole update tells us we're up to date as of its edit.
+        _partiallyReadProperties += other._readProperties;
+        _lastPartiallyEdited = qMax(_lastPartiallyEdited, other._lastEdited);
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_RADIUS)) {
+        _radius = other._radius;
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_POSITION)) {
+        _position = other._position;
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_COLOR)) {
+        memcpy(_color, other._color, sizeof(_color));
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_SHOULD_DIE)) {
+        _shouldDie = other._shouldDie;
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_MODEL_ROTATION)) {
+        _modelRotation = other._modelRotation;
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_MODEL_URL) ||
+            properties.getHasProperty(MODEL_ITEM_PROP_ANIMATION_URL)) {
+        if (properties.getHasProperty(MODEL_ITEM_PROP_MODEL_URL)) {
+            _modelURL = other._modelURL;
+        }
+        if (properties.getHasProperty(MODEL_ITEM_PROP_ANIMATION_URL)) {
+            _animationURL = other._animationURL;
+        }
+        // the joints are mapped between the model and the animation again
+        _jointMappingCompleted = false;
+        _jointMapping.clear();
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_ANIMATION_IS_PLAYING)) {
+        _animationIsPlaying = other._animationIsPlaying;
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_ANIMATION_FRAME_INDEX)) {
+        _animationFrameIndex = other._animationFrameIndex;
+    }
+    if (properties.getHasProperty(MODEL_ITEM_PROP_ANIMATION_FPS)) {
+        _animationFPS = other._animationFPS;
+    }
 }
 
 ModelItemProperties ModelItem::getProperties() const {
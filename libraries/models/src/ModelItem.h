@@ -24,6 +24,7 @@
 #include <SharedUtil.h>
 #include <OctreePacketData.h>
 #include <FBXReader.h>
+#include <PropertyFlags.h>
 
 
 class ModelItem;
@@ -31,6 +32,7 @@ class ModelEditPacketSender;
 class ModelItemProperties;
 class ModelsScriptingInterface;
 class ModelTree;
+class OctreeItemDeltas;
 class ScriptEngine;
 class VoxelEditPacketSender;
 class VoxelsScriptingInterface;
@@ -60,6 +62,25 @@ const float MODEL_DEFAULT_ANIMATION_FPS = 30.0f;
 
 const PacketVersion VERSION_MODELS_HAVE_ANIMATION = 1;
 const PacketVersion VERSION_ROOT_ELEMENT_HAS_DATA = 2;
+const PacketVersion VERSION_MODELS_HAVE_PROPERTY_FLAGS = 3;
+
+/// The properties of a model item in a model data packet, which only holds the properties that are included in its flags.
+enum ModelItemPropertyList {
+    MODEL_ITEM_PROP_RADIUS,
+    MODEL_ITEM_PROP_POSITION,
+    MODEL_ITEM_PROP_QUANTIZED_POSITION, // the position relative to the cube of the element, instead of the position
+    MODEL_ITEM_PROP_COLOR,
+    MODEL_ITEM_PROP_SHOULD_DIE,
+    MODEL_ITEM_PROP_MODEL_URL,
+    MODEL_ITEM_PROP_MODEL_ROTATION,
+    MODEL_ITEM_PROP_ANIMATION_URL,
+    MODEL_ITEM_PROP_ANIMATION_IS_PLAYING,
+    MODEL_ITEM_PROP_ANIMATION_FRAME_INDEX,
+    MODEL_ITEM_PROP_ANIMATION_FPS,
+    MODEL_ITEM_PROP_COUNT
+};
+
+typedef PropertyFlags<ModelItemPropertyList> ModelItemPropertyFlags;
 
 /// A collection of properties of a model item used in the scripting API. Translates between the actual properties of a model
 /// and a JavaScript style hash/QScriptValue storing a set of properties. Used in scripting to set/get the complete set of
@@ -263,9 +284,13 @@ public:
     
     void setProperties(const ModelItemProperties& properties);
 
-    bool appendModelData(OctreePacketData* packetData) const;
-    int readModelDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args);
-    static int expectedBytes();
+    /// Appends the model to packet data. With deltas, only the properties the client hasn't been sent are included, and
+    /// the position is quantized into the containing cube of the element when that keeps it accurate.
+    bool appendModelData(OctreePacketData* packetData, OctreeItemDeltas* deltas = NULL,
+                         const AACube* containingCube = NULL) const;
+    int readModelDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args,
+                                const AACube* containingCube = NULL);
+    static int expectedBytes(PacketVersion bitstreamVersion);
 
     static bool encodeModelEditMessageDetails(PacketType command, ModelItemID id, const ModelItemProperties& details,
                         unsigned char* bufferOut, int sizeIn, int& sizeOut);
@@ -276,9 +301,12 @@ public:
 
     void debugDump() const;
 
-    // similar to assignment/copy, but it handles keeping lifetime accurate
+    // similar to assignment/copy, but only copies the properties that were read into the other model
     void copyChangedProperties(const ModelItem& other);
 
+    // whether the model was last read with all of its properties, rather than only the ones that changed
+    bool wasReadWhole() const;
+
     // these methods allow you to create models, and later edit them.
     static uint32_t getIDfromCreatorTokenID(uint32_t creatorTokenID);
     static uint32_t getNextCreatorTokenID();
@@ -295,6 +323,8 @@ public:
     static void cleanupLoadedAnimations();
 
 protected:
+    int readModelDataWithoutPropertyFlags(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args);
+
     glm::vec3 _position;
     rgbColor _color;
     float _radius;
@@ -325,6 +355,11 @@ protected:
     bool _jointMappingCompleted;
     QVector<int> _jointMapping;
     
+    ModelItemPropertyFlags _readProperties;
+
+    // the properties taken from updates that left others out, and the newest edit among them
+    ModelItemPropertyFlags _partiallyReadProperties;
+    quint64 _lastPartiallyEdited;
 
     // used by the static interfaces for creator token ids
     static uint32_t _nextCreatorTokenID;
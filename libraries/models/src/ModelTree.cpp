@@ -114,8 +114,9 @@ void ModelTree::storeModel(const ModelItem& model, const SharedNodePointer& send
     FindAndUpdateModelOperator theOperator(model);
     recurseTreeWithOperator(&theOperator);
     
-    // if we didn't find it in the tree, then store it...
-    if (!theOperator.wasFound()) {
+    // if we didn't find it in the tree, then store it... unless the update only had the properties that changed, the
+    // rest would be made up. The next whole update brings it in.
+    if (!theOperator.wasFound() && model.wasReadWhole()) {
         AACube modelCube = model.getAACube();
         ModelTreeElement* element = static_cast<ModelTreeElement*>(getOrCreateChildElementContaining(model.getAACube()));
         element->storeModel(model);
@@ -546,7 +547,8 @@ bool ModelTree::hasModelsDeletedSince(quint64 sinceTime) {
 
 // sinceTime is an in/out parameter - it will be side effected with the last time sent out
 bool ModelTree::encodeModelsDeletedSince(OCTREE_PACKET_SEQUENCE sequenceNumber, quint64& sinceTime, unsigned char* outputBuffer,
-                                            size_t maxLength, size_t& outputLength) {
+                                            size_t maxLength, size_t& outputLength,
+                                            OctreeItemDeltas* itemDeltas) {
 
     bool hasMoreToSend = true;
 
@@ -593,6 +595,9 @@ bool ModelTree::encodeModelsDeletedSince(OCTREE_PACKET_SEQUENCE sequenceNumber,
             if (iterator.key() > sinceTime) {
                 uint32_t modelID = values.at(valueItem);
                 memcpy(copyAt, &modelID, sizeof(modelID));
+                if (itemDeltas) {
+                    itemDeltas->forgetItem(modelID);
+                }
                 copyAt += sizeof(modelID);
                 outputLength += sizeof(modelID);
                 numberOfIds++;
@@ -74,10 +74,12 @@ public:
 
     bool hasAnyDeletedModels() const { return _recentlyDeletedModelItemIDs.size() > 0; }
     bool hasModelsDeletedSince(quint64 sinceTime);
-    bool encodeModelsDeletedSince(OCTREE_PACKET_SEQUENCE sequenceNumber, quint64& sinceTime, unsigned char* packetData, size_t maxLength, size_t& outputLength);
+    /// \param itemDeltas if not NULL, forgets what the client was sent of the erased items
+    bool encodeModelsDeletedSince(OCTREE_PACKET_SEQUENCE sequenceNumber, quint64& sinceTime, unsigned char* packetData,
+                                  size_t maxLength, size_t& outputLength, OctreeItemDeltas* itemDeltas = NULL);
     void forgetModelsDeletedBefore(quint64 sinceTime);
 
-    void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
+    virtual void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
     void handleAddModelResponse(const QByteArray& packet);
     
     void setFBXService(ModelItemFBXService* service) { _fbxService = service; }
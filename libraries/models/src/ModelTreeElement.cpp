@@ -86,7 +86,7 @@ bool ModelTreeElement::appendElementData(OctreePacketData* packetData, EncodeBit
             
             LevelDetails modelLevel = packetData->startLevel();
     
-            success = model.appendModelData(packetData);
+            success = model.appendModelData(packetData, params.itemDeltas, &_cube);
 
             if (success) {
                 packetData->endLevel(modelLevel);
@@ -457,7 +457,7 @@ int ModelTreeElement::readElementDataFromBuffer(const unsigned char* data, int b
     const unsigned char* dataAt = data;
     int bytesRead = 0;
     uint16_t numberOfModels = 0;
-    int expectedBytesPerModel = ModelItem::expectedBytes();
+    int expectedBytesPerModel = ModelItem::expectedBytes(args.bitstreamVersion);
 
     if (bytesLeftToRead >= (int)sizeof(numberOfModels)) {
         // read our models in....
@@ -470,7 +470,10 @@ int ModelTreeElement::readElementDataFromBuffer(const unsigned char* data, int b
         if (bytesLeftToRead >= (int)(numberOfModels * expectedBytesPerModel)) {
             for (uint16_t i = 0; i < numberOfModels; i++) {
                 ModelItem tempModel;
-                int bytesForThisModel = tempModel.readModelDataFromBuffer(dataAt, bytesLeftToRead, args);
+                int bytesForThisModel = tempModel.readModelDataFromBuffer(dataAt, bytesLeftToRead, args, &_cube);
+                if (bytesForThisModel == 0) {
+                    break; // the rest of the models can't be read
+                }
                 _myTree->storeModel(tempModel);
                 dataAt += bytesForThisModel;
                 bytesLeftToRead -= bytesForThisModel;
@@ -32,7 +32,3 @@ void ModelTreeHeadlessViewer::update() {
         }
     }
 }
-
-void ModelTreeHeadlessViewer::processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) {
-    static_cast<ModelTree*>(_tree)->processEraseMessage(dataByteArray, sourceNode);
-}
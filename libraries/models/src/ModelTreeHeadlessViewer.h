@@ -37,8 +37,6 @@ public:
 
     ModelTree* getTree() { return (ModelTree*)_tree; }
 
-    void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
-
     virtual void init();
 };
 
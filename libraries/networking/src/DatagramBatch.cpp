@@ -0,0 +1,129 @@
+//
+//  DatagramBatch.cpp
+//  libraries/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDebug>
+
+#ifdef Q_OS_LINUX
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include "DatagramBatch.h"
+
+DatagramBatch::DatagramBatch(QUdpSocket& socket) :
+    _socket(socket),
+    _isCollecting(false),
+    _datagrams(),
+    _destinations(),
+    _numDatagramsSent(0),
+    _numSendCalls(0),
+    _numFlushes(0),
+    _numSendCallsLastFlush(0)
+{
+    _datagrams.reserve(MAX_DATAGRAMS_PER_SEND);
+    _destinations.reserve(MAX_DATAGRAMS_PER_SEND);
+}
+
+void DatagramBatch::queueDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr) {
+    _datagrams.append(datagram);
+    _destinations.append(destinationSockAddr);
+}
+
+int DatagramBatch::flush() {
+    quint64 numSendCallsBefore = _numSendCalls;
+    int numWritten = 0;
+    int next = 0;
+
+    while (next < _datagrams.size()) {
+        int numInRun = writeDatagramRun(next);
+
+        if (numInRun > 0) {
+            numWritten += numInRun;
+            next += numInRun;
+        } else {
+            // either batching isn't available or the kernel refused the first datagram of the run,
+            // go through QUdpSocket so that any error gets reported the same way unbatched sends report it
+            if (writeSingleDatagram(next)) {
+                ++numWritten;
+            }
+            ++next;
+        }
+    }
+
+    // resize instead of clear so the vectors keep their capacity for the next frame
+    _datagrams.resize(0);
+    _destinations.resize(0);
+
+    _numDatagramsSent += numWritten;
+    ++_numFlushes;
+    _numSendCallsLastFlush = _numSendCalls - numSendCallsBefore;
+    _isCollecting = false;
+
+    return numWritten;
+}
+
+int DatagramBatch::writeDatagramRun(int first) {
+#ifdef Q_OS_LINUX
+    mmsghdr messages[MAX_DATAGRAMS_PER_SEND];
+    iovec iovecs[MAX_DATAGRAMS_PER_SEND];
+    sockaddr_in addresses[MAX_DATAGRAMS_PER_SEND];
+
+    memset(messages, 0, sizeof(messages));
+    memset(addresses, 0, sizeof(addresses));
+
+    // our sockets are bound to IPv4, so a run ends at the first destination that isn't
+    int numInRun = 0;
+    while (numInRun < MAX_DATAGRAMS_PER_SEND && first + numInRun < _datagrams.size()
+           && _destinations[first + numInRun].getAddress().protocol() == QAbstractSocket::IPv4Protocol) {
+        const QByteArray& datagram = _datagrams[first + numInRun];
+        const HifiSockAddr& destination = _destinations[first + numInRun];
+
+        addresses[numInRun].sin_family = AF_INET;
+        addresses[numInRun].sin_addr.s_addr = htonl(destination.getAddress().toIPv4Address());
+        addresses[numInRun].sin_port = htons(destination.getPort());
+
+        iovecs[numInRun].iov_base = const_cast<char*>(datagram.constData());
+        iovecs[numInRun].iov_len = datagram.size();
+
+        messages[numInRun].msg_hdr.msg_name = &addresses[numInRun];
+        messages[numInRun].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        messages[numInRun].msg_hdr.msg_iov = &iovecs[numInRun];
+        messages[numInRun].msg_hdr.msg_iovlen = 1;
+
+        ++numInRun;
+    }
+
+    if (numInRun == 0) {
+        return 0;
+    }
+
+    ++_numSendCalls;
+    int numSent = sendmmsg(_socket.socketDescriptor(), messages, numInRun, 0);
+
+    return numSent > 0 ? numSent : 0;
+#else
+    return 0;
+#endif
+}
+
+bool DatagramBatch::writeSingleDatagram(int index) {
+    ++_numSendCalls;
+    qint64 bytesWritten = _socket.writeDatagram(_datagrams[index], _destinations[index].getAddress(),
+                                                _destinations[index].getPort());
+
+    if (bytesWritten < 0) {
+        qDebug() << "ERROR in writeDatagram:" << _socket.error() << "-" << _socket.errorString();
+        return false;
+    }
+
+    return true;
+}
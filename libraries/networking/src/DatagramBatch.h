@@ -0,0 +1,63 @@
+//
+//  DatagramBatch.h
+//  libraries/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_DatagramBatch_h
+#define hifi_DatagramBatch_h
+
+#include <QtCore/QVector>
+#include <QtNetwork/QUdpSocket>
+
+#include "HifiSockAddr.h"
+
+/// the number of datagrams handed to the kernel with one system call, where the platform supports it
+const int MAX_DATAGRAMS_PER_SEND = 64;
+
+/// Collects outgoing datagrams and writes them to a socket together, with a single sendmmsg call per
+/// MAX_DATAGRAMS_PER_SEND datagrams on Linux and one QUdpSocket::writeDatagram per datagram elsewhere.
+///
+/// The queued datagrams are implicitly shared copies, so callers are free to reuse their buffers right after queueing.
+class DatagramBatch {
+public:
+    DatagramBatch(QUdpSocket& socket);
+
+    /// starts collecting datagrams; until the next flush, queueDatagram is what callers should use
+    void begin() { _isCollecting = true; }
+    bool isCollecting() const { return _isCollecting; }
+
+    void queueDatagram(const QByteArray& datagram, const HifiSockAddr& destinationSockAddr);
+
+    /// writes everything that was queued and stops collecting, returns the number of datagrams written
+    int flush();
+
+    int getNumQueued() const { return _datagrams.size(); }
+
+    quint64 getNumDatagramsSent() const { return _numDatagramsSent; }
+    quint64 getNumSendCalls() const { return _numSendCalls; }
+    quint64 getNumFlushes() const { return _numFlushes; }
+    int getNumSendCallsLastFlush() const { return _numSendCallsLastFlush; }
+
+private:
+    /// hands as many of the queued datagrams starting at first to the kernel as it can in one call,
+    /// returns how many were written or zero if none were
+    int writeDatagramRun(int first);
+    bool writeSingleDatagram(int index);
+
+    QUdpSocket& _socket;
+    bool _isCollecting;
+    QVector<QByteArray> _datagrams;
+    QVector<HifiSockAddr> _destinations;
+    quint64 _numDatagramsSent;
+    quint64 _numSendCalls;
+    quint64 _numFlushes;
+    int _numSendCallsLastFlush;
+};
+
+#endif // hifi_DatagramBatch_h
@@ -65,11 +65,13 @@ LimitedNodeList::LimitedNodeList(unsigned short socketListenPort, unsigned short
     _sessionUUID(),
     _nodeHash(),
     _nodeHashMutex(QMutex::Recursive),
+    _nodeHashVersion(0),
     _nodeSocket(this),
     _dtlsSocket(NULL),
     _numCollectedPackets(0),
     _numCollectedBytes(0),
-    _packetStatTimer()
+    _packetStatTimer(),
+    _datagramBatches()
 {
     _nodeSocket.bind(QHostAddress::AnyIPv4, socketListenPort);
     qDebug() << "NodeList socket is listening on" << _nodeSocket.localPort();
@@ -207,6 +209,12 @@ qint64 LimitedNodeList::writeDatagram(const QByteArray& datagram, const HifiSock
     ++_numCollectedPackets;
     _numCollectedBytes += datagram.size();
     
+    if (_datagramBatches.hasLocalData() && _datagramBatches.localData()->isCollecting()) {
+        // this thread is batching, the datagram goes out with the rest of them in flushDatagramBatch
+        _datagramBatches.localData()->queueDatagram(datagramCopy, destinationSockAddr);
+        return datagramCopy.size();
+    }
+    
     qint64 bytesWritten = _nodeSocket.writeDatagram(datagramCopy,
                                                     destinationSockAddr.getAddress(), destinationSockAddr.getPort());
     
@@ -276,6 +284,27 @@ qint64 LimitedNodeList::writeUnverifiedDatagram(const char* data, qint64 size, c
     return writeUnverifiedDatagram(QByteArray(data, size), destinationNode, overridenSockAddr);
 }
 
+void LimitedNodeList::beginDatagramBatch() {
+    if (!_datagramBatches.hasLocalData()) {
+        // QThreadStorage deletes the batch when this thread finishes
+        _datagramBatches.setLocalData(new DatagramBatch(_nodeSocket));
+    }
+    
+    _datagramBatches.localData()->begin();
+}
+
+int LimitedNodeList::flushDatagramBatch() {
+    if (!_datagramBatches.hasLocalData()) {
+        return 0;
+    }
+    
+    return _datagramBatches.localData()->flush();
+}
+
+const DatagramBatch* LimitedNodeList::getDatagramBatch() {
+    return _datagramBatches.hasLocalData() ? _datagramBatches.localData() : NULL;
+}
+
 void LimitedNodeList::processNodeData(const HifiSockAddr& senderSockAddr, const QByteArray& packet) {
     // the node decided not to do anything with this packet
     // if it comes from a known source we should keep that node alive
@@ -367,6 +396,7 @@ void LimitedNodeList::killNodeWithUUID(const QUuid& nodeUUID) {
 NodeHash::iterator LimitedNodeList::killNodeAtHashIterator(NodeHash::iterator& nodeItemToKill) {
     qDebug() << "Killed" << *nodeItemToKill.value();
     emit nodeKilled(nodeItemToKill.value());
+    _nodeHashVersion.ref();
     return _nodeHash.erase(nodeItemToKill);
 }
 
@@ -389,6 +419,7 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
         SharedNodePointer newNodeSharedPointer(newNode, &QObject::deleteLater);
         
         _nodeHash.insert(newNode->getUUID(), newNodeSharedPointer);
+        _nodeHashVersion.ref();
         
         _nodeHashMutex.unlock();
         
@@ -19,14 +19,17 @@
 #include <unistd.h> // not on windows, not needed for mac or windows
 #endif
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QMutex>
 #include <QtCore/QSet>
 #include <QtCore/QSettings>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QThreadStorage>
 #include <QtNetwork/QHostAddress>
 #include <QtNetwork/QUdpSocket>
 
+#include "DatagramBatch.h"
 #include "DomainHandler.h"
 #include "Node.h"
 
@@ -44,6 +47,23 @@ class HifiSockAddr;
 
 typedef QSet<NodeType_t> NodeSet;
 
+// the domain-server either sends every interesting node (Full) or only the nodes that were added, changed
+// or removed since the domain list version the receiving node last acknowledged (Delta)
+typedef quint8 DomainListType_t;
+namespace DomainListType {
+    const DomainListType_t Full = 0;
+    const DomainListType_t Delta = 1;
+}
+
+typedef quint8 DomainListEntry_t;
+namespace DomainListEntry {
+    const DomainListEntry_t AddOrUpdate = 0;
+    const DomainListEntry_t Remove = 1;
+}
+
+// a domain list version of zero means the node has no usable list and needs a full one
+const quint32 NO_DOMAIN_LIST_VERSION = 0;
+
 typedef QSharedPointer<Node> SharedNodePointer;
 typedef QHash<QUuid, SharedNodePointer> NodeHash;
 Q_DECLARE_METATYPE(SharedNodePointer)
@@ -75,9 +95,21 @@ public:
     qint64 writeUnverifiedDatagram(const char* data, qint64 size, const SharedNodePointer& destinationNode,
                          const HifiSockAddr& overridenSockAddr = HifiSockAddr());
 
+    /// until the matching flushDatagramBatch, datagrams written from the calling thread are queued instead of sent,
+    /// so that a frame's worth of packets goes out with as few system calls as possible
+    void beginDatagramBatch();
+    /// sends the datagrams queued since beginDatagramBatch on the calling thread, returns the number sent
+    int flushDatagramBatch();
+    /// the calling thread's batch, or NULL if it has never started one
+    const DatagramBatch* getDatagramBatch();
+
     void(*linkedDataCreateCallback)(Node *);
 
     NodeHash getNodeHash();
+
+    /// changes whenever a node is added to or killed from the node hash, so that anything derived from it can be
+    /// rebuilt when it is out of date without taking the node hash lock to find out
+    int getNodeHashVersion() const { return _nodeHashVersion.load(); }
     int size() const { return _nodeHash.size(); }
 
     SharedNodePointer nodeWithUUID(const QUuid& nodeUUID, bool blockingLock = true);
@@ -128,11 +160,13 @@ protected:
     QUuid _sessionUUID;
     NodeHash _nodeHash;
     QMutex _nodeHashMutex;
+    QAtomicInt _nodeHashVersion;
     QUdpSocket _nodeSocket;
     QUdpSocket* _dtlsSocket;
     int _numCollectedPackets;
     int _numCollectedBytes;
     QElapsedTimer _packetStatTimer;
+    QThreadStorage<DatagramBatch*> _datagramBatches;
 };
 
 #endif // hifi_LimitedNodeList_h
@@ -56,6 +56,11 @@ NodeList::NodeList(char newOwnerType, unsigned short socketListenPort, unsigned
     _nodeTypesOfInterest(),
     _domainHandler(this),
     _numNoReplyDomainCheckIns(0),
+    _domainListVersion(NO_DOMAIN_LIST_VERSION),
+    _pendingDomainListVersion(NO_DOMAIN_LIST_VERSION),
+    _pendingDomainListType(DomainListType::Full),
+    _receivedDomainListPackets(),
+    _isApplyingDomainList(false),
     _assignmentServerSocket(),
     _publicSockAddr(),
     _hasCompletedInitialSTUNFailure(false),
@@ -66,6 +71,10 @@ NodeList::NodeList(char newOwnerType, unsigned short socketListenPort, unsigned
     
     // clear our NodeList when logout is requested
     connect(&AccountManager::getInstance(), &AccountManager::logoutComplete , this, &NodeList::reset);
+
+    // the domain-server only sends us the changes since our list version, so once we drop a node it still lists
+    // (because it went silent or we were told it was killed) we need the full list again to get it back
+    connect(this, &LimitedNodeList::nodeKilled, this, &NodeList::forgetDomainListVersion, Qt::DirectConnection);
 }
 
 qint64 NodeList::sendStatsToDomainServer(const QJsonObject& statsObject) {
@@ -174,6 +183,11 @@ void NodeList::reset() {
     
     _numNoReplyDomainCheckIns = 0;
 
+    // we'll need a full list from whatever domain-server we talk to next
+    _domainListVersion = NO_DOMAIN_LIST_VERSION;
+    _pendingDomainListVersion = NO_DOMAIN_LIST_VERSION;
+    _receivedDomainListPackets.clear();
+
     // refresh the owner UUID to the NULL UUID
     setSessionUUID(QUuid());
     
@@ -363,6 +377,9 @@ void NodeList::sendDomainServerCheckIn() {
         foreach (NodeType_t nodeTypeOfInterest, _nodeTypesOfInterest) {
             packetStream << nodeTypeOfInterest;
         }
+
+        // tell the domain-server which version of the list we have so it only sends us what changed since then
+        packetStream << _domainListVersion;
         
         if (!isUsingDTLS) {
             writeDatagram(domainServerPacket, _domainHandler.getSockAddr(), QUuid());
@@ -411,9 +428,27 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
     QUuid newUUID;
     packetStream >> newUUID;
     setSessionUUID(newUUID);
+
+    // followed by what kind of list this is, the version it brings us to and which part of that list this packet is
+    DomainListType_t listType;
+    quint32 listVersion;
+    quint16 packetIndex, numPackets;
+    packetStream >> listType >> listVersion >> packetIndex >> numPackets;
     
     // pull each node in the packet
     while(packetStream.device()->pos() < packet.size()) {
+        DomainListEntry_t entryType;
+        packetStream >> entryType;
+
+        if (entryType == DomainListEntry::Remove) {
+            // the domain-server has let this node go, so should we
+            packetStream >> nodeUUID;
+            _isApplyingDomainList = true;
+            killNodeWithUUID(nodeUUID);
+            _isApplyingDomainList = false;
+            continue;
+        }
+
         packetStream >> nodeType >> nodeUUID >> nodePublicSocket >> nodeLocalSocket;
 
         // if the public socket address is 0 then it's reachable at the same IP
@@ -426,6 +461,25 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
         
         packetStream >> connectionUUID;
         node->setConnectionSecret(connectionUUID);
+
+        ++readNodes;
+    }
+
+    // only acknowledge a new list version once every packet that makes it up has arrived - if one gets lost
+    // we keep asking relative to our old version and the domain-server resends what we missed
+    if (listVersion != _pendingDomainListVersion || listType != _pendingDomainListType) {
+        _pendingDomainListVersion = listVersion;
+        _pendingDomainListType = listType;
+        _receivedDomainListPackets.clear();
+    }
+
+    _receivedDomainListPackets.insert(packetIndex);
+
+    // a delta only means something on top of the list we had, so if we dropped a node locally while it was on its way
+    // we keep asking for the full list
+    if (_receivedDomainListPackets.size() >= numPackets
+        && (listType == DomainListType::Full || _domainListVersion != NO_DOMAIN_LIST_VERSION)) {
+        _domainListVersion = listVersion;
     }
     
     // ping inactive nodes in conjunction with receipt of list from domain-server
@@ -435,6 +489,14 @@ int NodeList::processDomainServerList(const QByteArray& packet) {
     return readNodes;
 }
 
+void NodeList::forgetDomainListVersion() {
+    if (!_isApplyingDomainList) {
+        _domainListVersion = NO_DOMAIN_LIST_VERSION;
+        _pendingDomainListVersion = NO_DOMAIN_LIST_VERSION;
+        _receivedDomainListPackets.clear();
+    }
+}
+
 void NodeList::sendAssignment(Assignment& assignment) {
     
     PacketType assignmentPacketType = assignment.getCommand() == Assignment::CreateCommand
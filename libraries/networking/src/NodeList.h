@@ -83,6 +83,8 @@ public slots:
     void pingInactiveNodes();
 signals:
     void limitOfSilentDomainCheckInsReached();
+private slots:
+    void forgetDomainListVersion();
 private:
     static NodeList* _sharedInstance;
 
@@ -101,6 +103,11 @@ private:
     NodeSet _nodeTypesOfInterest;
     DomainHandler _domainHandler;
     int _numNoReplyDomainCheckIns;
+    quint32 _domainListVersion;
+    quint32 _pendingDomainListVersion;
+    DomainListType_t _pendingDomainListType;
+    QSet<quint16> _receivedDomainListPackets;
+    bool _isApplyingDomainList;
     HifiSockAddr _assignmentServerSocket;
     HifiSockAddr _publicSockAddr;
     bool _hasCompletedInitialSTUNFailure;
@@ -0,0 +1,170 @@
+//
+//  PacketDispatcher.cpp
+//  libraries/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QtCore/QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+#include "LimitedNodeList.h"
+#include "PacketDispatcher.h"
+
+PacketDispatcher::PacketDispatcher(QUdpSocket& socket) :
+    _socket(socket),
+    _handlers(),
+    _verifiesPackets(true),
+    _bufferPool(new char[DATAGRAM_BATCH_SIZE * DATAGRAM_BUFFER_BYTES]),
+    _numPacketsReceived(0),
+    _numPacketsDropped(0),
+    _numBatches(0)
+{
+    _defaultHandler.handler = NULL;
+    _defaultHandler.needsOwnedCopy = false;
+}
+
+PacketDispatcher::~PacketDispatcher() {
+    foreach (const HandlerEntry& entry, _handlers) {
+        delete entry.handler;
+    }
+    delete _defaultHandler.handler;
+    delete[] _bufferPool;
+}
+
+void PacketDispatcher::registerHandler(PacketType type, PacketHandler* handler, bool needsOwnedCopy) {
+    // grow the table so it can be indexed by this type, with no handlers for the types in between
+    HandlerEntry emptyEntry = { NULL, false };
+    while (_handlers.size() <= type) {
+        _handlers.append(emptyEntry);
+    }
+
+    delete _handlers[type].handler;
+    _handlers[type].handler = handler;
+    _handlers[type].needsOwnedCopy = needsOwnedCopy;
+}
+
+void PacketDispatcher::setDefaultHandler(PacketHandler* handler, bool needsOwnedCopy) {
+    delete _defaultHandler.handler;
+    _defaultHandler.handler = handler;
+    _defaultHandler.needsOwnedCopy = needsOwnedCopy;
+}
+
+int PacketDispatcher::processPendingDatagrams() {
+    int numDatagramsRead = 0;
+
+    while (_socket.hasPendingDatagrams()) {
+        int numInBatch = readDatagramBatch();
+        if (numInBatch == 0) {
+            break;
+        }
+
+        for (int i = 0; i < numInBatch; i++) {
+            dispatchDatagram(_bufferPool + i * DATAGRAM_BUFFER_BYTES, _datagramSizes[i], _senderSockAddrs[i]);
+        }
+
+        numDatagramsRead += numInBatch;
+        ++_numBatches;
+    }
+
+    return numDatagramsRead;
+}
+
+int PacketDispatcher::readDatagramBatch() {
+    // the first datagram always goes through QUdpSocket, since reading is what re-enables its read notifier
+    qint64 bytesRead = _socket.readDatagram(_bufferPool, DATAGRAM_BUFFER_BYTES,
+                                            _senderSockAddrs[0].getAddressPointer(),
+                                            _senderSockAddrs[0].getPortPointer());
+    if (bytesRead < 0) {
+        return 0;
+    }
+    _datagramSizes[0] = bytesRead;
+
+    int numRead = 1;
+
+#ifdef Q_OS_LINUX
+    // pull whatever else is waiting with a single recvmmsg call
+    const int NUM_BATCHED_SLOTS = DATAGRAM_BATCH_SIZE - 1;
+
+    mmsghdr messages[NUM_BATCHED_SLOTS];
+    iovec iovecs[NUM_BATCHED_SLOTS];
+    sockaddr_storage addresses[NUM_BATCHED_SLOTS];
+
+    memset(messages, 0, sizeof(messages));
+
+    for (int i = 0; i < NUM_BATCHED_SLOTS; i++) {
+        iovecs[i].iov_base = _bufferPool + (i + 1) * DATAGRAM_BUFFER_BYTES;
+        iovecs[i].iov_len = DATAGRAM_BUFFER_BYTES;
+
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &addresses[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+
+    int numMessages = recvmmsg(_socket.socketDescriptor(), messages, NUM_BATCHED_SLOTS, MSG_DONTWAIT, NULL);
+
+    for (int i = 0; i < numMessages; i++) {
+        if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            // can't happen with buffers the size of the largest UDP payload, but we couldn't use what we got
+            qDebug() << "PacketDispatcher dropping truncated datagram of" << messages[i].msg_len << "bytes";
+            _datagramSizes[numRead] = 0;
+        } else {
+            _datagramSizes[numRead] = messages[i].msg_len;
+        }
+        _senderSockAddrs[numRead] = HifiSockAddr(reinterpret_cast<const sockaddr*>(&addresses[i]));
+        ++numRead;
+    }
+#else
+    while (numRead < DATAGRAM_BATCH_SIZE && _socket.hasPendingDatagrams()) {
+        bytesRead = _socket.readDatagram(_bufferPool + numRead * DATAGRAM_BUFFER_BYTES, DATAGRAM_BUFFER_BYTES,
+                                         _senderSockAddrs[numRead].getAddressPointer(),
+                                         _senderSockAddrs[numRead].getPortPointer());
+        if (bytesRead < 0) {
+            break;
+        }
+        _datagramSizes[numRead++] = bytesRead;
+    }
+#endif
+
+    return numRead;
+}
+
+void PacketDispatcher::dispatchDatagram(const char* data, int size, const HifiSockAddr& senderSockAddr) {
+    ++_numPacketsReceived;
+
+    if (size <= 0) {
+        ++_numPacketsDropped;
+        return;
+    }
+
+    // a view of the datagram, no copy is made
+    QByteArray packet = QByteArray::fromRawData(data, size);
+
+    if (_verifiesPackets && !LimitedNodeList::getInstance()->packetVersionAndHashMatch(packet)) {
+        ++_numPacketsDropped;
+        return;
+    }
+
+    PacketType type = packetTypeForPacket(data);
+    const HandlerEntry& entry = (type < _handlers.size() && _handlers[type].handler) ? _handlers[type] : _defaultHandler;
+
+    if (!entry.handler) {
+        ++_numPacketsDropped;
+        return;
+    }
+
+    if (entry.needsOwnedCopy) {
+        entry.handler->handlePacket(QByteArray(data, size), senderSockAddr);
+    } else {
+        entry.handler->handlePacket(packet, senderSockAddr);
+    }
+}
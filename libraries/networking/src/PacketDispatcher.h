@@ -0,0 +1,113 @@
+//
+//  PacketDispatcher.h
+//  libraries/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketDispatcher_h
+#define hifi_PacketDispatcher_h
+
+#include <QtCore/QVector>
+#include <QtNetwork/QUdpSocket>
+
+#include "HifiSockAddr.h"
+#include "PacketHeaders.h"
+
+/// the number of datagrams read from the socket with one system call, where the platform supports it
+const int DATAGRAM_BATCH_SIZE = 64;
+
+/// the size of each buffer in the pool - room for the largest UDP payload, since some packets (billboards, for example)
+/// go over the MTU and rely on IP fragmentation, and a batched read can't hand back a datagram it had to truncate.
+/// Only the pages a datagram is written to are committed, so the mostly small packets don't touch most of the pool.
+const int DATAGRAM_BUFFER_BYTES = 64 * 1024;
+
+/// Something that wants the packets of one or more types from a PacketDispatcher.
+class PacketHandler {
+public:
+    virtual ~PacketHandler() { }
+    virtual void handlePacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) = 0;
+};
+
+/// Forwards packets to a member function of an object.
+template<class T> class MethodPacketHandler : public PacketHandler {
+public:
+    typedef void (T::*HandlerMethod)(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+
+    MethodPacketHandler(T* object, HandlerMethod method) : _object(object), _method(method) { }
+
+    virtual void handlePacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+        (_object->*_method)(packet, senderSockAddr);
+    }
+
+private:
+    T* _object;
+    HandlerMethod _method;
+};
+
+/// Reads all pending datagrams from a socket in batches into a pool of reusable buffers, checks the version and hash
+/// of each packet once and hands it to the handler registered for its type through a table lookup.
+///
+/// The QByteArray a handler gets is a view into the buffer pool (see QByteArray::fromRawData) and is only valid for
+/// the duration of the call. Handlers that hold on to packets (by queueing them for another thread, for example) must
+/// be registered with needsOwnedCopy set, so they get a deep copy instead.
+class PacketDispatcher {
+public:
+    PacketDispatcher(QUdpSocket& socket);
+    ~PacketDispatcher();
+
+    /// registers the handler for a packet type, taking ownership of it
+    void registerHandler(PacketType type, PacketHandler* handler, bool needsOwnedCopy = false);
+
+    template<class T> void registerHandler(PacketType type, T* object,
+                                           typename MethodPacketHandler<T>::HandlerMethod method,
+                                           bool needsOwnedCopy = false) {
+        registerHandler(type, new MethodPacketHandler<T>(object, method), needsOwnedCopy);
+    }
+
+    /// sets the handler for all packet types without one of their own, taking ownership of it
+    void setDefaultHandler(PacketHandler* handler, bool needsOwnedCopy = false);
+
+    template<class T> void setDefaultHandler(T* object, typename MethodPacketHandler<T>::HandlerMethod method,
+                                             bool needsOwnedCopy = false) {
+        setDefaultHandler(new MethodPacketHandler<T>(object, method), needsOwnedCopy);
+    }
+
+    /// whether packets are checked with LimitedNodeList::packetVersionAndHashMatch before being dispatched (default on)
+    void setVerifiesPackets(bool verifiesPackets) { _verifiesPackets = verifiesPackets; }
+
+    /// reads and dispatches every datagram pending on the socket, returns the number of datagrams read
+    int processPendingDatagrams();
+
+    quint64 getNumPacketsReceived() const { return _numPacketsReceived; }
+    quint64 getNumPacketsDropped() const { return _numPacketsDropped; }
+    quint64 getNumBatches() const { return _numBatches; }
+
+private:
+    struct HandlerEntry {
+        PacketHandler* handler;
+        bool needsOwnedCopy;
+    };
+
+    int readDatagramBatch();
+    void dispatchDatagram(const char* data, int size, const HifiSockAddr& senderSockAddr);
+
+    QUdpSocket& _socket;
+    QVector<HandlerEntry> _handlers;
+    HandlerEntry _defaultHandler;
+    bool _verifiesPackets;
+
+    char* _bufferPool;
+    int _datagramSizes[DATAGRAM_BATCH_SIZE];
+    HifiSockAddr _senderSockAddrs[DATAGRAM_BATCH_SIZE];
+
+    quint64 _numPacketsReceived;
+    quint64 _numPacketsDropped;
+    quint64 _numBatches;
+};
+
+#endif // hifi_PacketDispatcher_h
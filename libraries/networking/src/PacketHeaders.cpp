@@ -50,8 +50,10 @@ PacketVersion versionForPacketType(PacketType type) {
         case PacketTypeMicrophoneAudioNoEcho:
         case PacketTypeMicrophoneAudioWithEcho:
         case PacketTypeSilentAudioFrame:
-            return 2;
+            return 3;
         case PacketTypeMixedAudio:
+            return 2;
+        case PacketTypeInjectAudio:
             return 1;
         case PacketTypeAvatarData:
             return 3;
@@ -61,7 +63,7 @@ PacketVersion versionForPacketType(PacketType type) {
             return 2;
         case PacketTypeDomainList:
         case PacketTypeDomainListRequest:
-            return 3;
+            return 4;
         case PacketTypeCreateAssignment:
         case PacketTypeRequestAssignment:
             return 2;
@@ -70,12 +72,14 @@ PacketVersion versionForPacketType(PacketType type) {
             return 1;
         case PacketTypeOctreeStats:
             return 1;
-        case PacketTypeParticleData:
+        case PacketTypeJurisdiction:
             return 1;
+        case PacketTypeParticleData:
+            return 2;
         case PacketTypeParticleErase:
             return 1;
         case PacketTypeModelData:
-            return 2;
+            return 3;
         case PacketTypeModelErase:
             return 1;
         case PacketTypeAudioStreamStats:
@@ -70,6 +70,8 @@ enum PacketType {
     PacketTypeVoxelEditNack,
     PacketTypeParticleEditNack,
     PacketTypeModelEditNack,
+    PacketTypeJurisdictionLoad,
+    PacketTypeSubtreeHandoff,
 };
 
 typedef char PacketVersion;
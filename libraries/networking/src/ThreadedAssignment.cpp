@@ -18,11 +18,16 @@
 
 ThreadedAssignment::ThreadedAssignment(const QByteArray& packet) :
     Assignment(packet),
-    _isFinished(false)
+    _isFinished(false),
+    _packetDispatcher(NULL)
 {
     
 }
 
+ThreadedAssignment::~ThreadedAssignment() {
+    delete _packetDispatcher;
+}
+
 void ThreadedAssignment::setFinished(bool isFinished) {
     _isFinished = isFinished;
 
@@ -96,3 +101,15 @@ bool ThreadedAssignment::readAvailableDatagram(QByteArray& destinationByteArray,
         return false;
     }
 }
+
+PacketDispatcher& ThreadedAssignment::getPacketDispatcher() {
+    if (!_packetDispatcher) {
+        _packetDispatcher = new PacketDispatcher(NodeList::getInstance()->getNodeSocket());
+        _packetDispatcher->setDefaultHandler(this, &ThreadedAssignment::processNodeListPacket);
+    }
+    return *_packetDispatcher;
+}
+
+void ThreadedAssignment::processNodeListPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    NodeList::getInstance()->processNodeData(senderSockAddr, packet);
+}
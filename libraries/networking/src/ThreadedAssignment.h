@@ -15,11 +15,13 @@
 #include <QtCore/QSharedPointer>
 
 #include "Assignment.h"
+#include "PacketDispatcher.h"
 
 class ThreadedAssignment : public Assignment {
     Q_OBJECT
 public:
     ThreadedAssignment(const QByteArray& packet);
+    virtual ~ThreadedAssignment();
     void setFinished(bool isFinished);
     virtual void aboutToFinish() { };
     void addPacketStatsAndSendStatsPacket(QJsonObject& statsObject);
@@ -33,7 +35,14 @@ public slots:
 protected:
     bool readAvailableDatagram(QByteArray& destinationByteArray, HifiSockAddr& senderSockAddr);
     void commonInit(const QString& targetName, NodeType_t nodeType, bool shouldSendStats = true);
+
+    /// the dispatcher for the NodeList socket, created on first use - packets of types without a registered handler
+    /// are passed to the NodeList
+    PacketDispatcher& getPacketDispatcher();
+    void processNodeListPacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+
     bool _isFinished;
+    PacketDispatcher* _packetDispatcher;
 private slots:
     void checkInWithDomainServerOrExit();
 signals:
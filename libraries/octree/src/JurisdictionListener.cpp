@@ -29,6 +29,7 @@ JurisdictionListener::JurisdictionListener(NodeType_t type) :
 void JurisdictionListener::nodeKilled(SharedNodePointer node) {
     if (_jurisdictions.find(node->getUUID()) != _jurisdictions.end()) {
         _jurisdictions.erase(_jurisdictions.find(node->getUUID()));
+        _jurisdictions.jurisdictionsChanged();
     }
 }
 
@@ -63,6 +64,7 @@ void JurisdictionListener::processPacket(const SharedNodePointer& sendingNode, c
         JurisdictionMap map;
         map.unpackFromMessage(reinterpret_cast<const unsigned char*>(packet.data()), packet.size());
         _jurisdictions[nodeUUID] = map;
+        _jurisdictions.jurisdictionsChanged();
     }
 }
 
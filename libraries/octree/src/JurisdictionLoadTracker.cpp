@@ -0,0 +1,186 @@
+//
+//  JurisdictionLoadTracker.cpp
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <OctalCode.h>
+#include <SharedUtil.h>
+
+#include "OctreeConstants.h"
+#include "JurisdictionLoadTracker.h"
+
+static QByteArray octalCodeBytes(const unsigned char* octalCode) {
+    return QByteArray(reinterpret_cast<const char*>(octalCode),
+                      bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(octalCode)));
+}
+
+JurisdictionLoadTracker::JurisdictionLoadTracker() :
+    _trackedCube(NULL),
+    _trackedCubes(),
+    _threadStripes(),
+    _nextStripe(0),
+    _resetUsecs(usecTimestampNow())
+{
+    setJurisdiction(NULL);
+}
+
+JurisdictionLoadTracker::~JurisdictionLoadTracker() {
+    qDeleteAll(_trackedCubes);
+}
+
+void JurisdictionLoadTracker::setJurisdiction(const JurisdictionMap* jurisdiction) {
+    unsigned char wholeTreeCode = 0;
+    const unsigned char* rootCode = (jurisdiction && jurisdiction->getRootOctalCode())
+        ? jurisdiction->getRootOctalCode() : &wholeTreeCode;
+
+    VoxelPositionSize rootDetails;
+    voxelDetailsForCode(rootCode, rootDetails);
+
+    TrackedCube* trackedCube = new TrackedCube();
+    trackedCube->corner = glm::vec3(rootDetails.x, rootDetails.y, rootDetails.z);
+    trackedCube->scale = rootDetails.s;
+    trackedCube->level = numberOfThreeBitSectionsInCode(rootCode) + LOAD_TRACKING_LEVELS;
+    _trackedCubes << trackedCube;
+    _trackedCube.storeRelease(trackedCube);
+
+    reset();
+}
+
+JurisdictionLoadTracker::LoadCounters& JurisdictionLoadTracker::countersForThisThread() {
+    if (!_threadStripes.hasLocalData()) {
+        _threadStripes.setLocalData(_nextStripe.fetchAndAddRelaxed(1) % LOAD_COUNTER_STRIPES);
+    }
+    return _counters[_threadStripes.localData()];
+}
+
+void JurisdictionLoadTracker::addLoad(const glm::vec3& position, float usecs) {
+    // clients outside the jurisdiction are counted where they are closest to it
+    const float ALMOST_ONE = 0.99999f;
+    const TrackedCube* trackedCube = _trackedCube.loadAcquire();
+    glm::vec3 cubePosition = glm::clamp((position / (float)TREE_SCALE - trackedCube->corner) / trackedCube->scale,
+                                        0.0f, ALMOST_ONE);
+    glm::ivec3 cell = glm::ivec3(cubePosition * (float)LOAD_TRACKING_CELLS_PER_AXIS);
+    int cellIndex = (cell.x * LOAD_TRACKING_CELLS_PER_AXIS + cell.y) * LOAD_TRACKING_CELLS_PER_AXIS + cell.z;
+
+    LoadCounters& counters = countersForThisThread();
+    counters.cellUsecs[cellIndex].fetchAndAddRelaxed((int)usecs);
+    counters.totalUsecs.fetchAndAddRelaxed((int)usecs);
+}
+
+void JurisdictionLoadTracker::reset() {
+    // load that is added while we're at it goes to either interval, which doesn't matter
+    for (int i = 0; i < LOAD_COUNTER_STRIPES; i++) {
+        for (int j = 0; j < LOAD_TRACKING_CELLS; j++) {
+            _counters[i].cellUsecs[j].store(0);
+        }
+        _counters[i].totalUsecs.store(0);
+    }
+    _resetUsecs = usecTimestampNow();
+}
+
+float JurisdictionLoadTracker::getLoad() const {
+    float totalLoad = 0.0f;
+    for (int i = 0; i < LOAD_COUNTER_STRIPES; i++) {
+        totalLoad += _counters[i].totalUsecs.load();
+    }
+    quint64 elapsed = usecTimestampNow() - _resetUsecs;
+    return elapsed > 0 ? totalLoad * USECS_PER_SECOND / elapsed : 0.0f;
+}
+
+QHash<QByteArray, float> JurisdictionLoadTracker::getSubtreeLoads() const {
+    QHash<QByteArray, float> subtreeLoads;
+    const TrackedCube* trackedCube = _trackedCube.loadAcquire();
+    float cellSize = trackedCube->scale / LOAD_TRACKING_CELLS_PER_AXIS;
+
+    for (int cellIndex = 0; cellIndex < LOAD_TRACKING_CELLS; cellIndex++) {
+        float cellLoad = 0.0f;
+        for (int i = 0; i < LOAD_COUNTER_STRIPES; i++) {
+            cellLoad += _counters[i].cellUsecs[cellIndex].load();
+        }
+        if (cellLoad <= 0.0f) {
+            continue;
+        }
+
+        glm::vec3 cell(cellIndex / (LOAD_TRACKING_CELLS_PER_AXIS * LOAD_TRACKING_CELLS_PER_AXIS),
+                       (cellIndex / LOAD_TRACKING_CELLS_PER_AXIS) % LOAD_TRACKING_CELLS_PER_AXIS,
+                       cellIndex % LOAD_TRACKING_CELLS_PER_AXIS);
+        glm::vec3 cellCenter = trackedCube->corner + (cell + glm::vec3(0.5f)) * cellSize;
+        unsigned char* cellCode = pointToVoxel(cellCenter.x, cellCenter.y, cellCenter.z, cellSize);
+        subtreeLoads[octalCodeBytes(cellCode)] += cellLoad;
+        delete[] cellCode;
+    }
+    return subtreeLoads;
+}
+
+float JurisdictionLoadTracker::getSubtreeLoad(const QHash<QByteArray, float>& subtreeLoads,
+                                              const unsigned char* subtreeCode, const JurisdictionMap* jurisdiction) {
+    float load = 0.0f;
+    QHash<QByteArray, float>::const_iterator subtree = subtreeLoads.constBegin();
+    for (; subtree != subtreeLoads.constEnd(); subtree++) {
+        const unsigned char* code = reinterpret_cast<const unsigned char*>(subtree.key().constData());
+        if (isAncestorOf(subtreeCode, code)
+                && (!jurisdiction || jurisdiction->isMyJurisdiction(code, CHECK_NODE_ONLY) == JurisdictionMap::WITHIN)) {
+            load += subtree.value();
+        }
+    }
+    return load;
+}
+
+QByteArray JurisdictionLoadTracker::chooseSubtreeToHandOff(const JurisdictionMap* jurisdiction, float& subtreeLoad) const {
+    subtreeLoad = 0.0f;
+    if (jurisdiction && jurisdiction->isEmpty()) {
+        return QByteArray();
+    }
+
+    unsigned char wholeTreeCode = 0;
+    const unsigned char* rootCode = (jurisdiction && jurisdiction->getRootOctalCode())
+        ? jurisdiction->getRootOctalCode() : &wholeTreeCode;
+
+    // only work within the jurisdiction can be handed off
+    QHash<QByteArray, float> subtreeLoads = getSubtreeLoads();
+    float jurisdictionLoad = getSubtreeLoad(subtreeLoads, rootCode, jurisdiction);
+
+    QByteArray parentCode = octalCodeBytes(rootCode);
+    QByteArray chosenCode;
+    int rootLevel = numberOfThreeBitSectionsInCode(rootCode);
+    int trackingLevel = _trackedCube.loadAcquire()->level;
+
+    for (int level = rootLevel + 1; level <= trackingLevel; level++) {
+        QByteArray busiestCode;
+        float busiestLoad = 0.0f;
+
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            unsigned char* childCode = childOctalCode(reinterpret_cast<const unsigned char*>(parentCode.constData()), i);
+            if (!jurisdiction || jurisdiction->isMyJurisdiction(childCode, CHECK_NODE_ONLY) == JurisdictionMap::WITHIN) {
+                float childLoad = getSubtreeLoad(subtreeLoads, childCode, jurisdiction);
+                if (childLoad > busiestLoad) {
+                    busiestLoad = childLoad;
+                    busiestCode = octalCodeBytes(childCode);
+                }
+            }
+            delete[] childCode;
+        }
+
+        if (busiestLoad <= 0.0f) {
+            break;
+        }
+        chosenCode = busiestCode;
+        subtreeLoad = busiestLoad;
+
+        if (busiestLoad <= MAX_HANDOFF_LOAD_SHARE * jurisdictionLoad) {
+            break;
+        }
+        parentCode = busiestCode;
+    }
+
+    // report the load of the chosen subtree per second, like getLoad()
+    quint64 elapsed = usecTimestampNow() - _resetUsecs;
+    subtreeLoad = elapsed > 0 ? subtreeLoad * USECS_PER_SECOND / elapsed : 0.0f;
+    return chosenCode;
+}
@@ -0,0 +1,99 @@
+//
+//  JurisdictionLoadTracker.h
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JurisdictionLoadTracker_h
+#define hifi_JurisdictionLoadTracker_h
+
+#include <glm/glm.hpp>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QThreadStorage>
+
+#include "JurisdictionMap.h"
+
+/// how many levels below the jurisdiction root the load is kept track of, at most 8^3 subtrees
+const int LOAD_TRACKING_LEVELS = 3;
+const int LOAD_TRACKING_CELLS_PER_AXIS = 1 << LOAD_TRACKING_LEVELS;
+const int LOAD_TRACKING_CELLS = LOAD_TRACKING_CELLS_PER_AXIS * LOAD_TRACKING_CELLS_PER_AXIS * LOAD_TRACKING_CELLS_PER_AXIS;
+
+/// the threads adding load are spread over this many sets of counters
+const int LOAD_COUNTER_STRIPES = 8;
+
+/// a subtree with more than this share of the load is split further before it is handed off, if it can be
+const float MAX_HANDOFF_LOAD_SHARE = 0.75f;
+
+/// Keeps track of where an octree server's work goes, by the subtree of its jurisdiction that the client the work
+/// was done for is in. Picks the part of the jurisdiction to hand to another server when there is too much work.
+///
+/// Load can be added from any thread. It is added once per encode, so it goes to counters of the adding thread's own,
+/// without allocating or locking. The other methods are called from the thread that owns the tracker.
+class JurisdictionLoadTracker {
+public:
+    JurisdictionLoadTracker();
+    ~JurisdictionLoadTracker();
+
+    /// starts over for a new jurisdiction, NULL meaning the whole tree
+    void setJurisdiction(const JurisdictionMap* jurisdiction);
+
+    /// adds work done for a client at the given position, in meters
+    void addLoad(const glm::vec3& position, float usecs);
+
+    /// forgets the load added so far, to start a new measuring interval
+    void reset();
+
+    /// the work added since the last reset, in usecs per second
+    float getLoad() const;
+
+    /// Picks the subtree of the jurisdiction to hand off: the busiest child of the root, or if that has more than
+    /// MAX_HANDOFF_LOAD_SHARE of the load, the busiest of its children, and so on. Subtrees at or below an end node
+    /// are never picked. Returns the octal code, or an empty array if there is no work that can be handed off.
+    QByteArray chooseSubtreeToHandOff(const JurisdictionMap* jurisdiction, float& subtreeLoad) const;
+
+private:
+    /// the cube the load is tracked in, in tree units: the root of the jurisdiction
+    class TrackedCube {
+    public:
+        glm::vec3 corner;
+        float scale;
+        int level;
+    };
+
+    /// the load added by the threads of one stripe, in usecs
+    class LoadCounters {
+    public:
+        QAtomicInt cellUsecs[LOAD_TRACKING_CELLS];
+        QAtomicInt totalUsecs;
+    };
+
+    LoadCounters& countersForThisThread();
+
+    /// the load of each tracked subtree with any, by octal code
+    QHash<QByteArray, float> getSubtreeLoads() const;
+
+    static float getSubtreeLoad(const QHash<QByteArray, float>& subtreeLoads, const unsigned char* subtreeCode,
+                                const JurisdictionMap* jurisdiction);
+
+    // a cube is never changed once it's in use, the ones that were replaced are kept until we're gone since another
+    // thread might still be adding load in them
+    QAtomicPointer<const TrackedCube> _trackedCube;
+    QList<TrackedCube*> _trackedCubes;
+
+    LoadCounters _counters[LOAD_COUNTER_STRIPES];
+    QThreadStorage<int> _threadStripes;
+    QAtomicInt _nextStripe;
+    quint64 _resetUsecs;
+};
+
+#endif // hifi_JurisdictionLoadTracker_h
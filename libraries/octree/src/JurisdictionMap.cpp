@@ -208,6 +208,35 @@ JurisdictionMap::Area JurisdictionMap::isMyJurisdiction(const unsigned char* nod
 }
 
 
+bool JurisdictionMap::isEmpty() const {
+    if (!_rootOctalCode) {
+        return true;
+    }
+    for (size_t i = 0; i < _endNodes.size(); i++) {
+        if (isAncestorOf(_endNodes[i], _rootOctalCode)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void JurisdictionMap::addEndNode(const unsigned char* endNodeOctalCode) {
+    std::vector<unsigned char*>::iterator endNode = _endNodes.begin();
+    while (endNode != _endNodes.end()) {
+        if (isAncestorOf(endNodeOctalCode, *endNode)) {
+            delete[] *endNode;
+            endNode = _endNodes.erase(endNode);
+        } else {
+            ++endNode;
+        }
+    }
+
+    size_t bytes = bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(endNodeOctalCode));
+    unsigned char* endNodeCode = new unsigned char[bytes];
+    memcpy(endNodeCode, endNodeOctalCode, bytes);
+    _endNodes.push_back(endNodeCode);
+}
+
 bool JurisdictionMap::readFromFile(const char* filename) {
     QString     settingsFile(filename);
     QSettings   settings(settingsFile, QSettings::IniFormat);
@@ -254,7 +283,9 @@ bool JurisdictionMap::writeToFile(const char* filename) {
     QString rootNodeValue = octalCodeToHexString(_rootOctalCode);
 
     settings.setValue("root", rootNodeValue);
-    
+
+    // end nodes from an earlier write would otherwise stay, when there are fewer of them now
+    settings.remove("endNodes");
     settings.beginGroup("endNodes");
     for (size_t i = 0; i < _endNodes.size(); i++) {
         QString key = QString("endnode%1").arg(i);
@@ -262,7 +293,8 @@ bool JurisdictionMap::writeToFile(const char* filename) {
         settings.setValue(key, value);
     }
     settings.endGroup();
-    return true;
+    settings.sync();
+    return settings.status() == QSettings::NoError;
 }
 
 int JurisdictionMap::packEmptyJurisdictionIntoMessage(NodeType_t type, unsigned char* destinationBuffer, int availableBytes) {
@@ -296,7 +328,7 @@ int JurisdictionMap::packIntoMessage(unsigned char* destinationBuffer, int avail
 
     // add the root jurisdiction
     if (_rootOctalCode) {
-        size_t bytes = bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(_rootOctalCode));
+        int bytes = bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(_rootOctalCode));
         memcpy(destinationBuffer, &bytes, sizeof(bytes));
         destinationBuffer += sizeof(bytes);
         memcpy(destinationBuffer, _rootOctalCode, bytes);
@@ -309,7 +341,7 @@ int JurisdictionMap::packIntoMessage(unsigned char* destinationBuffer, int avail
 
         for (int i=0; i < endNodeCount; i++) {
             unsigned char* endNodeCode = _endNodes[i];
-            size_t bytes = 0;
+            int bytes = 0;
             if (endNodeCode) {
                 bytes = bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(endNodeCode));
             }
@@ -335,7 +367,12 @@ int JurisdictionMap::unpackFromMessage(const unsigned char* sourceBuffer, int av
     int numBytesPacketHeader = numBytesForPacketHeader(reinterpret_cast<const char*>(sourceBuffer));
     sourceBuffer += numBytesPacketHeader;
     int remainingBytes = availableBytes - numBytesPacketHeader;
-    
+
+    // the node type comes first
+    memcpy(&_nodeType, sourceBuffer, sizeof(_nodeType));
+    sourceBuffer += sizeof(_nodeType);
+    remainingBytes -= sizeof(_nodeType);
+
     // read the root jurisdiction
     int bytes = 0;
     memcpy(&bytes, sourceBuffer, sizeof(bytes));
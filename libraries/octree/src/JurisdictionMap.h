@@ -16,6 +16,7 @@
 #include <stdint.h>
 #include <vector>
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QString>
 #include <QtCore/QUuid>
 #include <QReadWriteLock>
@@ -51,6 +52,14 @@ public:
 
     Area isMyJurisdiction(const unsigned char* nodeOctalCode, int childIndex) const;
 
+    /// true when nothing is WITHIN this jurisdiction, like the jurisdiction of a server that is standing by to take over
+    /// part of another server's jurisdiction
+    bool isEmpty() const;
+
+    /// stops this jurisdiction at the given octal code, which gets copied. End nodes below it are no longer needed
+    /// and are removed.
+    void addEndNode(const unsigned char* endNodeOctalCode);
+
     bool writeToFile(const char* filename);
     bool readFromFile(const char* filename);
 
@@ -83,7 +92,17 @@ private:
 
 /// Map between node IDs and their reported JurisdictionMap. Typically used by classes that need to know which nodes are 
 /// managing which jurisdictions.
-class NodeToJurisdictionMap : public QMap<QUuid, JurisdictionMap>, public QReadWriteLock {};
+class NodeToJurisdictionMap : public QMap<QUuid, JurisdictionMap>, public QReadWriteLock {
+public:
+    /// call after changing the map, while still holding the write lock, so anything derived from it gets rebuilt
+    void jurisdictionsChanged() { _version.ref(); }
+
+    /// changes every time jurisdictionsChanged() is called, can be read without holding the lock
+    int getVersion() const { return _version.load(); }
+
+private:
+    QAtomicInt _version;
+};
 typedef QMap<QUuid, JurisdictionMap>::iterator NodeToJurisdictionMapIterator;
 
 
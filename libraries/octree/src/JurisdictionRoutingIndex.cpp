@@ -0,0 +1,116 @@
+//
+//  JurisdictionRoutingIndex.cpp
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <OctalCode.h>
+
+#include "JurisdictionRoutingIndex.h"
+
+JurisdictionRoutingIndex::TrieNode::TrieNode() :
+    rootServers(),
+    endServers()
+{
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        children[i] = 0;
+    }
+}
+
+JurisdictionRoutingIndex::JurisdictionRoutingIndex() :
+    _nodes(),
+    _unrestrictedServers()
+{
+    clear();
+}
+
+void JurisdictionRoutingIndex::clear() {
+    _nodes.clear();
+    _nodes.append(TrieNode()); // the empty octal code, which everything is below
+    _unrestrictedServers.clear();
+}
+
+int JurisdictionRoutingIndex::nodeForCode(const unsigned char* octalCode) {
+    int length = numberOfThreeBitSectionsInCode(octalCode);
+    if (length < 0) {
+        return -1;
+    }
+
+    int node = 0;
+    for (int section = 0; section < length; section++) {
+        int childIndex = getOctalCodeSectionValue(octalCode, section);
+        int child = _nodes[node].children[childIndex];
+        if (!child) {
+            child = _nodes.size();
+            _nodes.append(TrieNode());
+            _nodes[node].children[childIndex] = child;
+        }
+        node = child;
+    }
+    return node;
+}
+
+void JurisdictionRoutingIndex::addJurisdiction(int server, const JurisdictionMap& map) {
+    // a map without a root, like one that failed to unpack, has nothing within it
+    int rootNode = map.getRootOctalCode() ? nodeForCode(map.getRootOctalCode()) : -1;
+    if (rootNode < 0) {
+        return;
+    }
+    _nodes[rootNode].rootServers.append(server);
+
+    for (int i = 0; i < map.getEndNodeCount(); i++) {
+        if (map.getEndNodeOctalCode(i)) {
+            int endNode = nodeForCode(map.getEndNodeOctalCode(i));
+            if (endNode >= 0) {
+                _nodes[endNode].endServers.append(server);
+            }
+        }
+    }
+}
+
+void JurisdictionRoutingIndex::findServers(const unsigned char* octalCode, RoutedServers& servers) const {
+    for (int i = 0; i < _unrestrictedServers.size(); i++) {
+        servers.append(_unrestrictedServers[i]);
+    }
+
+    int length = numberOfThreeBitSectionsInCode(octalCode);
+    if (length < 0) {
+        return;
+    }
+
+    // Walk down the code. A code is within a jurisdiction when the jurisdiction's root is a strict prefix of it
+    // (an equal or shorter code is ABOVE the root) and none of its end nodes is a prefix of it or equal to it.
+    RoutedServers entered;
+    RoutedServers stopped;
+    int node = 0;
+    for (int section = 0; ; section++) {
+        const TrieNode& trieNode = _nodes[node];
+        if (section < length) {
+            entered.append(trieNode.rootServers.constData(), trieNode.rootServers.size());
+        }
+        stopped.append(trieNode.endServers.constData(), trieNode.endServers.size());
+
+        if (section == length) {
+            break;
+        }
+        node = trieNode.children[(int)getOctalCodeSectionValue(octalCode, section)];
+        if (!node) {
+            break;
+        }
+    }
+
+    for (int i = 0; i < entered.size(); i++) {
+        bool isStopped = false;
+        for (int j = 0; j < stopped.size() && !isStopped; j++) {
+            isStopped = (stopped[j] == entered[i]);
+        }
+        if (!isStopped) {
+            servers.append(entered[i]);
+        }
+    }
+}
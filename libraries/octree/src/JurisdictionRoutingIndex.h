@@ -0,0 +1,63 @@
+//
+//  JurisdictionRoutingIndex.h
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JurisdictionRoutingIndex_h
+#define hifi_JurisdictionRoutingIndex_h
+
+#include <QtCore/QVarLengthArray>
+#include <QtCore/QVector>
+
+#include "JurisdictionMap.h"
+#include "OctreeConstants.h"
+
+/// the number of servers an edit can be routed to before JurisdictionRoutingIndex::findServers() allocates
+const int EXPECTED_ROUTED_SERVERS = 8;
+
+typedef QVarLengthArray<int, EXPECTED_ROUTED_SERVERS> RoutedServers;
+
+/// A prefix trie over the root and end node octal codes of a set of server jurisdictions. It finds the servers an edit
+/// belongs to by walking the edit's octal code once, instead of asking every JurisdictionMap in turn.
+///
+/// Servers are identified by the index the caller adds them with. The index is not thread safe to build, but finding
+/// servers only reads it.
+class JurisdictionRoutingIndex {
+public:
+    JurisdictionRoutingIndex();
+
+    void clear();
+
+    /// routes to server whatever JurisdictionMap::isMyJurisdiction() says is WITHIN the given jurisdiction
+    void addJurisdiction(int server, const JurisdictionMap& map);
+
+    /// routes every edit to server, for when there are no jurisdictions to go by
+    void addUnrestrictedServer(int server) { _unrestrictedServers.append(server); }
+
+    /// appends to servers every server whose jurisdiction the octal code falls within
+    void findServers(const unsigned char* octalCode, RoutedServers& servers) const;
+
+private:
+    class TrieNode {
+    public:
+        TrieNode();
+
+        int children[NUMBER_OF_CHILDREN];   // index into _nodes, zero (the root) means there is no such child
+        QVector<int> rootServers;           // servers whose jurisdiction starts below this octal code
+        QVector<int> endServers;            // servers whose jurisdiction stops at this octal code
+    };
+
+    /// finds or adds the trie node for an octal code, returns -1 if the code is malformed
+    int nodeForCode(const unsigned char* octalCode);
+
+    QVector<TrieNode> _nodes;
+    QVector<int> _unrestrictedServers;
+};
+
+#endif // hifi_JurisdictionRoutingIndex_h
@@ -34,11 +34,24 @@ void JurisdictionSender::processPacket(const SharedNodePointer& sendingNode, con
         if (sendingNode) {
             lockRequestingNodes();
             _nodesRequestingJurisdictions.push(sendingNode->getUUID());
+            _nodesListeningToJurisdictions.insert(sendingNode->getUUID());
             unlockRequestingNodes();
         }
     }
 }
 
+void JurisdictionSender::publishJurisdiction(JurisdictionMap* map) {
+    lockRequestingNodes();
+    _jurisdictionMap = map;
+    foreach (const QUuid& nodeUUID, _nodesListeningToJurisdictions) {
+        _nodesRequestingJurisdictions.push(nodeUUID);
+    }
+    unlockRequestingNodes();
+
+    // wake our processing thread, it only sends when it has been woken up
+    _hasPackets.wakeAll();
+}
+
 bool JurisdictionSender::process() {
     bool continueProcessing = isStillRunning();
 
@@ -49,14 +62,15 @@ bool JurisdictionSender::process() {
         unsigned char* bufferOut = &buffer[0];
         ssize_t sizeOut = 0;
 
+        int nodeCount = 0;
+
+        lockRequestingNodes();
         if (_jurisdictionMap) {
             sizeOut = _jurisdictionMap->packIntoMessage(bufferOut, MAX_PACKET_SIZE);
         } else {
             sizeOut = JurisdictionMap::packEmptyJurisdictionIntoMessage(getNodeType(), bufferOut, MAX_PACKET_SIZE);
         }
-        int nodeCount = 0;
 
-        lockRequestingNodes();
         while (!_nodesRequestingJurisdictions.empty()) {
 
             QUuid nodeUUID = _nodesRequestingJurisdictions.front();
@@ -66,6 +80,8 @@ bool JurisdictionSender::process() {
             if (node && node->getActiveSocket()) {
                 _packetSender.queuePacketForSending(node, QByteArray(reinterpret_cast<char *>(bufferOut), sizeOut));
                 nodeCount++;
+            } else if (!node) {
+                _nodesListeningToJurisdictions.remove(nodeUUID);
             }
         }
         unlockRequestingNodes();
@@ -14,6 +14,7 @@
 
 #include <queue>
 #include <QMutex>
+#include <QSet>
 
 #include <PacketSender.h>
 #include <ReceivedPacketProcessor.h>
@@ -32,6 +33,10 @@ public:
 
     void setJurisdiction(JurisdictionMap* map) { _jurisdictionMap = map; }
 
+    /// switches to a new jurisdiction and sends it to every node that has asked for our jurisdiction before, instead
+    /// of waiting for them to ask again
+    void publishJurisdiction(JurisdictionMap* map);
+
     virtual bool process();
 
     NodeType_t getNodeType() const { return _nodeType; }
@@ -51,6 +56,7 @@ private:
     QMutex _requestingNodeMutex;
     JurisdictionMap* _jurisdictionMap;
     std::queue<QUuid> _nodesRequestingJurisdictions;
+    QSet<QUuid> _nodesListeningToJurisdictions;
     NodeType_t _nodeType;
     
     PacketSender _packetSender;
@@ -593,6 +593,7 @@ class RayArgs {
 public:
     glm::vec3 origin;
     glm::vec3 direction;
+    glm::vec3 inverseDirection;
     OctreeElement*& element;
     float& distance;
     BoxFace& face;
@@ -600,20 +601,97 @@ public:
     bool found;
 };
 
-bool findRayIntersectionOp(OctreeElement* element, void* extraData) {
-    RayArgs* args = static_cast<RayArgs*>(extraData);
+// the slab test grows cubes by this fraction of their size (and at least the minimum, in tree units) so that rounding
+// never makes it reject a cube that AACube::findRayIntersection() would have hit
+const float RAY_SLAB_EXPANSION = 1.0e-4f;
+const float MIN_RAY_SLAB_EXPANSION = 1.0e-6f;
+
+static glm::vec3 inverseRayDirection(const glm::vec3& direction) {
+    // axes the ray is parallel to get a huge but finite inverse, so the slab test never multiplies zero by infinity
+    glm::vec3 inverse;
+    for (int i = 0; i < 3; i++) {
+        inverse[i] = 1.0f / (fabsf(direction[i]) > FLT_MIN ? direction[i] : (direction[i] < 0.0f ? -FLT_MIN : FLT_MIN));
+    }
+    return inverse;
+}
+
+// a quick, conservative ray vs cube slab test - gives where the ray enters the cube, for front-to-back ordering
+static bool rayEntersCube(const RayArgs& args, const AACube& cube, float& entryDistance) {
+    float expansion = glm::max(cube.getScale() * RAY_SLAB_EXPANSION, MIN_RAY_SLAB_EXPANSION);
+    glm::vec3 minimum = cube.getCorner() - glm::vec3(expansion);
+    glm::vec3 maximum = cube.getCorner() + glm::vec3(cube.getScale() + expansion);
+
+    glm::vec3 nearPlanes = (minimum - args.origin) * args.inverseDirection;
+    glm::vec3 farPlanes = (maximum - args.origin) * args.inverseDirection;
+    glm::vec3 entries = glm::min(nearPlanes, farPlanes);
+    glm::vec3 exits = glm::max(nearPlanes, farPlanes);
+
+    entryDistance = glm::max(glm::max(entries.x, entries.y), glm::max(entries.z, 0.0f));
+    return entryDistance <= glm::min(glm::min(exits.x, exits.y), exits.z);
+}
+
+// whether nothing in this cube could replace the hit we already have: the element test only takes hits closer than
+// the current one, and no cube inside this one is entered before it - unless the ray starts inside, in which case
+// AACube reports the distance to where the ray leaves, and that can be smaller for the cubes within
+static bool isCubeBehindHit(const RayArgs& args, const AACube& cube) {
+    if (cube.contains(args.origin)) {
+        return false;
+    }
+    float distance;
+    BoxFace face;
+    return cube.findRayIntersection(args.origin, args.direction, distance, face) && distance * TREE_SCALE >= args.distance;
+}
+
+// visits the elements the ray passes through front-to-back, skipping everything behind the closest hit found so far
+static void findRayIntersectionInElement(OctreeElement* element, RayArgs& args, int recursionCount = 0) {
+    if (recursionCount > DANGEROUSLY_DEEP_RECURSION) {
+        qDebug() << "findRayIntersectionInElement() reached DANGEROUSLY_DEEP_RECURSION, bailing!";
+        return;
+    }
+
     bool keepSearching = true;
-    if (element->findRayIntersection(args->origin, args->direction, keepSearching, 
-                            args->element, args->distance, args->face, args->intersectedObject)) {
-        args->found = true;
+    if (element->findRayIntersection(args.origin, args.direction, keepSearching,
+                                     args.element, args.distance, args.face, args.intersectedObject)) {
+        args.found = true;
+    }
+    if (!keepSearching) {
+        return;
+    }
+
+    // sort the children the ray passes through by where it enters them - since they don't overlap, that's the order
+    // the ray passes through them in
+    OctreeElement* children[NUMBER_OF_CHILDREN];
+    float entryDistances[NUMBER_OF_CHILDREN];
+    int numChildren = 0;
+
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        OctreeElement* child = element->getChildAtIndex(i);
+        float entryDistance;
+        if (child && rayEntersCube(args, child->getAACube(), entryDistance)) {
+            int insertAt = numChildren++;
+            while (insertAt > 0 && entryDistances[insertAt - 1] > entryDistance) {
+                children[insertAt] = children[insertAt - 1];
+                entryDistances[insertAt] = entryDistances[insertAt - 1];
+                insertAt--;
+            }
+            children[insertAt] = child;
+            entryDistances[insertAt] = entryDistance;
+        }
+    }
+
+    for (int i = 0; i < numChildren; i++) {
+        if (args.found && isCubeBehindHit(args, children[i]->getAACube())) {
+            continue;
+        }
+        findRayIntersectionInElement(children[i], args, recursionCount + 1);
     }
-    return keepSearching;
 }
 
 bool Octree::findRayIntersection(const glm::vec3& origin, const glm::vec3& direction,
                                     OctreeElement*& element, float& distance, BoxFace& face, void** intersectedObject,
                                     Octree::lockType lockType, bool* accurateResult) {
-    RayArgs args = { origin / (float)(TREE_SCALE), direction, element, distance, face, intersectedObject, false};
+    RayArgs args = { origin / (float)(TREE_SCALE), direction, inverseRayDirection(direction),
+                     element, distance, face, intersectedObject, false };
     distance = FLT_MAX;
 
     bool gotLock = false;
@@ -630,7 +708,7 @@ bool Octree::findRayIntersection(const glm::vec3& origin, const glm::vec3& direc
         }
     }
 
-    recurseTreeWithOperation(findRayIntersectionOp, &args);
+    findRayIntersectionInElement(_rootElement, args);
 
     if (gotLock) {
         unlock();
@@ -642,6 +720,48 @@ bool Octree::findRayIntersection(const glm::vec3& origin, const glm::vec3& direc
     return args.found;
 }
 
+int Octree::findRayIntersections(QVector<OctreeRayQuery>& rays, Octree::lockType lockType, bool* accurateResult) {
+    bool gotLock = false;
+    if (lockType == Octree::Lock) {
+        lockForRead();
+        gotLock = true;
+    } else if (lockType == Octree::TryLock) {
+        gotLock = tryLockForRead();
+        if (!gotLock) {
+            if (accurateResult) {
+                *accurateResult = false;
+            }
+            return 0;
+        }
+    }
+
+    int numIntersected = 0;
+    for (int i = 0; i < rays.size(); i++) {
+        OctreeRayQuery& ray = rays[i];
+        ray.element = NULL;
+        ray.intersectedObject = NULL;
+        ray.distance = FLT_MAX;
+
+        RayArgs args = { ray.origin / (float)(TREE_SCALE), ray.direction, inverseRayDirection(ray.direction),
+                         ray.element, ray.distance, ray.face, &ray.intersectedObject, false };
+        findRayIntersectionInElement(_rootElement, args);
+
+        ray.intersects = args.found;
+        if (args.found) {
+            numIntersected++;
+        }
+    }
+
+    if (gotLock) {
+        unlock();
+    }
+
+    if (accurateResult) {
+        *accurateResult = true;
+    }
+    return numIntersected;
+}
+
 class SphereArgs {
 public:
     glm::vec3 center;
@@ -987,7 +1107,8 @@ int Octree::encodeTreeBitstream(OctreeElement* element,
 int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
                                             OctreePacketData* packetData, OctreeElementBag& bag,
                                             EncodeBitstreamParams& params, int& currentEncodeLevel,
-                                            const ViewFrustum::location& parentLocationThisView) const {
+                                            const ViewFrustum::location& parentLocationThisView,
+                                            const ViewFrustum::location* locationThisView) const {
     // How many bytes have we written so far at this level;
     int bytesAtThisLevel = 0;
 
@@ -1040,7 +1161,7 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
         // if we are INSIDE, INTERSECT, or OUTSIDE
         if (parentLocationThisView != ViewFrustum::INSIDE) {
             assert(parentLocationThisView != ViewFrustum::OUTSIDE); // we shouldn't be here if our parent was OUTSIDE!
-            nodeLocationThisView = element->inFrustum(*params.viewFrustum);
+            nodeLocationThisView = locationThisView ? *locationThisView : element->inFrustum(*params.viewFrustum);
         }
 
         // If we're at a element that is out of view, then we can return, because no nodes below us will be in view!
@@ -1194,6 +1315,12 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
         }
     }
 
+    // if this element intersects the view, test all of its children against the view in one batch
+    ViewFrustum::LocationMasks childrenLocationsThisView = { 0, 0, 0 };
+    if (params.viewFrustum && nodeLocationThisView == ViewFrustum::INTERSECT) {
+        childrenLocationsThisView = element->childrenInFrustum(*params.viewFrustum);
+    }
+
     // for each child element in Distance sorted order..., check to see if they exist, are colored, and in view, and if so
     // add them to our distance ordered array of children
     for (int i = 0; i < currentCount; i++) {
@@ -1203,8 +1330,9 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
         bool childIsInView  = (childElement && 
                 ( !params.viewFrustum || // no view frustum was given, everything is assumed in view
                   (nodeLocationThisView == ViewFrustum::INSIDE) || // parent was fully in view, we can assume ALL children are
+                  // the parent intersects and the child is in view
                   (nodeLocationThisView == ViewFrustum::INTERSECT && 
-                        childElement->isInView(*params.viewFrustum)) // the parent intersects and the child is in view
+                        (childrenLocationsThisView.getInViewMask() & (1 << originalIndex)))
                 ));
 
         if (!childIsInView) {
@@ -1447,8 +1575,10 @@ int Octree::encodeTreeBitstreamRecursion(OctreeElement* element,
                 // called databits), then we wouldn't send the children. So those types of Octree's should tell us to keep
                 // recursing, by returning TRUE in recurseChildrenWithData().
                 if (recurseChildrenWithData() || !params.viewFrustum || !oneAtBit(childrenColoredBits, originalIndex)) {
+                    ViewFrustum::location childLocationThisView = childrenLocationsThisView.getLocation(originalIndex);
                     childTreeBytesOut = encodeTreeBitstreamRecursion(childElement, packetData, bag, params, 
-                                                                            thisLevel, nodeLocationThisView);
+                                                                            thisLevel, nodeLocationThisView,
+                                                                            &childLocationThisView);
                 }
 
                 // remember this for reshuffling
@@ -1715,8 +1845,9 @@ void Octree::copySubTreeIntoNewTree(OctreeElement* startElement, Octree* destina
         // ask our tree to write a bitsteam
         EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, NO_EXISTS_BITS, chopLevels);
         encodeTreeBitstream(subTree, &packetData, nodeBag, params);
-        // ask destination tree to read the bitstream
-        ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS);
+        // ask destination tree to read the bitstream, which is in the current format of its items
+        ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS, NULL, QUuid(), SharedNodePointer(), false,
+                                       destinationTree->expectedVersion());
         destinationTree->readBitstreamToTree(packetData.getUncompressedData(), packetData.getUncompressedSize(), args);
     }
 }
@@ -1740,7 +1871,7 @@ void Octree::copyFromTreeIntoSubTree(Octree* sourceTree, OctreeElement* destinat
         // ask destination tree to read the bitstream
         bool wantImportProgress = true;
         ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS, destinationElement, 
-                                            0, SharedNodePointer(), wantImportProgress);
+                                            0, SharedNodePointer(), wantImportProgress, expectedVersion());
         readBitstreamToTree(packetData.getUncompressedData(), packetData.getUncompressedSize(), args);
     }
 }
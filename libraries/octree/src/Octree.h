@@ -12,6 +12,7 @@
 #ifndef hifi_Octree_h
 #define hifi_Octree_h
 
+#include <cfloat>
 #include <set>
 #include <SimpleMovingAverage.h>
 
@@ -20,7 +21,9 @@ class ReadBitstreamToTreeParams;
 class Octree;
 class OctreeElement;
 class OctreeElementBag;
+class OctreeItemDeltas;
 class OctreePacketData;
+class OctreeReceivedStrings;
 class Shape;
 
 
@@ -35,6 +38,7 @@ class Shape;
 
 #include <QObject>
 #include <QReadWriteLock>
+#include <QVector>
 
 /// derive from this class to use the Octree::recurseTreeWithOperator() method
 class RecurseOctreeOperator {
@@ -65,6 +69,7 @@ const quint64 IGNORE_LAST_SENT  = 0;
 #define IGNORE_VIEW_FRUSTUM      NULL
 #define IGNORE_COVERAGE_MAP      NULL
 #define IGNORE_JURISDICTION_MAP  NULL
+#define IGNORE_ITEM_DELTAS       NULL
 
 class EncodeBitstreamParams {
 public:
@@ -84,6 +89,7 @@ public:
     OctreeSceneStats* stats;
     CoverageMap* map;
     JurisdictionMap* jurisdictionMap;
+    OctreeItemDeltas* itemDeltas;
 
     // output hints from the encode process
     typedef enum {
@@ -115,7 +121,8 @@ public:
         quint64 lastViewFrustumSent = IGNORE_LAST_SENT,
         bool forceSendScene = true,
         OctreeSceneStats* stats = IGNORE_SCENE_STATS,
-        JurisdictionMap* jurisdictionMap = IGNORE_JURISDICTION_MAP) :
+        JurisdictionMap* jurisdictionMap = IGNORE_JURISDICTION_MAP,
+        OctreeItemDeltas* itemDeltas = IGNORE_ITEM_DELTAS) :
             maxEncodeLevel(maxEncodeLevel),
             maxLevelReached(0),
             viewFrustum(viewFrustum),
@@ -132,6 +139,7 @@ public:
             stats(stats),
             map(map),
             jurisdictionMap(jurisdictionMap),
+            itemDeltas(itemDeltas),
             stopReason(UNKNOWN)
     {}
 
@@ -171,6 +179,7 @@ public:
     SharedNodePointer sourceNode;
     bool wantImportProgress;
     PacketVersion bitstreamVersion;
+    OctreeReceivedStrings* receivedStrings;
 
     ReadBitstreamToTreeParams(
         bool includeColor = WANT_COLOR,
@@ -179,17 +188,37 @@ public:
         QUuid sourceUUID = QUuid(),
         SharedNodePointer sourceNode = SharedNodePointer(),
         bool wantImportProgress = false,
-        PacketVersion bitstreamVersion = 0) :
+        PacketVersion bitstreamVersion = 0,
+        OctreeReceivedStrings* receivedStrings = NULL) :
             includeColor(includeColor),
             includeExistsBits(includeExistsBits),
             destinationElement(destinationElement),
             sourceUUID(sourceUUID),
             sourceNode(sourceNode),
             wantImportProgress(wantImportProgress),
-            bitstreamVersion(bitstreamVersion)
+            bitstreamVersion(bitstreamVersion),
+            receivedStrings(receivedStrings)
     {}
 };
 
+/// One ray for Octree::findRayIntersections(), along with what it hit. The origin is in meters, like the origin
+/// given to Octree::findRayIntersection().
+class OctreeRayQuery {
+public:
+    OctreeRayQuery(const glm::vec3& rayOrigin = glm::vec3(), const glm::vec3& rayDirection = glm::vec3()) :
+        origin(rayOrigin), direction(rayDirection), intersects(false), element(NULL), distance(FLT_MAX),
+        face(MIN_X_FACE), intersectedObject(NULL) { }
+
+    glm::vec3 origin;
+    glm::vec3 direction;
+
+    bool intersects;
+    OctreeElement* element;
+    float distance;
+    BoxFace face;
+    void* intersectedObject;
+};
+
 class Octree : public QObject {
     Q_OBJECT
 public:
@@ -209,6 +238,9 @@ public:
     virtual bool handlesEditPacketType(PacketType packetType) const { return false; }
     virtual int processEditPacketData(PacketType packetType, const unsigned char* packetData, int packetLength,
                     const unsigned char* editData, int maxLength, const SharedNodePointer& sourceNode) { return 0; }
+
+    /// Implement this if your server sends erase packets for the items in your tree. Called with the tree locked for write.
+    virtual void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) { }
                     
     virtual bool recurseChildrenWithData() const { return true; }
     virtual bool rootElementHasData() const { return false; }
@@ -271,6 +303,10 @@ public:
                              void** intersectedObject = NULL,
                              Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
 
+    /// traces every ray in the list while holding the tree lock once, returns the number of rays that hit something
+    int findRayIntersections(QVector<OctreeRayQuery>& rays,
+                             Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
+
     bool findSpherePenetration(const glm::vec3& center, float radius, glm::vec3& penetration, void** penetratedObject = NULL, 
                                     Octree::lockType lockType = Octree::TryLock, bool* accurateResult = NULL);
 
@@ -329,7 +365,8 @@ protected:
     int encodeTreeBitstreamRecursion(OctreeElement* element,
                                      OctreePacketData* packetData, OctreeElementBag& bag,
                                      EncodeBitstreamParams& params, int& currentEncodeLevel,
-                                     const ViewFrustum::location& parentLocationThisView) const;
+                                     const ViewFrustum::location& parentLocationThisView,
+                                     const ViewFrustum::location* locationThisView = NULL) const;
 
     static bool countOctreeElementsOperation(OctreeElement* element, void* extraData);
 
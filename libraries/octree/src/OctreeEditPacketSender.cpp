@@ -34,7 +34,15 @@ OctreeEditPacketSender::OctreeEditPacketSender() :
     _maxPendingMessages(DEFAULT_MAX_PENDING_MESSAGES),
     _releaseQueuedMessagesPending(false),
     _serverJurisdictions(NULL),
-    _maxPacketSize(MAX_PACKET_SIZE) {
+    _routingTable(new RoutingTable()),
+    _routingIndexIsStale(true),
+    _routingNodeHashVersion(0),
+    _routingJurisdictionsVersion(0),
+    _routingIndexMutex(),
+    _routingTableGeneration(0),
+    _routingTableCaches(),
+    _maxPacketSize(MAX_PACKET_SIZE),
+    _editPacketsMutex(QMutex::Recursive) {
 }
 
 OctreeEditPacketSender::~OctreeEditPacketSender() {
@@ -85,10 +93,97 @@ bool OctreeEditPacketSender::serversExist() const {
     return (hasServers && !atLeastOneJurisdictionMissing);
 }
 
+OctreeEditPacketSender::RoutingTablePointer OctreeEditPacketSender::updateRoutingIndex() {
+    NodeList* nodeList = NodeList::getInstance();
+    int nodeHashVersion = nodeList->getNodeHashVersion();
+    int jurisdictionsVersion = _serverJurisdictions ? _serverJurisdictions->getVersion() : 0;
+
+    // the edit hot path: the versions and the generation are atomics, so nothing is locked to find out that the table
+    // this thread used last is still the current one
+    RoutingTableCache& cache = _routingTableCaches.localData();
+    if (cache.generation == _routingTableGeneration.load() && cache.nodeHashVersion == nodeHashVersion
+            && cache.jurisdictionsVersion == jurisdictionsVersion) {
+        return cache.table;
+    }
+
+    {
+        QMutexLocker locker(&_routingIndexMutex);
+        if (!_routingIndexIsStale && nodeHashVersion == _routingNodeHashVersion
+                && jurisdictionsVersion == _routingJurisdictionsVersion) {
+            cacheRoutingTable(cache);
+            return _routingTable;
+        }
+    }
+
+    // the new table is built on the side, readers keep using the one they have until it's published
+    QSharedPointer<RoutingTable> table(new RoutingTable());
+
+    if (_serverJurisdictions) {
+        _serverJurisdictions->lockForRead();
+    }
+
+    // nodes that aren't active yet get routed to as well, they are skipped while they have no active socket
+    foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
+        if (node->getType() == getMyNodeType()) {
+            int server = table->servers.size();
+            bool hasJurisdiction = true;
+
+            if (_serverJurisdictions) {
+                NodeToJurisdictionMap::const_iterator map = _serverJurisdictions->constFind(node->getUUID());
+                hasJurisdiction = (map != _serverJurisdictions->constEnd());
+                if (hasJurisdiction) {
+                    table->index.addJurisdiction(server, map.value());
+                }
+            } else {
+                table->index.addUnrestrictedServer(server);
+            }
+
+            table->servers.append(node);
+            table->serverHasJurisdiction.append(hasJurisdiction);
+        }
+    }
+
+    if (_serverJurisdictions) {
+        _serverJurisdictions->unlock();
+    }
+
+    // remember the versions from before the rebuild, so that a change made during it causes another one
+    QMutexLocker locker(&_routingIndexMutex);
+    _routingTable = table;
+    _routingNodeHashVersion = nodeHashVersion;
+    _routingJurisdictionsVersion = jurisdictionsVersion;
+    _routingIndexIsStale = false;
+    _routingTableGeneration.ref();
+    cacheRoutingTable(cache);
+    return _routingTable;
+}
+
+void OctreeEditPacketSender::cacheRoutingTable(RoutingTableCache& cache) {
+    // called with _routingIndexMutex locked, so the generation goes with the published table
+    cache.table = _routingTable;
+    cache.generation = _routingTableGeneration.load();
+    cache.nodeHashVersion = _routingNodeHashVersion;
+    cache.jurisdictionsVersion = _routingJurisdictionsVersion;
+}
+
+bool OctreeEditPacketSender::routedServersExist(const RoutingTable& table) {
+    bool hasServers = false;
+    for (int i = 0; i < table.servers.size(); i++) {
+        if (table.servers[i]->getActiveSocket()) {
+            if (!table.serverHasJurisdiction[i]) {
+                return false; // at least one jurisdiction is missing
+            }
+            hasServers = true;
+        }
+    }
+    return hasServers;
+}
+
 // This method is called when the edit packet layer has determined that it has a fully formed packet destined for
 // a known nodeID.
 void OctreeEditPacketSender::queuePacketToNode(const QUuid& nodeUUID, unsigned char* buffer, ssize_t length) {
     NodeList* nodeList = NodeList::getInstance();
+    QMutexLocker locker(&_editPacketsMutex);
 
     foreach (const SharedNodePointer& node, nodeList->getNodeHash()) {
         // only send to the NodeTypes that are getMyNodeType()
@@ -180,7 +275,8 @@ void OctreeEditPacketSender::queuePacketToNodes(unsigned char* buffer, ssize_t l
         return; // bail early
     }
 
-    assert(serversExist()); // we must have jurisdictions to be here!!
+    RoutingTablePointer table = updateRoutingIndex();
+    assert(routedServersExist(*table)); // we must have jurisdictions to be here!!
 
     int headerBytes = numBytesForPacketHeader(reinterpret_cast<char*>(buffer)) + sizeof(short) + sizeof(quint64);
     unsigned char* octCode = buffer + headerBytes; // skip the packet header to get to the octcode
@@ -189,21 +285,13 @@ void OctreeEditPacketSender::queuePacketToNodes(unsigned char* buffer, ssize_t l
     // But we can't really do that with a packed message, since each edit message could be destined
     // for a different server... So we need to actually manage multiple queued packets... one
     // for each server
+    RoutedServers servers;
+    table->index.findServers(octCode, servers);
 
-    foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
-        // only send to the NodeTypes that are getMyNodeType()
-        if (node->getActiveSocket() && node->getType() == getMyNodeType()) {
-            QUuid nodeUUID = node->getUUID();
-            bool isMyJurisdiction = true;
-            // we need to get the jurisdiction for this
-            // here we need to get the "pending packet" for this server
-            _serverJurisdictions->lockForRead();
-            const JurisdictionMap& map = (*_serverJurisdictions)[nodeUUID];
-            isMyJurisdiction = (map.isMyJurisdiction(octCode, CHECK_NODE_ONLY) == JurisdictionMap::WITHIN);
-            _serverJurisdictions->unlock();
-            if (isMyJurisdiction) {
-                queuePacketToNode(nodeUUID, buffer, length);
-            }
+    for (int i = 0; i < servers.size(); i++) {
+        const SharedNodePointer& node = table->servers[servers[i]];
+        if (node->getActiveSocket()) {
+            queuePacketToNode(node->getUUID(), buffer, length);
         }
     }
 }
@@ -217,8 +305,9 @@ void OctreeEditPacketSender::queueOctreeEditMessage(PacketType type, unsigned ch
     }
 
     // If we don't have jurisdictions, then we will simply queue up all of these packets and wait till we have
-    // jurisdictions for processing
-    if (!serversExist()) {
+    // jurisdictions for processing. The table stays the same while this edit is routed, whatever other threads do.
+    RoutingTablePointer table = updateRoutingIndex();
+    if (!routedServersExist(*table)) {
         if (_maxPendingMessages > 0) {
             EditPacketBuffer* packet = new EditPacketBuffer(type, codeColorBuffer, length);
             _pendingPacketsLock.lock();
@@ -240,52 +329,39 @@ void OctreeEditPacketSender::queueOctreeEditMessage(PacketType type, unsigned ch
     // But we can't really do that with a packed message, since each edit message could be destined
     // for a different server... So we need to actually manage multiple queued packets... one
     // for each server
+    RoutedServers servers;
+    table->index.findServers(codeColorBuffer, servers);
 
-    foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
-        // only send to the NodeTypes that are getMyNodeType()
-        if (node->getActiveSocket() && node->getType() == getMyNodeType()) {
+    QMutexLocker locker(&_editPacketsMutex);
+    for (int i = 0; i < servers.size(); i++) {
+        const SharedNodePointer& node = table->servers[servers[i]];
+        if (node->getActiveSocket()) {
             QUuid nodeUUID = node->getUUID();
-            bool isMyJurisdiction = true;
-
-            if (_serverJurisdictions) {
-                // we need to get the jurisdiction for this
-                // here we need to get the "pending packet" for this server
-                _serverJurisdictions->lockForRead();
-                if ((*_serverJurisdictions).find(nodeUUID) != (*_serverJurisdictions).end()) {
-                    const JurisdictionMap& map = (*_serverJurisdictions)[nodeUUID];
-                    isMyJurisdiction = (map.isMyJurisdiction(codeColorBuffer, CHECK_NODE_ONLY) == JurisdictionMap::WITHIN);
-                } else {
-                    isMyJurisdiction = false;
-                }
-                _serverJurisdictions->unlock();
+            EditPacketBuffer& packetBuffer = _pendingEditPackets[nodeUUID];
+            packetBuffer._nodeUUID = nodeUUID;
+
+            // If we're switching type, then we send the last one and start over
+            if ((type != packetBuffer._currentType && packetBuffer._currentSize > 0) ||
+                (packetBuffer._currentSize + length >= _maxPacketSize)) {
+                releaseQueuedPacket(packetBuffer);
+                initializePacket(packetBuffer, type);
             }
-            if (isMyJurisdiction) {
-                EditPacketBuffer& packetBuffer = _pendingEditPackets[nodeUUID];
-                packetBuffer._nodeUUID = nodeUUID;
-
-                // If we're switching type, then we send the last one and start over
-                if ((type != packetBuffer._currentType && packetBuffer._currentSize > 0) ||
-                    (packetBuffer._currentSize + length >= _maxPacketSize)) {
-                    releaseQueuedPacket(packetBuffer);
-                    initializePacket(packetBuffer, type);
-                }
-
-                // If the buffer is empty and not correctly initialized for our type...
-                if (type != packetBuffer._currentType && packetBuffer._currentSize == 0) {
-                    initializePacket(packetBuffer, type);
-                }
 
-                // This is really the first time we know which server/node this particular edit message
-                // is going to, so we couldn't adjust for clock skew till now. But here's our chance.
-                // We call this virtual function that allows our specific type of EditPacketSender to
-                // fixup the buffer for any clock skew
-                if (node->getClockSkewUsec() != 0) {
-                    adjustEditPacketForClockSkew(codeColorBuffer, length, node->getClockSkewUsec());
-                }
+            // If the buffer is empty and not correctly initialized for our type...
+            if (type != packetBuffer._currentType && packetBuffer._currentSize == 0) {
+                initializePacket(packetBuffer, type);
+            }
 
-                memcpy(&packetBuffer._currentBuffer[packetBuffer._currentSize], codeColorBuffer, length);
-                packetBuffer._currentSize += length;
+            // This is really the first time we know which server/node this particular edit message
+            // is going to, so we couldn't adjust for clock skew till now. But here's our chance.
+            // We call this virtual function that allows our specific type of EditPacketSender to
+            // fixup the buffer for any clock skew
+            if (node->getClockSkewUsec() != 0) {
+                adjustEditPacketForClockSkew(codeColorBuffer, length, node->getClockSkewUsec());
             }
+
+            memcpy(&packetBuffer._currentBuffer[packetBuffer._currentSize], codeColorBuffer, length);
+            packetBuffer._currentSize += length;
         }
     }
 }
@@ -294,9 +370,10 @@ void OctreeEditPacketSender::releaseQueuedMessages() {
     // if we don't yet have jurisdictions then we can't actually release messages yet because we don't
     // know where to send them to. Instead, just remember this request and when we eventually get jurisdictions
     // call release again at that time.
-    if (!serversExist()) {
+    if (!routedServersExist()) {
         _releaseQueuedMessagesPending = true;
     } else {
+        QMutexLocker locker(&_editPacketsMutex);
         for (QHash<QUuid, EditPacketBuffer>::iterator i = _pendingEditPackets.begin(); i != _pendingEditPackets.end(); i++) {
             releaseQueuedPacket(i.value());
         }
@@ -342,7 +419,8 @@ bool OctreeEditPacketSender::process() {
 void OctreeEditPacketSender::processNackPacket(const QByteArray& packet) {
     // parse sending node from packet, retrieve packet history for that node
     QUuid sendingNodeUUID = uuidFromPacketHeader(packet);
-    
+    QMutexLocker locker(&_editPacketsMutex);
+
     // if packet history doesn't exist for the sender node (somehow), bail
     if (!_sentPacketHistories.contains(sendingNodeUUID)) {
         return;
@@ -371,8 +449,8 @@ void OctreeEditPacketSender::processNackPacket(const QByteArray& packet) {
 }
 
 void OctreeEditPacketSender::nodeKilled(SharedNodePointer node) {
-    // TODO: add locks
     QUuid nodeUUID = node->getUUID();
+    QMutexLocker locker(&_editPacketsMutex);
     _pendingEditPackets.remove(nodeUUID);
     _outgoingSequenceNumbers.remove(nodeUUID);
     _sentPacketHistories.remove(nodeUUID);
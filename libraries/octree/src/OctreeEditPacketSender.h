@@ -13,9 +13,12 @@
 #define hifi_OctreeEditPacketSender_h
 
 #include <qqueue.h>
+#include <QSharedPointer>
+#include <QThreadStorage>
 #include <PacketSender.h>
 #include <PacketHeaders.h>
 #include "JurisdictionMap.h"
+#include "JurisdictionRoutingIndex.h"
 #include "SentPacketHistory.h"
 
 /// Used for construction of edit packets
@@ -64,6 +67,9 @@ public:
     /// known jurisdictions.
     void setServerJurisdictions(NodeToJurisdictionMap* serverJurisdictions) { 
         _serverJurisdictions = serverJurisdictions;
+        QMutexLocker locker(&_routingIndexMutex);
+        _routingIndexIsStale = true;
+        _routingTableGeneration.ref();
     }
 
     /// if you're running in non-threaded mode, you must call this method regularly
@@ -108,6 +114,38 @@ protected:
     
     void processPreServerExistsPackets();
 
+    /// Which of our servers each edit goes to, so that routing an edit needs neither the node list nor the jurisdiction
+    /// lock; the servers of the index are indexes into servers. A table is never changed once it's published, so it can
+    /// be read without a lock while another thread publishes a new one.
+    class RoutingTable {
+    public:
+        JurisdictionRoutingIndex index;
+        QVector<SharedNodePointer> servers;
+        QVector<bool> serverHasJurisdiction;
+    };
+    typedef QSharedPointer<const RoutingTable> RoutingTablePointer;
+
+    /// The routing table a thread used last, and what it was built from. As long as nothing was published since and
+    /// the versions are the same, the thread routes with it without taking _routingIndexMutex.
+    class RoutingTableCache {
+    public:
+        RoutingTableCache() : table(), generation(-1), nodeHashVersion(0), jurisdictionsVersion(0) { }
+
+        RoutingTablePointer table;
+        int generation;
+        int nodeHashVersion;
+        int jurisdictionsVersion;
+    };
+
+    /// rebuilds the routing table if the node list or the jurisdictions changed since it was last built
+    /// \return the current routing table
+    RoutingTablePointer updateRoutingIndex();
+    void cacheRoutingTable(RoutingTableCache& cache);
+
+    /// same as serversExist(), but answered from a routing table
+    static bool routedServersExist(const RoutingTable& table);
+    bool routedServersExist() { return routedServersExist(*updateRoutingIndex()); }
+
     // These are packets which are destined from know servers but haven't been released because they're still too small
     QHash<QUuid, EditPacketBuffer> _pendingEditPackets;
     
@@ -119,12 +157,25 @@ protected:
     QVector<EditPacketBuffer*> _preServerSingleMessagePackets; // these will go out as is
 
     NodeToJurisdictionMap* _serverJurisdictions;
+
+    // the published routing table and what it was built from, guarded by _routingIndexMutex
+    RoutingTablePointer _routingTable;
+    bool _routingIndexIsStale;
+    int _routingNodeHashVersion;
+    int _routingJurisdictionsVersion;
+    QMutex _routingIndexMutex;
+
+    // bumped, under _routingIndexMutex, whenever a table is published or the current one goes stale
+    QAtomicInt _routingTableGeneration;
+    QThreadStorage<RoutingTableCache> _routingTableCaches;
     
     int _maxPacketSize;
 
     QMutex _releaseQueuedPacketMutex;
 
-    // TODO: add locks for this and _pendingEditPackets
+    // guards _pendingEditPackets, _sentPacketHistories and _outgoingSequenceNumbers, since scripts on several threads
+    // can queue edits at once. Recursive, since packing an edit can release the packet it's packed into.
+    QMutex _editPacketsMutex;
     QHash<QUuid, SentPacketHistory> _sentPacketHistories;
     QHash<QUuid, quint16> _outgoingSequenceNumbers;
 };
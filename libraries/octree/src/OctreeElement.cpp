@@ -1197,6 +1197,69 @@ ViewFrustum::location OctreeElement::inFrustum(const ViewFrustum& viewFrustum) c
     return viewFrustum.cubeInFrustum(cube);
 }
 
+ViewFrustum::LocationMasks OctreeElement::childrenInFrustum(const ViewFrustum& viewFrustum) const {
+    AACube cubes[NUMBER_OF_CHILDREN];
+    int childIndexes[NUMBER_OF_CHILDREN];
+    int count = 0;
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        OctreeElement* childElement = getChildAtIndex(i);
+        if (childElement) {
+            cubes[count] = childElement->_cube;
+            cubes[count].scale(TREE_SCALE);
+            childIndexes[count++] = i;
+        }
+    }
+    ViewFrustum::LocationMasks batchMasks = viewFrustum.cubesInFrustum(cubes, count);
+
+    // the batch only has the children that exist, so move their bits over to their child indexes
+    ViewFrustum::LocationMasks masks = { 0, 0, 0 };
+    for (int i = 0; i < count; i++) {
+        quint32 childBit = 1u << childIndexes[i];
+        switch (batchMasks.getLocation(i)) {
+            case ViewFrustum::INSIDE:
+                masks.inside |= childBit;
+                break;
+            case ViewFrustum::INTERSECT:
+                masks.intersect |= childBit;
+                break;
+            default:
+                masks.outside |= childBit;
+                break;
+        }
+    }
+    return masks;
+}
+
+void ChildrenFrustumLocations::storeChildrenLocations(const OctreeElement* element, const ViewFrustum& viewFrustum) {
+    if (element->isLeaf()) {
+        return; // no children will come asking
+    }
+    int level = element->getLevel();
+    if (_levels.size() <= level) {
+        // only grows as deep as the tree goes
+        _levels.resize(level + 1);
+    }
+    _levels[level].parent = element;
+    _levels[level].masks = element->childrenInFrustum(viewFrustum);
+}
+
+ViewFrustum::location ChildrenFrustumLocations::getLocation(const OctreeElement* element,
+                                                            const ViewFrustum& viewFrustum) const {
+    int parentLevel = element->getLevel() - 1;
+    if (parentLevel < _levels.size()) {
+        // the batch at the parent's level may be left over from another part of the tree, so make sure it's our parent's
+        const LevelLocations& levelLocations = _levels[parentLevel];
+        if (levelLocations.parent) {
+            for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+                if (levelLocations.parent->getChildAtIndex(i) == element) {
+                    return levelLocations.masks.getLocation(i);
+                }
+            }
+        }
+    }
+    return element->inFrustum(viewFrustum);
+}
+
 // There are two types of nodes for which we want to "render"
 // 1) Leaves that are in the LOD
 // 2) Non-leaves are more complicated though... usually you don't want to render them, but if their children
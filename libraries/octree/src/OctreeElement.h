@@ -17,6 +17,7 @@
 #define SIMPLE_EXTERNAL_CHILDREN
 
 #include <QReadWriteLock>
+#include <QVector>
 
 #include <SharedUtil.h>
 
@@ -132,6 +133,9 @@ public:
     float getEnclosingRadius() const;
     bool isInView(const ViewFrustum& viewFrustum) const { return inFrustum(viewFrustum) != ViewFrustum::OUTSIDE; }
     ViewFrustum::location inFrustum(const ViewFrustum& viewFrustum) const;
+    /// Tests the children that exist against the view frustum in one batch. Bit i of the masks stands for child i, and
+    /// is clear in all of them for a child that doesn't exist.
+    ViewFrustum::LocationMasks childrenInFrustum(const ViewFrustum& viewFrustum) const;
     float distanceToCamera(const ViewFrustum& viewFrustum) const; 
     float furthestDistanceToCamera(const ViewFrustum& viewFrustum) const;
 
@@ -336,4 +340,30 @@ protected:
     static quint64 _childrenCount[NUMBER_OF_CHILDREN + 1];
 };
 
+/// Hands the locations of children, tested in one batch by their parent, down a depth first recursion such as
+/// Octree::recurseTreeWithOperation(). An operation calls storeChildrenLocations() before it returns true, and the
+/// operation on each child gets its location from getLocation() without testing the child on its own. Only one batch is
+/// kept per level, which is all a depth first recursion needs, so nothing is allocated per element.
+class ChildrenFrustumLocations {
+public:
+    ChildrenFrustumLocations() : _levels() { }
+
+    /// tests the children of the element against the view frustum in one batch
+    void storeChildrenLocations(const OctreeElement* element, const ViewFrustum& viewFrustum);
+
+    /// \return the location of the element from the batch its parent tested, or from testing the element itself if its
+    /// parent didn't store one
+    ViewFrustum::location getLocation(const OctreeElement* element, const ViewFrustum& viewFrustum) const;
+
+private:
+    struct LevelLocations {
+        LevelLocations() : parent(NULL) { }
+
+        const OctreeElement* parent;
+        ViewFrustum::LocationMasks masks;
+    };
+
+    QVector<LevelLocations> _levels; // indexed by the level of the parent
+};
+
 #endif // hifi_OctreeElement_h
@@ -31,6 +31,19 @@ OctreeHeadlessViewer::~OctreeHeadlessViewer() {
 void OctreeHeadlessViewer::init() {
     OctreeRenderer::init();
     setViewFrustum(&_viewFrustum);
+
+    // nothing else pumps the pipeline of a headless viewer, so packets that finish decoding after processDatagram()
+    // returns are applied from the event loop
+    connect(&_packetPipeline, SIGNAL(packetDecoded()), SLOT(applyDecodedPackets()),
+            (Qt::ConnectionType)(Qt::QueuedConnection | Qt::UniqueConnection));
+}
+
+void OctreeHeadlessViewer::applyDecodedPackets() {
+    applyQueuedPackets();
+    if (_packetPipeline.isReadyToApply()) {
+        // more than one window's worth: let the other events in before the next window
+        QMetaObject::invokeMethod(this, "applyDecodedPackets", Qt::QueuedConnection);
+    }
 }
 
 void OctreeHeadlessViewer::queryOctree() {
@@ -77,6 +90,10 @@ void OctreeHeadlessViewer::queryOctree() {
     int inViewServers = 0;
     int unknownJurisdictionServers = 0;
 
+    // the bounds of the servers with known jurisdictions, tested against the view in batches below
+    QVector<QUuid> serverUUIDs;
+    QVector<AACube> serverBoundsToTest;
+
     foreach (const SharedNodePointer& node, NodeList::getInstance()->getNodeHash()) {
         // only send to the NodeTypes that are serverType
         if (node->getActiveSocket() && node->getType() == serverType) {
@@ -103,11 +120,8 @@ void OctreeHeadlessViewer::queryOctree() {
                     AACube serverBounds(glm::vec3(rootDetails.x, rootDetails.y, rootDetails.z), rootDetails.s);
                     serverBounds.scale(TREE_SCALE);
 
-                    ViewFrustum::location serverFrustumLocation = _viewFrustum.cubeInFrustum(serverBounds);
-
-                    if (serverFrustumLocation != ViewFrustum::OUTSIDE) {
-                        inViewServers++;
-                    }
+                    serverUUIDs.append(nodeUUID);
+                    serverBoundsToTest.append(serverBounds);
                 } else {
                     jurisdictions.unlock();
                 }
@@ -115,6 +129,20 @@ void OctreeHeadlessViewer::queryOctree() {
         }
     }
 
+    QHash<QUuid, bool> serversInView;
+    for (int batchStart = 0; batchStart < serverBoundsToTest.size(); batchStart += MAX_CUBE_BATCH_SIZE) {
+        int batchSize = qMin(serverBoundsToTest.size() - batchStart, MAX_CUBE_BATCH_SIZE);
+        ViewFrustum::LocationMasks masks = _viewFrustum.cubesInFrustum(serverBoundsToTest.constData() + batchStart,
+            batchSize);
+        for (int i = 0; i < batchSize; i++) {
+            bool inView = masks.getLocation(i) != ViewFrustum::OUTSIDE;
+            serversInView.insert(serverUUIDs.at(batchStart + i), inView);
+            if (inView) {
+                inViewServers++;
+            }
+        }
+    }
+
     if (wantExtraDebugging) {
         qDebug("Servers: total %d, in view %d, unknown jurisdiction %d",
             totalServers, inViewServers, unknownJurisdictionServers);
@@ -174,11 +202,12 @@ void OctreeHeadlessViewer::queryOctree() {
                     AACube serverBounds(glm::vec3(rootDetails.x, rootDetails.y, rootDetails.z), rootDetails.s);
                     serverBounds.scale(TREE_SCALE);
 
-                    ViewFrustum::location serverFrustumLocation = _viewFrustum.cubeInFrustum(serverBounds);
-                    if (serverFrustumLocation != ViewFrustum::OUTSIDE) {
-                        inView = true;
+                    // use the result of the batch above, unless the jurisdiction arrived since
+                    QHash<QUuid, bool>::const_iterator tested = serversInView.constFind(nodeUUID);
+                    if (tested != serversInView.constEnd()) {
+                        inView = tested.value();
                     } else {
-                        inView = false;
+                        inView = _viewFrustum.cubeInFrustum(serverBounds) != ViewFrustum::OUTSIDE;
                     }
                 } else {
                     jurisdictions.unlock();
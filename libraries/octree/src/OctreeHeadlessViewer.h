@@ -63,6 +63,10 @@ public slots:
 
     unsigned getOctreeElementsCount() const { return _tree->getOctreeElementsCount(); }
 
+private slots:
+    /// reads the decoded packets into the tree on the viewer's thread, one write lock window per event
+    void applyDecodedPackets();
+
 private:
     ViewFrustum _viewFrustum;
     JurisdictionListener* _jurisdictionListener;
@@ -0,0 +1,298 @@
+//
+//  OctreeItemDeltas.cpp
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <climits>
+
+#include "OctreeItemDeltas.h"
+
+OctreeItemDeltas::OctreeItemDeltas() :
+    _sentItems(),
+    _stringIndexes(),
+    _sentStrings(),
+    _itemID(0),
+    _itemCube(),
+    _itemHasCube(false),
+    _itemOffset(0),
+    _stagedProperties(),
+    _stagedStrings(),
+    _packetProperties(),
+    _packetStrings() {
+}
+
+void OctreeItemDeltas::beginItem(OctreePacketData* packetData, quint32 itemID, const AACube* cube) {
+    dropRewoundWrites(packetData);
+    _itemID = itemID;
+    _itemHasCube = (cube != NULL);
+    _itemCube = cube ? *cube : AACube();
+    _itemOffset = packetData->getUncompressedByteOffset();
+}
+
+bool OctreeItemDeltas::hasPropertyChanged(int property, const QByteArray& value) const {
+    QHash<quint32, SentItem>::const_iterator item = _sentItems.constFind(_itemID);
+    if (item == _sentItems.constEnd() || property >= item.value().properties.size()) {
+        return true;
+    }
+    const QByteArray& sentValue = item.value().properties.at(property);
+    return sentValue.isNull() || sentValue != value;
+}
+
+void OctreeItemDeltas::propertyWritten(int property, const QByteArray& value) {
+    WrittenProperty written = { _itemOffset, _itemID, _itemCube, _itemHasCube, property, value };
+    _stagedProperties.append(written);
+}
+
+void OctreeItemDeltas::appendString(QByteArray& bytes, const QString& string) {
+    quint16 index;
+    QHash<QString, quint16>::const_iterator known = _stringIndexes.constFind(string);
+    if (known != _stringIndexes.constEnd()) {
+        index = known.value();
+        if (_sentStrings.contains(index)) {
+            bytes.append(reinterpret_cast<const char*>(&index), sizeof(index));
+            return;
+        }
+    } else if (_stringIndexes.size() < MAX_STRING_TABLE_SIZE) {
+        index = _stringIndexes.size();
+        _stringIndexes.insert(string, index);
+    } else {
+        appendInlineString(bytes, string);
+        return;
+    }
+
+    // the string is defined every time it's written until a packet with it has gone out
+    quint16 code = index | STRING_DEFINITION_BIT;
+    bytes.append(reinterpret_cast<const char*>(&code), sizeof(code));
+    QByteArray utf8 = string.toUtf8().left(MAX_STRING_LENGTH);
+    quint16 length = utf8.size();
+    bytes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    bytes.append(utf8);
+
+    WrittenString written = { _itemOffset, index };
+    _stagedStrings.append(written);
+}
+
+void OctreeItemDeltas::sectionWritten(OctreePacketData* packetData) {
+    dropRewoundWrites(packetData);
+    _packetProperties += _stagedProperties;
+    _packetStrings += _stagedStrings;
+    _stagedProperties.clear();
+    _stagedStrings.clear();
+}
+
+void OctreeItemDeltas::packetSent() {
+    foreach (const WrittenProperty& written, _packetProperties) {
+        SentItem& item = _sentItems[written.itemID];
+        item.cube = written.cube;
+        item.hasCube = written.hasCube;
+        QVector<QByteArray>& properties = item.properties;
+        if (written.property >= properties.size()) {
+            properties.resize(written.property + 1);
+        }
+        properties[written.property] = written.value;
+    }
+    foreach (const WrittenString& written, _packetStrings) {
+        _sentStrings.insert(written.index);
+    }
+    _packetProperties.clear();
+    _packetStrings.clear();
+}
+
+void OctreeItemDeltas::packetDropped() {
+    _packetProperties.clear();
+    _packetStrings.clear();
+}
+
+void OctreeItemDeltas::forgetItem(quint32 itemID) {
+    _sentItems.remove(itemID);
+    removeItemWrites(_stagedProperties, itemID);
+    removeItemWrites(_packetProperties, itemID);
+}
+
+void OctreeItemDeltas::forgetItemsOutside(const ViewFrustum& viewFrustum) {
+    QHash<quint32, SentItem>::iterator item = _sentItems.begin();
+    while (item != _sentItems.end()) {
+        if (item.value().hasCube) {
+            AACube cube = item.value().cube;
+            cube.scale(TREE_SCALE);
+            if (viewFrustum.cubeInFrustum(cube) == ViewFrustum::OUTSIDE) {
+                item = _sentItems.erase(item);
+                continue;
+            }
+        }
+        ++item;
+    }
+}
+
+void OctreeItemDeltas::reset() {
+    _sentItems.clear();
+    _sentStrings.clear();
+    _stagedProperties.clear();
+    _stagedStrings.clear();
+    _packetProperties.clear();
+    _packetStrings.clear();
+}
+
+bool OctreeItemDeltas::isEmpty() const {
+    return _sentItems.isEmpty() && _sentStrings.isEmpty() && _stagedProperties.isEmpty() &&
+        _packetProperties.isEmpty();
+}
+
+void OctreeItemDeltas::dropRewoundWrites(OctreePacketData* packetData) {
+    // the writes are staged in the order of their offsets, so the ones that were rewound are at the end
+    int rewoundTo = packetData->getRewoundToSinceLastCheck();
+    if (rewoundTo == INT_MAX) {
+        return;
+    }
+    while (!_stagedProperties.isEmpty() && _stagedProperties.last().offset >= rewoundTo) {
+        _stagedProperties.removeLast();
+    }
+    while (!_stagedStrings.isEmpty() && _stagedStrings.last().offset >= rewoundTo) {
+        _stagedStrings.removeLast();
+    }
+}
+
+void OctreeItemDeltas::removeItemWrites(QVector<WrittenProperty>& writes, quint32 itemID) {
+    int kept = 0;
+    for (int i = 0; i < writes.size(); i++) {
+        if (writes.at(i).itemID != itemID) {
+            writes[kept++] = writes.at(i);
+        }
+    }
+    writes.resize(kept);
+}
+
+bool OctreeItemDeltas::appendProperty(OctreeItemDeltas* deltas, QByteArray& bytes, int property, const void* value,
+                                      int size) {
+    QByteArray valueBytes(reinterpret_cast<const char*>(value), size);
+    if (deltas) {
+        if (!deltas->hasPropertyChanged(property, valueBytes)) {
+            return false;
+        }
+        deltas->propertyWritten(property, valueBytes);
+    }
+    bytes.append(valueBytes);
+    return true;
+}
+
+bool OctreeItemDeltas::appendStringProperty(OctreeItemDeltas* deltas, QByteArray& bytes, int property,
+                                            const QString& string) {
+    // the inline encoding is what the client is left with either way
+    QByteArray valueBytes;
+    appendInlineString(valueBytes, string);
+    if (!deltas) {
+        bytes.append(valueBytes);
+        return true;
+    }
+    if (!deltas->hasPropertyChanged(property, valueBytes)) {
+        return false;
+    }
+    deltas->propertyWritten(property, valueBytes);
+    deltas->appendString(bytes, string);
+    return true;
+}
+
+int OctreeItemDeltas::appendPositionProperty(OctreeItemDeltas* deltas, QByteArray& bytes, int positionProperty,
+                                             int quantizedPositionProperty, const glm::vec3& position, float radius,
+                                             const AACube* cube) {
+    QByteArray quantizedBytes;
+    glm::vec3 quantizedPosition;
+    bool isQuantized = deltas && cube && appendQuantizedPosition(quantizedBytes, position, radius, *cube,
+                                                                 quantizedPosition);
+    const glm::vec3& sentPosition = isQuantized ? quantizedPosition : position;
+    QByteArray valueBytes(reinterpret_cast<const char*>(&sentPosition), sizeof(sentPosition));
+    if (deltas) {
+        if (!deltas->hasPropertyChanged(positionProperty, valueBytes)) {
+            return -1;
+        }
+        deltas->propertyWritten(positionProperty, valueBytes);
+    }
+    if (isQuantized) {
+        bytes.append(quantizedBytes);
+        return quantizedPositionProperty;
+    }
+    bytes.append(valueBytes);
+    return positionProperty;
+}
+
+void OctreeItemDeltas::appendInlineString(QByteArray& bytes, const QString& string) {
+    quint16 code = INLINE_STRING;
+    bytes.append(reinterpret_cast<const char*>(&code), sizeof(code));
+    QByteArray utf8 = string.toUtf8().left(MAX_STRING_LENGTH);
+    quint16 length = utf8.size();
+    bytes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    bytes.append(utf8);
+}
+
+bool OctreeItemDeltas::appendQuantizedPosition(QByteArray& bytes, const glm::vec3& position, float radius,
+                                               const AACube& cube, glm::vec3& quantizedPosition) {
+    float scale = cube.getScale();
+    if (scale <= 0.0f || scale / QUANTIZED_POSITION_STEPS > radius * MAX_QUANTIZED_POSITION_STEP_PER_RADIUS) {
+        return false;
+    }
+    glm::vec3 relativePosition = (position - cube.getCorner()) / scale;
+    for (int i = 0; i < 3; i++) {
+        if (relativePosition[i] < 0.0f || relativePosition[i] > 1.0f) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        quint16 step = (quint16)(relativePosition[i] * QUANTIZED_POSITION_STEPS + 0.5f);
+        bytes.append(reinterpret_cast<const char*>(&step), sizeof(step));
+        quantizedPosition[i] = cube.getCorner()[i] + (step / QUANTIZED_POSITION_STEPS) * scale;
+    }
+    return true;
+}
+
+glm::vec3 OctreeItemDeltas::readQuantizedPosition(const unsigned char* data, const AACube& cube) {
+    glm::vec3 position;
+    for (int i = 0; i < 3; i++) {
+        quint16 step;
+        memcpy(&step, data + i * sizeof(step), sizeof(step));
+        position[i] = cube.getCorner()[i] + (step / QUANTIZED_POSITION_STEPS) * cube.getScale();
+    }
+    return position;
+}
+
+int OctreeReceivedStrings::readString(const unsigned char* data, int bytesLeftToRead,
+                                      OctreeReceivedStrings* receivedStrings, QString& string, bool& isKnown) {
+    quint16 code;
+    if (bytesLeftToRead < (int)sizeof(code)) {
+        return 0;
+    }
+    memcpy(&code, data, sizeof(code));
+    int bytesRead = sizeof(code);
+
+    if (code != INLINE_STRING && !(code & STRING_DEFINITION_BIT)) {
+        // a string the server sent before
+        QHash<quint16, QString>::const_iterator known = receivedStrings ? receivedStrings->_strings.constFind(code) :
+            QHash<quint16, QString>::const_iterator();
+        isKnown = receivedStrings && known != receivedStrings->_strings.constEnd();
+        string = isKnown ? known.value() : QString();
+        return bytesRead;
+    }
+
+    quint16 length;
+    if (bytesLeftToRead < bytesRead + (int)sizeof(length)) {
+        return 0;
+    }
+    memcpy(&length, data + bytesRead, sizeof(length));
+    bytesRead += sizeof(length);
+    if (bytesLeftToRead < bytesRead + length) {
+        return 0;
+    }
+    string = QString::fromUtf8(reinterpret_cast<const char*>(data + bytesRead), length);
+    bytesRead += length;
+    isKnown = true;
+
+    if (code != INLINE_STRING && receivedStrings) {
+        receivedStrings->_strings.insert(code & ~STRING_DEFINITION_BIT, string);
+    }
+    return bytesRead;
+}
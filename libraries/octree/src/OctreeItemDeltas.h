@@ -0,0 +1,184 @@
+//
+//  OctreeItemDeltas.h
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeItemDeltas_h
+#define hifi_OctreeItemDeltas_h
+
+#include <glm/glm.hpp>
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include <AACube.h>
+
+#include "OctreePacketData.h"
+#include "ViewFrustum.h"
+
+// A string property is written as a code, followed by the string unless the code refers to a string the client has
+// already been sent. The string is written as a 16 bit length and that many bytes of UTF-8.
+const quint16 INLINE_STRING = 0xFFFF; // the string follows, and doesn't go into the table
+const quint16 STRING_DEFINITION_BIT = 0x8000; // the rest of the code is the index the string that follows goes to
+const quint16 MAX_STRING_TABLE_SIZE = 0x7FFF;
+const int MAX_STRING_LENGTH = 0xFFFF;
+
+// positions quantized into the cube of the element that holds the item use this many steps along each side
+const float QUANTIZED_POSITION_STEPS = 65535.0f;
+const int QUANTIZED_POSITION_BYTES = 3 * sizeof(quint16);
+
+// a position is only quantized when a step is at most this fraction of the radius of the item
+const float MAX_QUANTIZED_POSITION_STEP_PER_RADIUS = 0.01f;
+
+/// What a client has been sent of the items (models, particles) of the elements sent over one connection, so that
+/// only the properties that changed since are sent, and strings are sent once and referred to by index after that.
+///
+/// The items write themselves into the packet data as before, but ask this which properties to include. What they
+/// write is staged until the packet data goes into a packet and the packet goes out, so that items thrown away when an
+/// element doesn't fit, or packets that are never sent, don't count as sent.
+class OctreeItemDeltas {
+public:
+    OctreeItemDeltas();
+
+    /// Starts an item, which is written into the packet data from its current end.
+    /// \param cube the cube of the element that holds the item, in tree units, or NULL if there is none
+    void beginItem(OctreePacketData* packetData, quint32 itemID, const AACube* cube = NULL);
+
+    /// \return true if the client hasn't been sent this value of a property of the current item
+    bool hasPropertyChanged(int property, const QByteArray& value) const;
+
+    /// Stages a value of a property of the current item, which the item wrote into the packet data.
+    void propertyWritten(int property, const QByteArray& value);
+
+    /// Appends a string property of the current item, as an index if the client has been sent the string before.
+    void appendString(QByteArray& bytes, const QString& string);
+
+    /// Called when the content of the packet data has been written into the packet, before the packet data is reset.
+    void sectionWritten(OctreePacketData* packetData);
+
+    /// Called when the packet has been sent.
+    void packetSent();
+
+    /// Called when the packet is reset without being sent.
+    void packetDropped();
+
+    /// Forgets what the client has been sent, so that items are sent whole and strings are defined again. Strings keep
+    /// their indexes, so that definitions in packets resent from before the reset still agree with the new ones.
+    void reset();
+
+    /// Forgets what the client has been sent of an item that was erased.
+    void forgetItem(quint32 itemID);
+
+    /// Forgets what the client has been sent of the items whose elements are outside a view frustum, in meters. They are
+    /// sent whole if they come back into view.
+    void forgetItemsOutside(const ViewFrustum& viewFrustum);
+
+    /// \return true if nothing has been sent or staged since the last reset()
+    bool isEmpty() const;
+
+    int getItemCount() const { return _sentItems.size(); }
+    int getStringCount() const { return _stringIndexes.size(); }
+
+    /// Appends a property of the current item to bytes, unless the client has been sent this value of it. Without deltas
+    /// the property is always appended.
+    /// \return true if the property was appended
+    static bool appendProperty(OctreeItemDeltas* deltas, QByteArray& bytes, int property, const void* value, int size);
+
+    /// Like appendProperty(), for a string, which is appended through appendString() with deltas and inline without.
+    static bool appendStringProperty(OctreeItemDeltas* deltas, QByteArray& bytes, int property, const QString& string);
+
+    /// Like appendProperty(), for a position, which is quantized into the cube of the element of the item when there are
+    /// deltas and a cube, and appendQuantizedPosition() allows it. The value the client has been sent is kept under
+    /// positionProperty either way.
+    /// \return the property that was appended, positionProperty or quantizedPositionProperty, or -1 if neither was
+    static int appendPositionProperty(OctreeItemDeltas* deltas, QByteArray& bytes, int positionProperty,
+                                      int quantizedPositionProperty, const glm::vec3& position, float radius,
+                                      const AACube* cube);
+
+    /// Appends a string property that doesn't go into a table, for encoding without a connection.
+    static void appendInlineString(QByteArray& bytes, const QString& string);
+
+    /// Quantizes a position into the cube of the element of an item, when it lies inside the cube and the steps are
+    /// small for the radius of the item.
+    /// \param quantizedPosition the position a reader of the quantized position gets
+    /// \return true if the position was quantized and appended to bytes
+    static bool appendQuantizedPosition(QByteArray& bytes, const glm::vec3& position, float radius, const AACube& cube,
+                                        glm::vec3& quantizedPosition);
+
+    /// Reads a position written by appendQuantizedPosition(), which takes QUANTIZED_POSITION_BYTES.
+    static glm::vec3 readQuantizedPosition(const unsigned char* data, const AACube& cube);
+
+private:
+    class SentItem {
+    public:
+        SentItem() : hasCube(false) { }
+
+        AACube cube;
+        bool hasCube;
+        QVector<QByteArray> properties;
+    };
+
+    class WrittenProperty {
+    public:
+        int offset;
+        quint32 itemID;
+        AACube cube;
+        bool hasCube;
+        int property;
+        QByteArray value;
+    };
+
+    class WrittenString {
+    public:
+        int offset;
+        quint16 index;
+    };
+
+    void dropRewoundWrites(OctreePacketData* packetData);
+    static void removeItemWrites(QVector<WrittenProperty>& writes, quint32 itemID);
+
+    // what the client has been sent
+    QHash<quint32, SentItem> _sentItems;
+    QHash<QString, quint16> _stringIndexes;
+    QSet<quint16> _sentStrings;
+
+    quint32 _itemID;
+    AACube _itemCube;
+    bool _itemHasCube;
+    int _itemOffset;
+
+    // staged in the packet data, by the offset of their item
+    QVector<WrittenProperty> _stagedProperties;
+    QVector<WrittenString> _stagedStrings;
+
+    // staged in the packet
+    QVector<WrittenProperty> _packetProperties;
+    QVector<WrittenString> _packetStrings;
+};
+
+/// The strings one server has sent through OctreeItemDeltas, by index.
+class OctreeReceivedStrings {
+public:
+    /// Reads a string property written by OctreeItemDeltas. Without received strings, only strings that were written in
+    /// full can be read.
+    /// \param isKnown set to false if the string refers to an index that isn't known
+    /// \return the number of bytes read, or 0 if there are too few bytes left
+    static int readString(const unsigned char* data, int bytesLeftToRead, OctreeReceivedStrings* receivedStrings,
+                          QString& string, bool& isKnown);
+
+    void clear() { _strings.clear(); }
+
+private:
+    QHash<quint16, QString> _strings;
+};
+
+#endif // hifi_OctreeItemDeltas_h
@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <climits>
+
 #include <PerfStat.h>
 #include "OctreePacketData.h"
 
@@ -38,6 +40,7 @@ void OctreePacketData::reset() {
     _subTreeAt = 0;
     _compressedBytes = 0;
     _bytesInUseLastCheck = 0;
+    _rewoundToSinceLastCheck = 0;
     _dirty = false;
 
     _bytesOfOctalCodes = 0;
@@ -157,6 +160,7 @@ void OctreePacketData::discardSubTree() {
     _bytesInUse -= bytesInSubTree;
     _bytesAvailable += bytesInSubTree; 
     _subTreeAt = _bytesInUse; // should be the same actually...
+    _rewoundToSinceLastCheck = std::min(_rewoundToSinceLastCheck, _bytesInUse);
     _dirty = true;
 
     // rewind to start of this subtree, other items rewound by endLevel()
@@ -193,6 +197,7 @@ void OctreePacketData::discardLevel(LevelDetails key) {
             
     _bytesInUse -= bytesInLevel;
     _bytesAvailable += bytesInLevel; 
+    _rewoundToSinceLastCheck = std::min(_rewoundToSinceLastCheck, _bytesInUse);
     _dirty = true;
 
     if (_debug) {
@@ -201,6 +206,12 @@ void OctreePacketData::discardLevel(LevelDetails key) {
     }
 }
 
+int OctreePacketData::getRewoundToSinceLastCheck() {
+    int rewoundTo = _rewoundToSinceLastCheck;
+    _rewoundToSinceLastCheck = INT_MAX;
+    return rewoundTo;
+}
+
 bool OctreePacketData::endLevel(LevelDetails key) {
     bool success = true;
     return success;
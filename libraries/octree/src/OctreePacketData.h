@@ -168,6 +168,10 @@ public:
     /// load finalized content to allow access to decoded content for parsing
     void loadFinalizedContent(const unsigned char* data, int length);
     
+    /// returns the lowest offset the uncompressed stream has been rewound to, by discarding or resetting, since the last
+    /// call, or INT_MAX if it hasn't been rewound. Lets the writers of the stream tell what of theirs was thrown away.
+    int getRewoundToSinceLastCheck();
+
     /// returns whether or not zlib compression enabled on finalization
     bool isCompressed() const { return _enableCompression; }
     
@@ -203,6 +207,7 @@ private:
     unsigned char _compressed[MAX_OCTREE_UNCOMRESSED_PACKET_SIZE];
     int _compressedBytes;
     int _bytesInUseLastCheck;
+    int _rewoundToSinceLastCheck;
     bool _dirty;
 
     // statistics...
@@ -0,0 +1,327 @@
+//
+//  OctreePacketPipeline.cpp
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+
+#include "OctreePacketData.h"
+#include "OctreePacketPipeline.h"
+
+// the stats are kept over windows of this many intervals of this many samples
+const int PIPELINE_STATS_INTERVAL = 16;
+const int PIPELINE_STATS_WINDOW_INTERVALS = 64;
+
+class OctreePacketDecoder : public QRunnable {
+public:
+    OctreePacketDecoder(OctreePacketPipeline* pipeline, quint64 generation, quint64 ticket, const QByteArray& packet,
+                        const SharedNodePointer& sourceNode, quint64 queuedAt) :
+        _pipeline(pipeline),
+        _generation(generation),
+        _ticket(ticket),
+        _packet(packet),
+        _sourceNode(sourceNode),
+        _queuedAt(queuedAt) {
+    }
+
+    virtual void run() {
+        _pipeline->decodePacket(_generation, _ticket, _packet, _sourceNode, _queuedAt);
+    }
+
+private:
+    OctreePacketPipeline* _pipeline;
+    quint64 _generation;
+    quint64 _ticket;
+    QByteArray _packet;
+    SharedNodePointer _sourceNode;
+    quint64 _queuedAt;
+};
+
+OctreePacketPipeline::OctreePacketPipeline() :
+    _tree(NULL),
+    _isThreaded(true),
+    _maxApplyWindowUsecs(DEFAULT_MAX_APPLY_WINDOW_USECS),
+    _mutex(),
+    _nextTicket(0),
+    _nextTicketToApply(0),
+    _decodedPackets(),
+    _generation(0),
+    _queuedPacketCount(0),
+    _maxQueuedPacketCount(0),
+    _decodedSectionCount(0),
+    _appliedSectionCount(0),
+    _applyLatencyStats(PIPELINE_STATS_INTERVAL, PIPELINE_STATS_WINDOW_INTERVALS),
+    _applyWindowStats(PIPELINE_STATS_INTERVAL, PIPELINE_STATS_WINDOW_INTERVALS),
+    _applyLatencies(),
+    _receivedStrings(),
+    _receivedStringsGeneration(0),
+    _threadPool() {
+}
+
+OctreePacketPipeline::~OctreePacketPipeline() {
+    _threadPool.waitForDone();
+}
+
+void OctreePacketPipeline::queuePacket(const QByteArray& packet, const SharedNodePointer& sourceNode) {
+    quint64 generation;
+    quint64 ticket;
+    {
+        QMutexLocker locker(&_mutex);
+        generation = _generation;
+        ticket = _nextTicket++;
+        _queuedPacketCount++;
+        _maxQueuedPacketCount = qMax(_maxQueuedPacketCount, _queuedPacketCount);
+    }
+    quint64 queuedAt = usecTimestampNow();
+    if (_isThreaded) {
+        _threadPool.start(new OctreePacketDecoder(this, generation, ticket, packet, sourceNode, queuedAt));
+    } else {
+        decodePacket(generation, ticket, packet, sourceNode, queuedAt);
+    }
+}
+
+void OctreePacketPipeline::queueEraseMessage(const QByteArray& packet, const SharedNodePointer& sourceNode) {
+    // there's nothing to decode, so the erase is ready as soon as it has its place in line
+    DecodedOctreeSection section;
+    section.isErase = true;
+    section.bitstream = packet;
+    section.isColored = false;
+    section.sourceUUID = uuidFromPacketHeader(packet);
+    section.sourceNode = sourceNode;
+    section.bitstreamVersion = 0;
+    section.queuedAt = usecTimestampNow();
+
+    QMutexLocker locker(&_mutex);
+    _queuedPacketCount++;
+    _maxQueuedPacketCount = qMax(_maxQueuedPacketCount, _queuedPacketCount);
+    _decodedPackets.insert(_nextTicket++, QVector<DecodedOctreeSection>() << section);
+    _decodedSectionCount++;
+}
+
+void OctreePacketPipeline::decodePacket(quint64 generation, quint64 ticket, const QByteArray& packet,
+                                        const SharedNodePointer& sourceNode, quint64 queuedAt) {
+    QVector<DecodedOctreeSection> sections;
+
+    unsigned int packetLength = packet.size();
+    unsigned int numBytesPacketHeader = numBytesForPacketHeader(packet);
+    QUuid sourceUUID = uuidFromPacketHeader(packet);
+
+    // the bitstream is in the format of the version the server stamped on the packet
+    PacketVersion bitstreamVersion = packet[numBytesArithmeticCodingFromBuffer(packet.data())];
+
+    const unsigned char* dataAt = reinterpret_cast<const unsigned char*>(packet.data()) + numBytesPacketHeader;
+
+    OCTREE_PACKET_FLAGS flags = (*(OCTREE_PACKET_FLAGS*)(dataAt));
+    dataAt += OCTREE_PACKET_EXTRA_HEADERS_SIZE; // the sequence number and sent time aren't needed to read the sections
+
+    bool packetIsColored = oneAtBit(flags, PACKET_IS_COLOR_BIT);
+    bool packetIsCompressed = oneAtBit(flags, PACKET_IS_COMPRESSED_BIT);
+
+    OCTREE_PACKET_INTERNAL_SECTION_SIZE sectionLength = 0;
+    unsigned int dataBytes = packetLength - (numBytesPacketHeader + OCTREE_PACKET_EXTRA_HEADERS_SIZE);
+
+    while (dataBytes > 0) {
+        if (packetIsCompressed) {
+            if (dataBytes > sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE)) {
+                sectionLength = (*(OCTREE_PACKET_INTERNAL_SECTION_SIZE*)dataAt);
+                dataAt += sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
+                dataBytes -= sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
+            } else {
+                sectionLength = 0;
+                dataBytes = 0; // stop looping something is wrong
+            }
+        } else {
+            sectionLength = dataBytes;
+        }
+
+        if (sectionLength) {
+            OctreePacketData packetData(packetIsCompressed);
+            packetData.loadFinalizedContent(dataAt, sectionLength);
+
+            DecodedOctreeSection section;
+            section.isErase = false;
+            section.bitstream = QByteArray(reinterpret_cast<const char*>(packetData.getUncompressedData()),
+                                           packetData.getUncompressedSize());
+            section.isColored = packetIsColored;
+            section.sourceUUID = sourceUUID;
+            section.sourceNode = sourceNode;
+            section.bitstreamVersion = bitstreamVersion;
+            section.queuedAt = queuedAt;
+            sections.append(section);
+
+            dataBytes -= sectionLength;
+            dataAt += sectionLength;
+        }
+    }
+
+    {
+        QMutexLocker locker(&_mutex);
+        if (generation != _generation) {
+            return; // the queue was discarded while we were decoding
+        }
+        _decodedPackets.insert(ticket, sections);
+        _decodedSectionCount += sections.size();
+    }
+    emit packetDecoded();
+}
+
+int OctreePacketPipeline::applyDecodedSections() {
+    if (!_tree) {
+        return 0;
+    }
+    int sectionsApplied = 0;
+    quint64 windowStart = 0;
+    forever {
+        DecodedOctreeSection section;
+        quint64 generation;
+        {
+            QMutexLocker locker(&_mutex);
+            QMap<quint64, QVector<DecodedOctreeSection> >::iterator packet = _decodedPackets.find(_nextTicketToApply);
+            if (packet == _decodedPackets.end()) {
+                break; // the oldest packet is still being decoded
+            }
+            if (packet.value().isEmpty()) {
+                _decodedPackets.erase(packet);
+                _nextTicketToApply++;
+                _queuedPacketCount--;
+                continue;
+            }
+            if (sectionsApplied > 0 && usecTimestampNow() - windowStart >= _maxApplyWindowUsecs) {
+                break;
+            }
+            section = packet.value().first();
+            packet.value().remove(0);
+            _decodedSectionCount--;
+            generation = _generation;
+        }
+
+        if (sectionsApplied == 0) {
+            _tree->lockForWrite();
+            windowStart = usecTimestampNow();
+
+            // the queue may have been discarded while we waited for the lock, the sections after this one were taken
+            // while we hold it, so they can't be
+            QMutexLocker locker(&_mutex);
+            if (generation != _generation) {
+                locker.unlock();
+                _tree->unlock();
+                continue;
+            }
+        }
+        if (generation != _receivedStringsGeneration) {
+            _receivedStrings.clear();
+            _receivedStringsGeneration = generation;
+        }
+        if (section.isErase) {
+            _tree->processEraseMessage(section.bitstream, section.sourceNode);
+        } else {
+            ReadBitstreamToTreeParams args(section.isColored ? WANT_COLOR : NO_COLOR, WANT_EXISTS_BITS, NULL,
+                                           section.sourceUUID, section.sourceNode, false, section.bitstreamVersion,
+                                           &_receivedStrings[section.sourceUUID]);
+            _tree->readBitstreamToTree(reinterpret_cast<const unsigned char*>(section.bitstream.constData()),
+                                       section.bitstream.size(), args);
+        }
+        sectionsApplied++;
+        _applyLatencies.append(usecTimestampNow() - section.queuedAt);
+    }
+
+    if (sectionsApplied > 0) {
+        _tree->unlock();
+        quint64 windowUsecs = usecTimestampNow() - windowStart;
+
+        QMutexLocker locker(&_mutex);
+        _appliedSectionCount += sectionsApplied;
+        _applyWindowStats.update(windowUsecs);
+        foreach (quint64 latency, _applyLatencies) {
+            _applyLatencyStats.update(latency);
+        }
+        _applyLatencies.clear();
+    }
+    return sectionsApplied;
+}
+
+void OctreePacketPipeline::flush() {
+    _threadPool.waitForDone();
+    while (applyDecodedSections() > 0) {
+        // each window lets go of the write lock before the next one takes it, so that readers get a turn
+        QThread::yieldCurrentThread();
+    }
+}
+
+void OctreePacketPipeline::discardQueued() {
+    QMutexLocker locker(&_mutex);
+    _generation++;
+    _decodedPackets.clear();
+    _nextTicketToApply = _nextTicket;
+    _queuedPacketCount = 0;
+    _decodedSectionCount = 0;
+}
+
+bool OctreePacketPipeline::hasQueuedPackets() const {
+    QMutexLocker locker(&_mutex);
+    return _queuedPacketCount > 0;
+}
+
+bool OctreePacketPipeline::isReadyToApply() const {
+    QMutexLocker locker(&_mutex);
+    return _decodedPackets.contains(_nextTicketToApply);
+}
+
+int OctreePacketPipeline::getQueuedPacketCount() const {
+    QMutexLocker locker(&_mutex);
+    return _queuedPacketCount;
+}
+
+int OctreePacketPipeline::getMaxQueuedPacketCount() const {
+    QMutexLocker locker(&_mutex);
+    return _maxQueuedPacketCount;
+}
+
+int OctreePacketPipeline::getDecodedSectionCount() const {
+    QMutexLocker locker(&_mutex);
+    return _decodedSectionCount;
+}
+
+quint64 OctreePacketPipeline::getAppliedSectionCount() const {
+    QMutexLocker locker(&_mutex);
+    return _appliedSectionCount;
+}
+
+double OctreePacketPipeline::getAverageApplyLatencyUsecs() const {
+    QMutexLocker locker(&_mutex);
+    return _applyLatencyStats.getAverage();
+}
+
+quint64 OctreePacketPipeline::getLongestApplyLatencyUsecs() const {
+    QMutexLocker locker(&_mutex);
+    return _applyLatencyStats.getMax();
+}
+
+double OctreePacketPipeline::getAverageApplyWindowUsecs() const {
+    QMutexLocker locker(&_mutex);
+    return _applyWindowStats.getAverage();
+}
+
+quint64 OctreePacketPipeline::getLongestApplyWindowUsecs() const {
+    QMutexLocker locker(&_mutex);
+    return _applyWindowStats.getMax();
+}
+
+void OctreePacketPipeline::resetStats() {
+    QMutexLocker locker(&_mutex);
+    _maxQueuedPacketCount = _queuedPacketCount;
+    _appliedSectionCount = 0;
+    _applyLatencyStats.reset();
+    _applyWindowStats.reset();
+}
@@ -0,0 +1,153 @@
+//
+//  OctreePacketPipeline.h
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreePacketPipeline_h
+#define hifi_OctreePacketPipeline_h
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QUuid>
+#include <QVector>
+
+#include <MovingMinMaxAvg.h>
+
+#include "Octree.h"
+#include "OctreeItemDeltas.h"
+
+class OctreePacketDecoder;
+
+/// One section of an octree data packet, decompressed and ready to be read into a tree. An erase packet is carried
+/// whole in a single section, so that it's applied in the same order as the data packets around it.
+class DecodedOctreeSection {
+public:
+    bool isErase;
+    QByteArray bitstream;
+    bool isColored;
+    QUuid sourceUUID;
+    SharedNodePointer sourceNode;
+    PacketVersion bitstreamVersion;
+    quint64 queuedAt;
+};
+
+/// Reads octree data packets into a tree in two stages. The threads of a pool parse the packet headers and decompress
+/// the sections of the packets as they're queued, without touching the tree. The thread that writes the tree reads the
+/// decoded sections into it, in the order their packets were queued, holding the write lock for one short window per
+/// call to applyDecodedSections(), so that rendering and picking can take the read lock in between.
+class OctreePacketPipeline : public QObject {
+    Q_OBJECT
+public:
+    static const quint64 DEFAULT_MAX_APPLY_WINDOW_USECS = 2000;
+
+    OctreePacketPipeline();
+    virtual ~OctreePacketPipeline();
+
+    /// Sets the tree the sections are read into. Packets that are still queued go to the new tree, call discardQueued()
+    /// first if they don't belong in it.
+    void setTree(Octree* tree) { _tree = tree; }
+    Octree* getTree() const { return _tree; }
+
+    /// When not threaded, packets are decoded by queuePacket() itself, on the calling thread.
+    void setIsThreaded(bool isThreaded) { _isThreaded = isThreaded; }
+    bool isThreaded() const { return _isThreaded; }
+
+    /// Sets how long one call to applyDecodedSections() holds the write lock, at most, before it lets go. A single
+    /// section is never split, so a window may run longer to read the first one.
+    void setMaxApplyWindowUsecs(quint64 maxApplyWindowUsecs) { _maxApplyWindowUsecs = maxApplyWindowUsecs; }
+    quint64 getMaxApplyWindowUsecs() const { return _maxApplyWindowUsecs; }
+
+    /// Queues a data packet to be decoded and later read into the tree. Can be called from any thread.
+    void queuePacket(const QByteArray& packet, const SharedNodePointer& sourceNode);
+
+    /// Queues an erase packet to be handed to the tree's processEraseMessage() once the data packets queued before it
+    /// are read, so that an erase can't be undone by older data that was still being decoded. Can be called from any
+    /// thread.
+    void queueEraseMessage(const QByteArray& packet, const SharedNodePointer& sourceNode);
+
+    /// Reads decoded sections into the tree, oldest first, within one write lock window. Call this from the thread
+    /// that writes the tree.
+    /// \return the number of sections read
+    int applyDecodedSections();
+
+    /// Waits for the queued packets to be decoded and reads all of them into the tree, one window at a time.
+    void flush();
+
+    /// Forgets the packets that are queued, including the ones still being decoded, along with the strings received
+    /// from the servers, so that nothing from before is read into a tree that was cleared. Call this while holding the
+    /// tree's write lock, so that a window that is being read can't read a section of the old packets after it.
+    void discardQueued();
+
+    /// \return true if any queued packets have not been read into the tree yet
+    bool hasQueuedPackets() const;
+
+    /// \return true if the oldest queued packet is decoded, so that applyDecodedSections() has work to do
+    bool isReadyToApply() const;
+
+    /// \return the number of packets queued but not read into the tree yet
+    int getQueuedPacketCount() const;
+    int getMaxQueuedPacketCount() const;
+
+    /// \return the number of sections decoded but not read into the tree yet
+    int getDecodedSectionCount() const;
+    quint64 getAppliedSectionCount() const;
+
+    /// the time from a packet being queued to its sections being read into the tree
+    double getAverageApplyLatencyUsecs() const;
+    quint64 getLongestApplyLatencyUsecs() const;
+
+    /// the time the write lock was held by one call to applyDecodedSections()
+    double getAverageApplyWindowUsecs() const;
+    quint64 getLongestApplyWindowUsecs() const;
+
+    void resetStats();
+
+signals:
+    /// Emitted from the decoding threads whenever a packet has been decoded.
+    void packetDecoded();
+
+private:
+    friend class OctreePacketDecoder;
+
+    void decodePacket(quint64 generation, quint64 ticket, const QByteArray& packet, const SharedNodePointer& sourceNode,
+                      quint64 queuedAt);
+
+    Octree* _tree;
+    bool _isThreaded;
+    quint64 _maxApplyWindowUsecs;
+
+    mutable QMutex _mutex;
+
+    // the packets are numbered in the order they're queued, and applied in that order whatever order they're decoded in
+    quint64 _nextTicket;
+    quint64 _nextTicketToApply;
+    QMap<quint64, QVector<DecodedOctreeSection> > _decodedPackets;
+
+    // bumped by discardQueued(), the packets that were decoding before are dropped when they're done
+    quint64 _generation;
+
+    int _queuedPacketCount;
+    int _maxQueuedPacketCount;
+    int _decodedSectionCount;
+    quint64 _appliedSectionCount;
+    MovingMinMaxAvg<quint64> _applyLatencyStats;
+    MovingMinMaxAvg<quint64> _applyWindowStats;
+
+    // only touched by the thread applying the sections
+    QVector<quint64> _applyLatencies;
+    QHash<QUuid, OctreeReceivedStrings> _receivedStrings; // by the server that sent them
+    quint64 _receivedStringsGeneration;
+
+    QThreadPool _threadPool;
+};
+
+#endif // hifi_OctreePacketPipeline_h
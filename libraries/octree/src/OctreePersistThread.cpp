@@ -20,7 +20,8 @@ OctreePersistThread::OctreePersistThread(Octree* tree, const QString& filename,
     _filename(filename),
     _persistInterval(persistInterval),
     _initialLoadComplete(false),
-    _loadTimeUSecs(0) 
+    _loadTimeUSecs(0),
+    _persistRequested(0)
 {
 }
 
@@ -76,7 +77,8 @@ bool OctreePersistThread::process() {
         quint64 sinceLastSave = now - _lastCheck;
         quint64 intervalToCheck = _persistInterval * MSECS_TO_USECS;
 
-        if (sinceLastSave > intervalToCheck) {
+        bool persistRequested = _persistRequested.fetchAndStoreRelaxed(0) != 0;
+        if (persistRequested || sinceLastSave > intervalToCheck) {
             // check the dirty bit and persist here...
             _lastCheck = usecTimestampNow();
             if (_tree->isDirty()) {
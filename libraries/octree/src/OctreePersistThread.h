@@ -14,6 +14,7 @@
 #ifndef hifi_OctreePersistThread_h
 #define hifi_OctreePersistThread_h
 
+#include <QAtomicInt>
 #include <QString>
 #include <GenericThread.h>
 #include "Octree.h"
@@ -29,6 +30,9 @@ public:
     bool isInitialLoadComplete() const { return _initialLoadComplete; }
     quint64 getLoadElapsedTime() const { return _loadTimeUSecs; }
 
+    /// saves the tree, if it changed, without waiting for the persist interval to pass. Can be called from any thread.
+    void persistSoon() { _persistRequested.ref(); }
+
 signals:
     void loadCompleted();
 
@@ -43,6 +47,7 @@ private:
 
     quint64 _loadTimeUSecs;
     quint64 _lastCheck;
+    QAtomicInt _persistRequested;
 };
 
 #endif // hifi_OctreePersistThread_h
@@ -27,6 +27,7 @@ OctreeQuery::OctreeQuery() :
     _wantLowResMoving(true),
     _wantOcclusionCulling(false), // disabled by default
     _wantCompression(false), // disabled by default
+    _wantItemDeltas(false), // only for clients that NACK
     _maxOctreePPS(DEFAULT_MAX_OCTREE_PPS),
     _octreeElementSizeScale(DEFAULT_OCTREE_SIZE_SCALE)
 {
@@ -62,6 +63,7 @@ int OctreeQuery::getBroadcastData(unsigned char* destinationBuffer) {
     if (_wantDelta)            { setAtBit(bitItems, WANT_DELTA_AT_BIT); }
     if (_wantOcclusionCulling) { setAtBit(bitItems, WANT_OCCLUSION_CULLING_BIT); }
     if (_wantCompression)      { setAtBit(bitItems, WANT_COMPRESSION); }
+    if (_wantItemDeltas)       { setAtBit(bitItems, WANT_ITEM_DELTAS_BIT); }
 
     *destinationBuffer++ = bitItems;
 
@@ -108,6 +110,7 @@ int OctreeQuery::parseData(const QByteArray& packet) {
     _wantDelta = oneAtBit(bitItems, WANT_DELTA_AT_BIT);
     _wantOcclusionCulling = oneAtBit(bitItems, WANT_OCCLUSION_CULLING_BIT);
     _wantCompression = oneAtBit(bitItems, WANT_COMPRESSION);
+    _wantItemDeltas = oneAtBit(bitItems, WANT_ITEM_DELTAS_BIT);
 
     // desired Max Octree PPS
     memcpy(&_maxOctreePPS, sourceBuffer, sizeof(_maxOctreePPS));
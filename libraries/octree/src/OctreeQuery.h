@@ -39,6 +39,7 @@ const int WANT_COLOR_AT_BIT = 1;
 const int WANT_DELTA_AT_BIT = 2;
 const int WANT_OCCLUSION_CULLING_BIT = 3;
 const int WANT_COMPRESSION = 4; // 5th bit
+const int WANT_ITEM_DELTAS_BIT = 5; // the client NACKs lost packets, so items can be sent as deltas
 
 class OctreeQuery : public NodeData {
     Q_OBJECT
@@ -76,6 +77,7 @@ public:
     bool getWantLowResMoving() const { return _wantLowResMoving; }
     bool getWantOcclusionCulling() const { return _wantOcclusionCulling; }
     bool getWantCompression() const { return _wantCompression; }
+    bool getWantItemDeltas() const { return _wantItemDeltas; }
     int getMaxOctreePacketsPerSecond() const { return _maxOctreePPS; }
     float getOctreeSizeScale() const { return _octreeElementSizeScale; }
     int getBoundaryLevelAdjust() const { return _boundaryLevelAdjust; }
@@ -86,6 +88,7 @@ public slots:
     void setWantDelta(bool wantDelta) { _wantDelta = wantDelta; }
     void setWantOcclusionCulling(bool wantOcclusionCulling) { _wantOcclusionCulling = wantOcclusionCulling; }
     void setWantCompression(bool wantCompression) { _wantCompression = wantCompression; }
+    void setWantItemDeltas(bool wantItemDeltas) { _wantItemDeltas = wantItemDeltas; }
     void setMaxOctreePacketsPerSecond(int maxOctreePPS) { _maxOctreePPS = maxOctreePPS; }
     void setOctreeSizeScale(float octreeSizeScale) { _octreeElementSizeScale = octreeSizeScale; }
     void setBoundaryLevelAdjust(int boundaryLevelAdjust) { _boundaryLevelAdjust = boundaryLevelAdjust; }
@@ -106,6 +109,7 @@ protected:
     bool _wantLowResMoving;
     bool _wantOcclusionCulling;
     bool _wantCompression;
+    bool _wantItemDeltas;
     int _maxOctreePPS;
     float _octreeElementSizeScale; /// used for LOD calculations
     int _boundaryLevelAdjust; /// used for LOD calculations
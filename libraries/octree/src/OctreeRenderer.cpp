@@ -19,7 +19,8 @@
 OctreeRenderer::OctreeRenderer() :
     _tree(NULL),
     _managedTree(false),
-    _viewFrustum(NULL)
+    _viewFrustum(NULL),
+    _packetPipeline()
 {
 }
 
@@ -27,6 +28,7 @@ void OctreeRenderer::init() {
     if (!_tree) {
         _tree = createTree();
         _managedTree = true;
+        _packetPipeline.setTree(_tree);
     }
 }
 
@@ -37,11 +39,18 @@ OctreeRenderer::~OctreeRenderer() {
 }
 
 void OctreeRenderer::setTree(Octree* newTree) { 
+    // what's queued was meant for the old tree
+    if (_tree) {
+        _tree->lockForWrite();
+        _packetPipeline.discardQueued();
+        _tree->unlock();
+    }
     if (_tree && _managedTree) {
         delete _tree;
         _managedTree = false;
     }
     _tree = newTree; 
+    _packetPipeline.setTree(_tree);
 }
 
 void OctreeRenderer::processDatagram(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) {
@@ -59,84 +68,32 @@ void OctreeRenderer::processDatagram(const QByteArray& dataByteArray, const Shar
     bool showTimingDetails = false; // Menu::getInstance()->isOptionChecked(MenuOption::PipelineWarnings);
     PerformanceWarning warn(showTimingDetails, "OctreeRenderer::processDatagram()",showTimingDetails);
     
-    unsigned int packetLength = dataByteArray.size();
     PacketType command = packetTypeForPacket(dataByteArray);
-    unsigned int numBytesPacketHeader = numBytesForPacketHeader(dataByteArray);
-    QUuid sourceUUID = uuidFromPacketHeader(dataByteArray);
     PacketType expectedType = getExpectedPacketType();
-    PacketVersion expectedVersion = _tree->expectedVersion(); // TODO: would be better to read this from the packet!
     
     if(command == expectedType) {
-        PerformanceWarning warn(showTimingDetails, "OctreeRenderer::processDatagram expected PacketType", showTimingDetails);
         // if we are getting inbound packets, then our tree is also viewing, and we should remember that fact.
         _tree->setIsViewing(true);
 
-        const unsigned char* dataAt = reinterpret_cast<const unsigned char*>(dataByteArray.data()) + numBytesPacketHeader;
-
-        OCTREE_PACKET_FLAGS flags = (*(OCTREE_PACKET_FLAGS*)(dataAt));
-        dataAt += sizeof(OCTREE_PACKET_FLAGS);
-        OCTREE_PACKET_SEQUENCE sequence = (*(OCTREE_PACKET_SEQUENCE*)dataAt);
-        dataAt += sizeof(OCTREE_PACKET_SEQUENCE);
-
-        OCTREE_PACKET_SENT_TIME sentAt = (*(OCTREE_PACKET_SENT_TIME*)dataAt);
-        dataAt += sizeof(OCTREE_PACKET_SENT_TIME);
-
-        bool packetIsColored = oneAtBit(flags, PACKET_IS_COLOR_BIT);
-        bool packetIsCompressed = oneAtBit(flags, PACKET_IS_COMPRESSED_BIT);
-        
-        OCTREE_PACKET_SENT_TIME arrivedAt = usecTimestampNow();
-        int clockSkew = sourceNode ? sourceNode->getClockSkewUsec() : 0;
-        int flightTime = arrivedAt - sentAt + clockSkew;
-
-        OCTREE_PACKET_INTERNAL_SECTION_SIZE sectionLength = 0;
-        unsigned int dataBytes = packetLength - (numBytesPacketHeader + OCTREE_PACKET_EXTRA_HEADERS_SIZE);
-
+        // the sections are decompressed off this thread, and read into the tree in short write lock windows
+        _packetPipeline.queuePacket(dataByteArray, sourceNode);
         if (extraDebugging) {
-            qDebug("OctreeRenderer::processDatagram() ... Got Packet Section"
-                   " color:%s compressed:%s sequence: %u flight:%d usec size:%u data:%u",
-                   debug::valueOf(packetIsColored), debug::valueOf(packetIsCompressed),
-                   sequence, flightTime, packetLength, dataBytes);
+            qDebug() << "OctreeRenderer::processDatagram() ... queued packet, size:" << dataByteArray.size()
+                << "packets in pipeline:" << _packetPipeline.getQueuedPacketCount();
         }
-        
-        int subsection = 1;
-        while (dataBytes > 0) {
-            if (packetIsCompressed) {
-                if (dataBytes > sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE)) {
-                    sectionLength = (*(OCTREE_PACKET_INTERNAL_SECTION_SIZE*)dataAt);
-                    dataAt += sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
-                    dataBytes -= sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
-                } else {
-                    sectionLength = 0;
-                    dataBytes = 0; // stop looping something is wrong
-                }
-            } else {
-                sectionLength = dataBytes;
-            }
-            
-            if (sectionLength) {
-                // ask the VoxelTree to read the bitstream into the tree
-                ReadBitstreamToTreeParams args(packetIsColored ? WANT_COLOR : NO_COLOR, WANT_EXISTS_BITS, NULL, 
-                                                sourceUUID, sourceNode, false, expectedVersion);
-                _tree->lockForWrite();
-                OctreePacketData packetData(packetIsCompressed);
-                packetData.loadFinalizedContent(dataAt, sectionLength);
-                if (extraDebugging) {
-                    qDebug("OctreeRenderer::processDatagram() ... Got Packet Section"
-                           " color:%s compressed:%s sequence: %u flight:%d usec size:%u data:%u"
-                           " subsection:%d sectionLength:%d uncompressed:%d",
-                           debug::valueOf(packetIsColored), debug::valueOf(packetIsCompressed),
-                           sequence, flightTime, packetLength, dataBytes, subsection, sectionLength,
-                           packetData.getUncompressedSize());
-                }
-                _tree->readBitstreamToTree(packetData.getUncompressedData(), packetData.getUncompressedSize(), args);
-                _tree->unlock();
-            
-                dataBytes -= sectionLength;
-                dataAt += sectionLength;
-            }
-        }
-        subsection++;
     }
+    applyQueuedPackets();
+}
+
+void OctreeRenderer::processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) {
+    if (_tree) {
+        _packetPipeline.queueEraseMessage(dataByteArray, sourceNode);
+        applyQueuedPackets();
+    }
+}
+
+int OctreeRenderer::applyQueuedPackets() {
+    return _packetPipeline.applyDecodedSections();
 }
 
 bool OctreeRenderer::renderOperation(OctreeElement* element, void* extraData) {
@@ -168,6 +125,7 @@ void OctreeRenderer::clear() {
     if (_tree) {
         _tree->lockForWrite();
         _tree->eraseAllOctreeElements(); 
+        _packetPipeline.discardQueued();
         _tree->unlock();
     }
 }
@@ -22,6 +22,7 @@
 
 #include "Octree.h"
 #include "OctreePacketData.h"
+#include "OctreePacketPipeline.h"
 #include "ViewFrustum.h"
 
 class OctreeRenderer;
@@ -45,9 +46,17 @@ public:
 
     virtual void setTree(Octree* newTree);
     
-    /// process incoming data
+    /// process incoming data: queues the packet to be decoded on the pipeline's threads, and reads whatever packets
+    /// are decoded by now into the tree
     virtual void processDatagram(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
 
+    /// process an incoming erase packet: it's queued behind the data packets that came before it, so that it's handed
+    /// to the tree's processEraseMessage() only after they are read
+    void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
+
+    OctreePacketPipeline& getPacketPipeline() { return _packetPipeline; }
+    const OctreePacketPipeline& getPacketPipeline() const { return _packetPipeline; }
+
     /// initialize and GPU/rendering related resources
     virtual void init();
 
@@ -63,10 +72,17 @@ public:
 
     /// clears the tree
     virtual void clear();
+
+public slots:
+    /// reads the decoded packets into the tree, holding the write lock for one of the pipeline's windows
+    /// \return the number of packet sections read
+    int applyQueuedPackets();
+
 protected:
     Octree* _tree;
     bool _managedTree;
     ViewFrustum* _viewFrustum;
+    OctreePacketPipeline _packetPipeline;
 };
 
 class RenderArgs {
@@ -0,0 +1,101 @@
+//
+//  SubtreeHandoff.cpp
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <OctalCode.h>
+
+#include "Octree.h"
+#include "OctreeElementBag.h"
+#include "OctreePacketData.h"
+#include "SubtreeHandoff.h"
+
+QVector<QByteArray> SubtreeHandoff::encodeSubtree(Octree* tree, const unsigned char* subtreeCode,
+                                                  JurisdictionMap* jurisdiction, int maxChunkSize) {
+    QVector<QByteArray> chunks;
+
+    VoxelPositionSize subtreeDetails;
+    voxelDetailsForCode(subtreeCode, subtreeDetails);
+
+    tree->lockForRead();
+
+    OctreeElement* subtreeElement = tree->getOctreeElementAt(subtreeDetails.x, subtreeDetails.y,
+                                                             subtreeDetails.z, subtreeDetails.s);
+    if (subtreeElement) {
+        OctreeElementBag elementBag;
+        elementBag.insert(subtreeElement);
+        OctreePacketData packetData(false, maxChunkSize);
+
+        while (!elementBag.isEmpty()) {
+            OctreeElement* subtree = elementBag.extract();
+            packetData.reset();
+
+            EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, NO_EXISTS_BITS);
+            params.jurisdictionMap = jurisdiction;
+            tree->encodeTreeBitstream(subtree, &packetData, elementBag, params);
+
+            if (packetData.getUncompressedSize() > 0) {
+                chunks.append(QByteArray(reinterpret_cast<const char*>(packetData.getUncompressedData()),
+                                         packetData.getUncompressedSize()));
+            }
+        }
+    }
+
+    tree->unlock();
+    return chunks;
+}
+
+void SubtreeHandoff::readChunk(Octree* tree, const QByteArray& chunk, const SharedNodePointer& sourceNode) {
+    QUuid sourceUUID = sourceNode ? sourceNode->getUUID() : QUuid();
+    ReadBitstreamToTreeParams args(WANT_COLOR, NO_EXISTS_BITS, NULL, sourceUUID, sourceNode,
+                                   false, tree->expectedVersion());
+    tree->lockForWrite();
+    tree->readBitstreamToTree(reinterpret_cast<const unsigned char*>(chunk.constData()), chunk.size(), args);
+    tree->unlock();
+}
+
+void SubtreeHandoff::deleteSubtree(Octree* tree, const unsigned char* subtreeCode) {
+    tree->lockForWrite();
+    tree->deleteOctalCodeFromTree(subtreeCode, COLLAPSE_EMPTY_TREE);
+    tree->unlock();
+}
+
+void SubtreeHandoff::trimToJurisdiction(Octree* tree, const JurisdictionMap& jurisdiction) {
+    const unsigned char* rootCode = jurisdiction.getRootOctalCode();
+
+    tree->lockForWrite();
+
+    if (rootCode) {
+        // walk down to the root, deleting the branches we don't take
+        unsigned char* ancestorCode = new unsigned char[1];
+        ancestorCode[0] = 0;
+
+        int rootLevel = numberOfThreeBitSectionsInCode(rootCode);
+        for (int level = 0; level < rootLevel; level++) {
+            char pathIndex = getOctalCodeSectionValue(rootCode, level);
+            for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+                if (i != pathIndex) {
+                    unsigned char* siblingCode = childOctalCode(ancestorCode, i);
+                    tree->deleteOctalCodeFromTree(siblingCode, COLLAPSE_EMPTY_TREE);
+                    delete[] siblingCode;
+                }
+            }
+            unsigned char* pathCode = childOctalCode(ancestorCode, pathIndex);
+            delete[] ancestorCode;
+            ancestorCode = pathCode;
+        }
+        delete[] ancestorCode;
+    }
+
+    for (int i = 0; i < jurisdiction.getEndNodeCount(); i++) {
+        tree->deleteOctalCodeFromTree(jurisdiction.getEndNodeOctalCode(i), COLLAPSE_EMPTY_TREE);
+    }
+
+    tree->unlock();
+}
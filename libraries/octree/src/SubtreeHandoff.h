@@ -0,0 +1,44 @@
+//
+//  SubtreeHandoff.h
+//  libraries/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SubtreeHandoff_h
+#define hifi_SubtreeHandoff_h
+
+#include <QtCore/QByteArray>
+#include <QtCore/QVector>
+
+#include <Node.h>
+
+#include "JurisdictionMap.h"
+
+class Octree;
+
+/// Moves a subtree from the tree of one octree server to the tree of another, when a busy server hands part of its
+/// jurisdiction off. The methods lock the tree they work on.
+class SubtreeHandoff {
+public:
+    /// Encodes the part of the subtree that is within the jurisdiction, all of it if the jurisdiction is NULL, into
+    /// bitstream chunks of at most maxChunkSize bytes.
+    static QVector<QByteArray> encodeSubtree(Octree* tree, const unsigned char* subtreeCode,
+                                             JurisdictionMap* jurisdiction, int maxChunkSize);
+
+    /// Reads a chunk made by encodeSubtree() into the tree. Each chunk starts with the octal code of the element it
+    /// encodes, so chunks can be read in any order, and reading one again does no harm.
+    static void readChunk(Octree* tree, const QByteArray& chunk, const SharedNodePointer& sourceNode);
+
+    static void deleteSubtree(Octree* tree, const unsigned char* subtreeCode);
+
+    /// Deletes everything outside the jurisdiction from the tree: the siblings of the root and of its ancestors, and
+    /// the subtrees at the end nodes. Edits that were meant for another server can land there.
+    static void trimToJurisdiction(Octree* tree, const JurisdictionMap& jurisdiction);
+};
+
+#endif // hifi_SubtreeHandoff_h
@@ -17,6 +17,8 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <QtGlobal>
+
 #include "AABox.h"
 #include "AACube.h"
 #include "Plane.h"
@@ -30,6 +32,9 @@ const float DEFAULT_ASPECT_RATIO = 16.f/9.f;
 const float DEFAULT_NEAR_CLIP = 0.08f;
 const float DEFAULT_FAR_CLIP = 50.0f * TREE_SCALE;
 
+// the most cubes ViewFrustum::cubesInFrustum() tests in one batch, one bit of each mask per cube
+const int MAX_CUBE_BATCH_SIZE = 32;
+
 class ViewFrustum {
 public:
     // setters for camera attributes
@@ -93,11 +98,26 @@ public:
 
     typedef enum {OUTSIDE, INTERSECT, INSIDE} location;
 
+    /// The locations of a batch of cubes. Bit i of the masks stands for the i-th cube, and is set in exactly one of them.
+    class LocationMasks {
+    public:
+        quint32 inside;
+        quint32 intersect;
+        quint32 outside;
+
+        ViewFrustum::location getLocation(int index) const;
+        quint32 getInViewMask() const { return inside | intersect; }
+    };
+
     ViewFrustum::location pointInFrustum(const glm::vec3& point) const;
     ViewFrustum::location sphereInFrustum(const glm::vec3& center, float radius) const;
     ViewFrustum::location cubeInFrustum(const AACube& cube) const;
     ViewFrustum::location boxInFrustum(const AABox& box) const;
 
+    /// Gives each of up to MAX_CUBE_BATCH_SIZE cubes the location cubeInFrustum() would, testing the batch plane by plane
+    /// rather than cube by cube.
+    ViewFrustum::LocationMasks cubesInFrustum(const AACube* cubes, int count) const;
+
     // some frustum comparisons
     bool matches(const ViewFrustum& compareTo, bool debug = false) const;
     bool matches(const ViewFrustum* compareTo, bool debug = false) const { return matches(*compareTo, debug); }
@@ -124,6 +144,7 @@ private:
     ViewFrustum::location pointInKeyhole(const glm::vec3& point) const;
     ViewFrustum::location sphereInKeyhole(const glm::vec3& center, float radius) const;
     ViewFrustum::location cubeInKeyhole(const AACube& cube) const;
+    ViewFrustum::location cubeInKeyholeSphere(const AACube& cube) const;
     ViewFrustum::location boxInKeyhole(const AABox& box) const;
 
     void calculateOrthographic();
@@ -12,6 +12,7 @@
 #include <QtCore/QObject>
 
 #include <Octree.h>
+#include <OctreeItemDeltas.h>
 #include <RegisteredMetaTypes.h>
 #include <SharedUtil.h> // usecTimestampNow()
 #include <VoxelsScriptingInterface.h>
@@ -66,6 +67,28 @@ void Particle::handleAddParticleResponse(const QByteArray& packet) {
     _tokenIDsToIDs[creatorTokenID] = particleID;
 }
 
+// the properties of a particle read in full, or made locally
+static ParticleItemPropertyFlags allParticleItemProperties() {
+    ParticleItemPropertyFlags properties;
+    for (int i = 0; i < PARTICLE_ITEM_PROP_COUNT; i++) {
+        if (i != PARTICLE_ITEM_PROP_QUANTIZED_POSITION) {
+            properties.setHasProperty((ParticleItemPropertyList)i);
+        }
+    }
+    return properties;
+}
+
+// reads a property of a fixed size, unless there are too few bytes left for it
+static bool readProperty(const unsigned char*& dataAt, int& bytesLeftToRead, void* value, int size) {
+    if (bytesLeftToRead < size) {
+        return false;
+    }
+    memcpy(value, dataAt, size);
+    dataAt += size;
+    bytesLeftToRead -= size;
+    return true;
+}
+
 Particle::Particle() {
     rgbColor noColor = { 0, 0, 0 };
     init(glm::vec3(0,0,0), 0, noColor, glm::vec3(0,0,0),
@@ -98,6 +121,8 @@ Particle::Particle(const ParticleID& particleID, const ParticleProperties& prope
     _modelTranslation = DEFAULT_MODEL_TRANSLATION;
     _modelRotation = DEFAULT_MODEL_ROTATION;
     _modelScale = DEFAULT_MODEL_SCALE;
+    _readProperties = allParticleItemProperties();
+    _lastPartiallyEdited = 0;
     
     setProperties(properties);
 }
@@ -134,6 +159,8 @@ void Particle::init(glm::vec3 position, float radius, rgbColor color, glm::vec3
     _modelTranslation = DEFAULT_MODEL_TRANSLATION;
     _modelRotation = DEFAULT_MODEL_ROTATION;
     _modelScale = DEFAULT_MODEL_SCALE;
+    _readProperties = allParticleItemProperties();
+    _lastPartiallyEdited = 0;
 }
 
 void Particle::setMass(float value) {
@@ -142,82 +169,107 @@ void Particle::setMass(float value) {
     }
 }
 
-bool Particle::appendParticleData(OctreePacketData* packetData) const {
-
-    bool success = packetData->appendValue(getID());
+bool Particle::appendParticleData(OctreePacketData* packetData, OctreeItemDeltas* deltas,
+                                  const AACube* containingCube) const {
+    if (deltas) {
+        deltas->beginItem(packetData, getID(), containingCube);
+    }
 
-    //qDebug("Particle::appendParticleData()... getID()=%d", getID());
+    // the properties follow their flags, so they're collected before anything is appended
+    ParticleItemPropertyFlags propertyFlags;
+    QByteArray propertyBytes;
 
-    if (success) {
-        success = packetData->appendValue(getAge());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_RADIUS, &_radius, sizeof(_radius))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_RADIUS);
     }
-    if (success) {
-        success = packetData->appendValue(getLastUpdated());
+    int positionProperty = OctreeItemDeltas::appendPositionProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_POSITION,
+        PARTICLE_ITEM_PROP_QUANTIZED_POSITION, _position, _radius, containingCube);
+    if (positionProperty != -1) {
+        propertyFlags.setHasProperty((ParticleItemPropertyList)positionProperty);
     }
-    if (success) {
-        success = packetData->appendValue(getLastEdited());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_COLOR, _color, sizeof(_color))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_COLOR);
     }
-    if (success) {
-        success = packetData->appendValue(getRadius());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_VELOCITY, &_velocity,
+                                         sizeof(_velocity))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_VELOCITY);
     }
-    if (success) {
-        success = packetData->appendPosition(getPosition());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_GRAVITY, &_gravity, sizeof(_gravity))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_GRAVITY);
     }
-    if (success) {
-        success = packetData->appendColor(getColor());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_DAMPING, &_damping, sizeof(_damping))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_DAMPING);
     }
-    if (success) {
-        success = packetData->appendValue(getVelocity());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_LIFETIME, &_lifetime,
+                                         sizeof(_lifetime))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_LIFETIME);
     }
-    if (success) {
-        success = packetData->appendValue(getGravity());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_IN_HAND, &_inHand, sizeof(_inHand))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_IN_HAND);
     }
-    if (success) {
-        success = packetData->appendValue(getDamping());
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_SHOULD_DIE, &_shouldDie,
+                                         sizeof(_shouldDie))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_SHOULD_DIE);
     }
-    if (success) {
-        success = packetData->appendValue(getLifetime());
+
+    // script
+    if (OctreeItemDeltas::appendStringProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_SCRIPT, _script)) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_SCRIPT);
     }
-    if (success) {
-        success = packetData->appendValue(getInHand());
+
+    // modelURL
+    if (OctreeItemDeltas::appendStringProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_MODEL_URL, _modelURL)) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_MODEL_URL);
     }
-    if (success) {
-        success = packetData->appendValue(getShouldDie());
+
+    // modelScale, modelTranslation, modelRotation
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_MODEL_SCALE, &_modelScale,
+                                         sizeof(_modelScale))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_MODEL_SCALE);
     }
-    if (success) {
-        uint16_t scriptLength = _script.size() + 1; // include NULL
-        success = packetData->appendValue(scriptLength);
-        if (success) {
-            success = packetData->appendRawData((const unsigned char*)qPrintable(_script), scriptLength);
-        }
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_MODEL_TRANSLATION, &_modelTranslation,
+                                         sizeof(_modelTranslation))) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_MODEL_TRANSLATION);
+    }
+    // packed into the same 8 bytes OctreePacketData::appendValue(glm::quat) has always written, in files too
+    unsigned char packedRotation[sizeof(glm::quat)];
+    int packedRotationBytes = packOrientationQuatToBytes(packedRotation, _modelRotation);
+    if (OctreeItemDeltas::appendProperty(deltas, propertyBytes, PARTICLE_ITEM_PROP_MODEL_ROTATION, packedRotation,
+                                         packedRotationBytes)) {
+        propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_MODEL_ROTATION);
     }
 
-    // modelURL
+    bool success = packetData->appendValue(getID());
+
+    //qDebug("Particle::appendParticleData()... getID()=%d", getID());
+
     if (success) {
-        uint16_t modelURLLength = _modelURL.size() + 1; // include NULL
-        success = packetData->appendValue(modelURLLength);
-        if (success) {
-            success = packetData->appendRawData((const unsigned char*)qPrintable(_modelURL), modelURLLength);
-        }
+        success = packetData->appendValue(getAge());
     }
-
-    // modelScale
     if (success) {
-        success = packetData->appendValue(getModelScale());
+        success = packetData->appendValue(getLastUpdated());
     }
-
-    // modelTranslation
     if (success) {
-        success = packetData->appendValue(getModelTranslation());
+        success = packetData->appendValue(getLastEdited());
+    }
+    if (success) {
+        QByteArray encodedFlags = propertyFlags.encode();
+        success = packetData->appendRawData((const unsigned char*)encodedFlags.constData(), encodedFlags.size());
     }
-    // modelRotation
     if (success) {
-        success = packetData->appendValue(getModelRotation());
+        success = packetData->appendRawData((const unsigned char*)propertyBytes.constData(), propertyBytes.size());
     }
     return success;
 }
 
-int Particle::expectedBytes() {
+int Particle::expectedBytes(PacketVersion bitstreamVersion) {
+    if (bitstreamVersion >= VERSION_PARTICLES_HAVE_PROPERTY_FLAGS) {
+        return sizeof(uint32_t) // id
+                + sizeof(float) // age
+                + sizeof(quint64) // last updated
+                + sizeof(quint64) // lasted edited
+                + 1; // property flags, at least
+    }
     int expectedBytes = sizeof(uint32_t) // id
                 + sizeof(float) // age
                 + sizeof(quint64) // last updated
@@ -234,9 +286,135 @@ int Particle::expectedBytes() {
     return expectedBytes;
 }
 
-int Particle::readParticleDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args) {
+int Particle::readParticleDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args,
+                                         const AACube* containingCube) {
+    if (args.bitstreamVersion < VERSION_PARTICLES_HAVE_PROPERTY_FLAGS) {
+        return readParticleDataWithoutPropertyFlags(data, bytesLeftToRead, args);
+    }
+    if (bytesLeftToRead < expectedBytes(args.bitstreamVersion)) {
+        return 0;
+    }
+    int clockSkew = args.sourceNode ? args.sourceNode->getClockSkewUsec() : 0;
+
+    const unsigned char* dataAt = data;
+    int bytesLeft = bytesLeftToRead;
+
+    // id, age, _lastUpdated, _lastEdited
+    readProperty(dataAt, bytesLeft, &_id, sizeof(_id));
+    float age;
+    readProperty(dataAt, bytesLeft, &age, sizeof(age));
+    setAge(age);
+    readProperty(dataAt, bytesLeft, &_lastUpdated, sizeof(_lastUpdated));
+    _lastUpdated -= clockSkew;
+    readProperty(dataAt, bytesLeft, &_lastEdited, sizeof(_lastEdited));
+    _lastEdited -= clockSkew;
+
+    ParticleItemPropertyFlags propertyFlags;
+    int bytes = propertyFlags.decode(dataAt, bytesLeft);
+    if (bytes > bytesLeft) {
+        return 0;
+    }
+    dataAt += bytes;
+    bytesLeft -= bytes;
+
+    bool isComplete = true;
+    if (propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_RADIUS)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_radius, sizeof(_radius));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_POSITION)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_position, sizeof(_position));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_QUANTIZED_POSITION)) {
+        isComplete = containingCube && bytesLeft >= QUANTIZED_POSITION_BYTES;
+        if (isComplete) {
+            _position = OctreeItemDeltas::readQuantizedPosition(dataAt, *containingCube);
+            dataAt += QUANTIZED_POSITION_BYTES;
+            bytesLeft -= QUANTIZED_POSITION_BYTES;
+            propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_POSITION);
+        }
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_COLOR)) {
+        isComplete = readProperty(dataAt, bytesLeft, _color, sizeof(_color));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_VELOCITY)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_velocity, sizeof(_velocity));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_GRAVITY)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_gravity, sizeof(_gravity));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_DAMPING)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_damping, sizeof(_damping));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_LIFETIME)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_lifetime, sizeof(_lifetime));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_IN_HAND)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_inHand, sizeof(_inHand));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_SHOULD_DIE)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_shouldDie, sizeof(_shouldDie));
+    }
+
+    // script, which is left out of the properties that were read if it refers to a string that isn't known
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_SCRIPT)) {
+        QString script;
+        bool isKnown = false;
+        bytes = OctreeReceivedStrings::readString(dataAt, bytesLeft, args.receivedStrings, script, isKnown);
+        isComplete = bytes > 0;
+        dataAt += bytes;
+        bytesLeft -= bytes;
+        if (isKnown) {
+            _script = script;
+        } else {
+            propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_SCRIPT, false);
+        }
+    }
+
+    // modelURL
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_MODEL_URL)) {
+        QString modelURL;
+        bool isKnown = false;
+        bytes = OctreeReceivedStrings::readString(dataAt, bytesLeft, args.receivedStrings, modelURL, isKnown);
+        isComplete = bytes > 0;
+        dataAt += bytes;
+        bytesLeft -= bytes;
+        if (isKnown) {
+            _modelURL = modelURL;
+        } else {
+            propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_MODEL_URL, false);
+        }
+    }
+
+    // modelScale, modelTranslation, modelRotation
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_MODEL_SCALE)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_modelScale, sizeof(_modelScale));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_MODEL_TRANSLATION)) {
+        isComplete = readProperty(dataAt, bytesLeft, &_modelTranslation, sizeof(_modelTranslation));
+    }
+    if (isComplete && propertyFlags.getHasProperty(PARTICLE_ITEM_PROP_MODEL_ROTATION)) {
+        const int PACKED_ROTATION_BYTES = 4 * sizeof(uint16_t);
+        isComplete = bytesLeft >= PACKED_ROTATION_BYTES;
+        if (isComplete) {
+            bytes = unpackOrientationQuatFromBytes(dataAt, _modelRotation);
+            dataAt += bytes;
+            bytesLeft -= bytes;
+        }
+    }
+
+    if (!isComplete) {
+        return 0;
+    }
+    propertyFlags.setHasProperty(PARTICLE_ITEM_PROP_QUANTIZED_POSITION, false);
+    _readProperties = propertyFlags;
+    return bytesLeftToRead - bytesLeft;
+}
+
+int Particle::readParticleDataWithoutPropertyFlags(const unsigned char* data, int bytesLeftToRead,
+                                                   ReadBitstreamToTreeParams& args) {
     int bytesRead = 0;
-    if (bytesLeftToRead >= expectedBytes()) {
+    if (bytesLeftToRead >= expectedBytes(args.bitstreamVersion)) {
+        _readProperties = allParticleItemProperties();
         int clockSkew = args.sourceNode ? args.sourceNode->getClockSkewUsec() : 0;
 
         const unsigned char* dataAt = data;
@@ -1021,10 +1199,77 @@ void Particle::setAge(float age) {
     _created = usecTimestampNow() - ageInUsecs;
 }
 
+bool Particle::wasReadWhole() const {
+    return _readProperties == allParticleItemProperties();
+}
+
 void Particle::copyChangedProperties(const Particle& other) {
     float age = getAge();
-    *this = other;
-    setAge(age);
+    ParticleItemPropertyFlags properties = other._readProperties;
+
+    // the properties we took from updates that left the others out are newer than what an older update has for them
+    bool isOlderThanPartialUpdates = other._lastEdited < _lastPartiallyEdited;
+    if (other.wasReadWhole() && !isOlderThanPartialUpdates) {
+        *this = other;
+        setAge(age);
+        return;
+    }
+    if (isOlderThanPartialUpdates) {
+        properties -= _partiallyReadProperties;
+    }
+
+    _lastUpdated = other._lastUpdated;
+    if (other.wasReadWhole()) {
+        // we have all of the particle as of this edit, apart from the properties of the newer partial updates
+        _lastEdited = other._lastEdited;
+    } else {
+        // The properties an update left out may have changed in the same edit, so an older update that has them still
+        // has to be taken. Only a whole update tells us we're up to date as of its edit.
+        _partiallyReadProperties += other._readProperties;
+        _lastPartiallyEdited = qMax(_lastPartiallyEdited, other._lastEdited);
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_RADIUS)) {
+        _radius = other._radius;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_POSITION)) {
+        _position = other._position;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_COLOR)) {
+        memcpy(_color, other._color, sizeof(_color));
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_VELOCITY)) {
+        _velocity = other._velocity;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_GRAVITY)) {
+        _gravity = other._gravity;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_DAMPING)) {
+        _damping = other._damping;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_LIFETIME)) {
+        _lifetime = other._lifetime;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_IN_HAND)) {
+        _inHand = other._inHand;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_SHOULD_DIE)) {
+        _shouldDie = other._shouldDie;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_SCRIPT)) {
+        _script = other._script;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_MODEL_URL)) {
+        _modelURL = other._modelURL;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_MODEL_SCALE)) {
+        _modelScale = other._modelScale;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_MODEL_TRANSLATION)) {
+        _modelTranslation = other._modelTranslation;
+    }
+    if (properties.getHasProperty(PARTICLE_ITEM_PROP_MODEL_ROTATION)) {
+        _modelRotation = other._modelRotation;
+    }
 }
 
 ParticleProperties Particle::getProperties() const {
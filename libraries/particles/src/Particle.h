@@ -21,7 +21,9 @@
 #include <CollisionInfo.h>
 #include <SharedUtil.h>
 #include <OctreePacketData.h>
+#include <PropertyFlags.h>
 
+class OctreeItemDeltas;
 class Particle;
 class ParticleEditPacketSender;
 class ParticleProperties;
@@ -65,6 +67,30 @@ const float DEFAULT_MODEL_SCALE = 1.0f;
 const bool IN_HAND = true; // it's in a hand
 const bool NOT_IN_HAND = !IN_HAND; // it's not in a hand
 
+const PacketVersion VERSION_PARTICLES_HAVE_PROPERTY_FLAGS = 2;
+
+/// The properties of a particle in a particle data packet, which only holds the properties that are included in its flags.
+enum ParticleItemPropertyList {
+    PARTICLE_ITEM_PROP_RADIUS,
+    PARTICLE_ITEM_PROP_POSITION,
+    PARTICLE_ITEM_PROP_QUANTIZED_POSITION, // the position relative to the cube of the element, instead of the position
+    PARTICLE_ITEM_PROP_COLOR,
+    PARTICLE_ITEM_PROP_VELOCITY,
+    PARTICLE_ITEM_PROP_GRAVITY,
+    PARTICLE_ITEM_PROP_DAMPING,
+    PARTICLE_ITEM_PROP_LIFETIME,
+    PARTICLE_ITEM_PROP_IN_HAND,
+    PARTICLE_ITEM_PROP_SHOULD_DIE,
+    PARTICLE_ITEM_PROP_SCRIPT,
+    PARTICLE_ITEM_PROP_MODEL_URL,
+    PARTICLE_ITEM_PROP_MODEL_SCALE,
+    PARTICLE_ITEM_PROP_MODEL_TRANSLATION,
+    PARTICLE_ITEM_PROP_MODEL_ROTATION,
+    PARTICLE_ITEM_PROP_COUNT
+};
+
+typedef PropertyFlags<ParticleItemPropertyList> ParticleItemPropertyFlags;
+
 /// A collection of properties of a particle used in the scripting API. Translates between the actual properties of a particle
 /// and a JavaScript style hash/QScriptValue storing a set of properties. Used in scripting to set/get the complete set of
 /// particle properties via JavaScript hashes/QScriptValues
@@ -285,9 +311,13 @@ public:
     
     void setProperties(const ParticleProperties& properties);
 
-    bool appendParticleData(OctreePacketData* packetData) const;
-    int readParticleDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args);
-    static int expectedBytes();
+    /// Appends the particle to packet data. With deltas, only the properties the client hasn't been sent are included,
+    /// and the position is quantized into the containing cube of the element when that keeps it accurate.
+    bool appendParticleData(OctreePacketData* packetData, OctreeItemDeltas* deltas = NULL,
+                            const AACube* containingCube = NULL) const;
+    int readParticleDataFromBuffer(const unsigned char* data, int bytesLeftToRead, ReadBitstreamToTreeParams& args,
+                                   const AACube* containingCube = NULL);
+    static int expectedBytes(PacketVersion bitstreamVersion);
 
     static bool encodeParticleEditMessageDetails(PacketType command, ParticleID id, const ParticleProperties& details,
                         unsigned char* bufferOut, int sizeIn, int& sizeOut);
@@ -302,9 +332,13 @@ public:
 
     void debugDump() const;
 
-    // similar to assignment/copy, but it handles keeping lifetime accurate
+    // similar to assignment/copy, but it handles keeping lifetime accurate, and only copies the properties that were read
+    // into the other particle
     void copyChangedProperties(const Particle& other);
 
+    // whether the particle was last read with all of its properties, rather than only the ones that changed
+    bool wasReadWhole() const;
+
     static VoxelEditPacketSender* getVoxelEditPacketSender() { return _voxelEditSender; }
     static ParticleEditPacketSender* getParticleEditPacketSender() { return _particleEditSender; }
 
@@ -329,6 +363,8 @@ protected:
     void executeUpdateScripts();
 
     void setAge(float age);
+    int readParticleDataWithoutPropertyFlags(const unsigned char* data, int bytesLeftToRead,
+                                             ReadBitstreamToTreeParams& args);
 
     glm::vec3 _position;
     rgbColor _color;
@@ -359,6 +395,12 @@ protected:
     // this doesn't go on the wire, we send it as lifetime
     quint64 _created;
 
+    ParticleItemPropertyFlags _readProperties;
+
+    // the properties taken from updates that left others out, and the newest edit among them
+    ParticleItemPropertyFlags _partiallyReadProperties;
+    quint64 _lastPartiallyEdited;
+
     // used by the static interfaces for creator token ids
     static uint32_t _nextCreatorTokenID;
     static std::map<uint32_t,uint32_t> _tokenIDsToIDs;
@@ -15,6 +15,7 @@
 #include <AvatarData.h>
 #include <HeadData.h>
 #include <HandData.h>
+#include <ShapeCollider.h>
 
 #include "Particle.h"
 #include "ParticleCollisionSystem.h"
@@ -23,6 +24,11 @@
 
 const int MAX_COLLISIONS_PER_PARTICLE = 16;
 
+// the broadphase groups: particles collide with particles and avatars, particles in hand only with particles, and
+// avatars only with particles
+const quint32 PARTICLE_COLLISION_GROUP = 1 << 0;
+const quint32 AVATAR_COLLISION_GROUP = 1 << 1;
+
 ParticleCollisionSystem::ParticleCollisionSystem(ParticleEditPacketSender* packetSender,
     ParticleTree* particles, VoxelTree* voxels, AbstractAudioInterface* audio,
     AvatarHashMap* avatars) : _collisions(MAX_COLLISIONS_PER_PARTICLE) {
@@ -42,7 +48,7 @@ void ParticleCollisionSystem::init(ParticleEditPacketSender* packetSender,
 ParticleCollisionSystem::~ParticleCollisionSystem() {
 }
 
-bool ParticleCollisionSystem::updateOperation(OctreeElement* element, void* extraData) {
+bool ParticleCollisionSystem::addParticlesOperation(OctreeElement* element, void* extraData) {
     ParticleCollisionSystem* system = static_cast<ParticleCollisionSystem*>(extraData);
     ParticleTreeElement* particleTreeElement = static_cast<ParticleTreeElement*>(element);
 
@@ -51,7 +57,11 @@ bool ParticleCollisionSystem::updateOperation(OctreeElement* element, void* extr
     uint16_t numberOfParticles = particles.size();
     for (uint16_t i = 0; i < numberOfParticles; i++) {
         Particle* particle = &particles[i];
-        system->checkParticle(particle);
+        quint32 mask = particle->getInHand() ? PARTICLE_COLLISION_GROUP : (PARTICLE_COLLISION_GROUP | AVATAR_COLLISION_GROUP);
+        system->_broadphase.addSphere(particle->getPosition() * (float)(TREE_SCALE),
+                                      particle->getRadius() * (float)(TREE_SCALE), PARTICLE_COLLISION_GROUP, mask);
+        system->_broadphaseParticles.push_back(particle);
+        system->_broadphaseAvatars.push_back(NULL);
     }
 
     return true;
@@ -61,7 +71,41 @@ bool ParticleCollisionSystem::updateOperation(OctreeElement* element, void* extr
 void ParticleCollisionSystem::update() {
     // update all particles
     if (_particles->tryLockForRead()) {
-        _particles->recurseTreeWithOperation(updateOperation, this);
+        _broadphase.clear();
+        _broadphaseParticles.resize(0);
+        _broadphaseAvatars.resize(0);
+
+        _particles->recurseTreeWithOperation(addParticlesOperation, this);
+        int numParticles = _broadphaseParticles.size();
+
+        if (_avatars && numParticles > 0) {
+            foreach (const AvatarSharedPointer& avatarPointer, _avatars->getAvatarHash()) {
+                AvatarData* avatar = avatarPointer.data();
+                _broadphase.addSphere(avatar->getPosition(), avatar->getBoundingRadius(),
+                                      AVATAR_COLLISION_GROUP, PARTICLE_COLLISION_GROUP);
+                _broadphaseParticles.push_back(NULL);
+                _broadphaseAvatars.push_back(avatar);
+            }
+        }
+
+        // the voxels are a tree of their own, each particle still asks it directly
+        for (int i = 0; i < numParticles; i++) {
+            updateCollisionWithVoxels(_broadphaseParticles.at(i));
+        }
+
+        // the pairs come from the positions at the start of the update, the narrowphase uses the current ones
+        const QVector<SweepAndPrunePair>& pairs = _broadphase.findOverlappingPairs();
+        foreach (const SweepAndPrunePair& pair, pairs) {
+            Particle* particleA = _broadphaseParticles.at(pair.firstIndex);
+            Particle* particleB = _broadphaseParticles.at(pair.secondIndex);
+            if (particleA && particleB) {
+                updateCollisionWithParticle(particleA, particleB);
+            } else if (particleA) {
+                updateCollisionWithAvatar(particleA, _broadphaseAvatars.at(pair.secondIndex));
+            } else {
+                updateCollisionWithAvatar(particleB, _broadphaseAvatars.at(pair.firstIndex));
+            }
+        }
         _particles->unlock();
     }
 }
@@ -123,13 +167,26 @@ void ParticleCollisionSystem::updateCollisionWithVoxels(Particle* particle) {
 void ParticleCollisionSystem::updateCollisionWithParticles(Particle* particleA) {
     glm::vec3 center = particleA->getPosition() * (float)(TREE_SCALE);
     float radius = particleA->getRadius() * (float)(TREE_SCALE);
-    //const float ELASTICITY = 0.4f;
-    //const float DAMPING = 0.0f;
-    const float COLLISION_FREQUENCY = 0.5f;
     glm::vec3 penetration;
     Particle* particleB;
     if (_particles->findSpherePenetration(center, radius, penetration, (void**)&particleB, Octree::NoLock)) {
+        updateCollisionWithParticle(particleA, particleB);
+    }
+}
+
+void ParticleCollisionSystem::updateCollisionWithParticle(Particle* particleA, Particle* particleB) {
+    //const float ELASTICITY = 0.4f;
+    //const float DAMPING = 0.0f;
+    const float COLLISION_FREQUENCY = 0.5f;
+
+    SphereShape sphereA(particleA->getRadius(), particleA->getPosition());
+    SphereShape sphereB(particleB->getRadius(), particleB->getPosition());
+    _collisions.clear();
+    if (ShapeCollider::sphereSphere(&sphereA, &sphereB, _collisions)) {
         // NOTE: 'penetration' is the depth that 'particleA' overlaps 'particleB'.  It points from A into B.
+        // The spheres are in the octree reference frame, so we multiply by TREE_SCALE to hand the penetration to the
+        // scripts and the collision sound in world units, the same as findSpherePenetration() used to give it to us.
+        glm::vec3 penetration = (float)TREE_SCALE * _collisions.getCollision(0)->_penetration;
 
         // Even if the particles overlap... when the particles are already moving appart
         // we don't want to count this as a collision.
@@ -147,6 +204,9 @@ void ParticleCollisionSystem::updateCollisionWithParticles(Particle* particleA)
             glm::vec3 axis = glm::normalize(penetration);
             glm::vec3 axialVelocity = glm::dot(relativeVelocity, axis) * axis;
 
+            // we must scale back down to the octree reference frame before separating the particles
+            glm::vec3 treePenetration = penetration / (float)TREE_SCALE;
+
             // particles that are in hand are assigned an ureasonably large mass for collisions
             // which effectively makes them immovable but allows the other ball to reflect correctly.
             const float MAX_MASS = 1.0e6f;
@@ -156,7 +216,7 @@ void ParticleCollisionSystem::updateCollisionWithParticles(Particle* particleA)
 
             // handle particle A
             particleA->setVelocity(particleA->getVelocity() - axialVelocity * (2.0f * massB / totalMass));
-            particleA->setPosition(particleA->getPosition() - 0.5f * penetration);
+            particleA->setPosition(particleA->getPosition() - 0.5f * treePenetration);
             ParticleProperties propertiesA;
             ParticleID idA(particleA->getID());
             propertiesA.copyFromParticle(*particleA);
@@ -166,7 +226,7 @@ void ParticleCollisionSystem::updateCollisionWithParticles(Particle* particleA)
 
             // handle particle B
             particleB->setVelocity(particleB->getVelocity() + axialVelocity * (2.0f * massA / totalMass));
-            particleA->setPosition(particleB->getPosition() + 0.5f * penetration);
+            particleB->setPosition(particleB->getPosition() + 0.5f * treePenetration);
             ParticleProperties propertiesB;
             ParticleID idB(particleB->getID());
             propertiesB.copyFromParticle(*particleB);
@@ -192,12 +252,7 @@ void ParticleCollisionSystem::updateCollisionWithAvatars(Particle* particle) {
 
     glm::vec3 center = particle->getPosition() * (float)(TREE_SCALE);
     float radius = particle->getRadius() * (float)(TREE_SCALE);
-    const float ELASTICITY = 0.9f;
-    const float DAMPING = 0.1f;
-    const float COLLISION_FREQUENCY = 0.5f;
-    glm::vec3 penetration;
 
-    _collisions.clear();
     foreach (const AvatarSharedPointer& avatarPointer, _avatars->getAvatarHash()) {
         AvatarData* avatar = avatarPointer.data();
 
@@ -206,25 +261,35 @@ void ParticleCollisionSystem::updateCollisionWithAvatars(Particle* particle) {
         if (glm::dot(relativePosition, relativePosition) > (totalRadius * totalRadius)) {
             continue;
         }
+        updateCollisionWithAvatar(particle, avatar);
+    }
+}
+
+void ParticleCollisionSystem::updateCollisionWithAvatar(Particle* particle, AvatarData* avatar) {
+    glm::vec3 center = particle->getPosition() * (float)(TREE_SCALE);
+    float radius = particle->getRadius() * (float)(TREE_SCALE);
+    const float ELASTICITY = 0.9f;
+    const float DAMPING = 0.1f;
+    const float COLLISION_FREQUENCY = 0.5f;
 
-        if (avatar->findSphereCollisions(center, radius, _collisions)) {
-            int numCollisions = _collisions.size();
-            for (int i = 0; i < numCollisions; ++i) {
-                CollisionInfo* collision = _collisions.getCollision(i);
-                collision->_damping = DAMPING;
-                collision->_elasticity = ELASTICITY;
-    
-                collision->_addedVelocity /= (float)(TREE_SCALE);
-                glm::vec3 relativeVelocity = collision->_addedVelocity - particle->getVelocity();
-    
-                if (glm::dot(relativeVelocity, collision->_penetration) <= 0.f) {
-                    // only collide when particle and collision point are moving toward each other
-                    // (doing this prevents some "collision snagging" when particle penetrates the object)
-                    updateCollisionSound(particle, collision->_penetration, COLLISION_FREQUENCY);
-                    collision->_penetration /= (float)(TREE_SCALE);
-                    particle->applyHardCollision(*collision);
-                    queueParticlePropertiesUpdate(particle);
-                }
+    _collisions.clear();
+    if (avatar->findSphereCollisions(center, radius, _collisions)) {
+        int numCollisions = _collisions.size();
+        for (int i = 0; i < numCollisions; ++i) {
+            CollisionInfo* collision = _collisions.getCollision(i);
+            collision->_damping = DAMPING;
+            collision->_elasticity = ELASTICITY;
+
+            collision->_addedVelocity /= (float)(TREE_SCALE);
+            glm::vec3 relativeVelocity = collision->_addedVelocity - particle->getVelocity();
+
+            if (glm::dot(relativeVelocity, collision->_penetration) <= 0.f) {
+                // only collide when particle and collision point are moving toward each other
+                // (doing this prevents some "collision snagging" when particle penetrates the object)
+                updateCollisionSound(particle, collision->_penetration, COLLISION_FREQUENCY);
+                collision->_penetration /= (float)(TREE_SCALE);
+                particle->applyHardCollision(*collision);
+                queueParticlePropertiesUpdate(particle);
             }
         }
     }
@@ -21,6 +21,7 @@
 #include <AvatarHashMap.h>
 #include <CollisionInfo.h>
 #include <SharedUtil.h>
+#include <SweepAndPrune.h>
 #include <OctreePacketData.h>
 
 #include "Particle.h"
@@ -45,12 +46,16 @@ public:
                                 
     ~ParticleCollisionSystem();
 
+    /// Collides every particle with the voxels, and with the particles and avatars the broadphase finds near it.
     void update();
 
+    /// Collides one particle with everything, without the broadphase.
     void checkParticle(Particle* particle);
     void updateCollisionWithVoxels(Particle* particle);
     void updateCollisionWithParticles(Particle* particle);
     void updateCollisionWithAvatars(Particle* particle);
+    void updateCollisionWithParticle(Particle* particleA, Particle* particleB);
+    void updateCollisionWithAvatar(Particle* particle, AvatarData* avatar);
     void queueParticlePropertiesUpdate(Particle* particle);
     void updateCollisionSound(Particle* particle, const glm::vec3 &penetration, float frequency);
 
@@ -59,7 +64,7 @@ signals:
     void particleCollisionWithParticle(const ParticleID& idA, const ParticleID& idB, const CollisionInfo& penetration);
 
 private:
-    static bool updateOperation(OctreeElement* element, void* extraData);
+    static bool addParticlesOperation(OctreeElement* element, void* extraData);
     void emitGlobalParticleCollisionWithVoxel(Particle* particle, VoxelDetail* voxelDetails, const CollisionInfo& penetration);
     void emitGlobalParticleCollisionWithParticle(Particle* particleA, Particle* particleB, const CollisionInfo& penetration);
 
@@ -69,6 +74,11 @@ private:
     AbstractAudioInterface* _audio;
     AvatarHashMap* _avatars;
     CollisionList _collisions;
+
+    // the broadphase, rebuilt every update(); the particles and avatars are kept at the index of their box
+    SweepAndPrune _broadphase;
+    QVector<Particle*> _broadphaseParticles;
+    QVector<AvatarData*> _broadphaseAvatars;
 };
 
 #endif // hifi_ParticleCollisionSystem_h
@@ -97,8 +97,9 @@ void ParticleTree::storeParticle(const Particle& particle, const SharedNodePoint
     FindAndUpdateParticleArgs args = { particle, false };
     recurseTreeWithOperation(findAndUpdateOperation, &args);
 
-    // if we didn't find it in the tree, then store it...
-    if (!args.found) {
+    // if we didn't find it in the tree, then store it... unless the update only had the properties that changed, the
+    // rest would be made up. The next whole update brings it in.
+    if (!args.found && particle.wasReadWhole()) {
         glm::vec3 position = particle.getPosition();
         float size = std::max(MINIMUM_PARTICLE_ELEMENT_SIZE, particle.getRadius());
 
@@ -512,7 +513,8 @@ bool ParticleTree::hasParticlesDeletedSince(quint64 sinceTime) {
 
 // sinceTime is an in/out parameter - it will be side effected with the last time sent out
 bool ParticleTree::encodeParticlesDeletedSince(OCTREE_PACKET_SEQUENCE sequenceNumber, quint64& sinceTime, unsigned char* outputBuffer,
-                                                size_t maxLength, size_t& outputLength) {
+                                                size_t maxLength, size_t& outputLength,
+                                                OctreeItemDeltas* itemDeltas) {
 
     bool hasMoreToSend = true;
 
@@ -557,6 +559,9 @@ bool ParticleTree::encodeParticlesDeletedSince(OCTREE_PACKET_SEQUENCE sequenceNu
             if (iterator.key() > sinceTime) {
                 uint32_t particleID = values.at(valueItem);
                 memcpy(copyAt, &particleID, sizeof(particleID));
+                if (itemDeltas) {
+                    itemDeltas->forgetItem(particleID);
+                }
                 copyAt += sizeof(particleID);
                 outputLength += sizeof(particleID);
                 numberOfIds++;
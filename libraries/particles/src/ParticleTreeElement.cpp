@@ -58,7 +58,7 @@ bool ParticleTreeElement::appendElementData(OctreePacketData* packetData, Encode
     if (success) {
         for (uint16_t i = 0; i < numberOfParticles; i++) {
             const Particle& particle = (*_particles)[i];
-            success = particle.appendParticleData(packetData);
+            success = particle.appendParticleData(packetData, params.itemDeltas, &_cube);
             if (!success) {
                 break;
             }
@@ -297,7 +297,7 @@ int ParticleTreeElement::readElementDataFromBuffer(const unsigned char* data, in
     const unsigned char* dataAt = data;
     int bytesRead = 0;
     uint16_t numberOfParticles = 0;
-    int expectedBytesPerParticle = Particle::expectedBytes();
+    int expectedBytesPerParticle = Particle::expectedBytes(args.bitstreamVersion);
 
     if (bytesLeftToRead >= (int)sizeof(numberOfParticles)) {
         // read our particles in....
@@ -309,7 +309,11 @@ int ParticleTreeElement::readElementDataFromBuffer(const unsigned char* data, in
         if (bytesLeftToRead >= (int)(numberOfParticles * expectedBytesPerParticle)) {
             for (uint16_t i = 0; i < numberOfParticles; i++) {
                 Particle tempParticle;
-                int bytesForThisParticle = tempParticle.readParticleDataFromBuffer(dataAt, bytesLeftToRead, args);
+                int bytesForThisParticle = tempParticle.readParticleDataFromBuffer(dataAt, bytesLeftToRead, args,
+                                                                                   &_cube);
+                if (bytesForThisParticle == 0) {
+                    break; // the rest of the particles can't be read
+                }
                 _myTree->storeParticle(tempParticle);
                 dataAt += bytesForThisParticle;
                 bytesLeftToRead -= bytesForThisParticle;
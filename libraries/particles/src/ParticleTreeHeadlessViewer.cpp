@@ -32,7 +32,3 @@ void ParticleTreeHeadlessViewer::update() {
         }
     }
 }
-
-void ParticleTreeHeadlessViewer::processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) {
-    static_cast<ParticleTree*>(_tree)->processEraseMessage(dataByteArray, sourceNode);
-}
@@ -36,8 +36,6 @@ public:
 
     ParticleTree* getTree() { return (ParticleTree*)_tree; }
 
-    void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode);
-
     virtual void init();
 };
 
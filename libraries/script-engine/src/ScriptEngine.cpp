@@ -83,6 +83,7 @@ ScriptEngine::ScriptEngine(const QString& scriptContents, const QString& fileNam
     _isListeningToAudioStream(false),
     _avatarSound(NULL),
     _numAvatarSoundSentBytes(0),
+    _lastUpdate(0),
     _controllerScriptingInterface(controllerScriptingInterface),
     _avatarData(NULL),
     _scriptName(),
@@ -108,6 +109,7 @@ ScriptEngine::ScriptEngine(const QUrl& scriptURL,
     _isListeningToAudioStream(false),
     _avatarSound(NULL),
     _numAvatarSoundSentBytes(0),
+    _lastUpdate(0),
     _controllerScriptingInterface(controllerScriptingInterface),
     _avatarData(NULL),
     _scriptName(),
@@ -348,7 +350,39 @@ void ScriptEngine::sendAvatarBillboardPacket() {
     }
 }
 
-void ScriptEngine::run() {
+void ScriptEngine::flushEditPacketSenders() {
+    if (_voxelsScriptingInterface.getVoxelPacketSender()->serversExist()) {
+        // release the queue of edit voxel messages.
+        _voxelsScriptingInterface.getVoxelPacketSender()->releaseQueuedMessages();
+
+        // since we're in non-threaded mode, call process so that the packets are sent
+        if (!_voxelsScriptingInterface.getVoxelPacketSender()->isThreaded()) {
+            _voxelsScriptingInterface.getVoxelPacketSender()->process();
+        }
+    }
+
+    if (_particlesScriptingInterface.getParticlePacketSender()->serversExist()) {
+        // release the queue of edit particle messages.
+        _particlesScriptingInterface.getParticlePacketSender()->releaseQueuedMessages();
+
+        // since we're in non-threaded mode, call process so that the packets are sent
+        if (!_particlesScriptingInterface.getParticlePacketSender()->isThreaded()) {
+            _particlesScriptingInterface.getParticlePacketSender()->process();
+        }
+    }
+
+    if (_modelsScriptingInterface.getModelPacketSender()->serversExist()) {
+        // release the queue of edit model messages.
+        _modelsScriptingInterface.getModelPacketSender()->releaseQueuedMessages();
+
+        // since we're in non-threaded mode, call process so that the packets are sent
+        if (!_modelsScriptingInterface.getModelPacketSender()->isThreaded()) {
+            _modelsScriptingInterface.getModelPacketSender()->process();
+        }
+    }
+}
+
+void ScriptEngine::startRunning() {
     if (!_isInitialized) {
         init();
     }
@@ -364,201 +398,172 @@ void ScriptEngine::run() {
         _engine.clearExceptions();
     }
 
-    QElapsedTimer startTime;
-    startTime.start();
-
-    int thisFrame = 0;
-
-    NodeList* nodeList = NodeList::getInstance();
-
-    qint64 lastUpdate = usecTimestampNow();
-
-    while (!_isFinished) {
-        int usecToSleep = (thisFrame++ * SCRIPT_DATA_CALLBACK_USECS) - startTime.nsecsElapsed() / 1000; // nsec to usec
-        if (usecToSleep > 0) {
-            usleep(usecToSleep);
-        }
-
-        if (_isFinished) {
-            break;
-        }
-
-        QCoreApplication::processEvents();
-
-        if (_isFinished) {
-            break;
-        }
-
-        if (_voxelsScriptingInterface.getVoxelPacketSender()->serversExist()) {
-            // release the queue of edit voxel messages.
-            _voxelsScriptingInterface.getVoxelPacketSender()->releaseQueuedMessages();
-
-            // since we're in non-threaded mode, call process so that the packets are sent
-            if (!_voxelsScriptingInterface.getVoxelPacketSender()->isThreaded()) {
-                _voxelsScriptingInterface.getVoxelPacketSender()->process();
-            }
-        }
+    _lastUpdate = usecTimestampNow();
+}
 
-        if (_particlesScriptingInterface.getParticlePacketSender()->serversExist()) {
-            // release the queue of edit voxel messages.
-            _particlesScriptingInterface.getParticlePacketSender()->releaseQueuedMessages();
+void ScriptEngine::runFrame() {
+    sendAvatarFrame();
 
-            // since we're in non-threaded mode, call process so that the packets are sent
-            if (!_particlesScriptingInterface.getParticlePacketSender()->isThreaded()) {
-                _particlesScriptingInterface.getParticlePacketSender()->process();
-            }
-        }
+    qint64 now = usecTimestampNow();
+    float deltaTime = (float) (now - _lastUpdate) / (float) USECS_PER_SECOND;
 
-        if (_modelsScriptingInterface.getModelPacketSender()->serversExist()) {
-            // release the queue of edit voxel messages.
-            _modelsScriptingInterface.getModelPacketSender()->releaseQueuedMessages();
+    if (_engine.hasUncaughtException()) {
+        int line = _engine.uncaughtExceptionLineNumber();
+        qDebug() << "Uncaught exception at (" << _fileNameString << ") line" << line << ":" << _engine.uncaughtException().toString();
+        emit errorMessage("Uncaught exception at (" + _fileNameString + ") line" + QString::number(line) + ":" + _engine.uncaughtException().toString());
+        _engine.clearExceptions();
+    }
 
-            // since we're in non-threaded mode, call process so that the packets are sent
-            if (!_modelsScriptingInterface.getModelPacketSender()->isThreaded()) {
-                _modelsScriptingInterface.getModelPacketSender()->process();
-            }
-        }
+    emit update(deltaTime);
+    _lastUpdate = now;
+}
 
-        if (_isAvatar && _avatarData) {
+void ScriptEngine::sendAvatarFrame() {
+    NodeList* nodeList = NodeList::getInstance();
 
-            const int SCRIPT_AUDIO_BUFFER_SAMPLES = floor(((SCRIPT_DATA_CALLBACK_USECS * SAMPLE_RATE) / (1000 * 1000)) + 0.5);
-            const int SCRIPT_AUDIO_BUFFER_BYTES = SCRIPT_AUDIO_BUFFER_SAMPLES * sizeof(int16_t);
+    if (_isAvatar && _avatarData) {
 
-            QByteArray avatarPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarData);
-            avatarPacket.append(_avatarData->toByteArray());
+        const int SCRIPT_AUDIO_BUFFER_SAMPLES = floor(((SCRIPT_DATA_CALLBACK_USECS * SAMPLE_RATE) / (1000 * 1000)) + 0.5);
+        const int SCRIPT_AUDIO_BUFFER_BYTES = SCRIPT_AUDIO_BUFFER_SAMPLES * sizeof(int16_t);
 
-            nodeList->broadcastToNodes(avatarPacket, NodeSet() << NodeType::AvatarMixer);
+        QByteArray avatarPacket = byteArrayWithPopulatedHeader(PacketTypeAvatarData);
+        avatarPacket.append(_avatarData->toByteArray());
 
-            if (_isListeningToAudioStream || _avatarSound) {
-                // if we have an avatar audio stream then send it out to our audio-mixer
-                bool silentFrame = true;
+        nodeList->broadcastToNodes(avatarPacket, NodeSet() << NodeType::AvatarMixer);
 
-                int16_t numAvailableSamples = SCRIPT_AUDIO_BUFFER_SAMPLES;
-                const int16_t* nextSoundOutput = NULL;
+        if (_isListeningToAudioStream || _avatarSound) {
+            // if we have an avatar audio stream then send it out to our audio-mixer
+            bool silentFrame = true;
 
-                if (_avatarSound) {
+            int16_t numAvailableSamples = SCRIPT_AUDIO_BUFFER_SAMPLES;
+            const int16_t* nextSoundOutput = NULL;
 
-                    const QByteArray& soundByteArray = _avatarSound->getByteArray();
-                    nextSoundOutput = reinterpret_cast<const int16_t*>(soundByteArray.data()
-                                                                       + _numAvatarSoundSentBytes);
+            if (_avatarSound) {
 
-                    int numAvailableBytes = (soundByteArray.size() - _numAvatarSoundSentBytes) > SCRIPT_AUDIO_BUFFER_BYTES
-                        ? SCRIPT_AUDIO_BUFFER_BYTES
-                        : soundByteArray.size() - _numAvatarSoundSentBytes;
-                    numAvailableSamples = numAvailableBytes / sizeof(int16_t);
+                const QByteArray& soundByteArray = _avatarSound->getByteArray();
+                nextSoundOutput = reinterpret_cast<const int16_t*>(soundByteArray.data()
+                                                                   + _numAvatarSoundSentBytes);
 
+                int numAvailableBytes = (soundByteArray.size() - _numAvatarSoundSentBytes) > SCRIPT_AUDIO_BUFFER_BYTES
+                    ? SCRIPT_AUDIO_BUFFER_BYTES
+                    : soundByteArray.size() - _numAvatarSoundSentBytes;
+                numAvailableSamples = numAvailableBytes / sizeof(int16_t);
 
-                    // check if the all of the _numAvatarAudioBufferSamples to be sent are silence
-                    for (int i = 0; i < numAvailableSamples; ++i) {
-                        if (nextSoundOutput[i] != 0) {
-                            silentFrame = false;
-                            break;
-                        }
-                    }
 
-                    _numAvatarSoundSentBytes += numAvailableBytes;
-                    if (_numAvatarSoundSentBytes == soundByteArray.size()) {
-                        // we're done with this sound object - so set our pointer back to NULL
-                        // and our sent bytes back to zero
-                        _avatarSound = NULL;
-                        _numAvatarSoundSentBytes = 0;
-                    }
-                }
-                
-                QByteArray audioPacket = byteArrayWithPopulatedHeader(silentFrame
-                                                                      ? PacketTypeSilentAudioFrame
-                                                                      : PacketTypeMicrophoneAudioNoEcho);
-
-                QDataStream packetStream(&audioPacket, QIODevice::Append);
-
-                // pack a placeholder value for sequence number for now, will be packed when destination node is known
-                int numPreSequenceNumberBytes = audioPacket.size();
-                packetStream << (quint16) 0;
-                
-                // assume scripted avatar audio is mono and set channel flag to zero
-                packetStream << (quint8) 0;
-
-                // use the orientation and position of this avatar for the source of this audio
-                packetStream.writeRawData(reinterpret_cast<const char*>(&_avatarData->getPosition()), sizeof(glm::vec3));
-                glm::quat headOrientation = _avatarData->getHeadOrientation();
-                packetStream.writeRawData(reinterpret_cast<const char*>(&headOrientation), sizeof(glm::quat));
-
-                if (silentFrame) {
-                    if (!_isListeningToAudioStream) {
-                        // if we have a silent frame and we're not listening then just send nothing and break out of here
+                // check if the all of the _numAvatarAudioBufferSamples to be sent are silence
+                for (int i = 0; i < numAvailableSamples; ++i) {
+                    if (nextSoundOutput[i] != 0) {
+                        silentFrame = false;
                         break;
                     }
-
-                    // write the number of silent samples so the audio-mixer can uphold timing
-                    packetStream.writeRawData(reinterpret_cast<const char*>(&SCRIPT_AUDIO_BUFFER_SAMPLES), sizeof(int16_t));
-                } else if (nextSoundOutput) {
-                    // write the raw audio data
-                    packetStream.writeRawData(reinterpret_cast<const char*>(nextSoundOutput),
-                                              numAvailableSamples * sizeof(int16_t));
                 }
 
-                // write audio packet to AudioMixer nodes
-                NodeList* nodeList = NodeList::getInstance();
-                foreach(const SharedNodePointer& node, nodeList->getNodeHash()) {
-                    // only send to nodes of type AudioMixer
-                    if (node->getType() == NodeType::AudioMixer) {
-                        // pack sequence number
-                        quint16 sequence = _outgoingScriptAudioSequenceNumbers[node->getUUID()]++;
-                        memcpy(audioPacket.data() + numPreSequenceNumberBytes, &sequence, sizeof(quint16));
-
-                        // send audio packet
-                        nodeList->writeDatagram(audioPacket, node);
-                    }
+                _numAvatarSoundSentBytes += numAvailableBytes;
+                if (_numAvatarSoundSentBytes == soundByteArray.size()) {
+                    // we're done with this sound object - so set our pointer back to NULL
+                    // and our sent bytes back to zero
+                    _avatarSound = NULL;
+                    _numAvatarSoundSentBytes = 0;
                 }
             }
-        }
+            
+            QByteArray audioPacket = byteArrayWithPopulatedHeader(silentFrame
+                                                                  ? PacketTypeSilentAudioFrame
+                                                                  : PacketTypeMicrophoneAudioNoEcho);
+
+            QDataStream packetStream(&audioPacket, QIODevice::Append);
+
+            // pack a placeholder value for sequence number for now, will be packed when destination node is known
+            int numPreSequenceNumberBytes = audioPacket.size();
+            packetStream << (quint16) 0;
+            
+            // assume scripted avatar audio is mono and set channel flag to zero
+            packetStream << (quint8) 0;
+
+            // use the orientation and position of this avatar for the source of this audio
+            packetStream.writeRawData(reinterpret_cast<const char*>(&_avatarData->getPosition()), sizeof(glm::vec3));
+            glm::quat headOrientation = _avatarData->getHeadOrientation();
+            packetStream.writeRawData(reinterpret_cast<const char*>(&headOrientation), sizeof(glm::quat));
+
+            // scripted avatar audio is sent as it is
+            packetStream << AudioCodecType::PCM;
+
+            if (silentFrame) {
+                if (!_isListeningToAudioStream) {
+                    // if we have a silent frame and we're not listening then just send nothing and bail out of this frame.
+                    // This used to be a break out of the run loop, which ended the whole script on the first silent
+                    // frame after a sound; now only this frame's audio is skipped and the script keeps running.
+                    return;
+                }
 
-        qint64 now = usecTimestampNow();
-        float deltaTime = (float) (now - lastUpdate) / (float) USECS_PER_SECOND;
+                // write the number of silent samples so the audio-mixer can uphold timing
+                packetStream.writeRawData(reinterpret_cast<const char*>(&SCRIPT_AUDIO_BUFFER_SAMPLES), sizeof(int16_t));
+            } else if (nextSoundOutput) {
+                // write the raw audio data
+                packetStream.writeRawData(reinterpret_cast<const char*>(nextSoundOutput),
+                                          numAvailableSamples * sizeof(int16_t));
+            }
 
-        if (_engine.hasUncaughtException()) {
-            int line = _engine.uncaughtExceptionLineNumber();
-            qDebug() << "Uncaught exception at (" << _fileNameString << ") line" << line << ":" << _engine.uncaughtException().toString();
-            emit errorMessage("Uncaught exception at (" + _fileNameString + ") line" + QString::number(line) + ":" + _engine.uncaughtException().toString());
-            _engine.clearExceptions();
-        }
+            // write audio packet to AudioMixer nodes
+            foreach(const SharedNodePointer& node, nodeList->getNodeHash()) {
+                // only send to nodes of type AudioMixer
+                if (node->getType() == NodeType::AudioMixer) {
+                    // pack sequence number
+                    quint16 sequence = _outgoingScriptAudioSequenceNumbers[node->getUUID()]++;
+                    memcpy(audioPacket.data() + numPreSequenceNumberBytes, &sequence, sizeof(quint16));
 
-        emit update(deltaTime);
-        lastUpdate = now;
+                    // send audio packet
+                    nodeList->writeDatagram(audioPacket, node);
+                }
+            }
+        }
     }
+}
+
+void ScriptEngine::finishRunning(bool shouldFlushEditPackets) {
     emit scriptEnding();
 
     // kill the avatar identity timer
     delete _avatarIdentityTimer;
+    _avatarIdentityTimer = NULL;
 
-    if (_voxelsScriptingInterface.getVoxelPacketSender()->serversExist()) {
-        // release the queue of edit voxel messages.
-        _voxelsScriptingInterface.getVoxelPacketSender()->releaseQueuedMessages();
-
-        // since we're in non-threaded mode, call process so that the packets are sent
-        if (!_voxelsScriptingInterface.getVoxelPacketSender()->isThreaded()) {
-            _voxelsScriptingInterface.getVoxelPacketSender()->process();
-        }
+    if (shouldFlushEditPackets) {
+        // send any edits the script queued up on its way out
+        flushEditPacketSenders();
     }
 
-    if (_particlesScriptingInterface.getParticlePacketSender()->serversExist()) {
-        // release the queue of edit voxel messages.
-        _particlesScriptingInterface.getParticlePacketSender()->releaseQueuedMessages();
+    emit finished(_fileNameString);
 
-        // since we're in non-threaded mode, call process so that the packets are sent
-        if (!_particlesScriptingInterface.getParticlePacketSender()->isThreaded()) {
-            _particlesScriptingInterface.getParticlePacketSender()->process();
+    _isRunning = false;
+    emit runningStateChanged();
+}
+
+void ScriptEngine::run() {
+    startRunning();
+
+    QElapsedTimer startTime;
+    startTime.start();
+
+    int thisFrame = 0;
+
+    while (!_isFinished) {
+        int usecToSleep = (thisFrame++ * SCRIPT_DATA_CALLBACK_USECS) - startTime.nsecsElapsed() / 1000; // nsec to usec
+        if (usecToSleep > 0) {
+            usleep(usecToSleep);
         }
-    }
 
-    if (_modelsScriptingInterface.getModelPacketSender()->serversExist()) {
-        // release the queue of edit voxel messages.
-        _modelsScriptingInterface.getModelPacketSender()->releaseQueuedMessages();
+        if (_isFinished) {
+            break;
+        }
 
-        // since we're in non-threaded mode, call process so that the packets are sent
-        if (!_modelsScriptingInterface.getModelPacketSender()->isThreaded()) {
-            _modelsScriptingInterface.getModelPacketSender()->process();
+        QCoreApplication::processEvents();
+
+        if (_isFinished) {
+            break;
         }
+
+        flushEditPacketSenders();
+        runFrame();
     }
 
     // If we were on a thread, then wait till it's done
@@ -566,10 +571,7 @@ void ScriptEngine::run() {
         thread()->quit();
     }
 
-    emit finished(_fileNameString);
-
-    _isRunning = false;
-    emit runningStateChanged();
+    finishRunning(true);
 }
 
 void ScriptEngine::stop() {
@@ -82,6 +82,17 @@ public:
     void run(); /// runs continuously until Agent.stop() is called
     void evaluate(); /// initializes the engine, and evaluates the script, but then returns control to caller
 
+    /// evaluates the script so that it can then be driven one frame at a time by runFrame(), for hosts that run
+    /// several scripts on a shared thread instead of calling run()
+    void startRunning();
+    /// sends avatar data and audio (if we're an avatar) and emits update() - does not process events or flush edits
+    void runFrame();
+    /// emits scriptEnding() and finished() for a script that was driven with startRunning()/runFrame()
+    void finishRunning(bool shouldFlushEditPackets);
+
+    /// releases and sends any queued edit messages on the shared voxel, particle and model packet senders
+    static void flushEditPacketSenders();
+
     void timerFired();
 
     bool hasScript() const { return !_scriptContents.isEmpty(); }
@@ -125,11 +136,13 @@ protected:
     bool _isListeningToAudioStream;
     Sound* _avatarSound;
     int _numAvatarSoundSentBytes;
+    qint64 _lastUpdate;
 
 private:
     QUrl resolveInclude(const QString& include) const;
     void sendAvatarIdentityPacket();
     void sendAvatarBillboardPacket();
+    void sendAvatarFrame();
 
     QObject* setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot);
     void stopTimer(QTimer* timer);
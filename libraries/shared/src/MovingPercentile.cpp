@@ -13,49 +13,131 @@
 MovingPercentile::MovingPercentile(int numSamples, float percentile)
     : _numSamples(numSamples),
     _percentile(percentile),
-    _samplesSorted(),
-    _sampleIds(),
+    _samples(),
+    _slotHeaps(),
+    _slotHeapIndices(),
     _newSampleId(0),
     _indexOfPercentile(0),
     _valueAtPercentile(0.0f)
 {
+    _samples.reserve(numSamples);
+    _slotHeaps.reserve(numSamples);
+    _slotHeapIndices.reserve(numSamples);
+    _heaps[LOWER_HEAP].reserve(numSamples);
+    _heaps[UPPER_HEAP].reserve(numSamples);
 }
 
 void MovingPercentile::updatePercentile(float sample) {
 
-    // insert the new sample into _samplesSorted
-    int newSampleIndex;
-    if (_samplesSorted.size() < _numSamples) {
-        // if not all samples have been filled yet, simply append it
-        newSampleIndex = _samplesSorted.size();
-        _samplesSorted.append(sample);
-        _sampleIds.append(_newSampleId);
+    int newSampleSlot;
+    if (_samples.size() < _numSamples) {
+        // if not all samples have been filled yet, the new sample gets a slot of its own
+        newSampleSlot = _samples.size();
+        _samples.append(sample);
+        _slotHeaps.append(LOWER_HEAP);
+        _slotHeapIndices.append(0);
 
         // update _indexOfPercentile
-        float index = _percentile * (float)(_samplesSorted.size() - 1);
+        float index = _percentile * (float)(_samples.size() - 1);
         _indexOfPercentile = (int)(index + 0.5f);   // round to int
     } else {
-        // find index of sample with id = _newSampleId and replace it with new sample
-        newSampleIndex = _sampleIds.indexOf(_newSampleId);
-        _samplesSorted[newSampleIndex] = sample;
+        // the oldest sample is the one in slot _newSampleId: take it out of its heap and reuse its slot
+        newSampleSlot = _newSampleId;
+        popFromHeap((Heap)_slotHeaps[newSampleSlot], _slotHeapIndices[newSampleSlot]);
+        _samples[newSampleSlot] = sample;
     }
 
     // increment _newSampleId.  cycles from 0 thru N-1
     _newSampleId = (_newSampleId == _numSamples - 1) ? 0 : _newSampleId + 1;
 
-    // swap new sample with neighbors in _samplesSorted until it's in sorted order
-    // try swapping up first, then down.  element will only be swapped one direction.
-    while (newSampleIndex < _samplesSorted.size() - 1 && sample > _samplesSorted[newSampleIndex + 1]) {
-        _samplesSorted.swap(newSampleIndex, newSampleIndex + 1);
-        _sampleIds.swap(newSampleIndex, newSampleIndex + 1);
-        newSampleIndex++;
+    // every sample in the lower heap is at most every sample in the upper heap
+    const QVector<int>& upperHeap = _heaps[UPPER_HEAP];
+    if (!upperHeap.isEmpty() && sample >= _samples[upperHeap[0]]) {
+        pushToHeap(UPPER_HEAP, newSampleSlot);
+    } else {
+        pushToHeap(LOWER_HEAP, newSampleSlot);
+    }
+
+    // move samples across until the lower heap holds exactly the samples up to the percentile
+    int lowerHeapSize = _indexOfPercentile + 1;
+    while (_heaps[LOWER_HEAP].size() > lowerHeapSize) {
+        pushToHeap(UPPER_HEAP, popFromHeap(LOWER_HEAP, 0));
     }
-    while (newSampleIndex > 0 && sample < _samplesSorted[newSampleIndex - 1]) {
-        _samplesSorted.swap(newSampleIndex, newSampleIndex - 1);
-        _sampleIds.swap(newSampleIndex, newSampleIndex - 1);
-        newSampleIndex--;
+    while (_heaps[LOWER_HEAP].size() < lowerHeapSize) {
+        pushToHeap(LOWER_HEAP, popFromHeap(UPPER_HEAP, 0));
     }
 
     // find new value at percentile
-    _valueAtPercentile = _samplesSorted[_indexOfPercentile];
+    _valueAtPercentile = _samples[_heaps[LOWER_HEAP][0]];
+}
+
+bool MovingPercentile::isAbove(Heap heap, int slotA, int slotB) const {
+    // the lower heap is a max-heap, the upper heap a min-heap
+    return (heap == LOWER_HEAP) ? _samples[slotA] > _samples[slotB] : _samples[slotA] < _samples[slotB];
+}
+
+void MovingPercentile::setHeapEntry(Heap heap, int heapIndex, int slot) {
+    _heaps[heap][heapIndex] = slot;
+    _slotHeaps[slot] = heap;
+    _slotHeapIndices[slot] = heapIndex;
+}
+
+void MovingPercentile::siftUp(Heap heap, int heapIndex) {
+    QVector<int>& entries = _heaps[heap];
+    int slot = entries[heapIndex];
+    while (heapIndex > 0) {
+        int parentIndex = (heapIndex - 1) / 2;
+        int parentSlot = entries[parentIndex];
+        if (!isAbove(heap, slot, parentSlot)) {
+            break;
+        }
+        setHeapEntry(heap, heapIndex, parentSlot);
+        heapIndex = parentIndex;
+    }
+    setHeapEntry(heap, heapIndex, slot);
+}
+
+void MovingPercentile::siftDown(Heap heap, int heapIndex) {
+    QVector<int>& entries = _heaps[heap];
+    int size = entries.size();
+    int slot = entries[heapIndex];
+    forever {
+        int childIndex = heapIndex * 2 + 1;
+        if (childIndex >= size) {
+            break;
+        }
+        if (childIndex + 1 < size && isAbove(heap, entries[childIndex + 1], entries[childIndex])) {
+            childIndex++;
+        }
+        int childSlot = entries[childIndex];
+        if (!isAbove(heap, childSlot, slot)) {
+            break;
+        }
+        setHeapEntry(heap, heapIndex, childSlot);
+        heapIndex = childIndex;
+    }
+    setHeapEntry(heap, heapIndex, slot);
+}
+
+void MovingPercentile::pushToHeap(Heap heap, int slot) {
+    _heaps[heap].append(slot);
+    siftUp(heap, _heaps[heap].size() - 1);
+}
+
+int MovingPercentile::popFromHeap(Heap heap, int heapIndex) {
+    QVector<int>& entries = _heaps[heap];
+    int slot = entries[heapIndex];
+
+    // fill the hole with the last entry, which may belong above or below it
+    int lastSlot = entries.last();
+    entries.removeLast();
+    if (heapIndex < entries.size()) {
+        setHeapEntry(heap, heapIndex, lastSlot);
+        if (heapIndex > 0 && isAbove(heap, lastSlot, entries[(heapIndex - 1) / 2])) {
+            siftUp(heap, heapIndex);
+        } else {
+            siftDown(heap, heapIndex);
+        }
+    }
+    return slot;
 }
@@ -11,8 +11,12 @@
 #ifndef hifi_MovingPercentile_h
 #define hifi_MovingPercentile_h
 
-#include <qlist.h>
+#include <qvector.h>
 
+// The samples in the window are split between two heaps: a max-heap of the samples at or below the percentile and a
+// min-heap of the ones above it, so the value at the percentile is always the top of the lower heap. Each heap entry
+// knows its position, so the sample that drops out of the window can be removed from the middle of its heap.
+// Updates are O(log n), reading the percentile is O(1).
 class MovingPercentile {
 
 public:
@@ -22,12 +26,27 @@ public:
     float getValueAtPercentile() const { return _valueAtPercentile; }
 
 private:
+    enum Heap {
+        LOWER_HEAP = 0,
+        UPPER_HEAP,
+        NUM_HEAPS
+    };
+
+    bool isAbove(Heap heap, int slotA, int slotB) const;
+    void setHeapEntry(Heap heap, int heapIndex, int slot);
+    void siftUp(Heap heap, int heapIndex);
+    void siftDown(Heap heap, int heapIndex);
+    void pushToHeap(Heap heap, int slot);
+    int popFromHeap(Heap heap, int heapIndex);
+
     const int _numSamples;
     const float _percentile;
 
-    QList<float> _samplesSorted;
-    QList<int> _sampleIds;      // incrementally assigned, is cyclic
-    int _newSampleId;
+    QVector<float> _samples;            // indexed by slot; slots are reused in the order samples arrive
+    QVector<int> _heaps[NUM_HEAPS];     // the slots in each heap, in heap order
+    QVector<int> _slotHeaps;            // which heap each slot is in
+    QVector<int> _slotHeapIndices;      // where in that heap each slot is
+    int _newSampleId;                   // the slot of the next sample; incrementally assigned, is cyclic
 
     int _indexOfPercentile;
     float _valueAtPercentile;
@@ -27,6 +27,9 @@ size_t bytesRequiredForCodeLength(unsigned char threeBitCodes);
 int branchIndexWithDescendant(const unsigned char* ancestorOctalCode, const unsigned char* descendantOctalCode);
 unsigned char* childOctalCode(const unsigned char* parentOctalCode, char childNumber);
 
+/// the child index (0-7) at the given depth of the code, the first section is the child of the root
+char getOctalCodeSectionValue(const unsigned char* octalCode, int section);
+
 const int OVERFLOWED_OCTCODE_BUFFER = -1;
 const int UNKNOWN_OCTCODE_LENGTH = -2;
 
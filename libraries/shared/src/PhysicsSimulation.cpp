@@ -11,6 +11,7 @@
 
 #include <glm/glm.hpp>
 #include <iostream>
+#include <limits>
 
 #include "PhysicsSimulation.h"
 
@@ -23,9 +24,18 @@ int MAX_DOLLS_PER_SIMULATION = 16;
 int MAX_ENTITIES_PER_SIMULATION = 64;
 int MAX_COLLISIONS_PER_SIMULATION = 256;
 
+// shape bounds are padded by this fraction of their radius so that the pairs found at the start of a step
+// still cover the shapes after the relaxation iterations have pushed them around
+const float BROADPHASE_MARGIN = 0.25f;
 
 PhysicsSimulation::PhysicsSimulation() : _collisionList(MAX_COLLISIONS_PER_SIMULATION), 
+        _broadphase(), _broadphaseShapes(), _broadphaseShapeIndices(), _broadphaseEntityIndices(), _shapePairs(),
         _numIterations(0), _numCollisions(0), _constraintError(0.0f), _stepTime(0) {
+    // reserved vectors keep their memory when they are emptied at the start of each step
+    _broadphaseShapes.reserve(MAX_ENTITIES_PER_SIMULATION);
+    _broadphaseShapeIndices.reserve(MAX_ENTITIES_PER_SIMULATION);
+    _broadphaseEntityIndices.reserve(MAX_ENTITIES_PER_SIMULATION);
+    _shapePairs.reserve(MAX_COLLISIONS_PER_SIMULATION);
 }
 
 PhysicsSimulation::~PhysicsSimulation() {
@@ -84,6 +94,8 @@ void PhysicsSimulation::removeEntity(PhysicsEntity* entity) {
                 _entities[i] = lastEntity;
             }
             entity->_simulation = NULL;
+            // the cached pairs may point at its shapes
+            _shapePairs.resize(0);
             break;
         }
     }
@@ -148,6 +160,7 @@ void PhysicsSimulation::stepForward(float deltaTime, float minError, int maxIter
     quint64 expiry = startTime + maxUsec;
 
     moveRagdolls(deltaTime);
+    computeShapePairs();
 
     int numDolls = _dolls.size();
     _numCollisions = 0;
@@ -187,33 +200,61 @@ void PhysicsSimulation::moveRagdolls(float deltaTime) {
     }
 }
 
-void PhysicsSimulation::computeCollisions() {
-    _collisionList.clear();
-    // TODO: keep track of QSet<PhysicsEntity*> collidedEntities;
+void PhysicsSimulation::computeShapePairs() {
+    _broadphase.clear();
+    _broadphaseShapes.resize(0);
+    _broadphaseShapeIndices.resize(0);
+    _broadphaseEntityIndices.resize(0);
+    _shapePairs.resize(0);
+
+    // boxes are added in entity order, then shape order, so the lower box of a pair is the shapeA that
+    // walking the entities pairwise would have given
+    const float HUGE_EXTENT = std::numeric_limits<float>::max();
     int numEntities = _entities.size();
     for (int i = 0; i < numEntities; ++i) {
-        PhysicsEntity* entity = _entities.at(i);
-        const QVector<Shape*> shapes = entity->getShapes();
+        const QVector<Shape*> shapes = _entities.at(i)->getShapes();
         int numShapes = shapes.size();
-        // collide with self
         for (int j = 0; j < numShapes; ++j) {
             const Shape* shape = shapes.at(j);
             if (!shape) {
                 continue;
             }
-            for (int k = j+1; k < numShapes; ++k) {
-                const Shape* otherShape = shapes.at(k);
-                if (otherShape && entity->collisionsAreEnabled(j, k)) {
-                    ShapeCollider::collideShapes(shape, otherShape, _collisionList);
-                }
+            int type = shape->getType();
+            if (type == Shape::SPHERE_SHAPE || type == Shape::CAPSULE_SHAPE || type == Shape::LIST_SHAPE) {
+                float radius = shape->getBoundingRadius();
+                _broadphase.addSphere(shape->getTranslation(), radius * (1.0f + BROADPHASE_MARGIN));
+            } else {
+                // planes are unbounded
+                _broadphase.addBox(glm::vec3(-HUGE_EXTENT), glm::vec3(HUGE_EXTENT));
             }
+            _broadphaseShapes.push_back(shape);
+            _broadphaseShapeIndices.push_back(j);
+            _broadphaseEntityIndices.push_back(i);
         }
+    }
 
-        // collide with others
-        for (int j = i+1; j < numEntities; ++j) {
-            const QVector<Shape*> otherShapes = _entities.at(j)->getShapes();
-            ShapeCollider::collideShapesWithShapes(shapes, otherShapes, _collisionList);
+    const QVector<SweepAndPrunePair>& pairs = _broadphase.findOverlappingPairs();
+    int numPairs = pairs.size();
+    for (int i = 0; i < numPairs; ++i) {
+        int boxA = pairs.at(i).firstIndex;
+        int boxB = pairs.at(i).secondIndex;
+        int entityIndex = _broadphaseEntityIndices.at(boxA);
+        if (entityIndex == _broadphaseEntityIndices.at(boxB) && !_entities.at(entityIndex)->collisionsAreEnabled(
+                _broadphaseShapeIndices.at(boxA), _broadphaseShapeIndices.at(boxB))) {
+            continue;
         }
+        ShapePair pair = { _broadphaseShapes.at(boxA), _broadphaseShapes.at(boxB) };
+        _shapePairs.push_back(pair);
+    }
+}
+
+void PhysicsSimulation::computeCollisions() {
+    _collisionList.clear();
+    // TODO: keep track of QSet<PhysicsEntity*> collidedEntities;
+    const ShapePair* pairs = _shapePairs.constData();
+    int numPairs = _shapePairs.size();
+    for (int i = 0; i < numPairs && !_collisionList.isFull(); ++i) {
+        ShapeCollider::collideShapes(pairs[i].shapeA, pairs[i].shapeB, _collisionList);
     }
     _numCollisions = _collisionList.size();
 }
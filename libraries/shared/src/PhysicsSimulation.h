@@ -15,9 +15,11 @@
 #include <QVector>
 
 #include "CollisionInfo.h"
+#include "SweepAndPrune.h"
 
 class PhysicsEntity;
 class Ragdoll;
+class Shape;
 
 class PhysicsSimulation {
 public:
@@ -42,14 +44,34 @@ public:
     void stepForward(float deltaTime, float minError, int maxIterations, quint64 maxUsec);
 
     void moveRagdolls(float deltaTime);
+
+    /// Finds the pairs of shapes whose bounds, padded for the movement of one step, overlap.  The pairs are
+    /// kept until the next call and are the only ones computeCollisions() tests.
+    void computeShapePairs();
+
     void computeCollisions();
     void processCollisions();
 
+    int getNumShapePairs() const { return _shapePairs.size(); }
+    int getNumCollisions() const { return _numCollisions; }
+
 private:
+    class ShapePair {
+    public:
+        const Shape* shapeA;
+        const Shape* shapeB;
+    };
+
     CollisionList _collisionList;
     QVector<PhysicsEntity*> _entities;
     QVector<Ragdoll*> _dolls;
 
+    SweepAndPrune _broadphase;
+    QVector<const Shape*> _broadphaseShapes;    // the shape of each broadphase box
+    QVector<int> _broadphaseShapeIndices;       // and its index within its entity
+    QVector<int> _broadphaseEntityIndices;      // and the index of that entity
+    QVector<ShapePair> _shapePairs;
+
     // some stats
     int _numIterations;
     int _numCollisions;
@@ -40,10 +40,14 @@ public:
     Enum lastFlag() const { return (Enum)_maxFlag; }
     
     void setHasProperty(Enum flag, bool value = true);
-    bool getHasProperty(Enum flag);
+    bool getHasProperty(Enum flag) const;
     QByteArray encode();
     void decode(const QByteArray& fromEncoded);
 
+    /// decodes flags encoded by encode() from the start of a buffer
+    /// \return the number of bytes the encoded flags take, which may be more than length if the buffer is too short
+    int decode(const unsigned char* data, int length);
+
 
     bool operator==(const PropertyFlags& other) const { return _flags == other._flags; }
     bool operator!=(const PropertyFlags& other) const { return _flags != other._flags; }
@@ -133,7 +137,7 @@ template<typename Enum> inline void PropertyFlags<Enum>::setHasProperty(Enum fla
     }
 }
 
-template<typename Enum> inline bool PropertyFlags<Enum>::getHasProperty(Enum flag) {
+template<typename Enum> inline bool PropertyFlags<Enum>::getHasProperty(Enum flag) const {
     if (flag > _maxFlag) {
         return _trailingFlipped; // usually false
     }
@@ -219,6 +223,28 @@ template<typename Enum> inline void PropertyFlags<Enum>::decode(const QByteArray
     }
 }
 
+template<typename Enum> inline int PropertyFlags<Enum>::decode(const unsigned char* data, int length) {
+    clear();
+
+    // the leading bits count the bytes that follow the first one, like in decode() above, but only the bytes of the
+    // flags are looked at
+    int bitCount = BITS_PER_BYTE * length;
+    int encodedByteCount = 1;
+    int bitAt = 0;
+    while (bitAt < bitCount && (data[bitAt / BITS_PER_BYTE] & (1 << (BITS_PER_BYTE - (bitAt % BITS_PER_BYTE + 1))))) {
+        encodedByteCount++;
+        bitAt++;
+    }
+    int flagsStartAt = bitAt + 1;
+    int expectedBitCount = std::min(encodedByteCount * BITS_PER_BYTE, bitCount);
+    for (bitAt = flagsStartAt; bitAt < expectedBitCount; bitAt++) {
+        if (data[bitAt / BITS_PER_BYTE] & (1 << (BITS_PER_BYTE - (bitAt % BITS_PER_BYTE + 1)))) {
+            setHasProperty((Enum)(bitAt - flagsStartAt));
+        }
+    }
+    return encodedByteCount;
+}
+
 template<typename Enum> inline void PropertyFlags<Enum>::debugDumpBits() {
     qDebug() << "_minFlag=" << _minFlag;
     qDebug() << "_maxFlag=" << _maxFlag;
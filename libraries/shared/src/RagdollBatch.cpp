@@ -0,0 +1,346 @@
+//
+//  RagdollBatch.cpp
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <math.h>
+
+#include "RagdollBatch.h"
+#include "SharedUtil.h"
+
+// distance constraints are projected in blocks small enough for their gathered points to stay on the stack
+const int CONSTRAINT_BLOCK_SIZE = 64;
+
+// ragdolls are colored and relaxed together in groups of this many, which makes batches long enough to vectorize
+// and lets a thread relax a group at a time
+const int RAGDOLLS_PER_GROUP = 8;
+
+RagdollBatch::RagdollBatch() :
+    _ragdolls(),
+    _groups(),
+    _positionsX(),
+    _positionsY(),
+    _positionsZ(),
+    _addedFixedConstraints(),
+    _addedDistanceConstraints(),
+    _batchesAreDirty(false),
+    _fixedPoints(),
+    _fixedAnchors(),
+    _batches(),
+    _constraintPointsA(),
+    _constraintPointsB(),
+    _constraintDistances(),
+    _numIterations(0),
+    _minError(0.0f),
+    _maxIterations(0),
+    _workerErrors(),
+    _workerIterations(),
+    _rangeSplitter() {
+}
+
+void RagdollBatch::clear() {
+    _ragdolls.clear();
+    _positionsX.clear();
+    _positionsY.clear();
+    _positionsZ.clear();
+    _addedFixedConstraints.clear();
+    _addedDistanceConstraints.clear();
+    _batchesAreDirty = true;
+}
+
+int RagdollBatch::addRagdoll(const QVector<VerletPoint>& points) {
+    RagdollRange ragdoll = { _positionsX.size(), points.size() };
+    _ragdolls.push_back(ragdoll);
+    for (int i = 0; i < points.size(); ++i) {
+        const glm::vec3& position = points.at(i)._position;
+        _positionsX.push_back(position.x);
+        _positionsY.push_back(position.y);
+        _positionsZ.push_back(position.z);
+    }
+    _batchesAreDirty = true;
+    return _ragdolls.size() - 1;
+}
+
+void RagdollBatch::addFixedConstraint(int ragdollIndex, int pointIndex, const glm::vec3& anchor) {
+    assert(pointIndex >= 0 && pointIndex < _ragdolls.at(ragdollIndex).numPoints);
+    FixedConstraintData constraint = { ragdollIndex, pointIndex, anchor };
+    _addedFixedConstraints.push_back(constraint);
+    _batchesAreDirty = true;
+}
+
+void RagdollBatch::addDistanceConstraint(int ragdollIndex, int pointIndexA, int pointIndexB) {
+    const RagdollRange& ragdoll = _ragdolls.at(ragdollIndex);
+    assert(pointIndexA >= 0 && pointIndexA < ragdoll.numPoints);
+    assert(pointIndexB >= 0 && pointIndexB < ragdoll.numPoints);
+    assert(pointIndexA != pointIndexB);
+    int pointA = ragdoll.firstPoint + pointIndexA;
+    int pointB = ragdoll.firstPoint + pointIndexB;
+    glm::vec3 offset(_positionsX.at(pointA) - _positionsX.at(pointB), _positionsY.at(pointA) - _positionsY.at(pointB),
+        _positionsZ.at(pointA) - _positionsZ.at(pointB));
+    DistanceConstraintData constraint = { ragdollIndex, pointIndexA, pointIndexB, glm::length(offset) };
+    _addedDistanceConstraints.push_back(constraint);
+    _batchesAreDirty = true;
+}
+
+void RagdollBatch::setPoints(int ragdollIndex, const QVector<VerletPoint>& points) {
+    const RagdollRange& ragdoll = _ragdolls.at(ragdollIndex);
+    assert(points.size() == ragdoll.numPoints);
+    for (int i = 0; i < ragdoll.numPoints; ++i) {
+        const glm::vec3& position = points.at(i)._position;
+        _positionsX[ragdoll.firstPoint + i] = position.x;
+        _positionsY[ragdoll.firstPoint + i] = position.y;
+        _positionsZ[ragdoll.firstPoint + i] = position.z;
+    }
+}
+
+void RagdollBatch::getPoints(int ragdollIndex, QVector<VerletPoint>& points) const {
+    const RagdollRange& ragdoll = _ragdolls.at(ragdollIndex);
+    assert(points.size() == ragdoll.numPoints);
+    for (int i = 0; i < ragdoll.numPoints; ++i) {
+        points[i]._position = glm::vec3(_positionsX.at(ragdoll.firstPoint + i), _positionsY.at(ragdoll.firstPoint + i),
+            _positionsZ.at(ragdoll.firstPoint + i));
+    }
+}
+
+float RagdollBatch::enforceConstraints() {
+    if (_batchesAreDirty) {
+        buildBatches();
+    }
+    float maxDistance = 0.0f;
+    for (int i = 0; i < _groups.size(); ++i) {
+        maxDistance = glm::max(maxDistance, projectConstraints(_groups.at(i)));
+    }
+    return maxDistance;
+}
+
+float RagdollBatch::enforceAllConstraints(float minError, int maxIterations) {
+    if (_batchesAreDirty) {
+        buildBatches();
+    }
+    _minError = minError;
+    _maxIterations = maxIterations;
+    int numWorkers = _rangeSplitter.getNumWorkers(_groups.size());
+    _workerErrors.fill(0.0f, numWorkers);
+    _workerIterations.fill(0, numWorkers);
+    _rangeSplitter.run(*this, _groups.size());
+
+    float error = 0.0f;
+    _numIterations = 0;
+    for (int i = 0; i < numWorkers; ++i) {
+        error = glm::max(error, _workerErrors.at(i));
+        _numIterations += _workerIterations.at(i);
+    }
+    return error;
+}
+
+void RagdollBatch::processRange(int worker, int firstGroup, int lastGroup) {
+    _workerErrors[worker] = relaxGroups(firstGroup, lastGroup, _minError, _maxIterations, _workerIterations[worker]);
+}
+
+void RagdollBatch::buildBatches() {
+    int numRagdolls = _ragdolls.size();
+    QVector<QVector<int> > fixedConstraintsByRagdoll(numRagdolls);
+    for (int i = 0; i < _addedFixedConstraints.size(); ++i) {
+        fixedConstraintsByRagdoll[_addedFixedConstraints.at(i).ragdollIndex].push_back(i);
+    }
+    QVector<QVector<int> > distanceConstraintsByRagdoll(numRagdolls);
+    for (int i = 0; i < _addedDistanceConstraints.size(); ++i) {
+        distanceConstraintsByRagdoll[_addedDistanceConstraints.at(i).ragdollIndex].push_back(i);
+    }
+
+    _groups.clear();
+    _fixedPoints.clear();
+    _fixedAnchors.clear();
+    _batches.clear();
+    _constraintPointsA.clear();
+    _constraintPointsB.clear();
+    _constraintDistances.clear();
+
+    QVector<int> constraintPointsA;
+    QVector<int> constraintPointsB;
+    QVector<float> constraintDistances;
+    QVector<int> colors;
+    QVector<QVector<bool> > pointsUsedByColor;
+    for (int firstRagdoll = 0; firstRagdoll < numRagdolls; firstRagdoll += RAGDOLLS_PER_GROUP) {
+        int lastRagdoll = qMin(firstRagdoll + RAGDOLLS_PER_GROUP, numRagdolls);
+        int firstPoint = _ragdolls.at(firstRagdoll).firstPoint;
+        int numPoints = _ragdolls.at(lastRagdoll - 1).firstPoint + _ragdolls.at(lastRagdoll - 1).numPoints - firstPoint;
+
+        RagdollGroup group = { _batches.size(), 0, _fixedPoints.size(), 0 };
+        constraintPointsA.clear();
+        constraintPointsB.clear();
+        constraintDistances.clear();
+        for (int r = firstRagdoll; r < lastRagdoll; ++r) {
+            const RagdollRange& ragdoll = _ragdolls.at(r);
+            foreach (int index, fixedConstraintsByRagdoll.at(r)) {
+                const FixedConstraintData& constraint = _addedFixedConstraints.at(index);
+                _fixedPoints.push_back(ragdoll.firstPoint + constraint.pointIndex);
+                _fixedAnchors.push_back(constraint.anchor);
+                ++group.numFixedConstraints;
+            }
+            foreach (int index, distanceConstraintsByRagdoll.at(r)) {
+                const DistanceConstraintData& constraint = _addedDistanceConstraints.at(index);
+                constraintPointsA.push_back(ragdoll.firstPoint + constraint.pointIndexA);
+                constraintPointsB.push_back(ragdoll.firstPoint + constraint.pointIndexB);
+                constraintDistances.push_back(constraint.distance);
+            }
+        }
+
+        // greedy coloring, in the order the constraints were added: each constraint takes the first color
+        // that neither of its points has been used by yet
+        int numConstraints = constraintDistances.size();
+        colors.resize(numConstraints);
+        pointsUsedByColor.clear();
+        for (int i = 0; i < numConstraints; ++i) {
+            int pointA = constraintPointsA.at(i) - firstPoint;
+            int pointB = constraintPointsB.at(i) - firstPoint;
+            int color = 0;
+            while (color < group.numBatches &&
+                    (pointsUsedByColor.at(color).at(pointA) || pointsUsedByColor.at(color).at(pointB))) {
+                ++color;
+            }
+            if (color == group.numBatches) {
+                pointsUsedByColor.push_back(QVector<bool>(numPoints, false));
+                ++group.numBatches;
+            }
+            pointsUsedByColor[color][pointA] = true;
+            pointsUsedByColor[color][pointB] = true;
+            colors[i] = color;
+        }
+
+        for (int color = 0; color < group.numBatches; ++color) {
+            ConstraintBatch batch = { _constraintDistances.size(), 0 };
+            for (int i = 0; i < numConstraints; ++i) {
+                if (colors.at(i) == color) {
+                    _constraintPointsA.push_back(constraintPointsA.at(i));
+                    _constraintPointsB.push_back(constraintPointsB.at(i));
+                    _constraintDistances.push_back(constraintDistances.at(i));
+                    ++batch.numConstraints;
+                }
+            }
+            _batches.push_back(batch);
+        }
+        _groups.push_back(group);
+    }
+    _batchesAreDirty = false;
+}
+
+float RagdollBatch::projectConstraints(const RagdollGroup& group) {
+    float* positionsX = _positionsX.data();
+    float* positionsY = _positionsY.data();
+    float* positionsZ = _positionsZ.data();
+
+    float maxDistance = 0.0f;
+    int lastFixedConstraint = group.firstFixedConstraint + group.numFixedConstraints;
+    for (int i = group.firstFixedConstraint; i < lastFixedConstraint; ++i) {
+        int point = _fixedPoints.at(i);
+        const glm::vec3& anchor = _fixedAnchors.at(i);
+        glm::vec3 position(positionsX[point], positionsY[point], positionsZ[point]);
+        maxDistance = glm::max(maxDistance, glm::distance(anchor, position));
+        positionsX[point] = anchor.x;
+        positionsY[point] = anchor.y;
+        positionsZ[point] = anchor.z;
+    }
+
+    const ConstraintBatch* batches = _batches.constData();
+    int lastBatch = group.firstBatch + group.numBatches;
+    for (int i = group.firstBatch; i < lastBatch; ++i) {
+        maxDistance = glm::max(maxDistance, projectDistanceBatch(batches[i]));
+    }
+    return maxDistance;
+}
+
+float RagdollBatch::projectDistanceBatch(const ConstraintBatch& batch) {
+    float* positionsX = _positionsX.data();
+    float* positionsY = _positionsY.data();
+    float* positionsZ = _positionsZ.data();
+    const int* pointsA = _constraintPointsA.constData() + batch.firstConstraint;
+    const int* pointsB = _constraintPointsB.constData() + batch.firstConstraint;
+    const float* distances = _constraintDistances.constData() + batch.firstConstraint;
+
+    float ax[CONSTRAINT_BLOCK_SIZE], ay[CONSTRAINT_BLOCK_SIZE], az[CONSTRAINT_BLOCK_SIZE];
+    float bx[CONSTRAINT_BLOCK_SIZE], by[CONSTRAINT_BLOCK_SIZE], bz[CONSTRAINT_BLOCK_SIZE];
+    float errors[CONSTRAINT_BLOCK_SIZE];
+
+    float maxDistance = 0.0f;
+    for (int first = 0; first < batch.numConstraints; first += CONSTRAINT_BLOCK_SIZE) {
+        int count = qMin(CONSTRAINT_BLOCK_SIZE, batch.numConstraints - first);
+
+        // gather
+        for (int i = 0; i < count; ++i) {
+            int a = pointsA[first + i];
+            int b = pointsB[first + i];
+            ax[i] = positionsX[a];
+            ay[i] = positionsY[a];
+            az[i] = positionsZ[a];
+            bx[i] = positionsX[b];
+            by[i] = positionsY[b];
+            bz[i] = positionsZ[b];
+        }
+
+        // project, with the same result as DistanceConstraint::enforce() but without branches,
+        // so that the compiler can run it across several constraints at a time
+        const float* blockDistances = distances + first;
+        for (int i = 0; i < count; ++i) {
+            float dx = ax[i] - bx[i];
+            float dy = ay[i] - by[i];
+            float dz = az[i] - bz[i];
+            float length = sqrtf(dx * dx + dy * dy + dz * dz);
+            // points closer than EPSILON are pushed apart along the y axis
+            float isLong = (float)(length > EPSILON);
+            float inverseLength = isLong / glm::max(length, EPSILON);
+            float directionX = dx * inverseLength;
+            float directionY = dy * inverseLength + (1.0f - isLong);
+            float directionZ = dz * inverseLength;
+            float halfDistance = 0.5f * blockDistances[i];
+            float centerX = 0.5f * (ax[i] + bx[i]);
+            float centerY = 0.5f * (ay[i] + by[i]);
+            float centerZ = 0.5f * (az[i] + bz[i]);
+            ax[i] = centerX + halfDistance * directionX;
+            ay[i] = centerY + halfDistance * directionY;
+            az[i] = centerZ + halfDistance * directionZ;
+            bx[i] = centerX - halfDistance * directionX;
+            by[i] = centerY - halfDistance * directionY;
+            bz[i] = centerZ - halfDistance * directionZ;
+            errors[i] = fabsf(length - blockDistances[i]);
+        }
+
+        // scatter: no two constraints in a batch share a point, so the order doesn't matter
+        for (int i = 0; i < count; ++i) {
+            int a = pointsA[first + i];
+            int b = pointsB[first + i];
+            positionsX[a] = ax[i];
+            positionsY[a] = ay[i];
+            positionsZ[a] = az[i];
+            positionsX[b] = bx[i];
+            positionsY[b] = by[i];
+            positionsZ[b] = bz[i];
+            maxDistance = glm::max(maxDistance, errors[i]);
+        }
+    }
+    return maxDistance;
+}
+
+float RagdollBatch::relaxGroups(int firstGroup, int lastGroup, float minError, int maxIterations,
+        int& numIterations) {
+    float maxError = 0.0f;
+    numIterations = 0;
+    for (int i = firstGroup; i < lastGroup; ++i) {
+        const RagdollGroup& group = _groups.at(i);
+        float error = 0.0f;
+        int iterations = 0;
+        do {
+            error = projectConstraints(group);
+            ++iterations;
+        } while (error > minError && iterations < maxIterations);
+        maxError = glm::max(maxError, error);
+        numIterations += iterations;
+    }
+    return maxError;
+}
@@ -0,0 +1,151 @@
+//
+//  RagdollBatch.h
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RagdollBatch_h
+#define hifi_RagdollBatch_h
+
+#include <glm/glm.hpp>
+
+#include <QVector>
+
+#include "Ragdoll.h"
+#include "RangeSplitter.h"
+
+/// Solves the constraints of many ragdolls at once.  Enforces the same FixedConstraint and DistanceConstraint rules as
+/// Ragdoll::enforceRagdollConstraints(), but with a layout built for throughput:
+///
+/// - the point positions of all ragdolls live in one array per coordinate
+/// - the constraints are flat arrays of point indices and rest lengths, with no virtual calls per constraint
+/// - the distance constraints of a group of ragdolls are colored into batches in which no two constraints share a
+///   point, so every constraint in a batch can be projected at the same time by loops the compiler can vectorize
+/// - groups don't share points, so enforceAllConstraints() relaxes them in parallel with a RangeSplitter
+///
+/// Because a batch projects its constraints simultaneously rather than one after the other, an iteration moves the
+/// points in a different order than Ragdoll does, so the two converge to the same rest lengths along different paths.
+class RagdollBatch : public RangeWork {
+public:
+    RagdollBatch();
+
+    /// Removes all ragdolls and constraints.
+    void clear();
+
+    /// Copies the positions of the points into the batch.
+    /// \return the index of the ragdoll
+    int addRagdoll(const QVector<VerletPoint>& points);
+
+    /// Pins a point of a ragdoll to the anchor, like a FixedConstraint.
+    void addFixedConstraint(int ragdollIndex, int pointIndex, const glm::vec3& anchor);
+
+    /// Keeps two points of a ragdoll at their current distance, like a DistanceConstraint.
+    void addDistanceConstraint(int ragdollIndex, int pointIndexA, int pointIndexB);
+
+    int getNumRagdolls() const { return _ragdolls.size(); }
+
+    /// Copies positions in from the points of a ragdoll, which must have as many points as when it was added.
+    void setPoints(int ragdollIndex, const QVector<VerletPoint>& points);
+
+    /// Copies positions back out to the points of a ragdoll, leaving their other fields alone.
+    void getPoints(int ragdollIndex, QVector<VerletPoint>& points) const;
+
+    /// Runs one pass over the constraints of all ragdolls on the calling thread.
+    /// \return max distance of point movement
+    float enforceConstraints();
+
+    /// Relaxes each group of ragdolls until its error is below minError or it has run maxIterations passes, spreading
+    /// the groups over the thread pool.
+    /// \return the largest remaining error
+    float enforceAllConstraints(float minError, int maxIterations);
+
+    /// \return the number of passes the last enforceAllConstraints() ran, summed over the groups
+    int getNumIterations() const { return _numIterations; }
+
+    int getNumGroups() const { return _groups.size(); }
+
+private:
+    class RagdollRange {
+    public:
+        int firstPoint;
+        int numPoints;
+    };
+
+    class RagdollGroup {
+    public:
+        int firstBatch;
+        int numBatches;
+        int firstFixedConstraint;
+        int numFixedConstraints;
+    };
+
+    class ConstraintBatch {
+    public:
+        int firstConstraint;
+        int numConstraints;
+    };
+
+    class FixedConstraintData {
+    public:
+        int ragdollIndex;
+        int pointIndex;
+        glm::vec3 anchor;
+    };
+
+    class DistanceConstraintData {
+    public:
+        int ragdollIndex;
+        int pointIndexA;
+        int pointIndexB;
+        float distance;
+    };
+
+    void buildBatches();
+    float projectConstraints(const RagdollGroup& group);
+    float projectDistanceBatch(const ConstraintBatch& batch);
+
+    /// Relaxes the groups in [firstGroup, lastGroup).  Runs on the worker threads, so the batches must be built.
+    float relaxGroups(int firstGroup, int lastGroup, float minError, int maxIterations, int& numIterations);
+
+    /// relaxes a run of groups for enforceAllConstraints()
+    virtual void processRange(int worker, int firstGroup, int lastGroup);
+
+    QVector<RagdollRange> _ragdolls;
+    QVector<RagdollGroup> _groups;
+
+    // positions of the points of all ragdolls, by coordinate
+    QVector<float> _positionsX;
+    QVector<float> _positionsY;
+    QVector<float> _positionsZ;
+
+    // the constraints as added, rebuilt into the arrays below when they change
+    QVector<FixedConstraintData> _addedFixedConstraints;
+    QVector<DistanceConstraintData> _addedDistanceConstraints;
+    bool _batchesAreDirty;
+
+    QVector<int> _fixedPoints;
+    QVector<glm::vec3> _fixedAnchors;
+
+    // distance constraints, ordered by group and then by batch
+    QVector<ConstraintBatch> _batches;
+    QVector<int> _constraintPointsA;
+    QVector<int> _constraintPointsB;
+    QVector<float> _constraintDistances;
+
+    int _numIterations;
+
+    // what enforceAllConstraints() relaxes to, and what each worker got to
+    float _minError;
+    int _maxIterations;
+    QVector<float> _workerErrors;
+    QVector<int> _workerIterations;
+
+    RangeSplitter _rangeSplitter;
+};
+
+#endif // hifi_RagdollBatch_h
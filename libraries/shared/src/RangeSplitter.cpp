@@ -0,0 +1,80 @@
+//
+//  RangeSplitter.cpp
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QRunnable>
+#include <QThread>
+
+#include "RangeSplitter.h"
+
+class RangeSplitterRunner : public QRunnable {
+public:
+    RangeSplitterRunner() :
+        _work(NULL),
+        _worker(0),
+        _firstItem(0),
+        _lastItem(0) {
+        setAutoDelete(false);
+    }
+
+    void setWork(RangeWork* work, int worker, int firstItem, int lastItem) {
+        _work = work;
+        _worker = worker;
+        _firstItem = firstItem;
+        _lastItem = lastItem;
+    }
+
+    virtual void run() {
+        _work->processRange(_worker, _firstItem, _lastItem);
+    }
+
+private:
+    RangeWork* _work;
+    int _worker;
+    int _firstItem;
+    int _lastItem;
+};
+
+RangeSplitter::RangeSplitter() :
+    _threadPool(),
+    _runners() {
+}
+
+RangeSplitter::~RangeSplitter() {
+    _threadPool.waitForDone();
+    foreach (RangeSplitterRunner* runner, _runners) {
+        delete runner;
+    }
+}
+
+int RangeSplitter::getNumWorkers(int numItems) const {
+    return qMax(1, qMin(QThread::idealThreadCount(), numItems));
+}
+
+int RangeSplitter::run(RangeWork& work, int numItems) {
+    int numWorkers = getNumWorkers(numItems);
+    if (numWorkers == 1) {
+        work.processRange(0, 0, numItems);
+        return numWorkers;
+    }
+
+    while (_runners.size() < numWorkers) {
+        _runners.push_back(new RangeSplitterRunner());
+    }
+    for (int i = 0; i < numWorkers; ++i) {
+        _runners.at(i)->setWork(&work, i, numItems * i / numWorkers, numItems * (i + 1) / numWorkers);
+    }
+    for (int i = 1; i < numWorkers; ++i) {
+        _threadPool.start(_runners.at(i));
+    }
+    _runners.at(0)->run();
+    _threadPool.waitForDone();
+    return numWorkers;
+}
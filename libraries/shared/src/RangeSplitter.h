@@ -0,0 +1,49 @@
+//
+//  RangeSplitter.h
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RangeSplitter_h
+#define hifi_RangeSplitter_h
+
+#include <QThreadPool>
+#include <QVector>
+
+class RangeSplitterRunner;
+
+/// Work on a number of items that can be done in contiguous runs of them, on several threads at once.
+class RangeWork {
+public:
+    virtual ~RangeWork() { }
+
+    /// Does the items in [firstItem, lastItem). The worker, from zero up to the number of workers the work was split
+    /// over, says which buffers or results of the work the run may use; no two runs going at once have the same one.
+    virtual void processRange(int worker, int firstItem, int lastItem) = 0;
+};
+
+/// Splits work on items into one contiguous run per worker and runs them on a thread pool of its own, the first run on
+/// the calling thread. The runners are kept from one call to the next.
+class RangeSplitter {
+public:
+    RangeSplitter();
+    ~RangeSplitter();
+
+    /// \return the number of workers run() splits this many items over, at least one
+    int getNumWorkers(int numItems) const;
+
+    /// Does all of the items and returns once they're done.
+    /// \return the number of workers the items were split over, as getNumWorkers() tells beforehand
+    int run(RangeWork& work, int numItems);
+
+private:
+    QThreadPool _threadPool;
+    QVector<RangeSplitterRunner*> _runners;
+};
+
+#endif // hifi_RangeSplitter_h
@@ -27,7 +27,8 @@ public:
         SPHERE_SHAPE,
         CAPSULE_SHAPE,
         PLANE_SHAPE,
-        LIST_SHAPE
+        LIST_SHAPE,
+        NUM_SHAPE_TYPES
     };
 
     Shape() : _type(UNKNOWN_SHAPE), _owningEntity(NULL), _boundingRadius(0.f), _translation(0.f), _rotation(), _mass(MAX_SHAPE_MASS) { }
@@ -0,0 +1,139 @@
+//
+//  ShapeBatch.cpp
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ShapeBatch.h"
+
+#include "CapsuleShape.h"
+#include "SharedUtil.h"
+#include "SphereShape.h"
+
+SphereBatch::SphereBatch() :
+    _spheres(),
+    _centersX(),
+    _centersY(),
+    _centersZ(),
+    _radii() {
+}
+
+void SphereBatch::clear() {
+    _spheres.clear();
+    _centersX.clear();
+    _centersY.clear();
+    _centersZ.clear();
+    _radii.clear();
+}
+
+void SphereBatch::addSphere(const SphereShape* sphere) {
+    assert(sphere);
+    _spheres.push_back(sphere);
+    int newSize = _spheres.size();
+    _centersX.resize(newSize);
+    _centersY.resize(newSize);
+    _centersZ.resize(newSize);
+    _radii.resize(newSize);
+    copyShape(newSize - 1);
+}
+
+void SphereBatch::updateShapes() {
+    for (int i = 0; i < _spheres.size(); ++i) {
+        copyShape(i);
+    }
+}
+
+void SphereBatch::copyShape(int index) {
+    const SphereShape* sphere = _spheres.at(index);
+    const glm::vec3& center = sphere->getTranslation();
+    _centersX[index] = center.x;
+    _centersY[index] = center.y;
+    _centersZ[index] = center.z;
+    _radii[index] = sphere->getRadius();
+}
+
+CapsuleBatch::CapsuleBatch() :
+    _capsules(),
+    _startsX(),
+    _startsY(),
+    _startsZ(),
+    _axesX(),
+    _axesY(),
+    _axesZ(),
+    _inverseAxisLengths2(),
+    _radii(),
+    _centersX(),
+    _centersY(),
+    _centersZ(),
+    _boundingRadii() {
+}
+
+void CapsuleBatch::clear() {
+    _capsules.clear();
+    _startsX.clear();
+    _startsY.clear();
+    _startsZ.clear();
+    _axesX.clear();
+    _axesY.clear();
+    _axesZ.clear();
+    _inverseAxisLengths2.clear();
+    _radii.clear();
+    _centersX.clear();
+    _centersY.clear();
+    _centersZ.clear();
+    _boundingRadii.clear();
+}
+
+void CapsuleBatch::addCapsule(const CapsuleShape* capsule) {
+    assert(capsule);
+    _capsules.push_back(capsule);
+    int newSize = _capsules.size();
+    _startsX.resize(newSize);
+    _startsY.resize(newSize);
+    _startsZ.resize(newSize);
+    _axesX.resize(newSize);
+    _axesY.resize(newSize);
+    _axesZ.resize(newSize);
+    _inverseAxisLengths2.resize(newSize);
+    _radii.resize(newSize);
+    _centersX.resize(newSize);
+    _centersY.resize(newSize);
+    _centersZ.resize(newSize);
+    _boundingRadii.resize(newSize);
+    copyShape(newSize - 1);
+}
+
+void CapsuleBatch::updateShapes() {
+    for (int i = 0; i < _capsules.size(); ++i) {
+        copyShape(i);
+    }
+}
+
+void CapsuleBatch::copyShape(int index) {
+    const CapsuleShape* capsule = _capsules.at(index);
+    glm::vec3 start, end;
+    capsule->getStartPoint(start);
+    capsule->getEndPoint(end);
+    glm::vec3 axis = end - start;
+    float axisLength2 = glm::dot(axis, axis);
+    glm::vec3 center = start + 0.5f * axis;
+
+    _startsX[index] = start.x;
+    _startsY[index] = start.y;
+    _startsZ[index] = start.z;
+    _axesX[index] = axis.x;
+    _axesY[index] = axis.y;
+    _axesZ[index] = axis.z;
+    _inverseAxisLengths2[index] = (axisLength2 > EPSILON * EPSILON) ? 1.0f / axisLength2 : 0.0f;
+    _radii[index] = capsule->getRadius();
+    _centersX[index] = center.x;
+    _centersY[index] = center.y;
+    _centersZ[index] = center.z;
+    // computed here rather than taken from the shape, whose bounding radius can lag behind its end points
+    _boundingRadii[index] = capsule->getRadius() + 0.5f * sqrtf(axisLength2);
+}
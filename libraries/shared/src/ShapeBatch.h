@@ -0,0 +1,104 @@
+//
+//  ShapeBatch.h
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeBatch_h
+#define hifi_ShapeBatch_h
+
+#include <glm/glm.hpp>
+
+#include <QVector>
+
+class CapsuleShape;
+class SphereShape;
+
+// SphereBatch and CapsuleBatch copy the geometry of many shapes of one type into one array per coordinate, for the
+// ShapeCollider functions that collide one shape against all of them at once.  The copies are taken when a shape is
+// added, so call updateShapes() after the shapes move.
+
+class SphereBatch {
+public:
+    SphereBatch();
+
+    void clear();
+    void addSphere(const SphereShape* sphere);
+
+    /// Copies the current positions and radii of the spheres.
+    void updateShapes();
+
+    int size() const { return _spheres.size(); }
+    const SphereShape* getSphere(int index) const { return _spheres.at(index); }
+
+    const float* getCentersX() const { return _centersX.constData(); }
+    const float* getCentersY() const { return _centersY.constData(); }
+    const float* getCentersZ() const { return _centersZ.constData(); }
+    const float* getRadii() const { return _radii.constData(); }
+
+private:
+    void copyShape(int index);
+
+    QVector<const SphereShape*> _spheres;
+    QVector<float> _centersX;
+    QVector<float> _centersY;
+    QVector<float> _centersZ;
+    QVector<float> _radii;
+};
+
+class CapsuleBatch {
+public:
+    CapsuleBatch();
+
+    void clear();
+    void addCapsule(const CapsuleShape* capsule);
+
+    /// Copies the current end points and radii of the capsules.
+    void updateShapes();
+
+    int size() const { return _capsules.size(); }
+    const CapsuleShape* getCapsule(int index) const { return _capsules.at(index); }
+
+    const float* getStartsX() const { return _startsX.constData(); }
+    const float* getStartsY() const { return _startsY.constData(); }
+    const float* getStartsZ() const { return _startsZ.constData(); }
+
+    /// the axes run from the start points to the end points
+    const float* getAxesX() const { return _axesX.constData(); }
+    const float* getAxesY() const { return _axesY.constData(); }
+    const float* getAxesZ() const { return _axesZ.constData(); }
+
+    /// one over the squared axis lengths, or zero for capsules that are spheres
+    const float* getInverseAxisLengths2() const { return _inverseAxisLengths2.constData(); }
+
+    const float* getRadii() const { return _radii.constData(); }
+
+    const float* getCentersX() const { return _centersX.constData(); }
+    const float* getCentersY() const { return _centersY.constData(); }
+    const float* getCentersZ() const { return _centersZ.constData(); }
+    const float* getBoundingRadii() const { return _boundingRadii.constData(); }
+
+private:
+    void copyShape(int index);
+
+    QVector<const CapsuleShape*> _capsules;
+    QVector<float> _startsX;
+    QVector<float> _startsY;
+    QVector<float> _startsZ;
+    QVector<float> _axesX;
+    QVector<float> _axesY;
+    QVector<float> _axesZ;
+    QVector<float> _inverseAxisLengths2;
+    QVector<float> _radii;
+    QVector<float> _centersX;
+    QVector<float> _centersY;
+    QVector<float> _centersZ;
+    QVector<float> _boundingRadii;
+};
+
+#endif // hifi_ShapeBatch_h
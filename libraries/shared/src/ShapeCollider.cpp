@@ -23,48 +23,53 @@
 
 namespace ShapeCollider {
 
+typedef bool (*CollisionFunction)(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions);
+
+// adapts a pair function to the common signature of the dispatch table
+template<typename ShapeTypeA, typename ShapeTypeB, bool (*collide)(const ShapeTypeA*, const ShapeTypeB*, CollisionList&)>
+static bool collidePair(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions) {
+    return collide(static_cast<const ShapeTypeA*>(shapeA), static_cast<const ShapeTypeB*>(shapeB), collisions);
+}
+
+static bool noCollision(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions) {
+    return false;
+}
+
+// indexed by [typeA][typeB], built by the compiler; lists are only dispatched as shapeA
+static const CollisionFunction collisionFunctions[Shape::NUM_SHAPE_TYPES][Shape::NUM_SHAPE_TYPES] = {
+    // UNKNOWN_SHAPE
+    { noCollision, noCollision, noCollision, noCollision, noCollision },
+    // SPHERE_SHAPE
+    { noCollision,
+      collidePair<SphereShape, SphereShape, sphereSphere>,
+      collidePair<SphereShape, CapsuleShape, sphereCapsule>,
+      collidePair<SphereShape, PlaneShape, spherePlane>,
+      noCollision },
+    // CAPSULE_SHAPE
+    { noCollision,
+      collidePair<CapsuleShape, SphereShape, capsuleSphere>,
+      collidePair<CapsuleShape, CapsuleShape, capsuleCapsule>,
+      collidePair<CapsuleShape, PlaneShape, capsulePlane>,
+      noCollision },
+    // PLANE_SHAPE
+    { noCollision,
+      collidePair<PlaneShape, SphereShape, planeSphere>,
+      collidePair<PlaneShape, CapsuleShape, planeCapsule>,
+      collidePair<PlaneShape, PlaneShape, planePlane>,
+      noCollision },
+    // LIST_SHAPE
+    { noCollision,
+      collidePair<ListShape, SphereShape, listSphere>,
+      collidePair<ListShape, CapsuleShape, listCapsule>,
+      collidePair<ListShape, PlaneShape, listPlane>,
+      noCollision }
+};
+
 bool collideShapes(const Shape* shapeA, const Shape* shapeB, CollisionList& collisions) {
-    // TODO: make a fast lookup for correct method
     int typeA = shapeA->getType();
     int typeB = shapeB->getType();
-    if (typeA == Shape::SPHERE_SHAPE) {
-        const SphereShape* sphereA = static_cast<const SphereShape*>(shapeA);
-        if (typeB == Shape::SPHERE_SHAPE) {
-            return sphereSphere(sphereA, static_cast<const SphereShape*>(shapeB), collisions);
-        } else if (typeB == Shape::CAPSULE_SHAPE) {
-            return sphereCapsule(sphereA, static_cast<const CapsuleShape*>(shapeB), collisions);
-        } else if (typeB == Shape::PLANE_SHAPE) {
-            return spherePlane(sphereA, static_cast<const PlaneShape*>(shapeB), collisions);
-        }
-    } else if (typeA == Shape::CAPSULE_SHAPE) {
-        const CapsuleShape* capsuleA = static_cast<const CapsuleShape*>(shapeA);
-        if (typeB == Shape::SPHERE_SHAPE) {
-            return capsuleSphere(capsuleA, static_cast<const SphereShape*>(shapeB), collisions);
-        } else if (typeB == Shape::CAPSULE_SHAPE) {
-            return capsuleCapsule(capsuleA, static_cast<const CapsuleShape*>(shapeB), collisions);
-        } else if (typeB == Shape::PLANE_SHAPE) {
-            return capsulePlane(capsuleA, static_cast<const PlaneShape*>(shapeB), collisions);
-        }
-    } else if (typeA == Shape::PLANE_SHAPE) {
-        const PlaneShape* planeA = static_cast<const PlaneShape*>(shapeA);
-        if (typeB == Shape::SPHERE_SHAPE) {
-            return planeSphere(planeA, static_cast<const SphereShape*>(shapeB), collisions);
-        } else if (typeB == Shape::CAPSULE_SHAPE) {
-            return planeCapsule(planeA, static_cast<const CapsuleShape*>(shapeB), collisions);
-        } else if (typeB == Shape::PLANE_SHAPE) {
-            return planePlane(planeA, static_cast<const PlaneShape*>(shapeB), collisions);
-        }
-    } else if (typeA == Shape::LIST_SHAPE) {
-        const ListShape* listA = static_cast<const ListShape*>(shapeA);
-        if (typeB == Shape::SPHERE_SHAPE) {
-            return listSphere(listA, static_cast<const SphereShape*>(shapeB), collisions);
-        } else if (typeB == Shape::CAPSULE_SHAPE) {
-            return listCapsule(listA, static_cast<const CapsuleShape*>(shapeB), collisions);
-        } else if (typeB == Shape::PLANE_SHAPE) {
-            return listPlane(listA, static_cast<const PlaneShape*>(shapeB), collisions);
-        }
-    }
-    return false;
+    assert(typeA >= 0 && typeA < Shape::NUM_SHAPE_TYPES && typeB >= 0 && typeB < Shape::NUM_SHAPE_TYPES);
+    return collisionFunctions[typeA][typeB](shapeA, shapeB, collisions);
 }
 
 static CollisionList tempCollisions(32);
@@ -841,4 +846,170 @@ bool findRayIntersectionWithShapes(const QVector<Shape*> shapes, const glm::vec3
     return false;
 }
 
+// Batches are collided in blocks: a loop without branches over each block, which the compiler can vectorize, finds
+// the members that come within reach of shapeA; then the exact pair function runs on just those.  The reach is padded
+// a little so that rounding never drops a pair the pair function would have accepted.
+const int BATCH_BLOCK_SIZE = 64;
+const float BATCH_REACH_SCALE = 1.0001f;
+const float BATCH_REACH_PADDING = 1.0e-4f;
+
+// finds the points in [first, first + count) within reach of the segment from start along axis (which may be zero)
+static int findPointsNearSegment(const glm::vec3& start, const glm::vec3& axis, float inverseAxisLength2, float radius,
+        const float* pointsX, const float* pointsY, const float* pointsZ, const float* radii,
+        int first, int count, int* hits) {
+    int isNear[BATCH_BLOCK_SIZE];
+    for (int i = 0; i < count; ++i) {
+        float dx = pointsX[first + i] - start.x;
+        float dy = pointsY[first + i] - start.y;
+        float dz = pointsZ[first + i] - start.z;
+        float t = glm::clamp((dx * axis.x + dy * axis.y + dz * axis.z) * inverseAxisLength2, 0.0f, 1.0f);
+        dx -= t * axis.x;
+        dy -= t * axis.y;
+        dz -= t * axis.z;
+        float reach = (radius + radii[first + i]) * BATCH_REACH_SCALE + BATCH_REACH_PADDING;
+        isNear[i] = (dx * dx + dy * dy + dz * dz <= reach * reach);
+    }
+    int numHits = 0;
+    for (int i = 0; i < count; ++i) {
+        if (isNear[i]) {
+            hits[numHits++] = first + i;
+        }
+    }
+    return numHits;
+}
+
+// finds the segments of the batch in [first, first + count) within reach of the point
+static int findSegmentsNearPoint(const glm::vec3& point, float radius, const CapsuleBatch& segments,
+        int first, int count, int* hits) {
+    const float* startsX = segments.getStartsX();
+    const float* startsY = segments.getStartsY();
+    const float* startsZ = segments.getStartsZ();
+    const float* axesX = segments.getAxesX();
+    const float* axesY = segments.getAxesY();
+    const float* axesZ = segments.getAxesZ();
+    const float* inverseAxisLengths2 = segments.getInverseAxisLengths2();
+    const float* radii = segments.getRadii();
+    int isNear[BATCH_BLOCK_SIZE];
+    for (int i = 0; i < count; ++i) {
+        int j = first + i;
+        float dx = point.x - startsX[j];
+        float dy = point.y - startsY[j];
+        float dz = point.z - startsZ[j];
+        float t = glm::clamp((dx * axesX[j] + dy * axesY[j] + dz * axesZ[j]) * inverseAxisLengths2[j], 0.0f, 1.0f);
+        dx -= t * axesX[j];
+        dy -= t * axesY[j];
+        dz -= t * axesZ[j];
+        float reach = (radius + radii[j]) * BATCH_REACH_SCALE + BATCH_REACH_PADDING;
+        isNear[i] = (dx * dx + dy * dy + dz * dz <= reach * reach);
+    }
+    int numHits = 0;
+    for (int i = 0; i < count; ++i) {
+        if (isNear[i]) {
+            hits[numHits++] = first + i;
+        }
+    }
+    return numHits;
+}
+
+int sphereSpheres(const SphereShape* sphereA, const SphereBatch& spheresB, CollisionList& collisions) {
+    int oldSize = collisions.size();
+    const glm::vec3& center = sphereA->getTranslation();
+    const glm::vec3 noAxis(0.0f);
+    int hits[BATCH_BLOCK_SIZE];
+    for (int first = 0; first < spheresB.size() && !collisions.isFull(); first += BATCH_BLOCK_SIZE) {
+        int count = qMin(BATCH_BLOCK_SIZE, spheresB.size() - first);
+        int numHits = findPointsNearSegment(center, noAxis, 0.0f, sphereA->getRadius(), spheresB.getCentersX(),
+            spheresB.getCentersY(), spheresB.getCentersZ(), spheresB.getRadii(), first, count, hits);
+        for (int i = 0; i < numHits && !collisions.isFull(); ++i) {
+            sphereSphere(sphereA, spheresB.getSphere(hits[i]), collisions);
+        }
+    }
+    return collisions.size() - oldSize;
+}
+
+int sphereCapsules(const SphereShape* sphereA, const CapsuleBatch& capsulesB, CollisionList& collisions) {
+    int oldSize = collisions.size();
+    const glm::vec3& center = sphereA->getTranslation();
+    int hits[BATCH_BLOCK_SIZE];
+    for (int first = 0; first < capsulesB.size() && !collisions.isFull(); first += BATCH_BLOCK_SIZE) {
+        int count = qMin(BATCH_BLOCK_SIZE, capsulesB.size() - first);
+        int numHits = findSegmentsNearPoint(center, sphereA->getRadius(), capsulesB, first, count, hits);
+        for (int i = 0; i < numHits && !collisions.isFull(); ++i) {
+            sphereCapsule(sphereA, capsulesB.getCapsule(hits[i]), collisions);
+        }
+    }
+    return collisions.size() - oldSize;
+}
+
+int capsuleSpheres(const CapsuleShape* capsuleA, const SphereBatch& spheresB, CollisionList& collisions) {
+    int oldSize = collisions.size();
+    glm::vec3 start, end;
+    capsuleA->getStartPoint(start);
+    capsuleA->getEndPoint(end);
+    glm::vec3 axis = end - start;
+    float axisLength2 = glm::dot(axis, axis);
+    float inverseAxisLength2 = (axisLength2 > EPSILON * EPSILON) ? 1.0f / axisLength2 : 0.0f;
+    int hits[BATCH_BLOCK_SIZE];
+    for (int first = 0; first < spheresB.size() && !collisions.isFull(); first += BATCH_BLOCK_SIZE) {
+        int count = qMin(BATCH_BLOCK_SIZE, spheresB.size() - first);
+        int numHits = findPointsNearSegment(start, axis, inverseAxisLength2, capsuleA->getRadius(),
+            spheresB.getCentersX(), spheresB.getCentersY(), spheresB.getCentersZ(), spheresB.getRadii(),
+            first, count, hits);
+        for (int i = 0; i < numHits && !collisions.isFull(); ++i) {
+            capsuleSphere(capsuleA, spheresB.getSphere(hits[i]), collisions);
+        }
+    }
+    return collisions.size() - oldSize;
+}
+
+int capsuleCapsules(const CapsuleShape* capsuleA, const CapsuleBatch& capsulesB, CollisionList& collisions) {
+    // the capsules are culled by their bounding spheres, which is loose for long capsules but keeps the kernel simple
+    int oldSize = collisions.size();
+    glm::vec3 start, end;
+    capsuleA->getStartPoint(start);
+    capsuleA->getEndPoint(end);
+    glm::vec3 center = 0.5f * (start + end);
+    float boundingRadius = capsuleA->getRadius() + 0.5f * glm::distance(start, end);
+    const glm::vec3 noAxis(0.0f);
+    int hits[BATCH_BLOCK_SIZE];
+    for (int first = 0; first < capsulesB.size() && !collisions.isFull(); first += BATCH_BLOCK_SIZE) {
+        int count = qMin(BATCH_BLOCK_SIZE, capsulesB.size() - first);
+        int numHits = findPointsNearSegment(center, noAxis, 0.0f, boundingRadius, capsulesB.getCentersX(),
+            capsulesB.getCentersY(), capsulesB.getCentersZ(), capsulesB.getBoundingRadii(), first, count, hits);
+        for (int i = 0; i < numHits && !collisions.isFull(); ++i) {
+            capsuleCapsule(capsuleA, capsulesB.getCapsule(hits[i]), collisions);
+        }
+    }
+    return collisions.size() - oldSize;
+}
+
+int collideShapeWithSpheres(const Shape* shapeA, const SphereBatch& spheresB, CollisionList& collisions) {
+    int typeA = shapeA->getType();
+    if (typeA == Shape::SPHERE_SHAPE) {
+        return sphereSpheres(static_cast<const SphereShape*>(shapeA), spheresB, collisions);
+    } else if (typeA == Shape::CAPSULE_SHAPE) {
+        return capsuleSpheres(static_cast<const CapsuleShape*>(shapeA), spheresB, collisions);
+    }
+    // the other shapes go through the dispatch table one sphere at a time
+    int oldSize = collisions.size();
+    for (int i = 0; i < spheresB.size() && !collisions.isFull(); ++i) {
+        collideShapes(shapeA, spheresB.getSphere(i), collisions);
+    }
+    return collisions.size() - oldSize;
+}
+
+int collideShapeWithCapsules(const Shape* shapeA, const CapsuleBatch& capsulesB, CollisionList& collisions) {
+    int typeA = shapeA->getType();
+    if (typeA == Shape::SPHERE_SHAPE) {
+        return sphereCapsules(static_cast<const SphereShape*>(shapeA), capsulesB, collisions);
+    } else if (typeA == Shape::CAPSULE_SHAPE) {
+        return capsuleCapsules(static_cast<const CapsuleShape*>(shapeA), capsulesB, collisions);
+    }
+    int oldSize = collisions.size();
+    for (int i = 0; i < capsulesB.size() && !collisions.isFull(); ++i) {
+        collideShapes(shapeA, capsulesB.getCapsule(i), collisions);
+    }
+    return collisions.size() - oldSize;
+}
+
 }   // namespace ShapeCollider
@@ -18,6 +18,7 @@
 #include "CollisionInfo.h"
 #include "ListShape.h"
 #include "PlaneShape.h"
+#include "ShapeBatch.h"
 #include "SharedUtil.h" 
 #include "SphereShape.h"
 
@@ -155,6 +156,46 @@ namespace ShapeCollider {
     /// \return true if capsuleA collides with axis aligned cube
     bool capsuleAACube(const CapsuleShape* capsuleA, const glm::vec3& cubeCenter, float cubeSide, CollisionList& collisions);
 
+    /// \param shapeA pointer to a shape (cannot be NULL)
+    /// \param spheresB batch of spheres
+    /// \param[out] collisions where to append collision details
+    /// \return number of collisions appended
+    int collideShapeWithSpheres(const Shape* shapeA, const SphereBatch& spheresB, CollisionList& collisions);
+
+    /// \param shapeA pointer to a shape (cannot be NULL)
+    /// \param capsulesB batch of capsules
+    /// \param[out] collisions where to append collision details
+    /// \return number of collisions appended
+    int collideShapeWithCapsules(const Shape* shapeA, const CapsuleBatch& capsulesB, CollisionList& collisions);
+
+    /// Same results as sphereSphere() against each sphere of the batch, in batch order.
+    /// \param sphereA pointer to first shape (cannot be NULL)
+    /// \param spheresB batch of spheres
+    /// \param[out] collisions where to append collision details
+    /// \return number of collisions appended
+    int sphereSpheres(const SphereShape* sphereA, const SphereBatch& spheresB, CollisionList& collisions);
+
+    /// Same results as sphereCapsule() against each capsule of the batch, in batch order.
+    /// \param sphereA pointer to first shape (cannot be NULL)
+    /// \param capsulesB batch of capsules
+    /// \param[out] collisions where to append collision details
+    /// \return number of collisions appended
+    int sphereCapsules(const SphereShape* sphereA, const CapsuleBatch& capsulesB, CollisionList& collisions);
+
+    /// Same results as capsuleSphere() against each sphere of the batch, in batch order.
+    /// \param capsuleA pointer to first shape (cannot be NULL)
+    /// \param spheresB batch of spheres
+    /// \param[out] collisions where to append collision details
+    /// \return number of collisions appended
+    int capsuleSpheres(const CapsuleShape* capsuleA, const SphereBatch& spheresB, CollisionList& collisions);
+
+    /// Same results as capsuleCapsule() against each capsule of the batch, in batch order.
+    /// \param capsuleA pointer to first shape (cannot be NULL)
+    /// \param capsulesB batch of capsules
+    /// \param[out] collisions where to append collision details
+    /// \return number of collisions appended
+    int capsuleCapsules(const CapsuleShape* capsuleA, const CapsuleBatch& capsulesB, CollisionList& collisions);
+
     /// \param shapes list of pointers to shapes (shape pointers may be NULL)
     /// \param startPoint beginning of ray
     /// \param direction direction of ray
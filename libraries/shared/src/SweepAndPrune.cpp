@@ -0,0 +1,104 @@
+//
+//  SweepAndPrune.cpp
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include "SweepAndPrune.h"
+
+SweepAndPrune::SweepAndPrune() :
+    _boxes(),
+    _sortedBoxes(),
+    _pairs()
+{
+}
+
+// empties the vector but keeps its memory: a vector with reserved capacity doesn't shrink when resized
+template<typename T> static void clearKeepingCapacity(QVector<T>& vector) {
+    vector.reserve(vector.size());
+    vector.resize(0);
+}
+
+void SweepAndPrune::clear() {
+    clearKeepingCapacity(_boxes);
+    clearKeepingCapacity(_sortedBoxes);
+    clearKeepingCapacity(_pairs);
+}
+
+int SweepAndPrune::addBox(const glm::vec3& minimum, const glm::vec3& maximum, quint32 group, quint32 mask) {
+    Box box = { minimum, maximum, group, mask };
+    _boxes.push_back(box);
+    return _boxes.size() - 1;
+}
+
+int SweepAndPrune::addSphere(const glm::vec3& center, float radius, quint32 group, quint32 mask) {
+    glm::vec3 extent(radius);
+    return addBox(center - extent, center + extent, group, mask);
+}
+
+int SweepAndPrune::chooseSweepAxis() const {
+    // the axis along which the box centers vary the most separates the most boxes
+    glm::vec3 sum(0.0f);
+    glm::vec3 sumOfSquares(0.0f);
+    for (int i = 0; i < _boxes.size(); i++) {
+        glm::vec3 center = _boxes.at(i).minimum + _boxes.at(i).maximum;
+        sum += center;
+        sumOfSquares += center * center;
+    }
+    glm::vec3 variance = sumOfSquares - sum * sum / (float)_boxes.size();
+    if (variance.x >= variance.y && variance.x >= variance.z) {
+        return 0;
+    }
+    return (variance.y >= variance.z) ? 1 : 2;
+}
+
+const QVector<SweepAndPrunePair>& SweepAndPrune::findOverlappingPairs() {
+    clearKeepingCapacity(_pairs);
+    if (_boxes.size() < 2) {
+        return _pairs;
+    }
+
+    int axis = chooseSweepAxis();
+    int otherAxisA = (axis + 1) % 3;
+    int otherAxisB = (axis + 2) % 3;
+
+    _sortedBoxes.resize(_boxes.size());
+    for (int i = 0; i < _boxes.size(); i++) {
+        SortedBox& sortedBox = _sortedBoxes[i];
+        sortedBox.minimum = _boxes.at(i).minimum[axis];
+        sortedBox.maximum = _boxes.at(i).maximum[axis];
+        sortedBox.index = i;
+    }
+    std::sort(_sortedBoxes.begin(), _sortedBoxes.end());
+
+    const SortedBox* sortedBoxes = _sortedBoxes.constData();
+    const Box* boxes = _boxes.constData();
+    int numBoxes = _sortedBoxes.size();
+    for (int i = 0; i < numBoxes; i++) {
+        const SortedBox& sweptBox = sortedBoxes[i];
+        const Box& boxA = boxes[sweptBox.index];
+
+        // every box that starts before this one ends overlaps it along the sweep axis
+        for (int j = i + 1; j < numBoxes && sortedBoxes[j].minimum <= sweptBox.maximum; j++) {
+            const Box& boxB = boxes[sortedBoxes[j].index];
+            if (!(boxA.group & boxB.mask) || !(boxB.group & boxA.mask)) {
+                continue;
+            }
+            if (boxA.minimum[otherAxisA] > boxB.maximum[otherAxisA] || boxB.minimum[otherAxisA] > boxA.maximum[otherAxisA] ||
+                    boxA.minimum[otherAxisB] > boxB.maximum[otherAxisB] || boxB.minimum[otherAxisB] > boxA.maximum[otherAxisB]) {
+                continue;
+            }
+            int indexB = sortedBoxes[j].index;
+            SweepAndPrunePair pair = { qMin(sweptBox.index, indexB), qMax(sweptBox.index, indexB) };
+            _pairs.push_back(pair);
+        }
+    }
+    return _pairs;
+}
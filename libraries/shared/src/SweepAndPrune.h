@@ -0,0 +1,76 @@
+//
+//  SweepAndPrune.h
+//  libraries/shared/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SweepAndPrune_h
+#define hifi_SweepAndPrune_h
+
+#include <glm/glm.hpp>
+
+#include <QVector>
+
+/// A pair of boxes whose bounds overlap, by the indices addBox() returned for them. firstIndex < secondIndex.
+class SweepAndPrunePair {
+public:
+    int firstIndex;
+    int secondIndex;
+};
+
+/// Collision broadphase: finds the pairs of axis aligned boxes that overlap by sorting the boxes along the axis the
+/// boxes are most spread out on, and sweeping that axis so that each box is only compared with the boxes whose extents
+/// on that axis overlap its own. The cost is the sort plus the number of candidates, rather than one test per pair.
+///
+/// Each box has a group and a mask of the groups it collides with. A pair is only reported when each box's group is in
+/// the other's mask, which lets callers keep, say, avatars from pairing up with each other.
+class SweepAndPrune {
+public:
+    SweepAndPrune();
+
+    /// Removes all boxes, keeping the memory for the next round.
+    void clear();
+
+    /// \return the index of the box, which is the number of boxes added before it since the last clear()
+    int addBox(const glm::vec3& minimum, const glm::vec3& maximum, quint32 group = 1, quint32 mask = 0xffffffff);
+
+    /// \return the index of the bounding box of the sphere
+    int addSphere(const glm::vec3& center, float radius, quint32 group = 1, quint32 mask = 0xffffffff);
+
+    int getNumBoxes() const { return _boxes.size(); }
+
+    /// Finds the overlapping pairs of the boxes added since the last clear().
+    /// \return the pairs, valid until the next call to this or clear()
+    const QVector<SweepAndPrunePair>& findOverlappingPairs();
+
+private:
+    class Box {
+    public:
+        glm::vec3 minimum;
+        glm::vec3 maximum;
+        quint32 group;
+        quint32 mask;
+    };
+
+    class SortedBox {
+    public:
+        float minimum;
+        float maximum;
+        int index;
+
+        bool operator<(const SortedBox& other) const { return minimum < other.minimum; }
+    };
+
+    int chooseSweepAxis() const;
+
+    QVector<Box> _boxes;
+    QVector<SortedBox> _sortedBoxes;
+    QVector<SweepAndPrunePair> _pairs;
+};
+
+#endif // hifi_SweepAndPrune_h
@@ -0,0 +1,441 @@
+//
+//  VoxelMesher.cpp
+//  libraries/voxels/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include <QMutexLocker>
+
+#include "VoxelMesher.h"
+#include "VoxelTree.h"
+#include "VoxelTreeElement.h"
+
+// voxels deeper than this don't fit their coordinates in an int, and are far below any reasonable voxel size
+const int MAX_MESHED_LEVEL = 30;
+
+const int NUM_FACE_DIRECTIONS = 6;
+
+uint qHash(const VoxelKey& key, uint seed) {
+    return seed ^ ((uint)key.level * 2654435761u) ^ ((uint)key.x * 73856093u) ^ ((uint)key.y * 19349663u) ^
+        ((uint)key.z * 83492791u);
+}
+
+static VoxelKey getVoxelKey(const OctreeElement* element) {
+    float scale = element->getScale();
+    const glm::vec3& corner = element->getCorner();
+    return VoxelKey(element->getLevel() - 1, (int)(corner.x / scale + 0.5f), (int)(corner.y / scale + 0.5f),
+        (int)(corner.z / scale + 0.5f));
+}
+
+static quint32 packColor(const nodeColor& color) {
+    return ((quint32)color[0] << 16) | ((quint32)color[1] << 8) | (quint32)color[2];
+}
+
+// faces point along -x, +x, -y, +y, -z and +z; the other two axes of a face are u and v, in that order
+static int getAxis(int direction) {
+    return direction / 2;
+}
+
+static bool isPositive(int direction) {
+    return (direction & 1) != 0;
+}
+
+VoxelMesher::VoxelMesher(VoxelTree* tree, int chunkLevel) :
+    _tree(tree),
+    _chunkLevel(chunkLevel),
+    _voxels(),
+    _chunkVoxels(),
+    _voxelsPerLevel(MAX_MESHED_LEVEL + 1, 0),
+    _chunkMeshes(),
+    _dirtyChunksMutex(),
+    _dirtyChunks(),
+    _isEverythingDirty(true),
+    _jobs(),
+    _workerFaces(),
+    _workerQuads(),
+    _rangeSplitter() {
+    OctreeElement::addUpdateHook(this);
+    OctreeElement::addDeleteHook(this);
+}
+
+VoxelMesher::~VoxelMesher() {
+    OctreeElement::removeUpdateHook(this);
+    OctreeElement::removeDeleteHook(this);
+}
+
+void VoxelMesher::reset() {
+    QMutexLocker locker(&_dirtyChunksMutex);
+    _isEverythingDirty = true;
+}
+
+int VoxelMesher::getNumFaces() const {
+    int numFaces = 0;
+    foreach (const VoxelChunkMesh& mesh, _chunkMeshes) {
+        numFaces += mesh.numFaces;
+    }
+    return numFaces;
+}
+
+int VoxelMesher::getNumQuads() const {
+    int numQuads = 0;
+    foreach (const VoxelChunkMesh& mesh, _chunkMeshes) {
+        numQuads += mesh.indices.size() / 6;
+    }
+    return numQuads;
+}
+
+void VoxelMesher::elementUpdated(OctreeElement* element) {
+    markDirty(element);
+}
+
+void VoxelMesher::elementDeleted(OctreeElement* element) {
+    markDirty(element);
+}
+
+void VoxelMesher::markDirty(OctreeElement* element) {
+    if (element->getLevel() - 1 > MAX_MESHED_LEVEL) {
+        return;
+    }
+    VoxelKey chunk = getChunk(getVoxelKey(element));
+    QMutexLocker locker(&_dirtyChunksMutex);
+    _dirtyChunks.insert(chunk);
+}
+
+VoxelKey VoxelMesher::getChunk(const VoxelKey& voxel) const {
+    // voxels as big as a chunk or bigger are chunks of their own
+    if (voxel.level <= _chunkLevel) {
+        return voxel;
+    }
+    int shift = voxel.level - _chunkLevel;
+    return VoxelKey(_chunkLevel, voxel.x >> shift, voxel.y >> shift, voxel.z >> shift);
+}
+
+void VoxelMesher::collectVoxels(VoxelTreeElement* element, QVector<VoxelKey>& voxels) {
+    if (element->isLeaf()) {
+        if (element->isColored() && element->getLevel() - 1 <= MAX_MESHED_LEVEL) {
+            VoxelKey voxel = getVoxelKey(element);
+            addVoxel(voxel, packColor(element->getColor()));
+            voxels.append(voxel);
+        }
+        return;
+    }
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        VoxelTreeElement* child = element->getChildAtIndex(i);
+        if (child) {
+            collectVoxels(child, voxels);
+        }
+    }
+}
+
+void VoxelMesher::collectChunk(const VoxelKey& chunk, QVector<VoxelKey>& voxels) {
+    float scale = 1.0f / (float)(1 << chunk.level);
+    VoxelTreeElement* element = _tree->getVoxelAt(chunk.x * scale, chunk.y * scale, chunk.z * scale, scale);
+    if (!element) {
+        return;
+    }
+    // the voxels inside a chunk that's bigger than the chunk level belong to smaller chunks
+    if (chunk.level == _chunkLevel || element->isLeaf()) {
+        collectVoxels(element, voxels);
+    }
+}
+
+void VoxelMesher::addVoxel(const VoxelKey& voxel, quint32 color) {
+    QHash<VoxelKey, quint32>::iterator it = _voxels.find(voxel);
+    if (it == _voxels.end()) {
+        _voxels.insert(voxel, color);
+        _voxelsPerLevel[voxel.level]++;
+    } else {
+        it.value() = color;
+    }
+}
+
+void VoxelMesher::removeVoxel(const VoxelKey& voxel) {
+    if (_voxels.remove(voxel) != 0) {
+        _voxelsPerLevel[voxel.level]--;
+    }
+}
+
+void VoxelMesher::addNeighborChunks(const VoxelKey& voxel, QSet<VoxelKey>& chunks) const {
+    int size = 1 << voxel.level;
+    if (voxel.level >= _chunkLevel) {
+        for (int direction = 0; direction < NUM_FACE_DIRECTIONS; direction++) {
+            VoxelKey neighbor = voxel;
+            int& coordinate = (getAxis(direction) == 0) ? neighbor.x : (getAxis(direction) == 1 ? neighbor.y : neighbor.z);
+            coordinate += isPositive(direction) ? 1 : -1;
+            if (coordinate >= 0 && coordinate < size) {
+                chunks.insert(getChunk(neighbor));
+            }
+        }
+        return;
+    }
+
+    // a voxel bigger than a chunk borders many; look for the ones that touch it among the chunks that have voxels
+    for (QHash<VoxelKey, QVector<VoxelKey> >::const_iterator it = _chunkVoxels.constBegin();
+            it != _chunkVoxels.constEnd(); it++) {
+        const VoxelKey& chunk = it.key();
+        if (chunk.level < voxel.level) {
+            continue;
+        }
+        int shift = chunk.level - voxel.level;
+        int voxelMinimum[] = { voxel.x << shift, voxel.y << shift, voxel.z << shift };
+        int voxelMaximum[] = { (voxel.x + 1) << shift, (voxel.y + 1) << shift, (voxel.z + 1) << shift };
+        int chunkMinimum[] = { chunk.x, chunk.y, chunk.z };
+        int touchingAxes = 0;
+        int overlappingAxes = 0;
+        for (int i = 0; i < 3; i++) {
+            if (chunkMinimum[i] + 1 == voxelMinimum[i] || chunkMinimum[i] == voxelMaximum[i]) {
+                touchingAxes++;
+            } else if (chunkMinimum[i] >= voxelMinimum[i] && chunkMinimum[i] < voxelMaximum[i]) {
+                overlappingAxes++;
+            }
+        }
+        if (touchingAxes == 1 && overlappingAxes == 2) {
+            chunks.insert(chunk);
+        }
+    }
+}
+
+bool VoxelMesher::isFaceHidden(const VoxelKey& voxel, int direction) const {
+    VoxelKey neighbor = voxel;
+    int& coordinate = (getAxis(direction) == 0) ? neighbor.x : (getAxis(direction) == 1 ? neighbor.y : neighbor.z);
+    coordinate += isPositive(direction) ? 1 : -1;
+    if (coordinate < 0 || coordinate >= (1 << voxel.level)) {
+        return false;
+    }
+
+    // hidden by a voxel in the neighboring space or by one of the bigger voxels containing it; smaller voxels might
+    // not cover the whole face, so they leave it visible
+    for (int level = voxel.level; level >= 0; level--) {
+        if (_voxelsPerLevel.at(level) == 0) {
+            continue;
+        }
+        int shift = voxel.level - level;
+        if (_voxels.contains(VoxelKey(level, neighbor.x >> shift, neighbor.y >> shift, neighbor.z >> shift))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool VoxelMesher::Face::operator<(const Face& other) const {
+    if (direction != other.direction) {
+        return direction < other.direction;
+    }
+    if (level != other.level) {
+        return level < other.level;
+    }
+    if (slice != other.slice) {
+        return slice < other.slice;
+    }
+    if (v != other.v) {
+        return v < other.v;
+    }
+    return u < other.u;
+}
+
+void VoxelMesher::mergeFaces(const Face* faces, int numFaces, QVector<Quad>& quads) {
+    // the faces of one plane, sorted by row and then by column: join each row into runs of one color, then grow the
+    // rectangles of the row before downwards wherever a run lines up with one
+    int firstOpenQuad = quads.size();
+    int lastOpenQuad = firstOpenQuad;
+    for (int i = 0; i < numFaces; ) {
+        int v = faces[i].v;
+        int nextOpenQuad = quads.size();
+        int openQuad = firstOpenQuad;
+        while (i < numFaces && faces[i].v == v) {
+            Quad run = { faces[i].u, faces[i].u + 1, v, v + 1, faces[i].color };
+            for (i++; i < numFaces && faces[i].v == v && faces[i].u == run.u1 && faces[i].color == run.color; i++) {
+                run.u1++;
+            }
+            while (openQuad < lastOpenQuad && quads.at(openQuad).u0 < run.u0) {
+                openQuad++;
+            }
+            if (openQuad < lastOpenQuad) {
+                Quad& quad = quads[openQuad];
+                if (quad.v1 == v && quad.u0 == run.u0 && quad.u1 == run.u1 && quad.color == run.color) {
+                    // moved to the end, so that the open rectangles stay in order and together
+                    quad.v1 = v + 1;
+                    Quad grown = quad;
+                    quad.v1 = -1;
+                    quads.append(grown);
+                    openQuad++;
+                    continue;
+                }
+            }
+            quads.append(run);
+        }
+        firstOpenQuad = nextOpenQuad;
+        lastOpenQuad = quads.size();
+    }
+}
+
+void VoxelMesher::addQuad(const Face& plane, const Quad& quad, VoxelChunkMesh& mesh) {
+    int axis = getAxis(plane.direction);
+    int uAxis = (axis + 1) % 3;
+    int vAxis = (axis + 2) % 3;
+    float scale = 1.0f / (float)(1 << plane.level);
+
+    glm::vec3 normal(0.0f);
+    normal[axis] = isPositive(plane.direction) ? 1.0f : -1.0f;
+
+    // counterclockwise seen from outside
+    int corners[4][2] = { { quad.u0, quad.v0 }, { quad.u1, quad.v0 }, { quad.u1, quad.v1 }, { quad.u0, quad.v1 } };
+    if (!isPositive(plane.direction)) {
+        std::swap(corners[1][0], corners[3][0]);
+        std::swap(corners[1][1], corners[3][1]);
+    }
+    quint32 firstVertex = mesh.vertices.size();
+    for (int i = 0; i < 4; i++) {
+        VoxelMeshVertex vertex;
+        vertex.position[axis] = plane.slice * scale;
+        vertex.position[uAxis] = corners[i][0] * scale;
+        vertex.position[vAxis] = corners[i][1] * scale;
+        vertex.normal = normal;
+        vertex.color[0] = (quad.color >> 16) & 0xFF;
+        vertex.color[1] = (quad.color >> 8) & 0xFF;
+        vertex.color[2] = quad.color & 0xFF;
+        mesh.vertices.append(vertex);
+    }
+    mesh.indices << firstVertex << firstVertex + 1 << firstVertex + 2;
+    mesh.indices << firstVertex << firstVertex + 2 << firstVertex + 3;
+}
+
+void VoxelMesher::meshChunk(MeshJob& job, QVector<Face>& faces, QVector<Quad>& quads) const {
+    faces.clear();
+    foreach (const VoxelKey& voxel, _chunkVoxels.value(job.chunk)) {
+        quint32 color = _voxels.value(voxel);
+        int coordinates[] = { voxel.x, voxel.y, voxel.z };
+        for (int direction = 0; direction < NUM_FACE_DIRECTIONS; direction++) {
+            if (isFaceHidden(voxel, direction)) {
+                continue;
+            }
+            int axis = getAxis(direction);
+            Face face = { direction, voxel.level, coordinates[axis] + (isPositive(direction) ? 1 : 0),
+                coordinates[(axis + 2) % 3], coordinates[(axis + 1) % 3], color };
+            faces.append(face);
+        }
+    }
+    job.mesh.numFaces = faces.size();
+    std::sort(faces.begin(), faces.end());
+
+    const Face* sortedFaces = faces.constData();
+    for (int first = 0; first < faces.size(); ) {
+        int last = first + 1;
+        while (last < faces.size() && sortedFaces[last].direction == sortedFaces[first].direction &&
+                sortedFaces[last].level == sortedFaces[first].level && sortedFaces[last].slice == sortedFaces[first].slice) {
+            last++;
+        }
+        quads.clear();
+        mergeFaces(sortedFaces + first, last - first, quads);
+        foreach (const Quad& quad, quads) {
+            if (quad.v1 != -1) {
+                addQuad(sortedFaces[first], quad, job.mesh);
+            }
+        }
+        first = last;
+    }
+}
+
+void VoxelMesher::processRange(int worker, int firstJob, int lastJob) {
+    meshChunks(firstJob, lastJob, _workerFaces[worker], _workerQuads[worker]);
+}
+
+void VoxelMesher::meshChunks(int firstJob, int lastJob, QVector<Face>& faces, QVector<Quad>& quads) {
+    for (int i = firstJob; i < lastJob; i++) {
+        meshChunk(_jobs[i], faces, quads);
+    }
+}
+
+int VoxelMesher::update() {
+    QSet<VoxelKey> dirtyChunks;
+    bool isEverythingDirty;
+    {
+        QMutexLocker locker(&_dirtyChunksMutex);
+        dirtyChunks.swap(_dirtyChunks);
+        isEverythingDirty = _isEverythingDirty;
+        _isEverythingDirty = false;
+    }
+    if (!isEverythingDirty && dirtyChunks.isEmpty()) {
+        return 0;
+    }
+
+    _tree->lockForRead();
+    QSet<VoxelKey> chunksToMesh;
+    if (isEverythingDirty) {
+        _voxels.clear();
+        _chunkVoxels.clear();
+        _chunkMeshes.clear();
+        _voxelsPerLevel.fill(0);
+        QVector<VoxelKey> voxels;
+        collectVoxels(_tree->getRoot(), voxels);
+        foreach (const VoxelKey& voxel, voxels) {
+            VoxelKey chunk = getChunk(voxel);
+            _chunkVoxels[chunk].append(voxel);
+            chunksToMesh.insert(chunk);
+        }
+    } else {
+        // read the dirty chunks again, and find the neighbors of the voxels that came or went
+        QVector<VoxelKey> voxels;
+        foreach (const VoxelKey& chunk, dirtyChunks) {
+            QVector<VoxelKey> oldVoxels = _chunkVoxels.take(chunk);
+            foreach (const VoxelKey& voxel, oldVoxels) {
+                removeVoxel(voxel);
+            }
+            voxels.clear();
+            collectChunk(chunk, voxels);
+            if (!voxels.isEmpty()) {
+                _chunkVoxels.insert(chunk, voxels);
+            }
+            chunksToMesh.insert(chunk);
+
+            QSet<VoxelKey> oldVoxelSet = QSet<VoxelKey>::fromList(oldVoxels.toList());
+            QSet<VoxelKey> newVoxelSet = QSet<VoxelKey>::fromList(voxels.toList());
+            foreach (const VoxelKey& voxel, oldVoxelSet) {
+                if (!newVoxelSet.contains(voxel)) {
+                    addNeighborChunks(voxel, chunksToMesh);
+                }
+            }
+            foreach (const VoxelKey& voxel, newVoxelSet) {
+                if (!oldVoxelSet.contains(voxel)) {
+                    addNeighborChunks(voxel, chunksToMesh);
+                }
+            }
+        }
+    }
+    _tree->unlock();
+
+    _jobs.resize(0);
+    foreach (const VoxelKey& chunk, chunksToMesh) {
+        if (_chunkVoxels.contains(chunk)) {
+            MeshJob job;
+            job.chunk = chunk;
+            _jobs.append(job);
+        } else {
+            _chunkMeshes.remove(chunk);
+        }
+    }
+
+    int numJobs = _jobs.size();
+    int numWorkers = _rangeSplitter.getNumWorkers(numJobs);
+    if (_workerFaces.size() < numWorkers) {
+        _workerFaces.resize(numWorkers);
+        _workerQuads.resize(numWorkers);
+    }
+    _rangeSplitter.run(*this, numJobs);
+
+    foreach (const MeshJob& job, _jobs) {
+        if (job.mesh.indices.isEmpty()) {
+            _chunkMeshes.remove(job.chunk);
+        } else {
+            _chunkMeshes.insert(job.chunk, job.mesh);
+        }
+    }
+    return numJobs;
+}
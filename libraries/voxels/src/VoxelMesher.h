@@ -0,0 +1,178 @@
+//
+//  VoxelMesher.h
+//  libraries/voxels/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_VoxelMesher_h
+#define hifi_VoxelMesher_h
+
+#include <glm/glm.hpp>
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QVector>
+
+#include <OctreeElement.h>
+#include <RangeSplitter.h>
+
+class VoxelTree;
+class VoxelTreeElement;
+
+/// The level of a voxel in the tree (zero for the root, whose scale is one) and its corner in units of its scale.
+class VoxelKey {
+public:
+    VoxelKey() : level(0), x(0), y(0), z(0) { }
+    VoxelKey(int level, int x, int y, int z) : level(level), x(x), y(y), z(z) { }
+
+    bool operator==(const VoxelKey& other) const {
+        return level == other.level && x == other.x && y == other.y && z == other.z;
+    }
+
+    int level;
+    int x;
+    int y;
+    int z;
+};
+
+uint qHash(const VoxelKey& key, uint seed = 0);
+
+class VoxelMeshVertex {
+public:
+    glm::vec3 position; // in tree units
+    glm::vec3 normal;
+    unsigned char color[3];
+};
+
+/// The triangles of the visible voxel faces in a chunk of the tree.
+class VoxelChunkMesh {
+public:
+    VoxelChunkMesh() : numFaces(0) { }
+
+    QVector<VoxelMeshVertex> vertices;
+    QVector<quint32> indices;
+
+    /// the number of visible voxel faces, before the faces that share a plane and a color were merged
+    int numFaces;
+};
+
+/// Meshes the colored leaf voxels of a VoxelTree without a GL context.  The tree is divided into chunks: the elements
+/// at the chunk level, plus voxels bigger than those, which are each a chunk of their own.  For every chunk, the
+/// mesher builds a mesh of the voxel faces that aren't covered by a neighboring voxel of the same size or larger, with
+/// the faces that share a plane and a color merged into rectangles.
+///
+/// The mesher listens to the element update and delete hooks, and update() remeshes only the chunks with voxels that
+/// changed and the neighboring chunks whose faces those voxels could hide or uncover, spread over a thread pool.  The
+/// hooks report the elements of every tree, so edits to other trees just cost a look at chunks that haven't changed.
+class VoxelMesher : public OctreeElementUpdateHook, public OctreeElementDeleteHook, public RangeWork {
+public:
+    static const int DEFAULT_CHUNK_LEVEL = 10;
+
+    VoxelMesher(VoxelTree* tree, int chunkLevel = DEFAULT_CHUNK_LEVEL);
+    virtual ~VoxelMesher();
+
+    int getChunkLevel() const { return _chunkLevel; }
+
+    /// Throws away all of the meshes and marks the whole tree for meshing.
+    void reset();
+
+    /// Reads the chunks that changed since the last update from the tree, which it locks for reading, and remeshes
+    /// them and their neighbors.
+    /// \return the number of chunks meshed
+    int update();
+
+    /// \return the meshes of the chunks with visible faces, by chunk
+    const QHash<VoxelKey, VoxelChunkMesh>& getChunkMeshes() const { return _chunkMeshes; }
+
+    int getNumVoxels() const { return _voxels.size(); }
+
+    /// \return the number of visible faces over all of the chunks, before merging
+    int getNumFaces() const;
+
+    /// \return the number of rectangles over all of the chunks, after merging
+    int getNumQuads() const;
+
+    virtual void elementUpdated(OctreeElement* element);
+    virtual void elementDeleted(OctreeElement* element);
+
+private:
+    class Face {
+    public:
+        bool operator<(const Face& other) const;
+
+        int direction;
+        int level;
+        int slice;
+        int v;
+        int u;
+        quint32 color;
+    };
+
+    class Quad {
+    public:
+        int u0;
+        int u1;
+        int v0;
+        int v1;
+        quint32 color;
+    };
+
+    class MeshJob {
+    public:
+        VoxelKey chunk;
+        VoxelChunkMesh mesh;
+    };
+
+    VoxelKey getChunk(const VoxelKey& voxel) const;
+    void markDirty(OctreeElement* element);
+
+    void collectChunk(const VoxelKey& chunk, QVector<VoxelKey>& voxels);
+    void collectVoxels(VoxelTreeElement* element, QVector<VoxelKey>& voxels);
+    void addVoxel(const VoxelKey& voxel, quint32 color);
+    void removeVoxel(const VoxelKey& voxel);
+
+    /// Adds the chunks whose faces a voxel can hide: those across its faces with voxels of its size or smaller.
+    void addNeighborChunks(const VoxelKey& voxel, QSet<VoxelKey>& chunks) const;
+
+    bool isFaceHidden(const VoxelKey& voxel, int direction) const;
+
+    /// Meshes the jobs in [firstJob, lastJob).  Runs on the worker threads, so it only reads the voxels.
+    void meshChunks(int firstJob, int lastJob, QVector<Face>& faces, QVector<Quad>& quads);
+
+    /// meshes a run of jobs for update(), with the buffers of the worker
+    virtual void processRange(int worker, int firstJob, int lastJob);
+    void meshChunk(MeshJob& job, QVector<Face>& faces, QVector<Quad>& quads) const;
+    static void mergeFaces(const Face* faces, int numFaces, QVector<Quad>& quads);
+    static void addQuad(const Face& plane, const Quad& quad, VoxelChunkMesh& mesh);
+
+    VoxelTree* _tree;
+    int _chunkLevel;
+
+    // the colors of all of the colored leaf voxels, the voxels of each chunk, and how many voxels there are per level
+    QHash<VoxelKey, quint32> _voxels;
+    QHash<VoxelKey, QVector<VoxelKey> > _chunkVoxels;
+    QVector<int> _voxelsPerLevel;
+
+    QHash<VoxelKey, VoxelChunkMesh> _chunkMeshes;
+
+    // written by the hooks, which can run on any thread
+    QMutex _dirtyChunksMutex;
+    QSet<VoxelKey> _dirtyChunks;
+    bool _isEverythingDirty;
+
+    QVector<MeshJob> _jobs;
+
+    // the buffers each worker meshes with, kept from one update to the next
+    QVector<QVector<Face> > _workerFaces;
+    QVector<QVector<Quad> > _workerQuads;
+
+    RangeSplitter _rangeSplitter;
+};
+
+#endif // hifi_VoxelMesher_h
@@ -0,0 +1,360 @@
+//
+//  PoseBatchTests.cpp
+//  tests/animation/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+
+#include <QFile>
+
+#include <glm/gtx/transform.hpp>
+
+#include <PoseBatch.h>
+#include <SharedUtil.h>
+
+#include "PoseBatchTests.h"
+
+const int NUM_ANIMATION_FRAMES = 40;
+const int BENCHMARK_FRAMES = 30;
+const float BENCHMARK_FPS = 30.0f;
+const float TRANSFORM_TOLERANCE = 0.0001f;
+
+// the geometry of an animation from the AnimationCache: the joints it animates and a rotation for each per frame
+static FBXGeometry makeAnimation(const FBXGeometry& geometry, float amplitude, float phase) {
+    FBXGeometry animation;
+    FBXJoint missingJoint;
+    missingJoint.name = "NotInTheSkeleton";
+    animation.joints.append(missingJoint);
+    foreach (const FBXJoint& joint, geometry.joints) {
+        animation.joints.append(joint);
+    }
+    for (int frame = 0; frame < NUM_ANIMATION_FRAMES; frame++) {
+        FBXAnimationFrame animationFrame;
+        animationFrame.rotations.append(glm::quat());
+        for (int i = 0; i < geometry.joints.size(); i++) {
+            float angle = amplitude * sinf(TWO_PI * frame / NUM_ANIMATION_FRAMES + phase + i);
+            glm::vec3 axis = glm::normalize(glm::vec3(1.0f, (float)(i % 3), (float)(i % 5)));
+            animationFrame.rotations.append(geometry.joints.at(i).rotation * glm::angleAxis(angle, axis));
+        }
+        animation.animationFrames.append(animationFrame);
+    }
+    return animation;
+}
+
+// a skeleton with its joints listed children first, which readFBX() doesn't make but a Skeleton must handle
+static FBXGeometry makeShuffledGeometry() {
+    FBXGeometry geometry;
+    int parentIndices[] = { 2, -1, 1, 0, 1 };
+    for (int i = 0; i < 5; i++) {
+        FBXJoint joint;
+        joint.parentIndex = parentIndices[i];
+        joint.translation = glm::vec3(0.0f, 1.0f, 0.1f * i);
+        joint.preTransform = glm::translate(glm::vec3(0.0f, 0.0f, 0.5f));
+        joint.preRotation = glm::angleAxis(0.1f * i, glm::vec3(1.0f, 0.0f, 0.0f));
+        joint.rotation = glm::angleAxis(0.2f, glm::vec3(0.0f, 1.0f, 0.0f));
+        joint.postRotation = glm::angleAxis(-0.1f * i, glm::vec3(0.0f, 0.0f, 1.0f));
+        joint.postTransform = glm::mat4();
+        joint.name = QString("joint%1").arg(i);
+        geometry.joints.append(joint);
+        geometry.jointIndices.insert(joint.name, i + 1);
+    }
+    return geometry;
+}
+
+static bool loadGeometry(const QString& filename, FBXGeometry& geometry) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::cout << "Could not open " << filename.toStdString() << std::endl;
+        return false;
+    }
+    try {
+        geometry = readFBX(file.readAll(), QVariantHash());
+    } catch (const QString& error) {
+        std::cout << "Failed to load " << filename.toStdString() << ": " << error.toStdString() << std::endl;
+        return false;
+    }
+    if (geometry.joints.isEmpty()) {
+        std::cout << filename.toStdString() << " has no joints" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static glm::mat4 getBaseTransform(const FBXGeometry& geometry) {
+    return glm::scale(glm::vec3(0.01f)) * glm::translate(glm::vec3(0.0f, 1.0f, 0.0f)) * geometry.offset;
+}
+
+// an animation applied the way AnimationHandle does it, with its joint mappings from NetworkGeometry
+class JointByJointLayer {
+public:
+    const FBXGeometry* animation;
+    QVector<int> jointMappings;
+    float priority;
+};
+
+// the joint rotations, priorities and transforms that a Model keeps in its JointStates
+class JointByJointPose {
+public:
+    QVector<glm::quat> rotations;
+    QVector<float> priorities;
+    QVector<glm::mat4> transforms;
+};
+
+static JointByJointLayer makeJointByJointLayer(const FBXGeometry& geometry, const FBXGeometry* animation,
+        float priority, const QStringList& maskedJoints) {
+    JointByJointLayer layer = { animation, QVector<int>(), priority };
+    foreach (const FBXJoint& joint, animation->joints) {
+        int mapping = geometry.jointIndices.value(joint.name) - 1;
+        if (mapping != -1 && maskedJoints.contains(geometry.joints.at(mapping).name)) {
+            mapping = -1;
+        }
+        layer.jointMappings.append(mapping);
+    }
+    return layer;
+}
+
+static JointByJointPose makeJointByJointPose(const FBXGeometry& geometry) {
+    JointByJointPose pose;
+    foreach (const FBXJoint& joint, geometry.joints) {
+        pose.rotations.append(joint.rotation);
+        pose.priorities.append(0.0f);
+        pose.transforms.append(glm::mat4());
+    }
+    return pose;
+}
+
+// AnimationHandle::applyFrame()
+static void applyFrame(const JointByJointLayer& layer, float frameIndex, JointByJointPose& pose) {
+    int frameCount = layer.animation->animationFrames.size();
+    const FBXAnimationFrame& floorFrame = layer.animation->animationFrames.at((int)glm::floor(frameIndex) % frameCount);
+    const FBXAnimationFrame& ceilFrame = layer.animation->animationFrames.at((int)glm::ceil(frameIndex) % frameCount);
+    float frameFraction = glm::fract(frameIndex);
+    for (int i = 0; i < layer.jointMappings.size(); i++) {
+        int mapping = layer.jointMappings.at(i);
+        if (mapping != -1 && layer.priority >= pose.priorities.at(mapping)) {
+            pose.rotations[mapping] = safeMix(floorFrame.rotations.at(i), ceilFrame.rotations.at(i), frameFraction);
+            pose.priorities[mapping] = layer.priority;
+        }
+    }
+}
+
+// Model::updateJointState() and JointState::computeTransform() for each joint
+static void computeTransforms(const FBXGeometry& geometry, const glm::mat4& baseTransform, JointByJointPose& pose) {
+    for (int i = 0; i < geometry.joints.size(); i++) {
+        const FBXJoint& joint = geometry.joints.at(i);
+        glm::mat4 parentTransform = (joint.parentIndex == -1) ? baseTransform : pose.transforms.at(joint.parentIndex);
+        glm::quat rotationInConstrainedFrame = joint.preRotation * pose.rotations.at(i) * joint.postRotation;
+        glm::mat4 modifiedTransform = joint.preTransform * glm::mat4_cast(rotationInConstrainedFrame) * joint.postTransform;
+        pose.transforms[i] = parentTransform * glm::translate(joint.translation) * modifiedTransform;
+    }
+}
+
+// computes the transforms of a geometry whose joints might not come parent first
+static void computeTransformsInAnyOrder(const FBXGeometry& geometry, const glm::mat4& baseTransform,
+        JointByJointPose& pose) {
+    QVector<bool> computed(geometry.joints.size(), false);
+    for (int numComputed = 0; numComputed < geometry.joints.size(); ) {
+        for (int i = 0; i < geometry.joints.size(); i++) {
+            const FBXJoint& joint = geometry.joints.at(i);
+            if (computed.at(i) || (joint.parentIndex != -1 && !computed.at(joint.parentIndex))) {
+                continue;
+            }
+            glm::mat4 parentTransform = (joint.parentIndex == -1) ? baseTransform : pose.transforms.at(joint.parentIndex);
+            glm::quat rotationInConstrainedFrame = joint.preRotation * pose.rotations.at(i) * joint.postRotation;
+            pose.transforms[i] = parentTransform * glm::translate(joint.translation) * joint.preTransform *
+                glm::mat4_cast(rotationInConstrainedFrame) * joint.postTransform;
+            computed[i] = true;
+            numComputed++;
+        }
+    }
+}
+
+static float getMaxDifference(const glm::mat4& a, const glm::mat4& b) {
+    float maxDifference = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            maxDifference = qMax(maxDifference, fabsf(a[i][j] - b[i][j]));
+        }
+    }
+    return maxDifference;
+}
+
+void PoseBatchTests::skeletonOrderTests() {
+    FBXGeometry geometry = makeShuffledGeometry();
+    Skeleton skeleton(geometry);
+    for (int i = 0; i < skeleton.getNumJoints(); i++) {
+        if (skeleton.getParentIndex(i) >= i) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: joint " << i << " comes before its parent "
+                << skeleton.getParentIndex(i) << std::endl;
+        }
+        const FBXJoint& joint = geometry.joints.at(skeleton.getGeometryJointIndex(i));
+        if (skeleton.getJointIndex(joint.name) != i) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: joint " << i << " isn't found by name" << std::endl;
+        }
+    }
+
+    PoseBatch batch;
+    int poseIndex = batch.addPose(&skeleton);
+    glm::quat rotation = glm::angleAxis(0.5f, glm::vec3(0.0f, 0.0f, 1.0f));
+    batch.setJointRotation(poseIndex, skeleton.getJointIndex("joint2"), rotation, 1.0f);
+    batch.evaluate(poseIndex);
+
+    JointByJointPose pose = makeJointByJointPose(geometry);
+    pose.rotations[2] = rotation;
+    computeTransformsInAnyOrder(geometry, glm::mat4(), pose);
+    const glm::mat4* transforms = batch.getTransforms(poseIndex);
+    for (int i = 0; i < skeleton.getNumJoints(); i++) {
+        float difference = getMaxDifference(transforms[i], pose.transforms.at(skeleton.getGeometryJointIndex(i)));
+        if (difference > TRANSFORM_TOLERANCE) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: transform of reordered joint " << i
+                << " is off by " << difference << std::endl;
+        }
+    }
+
+    // a lower priority doesn't take a joint over
+    batch.setJointRotation(poseIndex, skeleton.getJointIndex("joint2"), glm::quat(), 0.5f);
+    if (batch.getJointRotation(poseIndex, skeleton.getJointIndex("joint2")) != rotation) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: lower priority replaced a joint rotation" << std::endl;
+    }
+}
+
+void PoseBatchTests::matchesJointByJointTests(const QStringList& filenames) {
+    foreach (const QString& filename, filenames) {
+        FBXGeometry geometry;
+        if (!loadGeometry(filename, geometry)) {
+            continue;
+        }
+        Skeleton skeleton(geometry);
+        for (int i = 0; i < skeleton.getNumJoints(); i++) {
+            if (skeleton.getGeometryJointIndex(i) != i) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << filename.toStdString()
+                    << " joints were reordered" << std::endl;
+                break;
+            }
+        }
+
+        // an idle animation, one of the same priority added after it, and a higher priority one on half of the joints
+        FBXGeometry idle = makeAnimation(geometry, 0.2f, 0.0f);
+        FBXGeometry fidget = makeAnimation(geometry, 0.1f, 1.0f);
+        FBXGeometry wave = makeAnimation(geometry, 0.5f, 2.0f);
+        QStringList waveMask;
+        for (int i = 0; i < geometry.joints.size() / 2; i++) {
+            waveMask.append(geometry.joints.at(i).name);
+        }
+        AnimationClip idleClip(skeleton, idle);
+        AnimationClip fidgetClip(skeleton, fidget);
+        AnimationClip waveClip(skeleton, wave, waveMask);
+
+        PoseBatch batch;
+        int poseIndex = batch.addPose(&skeleton);
+        glm::mat4 baseTransform = getBaseTransform(geometry);
+        batch.setBaseTransform(poseIndex, baseTransform);
+        int idleLayer = batch.addLayer(poseIndex, &idleClip, 1.0f);
+        int fidgetLayer = batch.addLayer(poseIndex, &fidgetClip, 1.0f);
+        int waveLayer = batch.addLayer(poseIndex, &waveClip, 2.0f);
+
+        // Model sorts its running animations by decreasing priority
+        JointByJointPose pose = makeJointByJointPose(geometry);
+        QVector<JointByJointLayer> layers;
+        layers.append(makeJointByJointLayer(geometry, &wave, 2.0f, waveMask));
+        layers.append(makeJointByJointLayer(geometry, &idle, 1.0f, QStringList()));
+        layers.append(makeJointByJointLayer(geometry, &fidget, 1.0f, QStringList()));
+
+        float frameIndices[] = { 0.0f, 3.25f, 17.5f, 39.75f, 45.0f };
+        for (int i = 0; i < 5; i++) {
+            float frameIndex = frameIndices[i];
+            batch.setLayerFrame(idleLayer, frameIndex);
+            batch.setLayerFrame(fidgetLayer, frameIndex + 1.5f);
+            batch.setLayerFrame(waveLayer, frameIndex * 2.0f);
+            batch.evaluate(poseIndex);
+
+            applyFrame(layers.at(0), frameIndex * 2.0f, pose);
+            applyFrame(layers.at(1), frameIndex, pose);
+            applyFrame(layers.at(2), frameIndex + 1.5f, pose);
+            computeTransforms(geometry, baseTransform, pose);
+
+            const glm::mat4* transforms = batch.getTransforms(poseIndex);
+            float maxDifference = 0.0f;
+            for (int j = 0; j < geometry.joints.size(); j++) {
+                maxDifference = qMax(maxDifference, getMaxDifference(transforms[j], pose.transforms.at(j)));
+            }
+            if (maxDifference > TRANSFORM_TOLERANCE) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR: " << filename.toStdString() << " frame "
+                    << frameIndex << " transforms are off by " << maxDifference << std::endl;
+            }
+        }
+    }
+}
+
+void PoseBatchTests::poseBenchmark(const QStringList& filenames) {
+    foreach (const QString& filename, filenames) {
+        FBXGeometry geometry;
+        if (!loadGeometry(filename, geometry)) {
+            continue;
+        }
+        Skeleton skeleton(geometry);
+        FBXGeometry idle = makeAnimation(geometry, 0.2f, 0.0f);
+        FBXGeometry wave = makeAnimation(geometry, 0.5f, 2.0f);
+        QStringList waveMask;
+        for (int i = 0; i < geometry.joints.size() / 2; i++) {
+            waveMask.append(geometry.joints.at(i).name);
+        }
+        AnimationClip idleClip(skeleton, idle);
+        AnimationClip waveClip(skeleton, wave, waveMask);
+        JointByJointLayer idleLayer = makeJointByJointLayer(geometry, &idle, 1.0f, QStringList());
+        JointByJointLayer waveLayer = makeJointByJointLayer(geometry, &wave, 2.0f, waveMask);
+        glm::mat4 baseTransform = getBaseTransform(geometry);
+
+        int numAvatars[] = { 16, 64, 256 };
+        for (int i = 0; i < 3; i++) {
+            QVector<JointByJointPose> poses(numAvatars[i], makeJointByJointPose(geometry));
+            quint64 start = usecTimestampNow();
+            for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+                for (int j = 0; j < poses.size(); j++) {
+                    float frameIndex = (frame + j) * BENCHMARK_FPS / 60.0f;
+                    applyFrame(waveLayer, frameIndex, poses[j]);
+                    applyFrame(idleLayer, frameIndex, poses[j]);
+                    computeTransforms(geometry, baseTransform, poses[j]);
+                }
+            }
+            quint64 jointByJointUsecs = usecTimestampNow() - start;
+
+            PoseBatch batch;
+            for (int j = 0; j < numAvatars[i]; j++) {
+                int poseIndex = batch.addPose(&skeleton);
+                batch.setBaseTransform(poseIndex, baseTransform);
+                batch.addLayer(poseIndex, &idleClip, 1.0f);
+                batch.addLayer(poseIndex, &waveClip, 2.0f);
+            }
+            start = usecTimestampNow();
+            for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+                for (int j = 0; j < numAvatars[i]; j++) {
+                    float frameIndex = (frame + j) * BENCHMARK_FPS / 60.0f;
+                    batch.setLayerFrame(2 * j, frameIndex);
+                    batch.setLayerFrame(2 * j + 1, frameIndex);
+                }
+                batch.evaluateAll();
+            }
+            quint64 batchUsecs = usecTimestampNow() - start;
+
+            std::cout << "TIME - " << filename.toStdString() << " " << numAvatars[i] << " avatars of "
+                << geometry.joints.size() << " joints: joint by joint "
+                << (float)jointByJointUsecs / BENCHMARK_FRAMES << " usecs/frame, PoseBatch "
+                << (float)batchUsecs / BENCHMARK_FRAMES << " usecs/frame" << std::endl;
+        }
+    }
+}
+
+void PoseBatchTests::runAllTests(const QStringList& filenames) {
+    skeletonOrderTests();
+    matchesJointByJointTests(filenames);
+    poseBenchmark(filenames);
+
+    std::cout << "PoseBatchTests done" << std::endl;
+}
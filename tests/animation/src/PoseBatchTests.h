@@ -0,0 +1,31 @@
+//
+//  PoseBatchTests.h
+//  tests/animation/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PoseBatchTests_h
+#define hifi_PoseBatchTests_h
+
+#include <QStringList>
+
+namespace PoseBatchTests {
+
+    void skeletonOrderTests();
+
+    /// poses the skeletons of the given files with layered animations and compares the transforms against applying
+    /// the animations and computing the transforms one joint at a time, the way Model and JointState do
+    void matchesJointByJointTests(const QStringList& filenames);
+
+    /// times posing many avatars joint by joint against posing them with a PoseBatch
+    void poseBenchmark(const QStringList& filenames);
+
+    void runAllTests(const QStringList& filenames);
+}
+
+#endif // hifi_PoseBatchTests_h
@@ -0,0 +1,24 @@
+//
+//  main.cpp
+//  tests/animation/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PoseBatchTests.h"
+
+int main(int argc, char** argv) {
+    // any FBX files on the command line are posed instead of the default avatar
+    QStringList filenames;
+    for (int i = 1; i < argc; i++) {
+        filenames.append(argv[i]);
+    }
+    if (filenames.isEmpty()) {
+        filenames << FBX_SAMPLE_DIRECTORY "/defaultAvatar/body.fbx";
+    }
+    PoseBatchTests::runAllTests(filenames);
+    return 0;
+}
@@ -0,0 +1,122 @@
+//
+//  AudioCodecTests.cpp
+//  tests/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <math.h>
+
+#include "AudioCodecTests.h"
+
+#include "AudioRingBuffer.h"
+#include "SharedUtil.h"
+
+const int NUM_BENCHMARK_FRAMES = 10000;
+
+// the least signal to noise ratio we accept for a lossy codec, in decibels
+const float MIN_LOSSY_SNR = 30.0f;
+
+void AudioCodecTests::testCodec(const AudioCodec* codec, int numChannels) {
+    int numSamples = (numChannels == 2) ? NETWORK_BUFFER_LENGTH_SAMPLES_STEREO : NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL;
+
+    // a couple of tones with some noise on top, a different mix on every channel
+    int16_t samples[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+    for (int i = 0; i < numSamples; i++) {
+        int frame = i / numChannels;
+        int channel = i % numChannels;
+        float tones = 6000.0f * sinf(frame * (0.05f + channel * 0.03f)) + 3000.0f * sinf(frame * 0.31f);
+        samples[i] = (int16_t) (tones + (randIntInRange(0, 400) - 200));
+    }
+
+    char encoded[NETWORK_BUFFER_LENGTH_BYTES_STEREO * 2];
+    int16_t decoded[NETWORK_BUFFER_LENGTH_SAMPLES_STEREO];
+
+    int maxEncodedSize = codec->getMaxEncodedSize(numSamples, numChannels);
+    int numEncodedBytes = codec->encode(samples, numSamples, numChannels, encoded);
+    int numDecodedSamples = 0;
+    int numDecodedBytes = codec->decode(encoded, numEncodedBytes, decoded, numSamples, numDecodedSamples);
+
+    if (numEncodedBytes <= 0 || numEncodedBytes > maxEncodedSize) {
+        qDebug("Codec %d wrote %d bytes, expected at most %d\n", codec->getType(), numEncodedBytes, maxEncodedSize);
+    }
+    if (numDecodedBytes != numEncodedBytes || numDecodedSamples != numSamples) {
+        qDebug("Codec %d read %d of %d bytes and decoded %d of %d samples\n", codec->getType(), numDecodedBytes,
+               numEncodedBytes, numDecodedSamples, numSamples);
+    }
+
+    double signalPower = 0.0;
+    double noisePower = 0.0;
+    for (int i = 0; i < numSamples; i++) {
+        double error = samples[i] - decoded[i];
+        signalPower += (double) samples[i] * samples[i];
+        noisePower += error * error;
+    }
+    bool isLossless = (noisePower == 0.0);
+    float snr = isLossless ? 0.0f : 10.0f * log10f(signalPower / noisePower);
+    if (codec->getType() == AudioCodecType::PCM && !isLossless) {
+        qDebug("PCM codec changed the samples\n");
+    } else if (!isLossless && snr < MIN_LOSSY_SNR) {
+        qDebug("Codec %d signal to noise ratio %f dB is below %f dB\n", codec->getType(), snr, MIN_LOSSY_SNR);
+    }
+
+    // a frame that was cut short must not decode
+    if (codec->getType() != AudioCodecType::PCM
+        && codec->decode(encoded, numEncodedBytes - 1, decoded, numSamples, numDecodedSamples) >= 0) {
+        qDebug("Codec %d decoded a truncated frame\n", codec->getType());
+    }
+
+    // the mixer encodes once per listener mix and decodes once per source per frame
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < NUM_BENCHMARK_FRAMES; i++) {
+        codec->encode(samples, numSamples, numChannels, encoded);
+    }
+    quint64 encodeUsecs = usecTimestampNow() - start;
+
+    start = usecTimestampNow();
+    for (int i = 0; i < NUM_BENCHMARK_FRAMES; i++) {
+        codec->decode(encoded, numEncodedBytes, decoded, numSamples, numDecodedSamples);
+    }
+    quint64 decodeUsecs = usecTimestampNow() - start;
+
+    // how much of one core it takes to keep up with a stream in real time
+    float framesPerSecond = (float) USECS_PER_SECOND / BUFFER_SEND_INTERVAL_USECS;
+    float encodeUsecsPerFrame = (float) encodeUsecs / NUM_BENCHMARK_FRAMES;
+    float decodeUsecsPerFrame = (float) decodeUsecs / NUM_BENCHMARK_FRAMES;
+
+    qDebug() << "TIME - codec" << codec->getType() << numChannels << "channels:"
+        << numEncodedBytes << "of" << numSamples * (int) sizeof(int16_t) << "bytes per frame,"
+        << "encode" << encodeUsecsPerFrame << "usecs per frame per stream ("
+        << encodeUsecsPerFrame * framesPerSecond / USECS_PER_SECOND * 100.0f << "% of a core ),"
+        << "decode" << decodeUsecsPerFrame << "usecs per frame per stream ("
+        << decodeUsecsPerFrame * framesPerSecond / USECS_PER_SECOND * 100.0f << "% of a core ),"
+        << (isLossless ? "lossless" : "SNR") << snr << "dB";
+}
+
+void AudioCodecTests::runAllTests() {
+    const AudioCodec_t CODEC_TYPES[] = { AudioCodecType::PCM, AudioCodecType::ADPCM };
+    const int NUM_CODEC_TYPES = sizeof(CODEC_TYPES) / sizeof(CODEC_TYPES[0]);
+
+    for (int i = 0; i < NUM_CODEC_TYPES; i++) {
+        const AudioCodec* codec = AudioCodec::getCodec(CODEC_TYPES[i]);
+        if (!codec || codec->getType() != CODEC_TYPES[i]) {
+            qDebug("No codec registered for type %d\n", CODEC_TYPES[i]);
+            continue;
+        }
+
+        // mono is what clients send the mixer, stereo is the mix the mixer sends back
+        testCodec(codec, 1);
+        testCodec(codec, 2);
+    }
+
+    const AudioCodec_t UNKNOWN_CODEC_TYPE = 255;
+    if (AudioCodec::getCodec(UNKNOWN_CODEC_TYPE)) {
+        qDebug("Got a codec for unknown type %d\n", UNKNOWN_CODEC_TYPE);
+    }
+
+    qDebug() << "PASSED";
+}
@@ -0,0 +1,25 @@
+//
+//  AudioCodecTests.h
+//  tests/audio/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AudioCodecTests_h
+#define hifi_AudioCodecTests_h
+
+#include "AudioCodec.h"
+
+namespace AudioCodecTests {
+
+    void runAllTests();
+
+    /// round trips a frame through the codec and times what the mixer spends on one stream per frame
+    void testCodec(const AudioCodec* codec, int numChannels);
+};
+
+#endif // hifi_AudioCodecTests_h
@@ -8,11 +8,13 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "AudioCodecTests.h"
 #include "AudioRingBufferTests.h"
 #include <stdio.h>
 
 int main(int argc, char** argv) {
     AudioRingBufferTests::runAllTests();
+    AudioCodecTests::runAllTests();
     printf("all tests passed.  press enter to exit\n");
     getchar();
     return 0;
@@ -0,0 +1,215 @@
+//
+//  BakedFBXGeometryTests.cpp
+//  tests/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QBuffer>
+#include <QFile>
+#include <QtDebug>
+
+#include <BakedFBXGeometry.h>
+#include <SharedUtil.h>
+
+#include "BakedFBXGeometryTests.h"
+
+const int BENCHMARK_LOADS_PER_FILE = 5;
+
+static FBXGeometry makeGeometry() {
+    FBXGeometry geometry;
+    geometry.author = "tester";
+
+    FBXJoint joint;
+    joint.isFree = false;
+    joint.parentIndex = -1;
+    joint.distanceToParent = 0.0f;
+    joint.boneRadius = 0.1f;
+    joint.name = "Hips";
+    joint.rotation = glm::quat(glm::vec3(0.1f, 0.2f, 0.3f));
+    joint.shapeType = Shape::CAPSULE_SHAPE;
+    geometry.joints.append(joint);
+    geometry.jointIndices.insert(joint.name, 1);
+    geometry.rootJointIndex = 0;
+
+    FBXMesh mesh;
+    for (int i = 0; i < 100; i++) {
+        mesh.vertices.append(glm::vec3(i, i * 2.0f, i * 3.0f));
+        mesh.normals.append(glm::vec3(0.0f, 1.0f, 0.0f));
+        mesh.texCoords.append(glm::vec2(i / 100.0f, 0.5f));
+    }
+    FBXMeshPart part;
+    for (int i = 0; i < 99; i++) {
+        part.triangleIndices << 0 << i << i + 1;
+    }
+    part.diffuseColor = glm::vec3(1.0f, 0.5f, 0.25f);
+    part.shininess = 12.0f;
+    part.diffuseTexture.filename = "skin.png";
+    mesh.parts.append(part);
+
+    FBXCluster cluster;
+    cluster.jointIndex = 0;
+    cluster.inverseBindMatrix = glm::mat4(2.0f);
+    mesh.clusters.append(cluster);
+
+    FBXBlendshape blendshape;
+    blendshape.indices << 3 << 4;
+    blendshape.vertices << glm::vec3(0.1f) << glm::vec3(0.2f);
+    blendshape.normals << glm::vec3(0.0f) << glm::vec3(0.0f);
+    mesh.blendshapes.append(blendshape);
+    mesh.meshExtents.reset();
+    mesh.meshExtents.addPoint(glm::vec3(99.0f, 198.0f, 297.0f));
+    mesh.isEye = false;
+    geometry.meshes.append(mesh);
+
+    FBXAttachment attachment;
+    attachment.jointIndex = 0;
+    attachment.url = QUrl("http://example.com/hat.fst");
+    attachment.scale = glm::vec3(1.0f);
+    geometry.attachments.append(attachment);
+
+    FBXAnimationFrame frame;
+    frame.rotations.append(joint.rotation);
+    geometry.animationFrames.append(frame);
+    return geometry;
+}
+
+static QByteArray bake(const FBXGeometry& geometry) {
+    QByteArray baked;
+    QBuffer buffer(&baked);
+    buffer.open(QIODevice::WriteOnly);
+    writeBakedFBXGeometry(&buffer, geometry);
+    return baked;
+}
+
+static FBXGeometry readBaked(const QByteArray& baked) {
+    return readBakedFBXGeometry(reinterpret_cast<const uchar*>(baked.constData()), baked.size());
+}
+
+void BakedFBXGeometryTests::roundTripTests() {
+    FBXGeometry geometry = makeGeometry();
+    QByteArray baked = bake(geometry);
+
+    try {
+        FBXGeometry readGeometry = readBaked(baked);
+        const FBXMesh& mesh = geometry.meshes.at(0);
+        bool passed = readGeometry.author == geometry.author && readGeometry.joints.size() == 1
+            && readGeometry.joints.at(0).name == "Hips" && readGeometry.joints.at(0).rotation == geometry.joints.at(0).rotation
+            && readGeometry.joints.at(0).shapeType == Shape::CAPSULE_SHAPE && readGeometry.getJointIndex("Hips") == 0
+            && readGeometry.meshes.size() == 1 && readGeometry.meshes.at(0).vertices == mesh.vertices
+            && readGeometry.meshes.at(0).texCoords == mesh.texCoords
+            && readGeometry.meshes.at(0).parts.at(0).triangleIndices == mesh.parts.at(0).triangleIndices
+            && readGeometry.meshes.at(0).parts.at(0).diffuseTexture.filename == "skin.png"
+            && readGeometry.meshes.at(0).clusters.at(0).inverseBindMatrix == mesh.clusters.at(0).inverseBindMatrix
+            && readGeometry.meshes.at(0).blendshapes.at(0).vertices == mesh.blendshapes.at(0).vertices
+            && readGeometry.meshes.at(0).meshExtents.maximum == mesh.meshExtents.maximum
+            && readGeometry.attachments.at(0).url == geometry.attachments.at(0).url
+            && readGeometry.animationFrames.at(0).rotations == geometry.animationFrames.at(0).rotations;
+        if (!passed) {
+            qDebug() << "FAILED - baked geometry did not read back the same";
+        }
+    } catch (const QString& error) {
+        qDebug() << "FAILED - reading baked geometry:" << error;
+    }
+
+    // every truncation has to be caught rather than read past the end of the mapping
+    for (int size = 0; size < baked.size(); size += 7) {
+        try {
+            readBaked(baked.left(size));
+            qDebug() << "FAILED - baked geometry truncated to" << size << "bytes was read";
+            break;
+        } catch (const QString& error) {
+            // expected
+        }
+    }
+
+    QByteArray otherVersion = baked;
+    otherVersion[12] = otherVersion[12] + 1;
+    try {
+        readBaked(otherVersion);
+        qDebug() << "FAILED - baked geometry of another version was read";
+    } catch (const QString& error) {
+        // expected
+    }
+}
+
+void BakedFBXGeometryTests::keyTests() {
+    QByteArray model("model contents");
+
+    QVariantHash mapping;
+    mapping.insert("filename", QByteArray("model.fbx"));
+    mapping.insert("scale", QByteArray("0.5"));
+    QVariantHash joints;
+    joints.insert("jointRoot", QByteArray("Hips"));
+    joints.insert("jointNeck", QByteArray("Neck"));
+    mapping.insert("joint", joints);
+
+    // the same mapping built in another order
+    QVariantHash otherJoints;
+    otherJoints.insert("jointNeck", QByteArray("Neck"));
+    otherJoints.insert("jointRoot", QByteArray("Hips"));
+    QVariantHash otherMapping;
+    otherMapping.insert("joint", otherJoints);
+    otherMapping.insert("scale", QByteArray("0.5"));
+    otherMapping.insert("filename", QByteArray("model.fbx"));
+
+    QByteArray key = getBakedFBXGeometryKey(model, mapping);
+    if (key != getBakedFBXGeometryKey(model, otherMapping)) {
+        qDebug() << "FAILED - baked geometry key depends on mapping order";
+    }
+
+    otherMapping.insert("scale", QByteArray("1.0"));
+    if (key == getBakedFBXGeometryKey(model, otherMapping)) {
+        qDebug() << "FAILED - baked geometry key ignores the mapping";
+    }
+    if (key == getBakedFBXGeometryKey(model + ' ', mapping)) {
+        qDebug() << "FAILED - baked geometry key ignores the model";
+    }
+}
+
+void BakedFBXGeometryTests::loadBenchmark(const QStringList& filenames) {
+    foreach (const QString& filename, filenames) {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Could not open" << filename;
+            continue;
+        }
+        QByteArray model = file.readAll();
+
+        try {
+            quint64 start = usecTimestampNow();
+            FBXGeometry geometry;
+            for (int i = 0; i < BENCHMARK_LOADS_PER_FILE; i++) {
+                geometry = readFBX(model, QVariantHash());
+            }
+            quint64 readUsecs = usecTimestampNow() - start;
+
+            QByteArray baked = bake(geometry);
+            start = usecTimestampNow();
+            for (int i = 0; i < BENCHMARK_LOADS_PER_FILE; i++) {
+                geometry = readBaked(baked);
+            }
+            quint64 bakedUsecs = usecTimestampNow() - start;
+
+            qDebug() << "TIME -" << filename << ": readFBX"
+                << (float)readUsecs / BENCHMARK_LOADS_PER_FILE / USECS_PER_MSEC << "msecs, baked"
+                << (float)bakedUsecs / BENCHMARK_LOADS_PER_FILE / USECS_PER_MSEC << "msecs,"
+                << baked.size() / 1024 << "KB baked from" << model.size() / 1024 << "KB";
+
+        } catch (const QString& error) {
+            qDebug() << "Failed to load" << filename << ":" << error;
+        }
+    }
+}
+
+void BakedFBXGeometryTests::runAllTests(const QStringList& benchmarkFilenames) {
+    roundTripTests();
+    keyTests();
+    loadBenchmark(benchmarkFilenames);
+
+    qDebug() << "BakedFBXGeometryTests done";
+}
@@ -0,0 +1,28 @@
+//
+//  BakedFBXGeometryTests.h
+//  tests/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakedFBXGeometryTests_h
+#define hifi_BakedFBXGeometryTests_h
+
+#include <QStringList>
+
+namespace BakedFBXGeometryTests {
+
+    void roundTripTests();
+    void keyTests();
+
+    /// compares parsing the given files with readFBX() against reading them back from the baked format
+    void loadBenchmark(const QStringList& filenames);
+
+    void runAllTests(const QStringList& benchmarkFilenames);
+}
+
+#endif // hifi_BakedFBXGeometryTests_h
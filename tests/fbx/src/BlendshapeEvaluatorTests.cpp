@@ -0,0 +1,299 @@
+//
+//  BlendshapeEvaluatorTests.cpp
+//  tests/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cfloat>
+#include <cmath>
+
+#include <QFile>
+#include <QTextStream>
+#include <QtDebug>
+
+#include <BlendshapeEvaluator.h>
+#include <FBXReader.h>
+#include <SharedUtil.h>
+
+#include "BlendshapeEvaluatorTests.h"
+
+typedef QVector<float> CoefficientFrame;
+
+// the evaluator may leave each coefficient this far from the one asked for
+const float COEFFICIENT_TOLERANCE = 0.001f;
+
+// 30 Hz tracker data rendered at 60 Hz: every frame of coefficients arrives twice
+const int SYNTHESIZED_TRACKER_FRAMES = 600;
+const int RENDER_FRAMES_PER_TRACKER_FRAME = 2;
+
+// blends the way Blender did before the evaluator: every mesh, every coefficient above EPSILON, every frame
+static void blendEverything(const QVector<FBXMesh>& meshes, const CoefficientFrame& coefficients,
+        QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals) {
+    vertices.clear();
+    normals.clear();
+    int offset = 0;
+    foreach (const FBXMesh& mesh, meshes) {
+        if (mesh.blendshapes.isEmpty()) {
+            continue;
+        }
+        vertices += mesh.vertices;
+        normals += mesh.normals;
+        glm::vec3* meshVertices = vertices.data() + offset;
+        glm::vec3* meshNormals = normals.data() + offset;
+        offset += mesh.vertices.size();
+        const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+        for (int i = 0, n = qMin(coefficients.size(), mesh.blendshapes.size()); i < n; i++) {
+            float vertexCoefficient = coefficients.at(i);
+            if (vertexCoefficient < EPSILON) {
+                continue;
+            }
+            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
+            const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
+            for (int j = 0; j < blendshape.indices.size(); j++) {
+                int index = blendshape.indices.at(j);
+                meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
+                meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
+            }
+        }
+    }
+}
+
+static float getMaxDistance(const QVector<glm::vec3>& a, const QVector<glm::vec3>& b) {
+    if (a.size() != b.size()) {
+        return FLT_MAX;
+    }
+    float maxDistance = 0.0f;
+    for (int i = 0; i < a.size(); i++) {
+        maxDistance = qMax(maxDistance, glm::distance(a.at(i), b.at(i)));
+    }
+    return maxDistance;
+}
+
+// the most that leaving every coefficient within the tolerance can move a vertex
+static float getMaxBlendError(const QVector<FBXMesh>& meshes) {
+    float maxError = 0.0f;
+    foreach (const FBXMesh& mesh, meshes) {
+        float meshError = 0.0f;
+        foreach (const FBXBlendshape& blendshape, mesh.blendshapes) {
+            float maxDelta = 0.0f;
+            foreach (const glm::vec3& delta, blendshape.vertices) {
+                maxDelta = qMax(maxDelta, glm::length(delta));
+            }
+            meshError += maxDelta * COEFFICIENT_TOLERANCE;
+        }
+        maxError = qMax(maxError, meshError);
+    }
+    return maxError + 0.0001f;
+}
+
+static int getNumBlendshapes(const QVector<FBXMesh>& meshes) {
+    int numBlendshapes = 0;
+    foreach (const FBXMesh& mesh, meshes) {
+        numBlendshapes = qMax(numBlendshapes, mesh.blendshapes.size());
+    }
+    return numBlendshapes;
+}
+
+static FBXMesh makeMesh(int numVertices, int numBlendshapes) {
+    FBXMesh mesh;
+    for (int i = 0; i < numVertices; i++) {
+        mesh.vertices.append(glm::vec3(randFloatInRange(-1.0f, 1.0f), randFloatInRange(-1.0f, 1.0f), 0.0f));
+        mesh.normals.append(glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+    for (int i = 0; i < numBlendshapes; i++) {
+        // runs of neighboring vertices with gaps between them, in a region of the mesh like a blendshape of a face
+        FBXBlendshape blendshape;
+        int regionSize = numVertices / 8;
+        int regionStart = (i * numVertices / qMax(numBlendshapes, 1)) % (numVertices - regionSize);
+        for (int index = regionStart; index < regionStart + regionSize; index += 1 + (index % 5 == 0 ? 3 : 0)) {
+            if (randFloat() < 0.3f) {
+                continue;
+            }
+            blendshape.indices.append(index);
+            blendshape.vertices.append(glm::vec3(randFloatInRange(-0.01f, 0.01f), randFloatInRange(-0.01f, 0.01f), 0.0f));
+            blendshape.normals.append(glm::vec3(randFloatInRange(-1.0f, 1.0f), 0.0f, 0.0f));
+        }
+        mesh.blendshapes.append(blendshape);
+    }
+    return mesh;
+}
+
+// a face tracker stream: blinks, a talking jaw, a few slowly moving expressions with jitter, and the rest at rest
+static QVector<CoefficientFrame> synthesizeStream(int numBlendshapes) {
+    QVector<CoefficientFrame> stream;
+    const float TRACKER_FRAME_SECONDS = 1.0f / 30.0f;
+    const int NUM_EXPRESSIONS = 6;
+    const float JITTER = 0.0005f;
+    for (int frame = 0; frame < SYNTHESIZED_TRACKER_FRAMES; frame++) {
+        float seconds = frame * TRACKER_FRAME_SECONDS;
+        CoefficientFrame coefficients(numBlendshapes, 0.0f);
+        float blink = glm::max(0.0f, 1.0f - fabsf(fmodf(seconds, 4.0f) - 0.15f) * 10.0f);
+        for (int i = 0; i < numBlendshapes; i++) {
+            if (i < 2) {
+                coefficients[i] = blink;
+
+            } else if (i == 2) {
+                coefficients[i] = glm::max(0.0f, sinf(seconds * 9.0f)) * 0.6f;
+
+            } else if (i < 3 + NUM_EXPRESSIONS) {
+                float expression = 0.5f + 0.5f * sinf(seconds * (0.5f + 0.1f * i) + i);
+                coefficients[i] = glm::clamp(expression + randFloatInRange(-JITTER, JITTER), 0.0f, 1.0f);
+            }
+        }
+        for (int i = 0; i < RENDER_FRAMES_PER_TRACKER_FRAME; i++) {
+            stream.append(coefficients);
+        }
+    }
+    return stream;
+}
+
+static QVector<CoefficientFrame> loadStream(const QString& filename) {
+    QVector<CoefficientFrame> stream;
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Could not open" << filename;
+        return stream;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList values = in.readLine().split(' ', QString::SkipEmptyParts);
+        if (values.isEmpty()) {
+            continue;
+        }
+        CoefficientFrame coefficients;
+        foreach (const QString& value, values) {
+            coefficients.append(value.toFloat());
+        }
+        stream.append(coefficients);
+    }
+    return stream;
+}
+
+void BlendshapeEvaluatorTests::matchesFullBlendTests() {
+    QVector<FBXMesh> meshes;
+    meshes.append(makeMesh(500, 12));
+    meshes.append(makeMesh(50, 0));
+    meshes.append(makeMesh(300, 8));
+    float maxError = getMaxBlendError(meshes);
+
+    BlendshapeEvaluator evaluator;
+    evaluator.setMeshes(meshes);
+    QVector<glm::vec3> vertices, normals;
+    QVector<CoefficientFrame> stream = synthesizeStream(getNumBlendshapes(meshes));
+    for (int frame = 0; frame < stream.size(); frame++) {
+        const CoefficientFrame& coefficients = stream.at(frame);
+        bool changed = evaluator.evaluate(coefficients);
+        if (frame > 0 && coefficients == stream.at(frame - 1) && changed) {
+            qDebug() << "FAILED - evaluator reblended unchanged coefficients at frame" << frame;
+            break;
+        }
+        blendEverything(meshes, coefficients, vertices, normals);
+        float error = getMaxDistance(evaluator.getVertices(), vertices);
+        if (error > maxError) {
+            qDebug() << "FAILED - blended vertices off by" << error << "at frame" << frame;
+            break;
+        }
+    }
+
+    // random coefficients, so that most of them change every frame
+    for (int frame = 0; frame < 200; frame++) {
+        CoefficientFrame coefficients;
+        for (int i = 0; i < 12; i++) {
+            coefficients.append(randFloat() < 0.5f ? 0.0f : randFloat());
+        }
+        evaluator.evaluate(coefficients);
+        blendEverything(meshes, coefficients, vertices, normals);
+        float error = getMaxDistance(evaluator.getVertices(), vertices);
+        if (error > maxError) {
+            qDebug() << "FAILED - blended vertices off by" << error << "at random frame" << frame;
+            break;
+        }
+    }
+
+    // coming back to rest gives the base mesh exactly, however many updates came before
+    evaluator.evaluate(CoefficientFrame());
+    blendEverything(meshes, CoefficientFrame(), vertices, normals);
+    if (evaluator.getVertices() != vertices || evaluator.getNormals() != normals) {
+        qDebug() << "FAILED - evaluator at rest doesn't give the base mesh";
+    }
+
+    // new meshes start over
+    meshes.remove(2);
+    evaluator.setMeshes(meshes);
+    if (!evaluator.evaluate(CoefficientFrame()) || evaluator.getVertices().size() != 500) {
+        qDebug() << "FAILED - evaluator didn't start over with new meshes";
+    }
+}
+
+static void benchmarkStream(const QString& name, const QVector<FBXMesh>& meshes, const QVector<CoefficientFrame>& stream) {
+    if (stream.isEmpty()) {
+        return;
+    }
+    QVector<glm::vec3> vertices, normals;
+    quint64 start = usecTimestampNow();
+    for (int frame = 0; frame < stream.size(); frame++) {
+        blendEverything(meshes, stream.at(frame), vertices, normals);
+    }
+    quint64 everythingUsecs = usecTimestampNow() - start;
+
+    BlendshapeEvaluator evaluator;
+    evaluator.setMeshes(meshes);
+    int numPosted = 0;
+    qint64 numUpdatedVertices = 0;
+    start = usecTimestampNow();
+    for (int frame = 0; frame < stream.size(); frame++) {
+        if (evaluator.evaluate(stream.at(frame))) {
+            numPosted++;
+        }
+        numUpdatedVertices += evaluator.getNumUpdatedVertices();
+    }
+    quint64 evaluatorUsecs = usecTimestampNow() - start;
+
+    float error = getMaxDistance(evaluator.getVertices(), vertices);
+    if (error > getMaxBlendError(meshes)) {
+        qDebug() << "FAILED -" << name << ": evaluator ended off by" << error;
+    }
+
+    qDebug() << "TIME -" << name << ":" << stream.size() << "frames, blending everything"
+        << (float)everythingUsecs / stream.size() << "usecs/frame, evaluator"
+        << (float)evaluatorUsecs / stream.size() << "usecs/frame," << numPosted << "frames posted,"
+        << (float)numUpdatedVertices / stream.size() << "vertex updates/frame for" << vertices.size() << "vertices";
+}
+
+void BlendshapeEvaluatorTests::blendBenchmark(const QStringList& filenames, const QStringList& streamFilenames) {
+    foreach (const QString& filename, filenames) {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Could not open" << filename;
+            continue;
+        }
+        try {
+            FBXGeometry geometry = readFBX(file.readAll(), QVariantHash());
+            if (!geometry.hasBlendedMeshes()) {
+                qDebug() << filename << "has no blendshapes";
+                continue;
+            }
+            if (streamFilenames.isEmpty()) {
+                benchmarkStream(filename + " synthesized", geometry.meshes,
+                    synthesizeStream(getNumBlendshapes(geometry.meshes)));
+            }
+            foreach (const QString& streamFilename, streamFilenames) {
+                benchmarkStream(filename + " " + streamFilename, geometry.meshes, loadStream(streamFilename));
+            }
+        } catch (const QString& error) {
+            qDebug() << "Failed to load" << filename << ":" << error;
+        }
+    }
+}
+
+void BlendshapeEvaluatorTests::runAllTests(const QStringList& benchmarkFilenames, const QStringList& streamFilenames) {
+    matchesFullBlendTests();
+    blendBenchmark(benchmarkFilenames, streamFilenames);
+
+    qDebug() << "BlendshapeEvaluatorTests done";
+}
@@ -0,0 +1,29 @@
+//
+//  BlendshapeEvaluatorTests.h
+//  tests/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BlendshapeEvaluatorTests_h
+#define hifi_BlendshapeEvaluatorTests_h
+
+#include <QStringList>
+
+namespace BlendshapeEvaluatorTests {
+
+    void matchesFullBlendTests();
+
+    /// compares blending the given files the way Blender used to, every coefficient of every frame, against the
+    /// evaluator, over the recorded coefficient streams (text files with one frame of coefficients per line) or over a
+    /// synthesized face tracker stream if there are none
+    void blendBenchmark(const QStringList& filenames, const QStringList& streamFilenames);
+
+    void runAllTests(const QStringList& benchmarkFilenames, const QStringList& streamFilenames);
+}
+
+#endif // hifi_BlendshapeEvaluatorTests_h
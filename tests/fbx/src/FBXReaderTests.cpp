@@ -0,0 +1,222 @@
+//
+//  FBXReaderTests.cpp
+//  tests/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QFile>
+#include <QtDebug>
+
+#include <FBXReader.h>
+#include <SharedUtil.h>
+
+#include "FBXReaderTests.h"
+
+const int BENCHMARK_LOADS_PER_FILE = 5;
+
+// the highest resident set size of this process so far, in kilobytes, or zero if we can't tell
+static qint64 getPeakResidentKilobytes() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on OS X
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static QDataStream& littleEndian(QDataStream& out) {
+    out.setByteOrder(QDataStream::LittleEndian);
+    return out;
+}
+
+template<class T> static QByteArray binaryArrayProperty(char type, const QVector<T>& values, bool compress) {
+    QByteArray data;
+    QDataStream dataOut(&data, QIODevice::WriteOnly);
+    littleEndian(dataOut).setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+    foreach (T value, values) {
+        dataOut << value;
+    }
+    if (compress) {
+        // qCompress prefaces the zlib stream with the uncompressed length, FBX doesn't
+        data = qCompress(data).mid(sizeof(quint32));
+    }
+
+    QByteArray property;
+    QDataStream out(&property, QIODevice::WriteOnly);
+    littleEndian(out) << (quint8)type << (quint32)values.size() << (quint32)(compress ? 1 : 0) << (quint32)data.size();
+    out.writeRawData(data.constData(), data.size());
+    return property;
+}
+
+static void appendBinaryNode(QByteArray& document, const QByteArray& name, const QByteArray& property) {
+    const int NODE_HEADER_SIZE = 13;
+    QDataStream out(&document, QIODevice::Append);
+    littleEndian(out) << (quint32)(document.size() + NODE_HEADER_SIZE + name.size() + property.size())
+        << (quint32)1 << (quint32)property.size() << (quint8)name.size();
+    out.writeRawData(name.constData(), name.size());
+    out.writeRawData(property.constData(), property.size());
+}
+
+template<class T> static bool hasArray(const FBXNode& node, const QVector<T>& values) {
+    return node.properties.size() == 1 && node.properties.at(0).userType() == qMetaTypeId<QVector<T> >()
+        && node.properties.at(0).value<QVector<T> >() == values;
+}
+
+void FBXReaderTests::parseBinaryArrayTests() {
+    QVector<double> vertices;
+    for (int i = 0; i < 9; i++) {
+        vertices.append(i * 0.5);
+    }
+    QVector<qint32> indices;
+    indices << 0 << 1 << -3;
+    QVector<bool> flags;
+    flags << true << false << true;
+
+    QByteArray document("Kaydara FBX Binary  ");
+    document.append('\0');
+    document.append("\x1a\x00", 2);
+    QDataStream versionOut(&document, QIODevice::Append);
+    littleEndian(versionOut) << (quint32)7300;
+
+    appendBinaryNode(document, "Vertices", binaryArrayProperty('d', vertices, true));
+    int indicesOffset = document.size();
+    appendBinaryNode(document, "PolygonVertexIndex", binaryArrayProperty('i', indices, false));
+    appendBinaryNode(document, "Flags", binaryArrayProperty('b', flags, true));
+
+    // a null record ends the top level
+    const int NULL_RECORD_SIZE = 13;
+    document.append(QByteArray(NULL_RECORD_SIZE, 0));
+
+    QBuffer buffer(&document);
+    buffer.open(QIODevice::ReadOnly);
+    FBXNode top = parseFBX(&buffer);
+
+    if (top.children.size() != 3) {
+        qDebug() << "FAILED - expected 3 binary nodes, got" << top.children.size();
+        return;
+    }
+    if (!hasArray(top.children.at(0), vertices)) {
+        qDebug() << "FAILED - compressed double array did not come back as QVector<double>";
+    }
+    if (!hasArray(top.children.at(1), indices)) {
+        qDebug() << "FAILED - uncompressed int array did not come back as QVector<qint32>";
+    }
+    if (!hasArray(top.children.at(2), flags)) {
+        qDebug() << "FAILED - compressed bool array did not come back as QVector<bool>";
+    }
+
+    // cut the document off in the middle of the uncompressed array
+    QByteArray truncated = document.left(indicesOffset + 48);
+    QBuffer truncatedBuffer(&truncated);
+    truncatedBuffer.open(QIODevice::ReadOnly);
+    try {
+        parseFBX(&truncatedBuffer);
+        qDebug() << "FAILED - truncated array was parsed";
+    } catch (const QString& error) {
+        // expected
+    }
+}
+
+void FBXReaderTests::parseTextArrayTests() {
+    QByteArray document(
+        "; FBX 7.3.0 project file\n"
+        "Vertices: *6 {\n"
+        "    a: 1,2,3.5,4,5,6\n"
+        "}\n"
+        "PolygonVertexIndex: *3 {\n"
+        "    a: 0,1,-3\n"
+        "}\n");
+
+    QBuffer buffer(&document);
+    buffer.open(QIODevice::ReadOnly);
+    FBXNode top = parseFBX(&buffer);
+
+    if (top.children.size() != 2 || top.children.at(0).children.size() != 1
+            || top.children.at(1).children.size() != 1) {
+        qDebug() << "FAILED - unexpected text node tree";
+        return;
+    }
+
+    // an array switches to doubles at the first value that isn't an integer
+    QVector<double> vertices;
+    vertices << 1.0 << 2.0 << 3.5 << 4.0 << 5.0 << 6.0;
+    if (top.children.at(0).properties.value(0).toByteArray() != "*6" || !hasArray(top.children.at(0).children.at(0), vertices)) {
+        qDebug() << "FAILED - text double array did not come back as QVector<double>";
+    }
+
+    QVector<int> indices;
+    indices << 0 << 1 << -3;
+    if (!hasArray(top.children.at(1).children.at(0), indices)) {
+        qDebug() << "FAILED - text int array did not come back as QVector<int>";
+    }
+}
+
+void FBXReaderTests::loadBenchmark(const QStringList& filenames) {
+    foreach (const QString& filename, filenames) {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "Could not open" << filename;
+            continue;
+        }
+        QByteArray model = file.readAll();
+
+        qint64 peakBefore = getPeakResidentKilobytes();
+        quint64 parseUsecs = 0;
+        quint64 readUsecs = 0;
+        int numVertices = 0;
+        try {
+            for (int i = 0; i < BENCHMARK_LOADS_PER_FILE; i++) {
+                QBuffer buffer(&model);
+                buffer.open(QIODevice::ReadOnly);
+                quint64 start = usecTimestampNow();
+                parseFBX(&buffer);
+                parseUsecs += usecTimestampNow() - start;
+
+                start = usecTimestampNow();
+                FBXGeometry geometry = readFBX(model, QVariantHash());
+                readUsecs += usecTimestampNow() - start;
+
+                numVertices = 0;
+                foreach (const FBXMesh& mesh, geometry.meshes) {
+                    numVertices += mesh.vertices.size();
+                }
+            }
+        } catch (const QString& error) {
+            qDebug() << "Failed to load" << filename << ":" << error;
+            continue;
+        }
+        qint64 peakAfter = getPeakResidentKilobytes();
+
+        qDebug() << "TIME -" << filename << model.size() / 1024 << "KB," << numVertices << "vertices:"
+            << "parse" << (float)parseUsecs / BENCHMARK_LOADS_PER_FILE / USECS_PER_MSEC << "msecs,"
+            << "parse and extract" << (float)readUsecs / BENCHMARK_LOADS_PER_FILE / USECS_PER_MSEC << "msecs,"
+            << "peak RSS" << peakAfter / 1024 << "MB (+" << (peakAfter - peakBefore) / 1024 << "MB )";
+    }
+}
+
+void FBXReaderTests::runAllTests(const QStringList& benchmarkFilenames) {
+    parseBinaryArrayTests();
+    parseTextArrayTests();
+
+    loadBenchmark(benchmarkFilenames);
+
+    qDebug() << "FBXReaderTests done";
+}
@@ -0,0 +1,28 @@
+//
+//  FBXReaderTests.h
+//  tests/fbx/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FBXReaderTests_h
+#define hifi_FBXReaderTests_h
+
+#include <QStringList>
+
+namespace FBXReaderTests {
+
+    void parseBinaryArrayTests();
+    void parseTextArrayTests();
+
+    /// times parsing and geometry extraction of the given files and reports how far they push the peak memory use
+    void loadBenchmark(const QStringList& filenames);
+
+    void runAllTests(const QStringList& benchmarkFilenames);
+}
+
+#endif // hifi_FBXReaderTests_h
@@ -0,0 +1,36 @@
+//
+//  main.cpp
+//  tests/fbx/src
+//
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BakedFBXGeometryTests.h"
+#include "BlendshapeEvaluatorTests.h"
+#include "FBXReaderTests.h"
+
+int main(int argc, char** argv) {
+    // any FBX files on the command line are benchmarked instead of the default avatar, and any text files are
+    // recorded blendshape coefficient streams to blend them with
+    QStringList benchmarkFilenames;
+    QStringList streamFilenames;
+    for (int i = 1; i < argc; i++) {
+        QString filename = argv[i];
+        if (filename.endsWith(".txt", Qt::CaseInsensitive)) {
+            streamFilenames.append(filename);
+        } else {
+            benchmarkFilenames.append(filename);
+        }
+    }
+    if (benchmarkFilenames.isEmpty()) {
+        benchmarkFilenames << FBX_SAMPLE_DIRECTORY "/defaultAvatar/head.fbx"
+            << FBX_SAMPLE_DIRECTORY "/defaultAvatar/body.fbx";
+    }
+    FBXReaderTests::runAllTests(benchmarkFilenames);
+    BakedFBXGeometryTests::runAllTests(benchmarkFilenames);
+    BlendshapeEvaluatorTests::runAllTests(benchmarkFilenames, streamFilenames);
+    return 0;
+}
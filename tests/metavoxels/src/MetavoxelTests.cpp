@@ -11,7 +11,9 @@
 
 #include <stdlib.h>
 
+#include <QRunnable>
 #include <QScriptValueIterator>
+#include <QThreadPool>
 
 #include <SharedUtil.h>
 
@@ -439,6 +441,8 @@ static bool testSerialization(Bitstream::MetadataType metadataType) {
     return false;
 }
 
+static bool testPublishedData();
+
 bool MetavoxelTests::run() {
     LimitedNodeList::createInstance();
 
@@ -558,6 +562,15 @@ bool MetavoxelTests::run() {
             "spanner mutations";
     }
     
+    if (test == 0 || test == 6) {
+        qDebug() << "Running published data test...";
+        qDebug();
+        
+        if (testPublishedData()) {
+            return true;
+        }
+    }
+    
     qDebug() << "All tests passed!";
     
     return false;
@@ -835,6 +848,112 @@ int MutateVisitor::visit(MetavoxelInfo& info) {
     return STOP_RECURSION;
 }
 
+/// Takes snapshots of published data and walks them until told to stop.
+class SnapshotReader : public QRunnable {
+public:
+    
+    int snapshotsRead;
+    
+    SnapshotReader(const PublishedMetavoxelData& data, const QAtomicInt& reading);
+    virtual void run();
+
+private:
+    
+    const PublishedMetavoxelData& _data;
+    const QAtomicInt& _reading;
+};
+
+SnapshotReader::SnapshotReader(const PublishedMetavoxelData& data, const QAtomicInt& reading) :
+    snapshotsRead(0),
+    _data(data),
+    _reading(reading) {
+}
+
+void SnapshotReader::run() {
+    while (_reading.load()) {
+        MetavoxelData snapshot = _data.getSnapshot();
+        int internalNodes = 0, leaves = 0;
+        snapshot.countNodes(internalNodes, leaves);
+        snapshotsRead++;
+    }
+}
+
+static QByteArray writeData(const MetavoxelData& data) {
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    Bitstream out(stream);
+    out << data;
+    out.flush();
+    return bytes;
+}
+
+static bool testPublishedData() {
+    PublishedMetavoxelData published;
+    MetavoxelData data;
+    RandomVisitor visitor;
+    data.guide(visitor);
+    published.publish(data);
+    
+    // keep the first version, as a reader would, while edits publish new ones
+    MetavoxelData first = published.getSnapshot();
+    QByteArray firstBytes = writeData(first);
+    
+    const int READER_COUNT = 4;
+    QAtomicInt reading(1);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(READER_COUNT);
+    QVector<SnapshotReader*> readers;
+    for (int i = 0; i < READER_COUNT; i++) {
+        SnapshotReader* reader = new SnapshotReader(published, reading);
+        reader->setAutoDelete(false);
+        readers.append(reader);
+        threadPool.start(reader);
+    }
+    
+    const int EDIT_COUNT = 1000;
+    AttributePointer colorAttribute = AttributeRegistry::getInstance()->getColorAttribute();
+    for (int i = 0; i < EDIT_COUNT; i++) {
+        MetavoxelData edited = published.getSnapshot();
+        MutateVisitor mutateVisitor;
+        edited.guide(mutateVisitor);
+        published.publish(edited);
+        
+        if (i == 0) {
+            // the edit only copies the parts it changed; the rest is shared with the previous version
+            int sharedChildren = 0;
+            for (int j = 0; j < MetavoxelNode::CHILD_COUNT; j++) {
+                if (edited.getRoot(colorAttribute)->getChild(j) == first.getRoot(colorAttribute)->getChild(j)) {
+                    sharedChildren++;
+                }
+            }
+            if (sharedChildren == 0 || sharedChildren == MetavoxelNode::CHILD_COUNT) {
+                qDebug() << "Failed structural sharing test.";
+                qDebug() << "Shared children:" << sharedChildren;
+                return true;
+            }
+        }
+    }
+    reading.store(0);
+    threadPool.waitForDone();
+    
+    int snapshotsRead = 0;
+    foreach (SnapshotReader* reader, readers) {
+        snapshotsRead += reader->snapshotsRead;
+        delete reader;
+    }
+    
+    if (published.getSnapshot() == first || writeData(first) != firstBytes) {
+        qDebug() << "Failed snapshot stability test.";
+        return true;
+    }
+    
+    qDebug() << "Published" << EDIT_COUNT << "versions while" << READER_COUNT << "readers read" << snapshotsRead <<
+        "snapshots";
+    qDebug();
+    
+    return false;
+}
+
 bool TestEndpoint::simulate(int iterationNumber) {
     // update/send our delayed datagrams
     for (QList<ByteArrayIntPair>::iterator it = _delayedDatagrams.begin(); it != _delayedDatagrams.end(); ) {
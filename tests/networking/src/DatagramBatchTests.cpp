@@ -0,0 +1,147 @@
+//
+//  DatagramBatchTests.cpp
+//  tests/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <assert.h>
+#include <stdio.h>
+
+#include <QtCore/QElapsedTimer>
+
+#include "DatagramBatchTests.h"
+
+static int drainSocket(QUdpSocket& receiver, qint64& numBytes) {
+    int numDatagrams = 0;
+    QByteArray datagram;
+    while (receiver.hasPendingDatagrams()) {
+        datagram.resize(receiver.pendingDatagramSize());
+        numBytes += receiver.readDatagram(datagram.data(), datagram.size());
+        ++numDatagrams;
+    }
+    return numDatagrams;
+}
+
+static void setupSockets(QUdpSocket& receiver, QUdpSocket& sender) {
+    receiver.bind(QHostAddress::LocalHost, 0);
+    receiver.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+    sender.bind(QHostAddress::LocalHost, 0);
+}
+
+void DatagramBatchTests::runAllTests() {
+    flushTest();
+    mixerFrameBenchmark();
+}
+
+void DatagramBatchTests::flushTest() {
+    QUdpSocket receiver, sender;
+    setupSockets(receiver, sender);
+    HifiSockAddr destination(receiver.localAddress(), receiver.localPort());
+
+    DatagramBatch batch(sender);
+    assert(!batch.isCollecting());
+
+    // more than one run's worth, of varying sizes, from a buffer that is reused between queue calls
+    const int NUM_DATAGRAMS = MAX_DATAGRAMS_PER_SEND * 2 + 10;
+    qint64 numBytesQueued = 0;
+    QByteArray buffer;
+
+    batch.begin();
+    assert(batch.isCollecting());
+
+    for (int i = 0; i < NUM_DATAGRAMS; i++) {
+        buffer.fill('a' + i % 26, 100 + i);
+        batch.queueDatagram(buffer, destination);
+        numBytesQueued += buffer.size();
+    }
+    assert(batch.getNumQueued() == NUM_DATAGRAMS);
+
+    int numWritten = batch.flush();
+    assert(numWritten == NUM_DATAGRAMS);
+    assert(!batch.isCollecting());
+    assert(batch.getNumQueued() == 0);
+    assert(batch.getNumDatagramsSent() == (quint64) NUM_DATAGRAMS);
+    assert(batch.getNumSendCallsLastFlush() > 0);
+
+#ifdef Q_OS_LINUX
+    assert(batch.getNumSendCallsLastFlush() < NUM_DATAGRAMS);
+#endif
+
+    receiver.waitForReadyRead(1000);
+    qint64 numBytesReceived = 0;
+    int numReceived = drainSocket(receiver, numBytesReceived);
+    assert(numReceived == NUM_DATAGRAMS);
+    assert(numBytesReceived == numBytesQueued);
+
+    // flushing an empty batch sends nothing
+    batch.begin();
+    assert(batch.flush() == 0);
+    assert(batch.getNumSendCallsLastFlush() == 0);
+}
+
+struct MixerFrameProfile {
+    const char* assignmentName;
+    int numPacketsPerFrame;
+    int numBytesPerPacket;
+};
+
+void DatagramBatchTests::mixerFrameBenchmark() {
+    // what one frame of each sender puts on the wire, with a typical packet size
+    const MixerFrameProfile PROFILES[] = {
+        { "audio-mixer x20", 20, 1004 },
+        { "audio-mixer x100", 100, 1004 },
+        { "avatar-mixer x50", 150, 600 },
+        { "octree-send burst", 40, 1450 }
+    };
+    const int NUM_PROFILES = sizeof(PROFILES) / sizeof(MixerFrameProfile);
+
+    const int NUM_FRAMES = 500;
+
+    printf("loopback send, usecs and send calls per frame\n");
+    printf("%-20s %12s %12s %12s %12s\n", "frame", "per-packet", "calls", "batched", "calls");
+
+    for (int p = 0; p < NUM_PROFILES; p++) {
+        const MixerFrameProfile& profile = PROFILES[p];
+        QByteArray packet(profile.numBytesPerPacket, 'x');
+
+        QUdpSocket receiver, sender;
+        setupSockets(receiver, sender);
+        HifiSockAddr destination(receiver.localAddress(), receiver.localPort());
+        qint64 numBytesReceived = 0;
+
+        qint64 perPacketNsecs = 0;
+        for (int frame = 0; frame < NUM_FRAMES; frame++) {
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < profile.numPacketsPerFrame; i++) {
+                sender.writeDatagram(packet, destination.getAddress(), destination.getPort());
+            }
+            perPacketNsecs += timer.nsecsElapsed();
+            drainSocket(receiver, numBytesReceived);
+        }
+
+        DatagramBatch batch(sender);
+        qint64 batchedNsecs = 0;
+        for (int frame = 0; frame < NUM_FRAMES; frame++) {
+            QElapsedTimer timer;
+            timer.start();
+            batch.begin();
+            for (int i = 0; i < profile.numPacketsPerFrame; i++) {
+                batch.queueDatagram(packet, destination);
+            }
+            batch.flush();
+            batchedNsecs += timer.nsecsElapsed();
+            drainSocket(receiver, numBytesReceived);
+        }
+
+        const double NSECS_PER_USEC = 1000.0;
+        printf("%-20s %12.1f %12d %12.1f %12.1f\n", profile.assignmentName,
+               perPacketNsecs / NSECS_PER_USEC / NUM_FRAMES, profile.numPacketsPerFrame,
+               batchedNsecs / NSECS_PER_USEC / NUM_FRAMES, (double) batch.getNumSendCalls() / NUM_FRAMES);
+    }
+}
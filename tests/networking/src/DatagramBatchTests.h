@@ -0,0 +1,25 @@
+//
+//  DatagramBatchTests.h
+//  tests/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_DatagramBatchTests_h
+#define hifi_DatagramBatchTests_h
+
+#include "DatagramBatch.h"
+
+namespace DatagramBatchTests {
+
+    void runAllTests();
+
+    void flushTest();
+    void mixerFrameBenchmark();
+};
+
+#endif // hifi_DatagramBatchTests_h
@@ -0,0 +1,181 @@
+//
+//  PacketDispatcherTests.cpp
+//  tests/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <assert.h>
+#include <stdio.h>
+
+#include <QtCore/QElapsedTimer>
+
+#include "PacketDispatcherTests.h"
+
+class CountingPacketHandler : public PacketHandler {
+public:
+    CountingPacketHandler() : numPackets(0), numBytes(0), lastType(PacketTypeUnknown) { }
+
+    virtual void handlePacket(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+        ++numPackets;
+        numBytes += packet.size();
+        lastType = packetTypeForPacket(packet);
+    }
+
+    int numPackets;
+    qint64 numBytes;
+    PacketType lastType;
+};
+
+static QByteArray makePacket(PacketType type, int numPayloadBytes) {
+    // pass a connection UUID so the header doesn't need a LimitedNodeList instance
+    QByteArray packet = byteArrayWithPopulatedHeader(type, QUuid::createUuid());
+    packet.append(QByteArray(numPayloadBytes, 'x'));
+    return packet;
+}
+
+static void setupSockets(QUdpSocket& receiver, QUdpSocket& sender) {
+    receiver.bind(QHostAddress::LocalHost, 0);
+    receiver.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4 * 1024 * 1024);
+    sender.bind(QHostAddress::LocalHost, 0);
+}
+
+void PacketDispatcherTests::runAllTests() {
+    dispatchTest();
+    loopbackBenchmark();
+}
+
+void PacketDispatcherTests::dispatchTest() {
+    QUdpSocket receiver, sender;
+    setupSockets(receiver, sender);
+
+    PacketDispatcher dispatcher(receiver);
+    dispatcher.setVerifiesPackets(false);
+
+    CountingPacketHandler* audioHandler = new CountingPacketHandler();
+    CountingPacketHandler* defaultHandler = new CountingPacketHandler();
+    dispatcher.registerHandler(PacketTypeMicrophoneAudioNoEcho, audioHandler);
+    dispatcher.setDefaultHandler(defaultHandler);
+
+    const int NUM_AUDIO_PACKETS = 100;
+    const int NUM_OTHER_PACKETS = 150;
+    QByteArray audioPacket = makePacket(PacketTypeMicrophoneAudioNoEcho, 960);
+    QByteArray otherPacket = makePacket(PacketTypePing, 8);
+
+    for (int i = 0; i < NUM_AUDIO_PACKETS + NUM_OTHER_PACKETS; i++) {
+        const QByteArray& packet = (i % 5 < 2) ? audioPacket : otherPacket;
+        sender.writeDatagram(packet, receiver.localAddress(), receiver.localPort());
+    }
+
+    int numRead = dispatcher.processPendingDatagrams();
+
+    assert(numRead == NUM_AUDIO_PACKETS + NUM_OTHER_PACKETS);
+    assert(audioHandler->numPackets == NUM_AUDIO_PACKETS);
+    assert(audioHandler->numBytes == (qint64) NUM_AUDIO_PACKETS * audioPacket.size());
+    assert(audioHandler->lastType == PacketTypeMicrophoneAudioNoEcho);
+    assert(defaultHandler->numPackets == NUM_OTHER_PACKETS);
+    assert(defaultHandler->lastType == PacketTypePing);
+    assert(dispatcher.getNumPacketsDropped() == 0);
+    assert(dispatcher.getNumBatches() < (quint64) numRead);
+
+    // datagrams over the MTU (billboards, for example) must come through whole in the middle of a batch as well
+    const int NUM_BILLBOARD_PACKETS = 4;
+    CountingPacketHandler* billboardHandler = new CountingPacketHandler();
+    dispatcher.registerHandler(PacketTypeAvatarBillboard, billboardHandler);
+    QByteArray billboardPacket = makePacket(PacketTypeAvatarBillboard, 40 * 1024);
+
+    for (int i = 0; i < NUM_BILLBOARD_PACKETS; i++) {
+        sender.writeDatagram(otherPacket, receiver.localAddress(), receiver.localPort());
+        sender.writeDatagram(billboardPacket, receiver.localAddress(), receiver.localPort());
+    }
+
+    numRead = dispatcher.processPendingDatagrams();
+
+    assert(numRead == 2 * NUM_BILLBOARD_PACKETS);
+    assert(billboardHandler->numPackets == NUM_BILLBOARD_PACKETS);
+    assert(billboardHandler->numBytes == (qint64) NUM_BILLBOARD_PACKETS * billboardPacket.size());
+    assert(dispatcher.getNumPacketsDropped() == 0);
+}
+
+struct TrafficProfile {
+    const char* assignmentName;
+    PacketType type;
+    int numPayloadBytes;
+};
+
+void PacketDispatcherTests::loopbackBenchmark() {
+    // the packet each assignment type receives the most of, with a typical payload size
+    const TrafficProfile PROFILES[] = {
+        { "audio-mixer", PacketTypeMicrophoneAudioNoEcho, 991 },
+        { "avatar-mixer", PacketTypeAvatarData, 120 },
+        { "octree-server", PacketTypeVoxelQuery, 96 },
+        { "agent", PacketTypeVoxelData, 1400 },
+        { "metavoxel-server", PacketTypeMetavoxelData, 512 },
+        { "domain-server", PacketTypeDomainListRequest, 48 }
+    };
+    const int NUM_PROFILES = sizeof(PROFILES) / sizeof(TrafficProfile);
+
+    const int NUM_BURSTS = 200;
+    const int PACKETS_PER_BURST = 256;
+
+    printf("loopback receive + dispatch, packets/sec on one core\n");
+    printf("%-18s %14s %14s\n", "assignment", "per-packet", "batched");
+
+    for (int p = 0; p < NUM_PROFILES; p++) {
+        const TrafficProfile& profile = PROFILES[p];
+        QByteArray packet = makePacket(profile.type, profile.numPayloadBytes);
+
+        QUdpSocket receiver, sender;
+        setupSockets(receiver, sender);
+
+        // the way the assignments used to read: a fresh QByteArray per datagram and a re-parse of the header
+        qint64 legacyNsecs = 0;
+        int legacyPackets = 0;
+        for (int burst = 0; burst < NUM_BURSTS; burst++) {
+            for (int i = 0; i < PACKETS_PER_BURST; i++) {
+                sender.writeDatagram(packet, receiver.localAddress(), receiver.localPort());
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+
+            QByteArray receivedPacket;
+            HifiSockAddr senderSockAddr;
+            while (receiver.hasPendingDatagrams()) {
+                receivedPacket.resize(receiver.pendingDatagramSize());
+                receiver.readDatagram(receivedPacket.data(), receivedPacket.size(),
+                                      senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
+                if (packetTypeForPacket(receivedPacket) == profile.type && numBytesForPacketHeader(receivedPacket) > 0) {
+                    ++legacyPackets;
+                }
+            }
+            legacyNsecs += timer.nsecsElapsed();
+        }
+
+        PacketDispatcher dispatcher(receiver);
+        dispatcher.setVerifiesPackets(false);
+        CountingPacketHandler* handler = new CountingPacketHandler();
+        dispatcher.registerHandler(profile.type, handler);
+
+        qint64 batchedNsecs = 0;
+        for (int burst = 0; burst < NUM_BURSTS; burst++) {
+            for (int i = 0; i < PACKETS_PER_BURST; i++) {
+                sender.writeDatagram(packet, receiver.localAddress(), receiver.localPort());
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            dispatcher.processPendingDatagrams();
+            batchedNsecs += timer.nsecsElapsed();
+        }
+
+        const double NSECS_PER_SECOND = 1.0e9;
+        printf("%-18s %14.0f %14.0f\n", profile.assignmentName,
+               legacyPackets * NSECS_PER_SECOND / qMax(legacyNsecs, (qint64) 1),
+               handler->numPackets * NSECS_PER_SECOND / qMax(batchedNsecs, (qint64) 1));
+    }
+}
@@ -0,0 +1,25 @@
+//
+//  PacketDispatcherTests.h
+//  tests/networking/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketDispatcherTests_h
+#define hifi_PacketDispatcherTests_h
+
+#include "PacketDispatcher.h"
+
+namespace PacketDispatcherTests {
+
+    void runAllTests();
+
+    void dispatchTest();
+    void loopbackBenchmark();
+};
+
+#endif // hifi_PacketDispatcherTests_h
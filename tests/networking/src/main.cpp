@@ -8,11 +8,15 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "DatagramBatchTests.h"
+#include "PacketDispatcherTests.h"
 #include "SequenceNumberStatsTests.h"
 #include <stdio.h>
 
 int main(int argc, char** argv) {
     SequenceNumberStatsTests::runAllTests();
+    PacketDispatcherTests::runAllTests();
+    DatagramBatchTests::runAllTests();
     printf("tests passed! press enter to exit");
     getchar();
     return 0;
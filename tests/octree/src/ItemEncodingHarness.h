@@ -0,0 +1,103 @@
+//
+//  ItemEncodingHarness.h
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ItemEncodingHarness_h
+#define hifi_ItemEncodingHarness_h
+
+#include <QByteArray>
+#include <QVector>
+
+#include <Octree.h>
+#include <OctreeItemDeltas.h>
+#include <PacketHeaders.h>
+
+/// Sends the items of a tree of models or particles from a server tree to a client tree through the bitstream, the way
+/// the octree server and a client do, and compares the items of the two.  Items are looked up by IDs from zero up to
+/// the item count.
+template<class Tree, class Item>
+class ItemEncodingHarness {
+public:
+    typedef const Item* (Tree::*ItemFinder)(uint32_t id, bool alreadyLocked);
+    typedef bool (*ItemMatcher)(const Item* serverItem, const Item* clientItem);
+
+    ItemEncodingHarness(PacketType packetType, int itemCount, ItemFinder findItem, ItemMatcher itemsMatch) :
+        _packetType(packetType),
+        _itemCount(itemCount),
+        _findItem(findItem),
+        _itemsMatch(itemsMatch) {
+    }
+
+    /// Encodes the whole tree, counting each section as a packet that was sent.
+    /// \return the number of bytes of the sections
+    int encode(Tree& tree, OctreeItemDeltas* deltas, QVector<QByteArray>& sections) const;
+
+    void decode(Tree& tree, const QVector<QByteArray>& sections, OctreeReceivedStrings* receivedStrings) const;
+
+    /// \return the number of items of the server tree that the client tree doesn't have the same
+    int countMismatches(Tree& serverTree, Tree& clientTree) const;
+
+private:
+    PacketType _packetType;
+    int _itemCount;
+    ItemFinder _findItem;
+    ItemMatcher _itemsMatch;
+};
+
+template<class Tree, class Item>
+int ItemEncodingHarness<Tree, Item>::encode(Tree& tree, OctreeItemDeltas* deltas, QVector<QByteArray>& sections) const {
+    OctreeElementBag bag;
+    bag.insert(tree.getRoot());
+    OctreePacketData packetData(false);
+    int bytes = 0;
+
+    while (!bag.isEmpty()) {
+        OctreeElement* subTree = bag.extract();
+        packetData.reset();
+        EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, WANT_EXISTS_BITS, 0, false,
+                                     IGNORE_VIEW_FRUSTUM, NO_OCCLUSION_CULLING, IGNORE_COVERAGE_MAP, NO_BOUNDARY_ADJUST,
+                                     DEFAULT_OCTREE_SIZE_SCALE, IGNORE_LAST_SENT, true, IGNORE_SCENE_STATS,
+                                     IGNORE_JURISDICTION_MAP, deltas);
+        tree.encodeTreeBitstream(subTree, &packetData, bag, params);
+        if (deltas) {
+            deltas->sectionWritten(&packetData);
+            deltas->packetSent();
+        }
+        if (packetData.getUncompressedSize() > 0) {
+            sections.append(QByteArray(reinterpret_cast<const char*>(packetData.getUncompressedData()),
+                                       packetData.getUncompressedSize()));
+            bytes += packetData.getUncompressedSize();
+        }
+    }
+    return bytes;
+}
+
+template<class Tree, class Item>
+void ItemEncodingHarness<Tree, Item>::decode(Tree& tree, const QVector<QByteArray>& sections,
+                                             OctreeReceivedStrings* receivedStrings) const {
+    foreach (const QByteArray& section, sections) {
+        ReadBitstreamToTreeParams args(WANT_COLOR, WANT_EXISTS_BITS, NULL, QUuid(), SharedNodePointer(), false,
+                                       versionForPacketType(_packetType), receivedStrings);
+        tree.readBitstreamToTree(reinterpret_cast<const unsigned char*>(section.constData()), section.size(), args);
+    }
+}
+
+template<class Tree, class Item>
+int ItemEncodingHarness<Tree, Item>::countMismatches(Tree& serverTree, Tree& clientTree) const {
+    int mismatches = 0;
+    for (int i = 0; i < _itemCount; i++) {
+        if (!_itemsMatch((serverTree.*_findItem)(i, false), (clientTree.*_findItem)(i, false))) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+#endif // hifi_ItemEncodingHarness_h
@@ -0,0 +1,156 @@
+//
+//  JurisdictionRoutingTests.cpp
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+
+#include <QDebug>
+
+#include <JurisdictionMap.h>
+#include <JurisdictionRoutingIndex.h>
+#include <OctalCode.h>
+#include <OctreeConstants.h>
+#include <SharedUtil.h>
+
+#include "JurisdictionRoutingTests.h"
+
+// the edits of a bulk import: small voxels all over the domain
+const int NUM_EDITS = 200000;
+const float EDIT_VOXEL_SIZE = 1.0f / 4096.0f;
+
+// Splits the domain the way a domain with many octree servers is set up: one server per top level octant, with
+// the first octant handed on to eight more servers, one for each of its children.
+static void buildJurisdictions(QVector<JurisdictionMap>& jurisdictions) {
+    unsigned char rootCode[] = { 0 };
+
+    for (int octant = 0; octant < NUMBER_OF_CHILDREN; octant++) {
+        unsigned char* octantCode = childOctalCode(rootCode, octant);
+        std::vector<unsigned char*> endNodes;
+
+        if (octant == 0) {
+            for (int child = 0; child < NUMBER_OF_CHILDREN; child++) {
+                // the maps own their codes, so the end node and the child server's root each get their own copy
+                endNodes.push_back(childOctalCode(octantCode, child));
+
+                std::vector<unsigned char*> noEndNodes;
+                jurisdictions.append(JurisdictionMap(childOctalCode(octantCode, child), noEndNodes));
+            }
+        }
+        jurisdictions.append(JurisdictionMap(octantCode, endNodes));
+    }
+}
+
+void JurisdictionRoutingTests::routingTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "JurisdictionRoutingTests::routingTests()";
+
+    QVector<JurisdictionMap> jurisdictions;
+    buildJurisdictions(jurisdictions);
+
+    JurisdictionRoutingIndex index;
+    for (int i = 0; i < jurisdictions.size(); i++) {
+        index.addJurisdiction(i, jurisdictions[i]);
+    }
+
+    QVector<unsigned char*> edits(NUM_EDITS);
+    for (int i = 0; i < NUM_EDITS; i++) {
+        edits[i] = pointToVoxel(randFloat(), randFloat(), randFloat(), EDIT_VOXEL_SIZE);
+    }
+
+    // what OctreeEditPacketSender used to do for every edit: ask each server's map
+    QVector<RoutedServers> scanned(NUM_EDITS);
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < NUM_EDITS; i++) {
+        for (int server = 0; server < jurisdictions.size(); server++) {
+            if (jurisdictions[server].isMyJurisdiction(edits[i], CHECK_NODE_ONLY) == JurisdictionMap::WITHIN) {
+                scanned[i].append(server);
+            }
+        }
+    }
+    quint64 scanElapsed = usecTimestampNow() - start;
+
+    QVector<RoutedServers> routed(NUM_EDITS);
+    start = usecTimestampNow();
+    for (int i = 0; i < NUM_EDITS; i++) {
+        index.findServers(edits[i], routed[i]);
+    }
+    quint64 indexElapsed = usecTimestampNow() - start;
+
+    qDebug() << "TIME - isMyJurisdiction() for" << jurisdictions.size() << "servers," << NUM_EDITS << "edits"
+        << (float)scanElapsed / USECS_PER_MSEC << "msecs,"
+        << NUM_EDITS * (float)USECS_PER_SECOND / qMax(scanElapsed, (quint64)1) << "edits/sec";
+    qDebug() << "TIME - JurisdictionRoutingIndex::findServers()" << NUM_EDITS << "edits"
+        << (float)indexElapsed / USECS_PER_MSEC << "msecs,"
+        << NUM_EDITS * (float)USECS_PER_SECOND / qMax(indexElapsed, (quint64)1) << "edits/sec";
+
+    {
+        testsTaken++;
+        int numMismatched = 0;
+        int numUnrouted = 0;
+        for (int i = 0; i < NUM_EDITS; i++) {
+            std::sort(routed[i].begin(), routed[i].end());
+            bool matches = (routed[i].size() == scanned[i].size());
+            for (int j = 0; matches && j < routed[i].size(); j++) {
+                matches = (routed[i][j] == scanned[i][j]);
+            }
+            if (!matches) {
+                numMismatched++;
+            }
+            if (scanned[i].size() == 0) {
+                numUnrouted++;
+            }
+        }
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": index agrees with isMyJurisdiction(), unrouted edits:" << numUnrouted;
+        }
+        if (numMismatched == 0 && numUnrouted == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ":" << numMismatched << "edits routed differently,"
+                << numUnrouted << "edits not routed at all";
+        }
+    }
+
+    {
+        testsTaken++;
+        // the octant roots themselves are ABOVE their jurisdictions, and the whole domain is above everything
+        unsigned char rootCode[] = { 0 };
+        unsigned char* octantCode = childOctalCode(rootCode, 3);
+        RoutedServers rootServers;
+        RoutedServers octantServers;
+        index.findServers(rootCode, rootServers);
+        index.findServers(octantCode, octantServers);
+        delete[] octantCode;
+
+        if (rootServers.size() == 0 && octantServers.size() == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": codes at or above a root were routed";
+        }
+    }
+
+    for (int i = 0; i < NUM_EDITS; i++) {
+        delete[] edits[i];
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void JurisdictionRoutingTests::runAllTests(bool verbose) {
+    routingTests(verbose);
+}
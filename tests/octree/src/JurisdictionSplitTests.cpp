@@ -0,0 +1,378 @@
+//
+//  JurisdictionSplitTests.cpp
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include <JurisdictionLoadTracker.h>
+#include <JurisdictionMap.h>
+#include <OctalCode.h>
+#include <OctreeConstants.h>
+#include <SharedUtil.h>
+#include <SubtreeHandoff.h>
+#include <VoxelTree.h>
+
+#include "JurisdictionSplitTests.h"
+
+const int NUM_BUSY_CLIENT_LOADS = 6000;
+const int NUM_QUIET_CLIENT_LOADS = 4000;
+const float LOAD_PER_ENCODE_USECS = 100.0f;
+
+const int NUM_HANDOFF_VOXELS = 40;
+const float HANDOFF_VOXEL_SIZE = 1.0f / 256.0f;
+
+// small enough that the subtree takes several chunks
+const int HANDOFF_CHUNK_SIZE = 256;
+
+// the center of the given subtree, in meters like the camera positions the octree servers charge load to
+static glm::vec3 subtreeCenter(const unsigned char* octalCode) {
+    VoxelPositionSize details;
+    voxelDetailsForCode(octalCode, details);
+    return glm::vec3(details.x + details.s / 2.0f, details.y + details.s / 2.0f, details.z + details.s / 2.0f)
+        * (float)TREE_SCALE;
+}
+
+// the corner of one of the voxels put in the given subtree, in tree units
+static glm::vec3 handoffVoxelCorner(const unsigned char* octalCode, int i) {
+    VoxelPositionSize details;
+    voxelDetailsForCode(octalCode, details);
+    const int STEPS_PER_AXIS = 8;
+    glm::vec3 step(i % STEPS_PER_AXIS, (i / STEPS_PER_AXIS) % STEPS_PER_AXIS, i % 3);
+    return glm::vec3(details.x, details.y, details.z) + step * (details.s / STEPS_PER_AXIS);
+}
+
+static void createHandoffVoxels(VoxelTree& tree, const unsigned char* octalCode) {
+    for (int i = 0; i < NUM_HANDOFF_VOXELS; i++) {
+        glm::vec3 corner = handoffVoxelCorner(octalCode, i);
+        tree.createVoxel(corner.x, corner.y, corner.z, HANDOFF_VOXEL_SIZE, 100 + i, 200 - i, 50 + 2 * i);
+    }
+}
+
+// how many of the voxels put in the given subtree the tree has
+static int countHandoffVoxels(const VoxelTree& tree, const unsigned char* octalCode) {
+    int count = 0;
+    for (int i = 0; i < NUM_HANDOFF_VOXELS; i++) {
+        glm::vec3 corner = handoffVoxelCorner(octalCode, i);
+        VoxelTreeElement* voxel = tree.getVoxelAt(corner.x, corner.y, corner.z, HANDOFF_VOXEL_SIZE);
+        if (voxel && voxel->isColored()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static bool sameOctalCode(const QByteArray& code, const unsigned char* otherCode) {
+    return !code.isEmpty()
+        && compareOctalCodes(reinterpret_cast<const unsigned char*>(code.constData()), otherCode) == EXACT_MATCH;
+}
+
+void JurisdictionSplitTests::splitTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "JurisdictionSplitTests::splitTests()";
+
+    unsigned char rootCode[] = { 0 };
+    unsigned char* busyOctantCode = childOctalCode(rootCode, 3);
+    unsigned char* busyChildCode = childOctalCode(busyOctantCode, 5);
+    unsigned char* quietOctantCode = childOctalCode(rootCode, 6);
+
+    {
+        testsTaken++;
+        // a standby server's jurisdiction covers nothing, also after being copied like the jurisdiction listeners do
+        JurisdictionMap standby("00", "00");
+        JurisdictionMap standbyCopy(standby);
+        JurisdictionMap wholeTree;
+
+        bool passed = standby.isEmpty() && standbyCopy.isEmpty() && !wholeTree.isEmpty()
+            && standbyCopy.isMyJurisdiction(busyChildCode, CHECK_NODE_ONLY) != JurisdictionMap::WITHIN;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": standby jurisdictions are empty";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": standby empty" << standby.isEmpty()
+                << "copy empty" << standbyCopy.isEmpty() << "whole tree empty" << wholeTree.isEmpty();
+        }
+    }
+
+    {
+        testsTaken++;
+        // handing off a subtree above one of our end nodes replaces that end node
+        JurisdictionMap jurisdiction;
+        jurisdiction.addEndNode(busyChildCode);
+        jurisdiction.addEndNode(busyOctantCode);
+
+        bool passed = jurisdiction.getEndNodeCount() == 1
+            && compareOctalCodes(jurisdiction.getEndNodeOctalCode(0), busyOctantCode) == EXACT_MATCH
+            && jurisdiction.isMyJurisdiction(busyChildCode, CHECK_NODE_ONLY) != JurisdictionMap::WITHIN
+            && jurisdiction.isMyJurisdiction(quietOctantCode, CHECK_NODE_ONLY) == JurisdictionMap::WITHIN;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": addEndNode() replaces the end nodes below it";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": end node count" << jurisdiction.getEndNodeCount();
+        }
+    }
+
+    JurisdictionMap jurisdiction;
+    JurisdictionLoadTracker loadTracker;
+    loadTracker.setJurisdiction(&jurisdiction);
+
+    glm::vec3 busyPosition = subtreeCenter(busyChildCode);
+    glm::vec3 quietPosition = subtreeCenter(quietOctantCode);
+
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < NUM_BUSY_CLIENT_LOADS; i++) {
+        loadTracker.addLoad(busyPosition, LOAD_PER_ENCODE_USECS);
+    }
+    for (int i = 0; i < NUM_QUIET_CLIENT_LOADS; i++) {
+        loadTracker.addLoad(quietPosition, LOAD_PER_ENCODE_USECS);
+    }
+    quint64 elapsed = usecTimestampNow() - start;
+    int numLoads = NUM_BUSY_CLIENT_LOADS + NUM_QUIET_CLIENT_LOADS;
+
+    qDebug() << "TIME - JurisdictionLoadTracker::addLoad()" << numLoads << "loads"
+        << (float)elapsed / USECS_PER_MSEC << "msecs,"
+        << numLoads * (float)USECS_PER_SECOND / qMax(elapsed, (quint64)1) << "loads/sec";
+
+    {
+        testsTaken++;
+        // the busy octant has less than MAX_HANDOFF_LOAD_SHARE of the load, so it is handed off as a whole
+        float subtreeLoad = 0.0f;
+        QByteArray chosenCode = loadTracker.chooseSubtreeToHandOff(&jurisdiction, subtreeLoad);
+
+        bool passed = sameOctalCode(chosenCode, busyOctantCode) && subtreeLoad > 0.0f;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": the busiest octant is chosen, subtree load" << subtreeLoad
+                << "of" << loadTracker.getLoad() << "usecs/sec";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": chose" << chosenCode.toHex();
+        }
+    }
+
+    {
+        testsTaken++;
+        // once the busy octant is handed off, all of the remaining load is in the quiet octant. Handing all of it off
+        // would only move the problem, so the tracker goes down to the tracked subtree the clients are in.
+        jurisdiction.addEndNode(busyOctantCode);
+
+        float subtreeLoad = 0.0f;
+        QByteArray chosenCode = loadTracker.chooseSubtreeToHandOff(&jurisdiction, subtreeLoad);
+
+        glm::vec3 quietTreePosition = quietPosition / (float)TREE_SCALE;
+        unsigned char* trackedCode = pointToVoxel(quietTreePosition.x, quietTreePosition.y, quietTreePosition.z,
+                                                  1.0f / (1 << LOAD_TRACKING_LEVELS));
+
+        bool passed = sameOctalCode(chosenCode, trackedCode);
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": subtrees that were handed off are not chosen again";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": chose" << chosenCode.toHex();
+        }
+        delete[] trackedCode;
+    }
+
+    {
+        testsTaken++;
+        float subtreeLoad = 0.0f;
+        JurisdictionMap standby("00", "00");
+        QByteArray chosenCode = loadTracker.chooseSubtreeToHandOff(&standby, subtreeLoad);
+
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": a standby server has nothing to hand off";
+        }
+        if (chosenCode.isEmpty() && subtreeLoad == 0.0f) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": chose" << chosenCode.toHex();
+        }
+    }
+
+    delete[] busyOctantCode;
+    delete[] busyChildCode;
+    delete[] quietOctantCode;
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void JurisdictionSplitTests::handoffTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "JurisdictionSplitTests::handoffTests()";
+
+    unsigned char rootCode[] = { 0 };
+    unsigned char* handedOffCode = childOctalCode(rootCode, 3);
+    unsigned char* endNodeCode = childOctalCode(handedOffCode, 0);
+    unsigned char* keptCode = childOctalCode(rootCode, 6);
+
+    VoxelTree sourceTree;
+    createHandoffVoxels(sourceTree, handedOffCode);
+    createHandoffVoxels(sourceTree, endNodeCode);
+    createHandoffVoxels(sourceTree, keptCode);
+
+    VoxelTree targetTree;
+
+    {
+        testsTaken++;
+        // chunks get lost, resent and reordered on the way, the standby has to end up with the subtree all the same
+        JurisdictionMap wholeTree;
+        QVector<QByteArray> chunks = SubtreeHandoff::encodeSubtree(&sourceTree, handedOffCode, &wholeTree,
+                                                                   HANDOFF_CHUNK_SIZE);
+        for (int i = chunks.size() - 1; i >= 0; i -= 2) {
+            SubtreeHandoff::readChunk(&targetTree, chunks[i], SharedNodePointer());
+        }
+        for (int i = 0; i < chunks.size(); i++) {
+            SubtreeHandoff::readChunk(&targetTree, chunks[i], SharedNodePointer());
+        }
+
+        int handedOffVoxels = countHandoffVoxels(targetTree, handedOffCode);
+        int keptVoxels = countHandoffVoxels(targetTree, keptCode);
+        bool passed = !chunks.isEmpty() && handedOffVoxels == NUM_HANDOFF_VOXELS && keptVoxels == 0;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": the subtree arrives whole in" << chunks.size()
+                << "chunks read out of order and twice";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ":" << chunks.size() << "chunks, handed off voxels"
+                << handedOffVoxels << "kept voxels" << keptVoxels;
+        }
+    }
+
+    {
+        testsTaken++;
+        // the source only sends what is within its jurisdiction, and drops the subtree once it's handed off
+        JurisdictionMap jurisdiction;
+        jurisdiction.addEndNode(endNodeCode);
+        QVector<QByteArray> chunks = SubtreeHandoff::encodeSubtree(&sourceTree, handedOffCode, &jurisdiction,
+                                                                   HANDOFF_CHUNK_SIZE);
+        VoxelTree otherTree;
+        for (int i = 0; i < chunks.size(); i++) {
+            SubtreeHandoff::readChunk(&otherTree, chunks[i], SharedNodePointer());
+        }
+        SubtreeHandoff::deleteSubtree(&sourceTree, handedOffCode);
+
+        int sentEndNodeVoxels = countHandoffVoxels(otherTree, endNodeCode);
+        int leftVoxels = countHandoffVoxels(sourceTree, handedOffCode);
+        int keptVoxels = countHandoffVoxels(sourceTree, keptCode);
+        bool passed = sentEndNodeVoxels == 0 && leftVoxels == 0 && keptVoxels == NUM_HANDOFF_VOXELS;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": end nodes are not sent, the subtree is dropped after the handoff";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": voxels sent below the end node" << sentEndNodeVoxels
+                << "left in the source" << leftVoxels << "kept by the source" << keptVoxels;
+        }
+    }
+
+    {
+        testsTaken++;
+        // edits forwarded to the standby can land outside its jurisdiction, they get trimmed away
+        createHandoffVoxels(targetTree, keptCode);
+
+        unsigned char* handedOffEndNodeCode = new unsigned char[bytesRequiredForCodeLength(
+            numberOfThreeBitSectionsInCode(endNodeCode))];
+        memcpy(handedOffEndNodeCode, endNodeCode, bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(endNodeCode)));
+        unsigned char* standbyRootCode = new unsigned char[bytesRequiredForCodeLength(
+            numberOfThreeBitSectionsInCode(handedOffCode))];
+        memcpy(standbyRootCode, handedOffCode, bytesRequiredForCodeLength(numberOfThreeBitSectionsInCode(handedOffCode)));
+        std::vector<unsigned char*> endNodes;
+        endNodes.push_back(handedOffEndNodeCode);
+        JurisdictionMap standbyJurisdiction(standbyRootCode, endNodes);
+
+        SubtreeHandoff::trimToJurisdiction(&targetTree, standbyJurisdiction);
+
+        int keptVoxels = countHandoffVoxels(targetTree, keptCode);
+        int endNodeVoxels = countHandoffVoxels(targetTree, endNodeCode);
+        bool passed = keptVoxels == 0 && endNodeVoxels == 0
+            && standbyJurisdiction.isMyJurisdiction(endNodeCode, CHECK_NODE_ONLY) != JurisdictionMap::WITHIN;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": trimming leaves only what is within the jurisdiction";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": voxels left outside the root" << keptVoxels
+                << "below the end node" << endNodeVoxels;
+        }
+    }
+
+    {
+        testsTaken++;
+        // a server that comes back up has the jurisdiction it saved last, not the end nodes it had before that
+        QString filename = QDir::tempPath() + "/JurisdictionSplitTests.jurisdiction";
+        QFile::remove(filename);
+
+        JurisdictionMap jurisdiction;
+        jurisdiction.addEndNode(endNodeCode);
+        jurisdiction.addEndNode(keptCode);
+        bool written = jurisdiction.writeToFile(filename.toLocal8Bit().constData());
+        jurisdiction.addEndNode(rootCode);
+        written = written && jurisdiction.writeToFile(filename.toLocal8Bit().constData());
+
+        JurisdictionMap restored(filename.toLocal8Bit().constData());
+        bool passed = written && restored.isEmpty() && restored.getEndNodeCount() == 1
+            && compareOctalCodes(restored.getRootOctalCode(), rootCode) == EXACT_MATCH;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": the saved jurisdiction is restored";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": written" << written << "restored end nodes"
+                << restored.getEndNodeCount();
+        }
+        QFile::remove(filename);
+    }
+
+    delete[] handedOffCode;
+    delete[] endNodeCode;
+    delete[] keptCode;
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void JurisdictionSplitTests::runAllTests(bool verbose) {
+    splitTests(verbose);
+    handoffTests(verbose);
+}
@@ -0,0 +1,21 @@
+//
+//  JurisdictionSplitTests.h
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_JurisdictionSplitTests_h
+#define hifi_JurisdictionSplitTests_h
+
+namespace JurisdictionSplitTests {
+    void splitTests(bool verbose = false);
+    void handoffTests(bool verbose = false);
+    void runAllTests(bool verbose = false);
+}
+
+#endif // hifi_JurisdictionSplitTests_h
@@ -19,11 +19,103 @@
 #include <ModelTree.h>
 #include <ModelTreeElement.h>
 #include <OctreeConstants.h>
+#include <OctreeItemDeltas.h>
+#include <PacketHeaders.h>
 #include <PropertyFlags.h>
 #include <SharedUtil.h>
+#include <ViewFrustum.h>
 
+#include "ItemEncodingHarness.h"
 #include "ModelTests.h"
 
+// a grid of models, in meters, which share a few model and animation URLs
+const int ENCODING_MODEL_COUNT = 500;
+const int ENCODING_GRID_SIZE = 20;
+const float ENCODING_MODEL_SPACING = 3.0f;
+const float ENCODING_MODEL_RADIUS = 0.5f;
+const glm::vec3 ENCODING_GRID_CORNER(100.0f, 10.0f, 100.0f);
+const int ENCODING_URL_COUNT = 4;
+
+// every this many models move and change color between updates in the benchmark
+const int ENCODING_CHANGED_MODEL_INTERVAL = 10;
+const int ENCODING_UPDATE_COUNT = 10;
+
+static ModelItemID encodingModelID(uint32_t id, bool isKnownID) {
+    ModelItemID modelID(id);
+    modelID.isKnownID = isKnownID; // local tree models are added with unknown IDs, and edited with known ones
+    return modelID;
+}
+
+static glm::vec3 encodingModelPosition(int index) {
+    return ENCODING_GRID_CORNER + glm::vec3((index % ENCODING_GRID_SIZE) * ENCODING_MODEL_SPACING,
+                                            (index / (ENCODING_GRID_SIZE * ENCODING_GRID_SIZE)) * ENCODING_MODEL_SPACING,
+                                            ((index / ENCODING_GRID_SIZE) % ENCODING_GRID_SIZE) * ENCODING_MODEL_SPACING);
+}
+
+static void buildEncodingScene(ModelTree& tree) {
+    for (int i = 0; i < ENCODING_MODEL_COUNT; i++) {
+        ModelItemProperties properties;
+        properties.setPosition(encodingModelPosition(i));
+        properties.setRadius(ENCODING_MODEL_RADIUS);
+        xColor color = { (unsigned char)(i % 256), 128, (unsigned char)(255 - i % 256) };
+        properties.setColor(color);
+        properties.setModelURL(QString("http://public.highfidelity.io/models/model%1.fbx").arg(i % ENCODING_URL_COUNT));
+        properties.setModelRotation(glm::angleAxis((float)i, glm::vec3(0.0f, 1.0f, 0.0f)));
+        if (i % 3 == 0) {
+            properties.setAnimationURL("http://public.highfidelity.io/animations/walk.fbx");
+            properties.setAnimationIsPlaying(true);
+            properties.setAnimationFPS(24.0f);
+        }
+        tree.addModel(encodingModelID(i, false), properties);
+    }
+}
+
+// moves and recolors every ENCODING_CHANGED_MODEL_INTERVAL'th model
+static void changeEncodingScene(ModelTree& tree, int update) {
+    for (int i = update % ENCODING_CHANGED_MODEL_INTERVAL; i < ENCODING_MODEL_COUNT; i += ENCODING_CHANGED_MODEL_INTERVAL) {
+        ModelItemProperties properties;
+        properties.setPosition(encodingModelPosition(i) + glm::vec3(0.01f * (update + 1), 0.0f, 0.0f));
+        xColor color = { 255, (unsigned char)(update * 16), 0 };
+        properties.setColor(color);
+        tree.updateModel(encodingModelID(i, true), properties);
+    }
+}
+
+// whether the client has a model the same as the server, within the quantization
+static bool modelsMatch(const ModelItem* serverModel, const ModelItem* clientModel) {
+    if (!serverModel || !clientModel) {
+        return false;
+    }
+    float positionError = glm::length(serverModel->getPosition() - clientModel->getPosition());
+    float rotationAlignment = fabsf(glm::dot(serverModel->getModelRotation(), clientModel->getModelRotation()));
+    const float MIN_ROTATION_ALIGNMENT = 0.999f;
+    if (positionError > serverModel->getRadius() * MAX_QUANTIZED_POSITION_STEP_PER_RADIUS ||
+            serverModel->getRadius() != clientModel->getRadius() ||
+            memcmp(serverModel->getColor(), clientModel->getColor(), sizeof(rgbColor)) != 0 ||
+            serverModel->getModelURL() != clientModel->getModelURL() ||
+            serverModel->getAnimationURL() != clientModel->getAnimationURL() ||
+            serverModel->getAnimationIsPlaying() != clientModel->getAnimationIsPlaying() ||
+            serverModel->getAnimationFPS() != clientModel->getAnimationFPS() ||
+            rotationAlignment < MIN_ROTATION_ALIGNMENT) {
+        return false;
+    }
+    return true;
+}
+
+static const ItemEncodingHarness<ModelTree, ModelItem> modelEncoding(PacketTypeModelData, ENCODING_MODEL_COUNT,
+                                                                     &ModelTree::findModelByID, modelsMatch);
+
+static void setUpEncodingFrustum(ViewFrustum& viewFrustum, const glm::vec3& position) {
+    viewFrustum.setPosition(position);
+    viewFrustum.setOrientation(glm::quat()); // looking down -z
+    viewFrustum.setFieldOfView(DEFAULT_FIELD_OF_VIEW_DEGREES);
+    viewFrustum.setAspectRatio(DEFAULT_ASPECT_RATIO);
+    viewFrustum.setNearClip(DEFAULT_NEAR_CLIP);
+    viewFrustum.setFarClip(ENCODING_GRID_SIZE * ENCODING_MODEL_SPACING * 4.0f);
+    viewFrustum.setKeyholeRadius(DEFAULT_KEYHOLE_RADIUS);
+    viewFrustum.calculate();
+}
+
 void ModelTests::modelTreeTests(bool verbose) {
     int testsTaken = 0;
     int testsPassed = 0;
@@ -258,7 +350,277 @@ void ModelTests::modelTreeTests(bool verbose) {
 }
 
 
+void ModelTests::modelEncodingTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    if (verbose) {
+        qDebug() << "******************************************************************************************";
+    }
+
+    qDebug() << "ModelTests::modelEncodingTests()";
+
+    ModelTree serverTree;
+    buildEncodingScene(serverTree);
+    OctreeItemDeltas deltas;
+    ModelTree clientTree;
+    OctreeReceivedStrings receivedStrings;
+    int fullBytes = 0;
+
+    {
+        testsTaken++;
+        QString testName = "first send with item deltas matches the server";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        QVector<QByteArray> sections;
+        fullBytes = modelEncoding.encode(serverTree, &deltas, sections);
+        modelEncoding.decode(clientTree, sections, &receivedStrings);
+        int mismatches = modelEncoding.countMismatches(serverTree, clientTree);
+
+        if (verbose) {
+            qDebug() << "bytes=" << fullBytes << "mismatches=" << mismatches << "items=" << deltas.getItemCount()
+                << "strings=" << deltas.getStringCount();
+        }
+
+        // the model URLs, the animation URL, and the empty animation URL of the models without animation
+        bool passed = mismatches == 0 && deltas.getItemCount() == ENCODING_MODEL_COUNT &&
+            deltas.getStringCount() == ENCODING_URL_COUNT + 2;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "resending unchanged models takes less than half the bytes";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        QVector<QByteArray> sections;
+        int bytes = modelEncoding.encode(serverTree, &deltas, sections);
+        modelEncoding.decode(clientTree, sections, &receivedStrings);
+        int mismatches = modelEncoding.countMismatches(serverTree, clientTree);
+
+        if (verbose) {
+            qDebug() << "bytes=" << bytes << "first send bytes=" << fullBytes << "mismatches=" << mismatches;
+        }
+
+        bool passed = mismatches == 0 && bytes * 2 < fullBytes;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "moved and recolored models reach the client";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        changeEncodingScene(serverTree, 0);
+        QVector<QByteArray> sections;
+        modelEncoding.encode(serverTree, &deltas, sections);
+        modelEncoding.decode(clientTree, sections, &receivedStrings);
+        int mismatches = modelEncoding.countMismatches(serverTree, clientTree);
+
+        if (verbose) {
+            qDebug() << "mismatches=" << mismatches;
+        }
+
+        bool passed = mismatches == 0;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "after a reset, a client that missed everything gets all models whole";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        // the strings keep their indexes, so the new client can still only learn them from definitions
+        deltas.reset();
+        ModelTree newClientTree;
+        OctreeReceivedStrings newReceivedStrings;
+        QVector<QByteArray> sections;
+        modelEncoding.encode(serverTree, &deltas, sections);
+        modelEncoding.decode(newClientTree, sections, &newReceivedStrings);
+        int mismatches = modelEncoding.countMismatches(serverTree, newClientTree);
+
+        if (verbose) {
+            qDebug() << "mismatches=" << mismatches;
+        }
+
+        bool passed = mismatches == 0;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "an erased model is forgotten, and sent whole if it comes back";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        int itemCount = deltas.getItemCount();
+        deltas.forgetItem(0);
+        int itemCountAfterForget = deltas.getItemCount();
+
+        // a client that only reads this send only has the models that were sent whole
+        ModelTree newClientTree;
+        QVector<QByteArray> sections;
+        modelEncoding.encode(serverTree, &deltas, sections);
+        modelEncoding.decode(newClientTree, sections, &receivedStrings);
+        bool sentWhole = modelsMatch(serverTree.findModelByID(0), newClientTree.findModelByID(0)) &&
+            !modelsMatch(serverTree.findModelByID(1), newClientTree.findModelByID(1));
+
+        if (verbose) {
+            qDebug() << "items=" << itemCount << "after forget=" << itemCountAfterForget << "sentWhole=" << sentWhole;
+        }
+
+        bool passed = itemCountAfterForget == itemCount - 1 && sentWhole && deltas.getItemCount() == itemCount;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "models are forgotten when they leave the view, and only then";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        glm::vec3 gridMiddle = ENCODING_GRID_CORNER + glm::vec3(ENCODING_GRID_SIZE * ENCODING_MODEL_SPACING * 0.5f,
+                                                                ENCODING_MODEL_SPACING * 0.5f, 0.0f);
+        int itemCount = deltas.getItemCount();
+
+        // in front of the grid, looking at it
+        ViewFrustum inFront;
+        setUpEncodingFrustum(inFront, gridMiddle + glm::vec3(0.0f, 0.0f, ENCODING_GRID_SIZE * ENCODING_MODEL_SPACING * 1.5f));
+        deltas.forgetItemsOutside(inFront);
+        int itemCountInView = deltas.getItemCount();
+
+        // behind the grid, looking away from it
+        ViewFrustum behind;
+        setUpEncodingFrustum(behind, gridMiddle - glm::vec3(0.0f, 0.0f, ENCODING_MODEL_SPACING * 3.0f));
+        deltas.forgetItemsOutside(behind);
+        int itemCountOutOfView = deltas.getItemCount();
+
+        if (verbose) {
+            qDebug() << "items=" << itemCount << "in view=" << itemCountInView << "out of view=" << itemCountOutOfView;
+        }
+
+        bool passed = itemCountInView == itemCount && itemCountOutOfView == 0;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "without item deltas, as in files, models are read whole without received strings";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        ModelTree fileTree;
+        QVector<QByteArray> sections;
+        modelEncoding.encode(serverTree, IGNORE_ITEM_DELTAS, sections);
+        modelEncoding.decode(fileTree, sections, NULL);
+        int mismatches = modelEncoding.countMismatches(serverTree, fileTree);
+        const ModelItem* model = fileTree.findModelByID(0);
+        bool positionIsExact = model && serverTree.findModelByID(0) &&
+            model->getPosition() == serverTree.findModelByID(0)->getPosition();
+
+        // rotations get the packing OctreePacketData::appendValue(glm::quat) gave them before property flags
+        bool rotationIsUnchanged = false;
+        if (model && serverTree.findModelByID(0)) {
+            OctreePacketData rotationData(false);
+            rotationData.appendValue(serverTree.findModelByID(0)->getModelRotation());
+            glm::quat oldRotation;
+            unpackOrientationQuatFromBytes(rotationData.getUncompressedData(), oldRotation);
+            rotationIsUnchanged = model->getModelRotation() == oldRotation;
+        }
+
+        if (verbose) {
+            qDebug() << "mismatches=" << mismatches << "positionIsExact=" << positionIsExact
+                << "rotationIsUnchanged=" << rotationIsUnchanged;
+        }
+
+        bool passed = mismatches == 0 && positionIsExact && rotationIsUnchanged;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    if (verbose) {
+        qDebug() << "******************************************************************************************";
+    }
+}
+
+void ModelTests::modelEncodingBenchmark() {
+    qDebug() << "ModelTests::modelEncodingBenchmark()";
+
+    ModelTree serverTree;
+    buildEncodingScene(serverTree);
+    OctreeItemDeltas deltas;
+    QVector<QByteArray> sections;
+    modelEncoding.encode(serverTree, &deltas, sections);
+
+    int bytesWithoutDeltas = 0;
+    int bytesWithDeltas = 0;
+    for (int update = 0; update < ENCODING_UPDATE_COUNT; update++) {
+        changeEncodingScene(serverTree, update);
+        sections.clear();
+        bytesWithoutDeltas += modelEncoding.encode(serverTree, IGNORE_ITEM_DELTAS, sections);
+        sections.clear();
+        bytesWithDeltas += modelEncoding.encode(serverTree, &deltas, sections);
+    }
+
+    qDebug() << "BYTES - models:" << ENCODING_MODEL_COUNT << "changed per update:"
+        << ENCODING_MODEL_COUNT / ENCODING_CHANGED_MODEL_INTERVAL;
+    qDebug() << "   without item deltas: bytes per update=" << bytesWithoutDeltas / ENCODING_UPDATE_COUNT;
+    qDebug() << "   with item deltas: bytes per update=" << bytesWithDeltas / ENCODING_UPDATE_COUNT
+        << "ratio=" << (float)bytesWithDeltas / (float)bytesWithoutDeltas;
+}
+
+
 void ModelTests::runAllTests(bool verbose) {
     modelTreeTests(verbose);
+    modelEncodingTests(verbose);
+    modelEncodingBenchmark();
 }
 
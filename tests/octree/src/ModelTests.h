@@ -14,6 +14,13 @@
 
 namespace ModelTests {
     void modelTreeTests(bool verbose = false);
+
+    /// sends models to a client tree with and without the state of a connection, and compares the client's models
+    void modelEncodingTests(bool verbose = false);
+
+    /// counts the bytes of sending the models of a scene in which a few models change, with and without item deltas
+    void modelEncodingBenchmark();
+
     void runAllTests(bool verbose = false);
 }
 
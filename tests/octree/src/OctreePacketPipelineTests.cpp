@@ -0,0 +1,384 @@
+//
+//  OctreePacketPipelineTests.cpp
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cstring>
+
+#include <QDebug>
+#include <QThread>
+
+#include <Octree.h>
+#include <OctreePacketData.h>
+#include <OctreePacketPipeline.h>
+#include <PacketHeaders.h>
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+#include <VoxelTreeHeadlessViewer.h>
+
+#include "OctreePacketPipelineTests.h"
+
+// a floor with a field of pillars on it, all made of the smallest voxels, in tree units
+const int SCENE_GRID_SIZE = 128;
+const float SCENE_VOXEL_SIZE = 1.0f / 1024.0f;
+const int PILLAR_SPACING = 4;
+const int MAX_PILLAR_HEIGHT = 16;
+
+// leaves room for the section size and for compression making small sections bigger
+const int SECTION_PADDING = 16;
+
+static void buildScene(VoxelTree& tree, unsigned char pillarRed) {
+    for (int x = 0; x < SCENE_GRID_SIZE; x++) {
+        for (int z = 0; z < SCENE_GRID_SIZE; z++) {
+            tree.createVoxel(x * SCENE_VOXEL_SIZE, 0.0f, z * SCENE_VOXEL_SIZE, SCENE_VOXEL_SIZE, 128, 128, 128);
+
+            if (x % PILLAR_SPACING == 0 && z % PILLAR_SPACING == 0) {
+                int height = 1 + (x * 7 + z * 13) % MAX_PILLAR_HEIGHT;
+                for (int y = 1; y <= height; y++) {
+                    tree.createVoxel(x * SCENE_VOXEL_SIZE, y * SCENE_VOXEL_SIZE, z * SCENE_VOXEL_SIZE,
+                                     SCENE_VOXEL_SIZE, pillarRed, 0, 0);
+                }
+            }
+        }
+    }
+}
+
+// the data packets a voxel server would send for the whole tree, one compressed section each
+static void encodePackets(VoxelTree& tree, const QUuid& serverUUID, QVector<QByteArray>& packets) {
+    OctreeElementBag bag;
+    bag.insert(tree.getRoot());
+    OctreePacketData packetData(true, MAX_OCTREE_PACKET_DATA_SIZE - SECTION_PADDING);
+    OCTREE_PACKET_SEQUENCE sequence = 0;
+
+    while (!bag.isEmpty()) {
+        OctreeElement* subTree = bag.extract();
+        packetData.reset();
+        EncodeBitstreamParams params(INT_MAX, IGNORE_VIEW_FRUSTUM, WANT_COLOR, WANT_EXISTS_BITS);
+        tree.encodeTreeBitstream(subTree, &packetData, bag, params);
+        if (packetData.getUncompressedSize() == 0) {
+            continue;
+        }
+
+        QByteArray packet = byteArrayWithPopulatedHeader(PacketTypeVoxelData, serverUUID);
+        OCTREE_PACKET_FLAGS flags = 0;
+        setAtBit(flags, PACKET_IS_COLOR_BIT);
+        setAtBit(flags, PACKET_IS_COMPRESSED_BIT);
+        OCTREE_PACKET_SENT_TIME sentAt = usecTimestampNow();
+        OCTREE_PACKET_INTERNAL_SECTION_SIZE sectionSize = packetData.getFinalizedSize();
+        packet.append(reinterpret_cast<const char*>(&flags), sizeof(flags));
+        packet.append(reinterpret_cast<const char*>(&sequence), sizeof(sequence));
+        packet.append(reinterpret_cast<const char*>(&sentAt), sizeof(sentAt));
+        packet.append(reinterpret_cast<const char*>(&sectionSize), sizeof(sectionSize));
+        packet.append(reinterpret_cast<const char*>(packetData.getFinalizedData()), sectionSize);
+        packets.append(packet);
+        sequence++;
+    }
+}
+
+class LeafComparison {
+public:
+    VoxelTree* otherTree;
+    int leaves;
+    int mismatches;
+};
+
+static bool compareLeafOperation(OctreeElement* element, void* extraData) {
+    LeafComparison* comparison = static_cast<LeafComparison*>(extraData);
+    VoxelTreeElement* voxel = static_cast<VoxelTreeElement*>(element);
+    if (voxel->isLeaf() && voxel->isColored()) {
+        comparison->leaves++;
+        const glm::vec3& corner = voxel->getCorner();
+        VoxelTreeElement* other = comparison->otherTree->getVoxelAt(corner.x, corner.y, corner.z, voxel->getScale());
+        if (!other || !other->isLeaf() || !other->isColored() || memcmp(other->getColor(), voxel->getColor(), 3) != 0) {
+            comparison->mismatches++;
+        }
+    }
+    return true;
+}
+
+// the number of colored leaves in one tree that the other tree doesn't have the same, both ways around
+static int countMismatchedLeaves(VoxelTree& tree, VoxelTree& otherTree) {
+    LeafComparison comparison = { &otherTree, 0, 0 };
+    tree.recurseTreeWithOperation(compareLeafOperation, &comparison);
+    LeafComparison reverseComparison = { &tree, 0, 0 };
+    otherTree.recurseTreeWithOperation(compareLeafOperation, &reverseComparison);
+    return comparison.mismatches + reverseComparison.mismatches;
+}
+
+// reads a packet the way OctreeRenderer::processDatagram() did before the pipeline: decompressing and reading each
+// section inside the write lock
+static void readPacketInsideLock(VoxelTree& tree, const QByteArray& packet) {
+    int numBytesPacketHeader = numBytesForPacketHeader(packet);
+    const unsigned char* dataAt = reinterpret_cast<const unsigned char*>(packet.data()) + numBytesPacketHeader +
+        OCTREE_PACKET_EXTRA_HEADERS_SIZE;
+    OCTREE_PACKET_INTERNAL_SECTION_SIZE sectionLength = (*(OCTREE_PACKET_INTERNAL_SECTION_SIZE*)dataAt);
+    dataAt += sizeof(OCTREE_PACKET_INTERNAL_SECTION_SIZE);
+
+    ReadBitstreamToTreeParams args(WANT_COLOR, WANT_EXISTS_BITS, NULL, uuidFromPacketHeader(packet));
+    tree.lockForWrite();
+    OctreePacketData packetData(true);
+    packetData.loadFinalizedContent(dataAt, sectionLength);
+    tree.readBitstreamToTree(packetData.getUncompressedData(), packetData.getUncompressedSize(), args);
+    tree.unlock();
+}
+
+// takes the read lock over and over, the way rendering and picking do, and remembers the longest wait for it
+class TreeReader : public QThread {
+public:
+    TreeReader(VoxelTree* tree) : _tree(tree), _stop(false), _longestWaitUsecs(0), _reads(0) { }
+
+    void stop() { _stop = true; }
+    quint64 getLongestWaitUsecs() const { return _longestWaitUsecs; }
+    int getReads() const { return _reads; }
+
+protected:
+    virtual void run() {
+        const unsigned long READ_INTERVAL_USECS = 200;
+        while (!_stop) {
+            quint64 start = usecTimestampNow();
+            _tree->lockForRead();
+            _longestWaitUsecs = qMax(_longestWaitUsecs, usecTimestampNow() - start);
+            _tree->unlock();
+            _reads++;
+            usleep(READ_INTERVAL_USECS);
+        }
+    }
+
+private:
+    VoxelTree* _tree;
+    volatile bool _stop;
+    quint64 _longestWaitUsecs;
+    int _reads;
+};
+
+// remembers how much of the scene was in the tree when an erase packet was handed to it
+class EraseRecordingVoxelTree : public VoxelTree {
+public:
+    EraseRecordingVoxelTree(VoxelTree* scene) : _scene(scene), _erases(0), _mismatchesAtErase(-1) { }
+
+    virtual void processEraseMessage(const QByteArray& dataByteArray, const SharedNodePointer& sourceNode) {
+        _erases++;
+        _mismatchesAtErase = countMismatchedLeaves(*_scene, *this);
+    }
+
+    int getErases() const { return _erases; }
+    int getMismatchesAtErase() const { return _mismatchesAtErase; }
+
+private:
+    VoxelTree* _scene;
+    int _erases;
+    int _mismatchesAtErase;
+};
+
+void OctreePacketPipelineTests::headlessViewerTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "OctreePacketPipelineTests::headlessViewerTests()";
+
+    QUuid serverUUID = QUuid::createUuid();
+    VoxelTree scene;
+    buildScene(scene, 255);
+    QVector<QByteArray> packets;
+    encodePackets(scene, serverUUID, packets);
+
+    {
+        testsTaken++;
+        VoxelTreeHeadlessViewer viewer;
+        viewer.init();
+        foreach (const QByteArray& packet, packets) {
+            viewer.processDatagram(packet, SharedNodePointer());
+        }
+        viewer.getPacketPipeline().flush();
+
+        int mismatches = countMismatchedLeaves(scene, *viewer.getTree());
+        const OctreePacketPipeline& pipeline = viewer.getPacketPipeline();
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ":" << packets.size() << "packets, queued at most"
+                << pipeline.getMaxQueuedPacketCount() << "- latency" << pipeline.getAverageApplyLatencyUsecs() << "usecs,"
+                << "longest lock window" << pipeline.getLongestApplyWindowUsecs() << "usecs";
+        }
+        if (mismatches == 0 && pipeline.getQueuedPacketCount() == 0 && pipeline.getDecodedSectionCount() == 0 &&
+                pipeline.getAppliedSectionCount() == (quint64)packets.size()) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": viewer tree differs from the scene in" << mismatches
+                << "leaves, queued=" << pipeline.getQueuedPacketCount() << "applied=" << pipeline.getAppliedSectionCount()
+                << "of" << packets.size();
+        }
+    }
+
+    {
+        // a second pass over the scene with other colors, queued before the first one is read: the threads may decode
+        // the packets out of order, but the second pass has to end up in the tree
+        testsTaken++;
+        VoxelTree recoloredScene;
+        buildScene(recoloredScene, 64);
+        QVector<QByteArray> recoloredPackets;
+        encodePackets(recoloredScene, serverUUID, recoloredPackets);
+
+        VoxelTreeHeadlessViewer viewer;
+        viewer.init();
+        OctreePacketPipeline& pipeline = viewer.getPacketPipeline();
+        foreach (const QByteArray& packet, packets) {
+            pipeline.queuePacket(packet, SharedNodePointer());
+        }
+        foreach (const QByteArray& packet, recoloredPackets) {
+            pipeline.queuePacket(packet, SharedNodePointer());
+        }
+        pipeline.flush();
+
+        int mismatches = countMismatchedLeaves(recoloredScene, *viewer.getTree());
+        if (mismatches == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": packets read out of order," << mismatches << "leaves differ";
+        }
+    }
+
+    {
+        // an erase queued behind data packets has to wait for them, or older data could bring back what it erased
+        testsTaken++;
+        EraseRecordingVoxelTree tree(&scene);
+        OctreePacketPipeline pipeline;
+        pipeline.setTree(&tree);
+        foreach (const QByteArray& packet, packets) {
+            pipeline.queuePacket(packet, SharedNodePointer());
+        }
+        pipeline.queueEraseMessage(byteArrayWithPopulatedHeader(PacketTypeParticleErase, serverUUID), SharedNodePointer());
+        pipeline.flush();
+
+        if (tree.getErases() == 1 && tree.getMismatchesAtErase() == 0 &&
+                pipeline.getAppliedSectionCount() == (quint64)packets.size() + 1) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": erase applied" << tree.getErases() << "times, with"
+                << tree.getMismatchesAtErase() << "leaves of the data queued before it missing";
+        }
+    }
+
+    {
+        // packets of the domain we're leaving, still queued or decoding when the tree is cleared, must not come back
+        testsTaken++;
+        VoxelTree recoloredScene;
+        buildScene(recoloredScene, 64);
+        QVector<QByteArray> recoloredPackets;
+        encodePackets(recoloredScene, serverUUID, recoloredPackets);
+
+        VoxelTreeHeadlessViewer viewer;
+        viewer.init();
+        OctreePacketPipeline& pipeline = viewer.getPacketPipeline();
+        foreach (const QByteArray& packet, packets) {
+            pipeline.queuePacket(packet, SharedNodePointer());
+        }
+        viewer.clear();
+        pipeline.flush();
+
+        VoxelTree emptyTree;
+        int leftoverLeaves = countMismatchedLeaves(emptyTree, *viewer.getTree());
+        int queuedAfterClear = pipeline.getQueuedPacketCount();
+
+        // and what comes in after is read as usual
+        foreach (const QByteArray& packet, recoloredPackets) {
+            pipeline.queuePacket(packet, SharedNodePointer());
+        }
+        pipeline.flush();
+
+        int mismatches = countMismatchedLeaves(recoloredScene, *viewer.getTree());
+        if (leftoverLeaves == 0 && queuedAfterClear == 0 && mismatches == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ":" << leftoverLeaves << "leaves read after clear(),"
+                << queuedAfterClear << "packets left queued," << mismatches << "leaves differ after it";
+        }
+    }
+
+    {
+        testsTaken++;
+        VoxelTreeHeadlessViewer viewer;
+        viewer.init();
+        viewer.getPacketPipeline().setIsThreaded(false);
+        foreach (const QByteArray& packet, packets) {
+            viewer.processDatagram(packet, SharedNodePointer());
+        }
+        bool queuedPackets = viewer.getPacketPipeline().hasQueuedPackets();
+        viewer.getPacketPipeline().flush();
+
+        int mismatches = countMismatchedLeaves(scene, *viewer.getTree());
+        if (mismatches == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": unthreaded viewer tree differs from the scene in" << mismatches
+                << "leaves, packets left after processDatagram()=" << queuedPackets;
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void OctreePacketPipelineTests::ingestBenchmark() {
+    qDebug() << "OctreePacketPipelineTests::ingestBenchmark()";
+
+    VoxelTree scene;
+    buildScene(scene, 255);
+    QVector<QByteArray> packets;
+    encodePackets(scene, QUuid::createUuid(), packets);
+
+    {
+        VoxelTree tree(true);
+        TreeReader reader(&tree);
+        reader.start();
+        quint64 start = usecTimestampNow();
+        foreach (const QByteArray& packet, packets) {
+            readPacketInsideLock(tree, packet);
+        }
+        quint64 elapsed = usecTimestampNow() - start;
+        reader.stop();
+        reader.wait();
+        qDebug() << "TIME - read inside the lock" << packets.size() << "packets" << (float)elapsed / USECS_PER_MSEC
+            << "msecs, longest reader wait" << reader.getLongestWaitUsecs() << "usecs," << reader.getReads() << "reads";
+    }
+
+    {
+        VoxelTree tree(true);
+        OctreePacketPipeline pipeline;
+        pipeline.setTree(&tree);
+        TreeReader reader(&tree);
+        reader.start();
+        quint64 start = usecTimestampNow();
+        foreach (const QByteArray& packet, packets) {
+            pipeline.queuePacket(packet, SharedNodePointer());
+            pipeline.applyDecodedSections();
+        }
+        pipeline.flush();
+        quint64 elapsed = usecTimestampNow() - start;
+        reader.stop();
+        reader.wait();
+        qDebug() << "TIME - pipeline" << packets.size() << "packets" << (float)elapsed / USECS_PER_MSEC
+            << "msecs, longest reader wait" << reader.getLongestWaitUsecs() << "usecs," << reader.getReads() << "reads";
+        qDebug() << "       queued at most" << pipeline.getMaxQueuedPacketCount() << "packets, latency average"
+            << pipeline.getAverageApplyLatencyUsecs() << "usecs, longest" << pipeline.getLongestApplyLatencyUsecs()
+            << "usecs, lock window average" << pipeline.getAverageApplyWindowUsecs() << "usecs, longest"
+            << pipeline.getLongestApplyWindowUsecs() << "usecs";
+    }
+}
+
+void OctreePacketPipelineTests::runAllTests(bool verbose) {
+    headlessViewerTests(verbose);
+    ingestBenchmark();
+}
@@ -0,0 +1,26 @@
+//
+//  OctreePacketPipelineTests.h
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreePacketPipelineTests_h
+#define hifi_OctreePacketPipelineTests_h
+
+namespace OctreePacketPipelineTests {
+
+    /// sends the packets of a scene to a headless viewer, and compares the viewer's tree against the scene
+    void headlessViewerTests(bool verbose = false);
+
+    /// times reading the packets of a scene the way processDatagram() used to against reading them through a pipeline
+    void ingestBenchmark();
+
+    void runAllTests(bool verbose = false);
+}
+
+#endif // hifi_OctreePacketPipelineTests_h
@@ -0,0 +1,225 @@
+//
+//  OctreeRayTests.cpp
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+
+#include <Octree.h>
+#include <OctreeConstants.h>
+#include <SharedUtil.h>
+#include <VoxelTree.h>
+
+#include "OctreeRayTests.h"
+
+// a floor with a field of pillars on it, all made of the smallest voxels, in tree units
+const int SCENE_GRID_SIZE = 64;
+const float SCENE_VOXEL_SIZE = 1.0f / 1024.0f;
+const int PILLAR_SPACING = 4;
+const int MAX_PILLAR_HEIGHT = 16;
+
+const int NUM_RAYS = 20000;
+
+// how far, in meters, the reference results may be from the ones of the tree
+const float REFERENCE_DISTANCE_TOLERANCE = 0.001f;
+
+static void buildScene(VoxelTree& tree) {
+    for (int x = 0; x < SCENE_GRID_SIZE; x++) {
+        for (int z = 0; z < SCENE_GRID_SIZE; z++) {
+            tree.createVoxel(x * SCENE_VOXEL_SIZE, 0.0f, z * SCENE_VOXEL_SIZE, SCENE_VOXEL_SIZE, 128, 128, 128);
+
+            if (x % PILLAR_SPACING == 0 && z % PILLAR_SPACING == 0) {
+                int height = 1 + (x * 7 + z * 13) % MAX_PILLAR_HEIGHT;
+                for (int y = 1; y <= height; y++) {
+                    tree.createVoxel(x * SCENE_VOXEL_SIZE, y * SCENE_VOXEL_SIZE, z * SCENE_VOXEL_SIZE,
+                                     SCENE_VOXEL_SIZE, 255, 0, 0);
+                }
+            }
+        }
+    }
+}
+
+// rays from a ring of eye points above the scene looking down into it at random points, in meters
+static void makeRays(QVector<OctreeRayQuery>& rays) {
+    float sceneSize = SCENE_GRID_SIZE * SCENE_VOXEL_SIZE * TREE_SCALE;
+    float eyeHeight = (MAX_PILLAR_HEIGHT + 8) * SCENE_VOXEL_SIZE * TREE_SCALE;
+    glm::vec3 center(sceneSize * 0.5f, 0.0f, sceneSize * 0.5f);
+
+    rays.resize(NUM_RAYS);
+    for (int i = 0; i < NUM_RAYS; i++) {
+        float angle = randFloat() * 2.0f * PI;
+        glm::vec3 origin = center + glm::vec3(cosf(angle) * sceneSize, eyeHeight, sinf(angle) * sceneSize);
+        glm::vec3 target(randFloat() * sceneSize, 0.0f, randFloat() * sceneSize);
+        rays[i] = OctreeRayQuery(origin, glm::normalize(target - origin));
+    }
+}
+
+// the ray cast the tree did before it traced rays front-to-back: every element the ray touches is visited in child
+// index order with recurseTreeWithOperation(), and the closest leaf that is hit wins
+class ReferenceRayArgs {
+public:
+    glm::vec3 origin;
+    glm::vec3 direction;
+    OctreeElement* element;
+    float distance;
+    BoxFace face;
+    bool found;
+};
+
+static bool referenceRayIntersectionOperation(OctreeElement* element, void* extraData) {
+    ReferenceRayArgs* args = static_cast<ReferenceRayArgs*>(extraData);
+    bool keepSearching = true;
+    if (element->findRayIntersection(args->origin, args->direction, keepSearching,
+                                     args->element, args->distance, args->face)) {
+        args->found = true;
+    }
+    return keepSearching;
+}
+
+static void findReferenceRayIntersection(VoxelTree& tree, OctreeRayQuery& ray) {
+    ReferenceRayArgs args = { ray.origin / (float)TREE_SCALE, ray.direction, NULL, FLT_MAX, MIN_X_FACE, false };
+    tree.recurseTreeWithOperation(referenceRayIntersectionOperation, &args);
+    ray.intersects = args.found;
+    ray.element = args.element;
+    ray.distance = args.distance;
+    ray.face = args.face;
+}
+
+void OctreeRayTests::rayIntersectionTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "OctreeRayTests::rayIntersectionTests()";
+
+    VoxelTree tree;
+    buildScene(tree);
+
+    QVector<OctreeRayQuery> rays;
+    makeRays(rays);
+
+    // one ray at a time, the way the callers in interface do it
+    QVector<OctreeRayQuery> singleResults = rays;
+    quint64 start = usecTimestampNow();
+    for (int i = 0; i < singleResults.size(); i++) {
+        OctreeRayQuery& ray = singleResults[i];
+        ray.intersects = tree.findRayIntersection(ray.origin, ray.direction, ray.element, ray.distance, ray.face,
+                                                  &ray.intersectedObject, Octree::Lock);
+    }
+    quint64 singleElapsed = usecTimestampNow() - start;
+
+    QVector<OctreeRayQuery> batchResults = rays;
+    start = usecTimestampNow();
+    int numIntersected = tree.findRayIntersections(batchResults, Octree::Lock);
+    quint64 batchElapsed = usecTimestampNow() - start;
+
+    QVector<OctreeRayQuery> referenceResults = rays;
+    start = usecTimestampNow();
+    tree.lockForRead();
+    for (int i = 0; i < referenceResults.size(); i++) {
+        findReferenceRayIntersection(tree, referenceResults[i]);
+    }
+    tree.unlock();
+    quint64 referenceElapsed = usecTimestampNow() - start;
+
+    qDebug() << "TIME - reference recurseTreeWithOperation() ray cast" << NUM_RAYS << "rays"
+        << (float)referenceElapsed / USECS_PER_MSEC << "msecs,"
+        << NUM_RAYS * (float)USECS_PER_SECOND / qMax(referenceElapsed, (quint64)1) << "rays/sec";
+    qDebug() << "TIME - findRayIntersection()" << NUM_RAYS << "rays" << (float)singleElapsed / USECS_PER_MSEC << "msecs,"
+        << NUM_RAYS * (float)USECS_PER_SECOND / qMax(singleElapsed, (quint64)1) << "rays/sec";
+    qDebug() << "TIME - findRayIntersections()" << NUM_RAYS << "rays" << (float)batchElapsed / USECS_PER_MSEC << "msecs,"
+        << NUM_RAYS * (float)USECS_PER_SECOND / qMax(batchElapsed, (quint64)1) << "rays/sec";
+
+    {
+        testsTaken++;
+        bool passed = numIntersected > 0;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": rays hit the scene -" << numIntersected << "of" << NUM_RAYS;
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": no ray hit the scene";
+        }
+    }
+
+    {
+        testsTaken++;
+        int numMismatched = 0;
+        for (int i = 0; i < NUM_RAYS; i++) {
+            const OctreeRayQuery& single = singleResults[i];
+            const OctreeRayQuery& batch = batchResults[i];
+            if (single.intersects != batch.intersects || (single.intersects &&
+                    (single.element != batch.element || single.distance != batch.distance || single.face != batch.face))) {
+                numMismatched++;
+            }
+        }
+        if (numMismatched == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": batched results differ from single ray results for"
+                << numMismatched << "rays";
+        }
+    }
+
+    {
+        testsTaken++;
+        // the front-to-back trace must find what visiting every element the ray touches finds
+        int numMismatched = 0;
+        for (int i = 0; i < NUM_RAYS; i++) {
+            const OctreeRayQuery& single = singleResults[i];
+            const OctreeRayQuery& reference = referenceResults[i];
+            if (single.intersects != reference.intersects || (single.intersects && (single.element != reference.element ||
+                    fabsf(single.distance - reference.distance) > REFERENCE_DISTANCE_TOLERANCE))) {
+                numMismatched++;
+                if (verbose) {
+                    qDebug() << "   ray" << i << "intersects=" << single.intersects << "distance=" << single.distance
+                        << "reference intersects=" << reference.intersects << "distance=" << reference.distance;
+                }
+            }
+        }
+        if (numMismatched == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": results differ from the reference ray cast for"
+                << numMismatched << "rays";
+        }
+    }
+
+    {
+        testsTaken++;
+        // a ray straight down onto the floor, clear of the pillars, hits the top of the floor voxel
+        glm::vec3 origin = glm::vec3(1.5f, 40.0f, 2.5f) * SCENE_VOXEL_SIZE * (float)TREE_SCALE;
+        OctreeElement* element = NULL;
+        float distance;
+        BoxFace face;
+        bool intersects = tree.findRayIntersection(origin, glm::vec3(0.0f, -1.0f, 0.0f), element, distance, face,
+                                                   NULL, Octree::Lock);
+        float expectedDistance = (40.0f - 1.0f) * SCENE_VOXEL_SIZE * TREE_SCALE;
+        if (intersects && face == MAX_Y_FACE && fabsf(distance - expectedDistance) < 0.01f) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": ray down onto the floor, intersects=" << intersects
+                << "distance=" << distance << "expected" << expectedDistance << "face=" << face;
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void OctreeRayTests::runAllTests(bool verbose) {
+    rayIntersectionTests(verbose);
+}
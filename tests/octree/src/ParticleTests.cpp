@@ -0,0 +1,313 @@
+//
+//  ParticleTests.cpp
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+
+#include <LimitedNodeList.h>
+#include <Octree.h>
+#include <OctreeConstants.h>
+#include <OctreeItemDeltas.h>
+#include <PacketHeaders.h>
+#include <Particle.h>
+#include <ParticleTree.h>
+#include <ParticleTreeElement.h>
+#include <SharedUtil.h>
+
+#include "ItemEncodingHarness.h"
+#include "ParticleTests.h"
+
+// a grid of particles, in meters, which share a few scripts and model URLs
+const int ENCODING_PARTICLE_COUNT = 200;
+const int ENCODING_GRID_SIZE = 10;
+const float ENCODING_PARTICLE_SPACING = 2.0f;
+const float ENCODING_PARTICLE_RADIUS = 0.25f;
+const glm::vec3 ENCODING_GRID_CORNER(50.0f, 5.0f, 50.0f);
+const int ENCODING_SCRIPT_COUNT = 3;
+
+// every this many particles move and change velocity between updates
+const int ENCODING_CHANGED_PARTICLE_INTERVAL = 10;
+
+static glm::vec3 encodingParticlePosition(int index) {
+    return ENCODING_GRID_CORNER + glm::vec3((index % ENCODING_GRID_SIZE) * ENCODING_PARTICLE_SPACING,
+                                            (index / (ENCODING_GRID_SIZE * ENCODING_GRID_SIZE)) * ENCODING_PARTICLE_SPACING,
+                                            ((index / ENCODING_GRID_SIZE) % ENCODING_GRID_SIZE) * ENCODING_PARTICLE_SPACING);
+}
+
+static void buildEncodingScene(ParticleTree& tree) {
+    for (int i = 0; i < ENCODING_PARTICLE_COUNT; i++) {
+        ParticleProperties properties;
+        properties.setPosition(encodingParticlePosition(i));
+        properties.setRadius(ENCODING_PARTICLE_RADIUS);
+        xColor color = { (unsigned char)(i % 256), 64, 192 };
+        properties.setColor(color);
+        properties.setVelocity(glm::vec3(0.0f, 0.1f * (i % 5), 0.0f));
+        properties.setDamping(0.5f);
+        properties.setScript(QString("function collisionWithVoxel(voxel) { print('%1'); }").arg(i % ENCODING_SCRIPT_COUNT));
+        if (i % 2 == 0) {
+            properties.setModelURL("http://public.highfidelity.io/models/ball.fbx");
+            properties.setModelRotation(glm::angleAxis((float)i, glm::vec3(1.0f, 0.0f, 0.0f)));
+        }
+        tree.addParticle(ParticleID(i, UNKNOWN_TOKEN, false), properties);
+    }
+}
+
+// moves and speeds up every ENCODING_CHANGED_PARTICLE_INTERVAL'th particle
+static void changeEncodingScene(ParticleTree& tree, int update) {
+    for (int i = update % ENCODING_CHANGED_PARTICLE_INTERVAL; i < ENCODING_PARTICLE_COUNT;
+            i += ENCODING_CHANGED_PARTICLE_INTERVAL) {
+        ParticleProperties properties;
+        properties.setPosition(encodingParticlePosition(i) + glm::vec3(0.0f, 0.01f * (update + 1), 0.0f));
+        properties.setVelocity(glm::vec3(0.0f, 1.0f + update, 0.0f));
+        tree.updateParticle(ParticleID(i), properties);
+    }
+}
+
+// whether the client has a particle the same as the server, within the quantization
+static bool particlesMatch(const Particle* serverParticle, const Particle* clientParticle) {
+    if (!serverParticle || !clientParticle) {
+        return false;
+    }
+    float positionError = glm::length(serverParticle->getPosition() - clientParticle->getPosition());
+    float rotationAlignment = fabsf(glm::dot(serverParticle->getModelRotation(), clientParticle->getModelRotation()));
+    const float MIN_ROTATION_ALIGNMENT = 0.999f;
+    if (positionError > serverParticle->getRadius() * MAX_QUANTIZED_POSITION_STEP_PER_RADIUS ||
+            serverParticle->getRadius() != clientParticle->getRadius() ||
+            memcmp(serverParticle->getColor(), clientParticle->getColor(), sizeof(rgbColor)) != 0 ||
+            serverParticle->getVelocity() != clientParticle->getVelocity() ||
+            serverParticle->getDamping() != clientParticle->getDamping() ||
+            serverParticle->getScript() != clientParticle->getScript() ||
+            serverParticle->getModelURL() != clientParticle->getModelURL() ||
+            rotationAlignment < MIN_ROTATION_ALIGNMENT) {
+        return false;
+    }
+    return true;
+}
+
+static const ItemEncodingHarness<ParticleTree, Particle> particleEncoding(PacketTypeParticleData, ENCODING_PARTICLE_COUNT,
+                                                                          &ParticleTree::findParticleByID, particlesMatch);
+
+void ParticleTests::particleEncodingTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    if (verbose) {
+        qDebug() << "******************************************************************************************";
+    }
+
+    qDebug() << "ParticleTests::particleEncodingTests()";
+
+    ParticleTree serverTree;
+    buildEncodingScene(serverTree);
+    OctreeItemDeltas deltas;
+    ParticleTree clientTree;
+    OctreeReceivedStrings receivedStrings;
+    int fullBytes = 0;
+
+    {
+        testsTaken++;
+        QString testName = "first send with item deltas matches the server";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        QVector<QByteArray> sections;
+        fullBytes = particleEncoding.encode(serverTree, &deltas, sections);
+        particleEncoding.decode(clientTree, sections, &receivedStrings);
+        int mismatches = particleEncoding.countMismatches(serverTree, clientTree);
+
+        if (verbose) {
+            qDebug() << "bytes=" << fullBytes << "mismatches=" << mismatches << "items=" << deltas.getItemCount()
+                << "strings=" << deltas.getStringCount();
+        }
+
+        // the scripts, the model URL, and the empty model URL of the particles without a model
+        bool passed = mismatches == 0 && deltas.getItemCount() == ENCODING_PARTICLE_COUNT &&
+            deltas.getStringCount() == ENCODING_SCRIPT_COUNT + 2;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "resending unchanged particles takes less than half the bytes";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        QVector<QByteArray> sections;
+        int bytes = particleEncoding.encode(serverTree, &deltas, sections);
+        particleEncoding.decode(clientTree, sections, &receivedStrings);
+        int mismatches = particleEncoding.countMismatches(serverTree, clientTree);
+
+        if (verbose) {
+            qDebug() << "bytes=" << bytes << "first send bytes=" << fullBytes << "mismatches=" << mismatches;
+        }
+
+        bool passed = mismatches == 0 && bytes * 2 < fullBytes;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "moved and sped up particles reach the client";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        changeEncodingScene(serverTree, 0);
+        QVector<QByteArray> sections;
+        particleEncoding.encode(serverTree, &deltas, sections);
+        particleEncoding.decode(clientTree, sections, &receivedStrings);
+        int mismatches = particleEncoding.countMismatches(serverTree, clientTree);
+
+        if (verbose) {
+            qDebug() << "mismatches=" << mismatches;
+        }
+
+        bool passed = mismatches == 0;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "after a reset, a client that missed everything gets all particles whole";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        deltas.reset();
+        ParticleTree newClientTree;
+        OctreeReceivedStrings newReceivedStrings;
+        QVector<QByteArray> sections;
+        particleEncoding.encode(serverTree, &deltas, sections);
+        particleEncoding.decode(newClientTree, sections, &newReceivedStrings);
+        int mismatches = particleEncoding.countMismatches(serverTree, newClientTree);
+
+        if (verbose) {
+            qDebug() << "mismatches=" << mismatches;
+        }
+
+        bool passed = mismatches == 0;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "without item deltas, as in files, particles are read whole without received strings";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        ParticleTree fileTree;
+        QVector<QByteArray> sections;
+        particleEncoding.encode(serverTree, IGNORE_ITEM_DELTAS, sections);
+        particleEncoding.decode(fileTree, sections, NULL);
+        int mismatches = particleEncoding.countMismatches(serverTree, fileTree);
+        const Particle* particle = fileTree.findParticleByID(0);
+        bool positionIsExact = particle && serverTree.findParticleByID(0) &&
+            particle->getPosition() == serverTree.findParticleByID(0)->getPosition();
+
+        if (verbose) {
+            qDebug() << "mismatches=" << mismatches << "positionIsExact=" << positionIsExact;
+        }
+
+        bool passed = mismatches == 0 && positionIsExact;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    {
+        testsTaken++;
+        QString testName = "erase messages forget the erased particles";
+        if (verbose) {
+            qDebug() << "Test" << testsTaken <<":" << qPrintable(testName);
+        }
+
+        // particles are only erased when they die in an update, so these don't move and have no scripts to run
+        const int DYING_PARTICLE_COUNT = 4;
+        ParticleTree dyingTree;
+        for (int i = 0; i < DYING_PARTICLE_COUNT; i++) {
+            ParticleProperties properties;
+            properties.setPosition(encodingParticlePosition(i));
+            properties.setRadius(ENCODING_PARTICLE_RADIUS);
+            properties.setGravity(glm::vec3(0.0f, 0.0f, 0.0f));
+            dyingTree.addParticle(ParticleID(i, UNKNOWN_TOKEN, false), properties);
+        }
+        OctreeItemDeltas dyingDeltas;
+        QVector<QByteArray> sections;
+        particleEncoding.encode(dyingTree, &dyingDeltas, sections);
+        int itemCount = dyingDeltas.getItemCount();
+
+        for (int i = 0; i < DYING_PARTICLE_COUNT; i += 2) {
+            ParticleProperties properties;
+            properties.setShouldDie(true);
+            dyingTree.updateParticle(ParticleID(i), properties);
+        }
+        dyingTree.update();
+
+        // the erase message header carries the session UUID
+        LimitedNodeList::createInstance();
+        unsigned char outputBuffer[MAX_PACKET_SIZE];
+        size_t packetLength = 0;
+        quint64 deletedParticlesSentAt = 0;
+        bool hasMoreToSend = true;
+        while (hasMoreToSend) {
+            hasMoreToSend = dyingTree.encodeParticlesDeletedSince(0, deletedParticlesSentAt, outputBuffer, MAX_PACKET_SIZE,
+                                                                  packetLength, &dyingDeltas);
+        }
+
+        if (verbose) {
+            qDebug() << "items=" << itemCount << "after erase=" << dyingDeltas.getItemCount();
+        }
+
+        bool passed = itemCount == DYING_PARTICLE_COUNT && dyingDeltas.getItemCount() == DYING_PARTICLE_COUNT / 2;
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken <<":" << qPrintable(testName);
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    if (verbose) {
+        qDebug() << "******************************************************************************************";
+    }
+}
+
+void ParticleTests::runAllTests(bool verbose) {
+    particleEncodingTests(verbose);
+}
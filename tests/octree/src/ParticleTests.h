@@ -0,0 +1,23 @@
+//
+//  ParticleTests.h
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ParticleTests_h
+#define hifi_ParticleTests_h
+
+namespace ParticleTests {
+
+    /// sends particles to a client tree with and without the state of a connection, and compares the client's particles
+    void particleEncodingTests(bool verbose = false);
+
+    void runAllTests(bool verbose = false);
+}
+
+#endif // hifi_ParticleTests_h
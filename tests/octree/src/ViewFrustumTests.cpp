@@ -0,0 +1,361 @@
+//
+//  ViewFrustumTests.cpp
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <stdlib.h>
+
+#include <QDebug>
+#include <QVector>
+
+#include <OctreeConstants.h>
+#include <SharedUtil.h>
+#include <ViewFrustum.h>
+#include <VoxelTree.h>
+
+#include "ViewFrustumTests.h"
+
+const int NUM_RANDOM_BATCHES = 500;
+const float RANDOM_CUBE_EXTENT = 60.0f; // meters around the camera
+const float MAX_RANDOM_CUBE_SCALE = 20.0f;
+const float RANDOM_FAR_CLIP = 100.0f;
+
+const int SCENE_GRID_SIZE = 32;
+const float SCENE_VOXEL_SIZE = 1.0f / 128.0f;
+const int BENCHMARK_PASSES = 200;
+
+static void setUpFrustum(ViewFrustum& viewFrustum, const glm::vec3& position, float keyholeRadius, float farClip) {
+    viewFrustum.setPosition(position);
+    viewFrustum.setOrientation(glm::quat(glm::vec3(-0.3f, 0.8f, 0.0f)));
+    viewFrustum.setFieldOfView(DEFAULT_FIELD_OF_VIEW_DEGREES);
+    viewFrustum.setAspectRatio(DEFAULT_ASPECT_RATIO);
+    viewFrustum.setNearClip(DEFAULT_NEAR_CLIP);
+    viewFrustum.setFarClip(farClip);
+    viewFrustum.setKeyholeRadius(keyholeRadius);
+    viewFrustum.calculate();
+}
+
+// cubes around the camera, some of them small and close enough to be inside the keyhole
+static AACube randomCube(const glm::vec3& position) {
+    if (randIntInRange(0, 3) == 0) {
+        glm::vec3 corner(randFloatInRange(-2.0f, 1.0f), randFloatInRange(-2.0f, 1.0f), randFloatInRange(-2.0f, 1.0f));
+        return AACube(position + corner, randFloatInRange(0.05f, 1.0f));
+    }
+    glm::vec3 corner(randFloatInRange(-RANDOM_CUBE_EXTENT, RANDOM_CUBE_EXTENT),
+                     randFloatInRange(-RANDOM_CUBE_EXTENT, RANDOM_CUBE_EXTENT),
+                     randFloatInRange(-RANDOM_CUBE_EXTENT, RANDOM_CUBE_EXTENT));
+    return AACube(position + corner, randFloatInRange(0.05f, MAX_RANDOM_CUBE_SCALE));
+}
+
+// compares random batches against cubeInFrustum(), and checks that each cube is in exactly one mask
+static bool compareRandomBatches(const ViewFrustum& viewFrustum, const glm::vec3& position, int locationCounts[3]) {
+    AACube cubes[MAX_CUBE_BATCH_SIZE];
+    for (int batch = 0; batch < NUM_RANDOM_BATCHES; batch++) {
+        int count = randIntInRange(1, MAX_CUBE_BATCH_SIZE);
+        for (int i = 0; i < count; i++) {
+            cubes[i] = randomCube(position);
+        }
+        ViewFrustum::LocationMasks masks = viewFrustum.cubesInFrustum(cubes, count);
+
+        quint32 batchMask = (count == MAX_CUBE_BATCH_SIZE) ? 0xFFFFFFFFu : ((1u << count) - 1);
+        if ((masks.inside & masks.intersect) || (masks.inside & masks.outside) || (masks.intersect & masks.outside) ||
+                (masks.inside | masks.intersect | masks.outside) != batchMask) {
+            qDebug() << "batch" << batch << "masks inside" << masks.inside << "intersect" << masks.intersect
+                << "outside" << masks.outside << "count" << count;
+            return false;
+        }
+        for (int i = 0; i < count; i++) {
+            ViewFrustum::location location = viewFrustum.cubeInFrustum(cubes[i]);
+            if (masks.getLocation(i) != location) {
+                qDebug() << "batch" << batch << "cube" << i << "location" << masks.getLocation(i) << "expected" << location;
+                return false;
+            }
+            locationCounts[location]++;
+        }
+    }
+    return true;
+}
+
+static bool collectElementsOperation(OctreeElement* element, void* extraData) {
+    static_cast<QVector<OctreeElement*>*>(extraData)->append(element);
+    return true;
+}
+
+static void buildScene(VoxelTree& tree, QVector<OctreeElement*>& elements) {
+    for (int x = 0; x < SCENE_GRID_SIZE; x++) {
+        for (int z = 0; z < SCENE_GRID_SIZE; z++) {
+            tree.createVoxel(x * SCENE_VOXEL_SIZE, 0.0f, z * SCENE_VOXEL_SIZE, SCENE_VOXEL_SIZE, 128, 128, 128);
+            if ((x + z) % 5 == 0) {
+                tree.createVoxel(x * SCENE_VOXEL_SIZE, SCENE_VOXEL_SIZE, z * SCENE_VOXEL_SIZE, SCENE_VOXEL_SIZE, 255, 0, 0);
+            }
+        }
+    }
+    tree.recurseTreeWithOperation(collectElementsOperation, &elements);
+}
+
+// a camera above the middle of the scene, looking across it
+static glm::vec3 scenePosition() {
+    float middle = SCENE_GRID_SIZE * SCENE_VOXEL_SIZE * 0.5f;
+    return glm::vec3(middle, 4.0f * SCENE_VOXEL_SIZE, middle) * (float)TREE_SCALE;
+}
+
+void ViewFrustumTests::batchCullingTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "ViewFrustumTests::batchCullingTests()";
+
+    srand(0xF00D);
+    glm::vec3 position(100.0f, 20.0f, 100.0f);
+
+    {
+        testsTaken++;
+        // with a keyhole, cubes can be inside, intersect or be outside either way
+        ViewFrustum viewFrustum;
+        setUpFrustum(viewFrustum, position, DEFAULT_KEYHOLE_RADIUS, RANDOM_FAR_CLIP);
+        int locationCounts[3] = { 0, 0, 0 };
+        bool passed = compareRandomBatches(viewFrustum, position, locationCounts) && locationCounts[ViewFrustum::INSIDE] > 0
+            && locationCounts[ViewFrustum::INTERSECT] > 0 && locationCounts[ViewFrustum::OUTSIDE] > 0;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": batches with a keyhole match cubeInFrustum(), inside"
+                << locationCounts[ViewFrustum::INSIDE] << "intersect" << locationCounts[ViewFrustum::INTERSECT]
+                << "outside" << locationCounts[ViewFrustum::OUTSIDE];
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": batches with a keyhole";
+        }
+    }
+
+    {
+        testsTaken++;
+        // a negative keyhole radius turns the keyhole off
+        ViewFrustum viewFrustum;
+        setUpFrustum(viewFrustum, position, -1.0f, RANDOM_FAR_CLIP);
+        int locationCounts[3] = { 0, 0, 0 };
+        bool passed = compareRandomBatches(viewFrustum, position, locationCounts);
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": batches without a keyhole match cubeInFrustum()";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": batches without a keyhole";
+        }
+    }
+
+    {
+        testsTaken++;
+        // an empty batch has no bits set
+        ViewFrustum viewFrustum;
+        setUpFrustum(viewFrustum, position, DEFAULT_KEYHOLE_RADIUS, RANDOM_FAR_CLIP);
+        ViewFrustum::LocationMasks masks = viewFrustum.cubesInFrustum(NULL, 0);
+        bool passed = masks.inside == 0 && masks.intersect == 0 && masks.outside == 0;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": an empty batch has empty masks";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": empty batch";
+        }
+    }
+
+    {
+        testsTaken++;
+        // the children of the elements of a scene get the locations inFrustum() gives them, by child index
+        VoxelTree tree;
+        QVector<OctreeElement*> elements;
+        buildScene(tree, elements);
+        ViewFrustum viewFrustum;
+        setUpFrustum(viewFrustum, scenePosition(), DEFAULT_KEYHOLE_RADIUS, DEFAULT_FAR_CLIP);
+
+        int mismatches = 0;
+        int childrenInView = 0;
+        int childrenOutOfView = 0;
+        foreach (OctreeElement* element, elements) {
+            ViewFrustum::LocationMasks masks = element->childrenInFrustum(viewFrustum);
+            for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+                OctreeElement* childElement = element->getChildAtIndex(i);
+                quint32 childBit = 1u << i;
+                if (!childElement) {
+                    if ((masks.inside | masks.intersect | masks.outside) & childBit) {
+                        mismatches++;
+                    }
+                    continue;
+                }
+                ViewFrustum::location location = childElement->inFrustum(viewFrustum);
+                if (masks.getLocation(i) != location || !((masks.inside | masks.intersect | masks.outside) & childBit)) {
+                    mismatches++;
+                }
+                if (location == ViewFrustum::OUTSIDE) {
+                    childrenOutOfView++;
+                } else {
+                    childrenInView++;
+                }
+            }
+        }
+        bool passed = mismatches == 0 && childrenInView > 0 && childrenOutOfView > 0;
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": childrenInFrustum() matches inFrustum() for" << elements.size()
+                << "elements," << childrenInView << "children in view," << childrenOutOfView << "out of view";
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": childrenInFrustum() mismatches" << mismatches;
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+static int countBits(quint32 mask) {
+    int count = 0;
+    for (; mask; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
+
+void ViewFrustumTests::batchCullingBenchmark() {
+    qDebug() << "ViewFrustumTests::batchCullingBenchmark()";
+
+    VoxelTree tree;
+    QVector<OctreeElement*> elements;
+    buildScene(tree, elements);
+    ViewFrustum viewFrustum;
+    setUpFrustum(viewFrustum, scenePosition(), DEFAULT_KEYHOLE_RADIUS, DEFAULT_FAR_CLIP);
+
+    int inViewOneByOne = 0;
+    quint64 start = usecTimestampNow();
+    for (int pass = 0; pass < BENCHMARK_PASSES; pass++) {
+        foreach (OctreeElement* element, elements) {
+            for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+                OctreeElement* childElement = element->getChildAtIndex(i);
+                if (childElement && childElement->isInView(viewFrustum)) {
+                    inViewOneByOne++;
+                }
+            }
+        }
+    }
+    quint64 oneByOneElapsed = usecTimestampNow() - start;
+
+    int inViewBatched = 0;
+    start = usecTimestampNow();
+    for (int pass = 0; pass < BENCHMARK_PASSES; pass++) {
+        foreach (OctreeElement* element, elements) {
+            inViewBatched += countBits(element->childrenInFrustum(viewFrustum).getInViewMask());
+        }
+    }
+    quint64 batchedElapsed = usecTimestampNow() - start;
+
+    int numTests = elements.size() * BENCHMARK_PASSES;
+    qDebug() << "TIME - children of" << elements.size() << "elements," << BENCHMARK_PASSES << "passes";
+    qDebug() << "   one by one:" << (float)oneByOneElapsed / USECS_PER_MSEC << "msecs,"
+        << numTests * (float)USECS_PER_SECOND / qMax(oneByOneElapsed, (quint64)1) << "elements/sec,"
+        << inViewOneByOne << "in view";
+    qDebug() << "   batched:" << (float)batchedElapsed / USECS_PER_MSEC << "msecs,"
+        << numTests * (float)USECS_PER_SECOND / qMax(batchedElapsed, (quint64)1) << "elements/sec,"
+        << inViewBatched << "in view";
+}
+
+// the culling VoxelSystem::hideOutOfView() does: elements fully inside or outside the view end the recursion, and the
+// children of the ones that intersect it are visited
+class HideOutOfViewArgs {
+public:
+    HideOutOfViewArgs(const ViewFrustum& viewFrustum, bool useBatches) :
+        viewFrustum(viewFrustum),
+        useBatches(useBatches),
+        locations(),
+        nodesInside(0),
+        nodesIntersect(0),
+        nodesOutside(0) {
+    }
+
+    const ViewFrustum& viewFrustum;
+    bool useBatches;
+    ChildrenFrustumLocations locations;
+    int nodesInside;
+    int nodesIntersect;
+    int nodesOutside;
+};
+
+static bool hideOutOfViewOperation(OctreeElement* element, void* extraData) {
+    HideOutOfViewArgs* args = static_cast<HideOutOfViewArgs*>(extraData);
+    ViewFrustum::location inFrustum = args->useBatches ? args->locations.getLocation(element, args->viewFrustum) :
+        element->inFrustum(args->viewFrustum);
+
+    switch (inFrustum) {
+        case ViewFrustum::OUTSIDE:
+            args->nodesOutside++;
+            return false;
+        case ViewFrustum::INSIDE:
+            args->nodesInside++;
+            return false;
+        default:
+            args->nodesIntersect++;
+            if (args->useBatches) {
+                args->locations.storeChildrenLocations(element, args->viewFrustum);
+            }
+            return true;
+    }
+}
+
+void ViewFrustumTests::hideOutOfViewBenchmark() {
+    qDebug() << "ViewFrustumTests::hideOutOfViewBenchmark()";
+
+    VoxelTree tree;
+    QVector<OctreeElement*> elements;
+    buildScene(tree, elements);
+    ViewFrustum viewFrustum;
+    setUpFrustum(viewFrustum, scenePosition(), DEFAULT_KEYHOLE_RADIUS, DEFAULT_FAR_CLIP);
+
+    HideOutOfViewArgs oneByOneArgs(viewFrustum, false);
+    quint64 start = usecTimestampNow();
+    for (int pass = 0; pass < BENCHMARK_PASSES; pass++) {
+        tree.recurseTreeWithOperation(hideOutOfViewOperation, &oneByOneArgs);
+    }
+    quint64 oneByOneElapsed = usecTimestampNow() - start;
+
+    HideOutOfViewArgs batchedArgs(viewFrustum, true);
+    start = usecTimestampNow();
+    for (int pass = 0; pass < BENCHMARK_PASSES; pass++) {
+        tree.recurseTreeWithOperation(hideOutOfViewOperation, &batchedArgs);
+    }
+    quint64 batchedElapsed = usecTimestampNow() - start;
+
+    int visited = (oneByOneArgs.nodesInside + oneByOneArgs.nodesIntersect + oneByOneArgs.nodesOutside) / BENCHMARK_PASSES;
+    qDebug() << "TIME - hideOutOfView recursion over" << elements.size() << "elements," << visited << "visited,"
+        << BENCHMARK_PASSES << "passes";
+    qDebug() << "   one by one:" << (float)oneByOneElapsed / USECS_PER_MSEC << "msecs, inside"
+        << oneByOneArgs.nodesInside << "intersect" << oneByOneArgs.nodesIntersect << "outside" << oneByOneArgs.nodesOutside;
+    qDebug() << "   batched:" << (float)batchedElapsed / USECS_PER_MSEC << "msecs, inside"
+        << batchedArgs.nodesInside << "intersect" << batchedArgs.nodesIntersect << "outside" << batchedArgs.nodesOutside;
+
+    if (batchedArgs.nodesInside != oneByOneArgs.nodesInside || batchedArgs.nodesIntersect != oneByOneArgs.nodesIntersect ||
+            batchedArgs.nodesOutside != oneByOneArgs.nodesOutside) {
+        qDebug() << "FAILED - hideOutOfView recursion with batches doesn't cull the same elements as one by one";
+    }
+}
+
+void ViewFrustumTests::runAllTests(bool verbose) {
+    batchCullingTests(verbose);
+    batchCullingBenchmark();
+    hideOutOfViewBenchmark();
+}
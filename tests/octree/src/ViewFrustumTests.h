@@ -0,0 +1,30 @@
+//
+//  ViewFrustumTests.h
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ViewFrustumTests_h
+#define hifi_ViewFrustumTests_h
+
+namespace ViewFrustumTests {
+
+    /// compares the locations ViewFrustum::cubesInFrustum() gives batches of cubes against cubeInFrustum() for each
+    void batchCullingTests(bool verbose = false);
+
+    /// times testing the children of the elements of a scene one by one against testing them in batches
+    void batchCullingBenchmark();
+
+    /// times the recursion VoxelSystem::hideOutOfView() makes, testing each element on its own against handing the
+    /// batches tested by the parents down with ChildrenFrustumLocations
+    void hideOutOfViewBenchmark();
+
+    void runAllTests(bool verbose = false);
+}
+
+#endif // hifi_ViewFrustumTests_h
@@ -0,0 +1,272 @@
+//
+//  VoxelMesherTests.cpp
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <QDebug>
+
+#include <SharedUtil.h>
+#include <VoxelMesher.h>
+#include <VoxelTree.h>
+
+#include "VoxelMesherTests.h"
+
+// the smallest voxels of the tests are at level 10; chunks of 16 of those on a side
+const float VOXEL_SIZE = 1.0f / 1024.0f;
+const int CHUNK_LEVEL = 6;
+
+// a floor with a field of pillars on it, like the scene of the ray tests but bigger
+const int SCENE_GRID_SIZE = 128;
+const int PILLAR_SPACING = 4;
+const int MAX_PILLAR_HEIGHT = 16;
+
+const int NUM_EDITS = 100;
+
+static void buildScene(VoxelTree& tree) {
+    for (int x = 0; x < SCENE_GRID_SIZE; x++) {
+        for (int z = 0; z < SCENE_GRID_SIZE; z++) {
+            tree.createVoxel(x * VOXEL_SIZE, 0.0f, z * VOXEL_SIZE, VOXEL_SIZE, 128, 128, 128);
+
+            if (x % PILLAR_SPACING == 0 && z % PILLAR_SPACING == 0) {
+                int height = 1 + (x * 7 + z * 13) % MAX_PILLAR_HEIGHT;
+                for (int y = 1; y <= height; y++) {
+                    tree.createVoxel(x * VOXEL_SIZE, y * VOXEL_SIZE, z * VOXEL_SIZE, VOXEL_SIZE, 255, 0, 0);
+                }
+            }
+        }
+    }
+}
+
+// digs holes in the floor and stacks voxels above the pillars, a different set of edits for every first edit
+static void editScene(VoxelTree& tree, int firstEdit, int numEdits) {
+    for (int i = firstEdit; i < firstEdit + numEdits; i++) {
+        int x = (i * 37) % SCENE_GRID_SIZE;
+        int z = (i * 59) % SCENE_GRID_SIZE;
+        if (i % 3 == 0) {
+            tree.deleteVoxelAt(x * VOXEL_SIZE, 0.0f, z * VOXEL_SIZE, VOXEL_SIZE);
+        } else {
+            tree.createVoxel(x * VOXEL_SIZE, (MAX_PILLAR_HEIGHT + 1 + i % 4) * VOXEL_SIZE, z * VOXEL_SIZE, VOXEL_SIZE,
+                             0, i % 256, 255);
+        }
+    }
+}
+
+static bool checkCounts(const char* description, VoxelMesher& mesher, int expectedFaces, int expectedQuads,
+                        int& testsTaken, bool verbose) {
+    testsTaken++;
+    int numVertices = 0;
+    int numIndices = 0;
+    foreach (const VoxelChunkMesh& mesh, mesher.getChunkMeshes()) {
+        numVertices += mesh.vertices.size();
+        numIndices += mesh.indices.size();
+    }
+    bool passed = mesher.getNumFaces() == expectedFaces && mesher.getNumQuads() == expectedQuads &&
+        numVertices == expectedQuads * 4 && numIndices == expectedQuads * 6;
+    if (verbose) {
+        qDebug() << "Test" << testsTaken << ":" << description << "-" << mesher.getNumFaces() << "faces,"
+            << mesher.getNumQuads() << "quads";
+    }
+    if (!passed) {
+        qDebug() << "FAILED - Test" << testsTaken << ":" << description << "- faces=" << mesher.getNumFaces()
+            << "expected" << expectedFaces << "quads=" << mesher.getNumQuads() << "expected" << expectedQuads
+            << "vertices=" << numVertices << "indices=" << numIndices;
+    }
+    return passed;
+}
+
+// the same voxels, faces and rectangles in the same chunks
+static int countMismatchedChunks(const VoxelMesher& mesher, const VoxelMesher& reference) {
+    const QHash<VoxelKey, VoxelChunkMesh>& meshes = mesher.getChunkMeshes();
+    const QHash<VoxelKey, VoxelChunkMesh>& referenceMeshes = reference.getChunkMeshes();
+    int numMismatched = qAbs(meshes.size() - referenceMeshes.size());
+    for (QHash<VoxelKey, VoxelChunkMesh>::const_iterator it = referenceMeshes.constBegin();
+            it != referenceMeshes.constEnd(); it++) {
+        QHash<VoxelKey, VoxelChunkMesh>::const_iterator mesh = meshes.constFind(it.key());
+        if (mesh == meshes.constEnd() || mesh.value().numFaces != it.value().numFaces ||
+                mesh.value().indices.size() != it.value().indices.size()) {
+            numMismatched++;
+        }
+    }
+    return numMismatched;
+}
+
+void VoxelMesherTests::faceCullingTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "VoxelMesherTests::faceCullingTests()";
+
+    {
+        VoxelTree tree;
+        tree.createVoxel(VOXEL_SIZE, VOXEL_SIZE, VOXEL_SIZE, VOXEL_SIZE, 255, 0, 0);
+        VoxelMesher mesher(&tree, CHUNK_LEVEL);
+        mesher.update();
+        if (checkCounts("a single voxel", mesher, 6, 6, testsTaken, verbose)) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+        }
+
+        testsTaken++;
+        // the +x face sits on the far side of the voxel and faces away from it
+        bool passed = false;
+        foreach (const VoxelChunkMesh& mesh, mesher.getChunkMeshes()) {
+            for (int i = 0; i < mesh.indices.size(); i += 3) {
+                const VoxelMeshVertex& a = mesh.vertices.at(mesh.indices.at(i));
+                const VoxelMeshVertex& b = mesh.vertices.at(mesh.indices.at(i + 1));
+                const VoxelMeshVertex& c = mesh.vertices.at(mesh.indices.at(i + 2));
+                if (a.normal.x == 1.0f) {
+                    glm::vec3 winding = glm::cross(b.position - a.position, c.position - a.position);
+                    passed = a.position.x == 2.0f * VOXEL_SIZE && winding.x > 0.0f && a.color[0] == 255;
+                }
+            }
+        }
+        if (passed) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": +x face of a single voxel";
+        }
+    }
+
+    {
+        VoxelTree tree;
+        for (int x = 0; x < 4; x++) {
+            for (int y = 0; y < 4; y++) {
+                for (int z = 0; z < 4; z++) {
+                    tree.createVoxel(x * VOXEL_SIZE, y * VOXEL_SIZE, z * VOXEL_SIZE, VOXEL_SIZE, 0, 255, 0);
+                }
+            }
+        }
+        VoxelMesher mesher(&tree, CHUNK_LEVEL);
+        mesher.update();
+        if (checkCounts("a block of one color", mesher, 6 * 4 * 4, 6, testsTaken, verbose)) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+        }
+    }
+
+    {
+        // the voxels at 15 and 16 lie in different chunks
+        VoxelTree tree;
+        tree.createVoxel(15 * VOXEL_SIZE, 0.0f, 0.0f, VOXEL_SIZE, 255, 0, 0);
+        tree.createVoxel(16 * VOXEL_SIZE, 0.0f, 0.0f, VOXEL_SIZE, 0, 0, 255);
+        VoxelMesher mesher(&tree, CHUNK_LEVEL);
+        mesher.update();
+        if (checkCounts("neighbors across a chunk border", mesher, 10, 10, testsTaken, verbose) &&
+                mesher.getChunkMeshes().size() == 2) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+        }
+    }
+
+    {
+        // a small voxel against the side of a big one: the big one hides the small face, but not the other way around
+        VoxelTree tree;
+        tree.createVoxel(0.0f, 0.0f, 0.0f, 2.0f * VOXEL_SIZE, 255, 0, 0);
+        tree.createVoxel(2.0f * VOXEL_SIZE, 0.0f, 0.0f, VOXEL_SIZE, 255, 0, 0);
+        VoxelMesher mesher(&tree, CHUNK_LEVEL);
+        mesher.update();
+        if (checkCounts("a small voxel against a big one", mesher, 11, 11, testsTaken, verbose)) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void VoxelMesherTests::incrementalUpdateTests(bool verbose) {
+    int testsTaken = 0;
+    int testsPassed = 0;
+    int testsFailed = 0;
+
+    qDebug() << "VoxelMesherTests::incrementalUpdateTests()";
+
+    VoxelTree tree;
+    buildScene(tree);
+    VoxelMesher mesher(&tree, CHUNK_LEVEL);
+    mesher.update();
+
+    {
+        testsTaken++;
+        int numChunksMeshed = mesher.update();
+        if (numChunksMeshed == 0) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": update without edits meshed" << numChunksMeshed << "chunks";
+        }
+    }
+
+    for (int round = 0; round < 3; round++) {
+        editScene(tree, round * NUM_EDITS, NUM_EDITS);
+        int numChunksMeshed = mesher.update();
+
+        VoxelMesher reference(&tree, CHUNK_LEVEL);
+        reference.update();
+
+        testsTaken++;
+        int numMismatched = countMismatchedChunks(mesher, reference);
+        if (verbose) {
+            qDebug() << "Test" << testsTaken << ": round" << round << "remeshed" << numChunksMeshed << "chunks,"
+                << mesher.getNumVoxels() << "voxels," << mesher.getNumFaces() << "faces";
+        }
+        if (numMismatched == 0 && mesher.getNumVoxels() == reference.getNumVoxels() &&
+                mesher.getNumFaces() == reference.getNumFaces() && mesher.getNumQuads() == reference.getNumQuads()) {
+            testsPassed++;
+        } else {
+            testsFailed++;
+            qDebug() << "FAILED - Test" << testsTaken << ": round" << round << "differs from meshing from scratch in"
+                << numMismatched << "chunks, voxels=" << mesher.getNumVoxels() << "expected" << reference.getNumVoxels()
+                << "faces=" << mesher.getNumFaces() << "expected" << reference.getNumFaces();
+        }
+    }
+
+    qDebug() << "   tests passed:" << testsPassed << "out of" << testsTaken;
+    if (testsFailed > 0) {
+        qDebug() << "   tests failed:" << testsFailed << "out of" << testsTaken;
+    }
+}
+
+void VoxelMesherTests::meshBenchmark() {
+    qDebug() << "VoxelMesherTests::meshBenchmark()";
+
+    VoxelTree tree;
+    buildScene(tree);
+    VoxelMesher mesher(&tree, CHUNK_LEVEL);
+
+    quint64 start = usecTimestampNow();
+    int numChunks = mesher.update();
+    quint64 elapsed = usecTimestampNow() - start;
+    qDebug() << "TIME - full mesh" << mesher.getNumVoxels() << "voxels," << numChunks << "chunks"
+        << (float)elapsed / USECS_PER_MSEC << "msecs";
+    qDebug() << "      " << mesher.getNumFaces() << "visible faces of" << 6 * mesher.getNumVoxels() << ","
+        << mesher.getNumQuads() << "quads after merging";
+
+    editScene(tree, 0, NUM_EDITS);
+    start = usecTimestampNow();
+    numChunks = mesher.update();
+    elapsed = usecTimestampNow() - start;
+    qDebug() << "TIME -" << NUM_EDITS << "edits," << numChunks << "chunks remeshed" << (float)elapsed / USECS_PER_MSEC
+        << "msecs";
+}
+
+void VoxelMesherTests::runAllTests(bool verbose) {
+    faceCullingTests(verbose);
+    incrementalUpdateTests(verbose);
+    meshBenchmark();
+}
@@ -0,0 +1,26 @@
+//
+//  VoxelMesherTests.h
+//  tests/octree/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_VoxelMesherTests_h
+#define hifi_VoxelMesherTests_h
+
+namespace VoxelMesherTests {
+    void faceCullingTests(bool verbose = false);
+
+    /// edits a tree and compares the incrementally updated meshes against meshing the edited tree from scratch
+    void incrementalUpdateTests(bool verbose = false);
+
+    void meshBenchmark();
+
+    void runAllTests(bool verbose = false);
+}
+
+#endif // hifi_VoxelMesherTests_h
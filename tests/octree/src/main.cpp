@@ -8,13 +8,27 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "JurisdictionRoutingTests.h"
+#include "JurisdictionSplitTests.h"
 #include "ModelTests.h"
+#include "OctreePacketPipelineTests.h"
 #include "OctreeTests.h"
+#include "OctreeRayTests.h"
+#include "ParticleTests.h"
 #include "AABoxCubeTests.h"
+#include "ViewFrustumTests.h"
+#include "VoxelMesherTests.h"
 
 int main(int argc, char** argv) {
     OctreeTests::runAllTests();
     AABoxCubeTests::runAllTests();
     ModelTests::runAllTests(true);
+    ParticleTests::runAllTests(true);
+    OctreeRayTests::runAllTests(true);
+    JurisdictionRoutingTests::runAllTests(true);
+    JurisdictionSplitTests::runAllTests(true);
+    VoxelMesherTests::runAllTests(true);
+    OctreePacketPipelineTests::runAllTests(true);
+    ViewFrustumTests::runAllTests(true);
     return 0;
 }
@@ -0,0 +1,167 @@
+//
+//  PhysicsSimulationTests.cpp
+//  tests/physics/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+#include <math.h>
+
+#include <glm/glm.hpp>
+
+#include <CapsuleShape.h>
+#include <CollisionInfo.h>
+#include <PhysicsEntity.h>
+#include <PhysicsSimulation.h>
+#include <ShapeCollider.h>
+#include <SharedUtil.h>
+
+#include "PhysicsSimulationTests.h"
+
+const int SHAPES_PER_ENTITY = 16;
+const float BONE_RADIUS = 0.05f;
+const float BONE_LENGTH = 0.1f;
+const float ENTITY_SPACING = 1.0f;
+
+// a column of overlapping capsules standing in for an avatar's skeleton
+class ColumnEntity : public PhysicsEntity {
+public:
+    ColumnEntity(const glm::vec3& position) {
+        _translation = position;
+        setEnableShapes(true);
+    }
+
+    virtual ~ColumnEntity() {
+        clearShapes();
+    }
+
+    virtual void buildShapes() {
+        // sway the column a little so that neighbouring entities touch in different places
+        glm::vec3 sway(randFloatInRange(-BONE_RADIUS, BONE_RADIUS), 0.0f, randFloatInRange(-BONE_RADIUS, BONE_RADIUS));
+        glm::vec3 start = _translation;
+        for (int i = 0; i < SHAPES_PER_ENTITY; ++i) {
+            glm::vec3 end = start + glm::vec3(0.0f, BONE_LENGTH, 0.0f) + sway;
+            _shapes.push_back(new CapsuleShape(BONE_RADIUS, start, end));
+            start = end;
+        }
+        setShapeBackPointers();
+
+        // like an avatar, the bones that touch at rest don't collide with each other
+        disableCurrentSelfCollisions();
+    }
+};
+
+static void addEntities(PhysicsSimulation& simulation, QVector<PhysicsEntity*>& entities, int numEntities) {
+    // a square grid whose columns are close enough to bump into their neighbours
+    int side = (int)ceilf(sqrtf((float)numEntities));
+    for (int i = 0; i < numEntities; ++i) {
+        glm::vec3 position((float)(i % side) * ENTITY_SPACING, 0.0f, (float)(i / side) * ENTITY_SPACING);
+        position += glm::vec3(randFloatInRange(0.0f, ENTITY_SPACING), 0.0f, randFloatInRange(0.0f, ENTITY_SPACING));
+        PhysicsEntity* entity = new ColumnEntity(position);
+        simulation.addEntity(entity);
+        entities.push_back(entity);
+    }
+}
+
+static void deleteEntities(QVector<PhysicsEntity*>& entities) {
+    foreach (PhysicsEntity* entity, entities) {
+        delete entity;
+    }
+    entities.clear();
+}
+
+// what PhysicsSimulation::computeCollisions() did before it had a broadphase
+static int collideAllPairs(const QVector<PhysicsEntity*>& entities, CollisionList& collisions) {
+    collisions.clear();
+    int numEntities = entities.size();
+    for (int i = 0; i < numEntities; ++i) {
+        PhysicsEntity* entity = entities.at(i);
+        const QVector<Shape*> shapes = entity->getShapes();
+        int numShapes = shapes.size();
+        for (int j = 0; j < numShapes; ++j) {
+            for (int k = j + 1; k < numShapes; ++k) {
+                if (entity->collisionsAreEnabled(j, k)) {
+                    ShapeCollider::collideShapes(shapes.at(j), shapes.at(k), collisions);
+                }
+            }
+        }
+        for (int j = i + 1; j < numEntities; ++j) {
+            ShapeCollider::collideShapesWithShapes(shapes, entities.at(j)->getShapes(), collisions);
+        }
+    }
+    return collisions.size();
+}
+
+void PhysicsSimulationTests::findsSameCollisionsAsBruteForce() {
+    const int NUM_TRIALS = 10;
+    const int MAX_ENTITIES = 16;
+    CollisionList collisions(256);
+
+    for (int trial = 0; trial < NUM_TRIALS; ++trial) {
+        PhysicsSimulation simulation;
+        QVector<PhysicsEntity*> entities;
+        addEntities(simulation, entities, 2 + rand() % (MAX_ENTITIES - 1));
+
+        simulation.computeShapePairs();
+        simulation.computeCollisions();
+        int expectedCollisions = collideAllPairs(entities, collisions);
+        if (simulation.getNumCollisions() != expectedCollisions) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: trial " << trial << " found " << simulation.getNumCollisions()
+                << " collisions but brute force found " << expectedCollisions << std::endl;
+        }
+        if (collisions.isFull()) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: trial " << trial << " filled the collision list, so it compared truncated lists" << std::endl;
+        }
+        deleteEntities(entities);
+    }
+}
+
+void PhysicsSimulationTests::benchmarkEntityCount() {
+    // stepForward() computes the pairs once and then collides them on every relaxation iteration
+    const int NUM_STEPS = 10;
+    const int ITERATIONS_PER_STEP = 5;
+    const int ENTITY_COUNTS[] = { 8, 16, 32, 64 };
+    CollisionList collisions(256);
+
+    for (unsigned int n = 0; n < sizeof(ENTITY_COUNTS) / sizeof(ENTITY_COUNTS[0]); ++n) {
+        int numEntities = ENTITY_COUNTS[n];
+        PhysicsSimulation simulation;
+        QVector<PhysicsEntity*> entities;
+        addEntities(simulation, entities, numEntities);
+
+        quint64 start = usecTimestampNow();
+        for (int step = 0; step < NUM_STEPS; ++step) {
+            for (int i = 0; i < ITERATIONS_PER_STEP; ++i) {
+                collideAllPairs(entities, collisions);
+            }
+        }
+        quint64 bruteForceElapsed = usecTimestampNow() - start;
+
+        start = usecTimestampNow();
+        for (int step = 0; step < NUM_STEPS; ++step) {
+            simulation.computeShapePairs();
+            for (int i = 0; i < ITERATIONS_PER_STEP; ++i) {
+                simulation.computeCollisions();
+            }
+        }
+        quint64 broadphaseElapsed = usecTimestampNow() - start;
+
+        std::cout << "TIME - " << numEntities << " entities, " << numEntities * SHAPES_PER_ENTITY << " shapes, "
+            << simulation.getNumShapePairs() << " pairs: brute force "
+            << (float)bruteForceElapsed / NUM_STEPS << " usecs/step, broadphase "
+            << (float)broadphaseElapsed / NUM_STEPS << " usecs/step" << std::endl;
+        deleteEntities(entities);
+    }
+}
+
+void PhysicsSimulationTests::runAllTests() {
+    findsSameCollisionsAsBruteForce();
+    benchmarkEntityCount();
+}
@@ -0,0 +1,220 @@
+//
+//  RagdollBatchTests.cpp
+//  tests/physics/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+#include <math.h>
+
+#include <glm/glm.hpp>
+
+#include <Ragdoll.h>
+#include <RagdollBatch.h>
+#include <SharedUtil.h>
+
+#include "RagdollBatchTests.h"
+
+const int POINTS_PER_RAGDOLL = 40;
+const float BONE_LENGTH = 0.2f;
+const float PERTURBATION = 0.05f;
+const float MIN_ERROR = 0.0001f;
+const int MAX_ITERATIONS = 100;
+
+static glm::vec3 randomOffset(float size) {
+    return glm::vec3(randFloatInRange(-size, size), randFloatInRange(-size, size), randFloatInRange(-size, size));
+}
+
+// a random tree of bones, pinned at its root the way SkeletonModel builds its ragdoll
+class TreeRagdoll : public Ragdoll {
+public:
+    TreeRagdoll(int numPoints) : _parents() {
+        for (int i = 0; i < numPoints; ++i) {
+            _parents.push_back(i == 0 ? -1 : rand() % i);
+        }
+        initRagdollPoints();
+        buildRagdollConstraints();
+    }
+
+    virtual void stepRagdollForward(float deltaTime) { }
+
+    const QVector<int>& getParents() const { return _parents; }
+
+    /// Adds the same constraints to the batch.
+    int addToBatch(RagdollBatch& batch) const {
+        int ragdollIndex = batch.addRagdoll(_ragdollPoints);
+        for (int i = 0; i < _parents.size(); ++i) {
+            if (_parents.at(i) == -1) {
+                batch.addFixedConstraint(ragdollIndex, i, glm::vec3(0.0f));
+            } else {
+                batch.addDistanceConstraint(ragdollIndex, i, _parents.at(i));
+            }
+        }
+        return ragdollIndex;
+    }
+
+protected:
+    virtual void initRagdollPoints() {
+        clearRagdollConstraintsAndPoints();
+        _ragdollPoints.resize(_parents.size());
+        for (int i = 1; i < _parents.size(); ++i) {
+            glm::vec3 direction = glm::normalize(randomOffset(1.0f) + glm::vec3(0.0f, 0.1f, 0.0f));
+            _ragdollPoints[i]._position = _ragdollPoints[_parents.at(i)]._position + BONE_LENGTH * direction;
+        }
+    }
+
+    virtual void buildRagdollConstraints() {
+        for (int i = 0; i < _parents.size(); ++i) {
+            if (_parents.at(i) == -1) {
+                _ragdollConstraints.push_back(new FixedConstraint(&_ragdollPoints[i], glm::vec3(0.0f)));
+            } else {
+                _ragdollConstraints.push_back(new DistanceConstraint(&_ragdollPoints[i], &_ragdollPoints[_parents.at(i)]));
+            }
+        }
+    }
+
+private:
+    QVector<int> _parents;
+};
+
+static void perturb(QVector<VerletPoint>& points) {
+    for (int i = 0; i < points.size(); ++i) {
+        points[i]._position += randomOffset(PERTURBATION);
+    }
+}
+
+static float getMaxBoneError(const QVector<VerletPoint>& relaxed, const QVector<VerletPoint>& rest,
+        const QVector<int>& parents) {
+    float maxError = 0.0f;
+    for (int i = 0; i < parents.size(); ++i) {
+        if (parents.at(i) != -1) {
+            float length = glm::distance(relaxed.at(i)._position, relaxed.at(parents.at(i))._position);
+            float restLength = glm::distance(rest.at(i)._position, rest.at(parents.at(i))._position);
+            maxError = glm::max(maxError, fabsf(length - restLength));
+        }
+    }
+    return maxError;
+}
+
+void RagdollBatchTests::convergesLikeRagdoll() {
+    const int NUM_TRIALS = 10;
+    const float MAX_BONE_ERROR = 0.01f;
+
+    for (int trial = 0; trial < NUM_TRIALS; ++trial) {
+        TreeRagdoll ragdoll(POINTS_PER_RAGDOLL);
+        RagdollBatch batch;
+        int ragdollIndex = ragdoll.addToBatch(batch);
+        QVector<VerletPoint> rest = ragdoll.getRagdollPoints();
+
+        perturb(ragdoll.getRagdollPoints());
+        batch.setPoints(ragdollIndex, ragdoll.getRagdollPoints());
+
+        int ragdollIterations = 0;
+        float ragdollError = 0.0f;
+        do {
+            ragdollError = ragdoll.enforceRagdollConstraints();
+            ++ragdollIterations;
+        } while (ragdollError > MIN_ERROR && ragdollIterations < MAX_ITERATIONS);
+
+        int batchIterations = 0;
+        float batchError = 0.0f;
+        do {
+            batchError = batch.enforceConstraints();
+            ++batchIterations;
+        } while (batchError > MIN_ERROR && batchIterations < MAX_ITERATIONS);
+
+        if (batchError > MIN_ERROR && ragdollError <= MIN_ERROR) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: trial " << trial << " batch did not converge in "
+                << MAX_ITERATIONS << " iterations but Ragdoll did in " << ragdollIterations << std::endl;
+        }
+
+        QVector<VerletPoint> relaxed = rest;
+        batch.getPoints(ragdollIndex, relaxed);
+        float boneError = getMaxBoneError(relaxed, rest, ragdoll.getParents());
+        if (boneError > MAX_BONE_ERROR) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: trial " << trial
+                << " batch left a bone " << boneError << " away from its rest length" << std::endl;
+        }
+        if (trial == 0) {
+            std::cout << "iterations to converge - Ragdoll: " << ragdollIterations << ", RagdollBatch: "
+                << batchIterations << std::endl;
+        }
+    }
+}
+
+void RagdollBatchTests::benchmarkRagdollCount() {
+    const int NUM_FRAMES = 20;
+    const int RAGDOLL_COUNTS[] = { 16, 64, 256 };
+
+    for (unsigned int n = 0; n < sizeof(RAGDOLL_COUNTS) / sizeof(RAGDOLL_COUNTS[0]); ++n) {
+        int numRagdolls = RAGDOLL_COUNTS[n];
+        QVector<TreeRagdoll*> ragdolls;
+        QVector<QVector<VerletPoint> > perturbedPoints;
+        RagdollBatch batch;
+        for (int i = 0; i < numRagdolls; ++i) {
+            TreeRagdoll* ragdoll = new TreeRagdoll(POINTS_PER_RAGDOLL);
+            ragdoll->addToBatch(batch);
+            QVector<VerletPoint> points = ragdoll->getRagdollPoints();
+            perturb(points);
+            perturbedPoints.push_back(points);
+            ragdolls.push_back(ragdoll);
+        }
+
+        // every frame starts from the same perturbed points and, like PhysicsSimulation::stepForward(), passes over
+        // all the ragdolls until the largest error is small enough
+        int ragdollIterations = 0;
+        quint64 start = usecTimestampNow();
+        for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+            for (int i = 0; i < numRagdolls; ++i) {
+                QVector<VerletPoint>& points = ragdolls.at(i)->getRagdollPoints();
+                const QVector<VerletPoint>& perturbed = perturbedPoints.at(i);
+                for (int j = 0; j < points.size(); ++j) {
+                    points[j]._position = perturbed.at(j)._position;
+                }
+            }
+            float error = 0.0f;
+            int iterations = 0;
+            do {
+                error = 0.0f;
+                for (int i = 0; i < numRagdolls; ++i) {
+                    error = glm::max(error, ragdolls.at(i)->enforceRagdollConstraints());
+                }
+                ++iterations;
+            } while (error > MIN_ERROR && iterations < MAX_ITERATIONS);
+            ragdollIterations += iterations;
+        }
+        quint64 ragdollElapsed = usecTimestampNow() - start;
+
+        int batchIterations = 0;
+        start = usecTimestampNow();
+        for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+            for (int i = 0; i < numRagdolls; ++i) {
+                batch.setPoints(i, perturbedPoints.at(i));
+            }
+            batch.enforceAllConstraints(MIN_ERROR, MAX_ITERATIONS);
+            batchIterations += batch.getNumIterations();
+        }
+        quint64 batchElapsed = usecTimestampNow() - start;
+
+        std::cout << "TIME - " << numRagdolls << " ragdolls of " << POINTS_PER_RAGDOLL << " points: Ragdoll "
+            << (float)ragdollElapsed / NUM_FRAMES << " usecs/frame ("
+            << (float)ragdollIterations / NUM_FRAMES << " iterations), RagdollBatch "
+            << (float)batchElapsed / NUM_FRAMES << " usecs/frame ("
+            << (float)batchIterations / (NUM_FRAMES * batch.getNumGroups()) << " iterations per group of "
+            << numRagdolls / batch.getNumGroups() << ")" << std::endl;
+
+        foreach (TreeRagdoll* ragdoll, ragdolls) {
+            delete ragdoll;
+        }
+    }
+}
+
+void RagdollBatchTests::runAllTests() {
+    convergesLikeRagdoll();
+    benchmarkRagdollCount();
+}
@@ -0,0 +1,22 @@
+//
+//  RagdollBatchTests.h
+//  tests/physics/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_RagdollBatchTests_h
+#define hifi_RagdollBatchTests_h
+
+namespace RagdollBatchTests {
+    void convergesLikeRagdoll();
+    void benchmarkRagdollCount();
+
+    void runAllTests();
+}
+
+#endif // hifi_RagdollBatchTests_h
@@ -17,6 +17,7 @@
 #include <glm/gtx/quaternion.hpp>
 
 #include <CollisionInfo.h>
+#include <ShapeBatch.h>
 #include <ShapeCollider.h>
 #include <SharedUtil.h>
 #include <SphereShape.h>
@@ -1298,6 +1299,193 @@ void ShapeColliderTests::rayMissesPlane() {
     }
 }
 
+static glm::vec3 randomPoint(float size) {
+    return glm::vec3(randFloatInRange(0.0f, size), randFloatInRange(0.0f, size), randFloatInRange(0.0f, size));
+}
+
+const float NSECS_PER_USEC = 1000.0f;
+
+// a crowd of avatar sized shapes
+const float CROWD_SIZE = 10.0f;
+const float CROWD_SHAPE_RADIUS = 0.3f;
+
+static SphereShape* randomSphere() {
+    return new SphereShape(randFloatInRange(0.1f, CROWD_SHAPE_RADIUS), randomPoint(CROWD_SIZE));
+}
+
+static CapsuleShape* randomCapsule() {
+    glm::vec3 start = randomPoint(CROWD_SIZE);
+    glm::vec3 end = start + randomPoint(2.0f * CROWD_SHAPE_RADIUS) - glm::vec3(CROWD_SHAPE_RADIUS);
+    return new CapsuleShape(randFloatInRange(0.05f, CROWD_SHAPE_RADIUS), start, end);
+}
+
+static bool collisionsMatch(CollisionList& listA, CollisionList& listB) {
+    if (listA.size() != listB.size()) {
+        return false;
+    }
+    for (int i = 0; i < listA.size(); ++i) {
+        CollisionInfo* a = listA.getCollision(i);
+        CollisionInfo* b = listB.getCollision(i);
+        if (a->_shapeA != b->_shapeA || a->_shapeB != b->_shapeB || a->_penetration != b->_penetration ||
+                a->_contactPoint != b->_contactPoint) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ShapeColliderTests::batchesMatchPairFunctions() {
+    const int NUM_SHAPES = 300;
+    const int NUM_QUERIES = 100;
+    QVector<Shape*> shapes;
+    SphereBatch spheres;
+    CapsuleBatch capsules;
+    for (int i = 0; i < NUM_SHAPES; ++i) {
+        SphereShape* sphere = randomSphere();
+        spheres.addSphere(sphere);
+        shapes.push_back(sphere);
+        CapsuleShape* capsule = randomCapsule();
+        capsules.addCapsule(capsule);
+        shapes.push_back(capsule);
+    }
+
+    CollisionList batchCollisions(2 * NUM_SHAPES);
+    CollisionList pairCollisions(2 * NUM_SHAPES);
+    int numCollisions = 0;
+    for (int i = 0; i < NUM_QUERIES; ++i) {
+        Shape* shapeA = (i % 2) ? (Shape*)randomCapsule() : (Shape*)randomSphere();
+
+        batchCollisions.clear();
+        int numSphereCollisions = ShapeCollider::collideShapeWithSpheres(shapeA, spheres, batchCollisions);
+        int numCapsuleCollisions = ShapeCollider::collideShapeWithCapsules(shapeA, capsules, batchCollisions);
+
+        pairCollisions.clear();
+        for (int j = 0; j < spheres.size(); ++j) {
+            ShapeCollider::collideShapes(shapeA, spheres.getSphere(j), pairCollisions);
+        }
+        for (int j = 0; j < capsules.size(); ++j) {
+            ShapeCollider::collideShapes(shapeA, capsules.getCapsule(j), pairCollisions);
+        }
+
+        if (numSphereCollisions + numCapsuleCollisions != batchCollisions.size()) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batches reported " 
+                << numSphereCollisions + numCapsuleCollisions << " collisions but added "
+                << batchCollisions.size() << std::endl;
+        }
+        if (!collisionsMatch(batchCollisions, pairCollisions)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: query " << i << " found "
+                << batchCollisions.size() << " collisions with batches but " << pairCollisions.size()
+                << " pair by pair, or they differ" << std::endl;
+        }
+        numCollisions += batchCollisions.size();
+        delete shapeA;
+    }
+    if (numCollisions == 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR: the queries should have hit something" << std::endl;
+    }
+
+    foreach (Shape* shape, shapes) {
+        delete shape;
+    }
+}
+
+void ShapeColliderTests::benchmarkDispatch() {
+    const int NUM_SHAPES = 1000;
+    const int NUM_PASSES = 10;
+    QVector<Shape*> shapes;
+    for (int i = 0; i < NUM_SHAPES; ++i) {
+        if (i % 2) {
+            shapes.push_back(randomSphere());
+        } else {
+            shapes.push_back(randomCapsule());
+        }
+    }
+
+    // neighbours in the list make a mix of sphere-sphere, sphere-capsule, capsule-sphere and capsule-capsule pairs
+    CollisionList collisions(NUM_SHAPES);
+    int numPairs = 0;
+    quint64 start = usecTimestampNow();
+    for (int pass = 0; pass < NUM_PASSES; ++pass) {
+        for (int i = 0; i < NUM_SHAPES; ++i) {
+            for (int j = 1; j <= 4; ++j) {
+                if (collisions.isFull()) {
+                    collisions.clear();
+                }
+                ShapeCollider::collideShapes(shapes.at(i), shapes.at((i + j * (pass + 1)) % NUM_SHAPES), collisions);
+                ++numPairs;
+            }
+        }
+    }
+    quint64 elapsed = usecTimestampNow() - start;
+    std::cout << "TIME - collideShapes: " << (float)elapsed * NSECS_PER_USEC / numPairs << " nsecs/pair" << std::endl;
+
+    foreach (Shape* shape, shapes) {
+        delete shape;
+    }
+}
+
+void ShapeColliderTests::benchmarkBatches() {
+    const int NUM_QUERIES = 200;
+    const int BATCH_SIZES[] = { 16, 256, 4096 };
+
+    for (unsigned int n = 0; n < sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]); ++n) {
+        int batchSize = BATCH_SIZES[n];
+        QVector<Shape*> shapes;
+        SphereBatch spheres;
+        CapsuleBatch capsules;
+        for (int i = 0; i < batchSize; ++i) {
+            SphereShape* sphere = randomSphere();
+            spheres.addSphere(sphere);
+            shapes.push_back(sphere);
+            CapsuleShape* capsule = randomCapsule();
+            capsules.addCapsule(capsule);
+            shapes.push_back(capsule);
+        }
+        QVector<Shape*> queries;
+        for (int i = 0; i < NUM_QUERIES; ++i) {
+            queries.push_back((i % 2) ? (Shape*)randomCapsule() : (Shape*)randomSphere());
+        }
+        CollisionList collisions(2 * batchSize);
+
+        quint64 start = usecTimestampNow();
+        int pairCollisions = 0;
+        foreach (Shape* shapeA, queries) {
+            collisions.clear();
+            for (int i = 0; i < batchSize; ++i) {
+                ShapeCollider::collideShapes(shapeA, spheres.getSphere(i), collisions);
+                ShapeCollider::collideShapes(shapeA, capsules.getCapsule(i), collisions);
+            }
+            pairCollisions += collisions.size();
+        }
+        quint64 pairElapsed = usecTimestampNow() - start;
+
+        start = usecTimestampNow();
+        int batchCollisions = 0;
+        foreach (Shape* shapeA, queries) {
+            collisions.clear();
+            batchCollisions += ShapeCollider::collideShapeWithSpheres(shapeA, spheres, collisions);
+            batchCollisions += ShapeCollider::collideShapeWithCapsules(shapeA, capsules, collisions);
+        }
+        quint64 batchElapsed = usecTimestampNow() - start;
+
+        if (batchCollisions != pairCollisions) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR: batches found " << batchCollisions
+                << " collisions but pair by pair found " << pairCollisions << std::endl;
+        }
+        float numTests = (float)(2 * batchSize * NUM_QUERIES);
+        std::cout << "TIME - " << 2 * batchSize << " shapes: pair by pair "
+            << (float)pairElapsed * NSECS_PER_USEC / numTests << " nsecs/shape, batched "
+            << (float)batchElapsed * NSECS_PER_USEC / numTests << " nsecs/shape" << std::endl;
+
+        foreach (Shape* shape, shapes) {
+            delete shape;
+        }
+        foreach (Shape* shape, queries) {
+            delete shape;
+        }
+    }
+}
+
 void ShapeColliderTests::runAllTests() {
     sphereMissesSphere();
     sphereTouchesSphere();
@@ -1319,4 +1507,8 @@ void ShapeColliderTests::runAllTests() {
     rayMissesCapsule();
     rayHitsPlane();
     rayMissesPlane();
+
+    batchesMatchPairFunctions();
+    benchmarkDispatch();
+    benchmarkBatches();
 }
@@ -35,6 +35,10 @@ namespace ShapeColliderTests {
     void rayHitsPlane();
     void rayMissesPlane();
 
+    void batchesMatchPairFunctions();
+    void benchmarkDispatch();
+    void benchmarkBatches();
+
     void runAllTests(); 
 }
 
@@ -0,0 +1,183 @@
+//
+//  SweepAndPruneTests.cpp
+//  tests/physics/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#include <QSet>
+
+#include <CollisionInfo.h>
+#include <ShapeCollider.h>
+#include <SharedUtil.h>
+#include <SphereShape.h>
+#include <SweepAndPrune.h>
+
+#include "SweepAndPruneTests.h"
+
+const quint32 PARTICLE_GROUP = 1 << 0;
+const quint32 AVATAR_GROUP = 1 << 1;
+
+static glm::vec3 randomPosition(const glm::vec3& extents) {
+    return glm::vec3(randFloatInRange(0.0f, extents.x), randFloatInRange(0.0f, extents.y), randFloatInRange(0.0f, extents.z));
+}
+
+static bool boxesOverlap(const glm::vec3& centerA, float radiusA, const glm::vec3& centerB, float radiusB) {
+    glm::vec3 separation = glm::abs(centerA - centerB);
+    float totalRadius = radiusA + radiusB;
+    return separation.x <= totalRadius && separation.y <= totalRadius && separation.z <= totalRadius;
+}
+
+static QSet<QPair<int, int> > toSet(const QVector<SweepAndPrunePair>& pairs) {
+    QSet<QPair<int, int> > pairSet;
+    foreach (const SweepAndPrunePair& pair, pairs) {
+        pairSet.insert(qMakePair(pair.firstIndex, pair.secondIndex));
+    }
+    return pairSet;
+}
+
+void SweepAndPruneTests::findsSamePairsAsBruteForce() {
+    const int NUM_TRIALS = 20;
+    const int MAX_SPHERES = 500;
+    const glm::vec3 EXTENTS(10.0f, 3.0f, 20.0f);
+    SweepAndPrune broadphase;
+
+    for (int trial = 0; trial < NUM_TRIALS; trial++) {
+        int numSpheres = 2 + rand() % MAX_SPHERES;
+        QVector<glm::vec3> centers;
+        QVector<float> radii;
+
+        broadphase.clear();
+        for (int i = 0; i < numSpheres; i++) {
+            centers.push_back(randomPosition(EXTENTS));
+            radii.push_back(randFloatInRange(0.05f, 0.5f));
+            broadphase.addSphere(centers.at(i), radii.at(i));
+        }
+        const QVector<SweepAndPrunePair>& pairs = broadphase.findOverlappingPairs();
+
+        QSet<QPair<int, int> > expectedPairs;
+        for (int i = 0; i < numSpheres; i++) {
+            for (int j = i + 1; j < numSpheres; j++) {
+                if (boxesOverlap(centers.at(i), radii.at(i), centers.at(j), radii.at(j))) {
+                    expectedPairs.insert(qMakePair(i, j));
+                }
+            }
+        }
+
+        QSet<QPair<int, int> > foundPairs = toSet(pairs);
+        if (foundPairs.size() != pairs.size()) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: trial " << trial << " reported " << (pairs.size() - foundPairs.size())
+                << " duplicate pairs" << std::endl;
+        }
+        if (foundPairs != expectedPairs) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: trial " << trial << " found " << foundPairs.size() << " pairs but expected "
+                << expectedPairs.size() << std::endl;
+        }
+    }
+}
+
+void SweepAndPruneTests::respectsCollisionGroups() {
+    SweepAndPrune broadphase;
+
+    // everything overlaps everything
+    int particle = broadphase.addSphere(glm::vec3(0.0f), 1.0f, PARTICLE_GROUP, PARTICLE_GROUP | AVATAR_GROUP);
+    int particleInHand = broadphase.addSphere(glm::vec3(0.1f), 1.0f, PARTICLE_GROUP, PARTICLE_GROUP);
+    int avatarA = broadphase.addSphere(glm::vec3(0.2f), 1.0f, AVATAR_GROUP, PARTICLE_GROUP);
+    int avatarB = broadphase.addSphere(glm::vec3(0.3f), 1.0f, AVATAR_GROUP, PARTICLE_GROUP);
+
+    QSet<QPair<int, int> > expectedPairs;
+    expectedPairs.insert(qMakePair(particle, particleInHand));
+    expectedPairs.insert(qMakePair(particle, avatarA));
+    expectedPairs.insert(qMakePair(particle, avatarB));
+
+    QSet<QPair<int, int> > foundPairs = toSet(broadphase.findOverlappingPairs());
+    if (foundPairs != expectedPairs) {
+        std::cout << __FILE__ << ":" << __LINE__
+            << " ERROR: found " << foundPairs.size() << " pairs but expected the particle to pair with the other "
+            << "particle and both avatars, and nothing else" << std::endl;
+    }
+}
+
+// thousands of particles spread over a room with a few dozen avatars in it, the way ParticleCollisionSystem sees them
+void SweepAndPruneTests::benchmarkParticlesAndAvatars() {
+    const int NUM_FRAMES = 5;
+    const int NUM_AVATARS = 50;
+    const float PARTICLE_RADIUS = 0.1f;
+    const float AVATAR_RADIUS = 1.0f;
+    const glm::vec3 ROOM_EXTENTS(100.0f, 10.0f, 100.0f);
+    const int PARTICLE_COUNTS[] = { 500, 2000, 5000 };
+
+    for (unsigned int n = 0; n < sizeof(PARTICLE_COUNTS) / sizeof(PARTICLE_COUNTS[0]); n++) {
+        int numParticles = PARTICLE_COUNTS[n];
+        QVector<SphereShape> spheres;
+        for (int i = 0; i < numParticles; i++) {
+            spheres.push_back(SphereShape(PARTICLE_RADIUS, randomPosition(ROOM_EXTENTS)));
+        }
+        for (int i = 0; i < NUM_AVATARS; i++) {
+            spheres.push_back(SphereShape(AVATAR_RADIUS, randomPosition(ROOM_EXTENTS)));
+        }
+        CollisionList collisions(spheres.size());
+
+        // every particle against every other particle and every avatar
+        int bruteForceCollisions = 0;
+        quint64 start = usecTimestampNow();
+        for (int frame = 0; frame < NUM_FRAMES; frame++) {
+            for (int i = 0; i < numParticles; i++) {
+                for (int j = i + 1; j < spheres.size(); j++) {
+                    collisions.clear();
+                    if (ShapeCollider::sphereSphere(&spheres.at(i), &spheres.at(j), collisions)) {
+                        bruteForceCollisions++;
+                    }
+                }
+            }
+        }
+        quint64 bruteForceElapsed = usecTimestampNow() - start;
+
+        // the broadphase, rebuilt every frame, and the narrowphase on its pairs only
+        SweepAndPrune broadphase;
+        int broadphaseCollisions = 0;
+        start = usecTimestampNow();
+        for (int frame = 0; frame < NUM_FRAMES; frame++) {
+            broadphase.clear();
+            for (int i = 0; i < spheres.size(); i++) {
+                bool isAvatar = i >= numParticles;
+                broadphase.addSphere(spheres.at(i).getTranslation(), spheres.at(i).getRadius(),
+                                     isAvatar ? AVATAR_GROUP : PARTICLE_GROUP,
+                                     isAvatar ? PARTICLE_GROUP : (PARTICLE_GROUP | AVATAR_GROUP));
+            }
+            const QVector<SweepAndPrunePair>& pairs = broadphase.findOverlappingPairs();
+            foreach (const SweepAndPrunePair& pair, pairs) {
+                collisions.clear();
+                if (ShapeCollider::sphereSphere(&spheres.at(pair.firstIndex), &spheres.at(pair.secondIndex), collisions)) {
+                    broadphaseCollisions++;
+                }
+            }
+        }
+        quint64 broadphaseElapsed = usecTimestampNow() - start;
+
+        if (broadphaseCollisions != bruteForceCollisions) {
+            std::cout << __FILE__ << ":" << __LINE__
+                << " ERROR: the broadphase found " << broadphaseCollisions << " collisions but brute force found "
+                << bruteForceCollisions << std::endl;
+        }
+        std::cout << "TIME - " << numParticles << " particles, " << NUM_AVATARS << " avatars: brute force "
+            << (float)bruteForceElapsed / (NUM_FRAMES * USECS_PER_MSEC) << " msecs/frame, sweep and prune "
+            << (float)broadphaseElapsed / (NUM_FRAMES * USECS_PER_MSEC) << " msecs/frame" << std::endl;
+    }
+}
+
+void SweepAndPruneTests::runAllTests() {
+    findsSamePairsAsBruteForce();
+    respectsCollisionGroups();
+    benchmarkParticlesAndAvatars();
+}
@@ -0,0 +1,23 @@
+//
+//  SweepAndPruneTests.h
+//  tests/physics/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SweepAndPruneTests_h
+#define hifi_SweepAndPruneTests_h
+
+namespace SweepAndPruneTests {
+    void findsSamePairsAsBruteForce();
+    void respectsCollisionGroups();
+    void benchmarkParticlesAndAvatars();
+
+    void runAllTests();
+}
+
+#endif // hifi_SweepAndPruneTests_h
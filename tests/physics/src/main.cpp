@@ -8,11 +8,17 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include "PhysicsSimulationTests.h"
+#include "RagdollBatchTests.h"
 #include "ShapeColliderTests.h"
+#include "SweepAndPruneTests.h"
 #include "VerletShapeTests.h"
 
 int main(int argc, char** argv) {
     ShapeColliderTests::runAllTests();
     VerletShapeTests::runAllTests();
+    SweepAndPruneTests::runAllTests();
+    PhysicsSimulationTests::runAllTests();
+    RagdollBatchTests::runAllTests();
     return 0;
 }
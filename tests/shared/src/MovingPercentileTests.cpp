@@ -164,6 +164,74 @@ void MovingPercentileTests::runAllTests() {
                 qDebug() << "\t\t PASS";
             }
         }
+
+
+        {
+            bool fail = false;
+
+            qDebug() << "\t testing running 80th percentile...";
+
+            lastNSamples.clear();
+            MovingPercentile moving80th(N, 0.8f);
+
+            for (int s = 0; s < 10000; s++) {
+
+                // few distinct values, so there are plenty of ties
+                float sample = (float)(rand() % 10);
+
+                lastNSamples.push_back(sample);
+                if (lastNSamples.size() > N) {
+                    lastNSamples.pop_front();
+                }
+
+                moving80th.updatePercentile(sample);
+
+                float experiment80th = moving80th.getValueAtPercentile();
+
+                QVector<float> sortedSamples = lastNSamples.toVector();
+                qSort(sortedSamples);
+                float actual80th = sortedSamples.at((int)(0.8f * (float)(sortedSamples.size() - 1) + 0.5f));
+
+                if (experiment80th != actual80th) {
+                    qDebug() << "\t\t FAIL at sample" << s;
+                    fail = true;
+                    break;
+                }
+            }
+            if (!fail) {
+                qDebug() << "\t\t PASS";
+            }
+        }
+    }
+
+    runBenchmark();
+}
+
+void MovingPercentileTests::runBenchmark() {
+    const int NUM_UPDATES = 1000000;
+
+    QVector<float> samples(NUM_UPDATES);
+    for (int i = 0; i < NUM_UPDATES; i++) {
+        samples[i] = random();
+    }
+
+    QVector<int> valuesForN;
+    valuesForN.append(30);      // what Node uses for clock skew
+    valuesForN.append(1000);
+    valuesForN.append(100000);
+
+    for (int i = 0; i < valuesForN.size(); i++) {
+        int N = valuesForN.at(i);
+        MovingPercentile movingPercentile(N, 0.8f);
+
+        quint64 start = usecTimestampNow();
+        for (int s = 0; s < NUM_UPDATES; s++) {
+            movingPercentile.updatePercentile(samples.at(s));
+        }
+        quint64 elapsed = usecTimestampNow() - start;
+
+        qDebug() << "TIME - updatePercentile() with N =" << N << ":" << NUM_UPDATES << "updates"
+            << (float)elapsed / USECS_PER_MSEC << "msecs," << (float)elapsed / NUM_UPDATES << "usecs/update";
     }
 }
 
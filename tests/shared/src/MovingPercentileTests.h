@@ -17,6 +17,8 @@ namespace MovingPercentileTests {
     float random();
 
     void runAllTests(); 
+
+    void runBenchmark();
 }
 
 #endif // hifi_MovingPercentileTests_h
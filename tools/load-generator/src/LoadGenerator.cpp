@@ -0,0 +1,231 @@
+//
+//  LoadGenerator.cpp
+//  tools/load-generator/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QtCore/QDebug>
+
+#include <DomainHandler.h>
+#include <OctreeConstants.h>
+#include <SharedUtil.h>
+
+#include "LoadGenerator.h"
+
+const int DEFAULT_NUM_CLIENTS = 10;
+const int DEFAULT_REPORT_INTERVAL_SECONDS = 5;
+const int DEFAULT_OCTREE_QUERIES_PER_SECOND = 30;
+
+// interface sends its avatar data once per frame
+const quint64 AVATAR_DATA_SEND_INTERVAL_USECS = USECS_PER_SECOND / 60;
+
+// how often the send timer wakes up to see which frames are due, well under the audio frame interval
+const int SEND_TIMER_INTERVAL_MSECS = 2;
+
+// if we fall further behind than this we skip frames instead of sending a burst to catch up
+const quint64 MAX_SEND_CATCH_UP_USECS = USECS_PER_SECOND / 4;
+
+static const char* optionValue(int argc, char** argv, const char* option) {
+    return getCmdOption(argc, (const char**) argv, option);
+}
+
+static bool optionExists(int argc, char** argv, const char* option) {
+    return cmdOptionExists(argc, (const char**) argv, option);
+}
+
+static void printPercentiles(const char* label, const SampleSet& samples) {
+    if (samples.size() > 0) {
+        printf("  %-26s p50 %8.2f  p95 %8.2f  p99 %8.2f  (%d samples)\n", label,
+               samples.getPercentile(0.50f), samples.getPercentile(0.95f), samples.getPercentile(0.99f), samples.size());
+    }
+}
+
+LoadGenerator::LoadGenerator(int& argc, char** argv) :
+    QCoreApplication(argc, argv),
+    _clients(),
+    _sendsAudio(!optionExists(argc, argv, "--no-audio")),
+    _sendsAvatarData(!optionExists(argc, argv, "--no-avatars")),
+    _sendsOctreeQueries(!optionExists(argc, argv, "--no-octree")),
+    _clock(),
+    _octreeQueryIntervalUsecs(USECS_PER_SECOND / DEFAULT_OCTREE_QUERIES_PER_SECOND),
+    _nextAudioFrameUsecs(0),
+    _nextAvatarFrameUsecs(0),
+    _nextOctreeQueryUsecs(0),
+    _sendTimer(this),
+    _checkInTimer(this),
+    _reportTimer(this),
+    _reportClock()
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    // the packet header helpers fall back to the node list's session UUID, which has to exist even though
+    // every simulated client talks through its own socket
+    LimitedNodeList::createInstance();
+
+    const char* domainHostname = optionValue(argc, argv, "--domain");
+    HifiSockAddr domainSockAddr(domainHostname ? domainHostname : "localhost", DEFAULT_DOMAIN_SERVER_PORT);
+
+    const char* numClientsOption = optionValue(argc, argv, "--clients");
+    int numClients = numClientsOption ? atoi(numClientsOption) : DEFAULT_NUM_CLIENTS;
+
+    const char* queryRateOption = optionValue(argc, argv, "--query-rate");
+    if (queryRateOption && atoi(queryRateOption) > 0) {
+        _octreeQueryIntervalUsecs = USECS_PER_SECOND / atoi(queryRateOption);
+    }
+
+    const char* octreePPSOption = optionValue(argc, argv, "--octree-pps");
+    int maxOctreePPS = octreePPSOption ? atoi(octreePPSOption) : DEFAULT_MAX_OCTREE_PPS;
+
+    NodeSet nodeTypesOfInterest;
+    if (_sendsAudio) {
+        nodeTypesOfInterest << NodeType::AudioMixer;
+    }
+    if (_sendsAvatarData) {
+        nodeTypesOfInterest << NodeType::AvatarMixer;
+    }
+    if (_sendsOctreeQueries) {
+        nodeTypesOfInterest << NodeType::VoxelServer << NodeType::ParticleServer << NodeType::ModelServer;
+    }
+
+    qDebug() << "Simulating" << numClients << "clients against the domain at" << domainSockAddr;
+
+    for (int i = 0; i < numClients; i++) {
+        SimulatedClient* client = new SimulatedClient(i, domainSockAddr, nodeTypesOfInterest, this);
+        client->setMaxOctreePacketsPerSecond(maxOctreePPS);
+        _clients.append(client);
+    }
+
+    _clock.start();
+    _reportClock.start();
+
+    _sendTimer.setTimerType(Qt::PreciseTimer);
+    connect(&_sendTimer, &QTimer::timeout, this, &LoadGenerator::sendFrames);
+    _sendTimer.start(SEND_TIMER_INTERVAL_MSECS);
+
+    connect(&_checkInTimer, &QTimer::timeout, this, &LoadGenerator::checkIn);
+    _checkInTimer.start(DOMAIN_SERVER_CHECK_IN_MSECS);
+    checkIn();
+
+    const char* reportIntervalOption = optionValue(argc, argv, "--report");
+    int reportIntervalSeconds = reportIntervalOption ? atoi(reportIntervalOption) : DEFAULT_REPORT_INTERVAL_SECONDS;
+    connect(&_reportTimer, &QTimer::timeout, this, &LoadGenerator::printReport);
+    _reportTimer.start(qMax(reportIntervalSeconds, 1) * MSECS_PER_SECOND);
+
+    const char* durationOption = optionValue(argc, argv, "--duration");
+    if (durationOption && atoi(durationOption) > 0) {
+        // print what we have for the last partial interval on the way out
+        QTimer::singleShot(atoi(durationOption) * MSECS_PER_SECOND, this, SLOT(printReport()));
+        QTimer::singleShot(atoi(durationOption) * MSECS_PER_SECOND, this, SLOT(quit()));
+    }
+}
+
+void LoadGenerator::sendFrames() {
+    quint64 now = _clock.nsecsElapsed() / 1000;
+
+    if (now > _nextAudioFrameUsecs + MAX_SEND_CATCH_UP_USECS) {
+        _nextAudioFrameUsecs = now;
+    }
+    if (now > _nextAvatarFrameUsecs + MAX_SEND_CATCH_UP_USECS) {
+        _nextAvatarFrameUsecs = now;
+    }
+    if (now > _nextOctreeQueryUsecs + MAX_SEND_CATCH_UP_USECS) {
+        _nextOctreeQueryUsecs = now;
+    }
+
+    float seconds = now / (float) USECS_PER_SECOND;
+    foreach (SimulatedClient* client, _clients) {
+        client->updatePose(seconds);
+    }
+
+    // send every frame that has come due, so the rates hold even when the timer fires late
+    while (_sendsAudio && _nextAudioFrameUsecs <= now) {
+        foreach (SimulatedClient* client, _clients) {
+            client->sendAudioFrame();
+        }
+        _nextAudioFrameUsecs += BUFFER_SEND_INTERVAL_USECS;
+    }
+
+    while (_sendsAvatarData && _nextAvatarFrameUsecs <= now) {
+        foreach (SimulatedClient* client, _clients) {
+            client->sendAvatarData();
+        }
+        _nextAvatarFrameUsecs += AVATAR_DATA_SEND_INTERVAL_USECS;
+    }
+
+    while (_sendsOctreeQueries && _nextOctreeQueryUsecs <= now) {
+        foreach (SimulatedClient* client, _clients) {
+            client->sendOctreeQueries();
+        }
+        _nextOctreeQueryUsecs += _octreeQueryIntervalUsecs;
+    }
+}
+
+void LoadGenerator::checkIn() {
+    foreach (SimulatedClient* client, _clients) {
+        client->checkInWithDomain();
+        client->pingNodes();
+    }
+}
+
+void LoadGenerator::printReport() {
+    float intervalSeconds = _reportClock.restart() / (float) MSECS_PER_SECOND;
+    if (intervalSeconds <= 0.0f) {
+        return;
+    }
+
+    int numConnected = 0;
+    ClientStats totals;
+    QHash<NodeType_t, SampleSet> pingMsecs;
+
+    foreach (SimulatedClient* client, _clients) {
+        if (client->isConnected()) {
+            numConnected++;
+        }
+
+        ClientStats& stats = client->getStats();
+        totals.numMixedAudioPackets += stats.numMixedAudioPackets;
+        totals.numBulkAvatarPackets += stats.numBulkAvatarPackets;
+        totals.numOctreeDataPackets += stats.numOctreeDataPackets;
+        totals.numOctreeStatsPackets += stats.numOctreeStatsPackets;
+        totals.numOtherPackets += stats.numOtherPackets;
+        totals.mixedAudioGapMsecs.addSamples(stats.mixedAudioGapMsecs);
+        totals.octreeLatencyMsecs.addSamples(stats.octreeLatencyMsecs);
+
+        QHash<NodeType_t, SampleSet>::const_iterator ping = stats.pingMsecs.constBegin();
+        for (; ping != stats.pingMsecs.constEnd(); ping++) {
+            pingMsecs[ping.key()].addSamples(ping.value());
+        }
+
+        stats.reset();
+    }
+
+    printf("[%8.1fs] %d of %d clients connected\n", _clock.elapsed() / (float) MSECS_PER_SECOND,
+           numConnected, _clients.size());
+    printf("  received packets/sec: mixed audio %.1f, bulk avatar %.1f, octree data %.1f, octree stats %.1f, other %.1f\n",
+           totals.numMixedAudioPackets / intervalSeconds, totals.numBulkAvatarPackets / intervalSeconds,
+           totals.numOctreeDataPackets / intervalSeconds, totals.numOctreeStatsPackets / intervalSeconds,
+           totals.numOtherPackets / intervalSeconds);
+
+    if (totals.mixedAudioGapMsecs.size() > 0) {
+        printf("  mixed audio arrival: mean gap %.2f ms (expected %.2f), jitter %.2f ms\n",
+               totals.mixedAudioGapMsecs.getAverage(), BUFFER_SEND_INTERVAL_USECS / (float) USECS_PER_MSEC,
+               totals.mixedAudioGapMsecs.getStandardDeviation());
+        printPercentiles("mixed audio gap ms", totals.mixedAudioGapMsecs);
+    }
+
+    QHash<NodeType_t, SampleSet>::const_iterator ping = pingMsecs.constBegin();
+    for (; ping != pingMsecs.constEnd(); ping++) {
+        QByteArray label = (NodeType::getNodeTypeName(ping.key()) + " ping ms").toLocal8Bit();
+        printPercentiles(label.constData(), ping.value());
+    }
+
+    printPercentiles("octree latency ms", totals.octreeLatencyMsecs);
+}
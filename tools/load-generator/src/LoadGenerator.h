@@ -0,0 +1,51 @@
+//
+//  LoadGenerator.h
+//  tools/load-generator/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LoadGenerator_h
+#define hifi_LoadGenerator_h
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+#include <QtCore/QTimer>
+
+#include "SimulatedClient.h"
+
+/// Runs a number of simulated clients against a domain, paces what they send and prints what they get back.
+class LoadGenerator : public QCoreApplication {
+    Q_OBJECT
+public:
+    LoadGenerator(int& argc, char** argv);
+
+private slots:
+    void sendFrames();
+    void checkIn();
+    void printReport();
+
+private:
+    QList<SimulatedClient*> _clients;
+    bool _sendsAudio;
+    bool _sendsAvatarData;
+    bool _sendsOctreeQueries;
+
+    QElapsedTimer _clock;
+    quint64 _octreeQueryIntervalUsecs;
+    quint64 _nextAudioFrameUsecs;
+    quint64 _nextAvatarFrameUsecs;
+    quint64 _nextOctreeQueryUsecs;
+
+    QTimer _sendTimer;
+    QTimer _checkInTimer;
+    QTimer _reportTimer;
+    QElapsedTimer _reportClock;
+};
+
+#endif // hifi_LoadGenerator_h
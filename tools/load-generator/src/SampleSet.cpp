@@ -0,0 +1,52 @@
+//
+//  SampleSet.cpp
+//  tools/load-generator/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "SampleSet.h"
+
+float SampleSet::getAverage() const {
+    if (_samples.isEmpty()) {
+        return 0.0f;
+    }
+
+    double sum = 0.0;
+    foreach (float sample, _samples) {
+        sum += sample;
+    }
+    return sum / _samples.size();
+}
+
+float SampleSet::getStandardDeviation() const {
+    if (_samples.size() < 2) {
+        return 0.0f;
+    }
+
+    float average = getAverage();
+    double sumOfSquares = 0.0;
+    foreach (float sample, _samples) {
+        sumOfSquares += (sample - average) * (sample - average);
+    }
+    return sqrt(sumOfSquares / (_samples.size() - 1));
+}
+
+float SampleSet::getPercentile(float percentile) const {
+    if (_samples.isEmpty()) {
+        return 0.0f;
+    }
+
+    // only the order up to the requested rank matters
+    QVector<float> samples = _samples;
+    int rank = qBound(0, (int) (percentile * (samples.size() - 1) + 0.5f), samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
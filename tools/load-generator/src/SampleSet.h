@@ -0,0 +1,36 @@
+//
+//  SampleSet.h
+//  tools/load-generator/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SampleSet_h
+#define hifi_SampleSet_h
+
+#include <QtCore/QVector>
+
+/// Every sample of one measurement over a report interval, for averages, deviations and percentiles.
+class SampleSet {
+public:
+    void addSample(float sample) { _samples.append(sample); }
+    void addSamples(const SampleSet& otherSet) { _samples += otherSet._samples; }
+    void clear() { _samples.resize(0); }
+
+    int size() const { return _samples.size(); }
+
+    float getAverage() const;
+    float getStandardDeviation() const;
+
+    /// the value below which the given fraction (0 to 1) of the samples fall
+    float getPercentile(float percentile) const;
+
+private:
+    QVector<float> _samples;
+};
+
+#endif // hifi_SampleSet_h
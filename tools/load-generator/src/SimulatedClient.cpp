@@ -0,0 +1,425 @@
+//
+//  SimulatedClient.cpp
+//  tools/load-generator/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include <cmath>
+
+#include <QtCore/QDataStream>
+
+#include <OctreePacketData.h>
+#include <SharedUtil.h>
+#include <ViewFrustum.h>
+
+#include "SimulatedClient.h"
+
+// the avatars walk in circles laid out on a grid, so they're spread out but still within earshot of each other
+const glm::vec3 FIRST_WALK_CENTER = glm::vec3(10.0f, 1.0f, 10.0f);
+const int WALK_CIRCLES_PER_ROW = 10;
+const float WALK_CIRCLE_SPACING = 5.0f;
+const float WALK_RADIUS = 2.0f;
+const float WALK_RADIANS_PER_SECOND = 0.5f;
+
+const float EYE_HEIGHT = 0.6f;
+const float LOOK_AROUND_RADIANS = 0.8f;
+const float LOOK_AROUND_RADIANS_PER_SECOND = 1.3f;
+
+// a tone loud enough that the mixer never skips the stream for being inaudible
+const float TONE_BASE_FREQUENCY = 220.0f;
+const float TONE_FREQUENCY_STEP = 10.0f;
+const float TONE_AMPLITUDE = 8000.0f;
+
+ClientStats::ClientStats() :
+    numMixedAudioPackets(0),
+    numBulkAvatarPackets(0),
+    numOctreeDataPackets(0),
+    numOctreeStatsPackets(0),
+    numOtherPackets(0),
+    mixedAudioGapMsecs(),
+    pingMsecs(),
+    octreeLatencyMsecs()
+{
+
+}
+
+void ClientStats::reset() {
+    numMixedAudioPackets = 0;
+    numBulkAvatarPackets = 0;
+    numOctreeDataPackets = 0;
+    numOctreeStatsPackets = 0;
+    numOtherPackets = 0;
+    mixedAudioGapMsecs.clear();
+    pingMsecs.clear();
+    octreeLatencyMsecs.clear();
+}
+
+SimulatedClient::SimulatedClient(int clientIndex, const HifiSockAddr& domainSockAddr, const NodeSet& nodeTypesOfInterest,
+                                 QObject* parent) :
+    QObject(parent),
+    _socket(this),
+    _domainSockAddr(domainSockAddr),
+    _nodeTypesOfInterest(nodeTypesOfInterest),
+    _numNoReplyDomainCheckIns(0),
+    _sessionUUID(),
+    _domainListVersion(NO_DOMAIN_LIST_VERSION),
+    _pendingDomainListVersion(NO_DOMAIN_LIST_VERSION),
+    _pendingDomainListType(DomainListType::Full),
+    _receivedDomainListPackets(),
+    _nodes(),
+    _audioSequenceNumber(0),
+    _walkCenter(FIRST_WALK_CENTER + WALK_CIRCLE_SPACING * glm::vec3(clientIndex % WALK_CIRCLES_PER_ROW, 0.0f,
+                                                                     clientIndex / WALK_CIRCLES_PER_ROW)),
+    _walkPhase(clientIndex * 0.7f),
+    _headPosition(),
+    _headOrientation(),
+    _avatar(),
+    _octreeQuery(),
+    _lastMixedAudioUsecs(0),
+    _stats()
+{
+    _socket.bind(QHostAddress::AnyIPv4, 0);
+    connect(&_socket, &QUdpSocket::readyRead, this, &SimulatedClient::readPendingDatagrams);
+
+    // every client hums its own note
+    float radiansPerSample = 2.0f * PI * (TONE_BASE_FREQUENCY + clientIndex * TONE_FREQUENCY_STEP) / SAMPLE_RATE;
+    for (int i = 0; i < NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL; i++) {
+        _audioSamples[i] = TONE_AMPLITUDE * sinf(i * radiansPerSample);
+    }
+
+    _octreeQuery.setWantLowResMoving(true);
+    _octreeQuery.setWantColor(true);
+    _octreeQuery.setWantDelta(true);
+    _octreeQuery.setWantOcclusionCulling(false);
+    _octreeQuery.setWantCompression(true);
+    _octreeQuery.setCameraFov(DEFAULT_FIELD_OF_VIEW_DEGREES);
+    _octreeQuery.setCameraAspectRatio(DEFAULT_ASPECT_RATIO);
+    _octreeQuery.setCameraNearClip(DEFAULT_NEAR_CLIP);
+    _octreeQuery.setCameraFarClip(DEFAULT_FAR_CLIP);
+    _octreeQuery.setMaxOctreePacketsPerSecond(DEFAULT_MAX_OCTREE_PPS);
+
+    updatePose(0.0f);
+}
+
+void SimulatedClient::updatePose(float seconds) {
+    float walkAngle = _walkPhase + seconds * WALK_RADIANS_PER_SECOND;
+    glm::vec3 position = _walkCenter + WALK_RADIUS * glm::vec3(cosf(walkAngle), 0.0f, sinf(walkAngle));
+
+    // face along the circle, and look from side to side while walking
+    float bodyYaw = -walkAngle;
+    float headYaw = bodyYaw + LOOK_AROUND_RADIANS * sinf(_walkPhase + seconds * LOOK_AROUND_RADIANS_PER_SECOND);
+
+    _avatar.setPosition(position);
+    _avatar.setBodyYaw(glm::degrees(bodyYaw));
+
+    _headPosition = position + glm::vec3(0.0f, EYE_HEIGHT, 0.0f);
+    _headOrientation = glm::quat(glm::vec3(0.0f, headYaw, 0.0f));
+
+    _octreeQuery.setCameraPosition(_headPosition);
+    _octreeQuery.setCameraOrientation(_headOrientation);
+}
+
+void SimulatedClient::checkInWithDomain() {
+    if (_numNoReplyDomainCheckIns >= MAX_SILENT_DOMAIN_SERVER_CHECK_INS) {
+        // the domain-server has forgotten us (or restarted), start over with a new session
+        _sessionUUID = QUuid();
+        _domainListVersion = NO_DOMAIN_LIST_VERSION;
+        _pendingDomainListVersion = NO_DOMAIN_LIST_VERSION;
+        _receivedDomainListPackets.clear();
+        _nodes.clear();
+        _numNoReplyDomainCheckIns = 0;
+    }
+
+    PacketType packetType = isConnected() ? PacketTypeDomainListRequest : PacketTypeDomainConnectRequest;
+    QByteArray packet = byteArrayWithPopulatedHeader(packetType, _sessionUUID);
+    QDataStream packetStream(&packet, QIODevice::Append);
+
+    // we have no public address of our own, so the domain-server hands out its own address for us
+    packetStream << NodeType::Agent << HifiSockAddr(QHostAddress(), _socket.localPort())
+        << HifiSockAddr(QHostAddress(getHostOrderLocalAddress()), _socket.localPort())
+        << (quint8) _nodeTypesOfInterest.size();
+
+    foreach (NodeType_t nodeTypeOfInterest, _nodeTypesOfInterest) {
+        packetStream << nodeTypeOfInterest;
+    }
+
+    packetStream << _domainListVersion;
+
+    _socket.writeDatagram(packet, _domainSockAddr.getAddress(), _domainSockAddr.getPort());
+    _numNoReplyDomainCheckIns++;
+}
+
+void SimulatedClient::pingNodes() {
+    foreach (const SimulatedNode& node, _nodes) {
+        if (node.activeSocket.isNull()) {
+            // punch through to whichever of its sockets answers first
+            sendPing(node, PingType::Local, node.localSocket);
+            sendPing(node, PingType::Public, node.publicSocket);
+        } else {
+            // an active node gets pinged too, for its round trip time
+            sendPing(node, PingType::Agnostic, node.activeSocket);
+        }
+    }
+}
+
+void SimulatedClient::sendAudioFrame() {
+    foreach (const SimulatedNode& node, _nodes) {
+        if (node.type != NodeType::AudioMixer || node.activeSocket.isNull()) {
+            continue;
+        }
+
+        QByteArray packet = byteArrayWithPopulatedHeader(PacketTypeMicrophoneAudioNoEcho, _sessionUUID);
+        packet.append(reinterpret_cast<const char*>(&_audioSequenceNumber), sizeof(quint16));
+
+        quint8 isStereo = 0;
+        packet.append(reinterpret_cast<const char*>(&isStereo), sizeof(isStereo));
+        packet.append(reinterpret_cast<const char*>(&_headPosition), sizeof(_headPosition));
+        packet.append(reinterpret_cast<const char*>(&_headOrientation), sizeof(_headOrientation));
+
+        // encode the frame the way interface does, so the mixer mixes for us with the same codec
+        const AudioCodec* codec = AudioCodec::getCodec(AudioCodecType::ADPCM);
+        AudioCodec_t codecType = codec->getType();
+        packet.append(reinterpret_cast<const char*>(&codecType), sizeof(codecType));
+
+        int numPreAudioBytes = packet.size();
+        packet.resize(numPreAudioBytes + codec->getMaxEncodedSize(NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL, 1));
+        int numEncodedBytes = codec->encode(_audioSamples, NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL, 1,
+                                            packet.data() + numPreAudioBytes);
+        packet.resize(numPreAudioBytes + numEncodedBytes);
+
+        writeDatagram(packet, node.activeSocket, node.connectionSecret);
+        _audioSequenceNumber++;
+    }
+}
+
+void SimulatedClient::sendAvatarData() {
+    foreach (const SimulatedNode& node, _nodes) {
+        if (node.type != NodeType::AvatarMixer || node.activeSocket.isNull()) {
+            continue;
+        }
+
+        QByteArray packet = byteArrayWithPopulatedHeader(PacketTypeAvatarData, _sessionUUID);
+        packet.append(_avatar.toByteArray());
+
+        writeDatagram(packet, node.activeSocket, node.connectionSecret);
+    }
+}
+
+void SimulatedClient::sendOctreeQueries() {
+    foreach (const SimulatedNode& node, _nodes) {
+        if (node.activeSocket.isNull()) {
+            continue;
+        }
+
+        PacketType queryType;
+        if (node.type == NodeType::VoxelServer) {
+            queryType = PacketTypeVoxelQuery;
+        } else if (node.type == NodeType::ParticleServer) {
+            queryType = PacketTypeParticleQuery;
+        } else if (node.type == NodeType::ModelServer) {
+            queryType = PacketTypeModelQuery;
+        } else {
+            continue;
+        }
+
+        unsigned char queryPacket[MAX_PACKET_SIZE];
+        int packetLength = populatePacketHeader(reinterpret_cast<char*>(queryPacket), queryType, _sessionUUID);
+        packetLength += _octreeQuery.getBroadcastData(queryPacket + packetLength);
+
+        QByteArray packet(reinterpret_cast<const char*>(queryPacket), packetLength);
+        writeDatagram(packet, node.activeSocket, node.connectionSecret);
+    }
+}
+
+void SimulatedClient::readPendingDatagrams() {
+    QByteArray packet;
+    HifiSockAddr senderSockAddr;
+
+    while (_socket.hasPendingDatagrams()) {
+        packet.resize(_socket.pendingDatagramSize());
+        _socket.readDatagram(packet.data(), packet.size(),
+                             senderSockAddr.getAddressPointer(), senderSockAddr.getPortPointer());
+
+        switch (packetTypeForPacket(packet)) {
+            case PacketTypeDomainList:
+                processDomainList(packet);
+                break;
+            case PacketTypePing:
+                processPing(packet, senderSockAddr);
+                break;
+            case PacketTypePingReply:
+                processPingReply(packet, senderSockAddr);
+                break;
+            case PacketTypeMixedAudio:
+                processMixedAudio();
+                break;
+            case PacketTypeBulkAvatarData:
+                _stats.numBulkAvatarPackets++;
+                break;
+            case PacketTypeVoxelData:
+            case PacketTypeParticleData:
+            case PacketTypeModelData:
+                processOctreeData(packet);
+                break;
+            case PacketTypeOctreeStats:
+                _stats.numOctreeStatsPackets++;
+                break;
+            default:
+                _stats.numOtherPackets++;
+                break;
+        }
+    }
+}
+
+void SimulatedClient::processDomainList(const QByteArray& packet) {
+    _numNoReplyDomainCheckIns = 0;
+
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    packetStream >> _sessionUUID;
+
+    DomainListType_t listType;
+    quint32 listVersion;
+    quint16 packetIndex, numPackets;
+    packetStream >> listType >> listVersion >> packetIndex >> numPackets;
+
+    while (packetStream.device()->pos() < packet.size()) {
+        DomainListEntry_t entryType;
+        QUuid nodeUUID;
+        packetStream >> entryType;
+
+        if (entryType == DomainListEntry::Remove) {
+            packetStream >> nodeUUID;
+            _nodes.remove(nodeUUID);
+            continue;
+        }
+
+        NodeType_t nodeType;
+        HifiSockAddr publicSocket, localSocket;
+        QUuid connectionSecret;
+        packetStream >> nodeType >> nodeUUID >> publicSocket >> localSocket >> connectionSecret;
+
+        if (publicSocket.getAddress().isNull()) {
+            // the node is on the same box as the domain-server
+            publicSocket.setAddress(_domainSockAddr.getAddress());
+        }
+
+        SimulatedNode& node = _nodes[nodeUUID];
+        if (node.publicSocket != publicSocket || node.localSocket != localSocket) {
+            // new or moved, we'll have to find out which socket works again
+            node.activeSocket = HifiSockAddr();
+        }
+        node.type = nodeType;
+        node.publicSocket = publicSocket;
+        node.localSocket = localSocket;
+        node.connectionSecret = connectionSecret;
+    }
+
+    // acknowledge the list version only once we have all of it, just like NodeList
+    if (listVersion != _pendingDomainListVersion || listType != _pendingDomainListType) {
+        _pendingDomainListVersion = listVersion;
+        _pendingDomainListType = listType;
+        _receivedDomainListPackets.clear();
+    }
+
+    _receivedDomainListPackets.insert(packetIndex);
+
+    if (_receivedDomainListPackets.size() >= numPackets) {
+        _domainListVersion = listVersion;
+    }
+}
+
+void SimulatedClient::processPing(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    QHash<QUuid, SimulatedNode>::const_iterator node = _nodes.constFind(uuidFromPacketHeader(packet));
+    if (node == _nodes.constEnd()) {
+        return;
+    }
+
+    QDataStream pingStream(packet);
+    pingStream.skipRawData(numBytesForPacketHeader(packet));
+
+    PingType_t pingType;
+    quint64 timeFromOriginalPing;
+    pingStream >> pingType >> timeFromOriginalPing;
+
+    QByteArray replyPacket = byteArrayWithPopulatedHeader(PacketTypePingReply, _sessionUUID);
+    QDataStream replyStream(&replyPacket, QIODevice::Append);
+    replyStream << pingType << timeFromOriginalPing << usecTimestampNow();
+
+    writeDatagram(replyPacket, senderSockAddr, node->connectionSecret);
+}
+
+void SimulatedClient::processPingReply(const QByteArray& packet, const HifiSockAddr& senderSockAddr) {
+    QHash<QUuid, SimulatedNode>::iterator node = _nodes.find(uuidFromPacketHeader(packet));
+    if (node == _nodes.end()) {
+        return;
+    }
+
+    QDataStream packetStream(packet);
+    packetStream.skipRawData(numBytesForPacketHeader(packet));
+
+    PingType_t pingType;
+    quint64 ourOriginalTime;
+    packetStream >> pingType >> ourOriginalTime;
+
+    if (node->activeSocket.isNull()) {
+        node->activeSocket = senderSockAddr;
+    }
+
+    _stats.pingMsecs[node->type].addSample((usecTimestampNow() - ourOriginalTime) / (float) USECS_PER_MSEC);
+}
+
+void SimulatedClient::processMixedAudio() {
+    _stats.numMixedAudioPackets++;
+
+    quint64 now = usecTimestampNow();
+    if (_lastMixedAudioUsecs != 0) {
+        _stats.mixedAudioGapMsecs.addSample((now - _lastMixedAudioUsecs) / (float) USECS_PER_MSEC);
+    }
+    _lastMixedAudioUsecs = now;
+}
+
+void SimulatedClient::processOctreeData(const QByteArray& packet) {
+    _stats.numOctreeDataPackets++;
+
+    int sentTimeOffset = numBytesForPacketHeader(packet) + sizeof(OCTREE_PACKET_FLAGS) + sizeof(OCTREE_PACKET_SEQUENCE);
+    if (packet.size() < sentTimeOffset + (int) sizeof(OCTREE_PACKET_SENT_TIME)) {
+        return;
+    }
+
+    OCTREE_PACKET_SENT_TIME sentTime;
+    memcpy(&sentTime, packet.constData() + sentTimeOffset, sizeof(sentTime));
+
+    // the servers run on this box, so their clock is ours
+    quint64 now = usecTimestampNow();
+    if (now > sentTime) {
+        _stats.octreeLatencyMsecs.addSample((now - sentTime) / (float) USECS_PER_MSEC);
+    }
+}
+
+void SimulatedClient::sendPing(const SimulatedNode& node, PingType_t pingType, const HifiSockAddr& destinationSockAddr) {
+    if (destinationSockAddr.isNull()) {
+        return;
+    }
+
+    QByteArray pingPacket = byteArrayWithPopulatedHeader(PacketTypePing, _sessionUUID);
+    QDataStream packetStream(&pingPacket, QIODevice::Append);
+    packetStream << pingType << usecTimestampNow();
+
+    writeDatagram(pingPacket, destinationSockAddr, node.connectionSecret);
+}
+
+void SimulatedClient::writeDatagram(QByteArray& packet, const HifiSockAddr& destinationSockAddr,
+                                    const QUuid& connectionSecret) {
+    if (!NON_VERIFIED_PACKETS.contains(packetTypeForPacket(packet))) {
+        replaceHashInPacketGivenConnectionUUID(packet, connectionSecret);
+    }
+
+    _socket.writeDatagram(packet, destinationSockAddr.getAddress(), destinationSockAddr.getPort());
+}
@@ -0,0 +1,122 @@
+//
+//  SimulatedClient.h
+//  tools/load-generator/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SimulatedClient_h
+#define hifi_SimulatedClient_h
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtNetwork/QUdpSocket>
+
+#include <AudioRingBuffer.h>
+#include <AvatarData.h>
+#include <HifiSockAddr.h>
+#include <LimitedNodeList.h>
+#include <NodeList.h>
+#include <OctreeQuery.h>
+#include <PacketHeaders.h>
+
+#include "SampleSet.h"
+
+/// What one simulated client received over a report interval.
+class ClientStats {
+public:
+    ClientStats();
+    void reset();
+
+    int numMixedAudioPackets;
+    int numBulkAvatarPackets;
+    int numOctreeDataPackets;
+    int numOctreeStatsPackets;
+    int numOtherPackets;
+
+    SampleSet mixedAudioGapMsecs;                  // time between consecutive mixed audio packets
+    QHash<NodeType_t, SampleSet> pingMsecs;         // round trip time to each kind of server
+    SampleSet octreeLatencyMsecs;                  // octree server send time to our receive time
+};
+
+/// A stand-in for one interface client: it has its own socket and session with the domain-server, streams
+/// microphone audio and avatar data to the mixers and queries the octree servers with a view that moves around.
+///
+/// It speaks the protocol directly instead of going through NodeList, since that is a singleton and we want
+/// hundreds of these in one process.
+class SimulatedClient : public QObject {
+    Q_OBJECT
+public:
+    SimulatedClient(int clientIndex, const HifiSockAddr& domainSockAddr, const NodeSet& nodeTypesOfInterest,
+                    QObject* parent = 0);
+
+    bool isConnected() const { return !_sessionUUID.isNull(); }
+
+    void setMaxOctreePacketsPerSecond(int maxOctreePPS) { _octreeQuery.setMaxOctreePacketsPerSecond(maxOctreePPS); }
+
+    /// walks the avatar around its circle and turns its head, for the given time since the load test started
+    void updatePose(float seconds);
+
+    void checkInWithDomain();
+    void pingNodes();
+    void sendAudioFrame();
+    void sendAvatarData();
+    void sendOctreeQueries();
+
+    ClientStats& getStats() { return _stats; }
+
+private slots:
+    void readPendingDatagrams();
+
+private:
+    struct SimulatedNode {
+        NodeType_t type;
+        HifiSockAddr publicSocket;
+        HifiSockAddr localSocket;
+        HifiSockAddr activeSocket;
+        QUuid connectionSecret;
+    };
+
+    void processDomainList(const QByteArray& packet);
+    void processPing(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void processPingReply(const QByteArray& packet, const HifiSockAddr& senderSockAddr);
+    void processMixedAudio();
+    void processOctreeData(const QByteArray& packet);
+
+    void sendPing(const SimulatedNode& node, PingType_t pingType, const HifiSockAddr& destinationSockAddr);
+    void writeDatagram(QByteArray& packet, const HifiSockAddr& destinationSockAddr, const QUuid& connectionSecret);
+
+    QUdpSocket _socket;
+    HifiSockAddr _domainSockAddr;
+    NodeSet _nodeTypesOfInterest;
+    int _numNoReplyDomainCheckIns;
+
+    QUuid _sessionUUID;
+    quint32 _domainListVersion;
+    quint32 _pendingDomainListVersion;
+    DomainListType_t _pendingDomainListType;
+    QSet<quint16> _receivedDomainListPackets;
+    QHash<QUuid, SimulatedNode> _nodes;
+
+    quint16 _audioSequenceNumber;
+    int16_t _audioSamples[NETWORK_BUFFER_LENGTH_SAMPLES_PER_CHANNEL];
+    glm::vec3 _walkCenter;
+    float _walkPhase;
+    glm::vec3 _headPosition;
+    glm::quat _headOrientation;
+    AvatarData _avatar;
+    OctreeQuery _octreeQuery;
+
+    quint64 _lastMixedAudioUsecs;
+    ClientStats _stats;
+};
+
+#endif // hifi_SimulatedClient_h
@@ -0,0 +1,17 @@
+//
+//  main.cpp
+//  tools/load-generator/src
+//
+//  Created by Aleric Inglewood on 10/19/14.
+//  Copyright 2014 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "LoadGenerator.h"
+
+int main(int argc, char* argv[]) {
+    LoadGenerator loadGenerator(argc, argv);
+    return loadGenerator.exec();
+}